@@ -0,0 +1,215 @@
+#include "ADSBSBSParser.h"
+
+#include <cstring>
+
+namespace {
+
+using ADSBSBSParser::Message_t;
+
+bool parseCallsign(const QByteArrayView *fields, qsizetype fieldCount, Message_t &message)
+{
+    if (fieldCount <= 10) {
+        return false;
+    }
+
+    const QByteArrayView callsign = fields[10].trimmed();
+    if (callsign.isEmpty()) {
+        return false;
+    }
+
+    message.callsignLength = qMin(callsign.size(), ADSBSBSParser::kMaxCallsignLength);
+    (void) memcpy(message.callsign, callsign.data(), static_cast<size_t>(message.callsignLength));
+    message.availableFlags = ADSB::CallsignAvailable;
+
+    return true;
+}
+
+bool parseLocation(const QByteArrayView *fields, qsizetype fieldCount, Message_t &message)
+{
+    if (fieldCount <= 19) {
+        return false;
+    }
+
+    // Altitude is either Barometric - based on pressure, in ft
+    // or HAE - as reported by GPS - based on WGS84 Ellipsoid, in ft
+    // If altitude ends with H, we have HAE
+    // There's a slight difference between Barometric alt and HAE, but it would require
+    // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
+    QByteArrayView altitudeField = fields[11];
+    if (altitudeField.endsWith('H')) {
+        altitudeField.chop(1);
+    }
+
+    bool altOk, latOk, lonOk, alertOk;
+    const int modeCAltitude = altitudeField.toInt(&altOk);
+    const double lat = fields[14].toDouble(&latOk);
+    const double lon = fields[15].toDouble(&lonOk);
+    const int alert = fields[19].toInt(&alertOk);
+
+    if (!altOk || !latOk || !lonOk || !alertOk) {
+        return false;
+    }
+
+    if (qFuzzyIsNull(lat) && qFuzzyIsNull(lon)) {
+        return false;
+    }
+
+    message.latitude = lat;
+    message.longitude = lon;
+    message.altitude = modeCAltitude * 0.3048;
+    message.alert = (alert == 1);
+    message.availableFlags = ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable;
+
+    return true;
+}
+
+bool parseHeading(const QByteArrayView *fields, qsizetype fieldCount, Message_t &message)
+{
+    if (fieldCount <= 13) {
+        return false;
+    }
+
+    bool headingOk = false, speedOk = false;
+    const double heading = fields[13].toDouble(&headingOk);
+    const double speedKnots = fields[12].toDouble(&speedOk);
+    if (!headingOk || !speedOk) {
+        return false;
+    }
+
+    message.heading = heading;
+    message.velocity = speedKnots * 0.514444;
+    message.availableFlags = ADSB::HeadingAvailable | ADSB::VelocityAvailable;
+
+    if (fieldCount > 16) {
+        bool vertOk = false;
+        const double verticalRate = fields[16].toDouble(&vertOk);
+        if (vertOk) {
+            message.verticalVel = verticalRate * 0.00508;
+            message.availableFlags |= ADSB::VerticalVelAvailable;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace ADSBSBSParser {
+
+bool parseLine(QByteArrayView line, Message_t &message)
+{
+    while (line.endsWith('\n') || line.endsWith('\r')) {
+        line.chop(1);
+    }
+
+    if ((line.size() <= 4) || !line.startsWith("MSG")) {
+        return false;
+    }
+
+    const char msgTypeChar = line.at(4);
+    if ((msgTypeChar < '0') || (msgTypeChar > '9')) {
+        return false;
+    }
+
+    // Skip unsupported mesg types to avoid parsing
+    const int msgType = msgTypeChar - '0';
+    if ((msgType == ADSB::SurfacePosition) || (msgType > ADSB::SurveillanceId)) {
+        return false;
+    }
+
+    QByteArrayView fields[kMaxFields];
+    qsizetype fieldCount = 0;
+    qsizetype fieldStart = 0;
+    while (fieldCount < kMaxFields) {
+        const qsizetype comma = line.indexOf(',', fieldStart);
+        if (comma < 0) {
+            fields[fieldCount++] = line.sliced(fieldStart);
+            break;
+        }
+        fields[fieldCount++] = line.sliced(fieldStart, comma - fieldStart);
+        fieldStart = comma + 1;
+    }
+
+    if (fieldCount <= 4) {
+        return false;
+    }
+
+    bool icaoOk = false;
+    const uint32_t icaoAddress = fields[4].toUInt(&icaoOk, 16);
+    if (!icaoOk) {
+        return false;
+    }
+
+    message = Message_t();
+    message.icaoAddress = icaoAddress;
+
+    switch (msgType) {
+    case ADSB::IdentificationAndCategory:
+    case ADSB::SurveillanceAltitude:
+    case ADSB::SurveillanceId:
+        return parseCallsign(fields, fieldCount, message);
+    case ADSB::AirbornePosition:
+        return parseLocation(fields, fieldCount, message);
+    case ADSB::AirborneVelocity:
+        return parseHeading(fields, fieldCount, message);
+    default:
+        return false;
+    }
+}
+
+void merge(Message_t &message, const Message_t &update)
+{
+    const ADSB::AvailableInfoTypes flags = update.availableFlags;
+
+    if (flags & ADSB::CallsignAvailable) {
+        (void) memcpy(message.callsign, update.callsign, static_cast<size_t>(update.callsignLength));
+        message.callsignLength = update.callsignLength;
+    }
+    if (flags & ADSB::LocationAvailable) {
+        message.latitude = update.latitude;
+        message.longitude = update.longitude;
+    }
+    if (flags & ADSB::AltitudeAvailable) {
+        message.altitude = update.altitude;
+    }
+    if (flags & ADSB::HeadingAvailable) {
+        message.heading = update.heading;
+    }
+    if (flags & ADSB::VelocityAvailable) {
+        message.velocity = update.velocity;
+    }
+    if (flags & ADSB::VerticalVelAvailable) {
+        message.verticalVel = update.verticalVel;
+    }
+    if (flags & ADSB::AlertAvailable) {
+        message.alert = update.alert;
+    }
+
+    message.availableFlags |= flags;
+}
+
+ADSB::VehicleInfo_t toVehicleInfo(const Message_t &message)
+{
+    ADSB::VehicleInfo_t vehicleInfo;
+    vehicleInfo.icaoAddress = message.icaoAddress;
+    vehicleInfo.availableFlags = message.availableFlags;
+
+    if (message.availableFlags & ADSB::CallsignAvailable) {
+        vehicleInfo.callsign = QString::fromLatin1(message.callsign, message.callsignLength);
+    }
+    if (message.availableFlags & ADSB::LocationAvailable) {
+        vehicleInfo.location.setLatitude(message.latitude);
+        vehicleInfo.location.setLongitude(message.longitude);
+    }
+    if (message.availableFlags & ADSB::AltitudeAvailable) {
+        vehicleInfo.location.setAltitude(message.altitude);
+    }
+    vehicleInfo.heading = message.heading;
+    vehicleInfo.velocity = message.velocity;
+    vehicleInfo.verticalVel = message.verticalVel;
+    vehicleInfo.alert = message.alert;
+
+    return vehicleInfo;
+}
+
+} // namespace ADSBSBSParser
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QtCore/QByteArrayView>
+
+#include "ADSB.h"
+
+/// Parser of the SBS-1 (BaseStation) text format served by dump1090 and similar receivers on port 30003.
+/// Lines are split into QByteArrayView fields and converted in place, nothing is allocated while parsing.
+namespace ADSBSBSParser {
+
+constexpr qsizetype kMaxFields = 22;
+constexpr qsizetype kMaxCallsignLength = 8;    ///< ADS-B identification carries 8 characters, longer SBS callsigns are truncated
+
+/// Fields of one message, or of several messages of one aircraft combined by merge()
+struct Message_t {
+    uint32_t icaoAddress = 0;
+    ADSB::AvailableInfoTypes availableFlags = ADSB::AvailableInfoType();
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double altitude = 0.0;          ///< m
+    double heading = 0.0;
+    double velocity = 0.0;          ///< m/s
+    double verticalVel = 0.0;       ///< m/s
+    bool alert = false;
+    char callsign[kMaxCallsignLength] = {};
+    qsizetype callsignLength = 0;
+};
+
+/// Parses one line, with or without its line end
+///     @return false if the line is not a supported message or a field is invalid
+bool parseLine(QByteArrayView line, Message_t &message);
+
+/// Copies the fields available in @a update into @a message, both of the same aircraft
+void merge(Message_t &message, const Message_t &update);
+
+ADSB::VehicleInfo_t toVehicleInfo(const Message_t &message);
+
+} // namespace ADSBSBSParser
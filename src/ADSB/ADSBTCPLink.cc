@@ -2,6 +2,7 @@
 // #include "DeviceInfo.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 #include <QtNetwork/QTcpSocket>
 
@@ -10,47 +11,29 @@ QGC_LOGGING_CATEGORY(ADSBTCPLinkLog, "ADSB.ADSBTCPLink")
 ADSBTCPLink::ADSBTCPLink(const QHostAddress &hostAddress, quint16 port, QObject *parent)
     : QObject(parent)
     , _hostAddress(hostAddress)
-    , _port(port)
-    , _socket(new QTcpSocket(this))
-    , _processTimer(new QTimer(this))
+    , _worker(new ADSBTCPWorker(hostAddress, port))
+    , _workerThread(new QThread(this))
 {
-    if (ADSBTCPLinkLog().isDebugEnabled()) {
-        (void) connect(_socket, &QTcpSocket::stateChanged, this, [](QTcpSocket::SocketState state) {
-            switch (state) {
-            case QTcpSocket::UnconnectedState:
-                qCDebug(ADSBTCPLinkLog) << "ADSB Socket disconnected";
-                break;
-            case QTcpSocket::SocketState::ConnectingState:
-                qCDebug(ADSBTCPLinkLog) << "ADSB Socket connecting...";
-                break;
-            case QTcpSocket::SocketState::ConnectedState:
-                qCDebug(ADSBTCPLinkLog) << "ADSB Socket connected";
-                break;
-            case QTcpSocket::SocketState::ClosingState:
-                qCDebug(ADSBTCPLinkLog) << "ADSB Socket closing...";
-                break;
-            default:
-                break;
-            }
-        }, Qt::AutoConnection);
-    }
+    _workerThread->setObjectName(QStringLiteral("ADSB_%1").arg(port));
 
-    (void) QObject::connect(_socket, &QTcpSocket::errorOccurred, this, [this](QTcpSocket::SocketError error) {
-        qCDebug(ADSBTCPLinkLog) << error << _socket->errorString();
-        // TODO: Check if it is a critical error or not and send if the socket is stopped/recoverable
-        emit errorOccurred(_socket->errorString(), false);
-    }, Qt::AutoConnection);
+    _worker->moveToThread(_workerThread);
 
-    (void) connect(_socket, &QTcpSocket::readyRead, this, &ADSBTCPLink::_readBytes);
+    (void) connect(_workerThread, &QThread::finished, _worker, &QObject::deleteLater);
+    (void) connect(_worker, &ADSBTCPWorker::vehicleUpdates, this, &ADSBTCPLink::_vehicleUpdates, Qt::QueuedConnection);
+    (void) connect(_worker, &ADSBTCPWorker::errorOccurred, this, &ADSBTCPLink::errorOccurred, Qt::QueuedConnection);
 
-    _processTimer->setInterval(_processInterval); // Set an interval for processing lines
-    (void) connect(_processTimer, &QTimer::timeout, this, &ADSBTCPLink::_processLines);
+    _workerThread->start();
 
     // qCDebug(ADSBTCPLinkLog) << Q_FUNC_INFO << this;
 }
 
 ADSBTCPLink::~ADSBTCPLink()
 {
+    _workerThread->quit();
+    if (!_workerThread->wait()) {
+        qCWarning(ADSBTCPLinkLog) << "Failed to wait for ADSB Thread to close";
+    }
+
     // qCDebug(ADSBTCPLinkLog) << Q_FUNC_INFO << this;
 }
 
@@ -64,175 +47,164 @@ bool ADSBTCPLink::init()
         return false;
     }
 
-    _socket->connectToHost(_hostAddress, _port);
-
-    return true;
+    return QMetaObject::invokeMethod(_worker, "connectToHost", Qt::QueuedConnection);
 }
 
-void ADSBTCPLink::_readBytes()
+void ADSBTCPLink::_vehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos)
 {
-    while (_socket && _socket->canReadLine()) {
-        const QByteArray bytes = _socket->readLine();
-        (void) _lineBuffer.append(QString::fromLocal8Bit(bytes));
-    }
-
-    // Start or restart the timer to process lines
-    if (!_processTimer->isActive()) {
-        _processTimer->start();
+    for (const ADSB::VehicleInfo_t &vehicleInfo : vehicleInfos) {
+        emit adsbVehicleUpdate(vehicleInfo);
     }
 }
 
-void ADSBTCPLink::_processLines()
+/*===========================================================================*/
+
+ADSBTCPWorker::ADSBTCPWorker(const QHostAddress &hostAddress, quint16 port, QObject *parent)
+    : QObject(parent)
+    , _hostAddress(hostAddress)
+    , _port(port)
 {
-    int linesProcessed = 0;
-    while (!_lineBuffer.isEmpty() && (linesProcessed < _maxLinesToProcess)) {
-        const QString line = _lineBuffer.takeFirst();
-        _parseLine(line);
-        ++linesProcessed;
-    }
+    // qCDebug(ADSBTCPLinkLog) << Q_FUNC_INFO << this;
+}
 
-    // Stop the timer if there are no more lines to process
-    if (_lineBuffer.isEmpty()) {
-        _processTimer->stop();
-    }
+ADSBTCPWorker::~ADSBTCPWorker()
+{
+    // qCDebug(ADSBTCPLinkLog) << Q_FUNC_INFO << this;
 }
 
-void ADSBTCPLink::_parseLine(const QString &line)
+void ADSBTCPWorker::connectToHost()
 {
-    if (line.size() <= 4) {
-        return;
-    }
+    if (!_socket) {
+        _socket = new QTcpSocket(this);
+        _processTimer = new QTimer(this);
+
+        if (ADSBTCPLinkLog().isDebugEnabled()) {
+            (void) connect(_socket, &QTcpSocket::stateChanged, this, [](QTcpSocket::SocketState state) {
+                switch (state) {
+                case QTcpSocket::UnconnectedState:
+                    qCDebug(ADSBTCPLinkLog) << "ADSB Socket disconnected";
+                    break;
+                case QTcpSocket::SocketState::ConnectingState:
+                    qCDebug(ADSBTCPLinkLog) << "ADSB Socket connecting...";
+                    break;
+                case QTcpSocket::SocketState::ConnectedState:
+                    qCDebug(ADSBTCPLinkLog) << "ADSB Socket connected";
+                    break;
+                case QTcpSocket::SocketState::ClosingState:
+                    qCDebug(ADSBTCPLinkLog) << "ADSB Socket closing...";
+                    break;
+                default:
+                    break;
+                }
+            }, Qt::AutoConnection);
+        }
 
-    if (!line.startsWith(QStringLiteral("MSG"))) {
-        return;
-    }
+        (void) QObject::connect(_socket, &QTcpSocket::errorOccurred, this, [this](QTcpSocket::SocketError error) {
+            qCDebug(ADSBTCPLinkLog) << error << _socket->errorString();
+            // TODO: Check if it is a critical error or not and send if the socket is stopped/recoverable
+            emit errorOccurred(_socket->errorString(), false);
+        }, Qt::AutoConnection);
 
-    const int msgType = line.at(4).digitValue();
-    if (msgType == ADSB::Unsupported) {
-        qCDebug(ADSBTCPLinkLog) << "ADSB Invalid message type" << msgType;
-        return;
-    }
+        (void) connect(_socket, &QTcpSocket::readyRead, this, &ADSBTCPWorker::_readBytes);
 
-    // Skip unsupported mesg types to avoid parsing
-    if ((msgType == ADSB::SurfacePosition) || (msgType > ADSB::SurveillanceId)) {
-        return;
+        _processTimer->setInterval(_processInterval); // Set an interval for sending updates
+        (void) connect(_processTimer, &QTimer::timeout, this, &ADSBTCPWorker::_processUpdates);
     }
 
-    qCDebug(ADSBTCPLinkLog) << "ADSB SBS-1" << line;
+    _socket->connectToHost(_hostAddress, _port);
+}
 
-    const QStringList values = line.split(QChar(','));
-    if (values.size() <= 4) {
+void ADSBTCPWorker::_readBytes()
+{
+    // Read straight into the buffer, which keeps its capacity, rather than into a new array per read
+    const qint64 available = _socket->bytesAvailable();
+    if (available <= 0) {
         return;
     }
 
-    bool icaoOk;
-    const uint32_t icaoAddress = values.at(4).toUInt(&icaoOk, 16);
-    if (!icaoOk) {
-        return;
-    }
+    const qsizetype previousSize = _buffer.size();
+    _buffer.resize(previousSize + available);
+    const qint64 bytesRead = _socket->read(_buffer.data() + previousSize, available);
+    _buffer.resize(previousSize + qMax<qint64>(bytesRead, 0));
 
-    ADSB::VehicleInfo_t adsbInfo;
-    adsbInfo.icaoAddress = icaoAddress;
-
-    switch (msgType) {
-    case ADSB::IdentificationAndCategory:
-    case ADSB::SurveillanceAltitude:
-    case ADSB::SurveillanceId:
-        _parseAndEmitCallsign(adsbInfo, values);
-        break;
-    case ADSB::AirbornePosition:
-        _parseAndEmitLocation(adsbInfo, values);
-        break;
-    case ADSB::AirborneVelocity:
-        _parseAndEmitHeading(adsbInfo, values);
-        break;
-    default:
-        break;
-    }
-}
+    const QByteArrayView bytes(_buffer);
+    qsizetype lineStart = 0;
+    while (lineStart < bytes.size()) {
+        const qsizetype lineEnd = bytes.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            break;
+        }
 
-void ADSBTCPLink::_parseAndEmitCallsign(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
-{
-    if (values.size() <= 10) {
-        return;
+        if (_discardingLine) {
+            // Tail of an overlong line, the next line starts behind it
+            _discardingLine = false;
+        } else {
+            _parseLine(bytes.sliced(lineStart, lineEnd - lineStart));
+        }
+        lineStart = lineEnd + 1;
     }
 
-    const QString callsign = values.at(10).trimmed();
-    if (callsign.isEmpty()) {
+    if (_discardingLine) {
+        _buffer.truncate(0);
         return;
     }
 
-    adsbInfo.callsign = callsign;
-    adsbInfo.availableFlags = ADSB::CallsignAvailable;
+    if (lineStart > 0) {
+        (void) _buffer.remove(0, lineStart);
+    }
 
-    emit adsbVehicleUpdate(adsbInfo);
+    if (_buffer.size() > _maxLineLength) {
+        // The rest of the line is dropped as it comes in, rather than parsed as a line of its own
+        qCDebug(ADSBTCPLinkLog) << "ADSB Dropping line longer than" << _maxLineLength;
+        _buffer.truncate(0);
+        _discardingLine = true;
+    }
 }
 
-void ADSBTCPLink::_parseAndEmitLocation(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
+void ADSBTCPWorker::_parseLine(QByteArrayView line)
 {
-    if (values.size() <= 19) {
+    ADSBSBSParser::Message_t message;
+    if (!ADSBSBSParser::parseLine(line, message)) {
         return;
     }
 
-    // Altitude is either Barometric - based on pressure, in ft
-    // or HAE - as reported by GPS - based on WGS84 Ellipsoid, in ft
-    // If altitude ends with H, we have HAE
-    // There's a slight difference between Barometric alt and HAE, but it would require
-    // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
-    QString altitudeStr = values.at(11);
-    if (altitudeStr.endsWith('H')) {
-        (void) altitudeStr.chop(1);
-    }
-
-    bool altOk, latOk, lonOk, alertOk;
-    const int modeCAltitude = altitudeStr.toInt(&altOk);
-    const double lat = values.at(14).toDouble(&latOk);
-    const double lon = values.at(15).toDouble(&lonOk);
-    const int alert = values.at(19).toInt(&alertOk);
-
-    if (!altOk || !latOk || !lonOk || !alertOk) {
-        return;
+    const auto it = _updates.find(message.icaoAddress);
+    if (it == _updates.end()) {
+        (void) _updates.insert(message.icaoAddress, message);
+    } else {
+        ADSBSBSParser::merge(*it, message);
     }
 
-    if (qFuzzyIsNull(lat) && qFuzzyIsNull(lon)) {
-        return;
+    // Start the timer to send the updates
+    if (!_processTimer->isActive()) {
+        _processTimer->start();
     }
-
-    const double altitude = modeCAltitude * 0.3048;
-    const QGeoCoordinate location(lat, lon, altitude);
-
-    adsbInfo.location = location;
-    adsbInfo.alert = (alert == 1);
-    adsbInfo.availableFlags = ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable;
-
-    emit adsbVehicleUpdate(adsbInfo);
 }
 
-void ADSBTCPLink::_parseAndEmitHeading(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
+void ADSBTCPWorker::_processUpdates()
 {
-    if (values.size() <= 13) {
-        return;
-    }
+    QList<ADSB::VehicleInfo_t> vehicleInfos;
+    vehicleInfos.reserve(_updates.size());
 
-    bool headingOk = false, speedOk = false;
-    const double heading = values.at(13).toDouble(&headingOk);
-    const double speedKnots = values.at(12).toDouble(&speedOk);
-    if (!headingOk || !speedOk) {
-        return;
+    for (auto it = _updates.begin(); it != _updates.end(); ++it) {
+        if (!it->availableFlags) {
+            continue;
+        }
+
+        vehicleInfos.append(ADSBSBSParser::toVehicleInfo(*it));
+        it->availableFlags = ADSB::AvailableInfoType();
     }
 
-    adsbInfo.heading = heading;
-    adsbInfo.velocity = speedKnots * 0.514444;
-    adsbInfo.availableFlags = ADSB::HeadingAvailable | ADSB::VelocityAvailable;
+    if (_updates.size() > _maxTrackedVehicles) {
+        _updates.clear();
+    }
 
-    if (values.size() > 16) {
-        bool vertOk = false;
-        const double verticalRate = values.at(16).toDouble(&vertOk);
-        if (vertOk) {
-            adsbInfo.verticalVel = verticalRate * 0.00508;
-            adsbInfo.availableFlags |= ADSB::VerticalVelAvailable;
-        }
+    // Stop the timer until more updates are parsed
+    if (vehicleInfos.isEmpty()) {
+        _processTimer->stop();
+        return;
     }
 
-    emit adsbVehicleUpdate(adsbInfo);
+    qCDebug(ADSBTCPLinkLog) << "ADSB SBS-1 updates" << vehicleInfos.size();
+    emit vehicleUpdates(vehicleInfos);
 }
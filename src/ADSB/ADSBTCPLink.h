@@ -1,18 +1,25 @@
 #pragma once
 
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtNetwork/QHostAddress>
 
 #include "ADSB.h"
+#include "ADSBSBSParser.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ADSBTCPLinkLog)
 
+class ADSBTCPWorker;
 class QTcpSocket;
+class QThread;
 class QTimer;
 
 /// The ADSBTCPLink class handles the TCP connection to an ADS-B server
 /// and processes incoming ADS-B data.
+/// Reading and parsing run on a worker thread, see ADSBTCPWorker.
 class ADSBTCPLink : public QObject
 {
     Q_OBJECT
@@ -40,39 +47,59 @@ class ADSBTCPLink : public QObject
     void errorOccurred(const QString &errorMsg, bool stopped = false);
 
 private slots:
-    /// Reads bytes from the TCP socket.
-    void _readBytes();
-
-    /// Processes buffered lines of ADS-B data.
-    void _processLines();
+    /// Emits the updates of one processing tick of the worker.
+    ///     @param vehicleInfos One update per vehicle.
+    void _vehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos);
 
 private:
-    /// Parses a line of ADS-B data.
-    ///     @param line The line to parse.
-    void _parseLine(const QString &line);
+    QHostAddress _hostAddress;
+
+    ADSBTCPWorker *_worker = nullptr;
+    QThread *_workerThread = nullptr;
+};
+
+/*===========================================================================*/
+
+/// Reads SBS-1 lines from the ADS-B server and parses them in place in the receive buffer.
+/// The messages of each vehicle are merged and sent as one update per vehicle every processing tick.
+class ADSBTCPWorker : public QObject
+{
+    Q_OBJECT
 
-    /// Parses and emits the callsign from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitCallsign(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+public:
+    explicit ADSBTCPWorker(const QHostAddress &hostAddress, quint16 port, QObject *parent = nullptr);
+    ~ADSBTCPWorker();
+
+public slots:
+    void connectToHost();
+
+signals:
+    /// Emitted once per processing tick with the merged updates of each vehicle heard since the last one.
+    void vehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos);
+    void errorOccurred(const QString &errorMsg, bool stopped = false);
 
-    /// Parses and emits the location from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitLocation(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+private slots:
+    /// Reads bytes from the TCP socket and parses the complete lines.
+    void _readBytes();
+
+    /// Sends the merged updates.
+    void _processUpdates();
 
-    /// Parses and emits the heading from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitHeading(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+private:
+    /// Parses a line of ADS-B data.
+    ///     @param line The line to parse, points into the receive buffer.
+    void _parseLine(QByteArrayView line);
 
     QHostAddress _hostAddress;
     quint16 _port = 30003;
 
     QTcpSocket *_socket = nullptr;     ///< Pointer to the TCP socket used for connection
     QTimer *_processTimer = nullptr;   ///< Timer for periodic processing of ADS-B data
-    QStringList _lineBuffer;           ///< Buffer for storing incoming lines of ADS-B data
+    QByteArray _buffer;                ///< Received bytes of the incomplete last line
+    bool _discardingLine = false;      ///< Dropping the rest of an overlong line up to its '\n'
+    QHash<uint32_t, ADSBSBSParser::Message_t> _updates;   ///< Merged updates by ICAO address, entries without flags were sent
 
-    static constexpr int _processInterval = 50;     ///< Interval for processing lines
-    static constexpr int _maxLinesToProcess = 100;  ///< Maximum number of lines to process per timer timeout
+    static constexpr int _processInterval = 200;        ///< Interval for sending updates
+    static constexpr int _maxLineLength = 4096;         ///< Longer lines are dropped
+    static constexpr int _maxTrackedVehicles = 4096;    ///< Update entries kept for reuse
 };
@@ -45,6 +45,7 @@ MAVLinkInspectorController::MAVLinkInspectorController(QObject *parent)
 
     MAVLinkProtocol *const mavlinkProtocol = MAVLinkProtocol::instance();
     (void) connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    (void) connect(mavlinkProtocol, &MAVLinkProtocol::lossStatisticsUpdated, this, &MAVLinkInspectorController::_receiveLossStatistics);
     (void) connect(_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
 
     _updateFrequencyTimer->setInterval(1000);
@@ -187,10 +188,12 @@ void MAVLinkInspectorController::_vehicleRemoved(const Vehicle *vehicle)
     emit systemsChanged();
 }
 
-void MAVLinkInspectorController::_receiveMessage(LinkInterface *link, const mavlink_message_t &message)
+void MAVLinkInspectorController::_receiveMessage(LinkInterface *link, const MAVLinkMessageRef &sharedMessage)
 {
     Q_UNUSED(link);
 
+    const mavlink_message_t &message = *sharedMessage;
+
     QGCMAVLinkMessage *msg = nullptr;
     QGCMAVLinkSystem *system = _findVehicle(message.sysid);
 
@@ -216,6 +219,19 @@ void MAVLinkInspectorController::_receiveMessage(LinkInterface *link, const mavl
     }
 }
 
+void MAVLinkInspectorController::_receiveLossStatistics(LinkInterface *link, const QList<MAVLinkLossStats> &statistics)
+{
+    Q_UNUSED(link);
+
+    for (const MAVLinkLossStats &stats : statistics) {
+        // Systems are only created by their messages, which arrive before the first statistics for them
+        QGCMAVLinkSystem *const system = _findVehicle(stats.sysid);
+        if (system) {
+            system->setLossStatistics(stats.compid, stats.toVariantMap());
+        }
+    }
+}
+
 void MAVLinkInspectorController::setActiveSystem(int systemId)
 {
     QGCMAVLinkSystem *const system = _findVehicle(systemId);
@@ -6,6 +6,8 @@
 #include <QtQmlIntegration/QtQmlIntegration>
 
 #include "MAVLinkLib.h"
+#include "MAVLinkLossTracker.h"
+#include "MAVLinkMessagePool.h"
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkInspectorControllerLog)
 
@@ -71,7 +73,8 @@ class MAVLinkInspectorController : public QObject
     void timeScalesChanged();
 
 private slots:
-    void _receiveMessage(LinkInterface *link, const mavlink_message_t &message);
+    void _receiveMessage(LinkInterface *link, const MAVLinkMessageRef &sharedMessage);
+    void _receiveLossStatistics(LinkInterface *link, const QList<MAVLinkLossStats> &statistics);
     void _refreshFrequency();
     void _setActiveVehicle(Vehicle *vehicle);
     void _vehicleAdded(Vehicle *vehicle);
@@ -61,6 +61,27 @@ AnalyzePage {
             QGCLabel {
                 text:           qsTr("Inspect real time MAVLink messages.")
             }
+            QGCLabel {
+                text:           lossText()
+                visible:        text !== ""
+                font.pointSize: ScreenTools.smallFontPointSize
+
+                function lossText() {
+                    if (!curSystem) {
+                        return ""
+                    }
+                    const parts = []
+                    const stats = curSystem.lossStatistics
+                    for (let i = 0; i < stats.length; i++) {
+                        const stat = stats[i]
+                        if (curCompID !== 0 && curCompID !== stat.compid) {
+                            continue
+                        }
+                        parts.push(qsTr("Comp %1: %2% loss, %3 lost, %4 reordered").arg(stat.compid).arg(stat.windowLossPercent.toFixed(1)).arg(stat.lost).arg(stat.reordered))
+                    }
+                    return parts.join("  ")
+                }
+            }
             RowLayout {
                 Layout.alignment:   Qt.AlignRight
                 visible:            curSystem ? controller.systemNames.length > 1 || curSystem.compIDsStr.length > 2 : false
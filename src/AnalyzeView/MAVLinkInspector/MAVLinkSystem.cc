@@ -121,6 +121,12 @@ void QGCMAVLinkSystem::append(QGCMAVLinkMessage *message)
     }
 }
 
+void QGCMAVLinkSystem::setLossStatistics(uint8_t compId, const QVariantMap &stats)
+{
+    _lossStatistics[compId] = stats;
+    emit lossStatisticsChanged();
+}
+
 void QGCMAVLinkSystem::_checkCompID(const QGCMAVLinkMessage *message)
 {
     if (_compIDsStr.isEmpty()) {
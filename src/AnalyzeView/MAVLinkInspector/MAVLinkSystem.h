@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QMap>
 #include <QtCore/QObject>
 #include <QtCore/QStringList>
+#include <QtCore/QVariantList>
 #include <QtQmlIntegration/QtQmlIntegration>
 
 #include "QmlObjectListModel.h"
@@ -20,6 +22,7 @@ class QGCMAVLinkSystem : public QObject
     Q_PROPERTY(QList<int>           compIDs     READ compIDs                        NOTIFY compIDsChanged)
     Q_PROPERTY(QStringList          compIDsStr  READ compIDsStr                     NOTIFY compIDsChanged)
     Q_PROPERTY(int                  selected    READ selected   WRITE setSelected   NOTIFY selectedChanged)
+    Q_PROPERTY(QVariantList         lossStatistics READ lossStatistics              NOTIFY lossStatisticsChanged)
 public:
     QGCMAVLinkSystem(quint8 id, QObject *parent = nullptr);
     ~QGCMAVLinkSystem();
@@ -29,16 +32,21 @@ class QGCMAVLinkSystem : public QObject
     QList<int> compIDs() const { return _compIDs; }
     QStringList compIDsStr() const { return _compIDsStr; }
     int selected() const { return _selected; }
+    /// @return Sequence loss of each component, see MAVLinkLossStats::toVariantMap
+    QVariantList lossStatistics() const { return _lossStatistics.values(); }
 
     void setSelected(int sel);
     QGCMAVLinkMessage *findMessage(uint32_t id, uint8_t compId);
     int findMessage(const QGCMAVLinkMessage *message);
     void append(QGCMAVLinkMessage *message);
     QGCMAVLinkMessage *selectedMsg();
+    /// Replaces the loss statistics of the component in @a stats
+    void setLossStatistics(uint8_t compId, const QVariantMap &stats);
 
 signals:
     void compIDsChanged();
     void selectedChanged();
+    void lossStatisticsChanged();
 
 private:
     void _checkCompID(const QGCMAVLinkMessage *message);
@@ -50,4 +58,5 @@ class QGCMAVLinkSystem : public QObject
     QList<int> _compIDs;
     QStringList _compIDsStr;
     int _selected = 0;
+    QMap<uint8_t, QVariantMap> _lossStatistics;
 };
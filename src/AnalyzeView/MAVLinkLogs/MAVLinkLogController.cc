@@ -1,6 +1,7 @@
 #include "MAVLinkLogController.h"
 #include "AppSettings.h"
 #include "MAVLinkLogEntry.h"
+#include "MAVLinkLogDownloadWriter.h"
 #include "MAVLinkProtocol.h"
 #include "MultiVehicleManager.h"
 #include "ParameterManager.h"
@@ -11,6 +12,9 @@
 #include "Vehicle.h"
 
 #include <QtCore/QApplicationStatic>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 
 QGC_LOGGING_CATEGORY(MAVLinkLogControllerLog, "AnalyzeView.MAVLinkLogController")
@@ -18,6 +22,8 @@ QGC_LOGGING_CATEGORY(MAVLinkLogControllerLog, "AnalyzeView.MAVLinkLogController"
 MAVLinkLogController::MAVLinkLogController(QObject *parent)
     : QObject(parent)
     , _timer(new QTimer(this))
+    , _writerThread(new QThread(this))
+    , _writer(new MAVLinkLogDownloadWriter())
     , _logEntriesModel(new QmlObjectListModel(this))
 {
     qCDebug(MAVLinkLogControllerLog) << this;
@@ -27,11 +33,25 @@ MAVLinkLogController::MAVLinkLogController(QObject *parent)
 
     _timer->setSingleShot(false);
 
+    _writerThread->setObjectName(QStringLiteral("MAVLinkLogDownloadWriter"));
+    _writer->moveToThread(_writerThread);
+    (void) connect(_writerThread, &QThread::finished, _writer, &QObject::deleteLater);
+    (void) connect(_writer, &MAVLinkLogDownloadWriter::errorOccurred, this, &MAVLinkLogController::_writerError);
+    (void) connect(_writer, &MAVLinkLogDownloadWriter::finished, this, &MAVLinkLogController::_writerFinished);
+    _writerThread->start(QThread::LowPriority);
+
     _setActiveVehicle(MultiVehicleManager::instance()->activeVehicle());
 }
 
 MAVLinkLogController::~MAVLinkLogController()
 {
+    _closeLogDownload();
+
+    // Returns once everything queued to the writer before is written
+    (void) QMetaObject::invokeMethod(_writer, "close", Qt::BlockingQueuedConnection);
+    _writerThread->quit();
+    _writerThread->wait();
+
     qCDebug(MAVLinkLogControllerLog) << this;
 }
 
@@ -45,6 +65,7 @@ void MAVLinkLogController::_downloadToDirectory(const QString &dir)
 {
     _receivedAllEntries();
 
+    _closeLogDownload();
     _downloadData.reset();
 
     _downloadPath = dir;
@@ -215,7 +236,7 @@ bool MAVLinkLogController::_entriesComplete() const
 
 void MAVLinkLogController::_logData(uint32_t ofs, uint16_t id, uint8_t count, const uint8_t *data)
 {
-    if (!_downloadingLogs || !_downloadData) {
+    if (!_downloadingLogs || !_downloadData || _downloadData->finishing) {
         return;
     }
 
@@ -230,145 +251,208 @@ void MAVLinkLogController::_logData(uint32_t ofs, uint16_t id, uint8_t count, co
         return;
     }
 
-    bool result = false;
-    if (ofs <= _downloadData->entry->size()) {
-        const uint32_t chunk = ofs / MAVLinkLogDownloadData::kChunkSize;
-        // qCDebug(MAVLinkLogControllerLog) << "Received data - Offset:" << ofs << "Chunk:" << chunk;
-        if (chunk != _downloadData->current_chunk) {
-            qCWarning(MAVLinkLogControllerLog) << "Ignored packet for out of order chunk actual:expected" << chunk << _downloadData->current_chunk;
-            return;
-        }
-
-        const uint16_t bin = (ofs - (chunk * MAVLinkLogDownloadData::kChunkSize)) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-        if (bin >= _downloadData->chunk_table.size()) {
-            qCWarning(MAVLinkLogControllerLog) << "Out of range bin received";
-        } else {
-            _downloadData->chunk_table.setBit(bin);
-        }
+    if (ofs >= _downloadData->entry->size()) {
+        qCWarning(MAVLinkLogControllerLog) << "Received log offset greater than expected";
+        return;
+    }
 
-        if (_downloadData->file.pos() != ofs) {
-            if (!_downloadData->file.seek(ofs)) {
-                qCWarning(MAVLinkLogControllerLog) << "Error while seeking log file offset";
-                return;
-            }
-        }
+    // Only the last bin of the log may be short
+    if (count != qMin<uint32_t>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, _downloadData->entry->size() - ofs)) {
+        qCWarning(MAVLinkLogControllerLog) << "Ignored packet of unexpected size @" << ofs << count;
+        return;
+    }
 
-        if (_downloadData->file.write(reinterpret_cast<const char*>(data), count)) {
-            _downloadData->written += count;
-            _downloadData->rate_bytes += count;
-            _updateDataRate();
+    _retries = 0;
+    _timer->start(kTimeOutMs);
 
-            result = true;
-            _retries = 0;
-
-            _timer->start(kTimeOutMs);
-            if (_logComplete()) {
-                _downloadData->entry->setStatus(tr("Downloaded"));
-                _receivedAllData();
-            } else if (_chunkComplete()) {
-                _downloadData->advanceChunk();
-                _requestLogData(_downloadData->ID,
-                                _downloadData->current_chunk * MAVLinkLogDownloadData::kChunkSize,
-                                _downloadData->chunk_table.size() * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-            } else if ((bin < (_downloadData->chunk_table.size() - 1)) && _downloadData->chunk_table.at(bin + 1)) {
-                // Likely to be grabbing fragments and got to the end of a gap
-                _findMissingData();
-            }
-        } else {
-            qCWarning(MAVLinkLogControllerLog) << "Error while writing log file chunk";
+    const uint32_t bin = ofs / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    if (_downloadData->setReceived(bin)) {
+        if (!_downloadData->write_buffer.isEmpty() && (ofs != (_downloadData->write_offset + _downloadData->write_buffer.size()))) {
+            _flushLogData();
         }
+        if (_downloadData->write_buffer.isEmpty()) {
+            _downloadData->write_offset = ofs;
+        }
+        _downloadData->write_buffer.append(reinterpret_cast<const char*>(data), count);
+        if (_downloadData->write_buffer.size() >= kWriteBatchSize) {
+            _flushLogData();
+        }
+
+        _downloadData->written += count;
+        _statistics.bytesReceived += count;
     } else {
-        qCWarning(MAVLinkLogControllerLog) << "Received log offset greater than expected";
+        _statistics.bytesDuplicate += count;
     }
 
-    if (!result) {
-        _downloadData->entry->setStatus(tr("Error"));
+    if (_downloadData->complete()) {
+        _timer->stop();
+        _updateDataRate(true);
+        _flushLogData();
+        _downloadData->finishing = true;
+        (void) QMetaObject::invokeMethod(_writer, "finish", Qt::QueuedConnection, Q_ARG(QString, _downloadData->stateFileName()));
+        return;
+    }
+
+    _updateDataRate();
+
+    if ((bin + 1) == _downloadData->request_end) {
+        // The vehicle sent the end of the range, what is still missing is requested without waiting for the timeout
+        _requestMissingData();
     }
 }
 
 void MAVLinkLogController::_findMissingData()
 {
-    if (_logComplete()) {
-        _receivedAllData();
+    if (!_downloadData || _downloadData->finishing) {
         return;
     }
 
-    if (_chunkComplete()) {
-        _downloadData->advanceChunk();
-    }
-
     _retries++;
+    _statistics.retries++;
 
     _updateDataRate();
 
-    uint16_t start = 0, end = 0;
-    const int size = _downloadData->chunk_table.size();
-    for (; start < size; start++) {
-        if (!_downloadData->chunk_table.testBit(start)) {
-            break;
-        }
+    // The vehicle stopped sending, keep what was received in case the download does not continue
+    _saveLogState();
+
+    _requestMissingData();
+}
+
+void MAVLinkLogController::_requestMissingData()
+{
+    uint32_t start = 0;
+    uint32_t end = 0;
+    if (!_downloadData->nextMissingBins(0, start, end)) {
+        return;
     }
 
-    for (end = start; end < size; end++) {
-        if (_downloadData->chunk_table.testBit(end)) {
-            break;
-        }
+    // Sending a few received bins again is cheaper than waiting for another range
+    uint32_t nextStart = 0;
+    uint32_t nextEnd = 0;
+    while (_downloadData->nextMissingBins(end, nextStart, nextEnd) && ((nextStart - end) <= kMissingBinsMergeGap)) {
+        end = nextEnd;
     }
 
-    const uint32_t pos = (_downloadData->current_chunk * MAVLinkLogDownloadData::kChunkSize) + (start * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-    const uint32_t len = (end - start) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
-    _requestLogData(_downloadData->ID, pos, len, _retries);
+    _downloadData->request_start = start;
+    _downloadData->request_end = end;
+    _statistics.requests++;
+
+    const uint32_t offset = start * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    const uint32_t endOffset = static_cast<uint32_t>(qMin<quint64>(static_cast<quint64>(end) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN, _downloadData->entry->size()));
+    _requestLogData(_downloadData->ID, offset, endOffset - offset, _retries);
+    _timer->start(kTimeOutMs);
 }
 
-void MAVLinkLogController::_updateDataRate()
+void MAVLinkLogController::_updateDataRate(bool force)
 {
     constexpr uint kSizeUpdateThreshold = 102400; // 0.1 MB
-    const bool timeThresholdMet = _downloadData->elapsed.elapsed() >= kGUIRateMs;
+    const bool timeThresholdMet = _downloadData->last_status.elapsed() >= kGUIRateMs;
     const bool sizeThresholdMet = (_downloadData->written - _downloadData->last_status_written) >= kSizeUpdateThreshold;
 
-    if (!timeThresholdMet && !sizeThresholdMet) {
+    if (!force && !timeThresholdMet && !sizeThresholdMet) {
         return;
     }
 
-    QString status;
-    if (timeThresholdMet) {
-        // Update both rate and size
-        const qreal rate = _downloadData->rate_bytes / (_downloadData->elapsed.elapsed() / 1000.0);
-        _downloadData->rate_avg = (_downloadData->rate_avg * 0.95) + (rate * 0.05);
-        _downloadData->rate_bytes = 0;
-
-        status = QStringLiteral("%1 (%2/s)").arg(qgcApp()->bigSizeToString(_downloadData->written),
-                                                   qgcApp()->bigSizeToString(_downloadData->rate_avg));
-        _downloadData->elapsed.start();
-    } else {
-        // Update size only, keep previous rate
-        status = QStringLiteral("%1 (%2/s)").arg(qgcApp()->bigSizeToString(_downloadData->written),
-                                                   qgcApp()->bigSizeToString(_downloadData->rate_avg));
+    // Achieved rate of this download, data kept from an interrupted download does not count
+    _statistics.elapsedMs = _downloadData->elapsed.elapsed();
+    const double bytesPerSecond = (_statistics.elapsedMs > 0) ? ((_statistics.bytesReceived * 1000.0) / _statistics.elapsedMs) : 0.0;
+    if (bytesPerSecond != _statistics.bytesPerSecond) {
+        _statistics.bytesPerSecond = bytesPerSecond;
+        emit downloadRateChanged();
     }
 
+    const QString status = QStringLiteral("%1 / %2 (%3/s)").arg(qgcApp()->bigSizeToString(_downloadData->written),
+                                                                qgcApp()->bigSizeToString(_downloadData->entry->size()),
+                                                                qgcApp()->bigSizeToString(static_cast<quint64>(bytesPerSecond)));
     _downloadData->entry->setStatus(status);
     _downloadData->last_status_written = _downloadData->written;
+    _downloadData->last_status.start();
+
+    if (_downloadData->last_state_save.elapsed() >= kStateSaveMs) {
+        _saveLogState();
+    }
+}
+
+void MAVLinkLogController::_flushLogData()
+{
+    if (!_downloadData || _downloadData->write_buffer.isEmpty()) {
+        return;
+    }
+
+    (void) QMetaObject::invokeMethod(_writer, "write", Qt::QueuedConnection,
+                                     Q_ARG(quint32, _downloadData->write_offset),
+                                     Q_ARG(QByteArray, _downloadData->write_buffer));
+    _downloadData->write_buffer.clear();
 }
 
-bool MAVLinkLogController::_chunkComplete() const
+void MAVLinkLogController::_saveLogState()
 {
-    return _downloadData->chunkEquals(true);
+    _flushLogData();
+    (void) QMetaObject::invokeMethod(_writer, "saveState", Qt::QueuedConnection,
+                                     Q_ARG(QString, _downloadData->stateFileName()),
+                                     Q_ARG(QByteArray, _downloadData->saveState()));
+    _downloadData->last_state_save.start();
 }
 
-bool MAVLinkLogController::_logComplete() const
+void MAVLinkLogController::_closeLogDownload()
 {
-    return (_chunkComplete() && ((_downloadData->current_chunk + 1) == _downloadData->numChunks()));
+    if (!_downloadData || _downloadData->finishing) {
+        return;
+    }
+
+    // Blocks until the writer is done so the state is on disk before the log can be downloaded again
+    if (_downloadData->received_bins > 0) {
+        _saveLogState();
+        (void) QMetaObject::invokeMethod(_writer, "close", Qt::BlockingQueuedConnection);
+    } else {
+        (void) QMetaObject::invokeMethod(_writer, "discard", Qt::BlockingQueuedConnection,
+                                         Q_ARG(QString, _downloadData->file_path),
+                                         Q_ARG(QString, _downloadData->stateFileName()));
+    }
+}
+
+void MAVLinkLogController::_writerError(const QString &fileName, const QString &errorString)
+{
+    if (!_downloadData || (fileName != _downloadData->file_path)) {
+        return;
+    }
+
+    qCWarning(MAVLinkLogControllerLog) << "Error while writing log file" << _downloadData->filename << errorString;
+    _downloadData->entry->setStatus(tr("Error"));
+    (void) QMetaObject::invokeMethod(_writer, "close", Qt::QueuedConnection);
+    _downloadData.reset();
+
+    _receivedAllData();
+}
+
+void MAVLinkLogController::_writerFinished(const QString &fileName, bool success)
+{
+    if (!_downloadData || !_downloadData->finishing || (fileName != _downloadData->file_path)) {
+        return;
+    }
+
+    qCDebug(MAVLinkLogControllerLog) << "Downloaded" << _downloadData->filename << _statistics.bytesReceived << "bytes in"
+                                     << _statistics.elapsedMs << "ms," << _statistics.requests << "requests";
+    _downloadData->entry->setStatus(success ? tr("Downloaded") : tr("Error"));
+
+    _receivedAllData();
 }
 
 void MAVLinkLogController::_receivedAllData()
 {
     _timer->stop();
-    if (_prepareLogDownload()) {
-        _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size() * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-        _timer->start(kTimeOutMs);
-    } else {
+    if (!_prepareLogDownload()) {
         _resetSelection();
         _setDownloading(false);
+        return;
+    }
+
+    (void) QMetaObject::invokeMethod(_writer, "open", Qt::QueuedConnection, Q_ARG(QString, _downloadData->file_path));
+    if (_downloadData->complete()) {
+        _downloadData->finishing = true;
+        (void) QMetaObject::invokeMethod(_writer, "finish", Qt::QueuedConnection, Q_ARG(QString, _downloadData->stateFileName()));
+    } else {
+        _requestMissingData();
     }
 }
 
@@ -401,40 +485,86 @@ bool MAVLinkLogController::_prepareLogDownload()
         _downloadData->filename += ".bin";
     }
 
-    _downloadData->file.setFileName(_downloadPath + _downloadData->filename);
-
-    if (_downloadData->file.exists()) {
-        uint32_t numDups = 0;
-        const QStringList filename_spl = _downloadData->filename.split('.');
-        do {
-            numDups += 1;
-            const QString filename = filename_spl[0] + '_' + QString::number(numDups) + '.' + filename_spl[1];
-            _downloadData->file.setFileName(filename);
-        } while ( _downloadData->file.exists());
-    }
+    _statistics = Statistics_t();
+    emit downloadRateChanged();
 
+    // An interrupted download of the log continues in its file, other existing files are kept
     bool result = false;
-    if (!_downloadData->file.open(QIODevice::WriteOnly)) {
-        qCWarning(MAVLinkLogControllerLog) << "Failed to create log file:" <<  _downloadData->filename;
-    } else if (!_downloadData->file.resize(entry->size())) {
-        qCWarning(MAVLinkLogControllerLog) << "Failed to allocate space for log file:" <<  _downloadData->filename;
-    } else {
-        _downloadData->current_chunk = 0;
-        _downloadData->chunk_table = QBitArray(_downloadData->chunkBins(), false);
-        _downloadData->elapsed.start();
-        result = true;
+    _downloadData->file_path = _downloadPath + _downloadData->filename;
+    uint32_t numDups = 0;
+    const QStringList filename_spl = _downloadData->filename.split('.');
+    while (QFile::exists(_downloadData->file_path)) {
+        if (_resumeLogDownload(_downloadData->file_path)) {
+            result = true;
+            break;
+        }
+
+        numDups += 1;
+        const QString filename = filename_spl[0] + '_' + QString::number(numDups) + '.' + filename_spl[1];
+        _downloadData->file_path = _downloadPath + filename;
     }
 
     if (!result) {
-        if (_downloadData->file.exists()) {
-            (void) _downloadData->file.remove();
+        QFile file(_downloadData->file_path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCWarning(MAVLinkLogControllerLog) << "Failed to create log file:" <<  _downloadData->filename;
+        } else if (!file.resize(entry->size())) {
+            qCWarning(MAVLinkLogControllerLog) << "Failed to allocate space for log file:" <<  _downloadData->filename;
+            file.close();
+            (void) file.remove();
+        } else {
+            _downloadData->bin_table = QBitArray(_downloadData->numBins(), false);
+            result = true;
         }
+    }
 
+    if (!result) {
         _downloadData->entry->setStatus(QStringLiteral("Error"));
         _downloadData.reset();
+        return false;
+    }
+
+    _downloadData->elapsed.start();
+    _downloadData->last_status.start();
+    _downloadData->last_state_save.start();
+
+    return true;
+}
+
+bool MAVLinkLogController::_resumeLogDownload(const QString &filePath)
+{
+    const QString stateFileName = filePath + MAVLinkLogDownloadData::kStateFileSuffix;
+    if (!QFile::exists(stateFileName)) {
+        return false;
+    }
+
+    if (QFileInfo(filePath).size() != _downloadData->entry->size()) {
+        qCDebug(MAVLinkLogControllerLog) << "Log file does not match its download state" << filePath;
+        return false;
+    }
+
+    QFile stateFile(stateFileName);
+    if (!stateFile.open(QIODevice::ReadOnly)) {
+        qCWarning(MAVLinkLogControllerLog) << "Failed to read download state" << stateFileName << stateFile.errorString();
+        return false;
+    }
+
+    if (!_downloadData->restoreState(stateFile.readAll())) {
+        return false;
     }
 
-    return result;
+    // All bins are full size but the last one
+    quint64 resumed = static_cast<quint64>(_downloadData->received_bins) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    if (!_downloadData->bin_table.isEmpty() && _downloadData->bin_table.testBit(_downloadData->bin_table.size() - 1)) {
+        resumed -= (static_cast<quint64>(_downloadData->numBins()) * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) - _downloadData->entry->size();
+    }
+    _downloadData->written = static_cast<uint>(resumed);
+    _downloadData->last_status_written = _downloadData->written;
+    _statistics.bytesResumed = static_cast<qint64>(resumed);
+
+    qCDebug(MAVLinkLogControllerLog) << "Resuming download of" << _downloadData->filename << "with" << resumed << "of" << _downloadData->entry->size() << "bytes";
+
+    return true;
 }
 
 void MAVLinkLogController::refresh()
@@ -467,10 +597,7 @@ void MAVLinkLogController::cancel()
 
     if (_downloadData) {
         _downloadData->entry->setStatus(QStringLiteral("Canceled"));
-        if (_downloadData->file.exists()) {
-            (void) _downloadData->file.remove();
-        }
-
+        _closeLogDownload();
         _downloadData.reset();
     }
 
@@ -7,6 +7,7 @@
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogControllerLog)
 
 struct MAVLinkLogDownloadData;
+class MAVLinkLogDownloadWriter;
 class QGCMAVLinkLogEntry;
 class QmlObjectListModel;
 class QTimer;
@@ -14,6 +15,11 @@ class QThread;
 class Vehicle;
 class MAVLinkLogDownloadTest;
 
+/// Lists and downloads the onboard logs of the active vehicle.
+/// Received data is tracked per LOG_DATA bin over the whole log. The remaining log is requested as one range and
+/// what is still missing once the vehicle reaches the end of the range is requested again, nearby gaps together.
+/// Data is written by MAVLinkLogDownloadWriter on a worker thread, which also keeps a state file next to the log
+/// so an interrupted download continues where it stopped.
 class MAVLinkLogController : public QObject
 {
     Q_OBJECT
@@ -27,6 +33,7 @@ class MAVLinkLogController : public QObject
     Q_PROPERTY(bool               compressLogs    READ compressLogs         WRITE setCompressLogs NOTIFY compressLogsChanged)
     Q_PROPERTY(bool               compressing     READ compressing          NOTIFY compressingChanged)
     Q_PROPERTY(float              compressionProgress READ compressionProgress NOTIFY compressionProgressChanged)
+    Q_PROPERTY(double             downloadRate    READ downloadRate         NOTIFY downloadRateChanged)   ///< Bytes per second of the current or last log download
 
     friend class MAVLinkLogDownloadTest;
 
@@ -43,6 +50,20 @@ class MAVLinkLogController : public QObject
     void setCompressLogs(bool compress);
     bool compressing() const { return _compressing; }
     float compressionProgress() const { return _compressionProgress; }
+    double downloadRate() const { return _statistics.bytesPerSecond; }
+
+    struct Statistics_t {
+        qint64  bytesReceived   = 0;    ///< Log data received by the current or last log download
+        qint64  bytesDuplicate  = 0;    ///< Log data received more than once
+        qint64  bytesResumed    = 0;    ///< Log data kept from an interrupted download
+        qint64  elapsedMs       = 0;
+        double  bytesPerSecond  = 0;
+        int     requests        = 0;    ///< LOG_REQUEST_DATA ranges sent
+        int     retries         = 0;    ///< Ranges sent again after the vehicle stopped sending
+    };
+
+    /// @return Statistics of the current or last log download
+    Statistics_t statistics() const { return _statistics; }
 
     /// Compress a single log file
     Q_INVOKABLE bool compressLogFile(const QString &logPath);
@@ -58,6 +79,7 @@ class MAVLinkLogController : public QObject
     void compressingChanged();
     void compressionProgressChanged();
     void compressionComplete(const QString &outputPath, const QString &error);
+    void downloadRateChanged();
 
 private slots:
     void _setActiveVehicle(Vehicle *vehicle);
@@ -66,18 +88,22 @@ private slots:
     void _processDownload();
     void _handleCompressionProgress(qreal progress);
     void _handleCompressionFinished(bool success);
+    void _writerError(const QString &fileName, const QString &errorString);
+    void _writerFinished(const QString &fileName, bool success);
 
 private:
     QmlObjectListModel *_getModel() const { return _logEntriesModel; }
     bool _getRequestingList() const { return _requestingLogEntries; }
     bool _getDownloadingLogs() const { return _downloadingLogs; }
 
-    bool _chunkComplete() const;
     bool _entriesComplete() const;
-    bool _logComplete() const;
     bool _prepareLogDownload();
+    /// @return true if the log download can continue from the state file next to @a filePath
+    bool _resumeLogDownload(const QString &filePath);
     void _downloadToDirectory(const QString &dir);
     void _findMissingData();
+    /// Requests the first missing bins, nearby runs of missing bins are requested as one range
+    void _requestMissingData();
     void _findMissingEntries();
     void _receivedAllData();
     void _receivedAllEntries();
@@ -87,11 +113,18 @@ private slots:
     void _resetSelection(bool canceled = false);
     void _setDownloading(bool active);
     void _setListing(bool active);
-    void _updateDataRate();
+    void _updateDataRate(bool force = false);
+    /// Queues the buffered log data to the writer
+    void _flushLogData();
+    void _saveLogState();
+    /// Stops writing the log being downloaded, a partial log is kept with its state so the download can resume
+    void _closeLogDownload();
 
     QGCMAVLinkLogEntry *_getNextSelected() const;
 
     QTimer *_timer = nullptr;
+    QThread *_writerThread = nullptr;
+    MAVLinkLogDownloadWriter *_writer = nullptr;
     QmlObjectListModel *_logEntriesModel = nullptr;
 
     bool _downloadingLogs = false;
@@ -104,8 +137,12 @@ private slots:
     bool _compressLogs = false;
     bool _compressing = false;
     float _compressionProgress = 0.0F;
+    Statistics_t _statistics;
 
     static constexpr uint32_t kTimeOutMs = 500;
     static constexpr uint32_t kGUIRateMs = 500; ///< Update download rate twice per second
     static constexpr uint32_t kRequestLogListTimeoutMs = 5000;
+    static constexpr uint32_t kStateSaveMs = 2000;          ///< Interval the download state is saved at
+    static constexpr int kWriteBatchSize = 64 * 1024;       ///< Log data queued to the writer at once
+    static constexpr uint32_t kMissingBinsMergeGap = 8;     ///< Received bins requested again rather than sending another range
 };
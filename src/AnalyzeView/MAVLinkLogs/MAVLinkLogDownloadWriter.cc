@@ -0,0 +1,103 @@
+#include "MAVLinkLogDownloadWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QSaveFile>
+
+QGC_LOGGING_CATEGORY(MAVLinkLogDownloadWriterLog, "AnalyzeView.MAVLinkLogDownloadWriter")
+
+MAVLinkLogDownloadWriter::MAVLinkLogDownloadWriter(QObject *parent)
+    : QObject(parent)
+{
+    // qCDebug(MAVLinkLogDownloadWriterLog) << Q_FUNC_INFO << this;
+}
+
+MAVLinkLogDownloadWriter::~MAVLinkLogDownloadWriter()
+{
+    close();
+
+    // qCDebug(MAVLinkLogDownloadWriterLog) << Q_FUNC_INFO << this;
+}
+
+void MAVLinkLogDownloadWriter::open(const QString &fileName)
+{
+    close();
+
+    _failed = false;
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadWrite)) {
+        _fail(_file.errorString());
+        return;
+    }
+
+    qCDebug(MAVLinkLogDownloadWriterLog) << "Opened" << fileName;
+}
+
+void MAVLinkLogDownloadWriter::write(quint32 offset, const QByteArray &data)
+{
+    if (_failed || !_file.isOpen()) {
+        return;
+    }
+
+    if ((_file.pos() != offset) && !_file.seek(offset)) {
+        _fail(_file.errorString());
+        return;
+    }
+
+    if (_file.write(data) != data.size()) {
+        _fail(_file.errorString());
+    }
+}
+
+void MAVLinkLogDownloadWriter::saveState(const QString &stateFileName, const QByteArray &state)
+{
+    if (_failed || !_file.isOpen()) {
+        return;
+    }
+
+    // The state must not claim data which is still buffered
+    if (!_file.flush()) {
+        _fail(_file.errorString());
+        return;
+    }
+
+    QSaveFile stateFile(stateFileName);
+    if (!stateFile.open(QIODevice::WriteOnly) || (stateFile.write(state) != state.size()) || !stateFile.commit()) {
+        qCWarning(MAVLinkLogDownloadWriterLog) << "Failed to save download state" << stateFileName << stateFile.errorString();
+    }
+}
+
+void MAVLinkLogDownloadWriter::finish(const QString &stateFileName)
+{
+    const QString fileName = _file.fileName();
+    const bool success = !_failed && _file.isOpen() && _file.flush();
+    close();
+
+    if (success) {
+        (void) QFile::remove(stateFileName);
+    }
+
+    qCDebug(MAVLinkLogDownloadWriterLog) << "Finished" << fileName << success;
+    emit finished(fileName, success);
+}
+
+void MAVLinkLogDownloadWriter::close()
+{
+    if (_file.isOpen()) {
+        _file.close();
+    }
+}
+
+void MAVLinkLogDownloadWriter::discard(const QString &fileName, const QString &stateFileName)
+{
+    close();
+
+    (void) QFile::remove(fileName);
+    (void) QFile::remove(stateFileName);
+}
+
+void MAVLinkLogDownloadWriter::_fail(const QString &errorString)
+{
+    _failed = true;
+    qCWarning(MAVLinkLogDownloadWriterLog) << "Error writing log file" << _file.fileName() << errorString;
+    emit errorOccurred(_file.fileName(), errorString);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogDownloadWriterLog)
+
+/// Writes downloaded log data to disk. Lives on the worker thread of MAVLinkLogController, which queues the data
+/// of the log being downloaded in batches. Calls are handled in the order they were queued, so a state file saved
+/// by saveState() never claims data which is not written yet.
+class MAVLinkLogDownloadWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MAVLinkLogDownloadWriter(QObject *parent = nullptr);
+    ~MAVLinkLogDownloadWriter();
+
+public slots:
+    /// Opens the existing @a fileName for writing, a file still open is closed first
+    void open(const QString &fileName);
+    void write(quint32 offset, const QByteArray &data);
+    /// Replaces @a stateFileName with @a state, see MAVLinkLogDownloadData::saveState()
+    void saveState(const QString &stateFileName, const QByteArray &state);
+    /// Closes the file, removing @a stateFileName since the log is complete. Emits finished().
+    void finish(const QString &stateFileName);
+    /// Closes the file, keeping it and its state file so the download can resume
+    void close();
+    /// Closes and removes @a fileName and @a stateFileName
+    void discard(const QString &fileName, const QString &stateFileName);
+
+signals:
+    void errorOccurred(const QString &fileName, const QString &errorString);
+    void finished(const QString &fileName, bool success);
+
+private:
+    void _fail(const QString &errorString);
+
+    QFile _file;
+    bool _failed = false;
+};
@@ -2,7 +2,7 @@
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
 
-#include <QtCore/QtMath>
+#include <QtCore/QDataStream>
 
 QGC_LOGGING_CATEGORY(MAVLinkLogEntryLog, "AnalyzeView.QGCMAVLinkLogEntry")
 
@@ -18,27 +18,92 @@ MAVLinkLogDownloadData::~MAVLinkLogDownloadData()
     // qCDebug(MAVLinkLogEntryLog) << Q_FUNC_INFO << this;
 }
 
-void MAVLinkLogDownloadData::advanceChunk()
+uint32_t MAVLinkLogDownloadData::numBins() const
 {
-    ++current_chunk;
-    chunk_table = QBitArray(chunkBins(), false);
+    return static_cast<uint32_t>((static_cast<quint64>(entry->size()) + MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN - 1) / MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
 }
 
-uint32_t MAVLinkLogDownloadData::chunkBins() const
+bool MAVLinkLogDownloadData::setReceived(uint32_t bin)
 {
-    const qreal num = static_cast<qreal>((entry->size() - (current_chunk * kChunkSize))) / static_cast<qreal>(MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
-    return qMin(static_cast<uint32_t>(qCeil(num)), kTableBins);
+    if (bin_table.testBit(bin)) {
+        return false;
+    }
+
+    bin_table.setBit(bin);
+    received_bins++;
+    return true;
 }
 
-uint32_t MAVLinkLogDownloadData::numChunks() const
+bool MAVLinkLogDownloadData::nextMissingBins(uint32_t fromBin, uint32_t &start, uint32_t &end) const
 {
-    const qreal num = static_cast<qreal>(entry->size()) / static_cast<qreal>(kChunkSize);
-    return qCeil(num);
+    const uint32_t size = static_cast<uint32_t>(bin_table.size());
+    const uchar *const bytes = reinterpret_cast<const uchar*>(bin_table.bits());
+
+    // Whole bytes of received bins are skipped at once, logs of several GB have millions of bins
+    start = fromBin;
+    while (start < size) {
+        if (((start % 8) == 0) && (bytes[start / 8] == 0xFF)) {
+            start += 8;
+        } else if (bin_table.testBit(start)) {
+            start++;
+        } else {
+            break;
+        }
+    }
+    if (start >= size) {
+        return false;
+    }
+
+    end = start + 1;
+    while (end < size) {
+        if (((end % 8) == 0) && (bytes[end / 8] == 0x00) && ((end + 8) <= size)) {
+            end += 8;
+        } else if (!bin_table.testBit(end)) {
+            end++;
+        } else {
+            break;
+        }
+    }
+
+    return true;
 }
 
-bool MAVLinkLogDownloadData::chunkEquals(const bool val) const
+QByteArray MAVLinkLogDownloadData::saveState() const
 {
-    return (chunk_table == QBitArray(chunk_table.size(), val));
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << kStateMagic << kStateVersion << static_cast<quint32>(ID) << static_cast<quint32>(entry->size())
+           << static_cast<qint64>(entry->time().toSecsSinceEpoch()) << bin_table;
+    return state;
+}
+
+bool MAVLinkLogDownloadData::restoreState(const QByteArray &state)
+{
+    QDataStream stream(state);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 id = 0;
+    quint32 size = 0;
+    qint64 time = 0;
+    QBitArray table;
+    stream >> magic >> version >> id >> size >> time >> table;
+
+    if ((stream.status() != QDataStream::Ok) || (magic != kStateMagic) || (version != kStateVersion)) {
+        qCDebug(MAVLinkLogEntryLog) << "Invalid download state of log" << ID;
+        return false;
+    }
+
+    if ((id != ID) || (size != entry->size()) || (time != entry->time().toSecsSinceEpoch()) || (static_cast<uint32_t>(table.size()) != numBins())) {
+        qCDebug(MAVLinkLogEntryLog) << "Download state belongs to a different log" << id << size << time;
+        return false;
+    }
+
+    bin_table = table;
+    received_bins = static_cast<uint32_t>(bin_table.count(true));
+    return true;
 }
 
 /*===========================================================================*/
@@ -19,32 +19,51 @@ struct MAVLinkLogDownloadData
     explicit MAVLinkLogDownloadData(QGCMAVLinkLogEntry * const logEntry);
     ~MAVLinkLogDownloadData();
 
-    void advanceChunk();
+    /// The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the log
+    uint32_t numBins() const;
 
-    /// The number of MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN bins in the current chunk
-    uint32_t chunkBins() const;
+    /// Marks @a bin as received
+    ///     @return false if it was received before
+    bool setReceived(uint32_t bin);
 
-    /// The number of kChunkSize chunks in the file
-    uint32_t numChunks() const;
+    bool complete() const { return (received_bins == static_cast<uint32_t>(bin_table.size())); }
 
-    /// True if all bins in the chunk have been set to val
-    bool chunkEquals(const bool val) const;
+    /// Finds the first run of missing bins at or after @a fromBin
+    ///     @param start First missing bin of the run
+    ///     @param end Bin after the last missing bin of the run
+    ///     @return false if no bin at or after @a fromBin is missing
+    bool nextMissingBins(uint32_t fromBin, uint32_t &start, uint32_t &end) const;
+
+    /// Download state of the log, written next to the log file so an interrupted download can resume
+    QByteArray saveState() const;
+
+    /// Restores the received bins from @a state
+    ///     @return false if @a state is not the state of this log
+    bool restoreState(const QByteArray &state);
+
+    QString stateFileName() const { return file_path + kStateFileSuffix; }
 
     uint ID = 0;
     QGCMAVLinkLogEntry *const entry = nullptr;
 
-    QBitArray chunk_table;
-    uint32_t current_chunk = 0;
-    QFile file;
+    QBitArray bin_table;                ///< Received bins of the whole log
+    uint32_t received_bins = 0;
+    uint32_t request_start = 0;         ///< Bins of the range requested last
+    uint32_t request_end = 0;
+    QString file_path;
     QString filename;
-    uint written = 0;
+    QByteArray write_buffer;            ///< Received data not yet queued to the writer, contiguous from write_offset
+    uint32_t write_offset = 0;
+    bool finishing = false;             ///< All data received, waiting for the writer to close the file
+    uint written = 0;                   ///< Bytes of the log on disk or queued to the writer
     uint last_status_written = 0;
-    size_t rate_bytes = 0;
-    qreal rate_avg = 0.;
-    QElapsedTimer elapsed;
+    QElapsedTimer elapsed;              ///< Since the download started
+    QElapsedTimer last_status;
+    QElapsedTimer last_state_save;
 
-    static constexpr uint32_t kTableBins = 2048;  // 2048 packets = ~180 KB chunks (4x larger for better throughput)
-    static constexpr uint32_t kChunkSize = kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    static constexpr const char *kStateFileSuffix = ".state";
+    static constexpr quint32 kStateMagic = 0x53444C51;     ///< "QLDS"
+    static constexpr quint32 kStateVersion = 1;
 };
 
 /*===========================================================================*/
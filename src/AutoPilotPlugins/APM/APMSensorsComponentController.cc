@@ -656,10 +656,12 @@ void APMSensorsComponentController::_handleCommandLong(const mavlink_message_t &
     }
 }
 
-void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface *link, const mavlink_message_t &message)
+void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface *link, const MAVLinkMessageRef &sharedMessage)
 {
     Q_UNUSED(link);
 
+    const mavlink_message_t &message = *sharedMessage;
+
     if (message.sysid != _vehicle->id()) {
         return;
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FactPanelController.h"
+#include "MAVLinkMessagePool.h"
 #include "QGCMAVLink.h"
 
 #include <QtCore/QLoggingCategory>
@@ -116,7 +117,7 @@ class APMSensorsComponentController : public FactPanelController
 
 private slots:
     void _handleTextMessage(int sysid, int componentid, int severity, const QString &text, const QString &description);
-    void _mavlinkMessageReceived(LinkInterface *link, const mavlink_message_t &message);
+    void _mavlinkMessageReceived(LinkInterface *link, const MAVLinkMessageRef &sharedMessage);
     void _mavCommandResult(int vehicleId, int component, int command, int result, int failureCode);
 
 private:
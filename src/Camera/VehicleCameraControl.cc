@@ -2113,6 +2113,7 @@ void VehicleCameraControl::_handleDefinitionFile(const QString &url)
             _modelName.toStdString().c_str(),
             ver,
             ext.toStdString().c_str());
+        _ftpCompID = FTPManager::componentIdForURI(static_cast<uint8_t>(_compID), url);
         connect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &VehicleCameraControl::_ftpDownloadComplete);
         _vehicle->ftpManager()->download(_compID, url,
             SettingsManager::instance()->appSettings()->parameterSavePath().toStdString().c_str(),
@@ -2183,8 +2184,13 @@ void VehicleCameraControl::_downloadFinished()
     //reply->deleteLater();
 }
 
-void VehicleCameraControl::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+void VehicleCameraControl::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg, uint8_t compId)
 {
+    if (compId != _ftpCompID) {
+        // Another component's transfer
+        return;
+    }
+
     qCDebug(CameraControlLog) << "FTP Download completed: " << fileName << ", " << errorMsg;
 
     disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &VehicleCameraControl::_ftpDownloadComplete);
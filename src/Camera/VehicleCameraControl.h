@@ -239,7 +239,7 @@ protected slots:
     void    _updateRanges                   (Fact* pFact);
     void    _httpRequest                    (const QString& url);
     void    _handleDefinitionFile           (const QString& url);
-    void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg);
+    void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg, uint8_t compId);
 
     QStringList     _loadExclusions         (QDomNode option);
     QStringList     _loadUpdates            (QDomNode option);
@@ -247,6 +247,7 @@ protected slots:
 
 protected:
     int                                 _compID             = 0;
+    uint8_t                             _ftpCompID          = 0;    ///< Component the definition file download runs on
     mavlink_camera_information_t        _mavlinkCameraInfo;
     int                                 _version            = 0;
     bool                                _cached             = false;
@@ -1,5 +1,6 @@
 #include "LinkInterface.h"
 #include "LinkManager.h"
+#include "MAVLinkProtocol.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
 #include "MAVLinkSigning.h"
@@ -13,6 +14,7 @@ QGC_LOGGING_CATEGORY(LinkInterfaceLog, "Comms.LinkInterface")
 LinkInterface::LinkInterface(SharedLinkConfigurationPtr &config, QObject *parent)
     : QObject(parent)
     , _config(config)
+    , _threadedParsing(SettingsManager::instance()->mavlinkSettings()->threadedMavlinkParsing()->rawValue().toBool())
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
@@ -45,14 +47,18 @@ bool LinkInterface::initMavlinkSigning()
     if (!isSecureConnection()) {
         auto mavlinkSettings = SettingsManager::instance()->mavlinkSettings();
         const QByteArray signingKeyBytes = mavlinkSettings->mavlink2SigningKey()->rawValue().toByteArray();
-        if (MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(_mavlinkChannel), signingKeyBytes, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback)) {
+        const mavlink_channel_t channel = static_cast<mavlink_channel_t>(_mavlinkChannel.load());
+        if (MAVLinkSigning::initSigning(channel, signingKeyBytes, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback)) {
+            // The parsing thread checks incoming signatures against its own copy, the channel signing is only used for sending
+            const mavlink_status_t *const status = mavlink_get_channel_status(channel);
+            _framer.setSigning(status ? status->signing : nullptr);
             if (signingKeyBytes.isEmpty()) {
-                qCDebug(LinkInterfaceLog) << "Signing disabled on channel" << _mavlinkChannel;
+                qCDebug(LinkInterfaceLog) << "Signing disabled on channel" << _mavlinkChannel.load();
             } else {
-                qCDebug(LinkInterfaceLog) << "Signing enabled on channel" << _mavlinkChannel;
+                qCDebug(LinkInterfaceLog) << "Signing enabled on channel" << _mavlinkChannel.load();
             }
         } else {
-            qCWarning(LinkInterfaceLog) << "Failed To enable Signing on channel" << _mavlinkChannel;
+            qCWarning(LinkInterfaceLog) << "Failed To enable Signing on channel" << _mavlinkChannel.load();
             // FIXME: What should we do here?
             return false;
         }
@@ -66,7 +72,7 @@ bool LinkInterface::_allocateMavlinkChannel()
     Q_ASSERT(!mavlinkChannelIsSet());
 
     if (mavlinkChannelIsSet()) {
-        qCWarning(LinkInterfaceLog) << "already have" << _mavlinkChannel;
+        qCWarning(LinkInterfaceLog) << "already have" << _mavlinkChannel.load();
         return true;
     }
 
@@ -77,7 +83,7 @@ bool LinkInterface::_allocateMavlinkChannel()
         return false;
     }
 
-    qCDebug(LinkInterfaceLog) << "_allocateMavlinkChannel" << _mavlinkChannel;
+    qCDebug(LinkInterfaceLog) << "_allocateMavlinkChannel" << _mavlinkChannel.load();
 
     mavlink_set_proto_version(_mavlinkChannel, MAVLINK_VERSION); // We only support v2 protcol
     initMavlinkSigning();
@@ -85,9 +91,26 @@ bool LinkInterface::_allocateMavlinkChannel()
     return true;
 }
 
+QVariantList LinkInterface::lossStatistics() const
+{
+    QVariantList result;
+    result.reserve(_lossStatistics.size());
+    for (const MAVLinkLossStats &stats : _lossStatistics) {
+        result.append(stats.toVariantMap());
+    }
+
+    return result;
+}
+
+void LinkInterface::setLossStatistics(const QList<MAVLinkLossStats> &statistics)
+{
+    _lossStatistics = statistics;
+    emit lossStatisticsChanged();
+}
+
 void LinkInterface::_freeMavlinkChannel()
 {
-    qCDebug(LinkInterfaceLog) << _mavlinkChannel;
+    qCDebug(LinkInterfaceLog) << _mavlinkChannel.load() << "message buffer allocations avoided:" << _framer.allocationsAvoided();
 
     if (!mavlinkChannelIsSet()) {
         return;
@@ -103,6 +126,39 @@ void LinkInterface::writeBytesThreadSafe(const char *bytes, int length)
     (void) QMetaObject::invokeMethod(this, "_writeBytes", Qt::AutoConnection, data);
 }
 
+qsizetype LinkInterface::frameBytes(QByteArrayView data, MAVLinkMessageBatch &batch)
+{
+    if (!mavlinkChannelIsSet()) {
+        // Channel was already freed by a disconnect, late data is dropped
+        return 0;
+    }
+
+    // The framer keeps its own parser and signing state, so a channel freed or re-signed
+    // by the main thread while this runs does not touch the frame being parsed
+    return _framer.frame(data, batch);
+}
+
+void LinkInterface::_workerBytesReceived(const QByteArray &data)
+{
+    if (!_threadedParsing) {
+        emit bytesReceived(this, data);
+        return;
+    }
+
+    auto batch = std::make_unique<MAVLinkMessageBatch>();
+    if ((frameBytes(data, *batch) == 0) && !batch->mavlinkV1Traffic) {
+        return;
+    }
+
+    MAVLinkProtocol *const protocol = MAVLinkProtocol::instance();
+    if (!protocol) {
+        return;
+    }
+
+    batch->link = weak_from_this();
+    protocol->enqueueMessageBatch(batch.release());
+}
+
 void LinkInterface::removeVehicleReference()
 {
     if (_vehicleReferenceCount != 0) {
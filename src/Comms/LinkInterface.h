@@ -3,18 +3,23 @@
 #include <QtCore/QLoggingCategory>
 #include <QtQmlIntegration/QtQmlIntegration>
 
+#include <atomic>
+#include <memory>
+
 #include "LinkConfiguration.h"
+#include "MAVLinkIngest.h"
 
 class LinkManager;
 
 Q_DECLARE_LOGGING_CATEGORY(LinkInterfaceLog)
 
 /// The link interface defines the interface for all links used to communicate with the ground station application.
-class LinkInterface : public QObject
+class LinkInterface : public QObject, public std::enable_shared_from_this<LinkInterface>
 {
     Q_OBJECT
     QML_ELEMENT
     QML_UNCREATABLE("")
+    Q_PROPERTY(QVariantList lossStatistics READ lossStatistics NOTIFY lossStatisticsChanged)
     friend class LinkManager;
 
 public:
@@ -39,12 +44,28 @@ class LinkInterface : public QObject
     void setSigningSignatureFailure(bool failure);
     void reportMavlinkV1Traffic();
 
+    /// Frames @a data using this link's MAVLink parser state and loss counters.
+    /// The parser state is owned by the link rather than shared through the global channel status,
+    /// see MAVLinkFramer. For a given link this must always be called from the same thread.
+    ///     @return Number of messages appended to @a batch
+    qsizetype frameBytes(QByteArrayView data, MAVLinkMessageBatch &batch);
+
+    /// Thread safe. Clears the receive/loss counters before the next frame is parsed.
+    void resetMavlinkStatistics() { _framer.requestReset(); }
+
+    /// Latest per source sequence loss statistics, see MAVLinkLossStats::toVariantMap for the entries
+    QVariantList lossStatistics() const;
+    const QList<MAVLinkLossStats> &lossStatisticsList() const { return _lossStatistics; }
+    /// Called on the main thread with each snapshot published by the link's framer
+    void setLossStatistics(const QList<MAVLinkLossStats> &statistics);
+
 signals:
     void bytesReceived(LinkInterface *link, const QByteArray &data);
     void bytesSent(LinkInterface *link, const QByteArray &data);
     void connected();
     void disconnected();
     void communicationError(const QString &title, const QString &error);
+    void lossStatisticsChanged();
 
 protected:
     /// Links are only created by LinkManager so constructor is not public
@@ -58,6 +79,11 @@ class LinkInterface : public QObject
 
     void _connectionRemoved();
 
+    /// Delivers bytes read by the link worker thread. Must be called directly from the worker thread.
+    /// In threaded parsing mode the bytes are framed right here and queued to MAVLinkProtocol as decoded
+    /// message batches, otherwise they are forwarded through bytesReceived for parsing on the main thread.
+    void _workerBytesReceived(const QByteArray &data);
+
     SharedLinkConfigurationPtr _config;
 
 private slots:
@@ -68,11 +94,14 @@ private slots:
     /// connect is private since all links should be created through LinkManager::createConnectedLink calls
     virtual bool _connect() = 0;
 
-    uint8_t _mavlinkChannel = std::numeric_limits<uint8_t>::max();
+    std::atomic<uint8_t> _mavlinkChannel{std::numeric_limits<uint8_t>::max()};   ///< Read from the worker thread by frameBytes
+    MAVLinkFramer _framer;                                                      ///< Only touched from the parsing thread, except for requestReset/setSigning
+    const bool _threadedParsing = true;                                         ///< Snapshot of MavlinkSettings::threadedMavlinkParsing at creation
     bool _decodedFirstMavlinkPacket = false;
     int _vehicleReferenceCount = 0;
     bool _signingSignatureFailure = false;
     bool _mavlinkV1TrafficReported = false;
+    QList<MAVLinkLossStats> _lossStatistics;                                    ///< Main thread copy of the latest framer snapshot
 };
 
 typedef std::shared_ptr<LinkInterface> SharedLinkInterfacePtr;
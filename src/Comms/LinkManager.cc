@@ -735,10 +735,11 @@ void LinkManager::freeMavlinkChannel(uint8_t channel)
     _mavlinkChannelsUsedBitMask &= ~(1 << channel);
 }
 
-LogReplayLink *LinkManager::startLogReplay(const QString &logFile)
+LogReplayLink *LinkManager::startLogReplay(const QString &logFile, bool asFastAsPossible)
 {
     LogReplayConfiguration* const linkConfig = new LogReplayConfiguration(tr("Log Replay"));
     linkConfig->setLogFilename(logFile);
+    linkConfig->setAsFastAsPossible(asFastAsPossible);
     linkConfig->setName(linkConfig->logFilenameShort());
 
     SharedLinkConfigurationPtr sharedConfig = addConfiguration(linkConfig);
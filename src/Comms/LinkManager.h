@@ -63,7 +63,7 @@ class LinkManager : public QObject
     Q_INVOKABLE void createMavlinkForwardingSupportLink();
     /// Called to signal app shutdown. Disconnects all links while turning off auto-connect.
     Q_INVOKABLE void shutdown();
-    Q_INVOKABLE LogReplayLink *startLogReplay(const QString &logFile);
+    Q_INVOKABLE LogReplayLink *startLogReplay(const QString &logFile, bool asFastAsPossible = false);
 
     QList<SharedLinkInterfacePtr> links();
     QStringList linkTypeStrings() const;
@@ -0,0 +1,281 @@
+#include "LogReplayIndex.h"
+#include "MAVLinkLib.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(LogReplayIndexLog, "Comms.LogReplayIndex")
+
+LogReplayIndex::~LogReplayIndex()
+{
+    close();
+}
+
+bool LogReplayIndex::open(const QString &fileName, bool useCache)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        _errorString = _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = (_size > 0) ? _file.map(0, _size) : nullptr;
+    if (!_data) {
+        _errorString = (_size > 0) ? _file.errorString() : QStringLiteral("Log file is empty");
+        _file.close();
+        _size = 0;
+        return false;
+    }
+
+    _nowUSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString cacheFile = cacheFileName(fileName);
+    if (useCache && _loadCache(cacheFile)) {
+        _loadedFromCache = true;
+    } else {
+        (void) _build();
+        if (useCache && (_recordCount > 0)) {
+            _saveCache(cacheFile);
+        }
+    }
+
+    qCDebug(LogReplayIndexLog) << fileName << "records" << _recordCount << "index entries" << _indexOffsets.size()
+                               << (_loadedFromCache ? "loaded in" : "built in") << timer.elapsed() << "ms";
+
+    return true;
+}
+
+void LogReplayIndex::close()
+{
+    if (_data) {
+        (void) _file.unmap(_data);
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+
+    _size = 0;
+    _errorString.clear();
+    _indexTimestamps.clear();
+    _indexOffsets.clear();
+    _startTimeUSecs = 0;
+    _endTimeUSecs = 0;
+    _recordCount = 0;
+    _loadedFromCache = false;
+}
+
+QString LogReplayIndex::cacheFileName(const QString &logFileName)
+{
+    return logFileName + QStringLiteral(".qgcidx");
+}
+
+bool LogReplayIndex::readRecord(qint64 &offset, Record &record) const
+{
+    while ((offset + kTimestampSize) < _size) {
+        const qint64 frameOffset = offset + kTimestampSize;
+        const qint64 frameLength = _frameLength(frameOffset);
+        if (frameLength > 0) {
+            record.timestampUSecs = _timestampAt(offset);
+            record.offset = offset;
+            record.frame = QByteArrayView(_data + frameOffset, frameLength);
+            offset = frameOffset + frameLength;
+            return true;
+        }
+
+        // Not a frame, resynchronise one byte further on
+        offset++;
+    }
+
+    offset = _size;
+    return false;
+}
+
+qint64 LogReplayIndex::seek(quint64 timestampUSecs) const
+{
+    // Last index entry at or before the requested time, then walk forward to the exact record
+    const auto it = std::upper_bound(_indexTimestamps.cbegin(), _indexTimestamps.cend(), timestampUSecs);
+    const qsizetype indexEntry = std::distance(_indexTimestamps.cbegin(), it) - 1;
+
+    qint64 offset = (indexEntry >= 0) ? _indexOffsets.at(indexEntry) : 0;
+    Record record;
+    while (readRecord(offset, record)) {
+        if (record.timestampUSecs >= timestampUSecs) {
+            return record.offset;
+        }
+    }
+
+    return _size;
+}
+
+bool LogReplayIndex::_build()
+{
+    _indexTimestamps.clear();
+    _indexOffsets.clear();
+    _recordCount = 0;
+
+    qint64 offset = 0;
+    Record record;
+    while (readRecord(offset, record)) {
+        if ((_recordCount % kIndexStride) == 0) {
+            _indexTimestamps.append(record.timestampUSecs);
+            _indexOffsets.append(record.offset);
+        }
+        if (_recordCount == 0) {
+            _startTimeUSecs = record.timestampUSecs;
+        }
+        _endTimeUSecs = record.timestampUSecs;
+        _recordCount++;
+    }
+
+    return (_recordCount > 0);
+}
+
+bool LogReplayIndex::_loadCache(const QString &cacheFile)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QFileInfo logInfo(_file.fileName());
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint64 logSize = 0;
+    qint64 logModified = 0;
+    qint32 stride = 0;
+    stream >> magic >> version >> logSize >> logModified >> stride;
+    if ((magic != kCacheMagic) || (version != kCacheVersion) || (logSize != _size) ||
+            (logModified != logInfo.lastModified().toMSecsSinceEpoch()) || (stride != kIndexStride)) {
+        qCDebug(LogReplayIndexLog) << "Stale index" << cacheFile;
+        return false;
+    }
+
+    stream >> _startTimeUSecs >> _endTimeUSecs >> _recordCount >> _indexTimestamps >> _indexOffsets;
+    if ((stream.status() != QDataStream::Ok) || (_indexTimestamps.size() != _indexOffsets.size())) {
+        qCWarning(LogReplayIndexLog) << "Corrupt index" << cacheFile;
+        _indexTimestamps.clear();
+        _indexOffsets.clear();
+        _recordCount = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void LogReplayIndex::_saveCache(const QString &cacheFile) const
+{
+    // Best effort, the log may live in a read-only location
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(LogReplayIndexLog) << "Unable to write index" << cacheFile << file.errorString();
+        return;
+    }
+
+    const QFileInfo logInfo(_file.fileName());
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << kCacheMagic << kCacheVersion << _size << logInfo.lastModified().toMSecsSinceEpoch() << static_cast<qint32>(kIndexStride);
+    stream << _startTimeUSecs << _endTimeUSecs << _recordCount << _indexTimestamps << _indexOffsets;
+
+    if ((stream.status() != QDataStream::Ok) || !file.commit()) {
+        qCDebug(LogReplayIndexLog) << "Unable to write index" << cacheFile << file.errorString();
+    }
+}
+
+quint64 LogReplayIndex::_timestampAt(qint64 offset) const
+{
+    quint64 timestamp = qFromBigEndian<quint64>(_data + offset);
+    if (timestamp > _nowUSecs) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+qint64 LogReplayIndex::_frameLength(qint64 frameOffset) const
+{
+    const qint64 available = _size - frameOffset;
+    if (available < 2) {
+        return 0;
+    }
+
+    const uchar *const frame = _data + frameOffset;
+    const uint8_t payloadLength = frame[1];
+
+    qint64 headerLength = 0;
+    qint64 frameLength = 0;
+    uint32_t msgId = 0;
+    if (frame[0] == MAVLINK_STX) {
+        if (available < (MAVLINK_CORE_HEADER_LEN + 1)) {
+            return 0;
+        }
+        headerLength = MAVLINK_CORE_HEADER_LEN + 1;
+        frameLength = headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES;
+        if (frame[2] & MAVLINK_IFLAG_SIGNED) {
+            frameLength += MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+        msgId = frame[7] | (frame[8] << 8) | (static_cast<uint32_t>(frame[9]) << 16);
+    } else if (frame[0] == MAVLINK_STX_MAVLINK1) {
+        if (available < (MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1)) {
+            return 0;
+        }
+        headerLength = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        frameLength = headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES;
+        msgId = frame[5];
+    } else {
+        return 0;
+    }
+
+    if (frameLength > available) {
+        return 0;
+    }
+
+    // Messages the dialect knows must pass the CRC including their CRC_EXTRA. The CRC of any other message
+    // can not be checked, it is only accepted if the next record starts right behind it.
+    const mavlink_msg_entry_t *const entry = mavlink_get_msg_entry(msgId);
+    if (!entry) {
+        return _isRecordStart(frameOffset + frameLength) ? frameLength : 0;
+    }
+
+    uint16_t crc = crc_calculate(frame + 1, static_cast<uint16_t>(headerLength - 1 + payloadLength));
+    crc_accumulate(entry->crc_extra, &crc);
+    const uint16_t frameCrc = qFromLittleEndian<quint16>(frame + headerLength + payloadLength);
+    if (crc != frameCrc) {
+        return 0;
+    }
+
+    return frameLength;
+}
+
+bool LogReplayIndex::_isRecordStart(qint64 offset) const
+{
+    if (offset == _size) {
+        return true;
+    }
+
+    const qint64 frameOffset = offset + kTimestampSize;
+    if (frameOffset >= _size) {
+        return false;
+    }
+
+    return (_data[frameOffset] == MAVLINK_STX) || (_data[frameOffset] == MAVLINK_STX_MAVLINK1);
+}
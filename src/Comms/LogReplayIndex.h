@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayIndexLog)
+
+/// Memory mapped, indexed view of a telemetry log for replay.
+/// A log is a sequence of records, each an 8 byte big endian microsecond timestamp followed by a MAVLink frame.
+/// Opening the log walks the frame headers once to find the time range and builds a sparse index holding the
+/// timestamp and offset of every kIndexStride-th record, so a seek is a binary search followed by a walk over
+/// at most kIndexStride records. The index is saved to a sidecar file next to the log and reused while the
+/// log is unchanged.
+class LogReplayIndex
+{
+public:
+    struct Record
+    {
+        quint64 timestampUSecs = 0;
+        qint64 offset = 0;          ///< Offset of the record (its timestamp) in the log
+        QByteArrayView frame;       ///< Points into the mapped log, valid until close()
+    };
+
+    LogReplayIndex() = default;
+    ~LogReplayIndex();
+
+    /// Maps @a fileName and loads or builds its index
+    ///     @param useCache false: do not read or write the sidecar index, for temporary files
+    ///     @return false on failure, see errorString()
+    bool open(const QString &fileName, bool useCache = true);
+    void close();
+
+    bool isOpen() const { return (_data != nullptr); }
+    QString errorString() const { return _errorString; }
+
+    /// Size of the mapped log in bytes
+    qint64 size() const { return _size; }
+    quint64 startTimeUSecs() const { return _startTimeUSecs; }
+    quint64 endTimeUSecs() const { return _endTimeUSecs; }
+    qint64 recordCount() const { return _recordCount; }
+    bool loadedFromCache() const { return _loadedFromCache; }
+
+    /// Decodes the record at @a offset and advances @a offset past it.
+    /// Bytes which do not form a valid frame are skipped, as the MAVLink parser would.
+    ///     @return false if there are no more records
+    bool readRecord(qint64 &offset, Record &record) const;
+
+    /// @return Offset of the first record with a timestamp at or after @a timestampUSecs, size() if there is none
+    qint64 seek(quint64 timestampUSecs) const;
+
+    /// @return Path of the sidecar index for @a logFileName
+    static QString cacheFileName(const QString &logFileName);
+
+    static constexpr qint64 kTimestampSize = sizeof(quint64);
+    static constexpr int kIndexStride = 128;    ///< Records between index entries
+
+private:
+    bool _build();
+    bool _loadCache(const QString &cacheFile);
+    void _saveCache(const QString &cacheFile) const;
+    quint64 _timestampAt(qint64 offset) const;
+    /// @return Length of the valid frame at @a frameOffset, 0 if there is none
+    qint64 _frameLength(qint64 frameOffset) const;
+    /// @return true if a record can start at @a offset, its frame start byte is checked only
+    bool _isRecordStart(qint64 offset) const;
+
+    QFile _file;
+    uchar *_data = nullptr;
+    qint64 _size = 0;
+    quint64 _nowUSecs = 0;          ///< Timestamps beyond this were written little endian by older versions
+    QString _errorString;
+
+    QList<quint64> _indexTimestamps;
+    QList<qint64> _indexOffsets;
+    quint64 _startTimeUSecs = 0;
+    quint64 _endTimeUSecs = 0;
+    qint64 _recordCount = 0;
+    bool _loadedFromCache = false;
+
+    static constexpr quint32 kCacheMagic = 0x51524958;     ///< "QRIX"
+    static constexpr quint32 kCacheVersion = 1;
+};
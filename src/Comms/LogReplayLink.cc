@@ -1,11 +1,15 @@
 #include "LogReplayLink.h"
 #include "LinkManager.h"
+#include "MAVLinkLib.h"
 #include "MAVLinkProtocol.h"
 #include "MultiVehicleManager.h"
+#include "QGCCompression.h"
+#include "QGCDecompressDevice.h"
+#include "QGCFileHelper.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QFileInfo>
-#include <QtCore/QtEndian>
+#include <QtCore/QTemporaryFile>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
 
@@ -22,6 +26,7 @@ LogReplayConfiguration::LogReplayConfiguration(const QString &name, QObject *par
 LogReplayConfiguration::LogReplayConfiguration(const LogReplayConfiguration *copy, QObject *parent)
     : LinkConfiguration(copy, parent)
     , _logFilename(copy->logFilename())
+    , _asFastAsPossible(copy->asFastAsPossible())
 {
     qCDebug(LogReplayLinkLog) << this;
 }
@@ -38,6 +43,7 @@ void LogReplayConfiguration::copyFrom(const LinkConfiguration *source)
     const LogReplayConfiguration *logReplaySource = qobject_cast<const LogReplayConfiguration*>(source);
 
     setLogFilename(logReplaySource->logFilename());
+    setAsFastAsPossible(logReplaySource->asFastAsPossible());
 }
 
 void LogReplayConfiguration::loadSettings(QSettings &settings, const QString &root)
@@ -116,6 +122,8 @@ void LogReplayWorker::connectToLog()
     _isConnected = true;
     emit connected();
 
+    // Set before playback starts so no part of the log is sent in real time
+    _asFastAsPossible = _logReplayConfig->asFastAsPossible();
     play();
 }
 
@@ -131,10 +139,11 @@ void LogReplayWorker::disconnectFromLog()
     if (_readTickTimer) {
         _readTickTimer->stop();
     }
+    _fastPlaying = false;
+    _fastDraining = false;
 
-    if (_logFile.isOpen()) {
-        _logFile.close();
-    }
+    _log.close();
+    _decompressedLogFile.reset();
 
     _isConnected = false;
     emit disconnected();
@@ -142,7 +151,7 @@ void LogReplayWorker::disconnectFromLog()
 
 bool LogReplayWorker::isPlaying() const
 {
-    return (_readTickTimer && _readTickTimer->isActive());
+    return (_fastPlaying || (_readTickTimer && _readTickTimer->isActive()));
 }
 
 void LogReplayWorker::play()
@@ -150,15 +159,26 @@ void LogReplayWorker::play()
     LinkManager::instance()->setConnectionsSuspended(tr("Connect not allowed during Flight Data replay."));
     MAVLinkProtocol::instance()->suspendLogForReplay(true);
 
-    if (_logFile.atEnd()) {
+    if (_logPosition >= _log.size()) {
         _resetPlaybackToBeginning();
     }
 
+    emit playbackStarted();
+
+    if (_asFastAsPossible) {
+        _readTickTimer->stop();
+        _fastPlaying = true;
+        _fastDraining = false;
+        _fastReplayMessages = 0;
+        _fastReplayBytes = 0;
+        _fastReplayTimer.start();
+        _sendFastBatches();
+        return;
+    }
+
     _playbackStartTimeMSecs = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch());
     _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
     _readTickTimer->start(1);
-
-    emit playbackStarted();
 }
 
 void LogReplayWorker::pause()
@@ -167,6 +187,8 @@ void LogReplayWorker::pause()
     MAVLinkProtocol::instance()->suspendLogForReplay(false);
 
     _readTickTimer->stop();
+    _fastPlaying = false;
+    _fastDraining = false;
 
     emit playbackPaused();
 }
@@ -179,6 +201,34 @@ void LogReplayWorker::setPlaybackSpeed(qreal playbackSpeed)
     _readTickTimer->start(1);
 }
 
+void LogReplayWorker::setAsFastAsPossible(bool asFastAsPossible)
+{
+    if (asFastAsPossible == _asFastAsPossible) {
+        return;
+    }
+
+    _asFastAsPossible = asFastAsPossible;
+
+    // Carry on in the new mode from the current position
+    if (isPlaying()) {
+        _readTickTimer->stop();
+        _fastPlaying = false;
+        _fastDraining = false;
+        play();
+    }
+}
+
+void LogReplayWorker::dataConsumed(qint64 bytes)
+{
+    _bytesInFlight -= bytes;
+
+    if (_fastPlaying) {
+        _sendFastBatches();
+    } else if (_fastDraining && (_bytesInFlight <= 0)) {
+        _finishFastReplay();
+    }
+}
+
 void LogReplayWorker::movePlayhead(qreal percentComplete)
 {
     if (isPlaying()) {
@@ -189,41 +239,24 @@ void LogReplayWorker::movePlayhead(qreal percentComplete)
     }
 
     percentComplete = qBound(0., percentComplete, 100.);
-    const qreal percentCompleteMult = percentComplete / 100.0;
-    const qint64 newFilePos = static_cast<qint64>(percentCompleteMult * static_cast<qreal>(_logFile.size()));
-    if (!_logFile.seek(newFilePos)) {
-        emit errorOccurred(tr("Unable to seek to new position"));
-        return;
-    }
-
-    mavlink_message_t dummy{};
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(dummy);
+    const quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
 
-    qreal newRelativeTimeUSecs = static_cast<qreal>(_logCurrentTimeUSecs - _logStartTimeUSecs);
-    const qreal baudRate = _logFile.size() / static_cast<qreal>(_logDurationUSecs) / 1e6;
-    const qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
-    const qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        emit errorOccurred(tr("Unable to seek to new position"));
-        return;
-    }
+    // Exact: lands on the first record at or after the requested time
+    _logPosition = _log.seek(desiredTimeUSecs);
 
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(dummy);
+    qint64 offset = _logPosition;
+    LogReplayIndex::Record record;
+    _logCurrentTimeUSecs = _log.readRecord(offset, record) ? record.timestampUSecs : _logEndTimeUSecs;
     _signalCurrentLogTimeSecs();
 
-    newRelativeTimeUSecs = static_cast<qreal>(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    const qreal newRelativeTimeUSecs = static_cast<qreal>(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = ((newRelativeTimeUSecs / _logDurationUSecs) * 100);
     emit playbackPercentCompleteChanged(percentComplete);
 }
 
 void LogReplayWorker::_resetPlaybackToBeginning()
 {
-    if (_logFile.isOpen()) {
-        if (!_logFile.reset()) {
-            qCWarning(LogReplayLinkLog) << "failed to reset log file:" << _logFile.error() << _logFile.errorString();
-        }
-    }
-
+    _logPosition = 0;
     _playbackStartTimeMSecs = 0;
     _playbackStartLogTimeUSecs = 0;
     _logCurrentTimeUSecs = _logStartTimeUSecs;
@@ -234,12 +267,11 @@ void LogReplayWorker::_readNextLogEntry()
     int timeToNextExecutionMSecs = 0;
     while (timeToNextExecutionMSecs < 3) {
         QByteArray bytes;
-        bytes.reserve(_logFile.bytesAvailable());
         const qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
-        emit dataReceived(bytes);
+        _sendData(bytes);
         emit playbackPercentCompleteChanged((static_cast<float>(_logCurrentTimeUSecs - _logStartTimeUSecs) / static_cast<float>(_logDurationUSecs)) * 100);
 
-        if (_logFile.atEnd()) {
+        if (_logPosition >= _log.size()) {
             pause();
             emit playbackAtEnd();
             return;
@@ -258,6 +290,59 @@ void LogReplayWorker::_readNextLogEntry()
     _readTickTimer->start(timeToNextExecutionMSecs);
 }
 
+void LogReplayWorker::_sendData(const QByteArray &bytes)
+{
+    _bytesInFlight += bytes.size();
+    emit dataReceived(bytes);
+}
+
+void LogReplayWorker::_sendFastBatches()
+{
+    // No timers: reading only resumes once the receiver reports it has consumed earlier batches
+    while (_fastPlaying && (_bytesInFlight < kMaxBytesInFlight)) {
+        QByteArray batch;
+        batch.reserve(kFastBatchBytes + MAVLINK_MAX_PACKET_LEN);
+
+        LogReplayIndex::Record record;
+        while ((batch.size() < kFastBatchBytes) && _log.readRecord(_logPosition, record)) {
+            (void) batch.append(record.frame);
+            _logCurrentTimeUSecs = record.timestampUSecs;
+            _fastReplayMessages++;
+        }
+
+        if (!batch.isEmpty()) {
+            _fastReplayBytes += batch.size();
+            _sendData(batch);
+            emit playbackPercentCompleteChanged((static_cast<float>(_logCurrentTimeUSecs - _logStartTimeUSecs) / static_cast<float>(_logDurationUSecs)) * 100);
+        }
+
+        if (_logPosition >= _log.size()) {
+            _fastPlaying = false;
+            _fastDraining = true;
+        }
+    }
+
+    _signalCurrentLogTimeSecs();
+
+    if (_fastDraining && (_bytesInFlight <= 0)) {
+        _finishFastReplay();
+    }
+}
+
+void LogReplayWorker::_finishFastReplay()
+{
+    _fastDraining = false;
+
+    const qint64 elapsedMSecs = _fastReplayTimer.elapsed();
+    const qreal elapsedSecs = qMax<qint64>(elapsedMSecs, 1) / 1000.0;
+    qCDebug(LogReplayLinkLog) << "Replayed" << _fastReplayMessages << "messages" << _fastReplayBytes << "bytes in" << elapsedMSecs << "ms"
+                              << (_fastReplayMessages / elapsedSecs) << "msgs/sec" << ((_fastReplayBytes / (1024.0 * 1024.0)) / elapsedSecs) << "MB/sec";
+
+    pause();
+    emit replayThroughput(_fastReplayMessages, _fastReplayBytes, elapsedMSecs);
+    emit playbackAtEnd();
+}
+
 void LogReplayWorker::_signalCurrentLogTimeSecs()
 {
     emit currentLogTimeSecs((_logCurrentTimeUSecs - _logStartTimeUSecs) / 1000000);
@@ -265,27 +350,37 @@ void LogReplayWorker::_signalCurrentLogTimeSecs()
 
 bool LogReplayWorker::_loadLogFile()
 {
-    if (_logFile.isOpen()) {
-        _logFile.close();
+    if (_log.isOpen()) {
+        _log.close();
         emit errorOccurred(tr("Attempt to load new log while log being played"));
         return false;
     }
 
     const QString logFilename = _logReplayConfig->logFilename();
-    _logFile.setFileName(logFilename);
-    if (!_logFile.open(QFile::ReadOnly)) {
-        emit errorOccurred(tr("Unable to open log file: '%1', error: %2").arg(logFilename, _logFile.errorString()));
+    _decompressedLogFile.reset();
+
+    // Playback seeks around in the log, so compressed logs are streamed into a plain temp copy first
+    QString replayFilename = logFilename;
+    if (QGCCompression::isCompressionFormat(QGCCompression::detectFormat(logFilename, false))) {
+        if (!_decompressLogFile(logFilename)) {
+            return false;
+        }
+        replayFilename = _decompressedLogFile->fileName();
+    }
+
+    // The decompressed copy is temporary, so only index the original log in a sidecar file
+    if (!_log.open(replayFilename, !_decompressedLogFile)) {
+        emit errorOccurred(tr("Unable to open log file: '%1', error: %2").arg(logFilename, _log.errorString()));
         return false;
     }
 
-    QFileInfo logFileInfo;
-    logFileInfo.setFile(logFilename);
-    _logFileSize = logFileInfo.size();
+    _logFileSize = _log.size();
+    _logPosition = 0;
 
-    const quint64 startTimeUSecs = _parseTimestamp(_logFile.read(kTimestamp));
-    const quint64 endTimeUSecs = _findLastTimestamp();
+    const quint64 startTimeUSecs = _log.startTimeUSecs();
+    const quint64 endTimeUSecs = _log.endTimeUSecs();
     if (endTimeUSecs <= startTimeUSecs) {
-        _logFile.close();
+        _log.close();
         emit errorOccurred(tr("The log file '%1' is corrupt or empty.").arg(logFilename));
         return false;
     }
@@ -295,102 +390,73 @@ bool LogReplayWorker::_loadLogFile()
     _logDurationUSecs = endTimeUSecs - startTimeUSecs;
     _logCurrentTimeUSecs = startTimeUSecs;
 
-    if (!_logFile.reset()) {
-        qCWarning(LogReplayLinkLog) << "failed to reset log file:" << _logFile.error() << _logFile.errorString();
-    }
-
     const quint64 logDurationSecondsTotal = _logDurationUSecs / 1000000;
     emit logFileStats(logDurationSecondsTotal);
 
     return true;
 }
 
-quint64 LogReplayWorker::_parseTimestamp(const QByteArray &bytes)
+bool LogReplayWorker::_decompressLogFile(const QString &logFilename)
 {
-    const quint64 currentTimestamp = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
-    quint64 timestamp = qFromBigEndian(*reinterpret_cast<const quint64*>(bytes.constData()));
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
+    QGCDecompressDevice source(logFilename);
+    if (!source.open(QIODevice::ReadOnly)) {
+        emit errorOccurred(tr("Unable to open log file: '%1', error: %2").arg(logFilename, source.errorString()));
+        return false;
     }
 
-    return timestamp;
-}
-
-quint64 LogReplayWorker::_readNextMavlinkMessage(QByteArray &bytes)
-{
-    bytes.clear();
-
-    char nextByte;
-    while (_logFile.getChar(&nextByte)) {
-        mavlink_message_t message{};
-        mavlink_status_t status{};
-        const bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            bytes.clear();
-        }
-        (void) bytes.append(nextByte);
-
-        if (messageFound) {
-            const QByteArray rawTime = _logFile.read(kTimestamp);
-            return _parseTimestamp(rawTime);
-        }
+    _decompressedLogFile = std::make_unique<QTemporaryFile>(QGCFileHelper::tempDirectory() + QStringLiteral("/LogReplayXXXXXX.tlog"));
+    if (!_decompressedLogFile->open()) {
+        emit errorOccurred(tr("Unable to decompress log file: '%1', error: %2").arg(logFilename, _decompressedLogFile->errorString()));
+        _decompressedLogFile.reset();
+        return false;
     }
 
-    return 0;
-}
-
-quint64 LogReplayWorker::_seekToNextMavlinkMessage(mavlink_message_t &nextMsg)
-{
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    qint64 messageStartPos = -1;
-    char nextByte;
-    while (_logFile.getChar(&nextByte)) {
-        mavlink_status_t status{};
-        const bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            messageStartPos = _logFile.pos() - 1;
+    QByteArray buffer(static_cast<qsizetype>(QGCFileHelper::kBufferSizeMax), Qt::Uninitialized);
+    qint64 totalBytes = 0;
+    while (true) {
+        const qint64 bytesRead = source.read(buffer.data(), buffer.size());
+        if (bytesRead == 0) {
+            break;
         }
-
-        if (messageFound && (messageStartPos != -1)) {
-            if (!_logFile.seek(messageStartPos - kTimestamp)) {
-                qCWarning(LogReplayLinkLog) << "Failed to seek next message:" << _logFile.error() << _logFile.errorString();
-                break;
-            }
-
-            const QByteArray rawTime = _logFile.read(kTimestamp);
-            return _parseTimestamp(rawTime);
+        if (bytesRead < 0) {
+            // A log which was never closed ends in a partial frame, everything before it is still usable
+            qCWarning(LogReplayLinkLog) << "Compressed log ends early:" << logFilename << source.errorString();
+            break;
+        }
+        if (_decompressedLogFile->write(buffer.constData(), bytesRead) != bytesRead) {
+            emit errorOccurred(tr("Unable to decompress log file: '%1', error: %2").arg(logFilename, _decompressedLogFile->errorString()));
+            _decompressedLogFile.reset();
+            return false;
         }
+        totalBytes += bytesRead;
     }
 
-    return 0;
+    _decompressedLogFile->close();
+    qCDebug(LogReplayLinkLog) << "Decompressed" << logFilename << "filter" << source.filterName() << "bytes" << totalBytes;
+
+    return true;
 }
 
-quint64 LogReplayWorker::_findLastTimestamp()
+quint64 LogReplayWorker::_readNextMavlinkMessage(QByteArray &bytes)
 {
-    if (!_logFile.reset()) {
-        qCWarning(LogReplayLinkLog) << "failed to reset log file:" << _logFile.error() << _logFile.errorString();
-    }
-
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    quint64 lastTimestamp = 0;
-
-    while (_logFile.bytesAvailable() > static_cast<qint64>(kTimestamp)) {
-        lastTimestamp = _parseTimestamp(_logFile.read(kTimestamp));
+    bytes.clear();
 
-        bool endOfMessage = false;
-        char nextByte;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            mavlink_message_t msg{};
-            mavlink_status_t status{};
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
+    LogReplayIndex::Record record;
+    if (!_log.readRecord(_logPosition, record)) {
+        return 0;
     }
+    bytes = record.frame.toByteArray();
+
+    // Timestamp of the following record, which paces when that one is sent
+    qint64 nextOffset = _logPosition;
+    LogReplayIndex::Record nextRecord;
+    if (!_log.readRecord(nextOffset, nextRecord)) {
+        _logPosition = _log.size();
+        return 0;
+    }
+    _logPosition = nextRecord.offset;
 
-    return lastTimestamp;
+    return nextRecord.timestampUSecs;
 }
 
 /*===========================================================================*/
@@ -420,6 +486,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr &config, QObject *parent
     (void) connect(_worker, &LogReplayWorker::playbackPaused, this, &LogReplayLink::playbackPaused, Qt::QueuedConnection);
     (void) connect(_worker, &LogReplayWorker::playbackPercentCompleteChanged, this, &LogReplayLink::playbackPercentCompleteChanged, Qt::QueuedConnection);
     (void) connect(_worker, &LogReplayWorker::currentLogTimeSecs, this, &LogReplayLink::currentLogTimeSecs, Qt::QueuedConnection);
+    (void) connect(_worker, &LogReplayWorker::replayThroughput, this, &LogReplayLink::replayThroughput, Qt::QueuedConnection);
     (void) connect(_worker, &LogReplayWorker::disconnected, this, &LogReplayLink::disconnected, Qt::QueuedConnection);
 
     _workerThread->start();
@@ -479,6 +546,9 @@ void LogReplayLink::_onErrorOccurred(const QString &errorString)
 void LogReplayLink::_onDataReceived(const QByteArray &data)
 {
     emit bytesReceived(this, data);
+
+    // The protocol handles the bytes synchronously, so they are done with by now
+    (void) QMetaObject::invokeMethod(_worker, "dataConsumed", Qt::QueuedConnection, static_cast<qint64>(data.size()));
 }
 
 bool LogReplayLink::isPlaying() const
@@ -505,3 +575,8 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
 {
     (void) QMetaObject::invokeMethod(_worker, "movePlayhead", Qt::QueuedConnection, percentComplete);
 }
+
+void LogReplayLink::setAsFastAsPossible(bool asFastAsPossible)
+{
+    (void) QMetaObject::invokeMethod(_worker, "setAsFastAsPossible", Qt::QueuedConnection, asFastAsPossible);
+}
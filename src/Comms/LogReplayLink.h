@@ -2,13 +2,17 @@
 
 #include "LinkConfiguration.h"
 #include "LinkInterface.h"
+#include "LogReplayIndex.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QLoggingCategory>
 #include <QtQmlIntegration/QtQmlIntegration>
 
 #include <atomic>
+#include <memory>
 
+class QTemporaryFile;
 class QTimer;
 
 typedef struct __mavlink_message mavlink_message_t;
@@ -40,11 +44,16 @@ class LogReplayConfiguration : public LinkConfiguration
     QString logFilename() const { return _logFilename; }
     void setLogFilename(const QString &logFilename);
 
+    /// Start playback as fast as possible instead of in real time
+    bool asFastAsPossible() const { return _asFastAsPossible; }
+    void setAsFastAsPossible(bool asFastAsPossible) { _asFastAsPossible = asFastAsPossible; }
+
 signals:
     void filenameChanged();
 
 private:
     QString _logFilename;
+    bool _asFastAsPossible = false;
 };
 
 /*===========================================================================*/
@@ -60,6 +69,9 @@ class LogReplayWorker : public QObject
     bool isConnected() const { return _isConnected; }
     bool isPlaying() const;
 
+    static constexpr qsizetype kFastBatchBytes = 64 * 1024;                 ///< Frames sent per dataReceived in as fast as possible mode
+    static constexpr qint64 kMaxBytesInFlight = 4 * kFastBatchBytes;        ///< Sent but not yet consumed bytes before reading pauses
+
 signals:
     void connected();
     void disconnected();
@@ -71,6 +83,8 @@ class LogReplayWorker : public QObject
     void playbackAtEnd();
     void playbackPercentCompleteChanged(qreal percentComplete);
     void currentLogTimeSecs(uint32_t secs);
+    /// Emitted when an as fast as possible replay has been consumed to the end of the log
+    void replayThroughput(quint64 messages, quint64 bytes, qint64 elapsedMSecs);
 
 public slots:
     void setup();
@@ -80,16 +94,21 @@ public slots:
     void pause();
     void setPlaybackSpeed(qreal playbackSpeed);
     void movePlayhead(qreal percentComplete);
+    /// Ignore the log timestamps and send the log as fast as the receiver consumes it
+    void setAsFastAsPossible(bool asFastAsPossible);
+    /// The receiver has finished with @a bytes of the data sent through dataReceived
+    void dataConsumed(qint64 bytes);
 
 private slots:
     void _readNextLogEntry();
 
 private:
-    quint64 _parseTimestamp(const QByteArray &bytes);
-    quint64 _seekToNextMavlinkMessage(mavlink_message_t &nextMsg);
-    quint64 _findLastTimestamp();
+    void _sendData(const QByteArray &bytes);
+    void _sendFastBatches();
+    void _finishFastReplay();
     quint64 _readNextMavlinkMessage(QByteArray &bytes);
     bool _loadLogFile();
+    bool _decompressLogFile(const QString &logFilename);
     void _resetPlaybackToBeginning();
     void _signalCurrentLogTimeSecs();
 
@@ -97,7 +116,6 @@ private slots:
     QTimer *_readTickTimer = nullptr;
 
     bool _isConnected = false;
-    uint8_t _mavlinkChannel = 0;
 
     quint64 _logCurrentTimeUSecs = 0;
     quint64 _logStartTimeUSecs = 0;
@@ -108,10 +126,18 @@ private slots:
     quint64 _playbackStartTimeMSecs = 0;
     quint64 _playbackStartLogTimeUSecs = 0;
 
-    QFile _logFile;
+    bool _asFastAsPossible = false;
+    std::atomic<bool> _fastPlaying{false};
+    bool _fastDraining = false;         ///< End of log reached, waiting for the receiver to consume the rest
+    qint64 _bytesInFlight = 0;
+    QElapsedTimer _fastReplayTimer;
+    quint64 _fastReplayMessages = 0;
+    quint64 _fastReplayBytes = 0;
+
+    LogReplayIndex _log;
+    qint64 _logPosition = 0;    ///< Offset of the next record to play
+    std::unique_ptr<QTemporaryFile> _decompressedLogFile;   ///< Replay copy of a compressed log, removed on disconnect
     quint64 _logFileSize = 0;
-
-    static constexpr size_t kTimestamp = sizeof(quint64);
 };
 
 /*===========================================================================*/
@@ -133,6 +159,7 @@ class LogReplayLink : public LinkInterface
     void pause();
     void setPlaybackSpeed(qreal playbackSpeed);
     void movePlayhead(qreal percentComplete);
+    void setAsFastAsPossible(bool asFastAsPossible);
 
 signals:
     void logFileStats(uint32_t logDurationSecs);
@@ -141,6 +168,7 @@ class LogReplayLink : public LinkInterface
     void playbackAtEnd();
     void playbackPercentCompleteChanged(qreal percentComplete);
     void currentLogTimeSecs(uint32_t secs);
+    void replayThroughput(quint64 messages, quint64 bytes, qint64 elapsedMSecs);
 
 private slots:
     void _writeBytes(const QByteArray &bytes) override { Q_UNUSED(bytes); }
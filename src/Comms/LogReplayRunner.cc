@@ -0,0 +1,75 @@
+#include "LogReplayRunner.h"
+#include "LinkManager.h"
+#include "LogReplayLink.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFileInfo>
+
+QGC_LOGGING_CATEGORY_ON(LogReplayRunnerLog, "Comms.LogReplayRunner")
+
+LogReplayRunner::LogReplayRunner(const QString &logFile, QObject *parent)
+    : QObject(parent)
+    , _logFile(logFile)
+{
+    qCDebug(LogReplayRunnerLog) << this;
+}
+
+LogReplayRunner::~LogReplayRunner()
+{
+    qCDebug(LogReplayRunnerLog) << this;
+}
+
+int LogReplayRunner::exec()
+{
+    if (!QFileInfo::exists(_logFile)) {
+        qCCritical(LogReplayRunnerLog) << "Log file does not exist:" << _logFile;
+        return 1;
+    }
+
+    _link = LinkManager::instance()->startLogReplay(_logFile, true);
+    if (!_link) {
+        qCCritical(LogReplayRunnerLog) << "Unable to start replay of" << _logFile;
+        return 1;
+    }
+
+    (void) connect(_link, &LinkInterface::communicationError, this, &LogReplayRunner::_communicationError);
+    (void) connect(_link, &LogReplayLink::replayThroughput, this, &LogReplayRunner::_replayThroughput);
+    (void) connect(_link, &LogReplayLink::playbackAtEnd, this, &LogReplayRunner::_playbackAtEnd);
+
+    qCInfo(LogReplayRunnerLog) << "Replaying" << _logFile;
+    return QCoreApplication::exec();
+}
+
+void LogReplayRunner::_communicationError(const QString &title, const QString &error)
+{
+    qCCritical(LogReplayRunnerLog) << title << error;
+    _finish(1);
+}
+
+void LogReplayRunner::_replayThroughput(quint64 messages, quint64 bytes, qint64 elapsedMSecs)
+{
+    const qreal elapsedSecs = qMax<qint64>(elapsedMSecs, 1) / 1000.0;
+    qCInfo(LogReplayRunnerLog).noquote() << QStringLiteral("Replayed %1 messages, %2 MB in %3 s: %4 msgs/sec, %5 MB/sec")
+        .arg(messages)
+        .arg(bytes / (1024.0 * 1024.0), 0, 'f', 2)
+        .arg(elapsedSecs, 0, 'f', 3)
+        .arg(messages / elapsedSecs, 0, 'f', 0)
+        .arg((bytes / (1024.0 * 1024.0)) / elapsedSecs, 0, 'f', 2);
+}
+
+void LogReplayRunner::_playbackAtEnd()
+{
+    _finish(0);
+}
+
+void LogReplayRunner::_finish(int exitCode)
+{
+    if (_finished) {
+        return;
+    }
+    _finished = true;
+
+    LinkManager::instance()->disconnectAll();
+    QCoreApplication::exit(exitCode);
+}
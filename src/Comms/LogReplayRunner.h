@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+
+Q_DECLARE_LOGGING_CATEGORY(LogReplayRunnerLog)
+
+class LogReplayLink;
+
+/// Replays a telemetry log as fast as possible without any user interface, then exits.
+/// Used by the --replay-log command line option to regenerate vehicle state from large logs in batch or CI runs.
+class LogReplayRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogReplayRunner(const QString &logFile, QObject *parent = nullptr);
+    ~LogReplayRunner();
+
+    /// Starts the replay and runs the event loop until it completes
+    ///     @return Process exit code, 0 if the whole log was replayed
+    int exec();
+
+private slots:
+    void _communicationError(const QString &title, const QString &error);
+    void _replayThroughput(quint64 messages, quint64 bytes, qint64 elapsedMSecs);
+    void _playbackAtEnd();
+
+private:
+    void _finish(int exitCode);
+
+    const QString _logFile;
+    QPointer<LogReplayLink> _link;
+    bool _finished = false;
+};
@@ -0,0 +1,152 @@
+#include "MAVLinkIngest.h"
+
+MAVLinkFramer::MAVLinkFramer()
+    : _pool(MAVLinkMessagePool::create())
+{
+
+}
+
+MAVLinkFramer::~MAVLinkFramer()
+{
+    _message = MAVLinkMessageRef();
+    _pool->close();
+}
+
+void MAVLinkFramer::setSigning(const mavlink_signing_t *signing)
+{
+    QMutexLocker locker(&_signingMutex);
+    _pendingSigningEnabled = (signing != nullptr);
+    _pendingSigning = signing ? *signing : mavlink_signing_t{};
+    _signingChanged.store(true, std::memory_order_release);
+}
+
+void MAVLinkFramer::_applySigning()
+{
+    QMutexLocker locker(&_signingMutex);
+    _rxSigning = _pendingSigning;
+    _rxSigningStreams = mavlink_signing_streams_t{};
+    _rxStatus.signing = _pendingSigningEnabled ? &_rxSigning : nullptr;
+    _rxStatus.signing_streams = _pendingSigningEnabled ? &_rxSigningStreams : nullptr;
+}
+
+void MAVLinkFramer::_restartParse(uint8_t byte)
+{
+    _rxStatus.parse_error++;
+    _rxStatus.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+    _rxStatus.parse_state = MAVLINK_PARSE_STATE_IDLE;
+    if (byte == MAVLINK_STX) {
+        _rxStatus.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+        _rxMessage.len = 0;
+        mavlink_start_checksum(&_rxMessage);
+    }
+}
+
+qsizetype MAVLinkFramer::frame(QByteArrayView data, MAVLinkMessageBatch &batch)
+{
+    if (_resetRequested.exchange(false, std::memory_order_acquire)) {
+        _lossTracker.reset();
+        _lossStatisticsTimer.invalidate();
+    }
+
+    if (_signingChanged.exchange(false, std::memory_order_acquire)) {
+        _applySigning();
+    }
+
+    const qsizetype startCount = batch.messages.size();
+
+    for (const char byte : data) {
+        if (_message.isNull()) {
+            _message = _pool->acquire();
+        }
+        mavlink_message_t *const message = _message.data();
+
+        mavlink_status_t status{};
+        const uint8_t result = mavlink_frame_char_buffer(&_rxMessage, &_rxStatus, static_cast<uint8_t>(byte), message, &status);
+        if ((result == MAVLINK_FRAMING_BAD_CRC) || (result == MAVLINK_FRAMING_BAD_SIGNATURE)) {
+            _restartParse(static_cast<uint8_t>(byte));
+            continue;
+        }
+        if (result != MAVLINK_FRAMING_OK) {
+            continue;
+        }
+
+        // It's ok to get v1 HEARTBEAT messages on a v2 link:
+        //  PX4 defaults to sending V1 then switches to V2 after receiving a V2 message from GCS
+        //  ArduPilot always sends both versions
+        if ((message->msgid != MAVLINK_MSG_ID_HEARTBEAT) && (status.flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
+            batch.mavlinkV1Traffic = true;
+            continue;
+        }
+
+        (void) _lossTracker.update(message->sysid, message->compid, message->seq);
+        if ((_lossTracker.totalReceived() % kStatusInterval) == 0) {
+            batch.statusUpdates.append(MAVLinkStatusUpdate{
+                .sysid = message->sysid,
+                .messageIndex = batch.messages.size(),
+                .totalSent = _lossTracker.totalReceived() + _lossTracker.totalLost(),
+                .totalReceived = _lossTracker.totalReceived(),
+                .totalLoss = _lossTracker.totalLost(),
+                .lossPercent = _lossTracker.windowLossPercent(),
+            });
+
+            if (!_lossStatisticsTimer.isValid() || _lossStatisticsTimer.hasExpired(kLossStatisticsIntervalMs)) {
+                batch.lossStatistics = _lossTracker.statistics();
+                _lossStatisticsTimer.start();
+            }
+        }
+
+        // Hand the buffer over, the parser continues in a fresh one
+        batch.messages.append(std::move(_message));
+    }
+
+    if (_rxStatus.signing) {
+        batch.signingTimestamp = _rxSigning.timestamp;
+    }
+
+    return (batch.messages.size() - startCount);
+}
+
+/*===========================================================================*/
+
+MAVLinkIngestQueue::~MAVLinkIngestQueue()
+{
+    MAVLinkMessageBatch *batch = _head.exchange(nullptr, std::memory_order_acquire);
+    while (batch) {
+        MAVLinkMessageBatch *const next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+bool MAVLinkIngestQueue::push(MAVLinkMessageBatch *batch)
+{
+    MAVLinkMessageBatch *head = _head.load(std::memory_order_relaxed);
+    do {
+        batch->next = head;
+    } while (!_head.compare_exchange_weak(head, batch, std::memory_order_release, std::memory_order_relaxed));
+
+    return (head == nullptr);
+}
+
+int MAVLinkIngestQueue::drain(const Consumer &consumer)
+{
+    // Producers push onto the front, so the detached list is newest first. Reverse it to restore arrival order.
+    MAVLinkMessageBatch *batch = _head.exchange(nullptr, std::memory_order_acquire);
+    MAVLinkMessageBatch *ordered = nullptr;
+    while (batch) {
+        MAVLinkMessageBatch *const next = batch->next;
+        batch->next = ordered;
+        ordered = batch;
+        batch = next;
+    }
+
+    int count = 0;
+    while (ordered) {
+        std::unique_ptr<MAVLinkMessageBatch> current(ordered);
+        ordered = ordered->next;
+        consumer(*current);
+        count++;
+    }
+
+    return count;
+}
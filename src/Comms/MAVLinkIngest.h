@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "MAVLinkLib.h"
+#include "MAVLinkLossTracker.h"
+#include "MAVLinkMessagePool.h"
+
+class LinkInterface;
+
+/// Snapshot of the receive/loss counters of a link, published every MAVLinkFramer::kStatusInterval messages
+struct MAVLinkStatusUpdate
+{
+    uint8_t sysid = 0;              ///< System id of the message which triggered the update
+    qsizetype messageIndex = 0;     ///< Index of that message in MAVLinkMessageBatch::messages
+    uint64_t totalSent = 0;
+    uint64_t totalReceived = 0;
+    uint64_t totalLoss = 0;
+    float lossPercent = 0.f;
+};
+
+/// A batch of complete MAVLink frames decoded on a link worker thread.
+/// The link is referenced through a weak handle so the consumer can detect links which went
+/// away while the batch was queued without having to look the link up in LinkManager.
+struct MAVLinkMessageBatch
+{
+    std::weak_ptr<LinkInterface> link;
+    QList<MAVLinkMessageRef> messages;      ///< Pooled buffers of the link, nothing is copied when handing them on
+    QList<MAVLinkStatusUpdate> statusUpdates;
+    QList<MAVLinkLossStats> lossStatistics;     ///< Per source snapshot, published every MAVLinkFramer::kLossStatisticsIntervalMs (empty otherwise)
+    bool mavlinkV1Traffic = false;          ///< true: non-heartbeat MAVLink v1 frames were seen (and dropped)
+    uint64_t signingTimestamp = 0;          ///< Receive side signing timestamp after the batch, 0 when signature checking is off
+    MAVLinkMessageBatch *next = nullptr;    ///< Intrusive link used by MAVLinkIngestQueue
+};
+
+/// Frames raw link bytes into complete MAVLink messages and keeps the sequence-loss accounting for the link.
+/// CRC and signature validation happen inside mavlink_frame_char_buffer, so all per-byte work is done by the thread calling frame().
+/// The parser state and the receive side signing are owned by the framer rather than taken from the global channel status,
+/// so parsing on the link worker thread never touches state the main thread writes while packing outgoing messages.
+/// Messages are parsed straight into buffers recycled from the framer's MAVLinkMessagePool.
+/// Not thread safe: an instance must only be used from a single thread, normally the link worker thread.
+/// The only exceptions are requestReset() and setSigning() which may be called from any thread.
+class MAVLinkFramer
+{
+public:
+    MAVLinkFramer();
+    ~MAVLinkFramer();
+
+    /// Parses @a data, appending every completely framed message to @a batch.
+    ///     @return Number of messages appended
+    qsizetype frame(QByteArrayView data, MAVLinkMessageBatch &batch);
+
+    /// Thread safe. Counters are cleared before the next call to frame().
+    void requestReset() { _resetRequested.store(true, std::memory_order_release); }
+
+    /// Thread safe. Copies the signing setup of the link's channel, nullptr turns signature checking off.
+    /// The copy is installed before the next call to frame().
+    void setSigning(const mavlink_signing_t *signing);
+
+    uint64_t totalReceived() const { return _lossTracker.totalReceived(); }
+    uint64_t totalLoss() const { return _lossTracker.totalLost(); }
+    float windowLossPercent() const { return _lossTracker.windowLossPercent(); }
+    const MAVLinkLossTracker &lossTracker() const { return _lossTracker; }
+    /// Number of framed messages which reused a pooled buffer instead of allocating
+    quint64 allocationsAvoided() const { return _pool->allocationsAvoided(); }
+
+    static constexpr uint64_t kStatusInterval = 31;   ///< A status update is published every this many received messages
+    static constexpr qint64 kLossStatisticsIntervalMs = 1000;
+
+private:
+    Q_DISABLE_COPY_MOVE(MAVLinkFramer)
+
+    /// Same recovery as mavlink_parse_char after a frame failed its CRC or signature check
+    void _restartParse(uint8_t byte);
+    void _applySigning();
+
+    MAVLinkMessagePool *const _pool;
+    MAVLinkMessageRef _message;                     ///< Buffer the parser currently writes into
+    std::atomic<bool> _resetRequested{false};
+
+    mavlink_message_t _rxMessage{};                 ///< Frame being assembled
+    mavlink_status_t _rxStatus{};
+    mavlink_signing_t _rxSigning{};                 ///< Receive side copy of the channel signing, tracks the incoming timestamps
+    mavlink_signing_streams_t _rxSigningStreams{};
+
+    QMutex _signingMutex;                           ///< Guards the pending signing below
+    mavlink_signing_t _pendingSigning{};
+    bool _pendingSigningEnabled = false;
+    std::atomic<bool> _signingChanged{false};
+
+    MAVLinkLossTracker _lossTracker;
+    QElapsedTimer _lossStatisticsTimer;             ///< Time since the last per source snapshot
+};
+
+/// Lock-free multi-producer/single-consumer queue of message batches.
+/// Link worker threads push, the main thread drains.
+class MAVLinkIngestQueue
+{
+public:
+    MAVLinkIngestQueue() = default;
+    ~MAVLinkIngestQueue();
+
+    Q_DISABLE_COPY_MOVE(MAVLinkIngestQueue)
+
+    using Consumer = std::function<void(MAVLinkMessageBatch &batch)>;
+
+    /// Thread safe. Takes ownership of @a batch.
+    ///     @return true if the queue was empty, in which case the caller is responsible for scheduling a drain
+    bool push(MAVLinkMessageBatch *batch);
+
+    /// Removes every queued batch and hands them to @a consumer in the order they were pushed
+    /// (per producer). Must only be called from the consumer thread.
+    ///     @return Number of batches consumed
+    int drain(const Consumer &consumer);
+
+    bool isEmpty() const { return (_head.load(std::memory_order_acquire) == nullptr); }
+
+private:
+    std::atomic<MAVLinkMessageBatch*> _head{nullptr};
+};
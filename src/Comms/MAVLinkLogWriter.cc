@@ -0,0 +1,260 @@
+#include "MAVLinkLogWriter.h"
+#include "QGCCompressDevice.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(MAVLinkLogWriterLog, "Comms.MAVLinkLogWriter")
+
+MAVLinkLogWriter::MAVLinkLogWriter(qsizetype capacity, QObject *parent)
+    : QThread(parent)
+    , _capacity(capacity)
+    , _writeChunkSize(qMin(kWriteChunkSize, qMax<qsizetype>(capacity / 2, 1)))
+    , _ring(std::make_unique<char[]>(capacity))
+{
+    setObjectName(QStringLiteral("MAVLinkLogWriter"));
+
+    qCDebug(MAVLinkLogWriterLog) << this;
+}
+
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    close();
+
+    qCDebug(MAVLinkLogWriterLog) << this;
+}
+
+quint64 MAVLinkLogWriter::currentTimestamp()
+{
+    return static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+}
+
+QString MAVLinkLogWriter::fileExtension(Compression compression)
+{
+    switch (compression) {
+    case Compression::Zstd:
+        return QGCCompression::formatExtension(QGCCompression::Format::ZSTD);
+    case Compression::Xz:
+        return QGCCompression::formatExtension(QGCCompression::Format::XZ);
+    case Compression::None:
+    default:
+        return QString();
+    }
+}
+
+bool MAVLinkLogWriter::open(const QString &fileName, Compression compression)
+{
+    if (_open) {
+        qCWarning(MAVLinkLogWriterLog) << "Already open" << _fileName;
+        return false;
+    }
+
+    _file = std::make_unique<QFile>(fileName);
+    _fileName = fileName;
+    _errorString.clear();
+
+    // The ring buffer already batches the writes, a second buffer in QFile would only add a copy
+    if (!_file->open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        _errorString = _file->errorString();
+        _file.reset();
+        return false;
+    }
+
+    _output = _file.get();
+    _compression = compression;
+    if (compression != Compression::None) {
+        const QGCCompression::Format format = (compression == Compression::Zstd) ? QGCCompression::Format::ZSTD : QGCCompression::Format::XZ;
+        _compressor = std::make_unique<QGCCompressDevice>(_file.get(), format);
+        if (!_compressor->open(QIODevice::WriteOnly)) {
+            _errorString = _compressor->errorString();
+            _compressor.reset();
+            _file->close();
+            _file.reset();
+            return false;
+        }
+        _output = _compressor.get();
+    }
+
+    _head = 0;
+    _tail = 0;
+    _used = 0;
+    _accepting = true;
+    _stopRequested = false;
+    _bytesQueued.store(0, std::memory_order_relaxed);
+    _peakBytesQueued.store(0, std::memory_order_relaxed);
+    _bytesWritten.store(0, std::memory_order_relaxed);
+    _droppedRecords.store(0, std::memory_order_relaxed);
+    _droppedBytes.store(0, std::memory_order_relaxed);
+
+    _open = true;
+    start();
+
+    return true;
+}
+
+void MAVLinkLogWriter::close()
+{
+    if (!_open) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&_mutex);
+        _accepting = false;
+        _stopRequested = true;
+    }
+    _dataReady.wakeAll();
+    (void) wait();
+
+    if (_compressor) {
+        // Finishes the last frame
+        _compressor->close();
+        _compressor.reset();
+    }
+    _output = nullptr;
+
+    const qint64 fileSize = _file->size();
+    _file->close();
+    _file.reset();
+    _open = false;
+
+    qCDebug(MAVLinkLogWriterLog) << "Closed" << _fileName
+                                 << "written" << bytesWritten()
+                                 << "file size" << fileSize
+                                 << "peak queued" << peakBytesQueued()
+                                 << "dropped records" << droppedRecords()
+                                 << "dropped bytes" << droppedBytes();
+}
+
+bool MAVLinkLogWriter::append(quint64 timestampUSecs, QByteArrayView frame)
+{
+    uint8_t timestamp[kTimestampSize]{};
+    qToBigEndian(timestampUSecs, timestamp);
+
+    const qsizetype recordSize = kTimestampSize + frame.size();
+
+    bool wake = false;
+    {
+        QMutexLocker locker(&_mutex);
+
+        if (!_accepting) {
+            return false;
+        }
+
+        // Records are all or nothing, a partial record would corrupt the rest of the log for replay
+        if ((_capacity - _used) < recordSize) {
+            locker.unlock();
+            if (_droppedRecords.fetch_add(1, std::memory_order_relaxed) == 0) {
+                qCWarning(MAVLinkLogWriterLog) << "Log writer falling behind, dropping records" << _fileName;
+            }
+            (void) _droppedBytes.fetch_add(recordSize, std::memory_order_relaxed);
+            _dataReady.wakeOne();
+            return false;
+        }
+
+        _copyIn(reinterpret_cast<const char*>(timestamp), kTimestampSize);
+        _copyIn(frame.data(), frame.size());
+
+        // Only wake the writer when a full chunk becomes available, smaller amounts are picked up by the flush timeout
+        wake = ((_used < _writeChunkSize) && ((_used + recordSize) >= _writeChunkSize));
+        _used += recordSize;
+
+        _bytesQueued.store(_used, std::memory_order_relaxed);
+        if (_used > _peakBytesQueued.load(std::memory_order_relaxed)) {
+            _peakBytesQueued.store(_used, std::memory_order_relaxed);
+        }
+    }
+
+    if (wake) {
+        _dataReady.wakeOne();
+    }
+
+    return true;
+}
+
+void MAVLinkLogWriter::_copyIn(const char *data, qsizetype size)
+{
+    const qsizetype firstPart = qMin(size, _capacity - _head);
+    (void) memcpy(_ring.get() + _head, data, firstPart);
+    (void) memcpy(_ring.get(), data + firstPart, size - firstPart);
+    _head = (_head + size) % _capacity;
+}
+
+bool MAVLinkLogWriter::_writeOut(qsizetype start, qsizetype size)
+{
+    const qsizetype firstPart = qMin(size, _capacity - start);
+    if (_output->write(_ring.get() + start, firstPart) != firstPart) {
+        return false;
+    }
+
+    const qsizetype secondPart = size - firstPart;
+    if ((secondPart > 0) && (_output->write(_ring.get(), secondPart) != secondPart)) {
+        return false;
+    }
+
+    (void) _bytesWritten.fetch_add(size, std::memory_order_relaxed);
+    return true;
+}
+
+void MAVLinkLogWriter::run()
+{
+    _frameTimer.start();
+
+    while (true) {
+        qsizetype start = 0;
+        qsizetype size = 0;
+        bool flushAll = false;
+        bool stop = false;
+        {
+            QMutexLocker locker(&_mutex);
+            if (!_stopRequested && (_used < _writeChunkSize)) {
+                flushAll = !_dataReady.wait(&_mutex, kFlushIntervalMs);
+            }
+            stop = _stopRequested;
+            start = _tail;
+            size = _used;
+        }
+
+        // The region between start and start + size is only touched by this thread until _tail is advanced,
+        // so the file write happens without holding the lock
+        if (!flushAll && !stop) {
+            size -= (size % _writeChunkSize);
+        }
+
+        bool ok = ((size == 0) || _writeOut(start, size));
+
+        // Cutting the compressed stream into frames bounds how much of it is lost if the log is never closed
+        if (ok && _compressor && (_frameTimer.elapsed() >= kCompressedFrameIntervalMs)) {
+            ok = _compressor->flushFrame();
+            _frameTimer.restart();
+        }
+
+        if (!ok) {
+            const QString errorString = _output->errorString();
+            qCWarning(MAVLinkLogWriterLog) << "Write failed" << _fileName << errorString;
+            {
+                QMutexLocker locker(&_mutex);
+                _accepting = false;
+                _used = 0;
+                _bytesQueued.store(0, std::memory_order_relaxed);
+            }
+            emit writeError(errorString);
+            return;
+        }
+
+        {
+            QMutexLocker locker(&_mutex);
+            _tail = (_tail + size) % _capacity;
+            _used -= size;
+            _bytesQueued.store(_used, std::memory_order_relaxed);
+        }
+
+        if (stop) {
+            break;
+        }
+    }
+}
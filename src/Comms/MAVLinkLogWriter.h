@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <memory>
+
+class QFile;
+class QGCCompressDevice;
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogWriterLog)
+
+/// Writes a telemetry log on its own thread.
+/// Each record is an 8 byte big endian timestamp in microseconds followed by the raw MAVLink frame, which is the
+/// format LogReplayLink reads. Records are copied into a fixed size ring buffer by append(), which never touches
+/// the file, and the writer thread drains the ring in multiples of writeChunkSize(). Anything left over is written
+/// after kFlushIntervalMs of inactivity and on close(). When the disk falls behind far enough for the ring to fill up,
+/// new records are dropped and counted instead of blocking the caller.
+/// Optionally the log is compressed on the writer thread. The compressed stream is cut into frames at least every
+/// kCompressedFrameIntervalMs, so a log which was never closed properly can still be decompressed up to the last frame.
+class MAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    /// Values match the telemetryCompression setting
+    enum class Compression {
+        None,
+        Zstd,
+        Xz
+    };
+
+    explicit MAVLinkLogWriter(qsizetype capacity = kDefaultCapacity, QObject *parent = nullptr);
+    ~MAVLinkLogWriter();
+
+    /// Creates @a fileName, resets the counters and starts the writer thread
+    ///     @return false if the file could not be opened, see errorString()
+    bool open(const QString &fileName, Compression compression = Compression::None);
+
+    /// Writes everything still queued, stops the writer thread and closes the file
+    void close();
+
+    bool isOpen() const { return _open; }
+    Compression compression() const { return _compression; }
+    QString fileName() const { return _fileName; }
+    QString errorString() const { return _errorString; }
+
+    /// Thread safe. Queues a record with the given timestamp.
+    ///     @return false if the writer is not open, has failed, or the record did not fit in the ring buffer
+    bool append(quint64 timestampUSecs, QByteArrayView frame);
+    bool append(QByteArrayView frame) { return append(currentTimestamp(), frame); }
+
+    /// @return Wall clock time in microseconds, as used for log record timestamps
+    static quint64 currentTimestamp();
+
+    /// @return File name suffix for logs written with @a compression, for example ".zst", or an empty string
+    static QString fileExtension(Compression compression);
+
+    qsizetype capacity() const { return _capacity; }
+    /// kWriteChunkSize, or half the capacity for rings smaller than two chunks
+    qsizetype writeChunkSize() const { return _writeChunkSize; }
+    qsizetype bytesQueued() const { return _bytesQueued.load(std::memory_order_relaxed); }
+    /// Largest number of bytes which were waiting for the disk since open()
+    qsizetype peakBytesQueued() const { return _peakBytesQueued.load(std::memory_order_relaxed); }
+    /// Log bytes handed to the file, before compression
+    quint64 bytesWritten() const { return _bytesWritten.load(std::memory_order_relaxed); }
+    quint64 droppedRecords() const { return _droppedRecords.load(std::memory_order_relaxed); }
+    quint64 droppedBytes() const { return _droppedBytes.load(std::memory_order_relaxed); }
+
+    static constexpr qsizetype kTimestampSize = sizeof(quint64);
+    static constexpr qsizetype kWriteChunkSize = 64 * 1024;         ///< Unit of the writes issued while the log is busy
+    static constexpr qsizetype kDefaultCapacity = 64 * kWriteChunkSize;
+    static constexpr int kFlushIntervalMs = 500;
+    static constexpr int kCompressedFrameIntervalMs = 2000;
+
+signals:
+    /// Emitted from the writer thread when a write fails. Nothing is written after this until the file is reopened.
+    void writeError(const QString &errorString);
+
+protected:
+    void run() final;
+
+private:
+    void _copyIn(const char *data, qsizetype size);
+    bool _writeOut(qsizetype start, qsizetype size);
+
+    const qsizetype _capacity;
+    const qsizetype _writeChunkSize;
+    std::unique_ptr<char[]> _ring;
+    std::unique_ptr<QFile> _file;
+    std::unique_ptr<QGCCompressDevice> _compressor;
+    QIODevice *_output = nullptr;   ///< _file, or _compressor when compressing
+    QElapsedTimer _frameTimer;      ///< Only used by the writer thread
+    Compression _compression = Compression::None;
+    QString _fileName;
+    QString _errorString;
+    bool _open = false;
+
+    QMutex _mutex;
+    QWaitCondition _dataReady;
+    qsizetype _head = 0;            ///< Next byte to fill, guarded by _mutex
+    qsizetype _tail = 0;            ///< Next byte to write to disk, guarded by _mutex
+    qsizetype _used = 0;            ///< Guarded by _mutex
+    bool _accepting = false;        ///< Guarded by _mutex
+    bool _stopRequested = false;    ///< Guarded by _mutex
+
+    std::atomic<qsizetype> _bytesQueued{0};
+    std::atomic<qsizetype> _peakBytesQueued{0};
+    std::atomic<quint64> _bytesWritten{0};
+    std::atomic<quint64> _droppedRecords{0};
+    std::atomic<quint64> _droppedBytes{0};
+};
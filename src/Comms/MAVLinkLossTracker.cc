@@ -0,0 +1,180 @@
+#include "MAVLinkLossTracker.h"
+
+#include <QtCore/QVariantList>
+
+#include <bit>
+
+QVariantMap MAVLinkLossStats::toVariantMap() const
+{
+    QVariantList bursts;
+    bursts.reserve(kBurstBuckets);
+    for (const quint32 count : burstHistogram) {
+        bursts.append(count);
+    }
+
+    return QVariantMap{
+        { QStringLiteral("sysid"), sysid },
+        { QStringLiteral("compid"), compid },
+        { QStringLiteral("received"), received },
+        { QStringLiteral("lost"), lost },
+        { QStringLiteral("reordered"), reordered },
+        { QStringLiteral("duplicates"), duplicates },
+        { QStringLiteral("restarts"), restarts },
+        { QStringLiteral("windowLossPercent"), windowLossPercent },
+        { QStringLiteral("burstHistogram"), bursts },
+    };
+}
+
+int MAVLinkLossStats::burstBucket(uint32_t burstLength)
+{
+    return qMin(static_cast<int>(std::bit_width(burstLength - 1)), kBurstBuckets - 1);
+}
+
+/*===========================================================================*/
+
+void MAVLinkLossTracker::Window::add(uint32_t expected_, uint32_t lost_)
+{
+    expected += expected_;
+    lost += lost_;
+    if (expected >= kWindowSize) {
+        previousExpected = expected;
+        previousLost = lost;
+        expected = 0;
+        lost = 0;
+    }
+}
+
+void MAVLinkLossTracker::Window::removeLoss()
+{
+    // The late message was counted as lost in this or the previous window
+    if (lost > 0) {
+        lost--;
+    } else if (previousLost > 0) {
+        previousLost--;
+    }
+}
+
+float MAVLinkLossTracker::Window::lossPercent() const
+{
+    const uint32_t totalExpected = expected + previousExpected;
+    if (totalExpected == 0) {
+        return 0.f;
+    }
+
+    return (static_cast<float>(lost + previousLost) / totalExpected) * 100.f;
+}
+
+/*===========================================================================*/
+
+uint32_t MAVLinkLossTracker::update(uint8_t sysid, uint8_t compid, uint8_t seq)
+{
+    _received++;
+
+    const uint16_t key = static_cast<uint16_t>((sysid << 8) | compid);
+    uint8_t index = _sourceIndex[key];
+    if (index == 0) {
+        if (_sourceCount == kMaxSources) {
+            return 0;
+        }
+
+        _sources[_sourceCount] = Source{ .sysid = sysid, .compid = compid, .lastSeq = seq, .received = 1 };
+        _sourceCount++;
+        _sourceIndex[key] = static_cast<uint8_t>(_sourceCount);
+        _linkWindow.add(1, 0);
+        _sources[_sourceCount - 1].window.add(1, 0);
+        return 0;
+    }
+
+    Source &source = _sources[index - 1];
+    source.received++;
+
+    // Distance ahead of the expected sequence number, modulo 256
+    const uint8_t gap = static_cast<uint8_t>(seq - static_cast<uint8_t>(source.lastSeq + 1));
+    if (gap == 0) {
+        source.lastSeq = seq;
+        source.window.add(1, 0);
+        _linkWindow.add(1, 0);
+        return 0;
+    }
+
+    const uint8_t behind = static_cast<uint8_t>(source.lastSeq - seq);
+    if (behind == 0) {
+        // Duplicate of the newest message, nothing was lost
+        source.duplicates++;
+        _duplicates++;
+        return 0;
+    }
+
+    // Classify the jump before counting anything: only a short step back is a late message and only a
+    // bounded step forward is loss. Anything else means the sender restarted its sequence, resynchronise.
+    if ((behind >= kMaxReorderDistance) && (gap > kMaxLossBurst)) {
+        source.restarts++;
+        _restarts++;
+        source.lastSeq = seq;
+        source.window.add(1, 0);
+        _linkWindow.add(1, 0);
+        return 0;
+    }
+
+    if (behind < kMaxReorderDistance) {
+        // A message counted as lost earlier turned up late
+        source.reordered++;
+        _reordered++;
+        if (source.lost > 0) {
+            source.lost--;
+            _lost--;
+        }
+        source.window.removeLoss();
+        _linkWindow.removeLoss();
+        return 0;
+    }
+
+    source.lastSeq = seq;
+    source.lost += gap;
+    _lost += gap;
+    source.burstHistogram[MAVLinkLossStats::burstBucket(gap)]++;
+    source.window.add(gap + 1U, gap);
+    _linkWindow.add(gap + 1U, gap);
+
+    return gap;
+}
+
+void MAVLinkLossTracker::reset()
+{
+    // Only clear the entries in use rather than the whole table
+    for (int i = 0; i < _sourceCount; i++) {
+        const Source &source = _sources[i];
+        _sourceIndex[static_cast<uint16_t>((source.sysid << 8) | source.compid)] = 0;
+    }
+    _sourceCount = 0;
+
+    _received = 0;
+    _lost = 0;
+    _reordered = 0;
+    _duplicates = 0;
+    _restarts = 0;
+    _linkWindow = Window();
+}
+
+QList<MAVLinkLossStats> MAVLinkLossTracker::statistics() const
+{
+    QList<MAVLinkLossStats> result;
+    result.reserve(_sourceCount);
+
+    for (int i = 0; i < _sourceCount; i++) {
+        const Source &source = _sources[i];
+        result.append(MAVLinkLossStats{
+            .sysid = source.sysid,
+            .compid = source.compid,
+            .received = source.received,
+            .lost = source.lost,
+            .reordered = source.reordered,
+            .duplicates = source.duplicates,
+            .restarts = source.restarts,
+            .windowLossPercent = source.window.lossPercent(),
+            .burstHistogram = source.burstHistogram,
+        });
+    }
+
+    return result;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QVariantMap>
+
+#include <array>
+#include <cstdint>
+
+/// Sequence loss statistics of one MAVLink source (system/component pair) on one link
+struct MAVLinkLossStats
+{
+    static constexpr int kBurstBuckets = 7;     ///< Burst lengths 1, 2, 3-4, 5-8, 9-16, 17-32, 33-64, see MAVLinkLossTracker::kMaxLossBurst
+
+    uint8_t sysid = 0;
+    uint8_t compid = 0;
+    quint64 received = 0;
+    quint64 lost = 0;
+    quint64 reordered = 0;                      ///< Late arrivals, these are taken back out of lost
+    quint64 duplicates = 0;                     ///< Repeats of the newest message
+    quint64 restarts = 0;                       ///< Sequence jumps too large to be loss or reordering
+    float windowLossPercent = 0.f;              ///< Loss over the most recent messages, see MAVLinkLossTracker::kWindowSize
+    std::array<quint32, kBurstBuckets> burstHistogram{};    ///< Number of gaps of each length
+
+    /// Keys: sysid, compid, received, lost, reordered, duplicates, restarts, windowLossPercent, burstHistogram (list of counts)
+    QVariantMap toVariantMap() const;
+
+    /// @return Histogram bucket a gap of @a burstLength (1 - MAVLinkLossTracker::kMaxLossBurst) lost messages is counted in
+    static int burstBucket(uint32_t burstLength);
+};
+
+/// Tracks MAVLink sequence numbers per system/component pair to count lost, reordered and burst lost messages.
+/// Sources are found through a flat 64 KiB table indexed by (sysid << 8) | compid which holds the position of the
+/// source in a dense array, so the per message cost is two array lookups and no hashing. Only the first kMaxSources
+/// sources seen on a link are tracked, messages from any further sources are counted as received only.
+/// Loss is also reported over a sliding window of recent messages so the rate recovers once a link improves.
+/// Not thread safe, an instance belongs to the thread framing the link.
+class MAVLinkLossTracker
+{
+public:
+    MAVLinkLossTracker() = default;
+
+    /// Accounts for a received message
+    ///     @return Number of messages found missing in front of this one
+    uint32_t update(uint8_t sysid, uint8_t compid, uint8_t seq);
+    void reset();
+
+    quint64 totalReceived() const { return _received; }
+    quint64 totalLost() const { return _lost; }
+    quint64 totalReordered() const { return _reordered; }
+    quint64 totalDuplicates() const { return _duplicates; }
+    quint64 totalRestarts() const { return _restarts; }
+    /// @return Loss over the recent messages of all sources on the link
+    float windowLossPercent() const { return _linkWindow.lossPercent(); }
+
+    qsizetype sourceCount() const { return _sourceCount; }
+    /// @return Statistics for every tracked source in the order they were first seen
+    QList<MAVLinkLossStats> statistics() const;
+
+    static constexpr int kMaxSources = 255;
+    static constexpr uint32_t kWindowSize = 256;        ///< Expected messages per window, the rate covers the current and the previous window
+    static constexpr uint8_t kMaxReorderDistance = 16;  ///< Messages less than this far behind the newest are late arrivals
+    static constexpr uint8_t kMaxLossBurst = 64;        ///< Messages at most this far ahead of the expected one are loss, any other jump is a sequence restart
+
+private:
+    struct Window
+    {
+        void add(uint32_t expected, uint32_t lost);
+        void removeLoss();
+        float lossPercent() const;
+
+        uint32_t expected = 0;
+        uint32_t lost = 0;
+        uint32_t previousExpected = 0;
+        uint32_t previousLost = 0;
+    };
+
+    struct Source
+    {
+        uint8_t sysid = 0;
+        uint8_t compid = 0;
+        uint8_t lastSeq = 0;
+        quint64 received = 0;
+        quint64 lost = 0;
+        quint64 reordered = 0;
+        quint64 duplicates = 0;
+        quint64 restarts = 0;
+        Window window;
+        std::array<quint32, MAVLinkLossStats::kBurstBuckets> burstHistogram{};
+    };
+
+    std::array<uint8_t, 256 * 256> _sourceIndex{};      ///< Index + 1 of the source in _sources, 0: not seen yet
+    std::array<Source, kMaxSources> _sources{};
+    int _sourceCount = 0;
+
+    quint64 _received = 0;
+    quint64 _lost = 0;
+    quint64 _reordered = 0;
+    quint64 _duplicates = 0;
+    quint64 _restarts = 0;
+    Window _linkWindow;
+};
@@ -0,0 +1,114 @@
+#include "MAVLinkMessagePool.h"
+
+MAVLinkMessageRef MAVLinkMessageRef::fromMessage(const mavlink_message_t &message)
+{
+    auto *const buffer = new MAVLinkMessageBuffer;
+    buffer->message = message;
+    buffer->refCount.store(1, std::memory_order_relaxed);
+    return MAVLinkMessageRef(buffer);
+}
+
+mavlink_message_t *MAVLinkMessageRef::data()
+{
+    Q_ASSERT(useCount() == 1);
+    return (_buffer ? &_buffer->message : nullptr);
+}
+
+void MAVLinkMessageRef::_retain() const
+{
+    if (_buffer) {
+        (void) _buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MAVLinkMessageRef::_release()
+{
+    if (!_buffer) {
+        return;
+    }
+
+    MAVLinkMessageBuffer *const buffer = std::exchange(_buffer, nullptr);
+    if (buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (buffer->pool) {
+        buffer->pool->_recycle(buffer);
+    } else {
+        delete buffer;
+    }
+}
+
+/*===========================================================================*/
+
+MAVLinkMessagePool::~MAVLinkMessagePool()
+{
+    // Only reached once every buffer is back on a free list, the slabs own them all
+}
+
+void MAVLinkMessagePool::close()
+{
+    _unref();
+}
+
+MAVLinkMessageRef MAVLinkMessagePool::acquire()
+{
+    // Prefer returned buffers over untouched slab space, they are still warm in the cache
+    if (_returnedList.load(std::memory_order_relaxed)) {
+        MAVLinkMessageBuffer *const returned = _returnedList.exchange(nullptr, std::memory_order_acquire);
+        MAVLinkMessageBuffer *tail = returned;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = _freeList;
+        _freeList = returned;
+    } else if (!_freeList) {
+        _allocateSlab();
+    }
+
+    MAVLinkMessageBuffer *const buffer = _freeList;
+    _freeList = buffer->next;
+    buffer->next = nullptr;
+    buffer->refCount.store(1, std::memory_order_relaxed);
+
+    if (buffer->recycled) {
+        (void) _recycledCount.fetch_add(1, std::memory_order_relaxed);
+        (void) _totalAllocationsAvoided.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        buffer->recycled = true;
+    }
+    (void) _acquiredCount.fetch_add(1, std::memory_order_relaxed);
+    (void) _refs.fetch_add(1, std::memory_order_relaxed);
+
+    return MAVLinkMessageRef(buffer);
+}
+
+void MAVLinkMessagePool::_allocateSlab()
+{
+    std::unique_ptr<MAVLinkMessageBuffer[]> slab(new MAVLinkMessageBuffer[kSlabSize]);
+    for (int i = 0; i < kSlabSize; i++) {
+        slab[i].pool = this;
+        slab[i].next = (i + 1 < kSlabSize) ? &slab[i + 1] : nullptr;
+    }
+
+    _freeList = &slab[0];
+    _slabs.push_back(std::move(slab));
+    (void) _allocatedCount.fetch_add(kSlabSize, std::memory_order_relaxed);
+}
+
+void MAVLinkMessagePool::_recycle(MAVLinkMessageBuffer *buffer)
+{
+    MAVLinkMessageBuffer *head = _returnedList.load(std::memory_order_relaxed);
+    do {
+        buffer->next = head;
+    } while (!_returnedList.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+    _unref();
+}
+
+void MAVLinkMessagePool::_unref()
+{
+    if (_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QtCore/QMetaType>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MAVLinkLib.h"
+
+class MAVLinkMessagePool;
+
+/// Storage for a single pooled message. Only used through MAVLinkMessageRef.
+struct MAVLinkMessageBuffer
+{
+    mavlink_message_t message{};
+    std::atomic<int> refCount{0};
+    MAVLinkMessagePool *pool = nullptr;     ///< nullptr: heap allocated, deleted when the last reference goes away
+    bool recycled = false;                  ///< true: buffer has been handed out before
+    MAVLinkMessageBuffer *next = nullptr;   ///< Intrusive link used by the pool free lists
+};
+
+/// Reference counted, read-only handle to a received MAVLink message.
+/// Copying a handle only bumps the reference count so a message can be shared by any number of consumers,
+/// across direct and queued connections, without copying the ~290 byte mavlink_message_t.
+/// When the last handle goes away the buffer is returned to the pool of the link it was received on.
+class MAVLinkMessageRef
+{
+public:
+    MAVLinkMessageRef() = default;
+    MAVLinkMessageRef(const MAVLinkMessageRef &other) : _buffer(other._buffer) { _retain(); }
+    MAVLinkMessageRef(MAVLinkMessageRef &&other) noexcept : _buffer(std::exchange(other._buffer, nullptr)) {}
+    ~MAVLinkMessageRef() { _release(); }
+
+    MAVLinkMessageRef &operator=(MAVLinkMessageRef other) noexcept
+    {
+        std::swap(_buffer, other._buffer);
+        return *this;
+    }
+
+    /// Creates an unpooled message, for messages which do not come from a link framer
+    static MAVLinkMessageRef fromMessage(const mavlink_message_t &message);
+
+    bool isNull() const { return (_buffer == nullptr); }
+    const mavlink_message_t *get() const { return (_buffer ? &_buffer->message : nullptr); }
+    const mavlink_message_t &operator*() const { return _buffer->message; }
+    const mavlink_message_t *operator->() const { return &_buffer->message; }
+    int useCount() const { return (_buffer ? _buffer->refCount.load(std::memory_order_relaxed) : 0); }
+
+    /// Write access for the producer which filled the buffer. Only valid while the handle is not shared.
+    mavlink_message_t *data();
+
+private:
+    explicit MAVLinkMessageRef(MAVLinkMessageBuffer *buffer) : _buffer(buffer) {}
+
+    void _retain() const;
+    void _release();
+
+    MAVLinkMessageBuffer *_buffer = nullptr;
+
+    friend class MAVLinkMessagePool;
+};
+Q_DECLARE_METATYPE(MAVLinkMessageRef)
+
+/// Slab allocator of message buffers for the channel of a single link.
+/// acquire() must only be called by one thread at a time, normally the link worker thread which frames the bytes.
+/// Buffers are returned from whichever thread drops the last reference through a lock-free list, so after warm up
+/// received messages recycle buffers instead of allocating. The pool is kept alive by its owner and by every
+/// buffer which is still referenced, so messages queued or held by consumers remain valid after the link is gone.
+class MAVLinkMessagePool
+{
+public:
+    /// Creates a pool owned by the caller, which must call close() instead of deleting it
+    static MAVLinkMessagePool *create() { return new MAVLinkMessagePool; }
+
+    /// Releases the owner's reference. The pool is deleted once every outstanding buffer has been returned.
+    void close();
+
+    /// @return Unshared buffer for the framer to fill, with a reference count of one
+    MAVLinkMessageRef acquire();
+
+    quint64 acquired() const { return _acquiredCount.load(std::memory_order_relaxed); }
+    /// Number of buffers allocated by the pool, in slabs of kSlabSize
+    quint64 allocated() const { return _allocatedCount.load(std::memory_order_relaxed); }
+    /// Number of acquired messages which were served from a recycled buffer instead of a new allocation
+    quint64 allocationsAvoided() const { return _recycledCount.load(std::memory_order_relaxed); }
+
+    /// Allocations avoided by all pools since startup
+    static quint64 totalAllocationsAvoided() { return _totalAllocationsAvoided.load(std::memory_order_relaxed); }
+
+    static constexpr int kSlabSize = 64;    ///< Number of buffers allocated at once when the free lists are empty
+
+private:
+    MAVLinkMessagePool() = default;
+    ~MAVLinkMessagePool();
+    Q_DISABLE_COPY_MOVE(MAVLinkMessagePool)
+
+    void _recycle(MAVLinkMessageBuffer *buffer);
+    void _allocateSlab();
+    void _unref();
+
+    MAVLinkMessageBuffer *_freeList = nullptr;                  ///< Only touched by the acquiring thread
+    std::atomic<MAVLinkMessageBuffer*> _returnedList{nullptr};  ///< Buffers returned from any thread
+    std::atomic<int> _refs{1};                                  ///< Owner plus every buffer handed out
+    std::vector<std::unique_ptr<MAVLinkMessageBuffer[]>> _slabs;
+    std::atomic<quint64> _acquiredCount{0};
+    std::atomic<quint64> _allocatedCount{0};
+    std::atomic<quint64> _recycledCount{0};
+
+    static inline std::atomic<quint64> _totalAllocationsAvoided{0};
+
+    friend class MAVLinkMessageRef;
+};
@@ -1,9 +1,11 @@
 #include "MAVLinkProtocol.h"
 #include "AppSettings.h"
 #include "LinkManager.h"
+#include "MAVLinkLogWriter.h"
 #include "MavlinkSettings.h"
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
+#include "QGCCompression.h"
 #include "QGCFileHelper.h"
 #include "QGCLoggingCategory.h"
 #include "QmlObjectListModel.h"
@@ -24,8 +26,10 @@ Q_APPLICATION_STATIC(MAVLinkProtocol, _mavlinkProtocolInstance);
 
 MAVLinkProtocol::MAVLinkProtocol(QObject *parent)
     : QObject(parent)
-    , _tempLogFile(new QFile(this))
+    , _logWriter(new MAVLinkLogWriter(MAVLinkLogWriter::kDefaultCapacity, this))
 {
+    (void) connect(_logWriter, &MAVLinkLogWriter::writeError, this, &MAVLinkProtocol::_logWriteError, Qt::QueuedConnection);
+
     qCDebug(MAVLinkProtocolLog) << this;
 }
 
@@ -54,11 +58,7 @@ void MAVLinkProtocol::init()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    const uint8_t channel = link->mavlinkChannel();
-    _totalReceiveCounter[channel] = 0;
-    _totalLossCounter[channel] = 0;
-    _runningLossPercent[channel] = 0.f;
-
+    link->resetMavlinkStatistics();
     link->setDecodedFirstMavlinkPacket(false);
 }
 
@@ -66,23 +66,24 @@ void MAVLinkProtocol::logSentBytes(const LinkInterface *link, const QByteArray &
 {
     Q_UNUSED(link);
 
-    if (_logSuspendError || _logSuspendReplay || !_tempLogFile->isOpen()) {
+    if (_logSuspendError || _logSuspendReplay || !_logWriter->isOpen()) {
         return;
     }
 
-    const quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-    uint8_t bytes_time[sizeof(quint64)]{};
-    qToBigEndian(time, bytes_time);
+    // The timestamp is written ahead of the bytes by the log writer, no need to copy the data
+    (void) _logWriter->append(data);
+}
 
-    QByteArray logData = data;
-    QByteArray timeData = QByteArray::fromRawData(reinterpret_cast<const char*>(bytes_time), sizeof(bytes_time));
-    (void) logData.prepend(timeData);
-    if (_tempLogFile->write(logData) != logData.length()) {
-        const QString message = QStringLiteral("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile->fileName());
-        qgcApp()->showAppMessage(message, getName());
-        _stopLogging();
-        _logSuspendError = true;
+void MAVLinkProtocol::_logWriteError(const QString &errorString)
+{
+    if (!_logWriter->isOpen()) {
+        return;
     }
+
+    const QString message = QStringLiteral("MAVLink Logging failed. Could not write to file %1 (%2), logging disabled.").arg(_logWriter->fileName(), errorString);
+    qgcApp()->showAppMessage(message, getName());
+    _stopLogging();
+    _logSuspendError = true;
 }
 
 void MAVLinkProtocol::receiveBytes(LinkInterface *link, const QByteArray &data)
@@ -93,64 +94,74 @@ void MAVLinkProtocol::receiveBytes(LinkInterface *link, const QByteArray &data)
         return;
     }
 
-    for (uint8_t byte: data) {
-        const uint8_t mavlinkChannel = link->mavlinkChannel();
-        mavlink_message_t message{};
-        mavlink_status_t status{};
-
-        if (mavlink_parse_char(mavlinkChannel, byte, &message, &status) != MAVLINK_FRAMING_OK) {
-            continue;
-        }
+    MAVLinkMessageBatch batch;
+    (void) linkPtr->frameBytes(data, batch);
+    _processMessageBatch(linkPtr, batch);
+}
 
-        // It's ok to get v1 HEARTBEAT messages on a v2 link:
-        //  PX4 defaults to sending V1 then switches to V2 after receiving a V2 message from GCS
-        //  ArduPilot always sends both versions
-        if (message.msgid != MAVLINK_MSG_ID_HEARTBEAT && (status.flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
-            link->reportMavlinkV1Traffic();
-            continue;
-        }
+void MAVLinkProtocol::enqueueMessageBatch(MAVLinkMessageBatch *batch)
+{
+    if (_ingestQueue.push(batch)) {
+        (void) QMetaObject::invokeMethod(this, &MAVLinkProtocol::_processMessageBatches, Qt::QueuedConnection);
+    }
+}
 
-        _updateCounters(mavlinkChannel, message);
-        if (!linkPtr->linkConfiguration()->isForwarding()) {
-            _forward(message);
-            _forwardSupport(message);
+void MAVLinkProtocol::_processMessageBatches()
+{
+    (void) _ingestQueue.drain([this](MAVLinkMessageBatch &batch) {
+        const SharedLinkInterfacePtr linkPtr = batch.link.lock();
+        if (!linkPtr || !linkPtr->mavlinkChannelIsSet()) {
+            qCDebug(MAVLinkProtocolLog) << "_processMessageBatches: link gone!" << batch.messages.size() << "messages arrived too late";
+            return;
         }
-        _logData(link, message);
 
-        if (!_updateStatus(link, linkPtr, mavlinkChannel, message)) {
-            break;
-        }
-    }
+        _processMessageBatch(linkPtr, batch);
+    });
 }
 
-void MAVLinkProtocol::_updateCounters(uint8_t mavlinkChannel, const mavlink_message_t &message)
+void MAVLinkProtocol::_processMessageBatch(const SharedLinkInterfacePtr &linkPtr, const MAVLinkMessageBatch &batch)
 {
-    _totalReceiveCounter[mavlinkChannel]++;
-
-    uint8_t &lastSeq = _lastIndex[message.sysid][message.compid];
+    if (batch.mavlinkV1Traffic) {
+        linkPtr->reportMavlinkV1Traffic();
+    }
 
-    const QPair<uint8_t,uint8_t> key(message.sysid, message.compid);
-    uint8_t expectedSeq;
-    if (!_firstMessageSeen.contains(key)) {
-        _firstMessageSeen.insert(key);
-        expectedSeq = message.seq;
-    } else {
-        expectedSeq = lastSeq + 1;
+    // The framer checks signatures against its own copy of the signing, the channel timestamp is advanced from it here
+    if ((batch.signingTimestamp > 0) && linkPtr->mavlinkChannelIsSet()) {
+        mavlink_status_t *const status = mavlink_get_channel_status(linkPtr->mavlinkChannel());
+        if (status && status->signing && (batch.signingTimestamp > status->signing->timestamp)) {
+            status->signing->timestamp = batch.signingTimestamp;
+        }
     }
 
-    uint64_t lostMessages;
-    if (message.seq >= expectedSeq) {
-        lostMessages = message.seq - expectedSeq;
-    } else {
-        lostMessages = static_cast<uint64_t>(message.seq) + 256ULL - expectedSeq;
+    if (!batch.lossStatistics.isEmpty()) {
+        linkPtr->setLossStatistics(batch.lossStatistics);
+        emit lossStatisticsUpdated(linkPtr.get(), batch.lossStatistics);
     }
-    _totalLossCounter[mavlinkChannel] += lostMessages;
 
-    lastSeq = message.seq;
+    LinkInterface *const link = linkPtr.get();
+    const bool forwarding = linkPtr->linkConfiguration()->isForwarding();
+    qsizetype statusIndex = 0;
+    for (qsizetype i = 0; i < batch.messages.size(); i++) {
+        const MAVLinkMessageRef &message = batch.messages.at(i);
+        if (!forwarding) {
+            _forward(*message);
+            _forwardSupport(*message);
+        }
+        _logData(link, *message);
+
+        // A status update goes out right before the message which triggered it, so receivers see the status of that message
+        while ((statusIndex < batch.statusUpdates.size()) && (batch.statusUpdates.at(statusIndex).messageIndex == i)) {
+            const MAVLinkStatusUpdate &update = batch.statusUpdates.at(statusIndex++);
+            emit mavlinkMessageStatus(update.sysid, update.totalSent, update.totalReceived, update.totalLoss, update.lossPercent);
+        }
+
+        emit messageReceived(link, message);
 
-    const uint64_t totalSent = _totalReceiveCounter[mavlinkChannel] + _totalLossCounter[mavlinkChannel];
-    const float currentLossPercent = (static_cast<double>(_totalLossCounter[mavlinkChannel]) / totalSent) * 100.0f;
-    _runningLossPercent[mavlinkChannel] = (currentLossPercent + _runningLossPercent[mavlinkChannel]) * 0.5f;
+        if (linkPtr.use_count() == 1) {
+            // Link was removed while processing the batch
+            break;
+        }
+    }
 }
 
 void MAVLinkProtocol::_forward(const mavlink_message_t &message)
@@ -195,19 +206,12 @@ void MAVLinkProtocol::_forwardSupport(const mavlink_message_t &message)
 
 void MAVLinkProtocol::_logData(LinkInterface *link, const mavlink_message_t &message)
 {
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile->isOpen()) {
-        const quint64 timestamp = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-        uint8_t buf[MAVLINK_MAX_PACKET_LEN + sizeof(timestamp)]{};
-        qToBigEndian(timestamp, buf);
-
-        const qsizetype len = mavlink_msg_to_send_buffer(buf + sizeof(timestamp), &message) + sizeof(timestamp);
-        const QByteArray log_data(reinterpret_cast<const char*>(buf), len);
-        if (_tempLogFile->write(log_data) != len) {
-            const QString logErrorMessage = QStringLiteral("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile->fileName());
-            qgcApp()->showAppMessage(logErrorMessage, getName());
-            _stopLogging();
-            _logSuspendError = true;
-        }
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter->isOpen()) {
+        // Only copies the frame into the log writer's ring buffer, the file is written on the writer thread.
+        // A full ring drops the record and is counted by the writer rather than stalling message processing.
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN]{};
+        const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+        (void) _logWriter->append(QByteArrayView(buf, len));
 
         if ((message.msgid == MAVLINK_MSG_ID_HEARTBEAT) && !_vehicleWasArmed) {
             if (mavlink_msg_heartbeat_get_base_mode(&message) & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
@@ -244,35 +248,19 @@ void MAVLinkProtocol::_logData(LinkInterface *link, const mavlink_message_t &mes
     }
 }
 
-bool MAVLinkProtocol::_updateStatus(LinkInterface *link, const SharedLinkInterfacePtr linkPtr, uint8_t mavlinkChannel, const mavlink_message_t &message)
-{
-    if ((_totalReceiveCounter[mavlinkChannel] % 31) == 0) {
-        const uint64_t totalSent = _totalReceiveCounter[mavlinkChannel] + _totalLossCounter[mavlinkChannel];
-        emit mavlinkMessageStatus(message.sysid, totalSent, _totalReceiveCounter[mavlinkChannel], _totalLossCounter[mavlinkChannel], _runningLossPercent[mavlinkChannel]);
-    }
-
-    emit messageReceived(link, message);
-
-    if (linkPtr.use_count() == 1) {
-        return false;
-    }
-
-    return true;
-}
-
 bool MAVLinkProtocol::_closeLogFile()
 {
-    if (!_tempLogFile->isOpen()) {
+    if (!_logWriter->isOpen()) {
         return false;
     }
 
-    if (_tempLogFile->size() == 0) {
-        (void) _tempLogFile->remove();
+    _logWriter->close();
+
+    if (_logWriter->bytesWritten() == 0) {
+        (void) QFile::remove(_logWriter->fileName());
         return false;
     }
 
-    (void) _tempLogFile->flush();
-    _tempLogFile->close();
     return true;
 }
 
@@ -293,7 +281,7 @@ void MAVLinkProtocol::_startLogging()
     }
 #endif
 
-    if (_tempLogFile->isOpen()) {
+    if (_logWriter->isOpen()) {
         return;
     }
 
@@ -301,27 +289,28 @@ void MAVLinkProtocol::_startLogging()
         return;
     }
 
-    // Generate unique temp file path for this logging session
+    const auto compression = static_cast<MAVLinkLogWriter::Compression>(
+        SettingsManager::instance()->mavlinkSettings()->telemetryCompression()->rawValue().toUInt());
+
+    // Generate unique temp file path for this logging session, compressed logs carry the compression suffix
     const QString logPath = QGCFileHelper::uniqueTempPath(
-        QStringLiteral("%1.%2").arg(_tempLogFileTemplate, _logFileExtension));
+        QStringLiteral("%1.%2%3").arg(_tempLogFileTemplate, _logFileExtension, MAVLinkLogWriter::fileExtension(compression)));
     if (logPath.isEmpty()) {
         qCWarning(MAVLinkProtocolLog) << "Failed to generate temp log path";
         _logSuspendError = true;
         return;
     }
 
-    _tempLogFile->setFileName(logPath);
-    if (!_tempLogFile->open(QIODevice::WriteOnly)) {
+    if (!_logWriter->open(logPath, compression)) {
         const QString message = QStringLiteral("Opening Flight Data file for writing failed. "
             "Unable to write to %1. Please choose a different file location.")
-            .arg(_tempLogFile->fileName());
+            .arg(logPath);
         qgcApp()->showAppMessage(message, getName());
-        _closeLogFile();
         _logSuspendError = true;
         return;
     }
 
-    qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile->fileName();
+    qCDebug(MAVLinkProtocolLog) << "Temp log" << _logWriter->fileName();
     (void) _checkTelemetrySavePath();
 
     _logSuspendError = false;
@@ -329,15 +318,15 @@ void MAVLinkProtocol::_startLogging()
 
 void MAVLinkProtocol::_stopLogging()
 {
-    if (_tempLogFile->isOpen() && _closeLogFile()) {
+    if (_logWriter->isOpen() && _closeLogFile()) {
         auto appSettings = SettingsManager::instance()->appSettings();
         auto mavlinkSettings = SettingsManager::instance()->mavlinkSettings();
         if ((_vehicleWasArmed || mavlinkSettings->telemetrySaveNotArmed()->rawValue().toBool()) &&
                 mavlinkSettings->telemetrySave()->rawValue().toBool() &&
                 !appSettings->disableAllPersistence()->rawValue().toBool()) {
-            _saveTelemetryLog(_tempLogFile->fileName());
+            _saveTelemetryLog(_logWriter->fileName());
         } else {
-            (void) QFile::remove(_tempLogFile->fileName());
+            (void) QFile::remove(_logWriter->fileName());
         }
     }
 
@@ -347,10 +336,8 @@ void MAVLinkProtocol::_stopLogging()
 void MAVLinkProtocol::checkForLostLogFiles()
 {
     static const QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
-    static const QString filter(QStringLiteral("*.%1").arg(_logFileExtension));
-    static const QStringList filterList(filter);
 
-    const QFileInfoList fileInfoList = tempDir.entryInfoList(filterList, QDir::Files);
+    const QFileInfoList fileInfoList = tempDir.entryInfoList(_tempLogFileFilters(), QDir::Files);
     qCDebug(MAVLinkProtocolLog) << "Orphaned log file count" << fileInfoList.count();
 
     for (const QFileInfo &fileInfo: fileInfoList) {
@@ -363,12 +350,21 @@ void MAVLinkProtocol::checkForLostLogFiles()
     }
 }
 
+QStringList MAVLinkProtocol::_tempLogFileFilters()
+{
+    const QString filter = QStringLiteral("*.%1").arg(_logFileExtension);
+    return {
+        filter,
+        filter + MAVLinkLogWriter::fileExtension(MAVLinkLogWriter::Compression::Zstd),
+        filter + MAVLinkLogWriter::fileExtension(MAVLinkLogWriter::Compression::Xz),
+    };
+}
+
 void MAVLinkProtocol::deleteTempLogFiles()
 {
     static const QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
-    static const QString filter(QStringLiteral("*.%1").arg(_logFileExtension));
 
-    const QFileInfoList fileInfoList = tempDir.entryInfoList(QStringList(filter), QDir::Files);
+    const QFileInfoList fileInfoList = tempDir.entryInfoList(_tempLogFileFilters(), QDir::Files);
     qCDebug(MAVLinkProtocolLog) << "Temp log file count" << fileInfoList.count();
 
     for (const QFileInfo &fileInfo: fileInfoList) {
@@ -383,13 +379,20 @@ void MAVLinkProtocol::_saveTelemetryLog(const QString &tempLogfile)
         const QString saveDirPath = SettingsManager::instance()->appSettings()->telemetrySavePath();
         const QDir saveDir(saveDirPath);
 
-        const QString nameFormat("%1%2.%3");
+        const QString nameFormat("%1%2.%3%4");
         const QString dtFormat("yyyy-MM-dd hh-mm-ss");
 
+        // Compressed temp logs are copied as is, the saved log keeps the compression suffix (.tlog.zst)
+        QString compressionExtension;
+        const QGCCompression::Format format = QGCCompression::detectFormat(tempLogfile, false);
+        if (QGCCompression::isCompressionFormat(format)) {
+            compressionExtension = QGCCompression::formatExtension(format);
+        }
+
         int tryIndex = 1;
-        QString saveFileName = nameFormat.arg(QDateTime::currentDateTime().toString(dtFormat), QString(), AppSettings::telemetryFileExtension);
+        QString saveFileName = nameFormat.arg(QDateTime::currentDateTime().toString(dtFormat), QString(), AppSettings::telemetryFileExtension, compressionExtension);
         while (saveDir.exists(saveFileName)) {
-            saveFileName = nameFormat.arg(QDateTime::currentDateTime().toString(dtFormat), QStringLiteral(".%1").arg(tryIndex++), AppSettings::telemetryFileExtension);
+            saveFileName = nameFormat.arg(QDateTime::currentDateTime().toString(dtFormat), QStringLiteral(".%1").arg(tryIndex++), AppSettings::telemetryFileExtension, compressionExtension);
         }
 
         const QString saveFilePath = saveDir.absoluteFilePath(saveFileName);
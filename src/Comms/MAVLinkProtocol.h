@@ -4,11 +4,13 @@
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
 #include "LinkInterface.h"
+#include "MAVLinkIngest.h"
 #include "MAVLinkLib.h"
 
-class QFile;
+class MAVLinkLogWriter;
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLog)
 
@@ -53,15 +55,23 @@ class MAVLinkProtocol : public QObject
     /// Give the user an option to save these orphaned files.
     void checkForLostLogFiles();
 
+    /// Queues messages framed on a link worker thread for processing on the main thread.
+    /// Thread safe and lock-free. Takes ownership of @p batch.
+    void enqueueMessageBatch(MAVLinkMessageBatch *batch);
+
 signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface *link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /// Message received and directly copied via signal
-    void messageReceived(LinkInterface *link, const mavlink_message_t &message);
+    /// Message received. The message is a shared, read-only pooled buffer: receivers, including queued
+    /// ones, can hold on to the handle without copying the message.
+    void messageReceived(LinkInterface *link, const MAVLinkMessageRef &message);
 
     void mavlinkMessageStatus(int sysid, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
 
+    /// Per source sequence loss snapshot of @a link, published about once a second while messages arrive
+    void lossStatisticsUpdated(LinkInterface *link, const QList<MAVLinkLossStats> &statistics);
+
 public slots:
     /// Receive bytes from a communication interface and constructs a MAVLink packet
     ///     @param link The interface to read from
@@ -77,8 +87,11 @@ public slots:
 
 private slots:
     void _vehicleCountChanged();
+    void _logWriteError(const QString &errorString);
 
 private:
+    void _processMessageBatches();
+    void _processMessageBatch(const SharedLinkInterfacePtr &linkPtr, const MAVLinkMessageBatch &batch);
     void _logData(LinkInterface *link, const mavlink_message_t &message);
     bool _closeLogFile();
     void _startLogging();
@@ -87,24 +100,18 @@ private slots:
     void _forward(const mavlink_message_t &message);
     void _forwardSupport(const mavlink_message_t &message);
 
-    void _updateCounters(uint8_t mavlinkChannel, const mavlink_message_t &message);
-    bool _updateStatus(LinkInterface *link, const SharedLinkInterfacePtr linkPtr, uint8_t mavlinkChannel, const mavlink_message_t &message);
-
     void _saveTelemetryLog(const QString &tempLogfile);
+    /// Name filters matching uncompressed and compressed temp log files
+    static QStringList _tempLogFileFilters();
     bool _checkTelemetrySavePath();
 
-    QFile *_tempLogFile = nullptr;
+    MAVLinkLogWriter *_logWriter = nullptr;
+    MAVLinkIngestQueue _ingestQueue;
 
     bool _logSuspendError = false;  ///< true: Logging suspended due to error
     bool _logSuspendReplay = false; ///< true: Logging suspended due to replay
     bool _vehicleWasArmed = false;  ///< true: Vehicle was armed during log sequence
 
-    uint8_t _lastIndex[256][256]{};                             ///< Store the last received sequence ID for each system/component pair
-    QSet<QPair<uint8_t,uint8_t>> _firstMessageSeen;
-    uint64_t _totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS]{};  ///< The total number of successfully received messages
-    uint64_t _totalLossCounter[MAVLINK_COMM_NUM_BUFFERS]{};     ///< Total messages lost during transmission.
-    float _runningLossPercent[MAVLINK_COMM_NUM_BUFFERS]{};      ///< Loss rate
-
     bool _initialized = false;
 
     static constexpr const char *_tempLogFileTemplate = "FlightDataXXXXXX"; ///< Template for temporary log file
@@ -263,7 +263,7 @@ TCPLink::TCPLink(SharedLinkConfigurationPtr &config, QObject *parent)
     (void) connect(_worker, &TCPWorker::connected, this, &TCPLink::_onConnected, Qt::QueuedConnection);
     (void) connect(_worker, &TCPWorker::disconnected, this, &TCPLink::_onDisconnected, Qt::QueuedConnection);
     (void) connect(_worker, &TCPWorker::errorOccurred, this, &TCPLink::_onErrorOccurred, Qt::QueuedConnection);
-    (void) connect(_worker, &TCPWorker::dataReceived, this, &TCPLink::_onDataReceived, Qt::QueuedConnection);
+    (void) connect(_worker, &TCPWorker::dataReceived, this, &TCPLink::_onDataReceived, Qt::DirectConnection);
     (void) connect(_worker, &TCPWorker::dataSent, this, &TCPLink::_onDataSent, Qt::QueuedConnection);
 
     _workerThread->start();
@@ -322,7 +322,8 @@ void TCPLink::_onErrorOccurred(const QString &errorString)
 
 void TCPLink::_onDataReceived(const QByteArray &data)
 {
-    emit bytesReceived(this, data);
+    // Runs on the worker thread
+    _workerBytesReceived(data);
 }
 
 void TCPLink::_onDataSent(const QByteArray &data)
@@ -568,7 +568,7 @@ UDPLink::UDPLink(SharedLinkConfigurationPtr &config, QObject *parent)
     (void) connect(_worker, &UDPWorker::connected, this, &UDPLink::_onConnected, Qt::QueuedConnection);
     (void) connect(_worker, &UDPWorker::disconnected, this, &UDPLink::_onDisconnected, Qt::QueuedConnection);
     (void) connect(_worker, &UDPWorker::errorOccurred, this, &UDPLink::_onErrorOccurred, Qt::QueuedConnection);
-    (void) connect(_worker, &UDPWorker::dataReceived, this, &UDPLink::_onDataReceived, Qt::QueuedConnection);
+    (void) connect(_worker, &UDPWorker::dataReceived, this, &UDPLink::_onDataReceived, Qt::DirectConnection);
     (void) connect(_worker, &UDPWorker::dataSent, this, &UDPLink::_onDataSent, Qt::QueuedConnection);
 
     _workerThread->start();
@@ -627,7 +627,8 @@ void UDPLink::_onErrorOccurred(const QString &errorString)
 
 void UDPLink::_onDataReceived(const QByteArray &data)
 {
-    emit bytesReceived(this, data);
+    // Runs on the worker thread
+    _workerBytesReceived(data);
 }
 
 void UDPLink::_onDataSent(const QByteArray &data)
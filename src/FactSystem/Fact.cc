@@ -1,4 +1,5 @@
 #include "Fact.h"
+#include "FactNotificationCoalescer.h"
 #include "FactValueSliderListModel.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
@@ -69,6 +70,10 @@ Fact::Fact(const Fact &other, QObject *parent)
 Fact::~Fact()
 {
     // qCDebug(FactLog) << Q_FUNC_INFO << this;
+
+    if (_frameNotificationPending) {
+        FactNotificationCoalescer::instance()->remove(this);
+    }
 }
 
 void Fact::_init()
@@ -141,6 +146,12 @@ void Fact::setRawValue(const QVariant &value)
             }
 
             if (changed) {
+                if (_frameSynchronised && _queueFrameNotification()) {
+                    // containerRawValueChanged follows valueChanged in the frame notification, keeping the order below
+                    _frameContainerNotification = true;
+                    return;
+                }
+
                 const QVariant cooked = _metaData->rawTranslator()(typedValue);
                 _sendValueChangedSignal(cooked);
                 //-- Must be in this order
@@ -190,7 +201,6 @@ void Fact::setEnumIndex(int index)
 
 void Fact::containerSetRawValue(const QVariant &value)
 {
-    QVariant cooked;
     QVariant currentRaw = value;
     bool changed = false;
     {
@@ -200,14 +210,10 @@ void Fact::containerSetRawValue(const QVariant &value)
             changed = true;
         }
         currentRaw = _rawValue;
-        if (_metaData) {
-            cooked = _metaData->rawTranslator()(_rawValue);
-        } else {
-            cooked = _rawValue;
-        }
     }
 
-    if (changed) {
+    if (changed && !(_frameSynchronised && _queueFrameNotification())) {
+        const QVariant cooked = _metaData ? _metaData->rawTranslator()(currentRaw) : currentRaw;
         _sendValueChangedSignal(cooked);
         emit rawValueChanged(currentRaw);
     }
@@ -770,6 +776,24 @@ void Fact::sendDeferredValueChangedSignal()
     }
 }
 
+bool Fact::_queueFrameNotification()
+{
+    return FactNotificationCoalescer::instance()->queue(this);
+}
+
+void Fact::_sendFrameNotification()
+{
+    // The cooked value is only translated here, once per frame, not for every update
+    const QVariant raw = rawValue();
+    _sendValueChangedSignal(_metaData ? _metaData->rawTranslator()(raw) : raw);
+    //-- Must be in this order, see setRawValue
+    if (_frameContainerNotification) {
+        _frameContainerNotification = false;
+        emit containerRawValueChanged(raw);
+    }
+    emit rawValueChanged(raw);
+}
+
 QString Fact::enumOrValueString()
 {
     if (_metaData) {
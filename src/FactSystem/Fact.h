@@ -160,6 +160,12 @@ class Fact : public QObject
     void clearDeferredValueChangeSignal() { _deferredValueChangeSignal = false; }
     void sendDeferredValueChangedSignal();
 
+    /// Frame synchronised Facts send their value change signals from the FactNotificationCoalescer frame tick
+    /// while it is enabled, rather than on every update. Used by the vehicle telemetry FactGroups, other
+    /// Facts rely on the signals being sent synchronously.
+    void setFrameSynchronised(bool frameSynchronised) { _frameSynchronised = frameSynchronised; }
+    bool frameSynchronised() const { return _frameSynchronised; }
+
     /// Sets and sends new value to vehicle even if value is the same
     void forceSetRawValue(const QVariant &value);
 
@@ -207,6 +213,9 @@ class Fact : public QObject
     FactMetaData *_metaData = nullptr;
     bool _sendValueChangedSignals = true;
     bool _deferredValueChangeSignal = false;
+    bool _frameSynchronised = false;
+    bool _frameNotificationPending = false;    ///< Queued in FactNotificationCoalescer
+    bool _frameContainerNotification = false;  ///< The queued notification also sends containerRawValueChanged
     FactValueSliderListModel *_valueSliderModel = nullptr;
 
     static constexpr const char *kMissingMetadata = "Meta data pointer missing";
@@ -216,4 +225,9 @@ private slots:
 
 private:
     void _init();
+    /// @return true: the value change signals were queued for the next frame
+    bool _queueFrameNotification();
+    void _sendFrameNotification();
+
+    friend class FactNotificationCoalescer;
 };
@@ -3,20 +3,22 @@
 
 QGC_LOGGING_CATEGORY(FactGroupLog, "FactSystem.FactGroup")
 
-FactGroup::FactGroup(int updateRateMsecs, const QString &metaDataFile, QObject *parent, bool ignoreCamelCase)
+FactGroup::FactGroup(int updateRateMsecs, const QString &metaDataFile, QObject *parent, bool ignoreCamelCase, bool frameSynchronised)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
+    , _frameSynchronised(frameSynchronised)
 {
     // qCDebug(FactGroupLog) << Q_FUNC_INFO << this;
     _setupTimer();
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
 }
 
-FactGroup::FactGroup(int updateRateMsecs, QObject *parent, bool ignoreCamelCase)
+FactGroup::FactGroup(int updateRateMsecs, QObject *parent, bool ignoreCamelCase, bool frameSynchronised)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
+    , _frameSynchronised(frameSynchronised)
 {
     // qCDebug(FactGroupLog) << Q_FUNC_INFO << this;
     _setupTimer();
@@ -118,6 +120,7 @@ void FactGroup::_addFact(Fact *fact, const QString &name)
     }
 
     fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    fact->setFrameSynchronised(_frameSynchronised);
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -176,3 +179,9 @@ void FactGroup::_setTelemetryAvailable (bool telemetryAvailable)
         emit telemetryAvailableChanged(_telemetryAvailable);
     }
 }
+
+void FactGroup::_setHandledMessageIds(const QList<uint32_t> &msgIds)
+{
+    _handlesAllMessages = false;
+    _handledMessageIds = msgIds;
+}
@@ -2,6 +2,7 @@
 
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QJsonArray>
+#include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QStringList>
 #include <QtCore/QTimer>
@@ -25,8 +26,10 @@ class FactGroup : public QObject
     Q_PROPERTY(bool         telemetryAvailable  READ telemetryAvailable NOTIFY telemetryAvailableChanged)   ///< false: No telemetry for these values has been received
 
 public:
-    explicit FactGroup(int updateRateMsecs, const QString &metaDataFile, QObject *parent = nullptr, bool ignoreCamelCase = false);
-    explicit FactGroup(int updateRateMsecs, QObject *parent = nullptr, bool ignoreCamelCase = false);
+    /// @param frameSynchronised true: the Facts of the group are frame synchronised, see Fact::setFrameSynchronised.
+    ///                          Only for telemetry groups whose Facts nobody needs to see every change of synchronously.
+    explicit FactGroup(int updateRateMsecs, const QString &metaDataFile, QObject *parent = nullptr, bool ignoreCamelCase = false, bool frameSynchronised = false);
+    explicit FactGroup(int updateRateMsecs, QObject *parent = nullptr, bool ignoreCamelCase = false, bool frameSynchronised = false);
     virtual ~FactGroup();
 
     /// @ return true: if the fact exists in the group
@@ -51,6 +54,11 @@ class FactGroup : public QObject
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle * /*vehicle*/, const mavlink_message_t & /*message*/) {}
 
+    /// @return true: handleMessage is called for every message, false: only for handledMessageIds()
+    bool handlesAllMessages() const { return _handlesAllMessages; }
+    /// Message ids Vehicle subscribes this FactGroup's handleMessage to in its dispatch table
+    const QList<uint32_t> &handledMessageIds() const { return _handledMessageIds; }
+
 signals:
     void factNamesChanged();
     void factGroupNamesChanged();
@@ -66,6 +74,9 @@ protected slots:
     void _addFactGroup(FactGroup *factGroup) { _addFactGroup(factGroup, factGroup->objectName()); }
     void _loadFromJsonArray(const QJsonArray &jsonArray);
     void _setTelemetryAvailable(bool telemetryAvailable);
+    /// Restricts handleMessage to the specified message ids. FactGroups which do not call this
+    /// are offered every message. Pass an empty list if the FactGroup does not handle messages.
+    void _setHandledMessageIds(const QList<uint32_t> &msgIds);
 
     const int _updateRateMSecs = 0;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
 
@@ -80,5 +91,8 @@ protected slots:
 
     QTimer _updateTimer;
     const bool _ignoreCamelCase = false;
+    const bool _frameSynchronised = false;
     bool _telemetryAvailable = false;
+    bool _handlesAllMessages = true;
+    QList<uint32_t> _handledMessageIds;
 };
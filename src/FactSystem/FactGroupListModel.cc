@@ -1,9 +1,10 @@
 #include "FactGroupListModel.h"
 #include "Vehicle.h"
 
-FactGroupListModel::FactGroupListModel(const char* factGroupNamePrefix, QObject* parent)
+FactGroupListModel::FactGroupListModel(const char* factGroupNamePrefix, const QList<uint32_t> &handledMessageIds, QObject* parent)
     : QmlObjectListModel(parent)
     , _factGroupNamePrefix(factGroupNamePrefix)
+    , _handledMessageIds(handledMessageIds)
 {
 
 }
@@ -14,11 +14,14 @@ class FactGroupListModel : public QmlObjectListModel
     QML_UNCREATABLE("")
 
 public:
-    explicit FactGroupListModel(const char* factGroupNamePrefix, QObject* parent = nullptr);
+    explicit FactGroupListModel(const char* factGroupNamePrefix, const QList<uint32_t> &handledMessageIds, QObject* parent = nullptr);
 
     /// Allows for creation/updating of dynamic FactGroups based on incoming messages
     void handleMessageForFactGroupCreation(Vehicle *vehicle, const mavlink_message_t &message);
 
+    /// Message ids which may result in the creation of a new FactGroup, used to subscribe handleMessageForFactGroupCreation
+    const QList<uint32_t> &handledMessageIds() const { return _handledMessageIds; }
+
 protected:
     virtual bool _shouldHandleMessage(const mavlink_message_t &message, QList<uint32_t> &ids) const = 0;
     virtual FactGroupWithId *_createFactGroupWithId(uint32_t id) = 0;
@@ -27,4 +30,5 @@ class FactGroupListModel : public QmlObjectListModel
     QString _factGroupNameWithId(uint32_t id) const;
 
     const char* _factGroupNamePrefix;
+    const QList<uint32_t> _handledMessageIds;
 };
@@ -1,7 +1,7 @@
 #include "FactGroupWithId.h"
 
-FactGroupWithId::FactGroupWithId(int updateRateMsecs, const QString &metaDataFile, QObject *parent, bool ignoreCamelCase)
-    : FactGroup(updateRateMsecs, metaDataFile, parent, ignoreCamelCase)
+FactGroupWithId::FactGroupWithId(int updateRateMsecs, const QString &metaDataFile, QObject *parent, bool ignoreCamelCase, bool frameSynchronised)
+    : FactGroup(updateRateMsecs, metaDataFile, parent, ignoreCamelCase, frameSynchronised)
 {
     _addFact(&_idFact);
 }
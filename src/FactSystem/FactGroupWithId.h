@@ -12,7 +12,7 @@ class FactGroupWithId : public FactGroup
     Q_PROPERTY(Fact *id READ id CONSTANT)
 
 public:
-    explicit FactGroupWithId(int updateRateMsecs, const QString &metaDataFile, QObject *parent = nullptr, bool ignoreCamelCase = false);
+    explicit FactGroupWithId(int updateRateMsecs, const QString &metaDataFile, QObject *parent = nullptr, bool ignoreCamelCase = false, bool frameSynchronised = false);
 
     Fact *id() { return &_idFact; }
 
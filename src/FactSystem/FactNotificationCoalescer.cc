@@ -0,0 +1,126 @@
+#include "FactNotificationCoalescer.h"
+#include "Fact.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QApplicationStatic>
+#include <QtCore/QThread>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
+
+QGC_LOGGING_CATEGORY(FactNotificationCoalescerLog, "FactSystem.FactNotificationCoalescer")
+
+Q_APPLICATION_STATIC(FactNotificationCoalescer, _factNotificationCoalescerInstance);
+
+FactNotificationCoalescer::FactNotificationCoalescer(QObject *parent)
+    : QObject(parent)
+{
+    // The tick follows the refresh rate of the display, notifications any faster than that are never seen
+    int frameIntervalMSecs = kDefaultFrameIntervalMSecs;
+    const QScreen *const screen = qobject_cast<QGuiApplication*>(QCoreApplication::instance()) ? QGuiApplication::primaryScreen() : nullptr;
+    if (screen && (screen->refreshRate() > 0)) {
+        frameIntervalMSecs = qBound(4, qRound(1000. / screen->refreshRate()), 100);
+    }
+
+    _frameTimer.setSingleShot(true);
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    _frameTimer.setInterval(frameIntervalMSecs);
+    (void) connect(&_frameTimer, &QTimer::timeout, this, &FactNotificationCoalescer::_frame);
+
+    qCDebug(FactNotificationCoalescerLog) << this << "frame interval" << frameIntervalMSecs << "ms";
+}
+
+FactNotificationCoalescer::~FactNotificationCoalescer()
+{
+    qCDebug(FactNotificationCoalescerLog) << this;
+}
+
+FactNotificationCoalescer *FactNotificationCoalescer::instance()
+{
+    return _factNotificationCoalescerInstance();
+}
+
+void FactNotificationCoalescer::setEnabled(bool enabled)
+{
+    if (enabled == _enabled) {
+        return;
+    }
+
+    if (!enabled) {
+        flush();
+    }
+    _enabled = enabled;
+    _statisticsTimer.start();
+
+    qCDebug(FactNotificationCoalescerLog) << "Frame synchronised notifications" << (enabled ? "enabled" : "disabled");
+}
+
+bool FactNotificationCoalescer::queue(Fact *fact)
+{
+    if (!_enabled || (QThread::currentThread() != thread())) {
+        return false;
+    }
+
+    if (fact->_frameNotificationPending) {
+        // The queued notification will carry this value instead of the one it was queued for
+        _suppressedSignals += kSignalsPerNotification;
+        return true;
+    }
+
+    fact->_frameNotificationPending = true;
+    _queue.append(fact);
+    if (!_frameTimer.isActive()) {
+        _frameTimer.start();
+    }
+
+    return true;
+}
+
+void FactNotificationCoalescer::remove(Fact *fact)
+{
+    if (fact->_frameNotificationPending) {
+        fact->_frameNotificationPending = false;
+        (void) _queue.removeOne(fact);
+    }
+}
+
+void FactNotificationCoalescer::flush()
+{
+    // Only the Facts queued so far, Facts changed by the receivers of these signals wait for the next frame.
+    // Facts are taken off the queue one at a time so a receiver may destroy a Fact which is still queued.
+    qsizetype count = _queue.size();
+    if (count == 0) {
+        return;
+    }
+
+    _frames++;
+    while ((count-- > 0) && !_queue.isEmpty()) {
+        Fact *const fact = _queue.takeFirst();
+        fact->_frameNotificationPending = false;
+        fact->_sendFrameNotification();
+        _emittedSignals += kSignalsPerNotification;
+    }
+
+    if (!_queue.isEmpty()) {
+        _frameTimer.start();
+    }
+}
+
+void FactNotificationCoalescer::_frame()
+{
+    flush();
+
+    if (_statisticsTimer.isValid() && (_statisticsTimer.elapsed() >= kStatisticsIntervalMSecs)) {
+        qCDebug(FactNotificationCoalescerLog) << "frames" << _frames
+                                              << "emitted signals" << _emittedSignals
+                                              << "suppressed signals" << _suppressedSignals;
+        _statisticsTimer.restart();
+    }
+}
+
+void FactNotificationCoalescer::resetStatistics()
+{
+    _suppressedSignals = 0;
+    _emittedSignals = 0;
+    _frames = 0;
+    _statisticsTimer.start();
+}
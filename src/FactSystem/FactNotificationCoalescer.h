@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+class Fact;
+
+Q_DECLARE_LOGGING_CATEGORY(FactNotificationCoalescerLog)
+
+/// Batches the value change notifications of frame synchronised Facts (the telemetry Facts of FactGroups)
+/// to the display frame rate. While enabled, an update to such a Fact only stores the new value and queues
+/// the Fact. Once per frame every queued Fact emits a single valueChanged/rawValueChanged carrying its latest
+/// value, so QML bindings are evaluated at most once per frame no matter how fast the telemetry arrives.
+/// Lives on the main thread, updates made on other threads are notified immediately as before.
+class FactNotificationCoalescer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FactNotificationCoalescer(QObject *parent = nullptr);
+    ~FactNotificationCoalescer();
+
+    static FactNotificationCoalescer *instance();
+
+    bool enabled() const { return _enabled; }
+    /// Disabling sends the notifications still queued
+    void setEnabled(bool enabled);
+
+    int frameIntervalMSecs() const { return _frameTimer.interval(); }
+    void setFrameIntervalMSecs(int frameIntervalMSecs) { _frameTimer.setInterval(frameIntervalMSecs); }
+
+    /// Queues the notifications for a changed Fact until the next frame
+    ///     @return false: not queued, the caller must notify immediately
+    bool queue(Fact *fact);
+    /// Drops a queued Fact, called when it is destroyed
+    void remove(Fact *fact);
+    /// Sends all queued notifications now
+    void flush();
+
+    /// Value change signals not emitted because a newer value replaced a queued one
+    quint64 suppressedSignals() const { return _suppressedSignals; }
+    /// Value change signals emitted from the frame tick
+    quint64 emittedSignals() const { return _emittedSignals; }
+    /// Frame ticks which had notifications to send
+    quint64 frames() const { return _frames; }
+    void resetStatistics();
+
+    static constexpr int kDefaultFrameIntervalMSecs = 16;
+    static constexpr int kSignalsPerNotification = 2;       ///< valueChanged and rawValueChanged
+    static constexpr int kStatisticsIntervalMSecs = 10000;  ///< Interval of the statistics debug output
+
+private slots:
+    void _frame();
+
+private:
+    QList<Fact*> _queue;
+    QTimer _frameTimer;
+    bool _enabled = false;
+
+    quint64 _suppressedSignals = 0;
+    quint64 _emittedSignals = 0;
+    quint64 _frames = 0;
+    QElapsedTimer _statisticsTimer;
+};
@@ -0,0 +1,331 @@
+#include "ParameterCache.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QSaveFile>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+QGC_LOGGING_CATEGORY(ParameterCacheLog, "FactSystem.ParameterCache")
+
+namespace {
+
+bool isSlotType(FactMetaData::ValueType_t type)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeUint32:
+    case FactMetaData::valueTypeInt32:
+    case FactMetaData::valueTypeUint64:
+    case FactMetaData::valueTypeInt64:
+    case FactMetaData::valueTypeFloat:
+    case FactMetaData::valueTypeDouble:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+ParameterCache::~ParameterCache()
+{
+    close();
+}
+
+bool ParameterCache::save(const QString &fileName, QList<Param_t> params, QString *errorString)
+{
+    QList<QByteArray> names;
+    names.reserve(params.size());
+    for (const Param_t &param : params) {
+        names.append(param.name.toUtf8());
+    }
+
+    // Sort by name bytes so lookups can binary search the mapped table
+    QList<int> order(params.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&names](int a, int b) {
+        return (names.at(a) < names.at(b));
+    });
+
+    QByteArray nameTable;
+    QByteArray values;
+    QByteArray namePool;
+    nameTable.reserve(order.size() * kNameEntrySize);
+    values.reserve(order.size() * kValueSize);
+
+    int count = 0;
+    const QByteArray *previousName = nullptr;
+    for (const int index : order) {
+        const Param_t &param = params.at(index);
+        const QByteArray &name = names.at(index);
+        if (previousName && (*previousName == name)) {
+            qCWarning(ParameterCacheLog) << "Duplicate parameter" << param.name;
+            continue;
+        }
+        if (name.isEmpty() || (name.size() > std::numeric_limits<quint16>::max())) {
+            qCWarning(ParameterCacheLog) << "Invalid parameter name" << param.name;
+            continue;
+        }
+
+        uchar slot[kValueSize] = {};
+        if (!_encodeValue(param.type, param.rawValue, slot)) {
+            qCWarning(ParameterCacheLog) << "Unsupported parameter type" << param.name << param.type;
+            continue;
+        }
+
+        uchar entry[kNameEntrySize] = {};
+        qToLittleEndian<quint32>(static_cast<quint32>(namePool.size()), entry);
+        qToLittleEndian<quint16>(static_cast<quint16>(name.size()), entry + 4);
+        entry[6] = static_cast<uchar>(param.type);
+
+        nameTable.append(reinterpret_cast<const char*>(entry), kNameEntrySize);
+        values.append(reinterpret_cast<const char*>(slot), kValueSize);
+        namePool.append(name);
+        previousName = &name;
+        count++;
+    }
+
+    QByteArray body;
+    body.reserve(nameTable.size() + values.size() + namePool.size());
+    body.append(nameTable).append(values).append(namePool);
+
+    uchar header[kHeaderSize] = {};
+    qToLittleEndian<quint32>(kMagic, header);
+    qToLittleEndian<quint32>(kVersion, header + 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(count), header + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(namePool.size()), header + 12);
+    qToLittleEndian<quint32>(QGC::crc32(reinterpret_cast<const quint8*>(body.constData()), static_cast<unsigned>(body.size()), 0), header + 16);
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    if ((file.write(reinterpret_cast<const char*>(header), kHeaderSize) != kHeaderSize) || (file.write(body) != body.size()) || !file.commit()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    qCDebug(ParameterCacheLog) << fileName << "saved" << count << "parameters," << (kHeaderSize + body.size()) << "bytes";
+
+    return true;
+}
+
+bool ParameterCache::open(const QString &fileName)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return _fail(_file.errorString());
+    }
+
+    _size = _file.size();
+    if (_size < kHeaderSize) {
+        return _fail(QStringLiteral("Parameter cache is truncated"));
+    }
+
+    _data = _file.map(0, _size);
+    if (!_data) {
+        return _fail(_file.errorString());
+    }
+
+    if (qFromLittleEndian<quint32>(_data) != kMagic) {
+        return _fail(QStringLiteral("Not a parameter cache"));
+    }
+    const quint32 version = qFromLittleEndian<quint32>(_data + 4);
+    if (version != kVersion) {
+        return _fail(QStringLiteral("Unsupported parameter cache version %1").arg(version));
+    }
+
+    const quint32 count = qFromLittleEndian<quint32>(_data + 8);
+    _namesSize = qFromLittleEndian<quint32>(_data + 12);
+    const qint64 expectedSize = kHeaderSize + (static_cast<qint64>(count) * (kNameEntrySize + kValueSize)) + _namesSize;
+    if ((count > static_cast<quint32>(std::numeric_limits<int>::max())) || (expectedSize != _size)) {
+        return _fail(QStringLiteral("Parameter cache is truncated"));
+    }
+
+    const quint32 checksum = qFromLittleEndian<quint32>(_data + 16);
+    if (QGC::crc32(_data + kHeaderSize, static_cast<unsigned>(_size - kHeaderSize), 0) != checksum) {
+        return _fail(QStringLiteral("Parameter cache checksum mismatch"));
+    }
+
+    _count = static_cast<int>(count);
+    _values = _data + kHeaderSize + (static_cast<qint64>(_count) * kNameEntrySize);
+    _names = _values + (static_cast<qint64>(_count) * kValueSize);
+
+    // Names must lie in the pool and be strictly ascending, values must be of a slot type
+    QByteArrayView previousName;
+    for (int index = 0; index < _count; index++) {
+        const uchar *const entry = _nameEntry(index);
+        const quint32 nameOffset = qFromLittleEndian<quint32>(entry);
+        const quint16 nameLength = qFromLittleEndian<quint16>(entry + 4);
+        if ((nameLength == 0) || ((static_cast<quint64>(nameOffset) + nameLength) > _namesSize)) {
+            return _fail(QStringLiteral("Parameter cache name table is corrupt"));
+        }
+        if (!isSlotType(static_cast<FactMetaData::ValueType_t>(entry[6]))) {
+            return _fail(QStringLiteral("Parameter cache value type is corrupt"));
+        }
+
+        const QByteArrayView name = nameView(index);
+        if ((index > 0) && !(previousName < name)) {
+            return _fail(QStringLiteral("Parameter cache name table is not sorted"));
+        }
+        previousName = name;
+    }
+
+    qCDebug(ParameterCacheLog) << fileName << "opened" << _count << "parameters";
+
+    return true;
+}
+
+void ParameterCache::close()
+{
+    if (_data) {
+        (void) _file.unmap(_data);
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+
+    _size = 0;
+    _count = 0;
+    _values = nullptr;
+    _names = nullptr;
+    _namesSize = 0;
+    _errorString.clear();
+}
+
+bool ParameterCache::_fail(const QString &errorString)
+{
+    close();
+    _errorString = errorString;
+    return false;
+}
+
+QByteArrayView ParameterCache::nameView(int index) const
+{
+    const uchar *const entry = _nameEntry(index);
+    return QByteArrayView(_names + qFromLittleEndian<quint32>(entry), qFromLittleEndian<quint16>(entry + 4));
+}
+
+FactMetaData::ValueType_t ParameterCache::type(int index) const
+{
+    return static_cast<FactMetaData::ValueType_t>(_nameEntry(index)[6]);
+}
+
+QVariant ParameterCache::value(int index) const
+{
+    const uchar *const slot = _valueSlot(index);
+
+    switch (type(index)) {
+    case FactMetaData::valueTypeUint8:
+        return QVariant(static_cast<quint8>(slot[0]));
+    case FactMetaData::valueTypeInt8:
+        return QVariant(static_cast<qint8>(slot[0]));
+    case FactMetaData::valueTypeUint16:
+        return QVariant(qFromLittleEndian<quint16>(slot));
+    case FactMetaData::valueTypeInt16:
+        return QVariant(qFromLittleEndian<qint16>(slot));
+    case FactMetaData::valueTypeUint32:
+        return QVariant(qFromLittleEndian<quint32>(slot));
+    case FactMetaData::valueTypeInt32:
+        return QVariant(qFromLittleEndian<qint32>(slot));
+    case FactMetaData::valueTypeUint64:
+        return QVariant(qFromLittleEndian<quint64>(slot));
+    case FactMetaData::valueTypeInt64:
+        return QVariant(qFromLittleEndian<qint64>(slot));
+    case FactMetaData::valueTypeFloat:
+        return QVariant(qFromLittleEndian<float>(slot));
+    case FactMetaData::valueTypeDouble:
+        return QVariant(qFromLittleEndian<double>(slot));
+    default:
+        return QVariant();
+    }
+}
+
+int ParameterCache::indexOf(QByteArrayView name) const
+{
+    int low = 0;
+    int high = _count - 1;
+    while (low <= high) {
+        const int mid = low + ((high - low) / 2);
+        const QByteArrayView midName = nameView(mid);
+        if (midName < name) {
+            low = mid + 1;
+        } else if (name < midName) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+
+    return -1;
+}
+
+quint32 ParameterCache::hash(const std::function<bool(int index)> &excluded) const
+{
+    quint32 crc32Value = 0;
+    for (int index = 0; index < _count; index++) {
+        if (excluded && excluded(index)) {
+            continue;
+        }
+
+        const QByteArrayView name = nameView(index);
+        crc32Value = QGC::crc32(reinterpret_cast<const quint8*>(name.data()), static_cast<unsigned>(name.size()), crc32Value);
+        crc32Value = QGC::crc32(_valueSlot(index), static_cast<unsigned>(FactMetaData::typeToSize(type(index))), crc32Value);
+    }
+
+    return crc32Value;
+}
+
+bool ParameterCache::_encodeValue(FactMetaData::ValueType_t type, const QVariant &rawValue, uchar *slot)
+{
+    switch (type) {
+    case FactMetaData::valueTypeUint8:
+        slot[0] = static_cast<quint8>(rawValue.toUInt());
+        return true;
+    case FactMetaData::valueTypeInt8:
+        slot[0] = static_cast<uchar>(static_cast<qint8>(rawValue.toInt()));
+        return true;
+    case FactMetaData::valueTypeUint16:
+        qToLittleEndian<quint16>(static_cast<quint16>(rawValue.toUInt()), slot);
+        return true;
+    case FactMetaData::valueTypeInt16:
+        qToLittleEndian<qint16>(static_cast<qint16>(rawValue.toInt()), slot);
+        return true;
+    case FactMetaData::valueTypeUint32:
+        qToLittleEndian<quint32>(rawValue.toUInt(), slot);
+        return true;
+    case FactMetaData::valueTypeInt32:
+        qToLittleEndian<qint32>(rawValue.toInt(), slot);
+        return true;
+    case FactMetaData::valueTypeUint64:
+        qToLittleEndian<quint64>(rawValue.toULongLong(), slot);
+        return true;
+    case FactMetaData::valueTypeInt64:
+        qToLittleEndian<qint64>(rawValue.toLongLong(), slot);
+        return true;
+    case FactMetaData::valueTypeFloat:
+        qToLittleEndian<float>(rawValue.toFloat(), slot);
+        return true;
+    case FactMetaData::valueTypeDouble:
+        qToLittleEndian<double>(rawValue.toDouble(), slot);
+        return true;
+    default:
+        return false;
+    }
+}
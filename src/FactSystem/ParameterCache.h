@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+#include <functional>
+
+#include "FactMetaData.h"
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterCacheLog)
+
+/// Memory mapped parameter cache of one vehicle component.
+/// The file is a header followed by a table of name entries sorted by name, an array of 8 byte value slots in
+/// the same order and a pool holding the name bytes. Each name entry references its name in the pool and holds
+/// the FactMetaData::ValueType_t of its value. Values are stored little endian in the low bytes of their slot,
+/// which is also the layout the vehicle computes the _HASH_CHECK value over, so the hash of a cache is a single
+/// pass over the mapped file.
+class ParameterCache
+{
+public:
+    struct Param_t
+    {
+        QString name;
+        FactMetaData::ValueType_t type = FactMetaData::valueTypeFloat;
+        QVariant rawValue;
+    };
+
+    ParameterCache() = default;
+    ~ParameterCache();
+
+    /// Writes @a params to @a fileName, replacing it atomically. Parameters of types which do not fit a value
+    /// slot are left out.
+    ///     @return false on failure, see @a errorString
+    static bool save(const QString &fileName, QList<Param_t> params, QString *errorString = nullptr);
+
+    /// Maps @a fileName and validates its header and tables
+    ///     @return false on failure, see errorString()
+    bool open(const QString &fileName);
+    void close();
+
+    bool isOpen() const { return (_data != nullptr); }
+    QString errorString() const { return _errorString; }
+
+    int count() const { return _count; }
+    /// Name bytes of the parameter at @a index, points into the mapped file and is valid until close()
+    QByteArrayView nameView(int index) const;
+    QString name(int index) const { return QString::fromUtf8(nameView(index)); }
+    FactMetaData::ValueType_t type(int index) const;
+    QVariant value(int index) const;
+
+    /// @return Index of the parameter named @a name, -1 if it is not cached
+    int indexOf(QByteArrayView name) const;
+
+    /// CRC32 over the names and values of the cached parameters, the value the vehicle sends as _HASH_CHECK
+    ///     @param excluded Called for every parameter, true leaves the parameter out of the hash (volatile parameters)
+    quint32 hash(const std::function<bool(int index)> &excluded = nullptr) const;
+
+    static constexpr quint32 kMagic = 0x43504751;       ///< "QGPC"
+    static constexpr quint32 kVersion = 3;              ///< Version 2 was a QDataStream of a QMap
+    static constexpr qsizetype kHeaderSize = 24;
+    static constexpr qsizetype kNameEntrySize = 8;
+    static constexpr qsizetype kValueSize = 8;
+
+private:
+    const uchar *_nameEntry(int index) const { return (_data + kHeaderSize + (index * kNameEntrySize)); }
+    const uchar *_valueSlot(int index) const { return (_values + (index * kValueSize)); }
+    bool _fail(const QString &errorString);
+
+    static bool _encodeValue(FactMetaData::ValueType_t type, const QVariant &rawValue, uchar *slot);
+
+    QFile _file;
+    uchar *_data = nullptr;
+    qint64 _size = 0;
+    int _count = 0;
+    const uchar *_values = nullptr;
+    const uchar *_names = nullptr;
+    quint32 _namesSize = 0;
+    QString _errorString;
+};
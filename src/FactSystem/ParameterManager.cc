@@ -1,4 +1,5 @@
 #include "ParameterManager.h"
+#include "ParameterCache.h"
 #include "AutoPilotPlugin.h"
 #include "CompInfoParam.h"
 #include "ComponentInformationManager.h"
@@ -14,6 +15,7 @@
 #include "MultiVehicleManager.h"
 
 #include <QtCore/QEasingCurve>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QVariantAnimation>
@@ -485,8 +487,13 @@ void ParameterManager::_factRawValueUpdated(const QVariant &rawValue)
     _mavlinkParamSet(fact->componentId(), fact->name(), fact->type(), rawValue);
 }
 
-void ParameterManager::_ftpDownloadComplete(const QString &fileName, const QString &errorMsg)
+void ParameterManager::_ftpDownloadComplete(const QString &fileName, const QString &errorMsg, uint8_t compId)
 {
+    if (compId != MAV_COMP_ID_AUTOPILOT1) {
+        // Another component's transfer
+        return;
+    }
+
     bool continueWithDefaultParameterdownload = true;
     bool immediateRetry = false;
 
@@ -533,8 +540,12 @@ void ParameterManager::_ftpDownloadComplete(const QString &fileName, const QStri
     }
 }
 
-void ParameterManager::_ftpDownloadProgress(float progress)
+void ParameterManager::_ftpDownloadProgress(float progress, uint8_t compId)
 {
+    if (compId != MAV_COMP_ID_AUTOPILOT1) {
+        return;
+    }
+
     qCDebug(ParameterManagerVerbose1Log) << "ParameterManager::_ftpDownloadProgress:" << progress;
     _setLoadProgress(static_cast<double>(progress));
     if (progress > 0.001) {
@@ -889,19 +900,17 @@ void ParameterManager::_mavlinkParamRequestRead(int componentId, const QString &
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    const QMap<QString, Fact*> &factMap = _mapCompId2FactMap[componentId];
 
-    for (const QString &paramName: _mapCompId2FactMap[componentId].keys()) {
-        const Fact *const fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+    QList<ParameterCache::Param_t> params;
+    params.reserve(factMap.count());
+    for (auto it = factMap.cbegin(); it != factMap.cend(); ++it) {
+        params.append({ it.key(), it.value()->type(), it.value()->rawValue() });
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        QDataStream ds(&cacheFile);
-        ds << cacheMap;
-    } else {
-        qCWarning(ParameterManagerLog) << "Failed to open cache file for writing" << cacheFile.fileName();
+    QString errorString;
+    if (!ParameterCache::save(parameterCacheFile(vehicleId, componentId), params, &errorString)) {
+        qCWarning(ParameterManagerLog) << "Failed to write cache file" << parameterCacheFile(vehicleId, componentId) << errorString;
     }
 }
 
@@ -916,17 +925,15 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QStringLiteral("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QStringLiteral("%1_%2.v%3").arg(vehicleId).arg(componentId).arg(ParameterCache::kVersion));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, const QVariant &hashValue)
 {
     qCDebug(ParameterManagerLog) << "Attemping load from cache";
 
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    const QString cacheFileName = parameterCacheFile(vehicleId, componentId);
+    if (!QFileInfo::exists(cacheFileName)) {
         qCDebug(ParameterManagerLog) << "No parameter cache file";
         if (!_hashCheckDone) {
             // Standalone hash check path — fall back to PARAM_REQUEST_LIST
@@ -936,43 +943,31 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, const Q
         // If already in PARAM_REQUEST_LIST flow, just let the stream continue
         return;
     }
-    (void) cacheFile.open(QIODevice::ReadOnly);
 
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
+    ParameterCache cache;
+    if (!cache.open(cacheFileName)) {
+        qCWarning(ParameterManagerLog) << "Unable to read parameter cache" << cacheFileName << cache.errorString();
+    }
 
     /* compute the crc of the local cache to check against the remote */
-    uint32_t crc32_value = 0;
-    for (const QString &name: cacheMap.keys()) {
-        const ParamTypeVal &paramTypeVal = cacheMap[name];
-        const FactMetaData::ValueType_t factType = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, factType)->volatileValue()) {
+    CompInfoParam *const compInfoParam = _vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1);
+    const uint32_t crc32_value = cache.hash([&cache, compInfoParam](int index) {
+        const QString name = cache.name(index);
+        if (compInfoParam->factMetaDataForName(name, cache.type(index))->volatileValue()) {
             // Does not take part in CRC
             qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const void *const vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t cacheFactType = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32(reinterpret_cast<const uint8_t *>(qPrintable(name)), name.length(),  crc32_value);
-            crc32_value = QGC::crc32(static_cast<const uint8_t *>(vdat), FactMetaData::typeToSize(cacheFactType), crc32_value);
+            return true;
         }
-    }
+        return false;
+    });
 
     /* if the two param set hashes match, just load from the disk */
-    if (crc32_value == hashValue.toUInt()) {
+    if (cache.isOpen() && (crc32_value == hashValue.toUInt())) {
         _hashCheckDone = true;
         _paramRequestListTimer.stop();
-        qCDebug(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        const int count = cacheMap.count();
-        int index = 0;
-        for (const QString &name: cacheMap.keys()) {
-            const ParamTypeVal &paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t factType = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(factType);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
-        }
+        qCDebug(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFileName).absoluteFilePath());
+
+        _loadCachedParams(componentId, cache);
 
         const SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
         if (sharedLink) {
@@ -1016,11 +1011,14 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, const Q
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCDebug(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCDebug(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFileName).absoluteFilePath());
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
-            for (const QString &name: cacheMap.keys()) {
+            CacheMapName2ParamTypeVal &cacheMap = _debugCacheMap[componentId];
+            cacheMap.clear();
+            for (int index = 0; index < cache.count(); index++) {
+                const QString name = cache.name(index);
+                cacheMap[name] = ParamTypeVal(cache.type(index), cache.value(index));
                 _debugCacheParamSeen[componentId][name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
@@ -1034,6 +1032,80 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, const Q
     }
 }
 
+void ParameterManager::_loadCachedParams(int componentId, const ParameterCache &cache)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const int count = cache.count();
+    CompInfoParam *const compInfoParam = _vehicle->compInfoManager()->compInfoParam(componentId);
+    QMap<QString, Fact*> &factMap = _mapCompId2FactMap[componentId];
+
+    // Build the whole fact table first, nothing outside is told about it until it is complete
+    QList<Fact*> addedFacts;
+    QList<QPair<Fact*, QVariant>> updatedFacts;
+    addedFacts.reserve(count);
+    for (int index = 0; index < count; index++) {
+        const QString name = cache.name(index);
+        const QVariant value = cache.value(index);
+
+        const auto it = factMap.constFind(name);
+        if (it != factMap.constEnd()) {
+            updatedFacts.append(qMakePair(it.value(), value));
+            continue;
+        }
+
+        Fact *const fact = new Fact(componentId, name, cache.type(index), this);
+        fact->setMetaData(compInfoParam->factMetaDataForName(name, fact->type()));
+        // Nothing is connected to the fact yet, setting the value does not notify anyone
+        fact->containerSetRawValue(value);
+
+        // We need to know when the fact value changes so we can update the vehicle
+        (void) connect(fact, &Fact::containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
+
+        factMap[name] = fact;
+        addedFacts.append(fact);
+    }
+
+    // The component is complete, nothing is left to wait for
+    if (!_paramCountMap.contains(componentId)) {
+        _paramCountMap[componentId] = count;
+        _totalParamCount += count;
+    }
+    for (const int paramIndex: _waitingReadParamIndexMap.value(componentId).keys()) {
+        (void) _indexBatchQueue.removeOne(paramIndex);
+    }
+    _waitingReadParamIndexMap[componentId] = QMap<int, int>();
+
+    int waitingReadParamIndexCount = 0;
+    for (const int waitingComponentId: _waitingReadParamIndexMap.keys()) {
+        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
+    }
+    _prevWaitingReadParamIndexCount = waitingReadParamIndexCount;
+    if (waitingReadParamIndexCount) {
+        _waitingParamTimeoutTimer.start();
+    } else if (!_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
+        // Still waiting for parameters from default component
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
+        _waitingParamTimeoutTimer.start();
+    } else {
+        _waitingParamTimeoutTimer.stop();
+    }
+
+    for (Fact *const fact: addedFacts) {
+        emit factAdded(componentId, fact);
+    }
+    for (const QPair<Fact*, QVariant> &updatedFact: updatedFacts) {
+        updatedFact.first->containerSetRawValue(updatedFact.second);
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Loaded" << count << "parameters from cache in" << timer.elapsed() << "ms"
+                                 << "added:" << addedFacts.count() << "updated:" << updatedFacts.count();
+
+    _updateProgressBar();
+    _checkInitialLoadComplete();
+}
+
 QString ParameterManager::readParametersFromStream(QTextStream &stream)
 {
     QString missingErrors;
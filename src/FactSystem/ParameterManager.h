@@ -17,6 +17,7 @@ Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerDebugCacheFailureLog)
 
+class ParameterCache;
 class ParameterEditorController;
 class Vehicle;
 
@@ -131,6 +132,9 @@ private slots:
     void _requestHashCheck(uint8_t componentId);
     void _writeLocalParamCache(int vehicleId, int componentId);
     void _tryCacheHashLoad(int vehicleId, int componentId, const QVariant &hashValue);
+    /// Builds the fact table of @a componentId from a cache whose hash matched in one pass.
+    /// factAdded and value change signals are only emitted once the whole table is in place.
+    void _loadCachedParams(int componentId, const ParameterCache &cache);
     void _loadMetaData();
     void _clearMetaData();
     /// Remap a parameter from one firmware version to another
@@ -147,8 +151,8 @@ private slots:
     bool _fillIndexBatchQueue(bool waitingParamTimeout);
     void _updateProgressBar();
     void _checkInitialLoadComplete();
-    void _ftpDownloadComplete(const QString &fileName, const QString &errorMsg);
-    void _ftpDownloadProgress(float progress);
+    void _ftpDownloadComplete(const QString &fileName, const QString &errorMsg, uint8_t compId);
+    void _ftpDownloadProgress(float progress, uint8_t compId);
     /// Parse the binary parameter file and inject the parameters in the qgc fact system.
     /// See: https://github.com/ArduPilot/ardupilot/tree/master/libraries/AP_Filesystem
     bool _parseParamFile(const QString &filename);
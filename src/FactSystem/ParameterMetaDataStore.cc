@@ -0,0 +1,134 @@
+#include "ParameterMetaDataStore.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QApplicationStatic>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+#include <unistd.h>
+#endif
+
+QGC_LOGGING_CATEGORY(ParameterMetaDataStoreLog, "FactSystem.ParameterMetaDataStore")
+
+Q_APPLICATION_STATIC(ParameterMetaDataStore, _parameterMetaDataStoreInstance);
+
+ParameterMetaDataStore::ParameterMetaDataStore(QObject *parent)
+    : QObject(parent)
+{
+    // qCDebug(ParameterMetaDataStoreLog) << Q_FUNC_INFO << this;
+}
+
+ParameterMetaDataStore::~ParameterMetaDataStore()
+{
+    // qCDebug(ParameterMetaDataStoreLog) << Q_FUNC_INFO << this;
+}
+
+ParameterMetaDataStore *ParameterMetaDataStore::instance()
+{
+    return _parameterMetaDataStoreInstance();
+}
+
+QObject *ParameterMetaDataStore::metaDataSet(const QString &kind, const QString &fileName, const Loader_t &loader)
+{
+    const QString key = contentKey(fileName);
+    if (key.isEmpty()) {
+        qCWarning(ParameterMetaDataStoreLog) << "Unable to read metadata file" << fileName;
+        return nullptr;
+    }
+
+    const QString setKey = kind + QLatin1Char('.') + key;
+    const auto it = _sets.constFind(setKey);
+    if (it != _sets.constEnd()) {
+        _statistics.setsShared++;
+        _statistics.savedMs += it->loadMs;
+        _statistics.savedResidentBytes += it->residentBytes;
+        qCDebug(ParameterMetaDataStoreLog) << "Sharing" << kind << "metadata of" << fileName
+                                           << "saved" << it->loadMs << "ms" << (it->residentBytes / 1024) << "KB";
+        return it->set;
+    }
+
+    (void) QDir().mkpath(compiledDir().absolutePath());
+    const QString compiledFile = compiledDir().filePath(QStringLiteral("%1.%2.v%3.bin").arg(kind, key).arg(kCompiledVersion));
+
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 residentBefore = _residentBytes();
+
+    QObject *const set = loader(this, compiledFile);
+    if (!set) {
+        qCWarning(ParameterMetaDataStoreLog) << "Failed to load" << kind << "metadata" << fileName;
+        return nullptr;
+    }
+
+    Set_t entry;
+    entry.set = set;
+    entry.loadMs = timer.elapsed();
+    entry.residentBytes = qMax<qint64>(0, _residentBytes() - residentBefore);
+    _sets.insert(setKey, entry);
+
+    _statistics.setsLoaded++;
+    _statistics.loadMs += entry.loadMs;
+    _statistics.loadResidentBytes += entry.residentBytes;
+    qCDebug(ParameterMetaDataStoreLog) << "Loaded" << kind << "metadata" << fileName << "in" << entry.loadMs << "ms"
+                                       << (entry.residentBytes / 1024) << "KB";
+
+    return set;
+}
+
+QString ParameterMetaDataStore::intern(const QString &string)
+{
+    if (string.isEmpty()) {
+        return string;
+    }
+
+    const auto it = _strings.constFind(string);
+    if (it != _strings.constEnd()) {
+        if (!it->isSharedWith(string)) {
+            _statistics.internHits++;
+            _statistics.internSavedBytes += string.size() * static_cast<qint64>(sizeof(QChar));
+        }
+        return *it;
+    }
+
+    _statistics.internedStrings++;
+    return *_strings.insert(string);
+}
+
+QString ParameterMetaDataStore::contentKey(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    const QByteArray bytes = file.readAll();
+    const quint32 crc = QGC::crc32(reinterpret_cast<const quint8*>(bytes.constData()), static_cast<unsigned>(bytes.size()), 0);
+    return QStringLiteral("%1-%2").arg(bytes.size()).arg(crc, 8, 16, QLatin1Char('0'));
+}
+
+QDir ParameterMetaDataStore::compiledDir()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCParameterMetaData"));
+}
+
+qint64 ParameterMetaDataStore::_residentBytes()
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // size resident shared text lib data dt, in pages
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return 0;
+    }
+    return fields.at(1).toLongLong() * static_cast<qint64>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
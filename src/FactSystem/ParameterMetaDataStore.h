@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterMetaDataStoreLog)
+
+/// Parameter metadata shared by all vehicles.
+/// Metadata sets are keyed by the content of the file they are loaded from, so vehicles with identical metadata
+/// share one set instead of each parsing and holding its own. Strings which repeat across parameters (groups,
+/// categories, units, enum and bitmask labels) are interned so identical strings share one buffer.
+/// Sets live until the application exits. Main thread only.
+class ParameterMetaDataStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ParameterMetaDataStore(QObject *parent = nullptr);
+    ~ParameterMetaDataStore();
+
+    static ParameterMetaDataStore *instance();
+
+    /// Loads a metadata set, the store owns it
+    ///     @param parent Parent for the set
+    ///     @param compiledFile Location the loader may keep a compiled form of the set at, for faster loads
+    ///                         on the next run
+    ///     @return The set, nullptr on failure
+    typedef std::function<QObject*(QObject *parent, const QString &compiledFile)> Loader_t;
+
+    /// @return Set loaded from the content of @a fileName, @a loader is only called if no set with the same
+    ///         content was loaded yet. nullptr if the file cannot be read or the loader failed.
+    ///     @param kind Distinguishes sets of different loaders, e.g. "PX4"
+    QObject *metaDataSet(const QString &kind, const QString &fileName, const Loader_t &loader);
+
+    /// @return @a string, sharing its buffer with an equal string interned before
+    QString intern(const QString &string);
+
+    /// @return Key identifying the content of @a fileName, empty if it cannot be read
+    static QString contentKey(const QString &fileName);
+
+    /// @return Directory compiled metadata sets are kept in
+    static QDir compiledDir();
+
+    struct Statistics_t {
+        int setsLoaded = 0;             ///< Sets loaded by their loader
+        int setsShared = 0;             ///< Requests served by a set loaded before
+        qint64 loadMs = 0;              ///< Time spent in loaders
+        qint64 loadResidentBytes = 0;   ///< Growth of the resident set size while loading, 0 where unknown
+        qint64 savedMs = 0;             ///< Load time shared sets did not spend again
+        qint64 savedResidentBytes = 0;  ///< Resident memory shared sets did not allocate again
+        int internedStrings = 0;        ///< Distinct interned strings
+        int internHits = 0;             ///< Strings which shared an interned buffer
+        qint64 internSavedBytes = 0;    ///< String bytes not allocated thanks to interning
+    };
+
+    Statistics_t statistics() const { return _statistics; }
+    void resetStatistics() { _statistics = Statistics_t(); }
+
+    static constexpr int kCompiledVersion = 1;   ///< Bump to drop compiled sets made by older versions
+
+private:
+    struct Set_t {
+        QObject *set = nullptr;
+        qint64 loadMs = 0;
+        qint64 residentBytes = 0;
+    };
+
+    /// @return Resident set size of the process, 0 where unknown
+    static qint64 _residentBytes();
+
+    QHash<QString, Set_t> _sets;     ///< Key: kind and content key
+    QSet<QString> _strings;
+    Statistics_t _statistics;
+};
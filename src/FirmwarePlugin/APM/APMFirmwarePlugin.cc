@@ -14,6 +14,7 @@
 #include "ArduRoverFirmwarePlugin.h"
 #include "ArduSubFirmwarePlugin.h"
 #include "APMParameterMetaData.h"
+#include "ParameterMetaDataStore.h"
 #include "LinkManager.h"
 #include "Vehicle.h"
 #include "StatusTextHandler.h"
@@ -612,7 +613,15 @@ QString APMFirmwarePlugin::missionCommandOverrides(QGCMAVLink::VehicleClass_t ve
 
 QObject *APMFirmwarePlugin::_loadParameterMetaData(const QString &metaDataFile)
 {
-    Q_UNUSED(metaDataFile);
+    // Vehicles with the same meta data file share the parsed meta data, which is compiled on first use
+    QObject *const sharedMetaData = ParameterMetaDataStore::instance()->metaDataSet(QStringLiteral("APM"), metaDataFile, [metaDataFile](QObject *parent, const QString &compiledFile) {
+        APMParameterMetaData *const apmMetaData = new APMParameterMetaData(parent);
+        apmMetaData->loadParameterFactMetaDataFile(metaDataFile, compiledFile);
+        return static_cast<QObject*>(apmMetaData);
+    });
+    if (sharedMetaData) {
+        return sharedMetaData;
+    }
 
     APMParameterMetaData *const metaData = new APMParameterMetaData(this);
     metaData->loadParameterFactMetaDataFile(metaDataFile);
@@ -1,9 +1,12 @@
 #include "APMParameterMetaData.h"
+#include "ParameterMetaDataStore.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QDataStream>
 #include <QtCore/QFile>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QRegularExpressionMatch>
+#include <QtCore/QSaveFile>
 #include <QtCore/QStack>
 
 QGC_LOGGING_CATEGORY(APMParameterMetaDataLog, "FirmwarePlugin.APMParameterMetaData")
@@ -18,6 +21,16 @@ APMParameterMetaData::APMParameterMetaData(QObject *parent)
 APMParameterMetaData::~APMParameterMetaData()
 {
     qCDebug(APMParameterMetaDataLog) << this;
+
+    _clearRawMetaData();
+}
+
+void APMParameterMetaData::_clearRawMetaData()
+{
+    for (const ParameterNametoFactMetaDataMap &parameterMap : std::as_const(_vehicleTypeToParametersMap)) {
+        qDeleteAll(parameterMap);
+    }
+    _vehicleTypeToParametersMap.clear();
 }
 
 QString APMParameterMetaData::_mavTypeToString(MAV_TYPE vehicleTypeEnum)
@@ -77,14 +90,27 @@ QString APMParameterMetaData::_groupFromParameterName(const QString &name)
     return group.remove(regex); // remove any numbers from the end
 }
 
-void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaDataFile)
+void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaDataFile, const QString &compiledFile)
 {
     if (_parameterMetaDataLoaded) {
         return;
     }
     _parameterMetaDataLoaded = true;
 
+    if (!compiledFile.isEmpty() && _loadCompiled(compiledFile)) {
+        qCDebug(APMParameterMetaDataLog) << "Loaded compiled parameter meta data:" << compiledFile;
+        return;
+    }
+
     qCDebug(APMParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
+    if (_parseParameterFactMetaDataFile(metaDataFile) && !compiledFile.isEmpty()) {
+        _saveCompiled(compiledFile);
+    }
+}
+
+bool APMParameterMetaData::_parseParameterFactMetaDataFile(const QString &metaDataFile)
+{
+    ParameterMetaDataStore *const store = ParameterMetaDataStore::instance();
 
     QFile xmlFile(metaDataFile);
     Q_ASSERT(xmlFile.exists());
@@ -97,7 +123,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
     xmlFile.close();
     if (xml.hasError()) {
         qCWarning(APMParameterMetaDataLog) << "Badly formed XML, reading failed:" << xml.errorString();
-        return;
+        return false;
     }
 
     bool badMetaData = true;
@@ -124,13 +150,13 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
             } else if (elementName == "vehicles") {
                 if (xmlState.top() != XmlState::ParamFileFound) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, vehicles matched";
-                    return;
+                    return false;
                 }
                 xmlState.push(XmlState::FoundVehicles);
             } else if (elementName == "libraries") {
                 if (xmlState.top() != XmlState::ParamFileFound) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, libraries matched";
-                    return;
+                    return false;
                 }
                 currentCategory = "libraries";
                 xmlState.push(XmlState::FoundLibraries);
@@ -138,7 +164,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
                 if (xmlState.top() != XmlState::FoundVehicles && xmlState.top() != XmlState::FoundLibraries) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, parameters matched"
                                                        << "but we don't have proper vehicle or libraries yet";
-                    return;
+                    return false;
                 }
 
                 if (xml.attributes().hasAttribute("name")) {
@@ -156,7 +182,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
                         qCDebug(APMParameterMetaDataVerboseLog) << "not interested in this block of parameters, skipping:" << nameValue;
                         if (_skipXMLBlock(xml, "parameters")) {
                             qCWarning(APMParameterMetaDataLog) << "something wrong with the xml, skip of the xml failed";
-                            return;
+                            return false;
                         }
                         (void) xml.readNext();
                         continue;
@@ -166,25 +192,25 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
                 if (xmlState.top() != XmlState::FoundParameters) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, element param matched"
                                                        << "while we are not yet in parameters";
-                    return;
+                    return false;
                 }
                 xmlState.push(XmlState::FoundParameter);
 
                 if (!xml.attributes().hasAttribute("name")) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, parameter attribute name missing";
-                    return;
+                    return false;
                 }
 
                 QString name = xml.attributes().value("name").toString();
                 if (name.contains(':')) {
                     name = name.split(':').last();
                 }
-                const QString group = _groupFromParameterName(name);
+                const QString group = store->intern(_groupFromParameterName(name));
 
-                const QString category = xml.attributes().value("user").toString();
+                const QString category = store->intern(xml.attributes().value("user").toString());
 
-                const QString shortDescription = xml.attributes().value("humanName").toString();
-                const QString longDescription = xml.attributes().value("documentation").toString();
+                const QString shortDescription = store->intern(xml.attributes().value("humanName").toString());
+                const QString longDescription = store->intern(xml.attributes().value("documentation").toString());
 
                 qCDebug(APMParameterMetaDataVerboseLog) << "Found parameter name:" << name
                                                         << "short Desc:" << shortDescription
@@ -197,7 +223,7 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
                     qCDebug(APMParameterMetaDataLog) << "Duplicate parameter found:" << name;
                     rawMetaData = _vehicleTypeToParametersMap[currentCategory][name];
                 } else {
-                    rawMetaData = new APMFactMetaDataRaw(this);
+                    rawMetaData = new APMFactMetaDataRaw;
                     _vehicleTypeToParametersMap[currentCategory][name] = rawMetaData;
                     groupMembers[group] << name;
                 }
@@ -213,12 +239,12 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
                 // We should be getting meta data now
                 if (xmlState.top() != XmlState::FoundParameter) {
                     qCWarning(APMParameterMetaDataLog) << "Badly formed XML, while reading parameter fields wrong state";
-                    return;
+                    return false;
                 }
                 if (!badMetaData) {
                     if (!_parseParameterAttributes(xml, rawMetaData)) {
                         qCDebug(APMParameterMetaDataLog) << "Badly formed XML, failed to read parameter attributes";
-                        return;
+                        return false;
                     }
                     continue;
                 }
@@ -245,6 +271,8 @@ void APMParameterMetaData::loadParameterFactMetaDataFile(const QString &metaData
         }
         (void) xml.readNext();
     }
+
+    return true;
 }
 
 void APMParameterMetaData::_correctGroupMemberships(ParameterNametoFactMetaDataMap &parameterToFactMetaDataMap, QMap<QString,QStringList> &groupMembers)
@@ -270,6 +298,7 @@ bool APMParameterMetaData::_skipXMLBlock(QXmlStreamReader &xml, const QString &b
 
 bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMFactMetaDataRaw *rawMetaData)
 {
+    ParameterMetaDataStore *const store = ParameterMetaDataStore::instance();
     QString elementName = xml.name().toString();
     QList<QPair<QString,QString>> values;
     bool bitmaskElementSeen = false; // parse legacy <field name="Bitmask"> only if no <bitmask> was found
@@ -298,16 +327,18 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
 
                 // everything should be good. let's collect min and max
                 if (rangeList.count() == 2) {
-                    rawMetaData->min = rangeList.first().trimmed();
-                    rawMetaData->max = rangeList.last().trimmed();
+                    QString min = rangeList.first().trimmed();
+                    QString max = rangeList.last().trimmed();
 
                     // sanitize min and max off any comments that they may have
-                    if (rawMetaData->min.contains(' ')) {
-                        rawMetaData->min = rawMetaData->min.split(' ').first();
+                    if (min.contains(' ')) {
+                        min = min.split(' ').first();
                     }
-                    if (rawMetaData->max.contains(' ')) {
-                        rawMetaData->max = rawMetaData->max.split(' ').first();
+                    if (max.contains(' ')) {
+                        max = max.split(' ').first();
                     }
+                    rawMetaData->min = store->intern(min);
+                    rawMetaData->max = store->intern(max);
                     qCDebug(APMParameterMetaDataVerboseLog) << "read field parameter"
                                                             << "min:" << rawMetaData->min
                                                             << "max:" << rawMetaData->max;
@@ -315,11 +346,11 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
             } else if (attributeName == "Increment") {
                 const QString increment = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Increment:" << increment;
-                rawMetaData->incrementSize = increment;
+                rawMetaData->incrementSize = store->intern(increment);
             } else if (attributeName == "Units") {
                 const QString units = xml.readElementText();
                 qCDebug(APMParameterMetaDataVerboseLog) << "read Units:" << units;
-                rawMetaData->units = units;
+                rawMetaData->units = store->intern(units);
             } else if (attributeName == "ReadOnly") {
                 const QString strValue = xml.readElementText().trimmed();
                 if (strValue.compare("true", Qt::CaseInsensitive) == 0) {
@@ -340,7 +371,7 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
                         for (const QString &bitmask : bitmaskList) {
                             const QStringList pair = bitmask.split(":");
                             if (pair.count() == 2) {
-                                rawMetaData->bitmask << QPair<QString, QString>(pair[0].trimmed(), pair[1].trimmed());
+                                rawMetaData->bitmask << QPair<QString, QString>(store->intern(pair[0].trimmed()), store->intern(pair[1].trimmed()));
                             } else {
                                 qCDebug(APMParameterMetaDataLog) << "parse error: bitmask:" << bitmaskString << "pair count:" << pair.count();
                                 parseError = true;
@@ -366,7 +397,7 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
             const QString valueName = xml.readElementText();
             qCDebug(APMParameterMetaDataVerboseLog) << "read value parameter" << "value desc:"
                                                     << valueName << "code:" << valueValue;
-            values << QPair<QString,QString>(valueValue, valueName);
+            values << QPair<QString,QString>(store->intern(valueValue), store->intern(valueName));
             rawMetaData->values = values;
         } else if (elementName == "bitmask") {
             QList<QPair<QString,QString>> parsed;
@@ -383,7 +414,7 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
                             qCDebug(APMParameterMetaDataLog) << "parse error: <bit> missing code attribute";
                             break;
                         }
-                        parsed << qMakePair(code, desc);
+                        parsed << qMakePair(store->intern(code), store->intern(desc));
                     } else {
                         qCWarning(APMParameterMetaDataLog) << "Unknown element inside <bitmask>:" << xml.name().toString();
                     }
@@ -411,6 +442,17 @@ bool APMParameterMetaData::_parseParameterAttributes(QXmlStreamReader &xml, APMF
 }
 
 FactMetaData *APMParameterMetaData::getMetaDataForFact(const QString &name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type)
+{
+    // Vehicles of the same type share the FactMetaData of a parameter
+    FactMetaData *&metaData = _factMetaDataMap[(static_cast<quint32>(vehicleType) << 8) | static_cast<quint32>(type)][name];
+    if (!metaData) {
+        metaData = _createMetaDataForFact(name, vehicleType, type);
+    }
+
+    return metaData;
+}
+
+FactMetaData *APMParameterMetaData::_createMetaDataForFact(const QString &name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type)
 {
     bool keepTrying = true;
     QString mavTypeString = _mavTypeToString(vehicleType);
@@ -630,3 +672,166 @@ void APMParameterMetaData::getParameterMetaDataVersionInfo(const QString &metaDa
         qCWarning(APMParameterMetaDataLog) << "Unable to parse version from parameter meta data file name:" << metaDataFile;
     }
 }
+
+void APMParameterMetaData::_saveCompiled(const QString &compiledFile) const
+{
+    // Strings repeat a lot across parameters (groups, units, enum labels), so they are written once to a table
+    // and referenced by index. Index 0 is the empty string.
+    QStringList strings(QString());
+    QHash<QString, quint32> stringIndices;
+    stringIndices.insert(QString(), 0);
+    const auto stringIndex = [&strings, &stringIndices](const QString &string) -> quint32 {
+        const auto it = stringIndices.constFind(string);
+        if (it != stringIndices.constEnd()) {
+            return it.value();
+        }
+        const quint32 index = static_cast<quint32>(strings.size());
+        strings.append(string);
+        stringIndices.insert(string, index);
+        return index;
+    };
+
+    QByteArray body;
+    QDataStream bodyStream(&body, QIODevice::WriteOnly);
+    bodyStream.setVersion(QDataStream::Qt_6_0);
+
+    const auto writePairs = [&bodyStream, &stringIndex](const QList<QPair<QString, QString>> &pairs) {
+        bodyStream << static_cast<quint32>(pairs.size());
+        for (const QPair<QString, QString> &pair : pairs) {
+            bodyStream << stringIndex(pair.first) << stringIndex(pair.second);
+        }
+    };
+
+    bodyStream << static_cast<quint32>(_vehicleTypeToParametersMap.size());
+    for (auto it = _vehicleTypeToParametersMap.constBegin(); it != _vehicleTypeToParametersMap.constEnd(); it++) {
+        bodyStream << stringIndex(it.key()) << static_cast<quint32>(it.value().size());
+        for (const APMFactMetaDataRaw *const rawMetaData : it.value()) {
+            const quint8 flags = (rawMetaData->rebootRequired ? 0x01 : 0x00) | (rawMetaData->readOnly ? 0x02 : 0x00);
+            bodyStream << stringIndex(rawMetaData->name)
+                       << stringIndex(rawMetaData->category)
+                       << stringIndex(rawMetaData->group)
+                       << stringIndex(rawMetaData->shortDescription)
+                       << stringIndex(rawMetaData->longDescription)
+                       << stringIndex(rawMetaData->min)
+                       << stringIndex(rawMetaData->max)
+                       << stringIndex(rawMetaData->incrementSize)
+                       << stringIndex(rawMetaData->units)
+                       << flags;
+            writePairs(rawMetaData->values);
+            writePairs(rawMetaData->bitmask);
+        }
+    }
+
+    QSaveFile file(compiledFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(APMParameterMetaDataLog) << "Unable to save compiled parameter meta data" << compiledFile << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << kCompiledMagic << kCompiledVersion << strings;
+    (void) stream.writeRawData(body.constData(), static_cast<int>(body.size()));
+
+    if ((stream.status() != QDataStream::Ok) || !file.commit()) {
+        qCWarning(APMParameterMetaDataLog) << "Unable to save compiled parameter meta data" << compiledFile << file.errorString();
+        return;
+    }
+
+    qCDebug(APMParameterMetaDataLog) << "Saved compiled parameter meta data" << compiledFile << strings.size() << "strings";
+}
+
+bool APMParameterMetaData::_loadCompiled(const QString &compiledFile)
+{
+    QFile file(compiledFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if ((stream.status() != QDataStream::Ok) || (magic != kCompiledMagic) || (version != kCompiledVersion)) {
+        qCDebug(APMParameterMetaDataLog) << "Ignoring compiled parameter meta data of other format" << compiledFile;
+        return false;
+    }
+
+    QStringList strings;
+    stream >> strings;
+    if ((stream.status() != QDataStream::Ok) || strings.isEmpty()) {
+        qCWarning(APMParameterMetaDataLog) << "Compiled parameter meta data is corrupt" << compiledFile;
+        return false;
+    }
+
+    ParameterMetaDataStore *const store = ParameterMetaDataStore::instance();
+    for (QString &string : strings) {
+        string = store->intern(string);
+    }
+
+    bool corrupt = false;
+    const auto readString = [&stream, &strings, &corrupt]() -> QString {
+        quint32 index = 0;
+        stream >> index;
+        if (index >= static_cast<quint32>(strings.size())) {
+            corrupt = true;
+            return QString();
+        }
+        return strings.at(index);
+    };
+    const auto readPairs = [&stream, &readString, &corrupt]() -> QList<QPair<QString, QString>> {
+        QList<QPair<QString, QString>> pairs;
+        quint32 count = 0;
+        stream >> count;
+        for (quint32 i = 0; (i < count) && !corrupt && (stream.status() == QDataStream::Ok); i++) {
+            const QString first = readString();
+            const QString second = readString();
+            pairs.append(qMakePair(first, second));
+        }
+        return pairs;
+    };
+
+    quint32 categoryCount = 0;
+    stream >> categoryCount;
+    for (quint32 category = 0; (category < categoryCount) && !corrupt && (stream.status() == QDataStream::Ok); category++) {
+        const QString categoryName = readString();
+        ParameterNametoFactMetaDataMap &parameterMap = _vehicleTypeToParametersMap[categoryName];
+
+        quint32 parameterCount = 0;
+        stream >> parameterCount;
+        for (quint32 parameter = 0; (parameter < parameterCount) && !corrupt && (stream.status() == QDataStream::Ok); parameter++) {
+            APMFactMetaDataRaw *const rawMetaData = new APMFactMetaDataRaw;
+            rawMetaData->name = readString();
+            rawMetaData->category = readString();
+            rawMetaData->group = readString();
+            rawMetaData->shortDescription = readString();
+            rawMetaData->longDescription = readString();
+            rawMetaData->min = readString();
+            rawMetaData->max = readString();
+            rawMetaData->incrementSize = readString();
+            rawMetaData->units = readString();
+
+            quint8 flags = 0;
+            stream >> flags;
+            rawMetaData->rebootRequired = (flags & 0x01);
+            rawMetaData->readOnly = (flags & 0x02);
+
+            rawMetaData->values = readPairs();
+            rawMetaData->bitmask = readPairs();
+
+            APMFactMetaDataRaw *const previous = parameterMap.value(rawMetaData->name);
+            parameterMap.insert(rawMetaData->name, rawMetaData);
+            delete previous;
+        }
+    }
+
+    if (corrupt || (stream.status() != QDataStream::Ok) || !stream.atEnd()) {
+        qCWarning(APMParameterMetaDataLog) << "Compiled parameter meta data is corrupt" << compiledFile;
+        _clearRawMetaData();
+        return false;
+    }
+
+    return true;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QMap>
 #include <QtCore/QObject>
@@ -11,15 +12,10 @@
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataLog)
 Q_DECLARE_LOGGING_CATEGORY(APMParameterMetaDataVerboseLog)
 
-class APMFactMetaDataRaw : public QObject
+/// Parameter meta data as read from the xml, FactMetaData is created from it on first use.
+/// Plain struct rather than QObject since there is one per parameter of every vehicle type in the file.
+struct APMFactMetaDataRaw
 {
-    Q_OBJECT
-public:
-    explicit APMFactMetaDataRaw(QObject *parent = nullptr)
-        : QObject(parent)
-    { }
-    ~APMFactMetaDataRaw() {}
-
     QString name;
     QString category;
     QString group;
@@ -39,7 +35,8 @@ class APMFactMetaDataRaw : public QObject
 
 typedef QMap<QString, APMFactMetaDataRaw*> ParameterNametoFactMetaDataMap;
 
-/// Collection of Parameter Facts for ArduPilot
+/// Collection of Parameter Facts for ArduPilot. Shared by all vehicles using the same meta data file, see
+/// ParameterMetaDataStore.
 class APMParameterMetaData : public QObject
 {
     Q_OBJECT
@@ -49,7 +46,9 @@ class APMParameterMetaData : public QObject
     ~APMParameterMetaData();
 
     FactMetaData *getMetaDataForFact(const QString &name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type);
-    void loadParameterFactMetaDataFile(const QString &metaDataFile);
+    /// Loads the meta data from @a compiledFile if it holds a compiled form of @a metaDataFile, otherwise parses
+    /// @a metaDataFile and saves the compiled form to @a compiledFile
+    void loadParameterFactMetaDataFile(const QString &metaDataFile, const QString &compiledFile = QString());
 
     static void getParameterMetaDataVersionInfo(const QString &metaDataFile, int &majorVersion, int &minorVersion);
 
@@ -66,13 +65,22 @@ class APMParameterMetaData : public QObject
         Done
     };
 
+    bool _parseParameterFactMetaDataFile(const QString &metaDataFile);
+    FactMetaData *_createMetaDataForFact(const QString &name, MAV_TYPE vehicleType, FactMetaData::ValueType_t type);
     static bool _skipXMLBlock(QXmlStreamReader &xml, const QString &blockName);
     bool _parseParameterAttributes(QXmlStreamReader &xml, APMFactMetaDataRaw *rawMetaData);
     static void _correctGroupMemberships(ParameterNametoFactMetaDataMap &parameterToFactMetaDataMap, QMap<QString,QStringList> &groupMembers);
     static QString _mavTypeToString(MAV_TYPE vehicleTypeEnum);
     static QString _groupFromParameterName(const QString &name);
+    bool _loadCompiled(const QString &compiledFile);
+    void _saveCompiled(const QString &compiledFile) const;
+    void _clearRawMetaData();
 
     bool _parameterMetaDataLoaded = false; ///< true: parameter meta data already loaded
     // FIXME: metadata is vehicle type specific now
     QMap<QString, ParameterNametoFactMetaDataMap> _vehicleTypeToParametersMap; ///< Maps from a vehicle type to paramametertoFactMeta map>
+    QHash<quint32, QHash<QString, FactMetaData*>> _factMetaDataMap; ///< Key: MAV_TYPE and value type, Value: FactMetaData by parameter name
+
+    static constexpr quint32 kCompiledMagic = 0x4d504151;  ///< "QAPM"
+    static constexpr quint32 kCompiledVersion = 1;
 };
@@ -5,10 +5,12 @@
 QGC_LOGGING_CATEGORY(APMSubmarineFactGroupLog, "FirmwarePlugin.ArduSubFirmwarePlugin")
 
 APMSubmarineFactGroup::APMSubmarineFactGroup(QObject *parent)
-    : FactGroup(300, QStringLiteral(":/json/Vehicle/SubmarineFact.json"), parent)
+    : FactGroup(300, QStringLiteral(":/json/Vehicle/SubmarineFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
     // qCDebug(APMSubmarineFactGroupLog) << Q_FUNC_INFO << this;
 
+    _setHandledMessageIds({}); // Updated by ArduSubFirmwarePlugin
+
     _addFact(&_camTiltFact);
     _addFact(&_tetherTurnsFact);
     _addFact(&_lightsLevel1Fact);
@@ -287,8 +287,8 @@ class FirmwarePlugin : public QObject
     virtual QString _internalParameterMetaDataFile(const Vehicle* /*vehicle*/) const { return QString(); }
 
     /// Loads the specified parameter meta data file.
-    /// @return Opaque parameter meta data information which must be stored with Vehicle. Vehicle is responsible to
-    ///         call deleteParameterMetaData when no longer needed.
+    /// @return Opaque parameter meta data information which must be stored with Vehicle. The meta data may be shared
+    ///         with other vehicles (see ParameterMetaDataStore) and must not be deleted or modified.
     /// Important: Only CompInfoParam code should use this method
     virtual QObject *_loadParameterMetaData(const QString& /*metaDataFile*/) { return nullptr; }
 
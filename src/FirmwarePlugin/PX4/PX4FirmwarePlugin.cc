@@ -6,6 +6,7 @@
 #include "SettingsManager.h"
 #include "PlanViewSettings.h"
 #include "ParameterManager.h"
+#include "ParameterMetaDataStore.h"
 #include "Vehicle.h"
 
 #include <QString>
@@ -269,11 +270,19 @@ QString PX4FirmwarePlugin::missionCommandOverrides(QGCMAVLink::VehicleClass_t ve
 
 QObject* PX4FirmwarePlugin::_loadParameterMetaData(const QString& metaDataFile)
 {
-    PX4ParameterMetaData* metaData = new PX4ParameterMetaData(this);
     if (!metaDataFile.isEmpty()) {
-        metaData->loadParameterFactMetaDataFile(metaDataFile);
+        // Vehicles with the same meta data file share the parsed meta data
+        QObject* metaData = ParameterMetaDataStore::instance()->metaDataSet(QStringLiteral("PX4"), metaDataFile, [metaDataFile](QObject* parent, const QString& /*compiledFile*/) {
+            PX4ParameterMetaData* px4MetaData = new PX4ParameterMetaData(parent);
+            px4MetaData->loadParameterFactMetaDataFile(metaDataFile);
+            return static_cast<QObject*>(px4MetaData);
+        });
+        if (metaData) {
+            return metaData;
+        }
     }
-    return metaData;
+
+    return new PX4ParameterMetaData(this);
 }
 
 void PX4FirmwarePlugin::pauseVehicle(Vehicle* vehicle) const
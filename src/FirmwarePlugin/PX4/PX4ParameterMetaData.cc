@@ -1,4 +1,5 @@
 #include "PX4ParameterMetaData.h"
+#include "ParameterMetaDataStore.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QFile>
@@ -94,6 +95,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         return;
     }
 
+    ParameterMetaDataStore* store = ParameterMetaDataStore::instance();
     QString         factGroup;
     QString         errorString;
     FactMetaData*   metaData = nullptr;
@@ -148,7 +150,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                     qWarning() << "Badly formed XML";
                     return;
                 }
-                factGroup = xml.attributes().value("name").toString();
+                factGroup = store->intern(xml.attributes().value("name").toString());
                 qCDebug(PX4ParameterMetaDataLog) << "Found group: " << factGroup;
 
             } else if (elementName == "parameter") {
@@ -207,7 +209,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                 } else {
                     _mapParameterName2FactMetaData[name] = metaData;
                     metaData->setName(name);
-                    metaData->setCategory(category);
+                    metaData->setCategory(store->intern(category));
                     metaData->setGroup(factGroup);
                     metaData->setReadOnly(readOnly);
                     metaData->setVolatileValue(volatileValue);
@@ -236,13 +238,13 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Short description:" << text;
-                            metaData->setShortDescription(text);
+                            metaData->setShortDescription(store->intern(text));
 
                         } else if (elementName == "long_desc") {
                             QString text = xml.readElementText();
                             text = text.replace("\n", " ");
                             qCDebug(PX4ParameterMetaDataLog) << "Long description:" << text;
-                            metaData->setLongDescription(text);
+                            metaData->setLongDescription(store->intern(text));
 
                         } else if (elementName == "min") {
                             QString text = xml.readElementText();
@@ -272,7 +274,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                         } else if (elementName == "unit") {
                             QString text = xml.readElementText();
                             qCDebug(PX4ParameterMetaDataLog) << "Unit:" << text;
-                            metaData->setRawUnits(text);
+                            metaData->setRawUnits(store->intern(text));
 
                         } else if (elementName == "decimal") {
                             QString text = xml.readElementText();
@@ -305,7 +307,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                             QVariant    enumValue;
                             QString     enumErrorString;
                             if (metaData->convertAndValidateRaw(enumValueStr, false /* validate */, enumValue, enumErrorString)) {
-                                metaData->addEnumInfo(enumString, enumValue);
+                                metaData->addEnumInfo(store->intern(enumString), enumValue);
                             } else {
                                 qCDebug(PX4ParameterMetaDataLog) << "Invalid enum value, name:" << metaData->name()
                                                                  << " type:" << metaData->type() << " value:" << enumValueStr
@@ -325,9 +327,9 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                         } else if (elementName == "boolean") {
                             QVariant    enumValue;
                             metaData->convertAndValidateRaw(1, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Enabled"), enumValue);
+                            metaData->addEnumInfo(store->intern(tr("Enabled")), enumValue);
                             metaData->convertAndValidateRaw(0, false /* validate */, enumValue, errorString);
-                            metaData->addEnumInfo(tr("Disabled"), enumValue);
+                            metaData->addEnumInfo(store->intern(tr("Disabled")), enumValue);
 
                         } else if (elementName == "bitmask") {
                             // doing nothing individual bits will follow anyway. May be used for sanity checking.
@@ -345,7 +347,7 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
                                     QVariant bitmaskValue;
                                     QString bitmaskErrorString;
                                     if (metaData->convertAndValidateRaw(bitmaskRawValue, true, bitmaskValue, bitmaskErrorString)) {
-                                        metaData->addBitmaskInfo(bitDescription, bitmaskValue);
+                                        metaData->addBitmaskInfo(store->intern(bitDescription), bitmaskValue);
                                     } else {
                                         qCDebug(PX4ParameterMetaDataLog) << "Invalid bitmask value, name:" << metaData->name()
                                                                          << " type:" << metaData->type() << " value:" << bitmaskValue
@@ -482,13 +484,20 @@ FactMetaData* PX4ParameterMetaData::getMetaDataForFact(const QString& name, MAV_
 {
     Q_UNUSED(vehicleType)
 
-    if (!_mapParameterName2FactMetaData.contains(name)) {
+    FactMetaData* metaData = _mapParameterName2FactMetaData.value(name);
+    if (metaData) {
+        return metaData;
+    }
+
+    // The meta data is shared by vehicles which may report the parameter with different types, so the
+    // generic meta data is kept per type rather than with the type of the first vehicle asking for it
+    FactMetaData*& genericMetaData = _genericMetaDataMap[type][name];
+    if (!genericMetaData) {
         qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
-        FactMetaData* metaData = new FactMetaData(type, this);
-        _mapParameterName2FactMetaData[name] = metaData;
+        genericMetaData = new FactMetaData(type, this);
     }
 
-    return _mapParameterName2FactMetaData[name];
+    return genericMetaData;
 }
 
 void PX4ParameterMetaData::getParameterMetaDataVersionInfo(const QString& metaDataFile, int& majorVersion, int& minorVersion)
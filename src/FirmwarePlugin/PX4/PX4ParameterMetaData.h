@@ -4,6 +4,7 @@
 #include "MAVLinkLib.h"
 #include "FactMetaData.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
 #include <QtCore/QLoggingCategory>
 
@@ -11,7 +12,7 @@ Q_DECLARE_LOGGING_CATEGORY(PX4ParameterMetaDataLog)
 
 //#define GENERATE_PARAMETER_JSON
 
-/// Loads and holds parameter fact meta data for PX4 stack
+/// Loads and holds parameter fact meta data for PX4 stack. Shared by all vehicles using the same meta data file.
 class PX4ParameterMetaData : public QObject
 {
     Q_OBJECT
@@ -43,6 +44,7 @@ class PX4ParameterMetaData : public QObject
 
     bool                                _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
     FactMetaData::NameToMetaDataMap_t   _mapParameterName2FactMetaData;             ///< Maps from a parameter name to FactMetaData
+    QHash<int, FactMetaData::NameToMetaDataMap_t> _genericMetaDataMap;              ///< Key: value type, Value: generic FactMetaData of parameters without meta data
 
     static constexpr const char* kInvalidConverstion = "Internal Error: No support for string parameters";
 
@@ -0,0 +1,147 @@
+#include "TilePrefetchManager.h"
+
+#include <QtCore/QApplicationStatic>
+#include <QtCore/QTimer>
+#include <QtCore/QtMath>
+
+#include "FlightMapSettings.h"
+#include "MapsSettings.h"
+#include "MissionItem.h"
+#include "MissionManager.h"
+#include "MultiVehicleManager.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMapEngine.h"
+#include "QGCTilePrefetcher.h"
+#include "QGroundControlQmlGlobal.h"
+#include "SettingsManager.h"
+#include "Vehicle.h"
+
+QGC_LOGGING_CATEGORY(TilePrefetchManagerLog, "FlightMap.TilePrefetchManager")
+
+Q_APPLICATION_STATIC(TilePrefetchManager, _tilePrefetchManagerInstance);
+
+namespace {
+
+bool _isGlobalFrame(MAV_FRAME frame)
+{
+    switch (frame) {
+    case MAV_FRAME_GLOBAL:
+    case MAV_FRAME_GLOBAL_RELATIVE_ALT:
+    case MAV_FRAME_GLOBAL_INT:
+    case MAV_FRAME_GLOBAL_RELATIVE_ALT_INT:
+    case MAV_FRAME_GLOBAL_TERRAIN_ALT:
+    case MAV_FRAME_GLOBAL_TERRAIN_ALT_INT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+TilePrefetchManager::TilePrefetchManager(QObject *parent)
+    : QObject(parent)
+    , _updateTimer(new QTimer(this))
+{
+    qCDebug(TilePrefetchManagerLog) << this;
+
+    _updateTimer->setSingleShot(false);
+    _updateTimer->setInterval(kUpdateIntervalMs);
+}
+
+TilePrefetchManager::~TilePrefetchManager()
+{
+    qCDebug(TilePrefetchManagerLog) << this;
+}
+
+TilePrefetchManager *TilePrefetchManager::instance()
+{
+    return _tilePrefetchManagerInstance();
+}
+
+void TilePrefetchManager::init()
+{
+    static bool once = false;
+    if (once) {
+        return;
+    }
+    once = true;
+
+    (void) connect(_updateTimer, &QTimer::timeout, this, &TilePrefetchManager::_update);
+    (void) connect(SettingsManager::instance()->mapsSettings()->tilePrefetch(), &Fact::rawValueChanged, this, &TilePrefetchManager::_enabledChanged);
+    (void) connect(MultiVehicleManager::instance(), &MultiVehicleManager::activeVehicleChanged, this, &TilePrefetchManager::_activeVehicleChanged);
+
+    _activeVehicleChanged(MultiVehicleManager::instance()->activeVehicle());
+}
+
+void TilePrefetchManager::_activeVehicleChanged(Vehicle *activeVehicle)
+{
+    _vehicle = activeVehicle;
+    _enabledChanged();
+}
+
+void TilePrefetchManager::_enabledChanged()
+{
+    const bool enabled = SettingsManager::instance()->mapsSettings()->tilePrefetch()->rawValue().toBool();
+    if (enabled && _vehicle) {
+        if (!_updateTimer->isActive()) {
+            _updateTimer->start();
+        }
+        _update();
+    } else {
+        _updateTimer->stop();
+        getQGCMapEngine()->tilePrefetcher()->clear();
+    }
+}
+
+void TilePrefetchManager::_update()
+{
+    if (!_vehicle || !_vehicle->coordinate().isValid()) {
+        getQGCMapEngine()->tilePrefetcher()->clear();
+        return;
+    }
+
+    const double groundSpeed = _vehicle->groundSpeed()->rawValue().toDouble();
+    const double lookahead = SettingsManager::instance()->mapsSettings()->tilePrefetchLookahead()->rawValue().toDouble();
+    const double lengthMeters = qMax(kMinLengthMeters, qIsNaN(groundSpeed) ? 0. : (groundSpeed * lookahead));
+
+    const FlightMapSettings *const flightMapSettings = SettingsManager::instance()->flightMapSettings();
+    const QString mapType = flightMapSettings->mapProvider()->rawValue().toString() + QStringLiteral(" ") + flightMapSettings->mapType()->rawValue().toString();
+    const int zoom = qRound(QGroundControlQmlGlobal::flightMapZoom());
+
+    getQGCMapEngine()->tilePrefetcher()->setCorridor(mapType, zoom, _path(lengthMeters), lengthMeters);
+}
+
+QList<QGeoCoordinate> TilePrefetchManager::_path(double lengthMeters) const
+{
+    const QGeoCoordinate position = _vehicle->coordinate();
+    QList<QGeoCoordinate> path = { position };
+
+    MissionManager *const missionManager = _vehicle->missionManager();
+    const int currentIndex = missionManager->currentIndex();
+    const QList<MissionItem*> &missionItems = missionManager->missionItems();
+    if ((currentIndex >= 0) && (currentIndex < missionItems.size())) {
+        for (qsizetype i = currentIndex; i < missionItems.size(); i++) {
+            const MissionItem *const item = missionItems.at(i);
+            if (!_isGlobalFrame(item->frame())) {
+                continue;
+            }
+            const QGeoCoordinate coordinate = item->coordinate();
+            if (!coordinate.isValid() || ((coordinate.latitude() == 0.) && (coordinate.longitude() == 0.))) {
+                continue;
+            }
+            path.append(coordinate);
+        }
+        if (path.size() > 1) {
+            return path;
+        }
+    }
+
+    const double heading = _vehicle->heading()->rawValue().toDouble();
+    const double groundSpeed = _vehicle->groundSpeed()->rawValue().toDouble();
+    if (!qIsNaN(heading) && !qIsNaN(groundSpeed) && (groundSpeed >= kMinSpeedMetersPerSecond)) {
+        path.append(position.atDistanceAndAzimuth(lengthMeters, heading));
+    }
+
+    return path;
+}
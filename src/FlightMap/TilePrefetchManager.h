@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtPositioning/QGeoCoordinate>
+
+Q_DECLARE_LOGGING_CATEGORY(TilePrefetchManagerLog)
+
+class QTimer;
+class Vehicle;
+
+/// Feeds the map engine tile prefetcher with the corridor the active vehicle is about to fly: the rest of
+/// its mission, or a straight line along its heading when it has none.
+class TilePrefetchManager : public QObject
+{
+    Q_OBJECT
+    Q_MOC_INCLUDE("Vehicle.h")
+
+public:
+    explicit TilePrefetchManager(QObject *parent = nullptr);
+    ~TilePrefetchManager();
+
+    static TilePrefetchManager *instance();
+    void init();
+
+private slots:
+    void _activeVehicleChanged(Vehicle *activeVehicle);
+    void _enabledChanged();
+    void _update();
+
+private:
+    /// @return Vehicle position followed by the mission items it has yet to reach, or a point ahead of it on its heading
+    QList<QGeoCoordinate> _path(double lengthMeters) const;
+
+    Vehicle *_vehicle = nullptr;
+    QTimer *_updateTimer = nullptr;
+
+    static constexpr int kUpdateIntervalMs = 2000;
+    static constexpr double kMinLengthMeters = 500.;
+    static constexpr double kMinSpeedMetersPerSecond = 1.;
+};
@@ -9,12 +9,14 @@ Gimbal::Gimbal(GimbalController *parent)
 {
     qCDebug(GimbalLog) << this;
 
+    _setHandledMessageIds({}); // Updated by GimbalController
     _initFacts();
 }
 
 Gimbal::Gimbal(const Gimbal &other)
     : FactGroup(1000, QStringLiteral(":/json/Vehicle/GimbalFact.json"), other.parent())
 {
+    _setHandledMessageIds({}); // Updated by GimbalController
     _initFacts();
     *this = other;
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+#include <array>
+#include <cstdint>
+
+/// Maps MAVLink message ids to the handlers which subscribed to them, so an incoming message is only offered
+/// to the handlers which care about it instead of every handler switching on msgid.
+/// Ids below kDirectMsgIdCount, which covers the common telemetry set, resolve with a single array index.
+/// The sparse dialect ids above that fall back to a hash lookup.
+/// Not thread safe. The table must not be modified from within a handler while it is being dispatched.
+template<typename Handler>
+class MAVLinkMessageDispatchTable
+{
+public:
+    void subscribe(uint32_t msgId, const Handler &handler)
+    {
+        if (msgId < kDirectMsgIdCount) {
+            _direct[msgId].append(handler);
+        } else {
+            _sparse[msgId].append(handler);
+        }
+    }
+
+    /// Subscribes @a handler to every message id
+    void subscribeAll(const Handler &handler) { _all.append(handler); }
+
+    void clear()
+    {
+        for (QList<Handler> &handlers : _direct) {
+            handlers.clear();
+        }
+        _sparse.clear();
+        _all.clear();
+    }
+
+    /// @return Handlers subscribed to @a msgId, not including the ones subscribed to all messages
+    const QList<Handler> &handlers(uint32_t msgId) const
+    {
+        if (msgId < kDirectMsgIdCount) {
+            return _direct[msgId];
+        }
+
+        const auto it = _sparse.constFind(msgId);
+        return ((it != _sparse.constEnd()) ? it.value() : _empty);
+    }
+
+    /// Calls @a fn for each handler subscribed to @a msgId followed by each handler subscribed to all messages
+    template<typename Fn>
+    void dispatch(uint32_t msgId, Fn &&fn) const
+    {
+        for (const Handler &handler : handlers(msgId)) {
+            fn(handler);
+        }
+        for (const Handler &handler : _all) {
+            fn(handler);
+        }
+    }
+
+    static constexpr uint32_t kDirectMsgIdCount = 512;
+
+private:
+    std::array<QList<Handler>, kDirectMsgIdCount> _direct;
+    QHash<uint32_t, QList<Handler>> _sparse;
+    QList<Handler> _all;
+
+    static inline const QList<Handler> _empty{};
+};
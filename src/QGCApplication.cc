@@ -20,6 +20,7 @@
 
 #include "QGCLogging.h"
 #include "AudioOutput.h"
+#include "FactNotificationCoalescer.h"
 #include "FollowMe.h"
 #include "JoystickManager.h"
 #include "JsonHelper.h"
@@ -34,6 +35,7 @@
 #include "QGCImageProvider.h"
 #include "QGCLoggingCategory.h"
 #include "SettingsManager.h"
+#include "TilePrefetchManager.h"
 #include "MavlinkSettings.h"
 #include "AppSettings.h"
 #include "UDPLink.h"
@@ -51,6 +53,7 @@ QGCApplication::QGCApplication(int &argc, char *argv[], const QGCCommandLinePars
     : QApplication(argc, argv)
     , _runningUnitTests(cli.runningUnitTests)
     , _simpleBootTest(cli.simpleBootTest)
+    , _headlessLogReplay(cli.replayLogFile.has_value())
     , _fakeMobile(cli.fakeMobile)
     , _logOutput(cli.logOutput)
     , _systemId(cli.systemId.value_or(0))
@@ -229,6 +232,8 @@ void QGCApplication::init()
         // Since GStream builds are so problematic we initialize video during the simple boot test
         // to make sure it works and verfies plugin availability.
         _bootTestPassed = _initVideo();
+    } else if (_headlessLogReplay) {
+        _initForLogReplay();
     } else if (!_runningUnitTests) {
         _initForNormalAppBoot();
     }
@@ -249,11 +254,20 @@ bool QGCApplication::_initVideo()
     return initSucceeded;
 }
 
+void QGCApplication::_initForLogReplay()
+{
+    QGCCorePlugin::instance()->init();
+    MAVLinkProtocol::instance()->init();
+    MultiVehicleManager::instance()->init();
+}
+
 void QGCApplication::_initForNormalAppBoot()
 {
     (void) _initVideo();
 
     QQuickStyle::setStyle("Basic");
+    // Telemetry Facts notify the UI at most once per frame
+    FactNotificationCoalescer::instance()->setEnabled(true);
     QGCCorePlugin::instance()->init();
     MAVLinkProtocol::instance()->init();
     MultiVehicleManager::instance()->init();
@@ -263,6 +277,7 @@ void QGCApplication::_initForNormalAppBoot()
 
     AudioOutput::instance()->init(SettingsManager::instance()->appSettings()->audioMuted());
     FollowMe::instance()->init();
+    TilePrefetchManager::instance()->init();
     QGCPositionManager::instance()->init();
     LinkManager::instance()->init();
     VideoManager::instance()->init(mainRootWindow());
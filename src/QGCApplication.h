@@ -131,11 +131,15 @@ private slots:
     /// Initialize the application for normal application boot. Or in other words we are not going to run unit tests.
     void _initForNormalAppBoot();
 
+    /// Initialize only what is needed to push a log through the protocol and vehicle code, no UI or auto-connect
+    void _initForLogReplay();
+
     QObject *_rootQmlObject();
     void _checkForNewVersion();
 
     bool _runningUnitTests = false;
     bool _simpleBootTest = false;
+    bool _headlessLogReplay = false;
     bool _fakeMobile = false;    ///< true: Fake ui into displaying mobile interface
     bool _logOutput = false;    ///< true: Log Qt debug output to file
     quint8 _systemId = 0; ///< MAVLink system ID, 0 means not set
@@ -28,7 +28,7 @@ Rectangle {
     QGCFileDialog {
         id: filePicker
         title: qsTr("Select Telemetery Log")
-        nameFilters: [ qsTr("Telemetry Logs (*.%1)").arg(_logFileExtension), qsTr("All Files (*)") ]
+        nameFilters: [ qsTr("Telemetry Logs (*.%1 *.%1.zst *.%1.xz)").arg(_logFileExtension), qsTr("All Files (*)") ]
         folder: QGroundControl.settingsManager.appSettings.telemetrySavePath
         onAcceptedForLoad: (file) => {
             controller.link = QGroundControl.linkManager.startLogReplay(file)
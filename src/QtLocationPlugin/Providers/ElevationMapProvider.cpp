@@ -51,3 +51,35 @@ QByteArray CopernicusElevationProvider::serialize(const QByteArray &image) const
 {
     return TerrainTileCopernicus::serializeFromData(image);
 }
+
+int LocalDEMElevationProvider::long2tileX(double lon, int z) const
+{
+    Q_UNUSED(z)
+    return static_cast<int>(floor(lon + 180.0));
+}
+
+int LocalDEMElevationProvider::lat2tileY(double lat, int z) const
+{
+    Q_UNUSED(z)
+    return static_cast<int>(floor(lat + 90.0));
+}
+
+QString LocalDEMElevationProvider::_getURL(int x, int y, int zoom) const
+{
+    Q_UNUSED(x)
+    Q_UNUSED(y)
+    Q_UNUSED(zoom)
+    return QString();
+}
+
+QGCTileSet LocalDEMElevationProvider::getTileCount(int zoom, double topleftLon,
+                                                   double topleftLat, double bottomRightLon,
+                                                   double bottomRightLat) const
+{
+    Q_UNUSED(zoom)
+    Q_UNUSED(topleftLon)
+    Q_UNUSED(topleftLat)
+    Q_UNUSED(bottomRightLon)
+    Q_UNUSED(bottomRightLat)
+    return QGCTileSet();
+}
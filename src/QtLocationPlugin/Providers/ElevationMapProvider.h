@@ -50,3 +50,32 @@ class CopernicusElevationProvider : public ElevationProvider
 
     const QString _mapUrl = QString(kProviderURL) + QStringLiteral("/api/v1/carpet?points=%1,%2,%3,%4");
 };
+
+/// Elevation from DEM files (SRTM .hgt, GeoTIFF) in the terrain save directory, nothing is downloaded.
+/// See TerrainLocalDEM.
+class LocalDEMElevationProvider : public ElevationProvider
+{
+public:
+    LocalDEMElevationProvider()
+        : ElevationProvider(
+            kProviderKey,
+            QString(),
+            QStringLiteral("bin"),
+            0,
+            QGeoMapType::TerrainMap) {}
+
+    int long2tileX(double lon, int z) const final;
+    int lat2tileY(double lat, int z) const final;
+
+    /// Always empty, there are no tiles to download
+    QGCTileSet getTileCount(int zoom, double topleftLon,
+                            double topleftLat, double bottomRightLon,
+                            double bottomRightLat) const final;
+
+    QByteArray serialize(const QByteArray &image) const final { return image; }
+
+    static constexpr const char *kProviderKey = "Local DEM";
+
+private:
+    QString _getURL(int x, int y, int zoom) const final;
+};
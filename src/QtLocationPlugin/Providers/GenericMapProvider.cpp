@@ -12,6 +12,26 @@ QString CustomURLMapProvider::_getURL(int x, int y, int zoom) const
     return url;
 }
 
+QString OfflineArchiveMapProvider::_getURL(int x, int y, int zoom) const
+{
+    Q_UNUSED(x)
+    Q_UNUSED(y)
+    Q_UNUSED(zoom)
+    return QString();
+}
+
+QGCTileSet OfflineArchiveMapProvider::getTileCount(int zoom, double topleftLon,
+                                                   double topleftLat, double bottomRightLon,
+                                                   double bottomRightLat) const
+{
+    Q_UNUSED(zoom)
+    Q_UNUSED(topleftLon)
+    Q_UNUSED(topleftLat)
+    Q_UNUSED(bottomRightLon)
+    Q_UNUSED(bottomRightLat)
+    return QGCTileSet();
+}
+
 QString CyberJapanMapProvider::_getURL(int x, int y, int zoom) const
 {
     return _mapUrl.arg(_mapName).arg(zoom).arg(x).arg(y).arg(_imageFormat);
@@ -17,6 +17,32 @@ class CustomURLMapProvider : public MapProvider
     QString _getURL(int x, int y, int zoom) const final;
 };
 
+/// Tiles from the MBTiles and PMTiles archives in the map tiles save directory, served by the cache worker
+/// without a network fallback. Nothing is downloaded. See QGCTileArchiveSet.
+class OfflineArchiveMapProvider : public MapProvider
+{
+public:
+    OfflineArchiveMapProvider()
+        : MapProvider(
+            kProviderKey,
+            QString(),
+            QStringLiteral("png"),
+            QGC_AVERAGE_TILE_SIZE,
+            QGeoMapType::CustomMap) {}
+
+    bool isArchiveProvider() const final { return true; }
+
+    /// Always empty, there are no tiles to download
+    QGCTileSet getTileCount(int zoom, double topleftLon,
+                            double topleftLat, double bottomRightLon,
+                            double bottomRightLat) const final;
+
+    static constexpr const char *kProviderKey = "Offline Archive";
+
+private:
+    QString _getURL(int x, int y, int zoom) const final;
+};
+
 class CyberJapanMapProvider : public MapProvider
 {
 protected:
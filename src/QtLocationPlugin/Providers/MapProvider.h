@@ -56,6 +56,8 @@ class MapProvider
 
     virtual bool isElevationProvider() const { return false; }
     virtual bool isBingProvider() const { return false; }
+    /// Tiles come from local tile archives, there is no tile server
+    virtual bool isArchiveProvider() const { return false; }
 
     virtual QGCTileSet getTileCount(int zoom, double topleftLon,
                                     double topleftLat, double bottomRightLon,
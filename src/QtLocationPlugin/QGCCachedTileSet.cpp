@@ -1,5 +1,10 @@
 #include "QGCCachedTileSet.h"
 
+#include <QtCore/QTimer>
+
+#include <utility>
+
+#include "AppSettings.h"
 #include "ElevationMapProvider.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
@@ -8,20 +13,27 @@
 #include "QGCNetworkHelper.h"
 #include "QGCMapTasks.h"
 #include "QGCMapUrlEngine.h"
-#include "QGeoFileTileCacheQGC.h"
 #include "QGeoTileFetcherQGC.h"
+#include "SettingsManager.h"
 
 QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "QtLocationPlugin.QGCCachedTileSet")
 
 QGCCachedTileSet::QGCCachedTileSet(const QString &name, QObject *parent)
     : QObject(parent)
     , _name(name)
+    , _saveTimer(new QTimer(this))
 {
     qCDebug(QGCCachedTileSetLog) << this;
+
+    _saveTimer->setSingleShot(true);
+    _saveTimer->setInterval(kSaveBatchIntervalMs);
+    (void) connect(_saveTimer, &QTimer::timeout, this, &QGCCachedTileSet::_flushTileSaves);
 }
 
 QGCCachedTileSet::~QGCCachedTileSet()
 {
+    _flushTileSaves();
+
     qCDebug(QGCCachedTileSetLog) << this;
 }
 
@@ -49,6 +61,10 @@ void QGCCachedTileSet::createDownloadTask()
         setErrorCount(0);
         setDownloading(true);
         _noMoreTiles = false;
+        _tilesSavedSinceStart = 0;
+        _saveRate = 0.;
+        _saveRateTimer.start();
+        emit saveRateChanged();
     }
 
     QGCGetTileDownloadListTask *task = new QGCGetTileDownloadListTask(_id, kTileBatchSize);
@@ -106,6 +122,14 @@ void QGCCachedTileSet::_tileListFetched(const QQueue<QGCTile*> &tiles)
 
 void QGCCachedTileSet::_doneWithDownload()
 {
+    _flushTileSaves();
+
+    // The totals are taken from the saved tiles, so wait for the last batches to commit
+    if (_saveBatchesInFlight > 0) {
+        _donePending = true;
+        return;
+    }
+
     if (_errorCount == 0) {
         setTotalTileCount(_savedTileCount);
         setTotalTileSize(_savedTileSize);
@@ -231,21 +255,8 @@ void QGCCachedTileSet::_networkReplyFinished()
         return;
     }
 
-    QGeoFileTileCacheQGC::cacheTile(type, hash, image, format, _id);
-
-    QGCUpdateTileDownloadStateTask *task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-    if (!getQGCMapEngine()->addTask(task)) {
-        task->deleteLater();
-    }
-
-    setSavedTileSize(_savedTileSize + image.size());
-    setSavedTileCount(_savedTileCount + 1);
-
-    if (_savedTileCount % 10 == 0) {
-        const quint32 avg = _savedTileSize / _savedTileCount;
-        setTotalTileSize(avg * _totalTileCount);
-        setUniqueTileSize(avg * _uniqueTileCount);
-    }
+    // Counted as saved once its batch is committed, see _tilesSaved()
+    _queueTileSave(type, hash, image, format);
 
     _prepareDownload();
 }
@@ -287,6 +298,105 @@ void QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
     _prepareDownload();
 }
 
+void QGCCachedTileSet::_queueTileSave(const QString &type, const QString &hash, const QByteArray &image, const QString &format)
+{
+    if (SettingsManager::instance()->appSettings()->disableAllPersistence()->rawValue().toBool()) {
+        QGCUpdateTileDownloadStateTask *task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
+        if (!getQGCMapEngine()->addTask(task)) {
+            task->deleteLater();
+        }
+        _countSavedTiles(1, image.size());
+        return;
+    }
+
+    // One transaction per batch instead of one per tile, the tile leaves the download list in the same transaction
+    _pendingSaves.append(new QGCCacheTile(hash, image, format, type, _id));
+    if (_pendingSaves.size() >= kSaveBatchSize) {
+        _flushTileSaves();
+    } else if (!_saveTimer->isActive()) {
+        _saveTimer->start();
+    }
+}
+
+void QGCCachedTileSet::_flushTileSaves()
+{
+    _saveTimer->stop();
+    if (_pendingSaves.isEmpty()) {
+        return;
+    }
+
+    QStringList hashes;
+    hashes.reserve(_pendingSaves.size());
+    for (const QGCCacheTile *tile : std::as_const(_pendingSaves)) {
+        hashes.append(tile->hash);
+    }
+
+    QGCSaveTileBatchTask *task = new QGCSaveTileBatchTask(std::exchange(_pendingSaves, {}), true);
+    (void) connect(task, &QGCSaveTileBatchTask::tilesSaved, this, &QGCCachedTileSet::_tilesSaved);
+    (void) connect(task, &QGCMapTask::error, this, [this, hashes]() {
+        _tilesNotSaved(hashes);
+    });
+    if (_manager) {
+        (void) connect(task, &QGCMapTask::error, _manager, &QGCMapEngineManager::taskError);
+    }
+
+    // Counted before it is handed over, a rejected batch reports its error from addTask() and the engine deletes it
+    _saveBatchesInFlight++;
+    (void) getQGCMapEngine()->addTask(task);
+}
+
+void QGCCachedTileSet::_tilesNotSaved(const QStringList &hashes)
+{
+    // Rolled back, the tiles are still in the download list of the set but marked as downloading.
+    // Back to pending so the next download of the set fetches them again.
+    for (const QString &hash : hashes) {
+        QGCUpdateTileDownloadStateTask *task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, hash);
+        if (!getQGCMapEngine()->addTask(task)) {
+            task->deleteLater();
+        }
+    }
+
+    setErrorCount(_errorCount + static_cast<quint32>(hashes.size()));
+    _saveBatchFinished();
+}
+
+void QGCCachedTileSet::_tilesSaved(int count, qint64 bytes)
+{
+    _countSavedTiles(count, bytes);
+    _saveBatchFinished();
+
+    _tilesSavedSinceStart += count;
+
+    const qint64 elapsedMs = _saveRateTimer.isValid() ? _saveRateTimer.elapsed() : 0;
+    if (elapsedMs > 0) {
+        _saveRate = (_tilesSavedSinceStart * 1000.) / elapsedMs;
+        emit saveRateChanged();
+    }
+
+    qCDebug(QGCCachedTileSetLog) << _name << "saved" << count << "tiles," << _saveRate << "tiles/s";
+}
+
+void QGCCachedTileSet::_countSavedTiles(int count, qint64 bytes)
+{
+    setSavedTileSize(_savedTileSize + bytes);
+    setSavedTileCount(_savedTileCount + count);
+
+    if (_savedTileCount >= 10) {
+        const quint32 avg = _savedTileSize / _savedTileCount;
+        setTotalTileSize(avg * _totalTileCount);
+        setUniqueTileSize(avg * _uniqueTileCount);
+    }
+}
+
+void QGCCachedTileSet::_saveBatchFinished()
+{
+    _saveBatchesInFlight--;
+    if ((_saveBatchesInFlight == 0) && _donePending) {
+        _donePending = false;
+        _doneWithDownload();
+    }
+}
+
 void QGCCachedTileSet::setSelected(bool sel)
 {
     if (sel != _selected) {
@@ -303,6 +413,11 @@ QString QGCCachedTileSet::errorCountStr() const
     return qgcApp()->numberToString(_errorCount);
 }
 
+QString QGCCachedTileSet::saveRateStr() const
+{
+    return tr("%1 tiles/s").arg(qRound(_saveRate));
+}
+
 QString QGCCachedTileSet::totalTileCountStr() const
 {
     return qgcApp()->numberToString(_totalTileCount);
@@ -1,25 +1,32 @@
 #pragma once
 
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtNetwork/QNetworkReply>
 
 Q_DECLARE_LOGGING_CATEGORY(QGCCachedTileSetLog)
 
+struct QGCCacheTile;
 struct QGCTile;
 class QGCMapEngineManager;
 class QNetworkAccessManager;
+class QTimer;
 
 class QGCCachedTileSet : public QObject
 {
     Q_OBJECT
     Q_MOC_INCLUDE("QGCTile.h")
 
+    friend class QGCCachedTileSetTest;
+
     Q_PROPERTY(QString      name                READ    name                NOTIFY nameChanged)
     Q_PROPERTY(QString      mapTypeStr          READ    mapTypeStr          CONSTANT)
     Q_PROPERTY(double       topleftLon          READ    topleftLon          CONSTANT)
@@ -49,6 +56,8 @@ class QGCCachedTileSet : public QObject
     Q_PROPERTY(bool         downloading         READ    downloading         NOTIFY downloadingChanged)
     Q_PROPERTY(quint32      errorCount          READ    errorCount          NOTIFY errorCountChanged)
     Q_PROPERTY(QString      errorCountStr       READ    errorCountStr       NOTIFY errorCountChanged)
+    Q_PROPERTY(double       saveRate            READ    saveRate            NOTIFY saveRateChanged)
+    Q_PROPERTY(QString      saveRateStr         READ    saveRateStr         NOTIFY saveRateChanged)
     Q_PROPERTY(bool         selected            READ    selected            WRITE  setSelected  NOTIFY selectedChanged)
 
 public:
@@ -92,6 +101,9 @@ class QGCCachedTileSet : public QObject
     bool downloading() const { return _downloading; }
     quint32 errorCount() const { return _errorCount; }
     QString errorCountStr() const;
+    /// Tiles per second written to the cache database since the download started
+    double saveRate() const { return _saveRate; }
+    QString saveRateStr() const;
     bool selected() const { return _selected; }
 
     void setManager(QGCMapEngineManager *mgr) { _manager = mgr; }
@@ -132,6 +144,7 @@ class QGCCachedTileSet : public QObject
     void savedTileSizeChanged();
     void completeChanged();
     void errorCountChanged();
+    void saveRateChanged();
     void selectedChanged();
     void nameChanged();
 
@@ -143,6 +156,12 @@ private slots:
 private:
     void _prepareDownload();
     void _doneWithDownload();
+    void _queueTileSave(const QString &type, const QString &hash, const QByteArray &image, const QString &format);
+    void _flushTileSaves();
+    void _tilesSaved(int count, qint64 bytes);
+    void _tilesNotSaved(const QStringList &hashes);
+    void _countSavedTiles(int count, qint64 bytes);
+    void _saveBatchFinished();
 
     QString _name;
     QString _mapTypeStr;
@@ -173,8 +192,17 @@ private slots:
     QHash<QString, QNetworkReply*> _replies;
     QMutex _repliesMutex;
     QQueue<QGCTile*> _tilesToDownload;
+    QList<QGCCacheTile*> _pendingSaves;     ///< Downloaded tiles waiting for the next batch write
+    QTimer *_saveTimer = nullptr;
+    int _saveBatchesInFlight = 0;           ///< Batches sent to the cache worker which did not commit or fail yet
+    bool _donePending = false;              ///< The download finished, waiting for the batches in flight
+    QElapsedTimer _saveRateTimer;
+    quint64 _tilesSavedSinceStart = 0;
+    double _saveRate = 0.;
     QGCMapEngineManager *_manager = nullptr;
     QNetworkAccessManager *_networkManager = nullptr;
 
     static constexpr uint32_t kTileBatchSize = 256;
+    static constexpr int kSaveBatchSize = 64;           ///< Downloaded tiles written per transaction
+    static constexpr int kSaveBatchIntervalMs = 500;    ///< Longest a downloaded tile waits for its batch
 };
@@ -2,14 +2,18 @@
 
 #include <QtCore/QApplicationStatic>
 
+#include "AppSettings.h"
+#include "MapsSettings.h"
 #include "QGCCachedTileSet.h"
 #include "QGCCacheTile.h"
 #include "QGCLoggingCategory.h"
 #include "QGCMapTasks.h"
 #include "QGCTile.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTilePrefetcher.h"
 #include "QGCTileSet.h"
 #include "QGeoFileTileCacheQGC.h"
+#include "SettingsManager.h"
 
 QGC_LOGGING_CATEGORY(QGCMapEngineLog, "QtLocationPlugin.QGCMapEngine")
 
@@ -22,6 +26,7 @@ QGCMapEngine *getQGCMapEngine()
 
 QGCMapEngine::QGCMapEngine(QObject *parent)
     : QObject(parent)
+    , m_prefetcher(new QGCTilePrefetcher(this))
 {
     qCDebug(QGCMapEngineLog) << this;
 
@@ -63,6 +68,17 @@ void QGCMapEngine::init(const QString &databasePath)
     m_worker->setDatabaseFile(databasePath);
     (void) connect(m_worker, &QGCCacheWorker::updateTotals, this, &QGCMapEngine::_updateTotals);
 
+    Fact *const maxTileMemoryCacheSize = SettingsManager::instance()->mapsSettings()->maxTileMemoryCacheSize();
+    (void) connect(maxTileMemoryCacheSize, &Fact::rawValueChanged, this, &QGCMapEngine::_memoryCacheSizeChanged);
+    _memoryCacheSizeChanged();
+
+    (void) connect(SettingsManager::instance()->appSettings(), &AppSettings::savePathsChanged, this, &QGCMapEngine::_loadTileArchives);
+    _loadTileArchives();
+
+    Fact *const prefetchBandwidth = SettingsManager::instance()->mapsSettings()->tilePrefetchMaxBandwidth();
+    (void) connect(prefetchBandwidth, &Fact::rawValueChanged, this, &QGCMapEngine::_prefetchBandwidthChanged);
+    _prefetchBandwidthChanged();
+
     QGCMapTask *task = new QGCMapTask(QGCMapTask::TaskType::taskInit);
     if (!addTask(task)) {
         task->deleteLater();
@@ -72,6 +88,13 @@ void QGCMapEngine::init(const QString &databasePath)
 
 bool QGCMapEngine::addTask(QGCMapTask *task)
 {
+    if (!m_worker) {
+        // Rejected like the worker rejects tasks before its database is initialized
+        task->setError(tr("Database Not Initialized"));
+        task->deleteLater();
+        return false;
+    }
+
     // DirectConnection is intentional: the worker thread uses a custom loop (not
     // an event loop), so queued connections would never be delivered. The queue
     // is mutex-protected in enqueueTask, so calling from the main thread is safe.
@@ -80,6 +103,44 @@ bool QGCMapEngine::addTask(QGCMapTask *task)
     return result;
 }
 
+QGCTileMemoryCache::Statistics_t QGCMapEngine::memoryCacheStatistics() const
+{
+    if (!m_worker) {
+        return {};
+    }
+
+    return m_worker->statistics().memoryCache;
+}
+
+void QGCMapEngine::_memoryCacheSizeChanged()
+{
+    const qint64 maxBytes = SettingsManager::instance()->mapsSettings()->maxTileMemoryCacheSize()->rawValue().toLongLong() * 1024 * 1024;
+    m_worker->setMemoryCacheSize(maxBytes);
+}
+
+QStringList QGCMapEngine::tileArchiveFileNames() const
+{
+    if (!m_worker) {
+        return {};
+    }
+
+    return m_worker->tileArchiveFileNames();
+}
+
+void QGCMapEngine::_loadTileArchives()
+{
+    // Archives are only opened here, their tiles are read on demand
+    const QString directory = SettingsManager::instance()->appSettings()->mapTilesSavePath();
+    const int count = m_worker->loadTileArchives(directory);
+    qCDebug(QGCMapEngineLog) << "tile archives" << count << "in" << directory;
+}
+
+void QGCMapEngine::_prefetchBandwidthChanged()
+{
+    const qint64 maxBytesPerSecond = SettingsManager::instance()->mapsSettings()->tilePrefetchMaxBandwidth()->rawValue().toLongLong() * 1024;
+    m_prefetcher->setMaxBytesPerSecond(maxBytesPerSecond);
+}
+
 void QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
     emit updateTotals(totaltiles, totalsize, defaulttiles, defaultsize);
@@ -3,11 +3,15 @@
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include "QGCTileMemoryCache.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCMapEngineLog)
 
 class QGCMapTask;
 class QGCCacheWorker;
+class QGCTilePrefetcher;
 
 class QGCMapEngine : public QObject
 {
@@ -20,6 +24,13 @@ class QGCMapEngine : public QObject
     void init(const QString &databasePath);
     bool addTask(QGCMapTask *task);
 
+    /// Hits of the tiles kept in memory in front of the tile database
+    QGCTileMemoryCache::Statistics_t memoryCacheStatistics() const;
+    /// Files of the MBTiles and PMTiles archives served as the "Offline Archive" map type
+    QStringList tileArchiveFileNames() const;
+    /// Loads the tiles ahead of the active vehicle, fed by TilePrefetchManager
+    QGCTilePrefetcher *tilePrefetcher() const { return m_prefetcher; }
+
     static QGCMapEngine *instance();
 
 signals:
@@ -28,9 +39,13 @@ class QGCMapEngine : public QObject
 private slots:
     void _updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void _pruned() { m_pruning = false; }
+    void _memoryCacheSizeChanged();
+    void _loadTileArchives();
+    void _prefetchBandwidthChanged();
 
 private:
     QGCCacheWorker *m_worker = nullptr;
+    QGCTilePrefetcher *m_prefetcher = nullptr;
     bool m_pruning = false;
     std::atomic<bool> m_initialized = false;
 };
@@ -90,6 +90,45 @@ QString QGCMapEngineManager::tileSizeStr() const
     return qgcApp()->bigSizeToString(_imageSet.tileSize + _elevationSet.tileSize);
 }
 
+QString QGCMapEngineManager::memoryCacheStatsStr() const
+{
+    const quint64 reads = _memoryCacheStats.hits + _memoryCacheStats.misses;
+    if (reads == 0) {
+        return tr("No tiles read yet");
+    }
+
+    return tr("%1% of %2 reads, %3 tiles (%4) in memory")
+        .arg(qRound(_memoryCacheStats.hitRate() * 100.))
+        .arg(qgcApp()->numberToString(reads))
+        .arg(qgcApp()->numberToString(static_cast<quint64>(_memoryCacheStats.count)))
+        .arg(qgcApp()->bigSizeToString(static_cast<quint64>(_memoryCacheStats.bytes)));
+}
+
+void QGCMapEngineManager::updateMemoryCacheStats()
+{
+    _memoryCacheStats = getQGCMapEngine()->memoryCacheStatistics();
+    emit memoryCacheStatsChanged();
+}
+
+QString QGCMapEngineManager::prefetchStatsStr() const
+{
+    if (_prefetchStats.prefetched() == 0) {
+        return tr("No tiles prefetched yet");
+    }
+
+    return tr("%1% of %2 prefetched tiles used, %3 downloaded (%4)")
+        .arg(qRound(_prefetchStats.hitRatio() * 100.))
+        .arg(qgcApp()->numberToString(_prefetchStats.prefetched()))
+        .arg(qgcApp()->numberToString(_prefetchStats.downloaded))
+        .arg(qgcApp()->bigSizeToString(_prefetchStats.downloadedBytes));
+}
+
+void QGCMapEngineManager::updatePrefetchStats()
+{
+    _prefetchStats = getQGCMapEngine()->tilePrefetcher()->statistics();
+    emit prefetchStatsChanged();
+}
+
 void QGCMapEngineManager::loadTileSets()
 {
     if (_tileSets->count() > 0) {
@@ -142,7 +181,8 @@ void QGCMapEngineManager::startDownload(const QString &name, const QString &mapT
     }
 
     const int mapid = UrlFactory::getQtMapIdFromProviderType(mapType);
-    if (_fetchElevation && !UrlFactory::isElevation(mapid)) {
+    // Local elevation providers have no tiles to download
+    if (_fetchElevation && !UrlFactory::isElevation(mapid) && (_elevationSet.tileCount > 0)) {
         QGCCachedTileSet* const set = new QGCCachedTileSet(name + QStringLiteral(" Elevation"));
         const QString elevationProviderName = SettingsManager::instance()->flightMapSettings()->elevationMapProvider()->rawValue().toString();
         set->setMapTypeStr(elevationProviderName);
@@ -268,6 +308,9 @@ void QGCMapEngineManager::taskError(QGCMapTask::TaskType type, const QString &er
 {
     QString task;
     switch (type) {
+    case QGCMapTask::TaskType::taskCacheTileBatch:
+        task = QStringLiteral("Save Downloaded Tiles");
+        break;
     case QGCMapTask::TaskType::taskFetchTileSets:
         task = QStringLiteral("Fetch Tile Set");
         break;
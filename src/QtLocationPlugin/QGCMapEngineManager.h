@@ -5,6 +5,8 @@
 
 #include "QGCTileSet.h"
 #include "QGCMapTasks.h"
+#include "QGCTileMemoryCache.h"
+#include "QGCTilePrefetcher.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCMapEngineManagerLog)
 
@@ -33,6 +35,8 @@ class QGCMapEngineManager : public QObject
     Q_PROPERTY(QStringList          elevationProviderList   READ elevationProviderList              CONSTANT)
     Q_PROPERTY(quint64              tileCount       READ tileCount                                  NOTIFY tileCountChanged)
     Q_PROPERTY(quint64              tileSize        READ tileSize                                   NOTIFY tileSizeChanged)
+    Q_PROPERTY(QString              memoryCacheStatsStr     READ memoryCacheStatsStr                NOTIFY memoryCacheStatsChanged)
+    Q_PROPERTY(QString              prefetchStatsStr        READ prefetchStatsStr                   NOTIFY prefetchStatsChanged)
 
 public:
     explicit QGCMapEngineManager(QObject *parent = nullptr);
@@ -64,6 +68,10 @@ class QGCMapEngineManager : public QObject
     Q_INVOKABLE void selectAll();
     Q_INVOKABLE void selectNone();
     Q_INVOKABLE void startDownload(const QString &name, const QString &mapType);
+    /// Takes a new snapshot of the database tile memory cache hits for memoryCacheStatsStr
+    Q_INVOKABLE void updateMemoryCacheStats();
+    /// Takes a new snapshot of the tile prefetcher counters for prefetchStatsStr
+    Q_INVOKABLE void updatePrefetchStats();
     Q_INVOKABLE void updateForCurrentView(double lon0, double lat0, double lon1, double lat1, int minZoom, int maxZoom, const QString &mapName);
 
     Q_INVOKABLE static QString loadSetting(const QString &key, const QString &defaultValue);
@@ -77,6 +85,8 @@ class QGCMapEngineManager : public QObject
     QString errorMessage() const { return _errorMessage; }
     QString tileCountStr() const;
     QString tileSizeStr() const;
+    QString memoryCacheStatsStr() const;
+    QString prefetchStatsStr() const;
     quint64 tileCount() const { return (_imageSet.tileCount + _elevationSet.tileCount); }
     quint64 tileSize() const { return (_imageSet.tileSize + _elevationSet.tileSize); }
 
@@ -95,6 +105,8 @@ class QGCMapEngineManager : public QObject
     void freeDiskSpaceChanged();
     void importActionChanged();
     void importReplaceChanged();
+    void memoryCacheStatsChanged();
+    void prefetchStatsChanged();
     void selectedCountChanged();
     void tileCountChanged();
     void tileSetsChanged();
@@ -118,6 +130,8 @@ private slots:
     QmlObjectListModel *_tileSets = nullptr;
     QGCTileSet _imageSet;
     QGCTileSet _elevationSet;
+    QGCTileMemoryCache::Statistics_t _memoryCacheStats;
+    QGCTilePrefetcher::Statistics_t _prefetchStats;
     ImportAction _importAction = ImportAction::ActionNone;
     double _topleftLat = 0.;
     double _topleftLon = 0.;
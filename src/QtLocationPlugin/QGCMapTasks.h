@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
 #include <QtCore/QString>
@@ -27,7 +28,8 @@ class QGCMapTask : public QObject
         taskPruneCache,
         taskReset,
         taskExport,
-        taskImport
+        taskImport,
+        taskCacheTileBatch
     };
     Q_ENUM(TaskType);
 
@@ -44,11 +46,16 @@ class QGCMapTask : public QObject
         emit error(m_type, errorString);
     }
 
+    /// Started when the task is queued, for the cache worker latency statistics
+    void startQueuedTimer() { m_queuedTimer.start(); }
+    qint64 queuedUSecs() const { return (m_queuedTimer.isValid() ? (m_queuedTimer.nsecsElapsed() / 1000) : 0); }
+
 signals:
     void error(QGCMapTask::TaskType type, const QString &errorString);
 
 private:
     const TaskType m_type = TaskType::taskInit;
+    QElapsedTimer m_queuedTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -159,6 +166,46 @@ class QGCSaveTileTask : public QGCMapTask
 
 //-----------------------------------------------------------------------------
 
+/// Saves downloaded tiles in one database transaction
+class QGCSaveTileBatchTask : public QGCMapTask
+{
+    Q_OBJECT
+
+public:
+    /// @param completeDownloads Also removes the tiles from the download list of their tile set
+    explicit QGCSaveTileBatchTask(const QList<QGCCacheTile*> &tiles, bool completeDownloads, QObject *parent = nullptr)
+        : QGCMapTask(TaskType::taskCacheTileBatch, parent)
+        , m_tiles(tiles)
+        , m_completeDownloads(completeDownloads)
+    {}
+    ~QGCSaveTileBatchTask()
+    {
+        qDeleteAll(m_tiles);
+    }
+
+    const QList<QGCCacheTile*> &tiles() const { return m_tiles; }
+    bool completeDownloads() const { return m_completeDownloads; }
+
+    void setTilesSaved()
+    {
+        qint64 bytes = 0;
+        for (const QGCCacheTile *tile : m_tiles) {
+            bytes += tile->img.size();
+        }
+        emit tilesSaved(static_cast<int>(m_tiles.size()), bytes);
+    }
+
+signals:
+    /// Emitted once the transaction writing the tiles committed
+    void tilesSaved(int count, qint64 bytes);
+
+private:
+    const QList<QGCCacheTile*> m_tiles;
+    const bool m_completeDownloads = false;
+};
+
+//-----------------------------------------------------------------------------
+
 class QGCGetTileDownloadListTask : public QGCMapTask
 {
     Q_OBJECT
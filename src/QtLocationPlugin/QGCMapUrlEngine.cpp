@@ -67,7 +67,11 @@ const QList<SharedMapProvider> UrlFactory::_providers = {
 
     std::make_shared<CustomURLMapProvider>(),
 
-    std::make_shared<CopernicusElevationProvider>()
+    std::make_shared<CopernicusElevationProvider>(),
+    std::make_shared<LocalDEMElevationProvider>(),
+
+    // Appended so the map ids, which are part of the cached tile hashes, of the providers above do not change
+    std::make_shared<OfflineArchiveMapProvider>()
 };
 
 QString UrlFactory::getImageFormat(int qtMapId, QByteArrayView image)
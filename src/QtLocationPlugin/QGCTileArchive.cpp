@@ -0,0 +1,549 @@
+#include "QGCTileArchive.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QThread>
+#include <QtCore/QtEndian>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "QGCCompression.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(QGCTileArchiveLog, "QtLocationPlugin.QGCTileArchive")
+
+namespace {
+
+// PMTiles version 3 header, all integers little endian
+constexpr qint64 kPMTilesHeaderSize = 127;
+constexpr qint64 kPMTilesRootOffset = 8;
+constexpr qint64 kPMTilesRootLength = 16;
+constexpr qint64 kPMTilesLeafOffset = 40;
+constexpr qint64 kPMTilesLeafLength = 48;
+constexpr qint64 kPMTilesTileDataOffset = 56;
+constexpr qint64 kPMTilesTileDataLength = 64;
+constexpr qint64 kPMTilesInternalCompression = 97;
+constexpr qint64 kPMTilesTileCompression = 98;
+constexpr qint64 kPMTilesTileType = 99;
+constexpr qint64 kPMTilesMinZoom = 100;
+constexpr qint64 kPMTilesMaxZoom = 101;
+
+constexpr quint8 kCompressionUnknown = 0;
+constexpr quint8 kCompressionNone = 1;
+constexpr quint8 kCompressionGzip = 2;
+constexpr quint8 kCompressionZstd = 4;
+
+constexpr quint8 kTileTypePng = 2;
+constexpr quint8 kTileTypeJpeg = 3;
+constexpr quint8 kTileTypeWebp = 4;
+
+constexpr qint64 kMaxDecompressedBytes = 64 * 1024 * 1024;
+
+/// SQLite maps at most this much of an MBTiles file, the rest is read through the page cache
+constexpr qint64 kMaxMBTilesMmapBytes = qint64{1} << 32;
+
+std::atomic<quint64> s_connectionCounter{0};
+
+bool _supportedCompression(quint8 compression)
+{
+    return ((compression == kCompressionUnknown) || (compression == kCompressionNone) ||
+            (compression == kCompressionGzip) || (compression == kCompressionZstd));
+}
+
+QByteArray _decompress(const QByteArray &data, quint8 compression)
+{
+    switch (compression) {
+    case kCompressionUnknown:
+    case kCompressionNone:
+        return data;
+    case kCompressionGzip:
+        return QGCCompression::decompressData(data, QGCCompression::Format::GZIP, kMaxDecompressedBytes);
+    case kCompressionZstd:
+        return QGCCompression::decompressData(data, QGCCompression::Format::ZSTD, kMaxDecompressedBytes);
+    default:
+        return QByteArray();
+    }
+}
+
+/// @return True if @a length bytes from @a offset lie within @a size bytes
+bool _fits(quint64 offset, quint64 length, quint64 size)
+{
+    return ((offset <= size) && (length <= (size - offset)));
+}
+
+/// Unsigned LEB128 values of a PMTiles directory
+class VarintReader
+{
+public:
+    explicit VarintReader(const QByteArray &bytes)
+        : _data(reinterpret_cast<const uchar*>(bytes.constData())), _size(bytes.size()) {}
+
+    quint64 read()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_position >= _size) {
+                _failed = true;
+                return 0;
+            }
+            const uchar byte = _data[_position++];
+            value |= static_cast<quint64>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+
+        _failed = true;
+        return 0;
+    }
+
+    bool failed() const { return _failed; }
+
+private:
+    const uchar *const _data;
+    const qsizetype _size;
+    qsizetype _position = 0;
+    bool _failed = false;
+};
+
+} // namespace
+
+QGCTileArchive::QGCTileArchive()
+    : _leafDirectories(kMaxCachedDirectoryEntries)
+{
+}
+
+QGCTileArchive::~QGCTileArchive()
+{
+    close();
+}
+
+bool QGCTileArchive::isSupportedFile(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    return ((suffix == QStringLiteral("mbtiles")) || (suffix == QStringLiteral("pmtiles")));
+}
+
+quint64 QGCTileArchive::pmtilesTileId(int x, int y, int zoom)
+{
+    const quint64 n = quint64{1} << zoom;
+    quint64 tileId = ((n * n) - 1) / 3;
+    quint64 tx = static_cast<quint64>(x);
+    quint64 ty = static_cast<quint64>(y);
+    for (quint64 s = n / 2; s > 0; s /= 2) {
+        const quint64 rx = ((tx & s) != 0) ? 1 : 0;
+        const quint64 ry = ((ty & s) != 0) ? 1 : 0;
+        tileId += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                tx = n - 1 - tx;
+                ty = n - 1 - ty;
+            }
+            std::swap(tx, ty);
+        }
+    }
+
+    return tileId;
+}
+
+bool QGCTileArchive::open(const QString &fileName)
+{
+    close();
+    _errorString.clear();
+    _fileName = fileName;
+
+    if (!isSupportedFile(fileName)) {
+        return _setError(QStringLiteral("Unsupported file type"));
+    }
+
+    if (QFileInfo(fileName).suffix().toLower() == QStringLiteral("mbtiles")) {
+        if (!_openMBTiles()) {
+            return false;
+        }
+        _format = Format::MBTiles;
+    } else {
+        if (!_openPMTiles()) {
+            return false;
+        }
+        _format = Format::PMTiles;
+    }
+
+    qCDebug(QGCTileArchiveLog) << fileName << "format" << _tileFormat << "zoom" << _minZoom << "-" << _maxZoom;
+
+    return true;
+}
+
+void QGCTileArchive::close()
+{
+    _removeConnections();
+
+    _rootDirectory.reset();
+    {
+        QMutexLocker locker(&_leafDirectoriesMutex);
+        _leafDirectories.clear();
+    }
+    if (_data) {
+        (void) _file.unmap(_data);
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+
+    _size = 0;
+    _format = Format::Invalid;
+    _tileFormat.clear();
+    _minZoom = 0;
+    _maxZoom = 0;
+}
+
+bool QGCTileArchive::_setError(const QString &errorString)
+{
+    _errorString = errorString;
+    qCWarning(QGCTileArchiveLog) << _fileName << errorString;
+    close();
+    return false;
+}
+
+QByteArray QGCTileArchive::tile(int x, int y, int zoom) const
+{
+    if ((zoom < _minZoom) || (zoom > _maxZoom) || (x < 0) || (y < 0) || (x >= (1 << zoom)) || (y >= (1 << zoom))) {
+        return QByteArray();
+    }
+
+    switch (_format) {
+    case Format::MBTiles:
+        return _mbtilesTile(x, y, zoom);
+    case Format::PMTiles:
+        return _pmtilesTile(x, y, zoom);
+    default:
+        return QByteArray();
+    }
+}
+
+/*===========================================================================*/
+
+bool QGCTileArchive::_openMBTiles()
+{
+    const QString connection = _threadConnection();
+    if (connection.isEmpty()) {
+        return _setError(QStringLiteral("Failed to open the MBTiles database"));
+    }
+
+    QString format;
+    int minZoom = -1;
+    int maxZoom = -1;
+    QString errorString;
+    {
+        QSqlQuery query(QSqlDatabase::database(connection, false));
+        if (query.exec("SELECT name, value FROM metadata")) {
+            while (query.next()) {
+                const QString name = query.value(0).toString();
+                if (name == QStringLiteral("format")) {
+                    format = query.value(1).toString().toLower();
+                } else if (name == QStringLiteral("minzoom")) {
+                    minZoom = query.value(1).toInt();
+                } else if (name == QStringLiteral("maxzoom")) {
+                    maxZoom = query.value(1).toInt();
+                }
+            }
+
+            if ((minZoom < 0) || (maxZoom < 0)) {
+                if (query.exec("SELECT MIN(zoom_level), MAX(zoom_level) FROM tiles") && query.next()) {
+                    minZoom = query.value(0).toInt();
+                    maxZoom = query.value(1).toInt();
+                } else {
+                    errorString = QStringLiteral("MBTiles file has no tiles table");
+                }
+            }
+        } else {
+            errorString = QStringLiteral("MBTiles file has no metadata table");
+        }
+    }
+    if (!errorString.isEmpty()) {
+        return _setError(errorString);
+    }
+
+    // Version 1.0 of the specification had no format, it only allowed PNG and JPEG
+    if (format.isEmpty() || (format == QStringLiteral("png"))) {
+        _tileFormat = QStringLiteral("png");
+    } else if ((format == QStringLiteral("jpg")) || (format == QStringLiteral("jpeg"))) {
+        _tileFormat = QStringLiteral("jpg");
+    } else if (format == QStringLiteral("webp")) {
+        _tileFormat = QStringLiteral("webp");
+    } else {
+        return _setError(QStringLiteral("Tile format %1 is not a supported raster format").arg(format));
+    }
+
+    _minZoom = qBound(0, minZoom, kMaxZoom);
+    _maxZoom = qBound(_minZoom, maxZoom, kMaxZoom);
+
+    return true;
+}
+
+QString QGCTileArchive::_threadConnection() const
+{
+    const QThread *const thread = QThread::currentThread();
+
+    QMutexLocker locker(&_connectionsMutex);
+    const auto it = _connections.constFind(thread);
+    if (it != _connections.cend()) {
+        return it.value();
+    }
+
+    const QString connection = QStringLiteral("QGCTileArchive_%1").arg(s_connectionCounter.fetch_add(1));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(_fileName);
+        db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+        if (!db.open()) {
+            qCWarning(QGCTileArchiveLog) << _fileName << "open:" << db.lastError().text();
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connection);
+            return QString();
+        }
+
+        // Pages are then read from the mapping instead of being copied into the SQLite page cache
+        QSqlQuery pragma(db);
+        const qint64 mmapBytes = qMin(QFileInfo(_fileName).size(), kMaxMBTilesMmapBytes);
+        if (!pragma.exec(QStringLiteral("PRAGMA mmap_size = %1").arg(mmapBytes))) {
+            qCDebug(QGCTileArchiveLog) << _fileName << "mmap:" << pragma.lastError().text();
+        }
+    }
+
+    (void) _connections.insert(thread, connection);
+    return connection;
+}
+
+void QGCTileArchive::releaseThreadConnection() const
+{
+    QMutexLocker locker(&_connectionsMutex);
+    const QString connection = _connections.take(QThread::currentThread());
+    locker.unlock();
+
+    if (!connection.isEmpty()) {
+        QSqlDatabase::removeDatabase(connection);
+    }
+}
+
+bool QGCTileArchive::hasThreadConnections() const
+{
+    QMutexLocker locker(&_connectionsMutex);
+    return !_connections.isEmpty();
+}
+
+void QGCTileArchive::_removeConnections()
+{
+    releaseThreadConnection();
+
+    // A connection may only be removed by its own thread, one of another thread could be in use right now.
+    // QGCTileArchiveSet retires archives through the reading threads so this does not happen there.
+    QMutexLocker locker(&_connectionsMutex);
+    if (!_connections.isEmpty()) {
+        qCWarning(QGCTileArchiveLog) << _fileName << "closed while" << _connections.size() << "other threads still have a connection, leaving them open";
+        _connections.clear();
+    }
+}
+
+QByteArray QGCTileArchive::_mbtilesTile(int x, int y, int zoom) const
+{
+    const QString connection = _threadConnection();
+    if (connection.isEmpty()) {
+        return QByteArray();
+    }
+
+    QSqlQuery query(QSqlDatabase::database(connection, false));
+    if (!query.prepare("SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?")) {
+        qCWarning(QGCTileArchiveLog) << _fileName << "prepare:" << query.lastError().text();
+        return QByteArray();
+    }
+
+    // MBTiles rows are numbered from the south (TMS)
+    query.addBindValue(zoom);
+    query.addBindValue(x);
+    query.addBindValue(((1 << zoom) - 1) - y);
+    if (!query.exec() || !query.next()) {
+        return QByteArray();
+    }
+
+    return query.value(0).toByteArray();
+}
+
+/*===========================================================================*/
+
+bool QGCTileArchive::_openPMTiles()
+{
+    _file.setFileName(_fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return _setError(_file.errorString());
+    }
+
+    _size = _file.size();
+    _data = (_size > 0) ? _file.map(0, _size) : nullptr;
+    if (!_data) {
+        return _setError((_size > 0) ? _file.errorString() : QStringLiteral("File is empty"));
+    }
+
+    if ((_size < kPMTilesHeaderSize) || (std::memcmp(_data, "PMTiles", 7) != 0)) {
+        return _setError(QStringLiteral("Not a PMTiles file"));
+    }
+    if (_data[7] != 3) {
+        return _setError(QStringLiteral("PMTiles version %1 is not supported").arg(_data[7]));
+    }
+
+    const quint64 rootOffset = qFromLittleEndian<quint64>(_data + kPMTilesRootOffset);
+    const quint64 rootLength = qFromLittleEndian<quint64>(_data + kPMTilesRootLength);
+    _leafDirectoriesOffset = qFromLittleEndian<quint64>(_data + kPMTilesLeafOffset);
+    _leafDirectoriesLength = qFromLittleEndian<quint64>(_data + kPMTilesLeafLength);
+    _tileDataOffset = qFromLittleEndian<quint64>(_data + kPMTilesTileDataOffset);
+    _tileDataLength = qFromLittleEndian<quint64>(_data + kPMTilesTileDataLength);
+    _internalCompression = _data[kPMTilesInternalCompression];
+    _tileCompression = _data[kPMTilesTileCompression];
+
+    const quint64 size = static_cast<quint64>(_size);
+    if (!_fits(rootOffset, rootLength, size) || !_fits(_leafDirectoriesOffset, _leafDirectoriesLength, size) ||
+        !_fits(_tileDataOffset, _tileDataLength, size)) {
+        return _setError(QStringLiteral("PMTiles sections lie outside the file"));
+    }
+
+    if (!_supportedCompression(_internalCompression) || !_supportedCompression(_tileCompression)) {
+        return _setError(QStringLiteral("PMTiles compression %1/%2 is not supported").arg(_internalCompression).arg(_tileCompression));
+    }
+
+    switch (_data[kPMTilesTileType]) {
+    case kTileTypePng:
+        _tileFormat = QStringLiteral("png");
+        break;
+    case kTileTypeJpeg:
+        _tileFormat = QStringLiteral("jpg");
+        break;
+    case kTileTypeWebp:
+        _tileFormat = QStringLiteral("webp");
+        break;
+    default:
+        return _setError(QStringLiteral("Tile type %1 is not a supported raster format").arg(_data[kPMTilesTileType]));
+    }
+
+    _minZoom = _data[kPMTilesMinZoom];
+    _maxZoom = _data[kPMTilesMaxZoom];
+    if ((_minZoom > _maxZoom) || (_maxZoom > kMaxZoom)) {
+        return _setError(QStringLiteral("Invalid zoom range %1-%2").arg(_minZoom).arg(_maxZoom));
+    }
+
+    _rootDirectory = _decodeDirectory(rootOffset, rootLength);
+    if (!_rootDirectory) {
+        return _setError(QStringLiteral("Invalid PMTiles root directory"));
+    }
+
+    return true;
+}
+
+std::shared_ptr<const QGCTileArchive::Directory> QGCTileArchive::_decodeDirectory(quint64 offset, quint64 length) const
+{
+    if (!_fits(offset, length, static_cast<quint64>(_size)) || (length == 0)) {
+        return nullptr;
+    }
+
+    const QByteArray bytes = _decompress(QByteArray::fromRawData(reinterpret_cast<const char*>(_data + offset), static_cast<qsizetype>(length)),
+                                         _internalCompression);
+    VarintReader reader(bytes);
+
+    // Every entry takes at least one byte for each of its four columns
+    const quint64 count = reader.read();
+    if (reader.failed() || (count > static_cast<quint64>(bytes.size() / 4))) {
+        return nullptr;
+    }
+
+    auto directory = std::make_shared<Directory>(static_cast<qsizetype>(count));
+
+    // Columns: tile id deltas, run lengths, lengths, offsets (0 for right after the previous entry, else offset + 1)
+    quint64 tileId = 0;
+    for (DirectoryEntry_t &entry : *directory) {
+        tileId += reader.read();
+        entry.tileId = tileId;
+    }
+    for (DirectoryEntry_t &entry : *directory) {
+        entry.runLength = static_cast<quint32>(reader.read());
+    }
+    for (DirectoryEntry_t &entry : *directory) {
+        entry.length = static_cast<quint32>(reader.read());
+    }
+    for (qsizetype i = 0; i < directory->size(); i++) {
+        DirectoryEntry_t &entry = (*directory)[i];
+        const quint64 value = reader.read();
+        if ((value == 0) && (i > 0)) {
+            const DirectoryEntry_t &previous = directory->at(i - 1);
+            entry.offset = previous.offset + previous.length;
+        } else {
+            entry.offset = value - 1;
+        }
+    }
+
+    if (reader.failed()) {
+        return nullptr;
+    }
+
+    return directory;
+}
+
+std::shared_ptr<const QGCTileArchive::Directory> QGCTileArchive::_leafDirectory(quint64 offset, quint64 length) const
+{
+    QMutexLocker locker(&_leafDirectoriesMutex);
+    if (const std::shared_ptr<const Directory> *const cached = _leafDirectories.object(offset)) {
+        return *cached;
+    }
+    locker.unlock();
+
+    // Decoded unlocked, a leaf wanted by two readers at once is decoded twice
+    std::shared_ptr<const Directory> directory;
+    if (_fits(offset, length, _leafDirectoriesLength)) {
+        directory = _decodeDirectory(_leafDirectoriesOffset + offset, length);
+    }
+    if (!directory) {
+        qCWarning(QGCTileArchiveLog) << _fileName << "invalid leaf directory at" << offset;
+        return nullptr;
+    }
+
+    locker.relock();
+    (void) _leafDirectories.insert(offset, new std::shared_ptr<const Directory>(directory), qMax<qsizetype>(1, directory->size()));
+    return directory;
+}
+
+QByteArray QGCTileArchive::_pmtilesTile(int x, int y, int zoom) const
+{
+    const quint64 tileId = pmtilesTileId(x, y, zoom);
+
+    std::shared_ptr<const Directory> directory = _rootDirectory;
+    for (int depth = 0; directory && (depth < kMaxDirectoryDepth); depth++) {
+        // Last entry starting at or before the tile
+        const auto it = std::upper_bound(directory->cbegin(), directory->cend(), tileId,
+                                         [](quint64 id, const DirectoryEntry_t &entry) { return (id < entry.tileId); });
+        if (it == directory->cbegin()) {
+            return QByteArray();
+        }
+
+        const DirectoryEntry_t entry = *std::prev(it);
+        if (entry.runLength == 0) {
+            directory = _leafDirectory(entry.offset, entry.length);
+            continue;
+        }
+
+        if ((tileId - entry.tileId) >= entry.runLength) {
+            return QByteArray();
+        }
+        if (!_fits(entry.offset, entry.length, _tileDataLength)) {
+            qCWarning(QGCTileArchiveLog) << _fileName << "tile" << tileId << "lies outside the tile data";
+            return QByteArray();
+        }
+
+        const QByteArray data(reinterpret_cast<const char*>(_data + _tileDataOffset + entry.offset), entry.length);
+        return _decompress(data, _tileCompression);
+    }
+
+    return QByteArray();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCache>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+#include <memory>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileArchiveLog)
+
+class QThread;
+
+/// Read-only raster tile archive in the MBTiles or PMTiles (version 3) format, served in place: tiles are never
+/// copied into the tile cache database.
+/// PMTiles files are memory mapped. The root directory is decoded on open, leaf directories on first use and
+/// kept in a bounded cache, tile data is copied straight out of the mapping.
+/// MBTiles files are SQLite databases opened read-only with memory mapped I/O. QtSql connections can not be
+/// shared between threads, so each reading thread gets its own connection and must call
+/// releaseThreadConnection() before it ends. close() and the destructor only remove the connection of the
+/// calling thread, the archive must not be closed while another thread still has one.
+/// Thread safe after open().
+class QGCTileArchive
+{
+public:
+    enum class Format {
+        Invalid,
+        MBTiles,
+        PMTiles
+    };
+
+    QGCTileArchive();
+    ~QGCTileArchive();
+
+    QGCTileArchive(const QGCTileArchive&) = delete;
+    QGCTileArchive &operator=(const QGCTileArchive&) = delete;
+
+    /// Opens the archive and reads its header or metadata, the format is taken from the file extension.
+    /// Only PNG, JPEG and WebP tiles are accepted, vector tile archives fail to open.
+    ///     @return false on failure, see errorString()
+    bool open(const QString &fileName);
+    void close();
+
+    bool isValid() const { return (_format != Format::Invalid); }
+    Format format() const { return _format; }
+    QString fileName() const { return _fileName; }
+    QString errorString() const { return _errorString; }
+    /// Image format of the tiles as used by the tile cache: png, jpg or webp
+    QString tileFormat() const { return _tileFormat; }
+    int minZoom() const { return _minZoom; }
+    int maxZoom() const { return _maxZoom; }
+
+    /// @return Image of the tile in XYZ numbering (y grows southwards), empty if the archive does not hold it
+    QByteArray tile(int x, int y, int zoom) const;
+
+    /// Closes the MBTiles connection of the calling thread
+    void releaseThreadConnection() const;
+    /// @return True if any thread still has an MBTiles connection open
+    bool hasThreadConnections() const;
+
+    static bool isSupportedFile(const QString &fileName);
+
+    /// @return Position of the tile on the PMTiles Hilbert curve, counted over all lower zoom levels first
+    static quint64 pmtilesTileId(int x, int y, int zoom);
+
+    static constexpr int kMaxZoom = 26;
+
+private:
+    struct DirectoryEntry_t {
+        quint64 tileId = 0;
+        quint64 offset = 0;         ///< From the start of the tile data, or of the leaf directories if runLength is 0
+        quint32 length = 0;
+        quint32 runLength = 0;      ///< Consecutive tile ids sharing this tile data, 0 for a leaf directory
+    };
+    using Directory = QList<DirectoryEntry_t>;
+
+    bool _openMBTiles();
+    bool _openPMTiles();
+    bool _setError(const QString &errorString);
+
+    QByteArray _mbtilesTile(int x, int y, int zoom) const;
+    QString _threadConnection() const;
+    void _removeConnections();
+
+    QByteArray _pmtilesTile(int x, int y, int zoom) const;
+    std::shared_ptr<const Directory> _decodeDirectory(quint64 offset, quint64 length) const;
+    std::shared_ptr<const Directory> _leafDirectory(quint64 offset, quint64 length) const;
+
+    QString _fileName;
+    QString _errorString;
+    QString _tileFormat;
+    Format _format = Format::Invalid;
+    int _minZoom = 0;
+    int _maxZoom = 0;
+
+    // PMTiles
+    QFile _file;
+    uchar *_data = nullptr;
+    qint64 _size = 0;
+    quint64 _leafDirectoriesOffset = 0;
+    quint64 _leafDirectoriesLength = 0;
+    quint64 _tileDataOffset = 0;
+    quint64 _tileDataLength = 0;
+    quint8 _internalCompression = 0;
+    quint8 _tileCompression = 0;
+    std::shared_ptr<const Directory> _rootDirectory;
+    mutable QMutex _leafDirectoriesMutex;
+    mutable QCache<quint64, std::shared_ptr<const Directory>> _leafDirectories;  ///< By offset, cost is the entry count
+
+    // MBTiles
+    mutable QMutex _connectionsMutex;
+    mutable QHash<const QThread*, QString> _connections;
+
+    static constexpr int kMaxDirectoryDepth = 4;
+    static constexpr qsizetype kMaxCachedDirectoryEntries = 256 * 1024;
+};
@@ -0,0 +1,144 @@
+#include "QGCTileArchiveSet.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+
+#include "QGCCacheTile.h"
+#include "QGCMapUrlEngine.h"
+#include "QGCTileArchive.h"
+#include "QGCTileMemoryCache.h"
+
+QGCTileArchiveSet::QGCTileArchiveSet(int mapId)
+    : _mapId(mapId)
+    , _mapType(UrlFactory::getProviderTypeFromQtMapId(mapId))
+    , _archives(std::make_shared<const Archives>())
+{
+}
+
+QGCTileArchiveSet::~QGCTileArchiveSet()
+{
+}
+
+int QGCTileArchiveSet::load(const QString &directory)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto archives = std::make_shared<Archives>();
+    if (!directory.isEmpty()) {
+        const QDir dir(directory);
+        const QStringList fileNames = dir.entryList(QDir::Files | QDir::Readable, QDir::Name);
+        for (const QString &fileName : fileNames) {
+            if (!QGCTileArchive::isSupportedFile(fileName)) {
+                continue;
+            }
+
+            auto archive = std::make_shared<QGCTileArchive>();
+            if (!archive->open(dir.filePath(fileName))) {
+                qCWarning(QGCTileArchiveLog) << "Skipping" << fileName << archive->errorString();
+                continue;
+            }
+            // Connection of the loading thread, reading threads open their own
+            archive->releaseThreadConnection();
+            archives->append(std::move(archive));
+        }
+    }
+
+    qCDebug(QGCTileArchiveLog) << directory << "archives" << archives->size() << "loaded in" << timer.elapsed() << "ms";
+
+    const int count = static_cast<int>(archives->size());
+    QMutexLocker locker(&_mutex);
+    _replace(std::move(archives));
+    return count;
+}
+
+void QGCTileArchiveSet::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _replace(std::make_shared<const Archives>());
+}
+
+void QGCTileArchiveSet::_replace(std::shared_ptr<const Archives> archives)
+{
+    _retired.append(*_archives);
+    _archives = std::move(archives);
+}
+
+void QGCTileArchiveSet::_releaseRetiredConnections() const
+{
+    QMutexLocker locker(&_mutex);
+    for (auto it = _retired.begin(); it != _retired.end();) {
+        (*it)->releaseThreadConnection();
+
+        // Fetches only take archives from _archives, so once the list here holds the last reference and no thread
+        // has a connection left, nothing can open one again and the archive is destroyed in this thread
+        if (((*it).use_count() == 1) && !(*it)->hasThreadConnections()) {
+            it = _retired.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+qsizetype QGCTileArchiveSet::retiredCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _retired.size();
+}
+
+std::shared_ptr<const QGCTileArchiveSet::Archives> QGCTileArchiveSet::_snapshot() const
+{
+    QMutexLocker locker(&_mutex);
+    return _archives;
+}
+
+qsizetype QGCTileArchiveSet::count() const
+{
+    return _snapshot()->size();
+}
+
+QStringList QGCTileArchiveSet::fileNames() const
+{
+    const std::shared_ptr<const Archives> archives = _snapshot();
+    QStringList fileNames;
+    for (const std::shared_ptr<const QGCTileArchive> &archive : *archives) {
+        fileNames.append(archive->fileName());
+    }
+    return fileNames;
+}
+
+bool QGCTileArchiveSet::isArchiveTile(quint64 key) const
+{
+    return ((key != QGCTileMemoryCache::kInvalidKey) && (QGCTileMemoryCache::keyMapId(key) == _mapId));
+}
+
+std::unique_ptr<QGCCacheTile> QGCTileArchiveSet::getTile(quint64 key, const QString &hash) const
+{
+    if (!isArchiveTile(key)) {
+        return nullptr;
+    }
+
+    const int x = QGCTileMemoryCache::keyX(key);
+    const int y = QGCTileMemoryCache::keyY(key);
+    const int zoom = QGCTileMemoryCache::keyZoom(key);
+    _releaseRetiredConnections();
+    const std::shared_ptr<const Archives> archives = _snapshot();
+    for (const std::shared_ptr<const QGCTileArchive> &archive : *archives) {
+        const QByteArray image = archive->tile(x, y, zoom);
+        if (!image.isEmpty()) {
+            return std::make_unique<QGCCacheTile>(hash, image, archive->tileFormat(), _mapType);
+        }
+    }
+
+    return nullptr;
+}
+
+void QGCTileArchiveSet::releaseThreadConnections() const
+{
+    _releaseRetiredConnections();
+
+    const std::shared_ptr<const Archives> archives = _snapshot();
+    for (const std::shared_ptr<const QGCTileArchive> &archive : *archives) {
+        archive->releaseThreadConnection();
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <memory>
+
+class QGCTileArchive;
+struct QGCCacheTile;
+
+/// The MBTiles and PMTiles archives of a directory, served as the tiles of one map type next to the tile cache
+/// database. Where archives overlap, the first in file name order which holds the tile wins.
+/// load() swaps the whole archive list, fetches running at that time finish on the previous one. Replaced archives
+/// are retired rather than closed: each reading thread removes its own MBTiles connection on its next fetch or when
+/// it ends, and an archive is only destroyed once no thread has a connection and no fetch still uses it. Thread safe.
+class QGCTileArchiveSet
+{
+public:
+    /// @param mapId Map id of the map type served from the archives
+    explicit QGCTileArchiveSet(int mapId);
+    ~QGCTileArchiveSet();
+
+    QGCTileArchiveSet(const QGCTileArchiveSet&) = delete;
+    QGCTileArchiveSet &operator=(const QGCTileArchiveSet&) = delete;
+
+    /// Replaces the archives with those in @a directory, files which fail to open are skipped
+    ///     @return Number of archives loaded
+    int load(const QString &directory);
+    void clear();
+
+    int mapId() const { return _mapId; }
+    qsizetype count() const;
+    QStringList fileNames() const;
+
+    /// @param key QGCTileMemoryCache key of the tile
+    /// @return True if the tile is of the map type served from the archives
+    bool isArchiveTile(quint64 key) const;
+
+    /// @return The tile, nullptr if no archive holds it
+    std::unique_ptr<QGCCacheTile> getTile(quint64 key, const QString &hash) const;
+
+    /// Closes the MBTiles connections of the calling thread, of the current and the retired archives,
+    /// see QGCTileArchive::releaseThreadConnection()
+    void releaseThreadConnections() const;
+
+    /// Number of replaced archives not yet destroyed
+    qsizetype retiredCount() const;
+
+private:
+    using Archives = QList<std::shared_ptr<const QGCTileArchive>>;
+
+    std::shared_ptr<const Archives> _snapshot() const;
+    /// Moves the current archives to the retired ones and installs @a archives, the caller holds _mutex
+    void _replace(std::shared_ptr<const Archives> archives);
+    /// Closes the calling thread's connections to retired archives and destroys the archives nobody uses anymore
+    void _releaseRetiredConnections() const;
+
+    const int _mapId;
+    const QString _mapType;
+    mutable QMutex _mutex;
+    std::shared_ptr<const Archives> _archives;
+    mutable Archives _retired;              ///< Replaced archives which a thread may still have a connection to
+};
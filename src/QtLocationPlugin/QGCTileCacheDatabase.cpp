@@ -5,6 +5,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QSettings>
+#include <QtCore/QStringList>
 #include <QtCore/QUuid>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlError>
@@ -33,6 +34,17 @@ class TransactionGuard {
     bool _active = false;
 };
 
+class DetachGuard {
+public:
+    DetachGuard(QSqlDatabase db, const QString &schema) : _db(std::move(db)), _schema(schema) {}
+    ~DetachGuard() { QSqlQuery query(_db); (void) query.exec(QStringLiteral("DETACH DATABASE %1").arg(_schema)); }
+    DetachGuard(const DetachGuard &) = delete;
+    DetachGuard &operator=(const DetachGuard &) = delete;
+private:
+    QSqlDatabase _db;
+    QString _schema;
+};
+
 static std::atomic<int> s_exportSessionCounter{0};
 
 struct ScopedExportDB {
@@ -158,7 +170,7 @@ bool QGCTileCacheDatabase::init()
     return !_failed;
 }
 
-bool QGCTileCacheDatabase::connectDB()
+bool QGCTileCacheDatabase::connectDB(bool readOnly)
 {
     if (_connected) {
         disconnectDB();
@@ -166,8 +178,14 @@ bool QGCTileCacheDatabase::connectDB()
 
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", _connectionName);
     db.setDatabaseName(_databasePath);
+    if (readOnly) {
+        db.setConnectOptions(QStringLiteral("QSQLITE_OPEN_READONLY"));
+    }
     _valid = db.open();
-    if (_valid) {
+    if (_valid && readOnly) {
+        // The journal mode is persistent, the writer already switched the file to WAL
+        _connected = true;
+    } else if (_valid) {
         QSqlQuery pragma(db);
         if (!pragma.exec("PRAGMA journal_mode=WAL")) {
             qCWarning(QGCTileCacheWorkerLog) << "Failed to set WAL journal mode:" << pragma.lastError().text();
@@ -267,6 +285,94 @@ bool QGCTileCacheDatabase::saveTile(const QString &hash, const QString &format,
     return true;
 }
 
+bool QGCTileCacheDatabase::saveTiles(const QList<QGCCacheTile*> &tiles, bool completeDownloads)
+{
+    if (tiles.isEmpty()) {
+        return true;
+    }
+    if (!_ensureConnected()) {
+        return false;
+    }
+
+    TransactionGuard txn(_database());
+    if (!txn.begin()) {
+        qCWarning(QGCTileCacheWorkerLog) << "Failed to start transaction for saveTiles";
+        return false;
+    }
+
+    QSqlQuery insertTile(_database());
+    QSqlQuery lookupTile(_database());
+    QSqlQuery insertSetTile(_database());
+    QSqlQuery completeDownload(_database());
+    if (!insertTile.prepare("INSERT OR IGNORE INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)") ||
+            !lookupTile.prepare("SELECT tileID FROM Tiles WHERE hash = ?") ||
+            !insertSetTile.prepare("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(?, ?)") ||
+            (completeDownloads && !completeDownload.prepare("DELETE FROM TilesDownload WHERE setID = ? AND hash = ?"))) {
+        qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (prepare saveTiles):" << _database().lastError().text();
+        return false;
+    }
+    lookupTile.setForwardOnly(true);
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    quint64 defaultSet = kInvalidTileSet;
+    for (const QGCCacheTile *tile : tiles) {
+        insertTile.bindValue(0, tile->hash);
+        insertTile.bindValue(1, tile->format);
+        insertTile.bindValue(2, tile->img);
+        insertTile.bindValue(3, tile->img.size());
+        insertTile.bindValue(4, UrlFactory::getQtMapIdFromProviderType(tile->type));
+        insertTile.bindValue(5, now);
+        if (!insertTile.exec()) {
+            qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (saveTiles INSERT):" << insertTile.lastError().text();
+            return false;
+        }
+
+        lookupTile.bindValue(0, tile->hash);
+        if (!lookupTile.exec() || !lookupTile.next()) {
+            qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (tile lookup):" << lookupTile.lastError().text();
+            return false;
+        }
+        const quint64 tileID = lookupTile.value(0).toULongLong();
+        lookupTile.finish();
+
+        quint64 setID = tile->tileSet;
+        if (setID == kInvalidTileSet) {
+            if (defaultSet == kInvalidTileSet) {
+                defaultSet = _getDefaultTileSet();
+            }
+            setID = defaultSet;
+        }
+        if (setID == kInvalidTileSet) {
+            qCWarning(QGCTileCacheWorkerLog) << "Cannot save tile: no valid tile set";
+            return false;
+        }
+
+        insertSetTile.bindValue(0, tileID);
+        insertSetTile.bindValue(1, setID);
+        if (!insertSetTile.exec()) {
+            qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (add tile into SetTiles):" << insertSetTile.lastError().text();
+            return false;
+        }
+
+        if (completeDownloads) {
+            completeDownload.bindValue(0, setID);
+            completeDownload.bindValue(1, tile->hash);
+            if (!completeDownload.exec()) {
+                qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (complete download):" << completeDownload.lastError().text();
+                return false;
+            }
+        }
+    }
+
+    if (!txn.commit()) {
+        qCWarning(QGCTileCacheWorkerLog) << "Failed to commit saveTiles transaction";
+        return false;
+    }
+
+    qCDebug(QGCTileCacheWorkerLog) << "saved tiles" << tiles.size();
+    return true;
+}
+
 std::unique_ptr<QGCCacheTile> QGCTileCacheDatabase::getTile(const QString &hash)
 {
     if (!_ensureConnected()) {
@@ -1244,6 +1350,165 @@ DatabaseResult QGCTileCacheDatabase::exportSets(const QList<TileSetRecord> &sets
     return result;
 }
 
+DatabaseResult QGCTileCacheDatabase::exportMBTiles(const QList<TileSetRecord> &sets, const QString &path, ProgressCallback progressCb)
+{
+    DatabaseResult result;
+    if (!_ensureConnected()) {
+        result.errorString = "Database not connected";
+        return result;
+    }
+    if (QFileInfo(path).canonicalFilePath() == QFileInfo(_databasePath).canonicalFilePath()) {
+        result.errorString = "Export path must differ from the active database";
+        return result;
+    }
+    if (sets.isEmpty()) {
+        result.errorString = "No tile sets to export";
+        return result;
+    }
+
+    // An MBTiles file holds a single tile pyramid: one map type and no elevation data
+    const int mapId = sets.constFirst().type;
+    for (const TileSetRecord &set : sets) {
+        if (set.defaultSet || (set.type <= 0)) {
+            result.errorString = "The default tile set can not be exported as MBTiles";
+            return result;
+        }
+        if (set.type != mapId) {
+            result.errorString = "Tile sets exported as MBTiles must all be of the same map type";
+            return result;
+        }
+    }
+    if (UrlFactory::isElevation(mapId)) {
+        result.errorString = "Elevation tile sets can not be exported as MBTiles";
+        return result;
+    }
+
+    (void) QFile::remove(path);
+
+    QSqlDatabase db = _database();
+    {
+        QSqlQuery attach(db);
+        (void) attach.prepare("ATTACH DATABASE ? AS mbtiles");
+        attach.addBindValue(path);
+        if (!attach.exec()) {
+            qCCritical(QGCTileCacheWorkerLog) << "Map Cache SQL error (attach MBTiles database):" << attach.lastError().text();
+            result.errorString = "Error creating MBTiles database";
+            return result;
+        }
+    }
+    // Declared before the transaction and the queries, the database can only be detached once they are done
+    const DetachGuard detachGuard(db, QStringLiteral("mbtiles"));
+
+    TransactionGuard txn(db);
+    if (!txn.begin()) {
+        result.errorString = "Failed to start export transaction";
+        return result;
+    }
+
+    QSqlQuery query(db);
+
+    if (!query.exec("CREATE TABLE mbtiles.metadata (name TEXT, value TEXT)") ||
+        !query.exec("CREATE TABLE mbtiles.tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)") ||
+        !query.exec("CREATE UNIQUE INDEX mbtiles.tile_index ON tiles (zoom_level, tile_column, tile_row)")) {
+        qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (create MBTiles tables):" << query.lastError().text();
+        result.errorString = "Error creating MBTiles database";
+        return result;
+    }
+
+    // Tiles are copied by SQLite itself, the x/y/zoom come out of the tile hash and the row is flipped to TMS
+    if (!query.prepare(
+        "INSERT OR IGNORE INTO mbtiles.tiles (zoom_level, tile_column, tile_row, tile_data) "
+        "SELECT CAST(substr(T.hash, 27, 3) AS INTEGER), "
+        "CAST(substr(T.hash, 11, 8) AS INTEGER), "
+        "((1 << CAST(substr(T.hash, 27, 3) AS INTEGER)) - 1) - CAST(substr(T.hash, 19, 8) AS INTEGER), "
+        "T.tile "
+        "FROM Tiles T INNER JOIN SetTiles S ON T.tileID = S.tileID "
+        "WHERE S.setID = ? AND T.type = ? AND length(T.hash) = 29 AND T.tile IS NOT NULL")) {
+        qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (prepare MBTiles copy):" << query.lastError().text();
+        result.errorString = "Error preparing MBTiles export";
+        return result;
+    }
+
+    QStringList names;
+    double west = 180.;
+    double south = 90.;
+    double east = -180.;
+    double north = -90.;
+    int lastProgress = -1;
+    for (qsizetype i = 0; i < sets.size(); i++) {
+        const TileSetRecord &set = sets.at(i);
+        query.addBindValue(set.setID);
+        query.addBindValue(mapId);
+        if (!query.exec()) {
+            qCWarning(QGCTileCacheWorkerLog) << "Failed to export set" << set.name << query.lastError().text();
+            result.errorString = "Error exporting tiles";
+            return result;
+        }
+
+        names.append(set.name);
+        west = qMin(west, set.topleftLon);
+        east = qMax(east, set.bottomRightLon);
+        north = qMax(north, set.topleftLat);
+        south = qMin(south, set.bottomRightLat);
+
+        if (progressCb) {
+            const int progress = static_cast<int>(((i + 1) * 100) / sets.size());
+            if (lastProgress != progress) {
+                lastProgress = progress;
+                progressCb(progress);
+            }
+        }
+    }
+
+    QString format = QStringLiteral("png");
+    QSqlQuery formatQuery(db);
+    if (formatQuery.prepare("SELECT format FROM Tiles T INNER JOIN SetTiles S ON T.tileID = S.tileID WHERE S.setID = ? LIMIT 1")) {
+        formatQuery.addBindValue(sets.constFirst().setID);
+        if (formatQuery.exec() && formatQuery.next()) {
+            format = formatQuery.value(0).toString();
+        }
+    }
+
+    int minZoom = 0;
+    int maxZoom = 0;
+    QSqlQuery zoomQuery(db);
+    if (zoomQuery.exec("SELECT MIN(zoom_level), MAX(zoom_level) FROM mbtiles.tiles") && zoomQuery.next()) {
+        minZoom = zoomQuery.value(0).toInt();
+        maxZoom = zoomQuery.value(1).toInt();
+    }
+
+    const QList<std::pair<QString, QString>> metadata = {
+        { QStringLiteral("name"), names.join(QStringLiteral(", ")) },
+        { QStringLiteral("format"), format },
+        { QStringLiteral("bounds"), QStringLiteral("%1,%2,%3,%4").arg(west, 0, 'f', 6).arg(south, 0, 'f', 6).arg(east, 0, 'f', 6).arg(north, 0, 'f', 6) },
+        { QStringLiteral("minzoom"), QString::number(minZoom) },
+        { QStringLiteral("maxzoom"), QString::number(maxZoom) },
+        { QStringLiteral("type"), QStringLiteral("baselayer") },
+        { QStringLiteral("version"), QStringLiteral("1.1") },
+    };
+    if (!query.prepare("INSERT INTO mbtiles.metadata (name, value) VALUES (?, ?)")) {
+        result.errorString = "Error preparing MBTiles metadata";
+        return result;
+    }
+    for (const auto &[name, value] : metadata) {
+        query.addBindValue(name);
+        query.addBindValue(value);
+        if (!query.exec()) {
+            qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (MBTiles metadata):" << query.lastError().text();
+            result.errorString = "Error writing MBTiles metadata";
+            return result;
+        }
+    }
+
+    if (!txn.commit()) {
+        result.errorString = "Failed to commit MBTiles export";
+        return result;
+    }
+
+    result.success = true;
+    return result;
+}
+
 bool QGCTileCacheDatabase::_createDB(QSqlDatabase db, bool createDefault)
 {
     QSqlQuery query(db);
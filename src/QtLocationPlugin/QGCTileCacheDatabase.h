@@ -22,7 +22,9 @@ class QGCTileCacheDatabase
     ~QGCTileCacheDatabase();
 
     bool init();
-    bool connectDB();
+    /// @param readOnly Open a read-only connection, for readers next to the writing connection. The database
+    ///                 must already exist; it is in WAL mode so readers do not block on the writer.
+    bool connectDB(bool readOnly = false);
     void disconnectDB();
 
     bool isValid() const { return _valid; }
@@ -30,6 +32,10 @@ class QGCTileCacheDatabase
 
     // Tiles
     bool saveTile(const QString &hash, const QString &format, const QByteArray &img, const QString &type, quint64 tileSet);
+    /// Saves @a tiles in one transaction, with each statement prepared once for the whole batch.
+    ///     @param completeDownloads Also removes each tile from the download list of its tile set
+    ///     @return false if the batch failed, nothing of it is saved then
+    bool saveTiles(const QList<QGCCacheTile*> &tiles, bool completeDownloads);
     std::unique_ptr<QGCCacheTile> getTile(const QString &hash);
     std::optional<quint64> findTile(const QString &hash);
 
@@ -61,6 +67,9 @@ class QGCTileCacheDatabase
     DatabaseResult importSetsReplace(const QString &path, ProgressCallback progressCb);
     DatabaseResult importSetsMerge(const QString &path, ProgressCallback progressCb);
     DatabaseResult exportSets(const QList<TileSetRecord> &sets, const QString &path, ProgressCallback progressCb);
+    /// Writes the tiles of @a sets to a new MBTiles file in one statement per set, without reading them into
+    /// this process. All sets must be of the same, non elevation, map type.
+    DatabaseResult exportMBTiles(const QList<TileSetRecord> &sets, const QString &path, ProgressCallback progressCb);
 
     // Exposed for unit tests only
     QSqlDatabase database() const;
@@ -0,0 +1,216 @@
+#include "QGCTileCacheReaderPool.h"
+#include "QGCTileArchiveSet.h"
+#include "QGCTileCacheDatabase.h"
+#include "QGCTileMemoryCache.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QThread>
+
+#include <utility>
+
+#include "QGCCacheTile.h"
+#include "QGCMapTasks.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheWorkerLog)
+
+QGCTileCacheReaderPool::QGCTileCacheReaderPool(const QString &databasePath, int readerCount, QGCTileMemoryCache *memoryCache,
+                                               const QGCTileArchiveSet *archives, TaskFinished taskFinished)
+    : _databasePath(databasePath)
+    , _readerCount(readerCount)
+    , _memoryCache(memoryCache)
+    , _archives(archives)
+    , _taskFinished(std::move(taskFinished))
+{
+}
+
+QGCTileCacheReaderPool::~QGCTileCacheReaderPool()
+{
+    stop();
+}
+
+void QGCTileCacheReaderPool::start()
+{
+    if (!_threads.isEmpty()) {
+        return;
+    }
+
+    _stopRequested = false;
+    for (int i = 0; i < _readerCount; i++) {
+        QThread *const thread = QThread::create([this] { _runReader(); });
+        thread->setObjectName(QStringLiteral("QGCTileCacheReader%1").arg(i));
+        thread->start(QThread::NormalPriority);
+        _threads.append(thread);
+    }
+
+    qCDebug(QGCTileCacheWorkerLog) << "tile cache readers started" << _readerCount;
+}
+
+void QGCTileCacheReaderPool::stop()
+{
+    QMutexLocker lock(&_mutex);
+    _stopRequested = true;
+    const QQueue<QGCFetchTileTask*> orphans = std::exchange(_queue, {});
+    _wakeReaders.wakeAll();
+    _readerStateChanged.wakeAll();
+    lock.unlock();
+
+    for (QThread *thread : std::as_const(_threads)) {
+        (void) thread->wait();
+        delete thread;
+    }
+    _threads.clear();
+
+    for (QGCFetchTileTask *orphan : orphans) {
+        orphan->setError(QStringLiteral("Worker shutting down"));
+        orphan->deleteLater();
+    }
+}
+
+void QGCTileCacheReaderPool::enqueue(QGCFetchTileTask *task)
+{
+    QMutexLocker lock(&_mutex);
+    _queue.enqueue(task);
+    _wakeReaders.wakeOne();
+}
+
+qsizetype QGCTileCacheReaderPool::queueDepth() const
+{
+    QMutexLocker lock(&_mutex);
+    return _queue.count();
+}
+
+void QGCTileCacheReaderPool::suspend()
+{
+    QMutexLocker lock(&_mutex);
+    while (!_stopRequested && (!_queue.isEmpty() || (_busyReaders > 0))) {
+        (void) _readerStateChanged.wait(&_mutex);
+    }
+
+    _suspended = true;
+    _wakeReaders.wakeAll();
+    while (!_stopRequested && (_closedReaders < _threads.size())) {
+        (void) _readerStateChanged.wait(&_mutex);
+    }
+}
+
+void QGCTileCacheReaderPool::resume()
+{
+    QMutexLocker lock(&_mutex);
+    _suspended = false;
+    _wakeReaders.wakeAll();
+}
+
+void QGCTileCacheReaderPool::_runReader()
+{
+    QGCTileCacheDatabase database(_databasePath);
+    bool connected = false;
+
+    QMutexLocker lock(&_mutex);
+    while (!_stopRequested) {
+        if (_suspended) {
+            if (connected) {
+                lock.unlock();
+                database.disconnectDB();
+                lock.relock();
+                connected = false;
+            }
+            _closedReaders++;
+            _readerStateChanged.wakeAll();
+            while (_suspended && !_stopRequested) {
+                (void) _wakeReaders.wait(&_mutex);
+            }
+            _closedReaders--;
+            continue;
+        }
+
+        if (_queue.isEmpty()) {
+            (void) _wakeReaders.wait(&_mutex);
+            continue;
+        }
+
+        QGCFetchTileTask *const task = _queue.dequeue();
+        _busyReaders++;
+        lock.unlock();
+
+        const qint64 waitUSecs = task->queuedUSecs();
+        QElapsedTimer runTimer;
+        runTimer.start();
+
+        if (!_serveFromArchives(task) && !_serveFromMemory(task)) {
+            // Connected lazily and again after a suspension, a failed connection is retried with the next fetch
+            if (!connected) {
+                connected = database.connectDB(true);
+            }
+            if (connected) {
+                _fetchTile(database, task);
+            } else {
+                task->setError(QStringLiteral("No Cache Database"));
+            }
+        }
+
+        if (_taskFinished) {
+            _taskFinished(task, waitUSecs, runTimer.nsecsElapsed() / 1000);
+        }
+        task->deleteLater();
+
+        lock.relock();
+        _busyReaders--;
+        _readerStateChanged.wakeAll();
+    }
+    lock.unlock();
+
+    database.disconnectDB();
+    if (_archives) {
+        _archives->releaseThreadConnections();
+    }
+}
+
+bool QGCTileCacheReaderPool::_serveFromArchives(QGCFetchTileTask *task)
+{
+    if (!_archives) {
+        return false;
+    }
+
+    const quint64 key = QGCTileMemoryCache::keyFromHash(task->hash());
+    if (!_archives->isArchiveTile(key)) {
+        return false;
+    }
+
+    auto tile = _archives->getTile(key, task->hash());
+    if (tile) {
+        task->setTileFetched(tile.release());
+    } else {
+        task->setError("Tile not in archives");
+    }
+    return true;
+}
+
+bool QGCTileCacheReaderPool::_serveFromMemory(QGCFetchTileTask *task)
+{
+    if (!_memoryCache) {
+        return false;
+    }
+
+    auto tile = _memoryCache->find(QGCTileMemoryCache::keyFromHash(task->hash()), task->hash());
+    if (!tile) {
+        return false;
+    }
+
+    task->setTileFetched(tile.release());
+    return true;
+}
+
+void QGCTileCacheReaderPool::_fetchTile(QGCTileCacheDatabase &database, QGCFetchTileTask *task)
+{
+    const quint64 generation = _memoryCache ? _memoryCache->generation() : 0;
+    auto tile = database.getTile(task->hash());
+    if (tile) {
+        if (_memoryCache) {
+            _memoryCache->insert(QGCTileMemoryCache::keyFromHash(task->hash()), *tile, generation);
+        }
+        task->setTileFetched(tile.release());
+    } else {
+        task->setError("Tile not in cache database");
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QQueue>
+#include <QtCore/QString>
+#include <QtCore/QWaitCondition>
+
+#include <functional>
+
+class QGCFetchTileTask;
+class QGCMapTask;
+class QGCTileArchiveSet;
+class QGCTileCacheDatabase;
+class QGCTileMemoryCache;
+class QThread;
+
+/// Read-only connections to the tile cache database which serve map tile fetches next to the cache worker.
+/// The database is in WAL mode, so a reader sees the last committed state without waiting for the writer.
+/// Each reader thread owns one connection and takes fetches from a shared queue. Tiles found in the
+/// QGCTileMemoryCache are served without touching the database, tiles read from the database are added to it.
+/// Fetches of the map type served from tile archives go to the QGCTileArchiveSet instead of the database.
+class QGCTileCacheReaderPool
+{
+public:
+    /// Called on the reader thread once a fetch has run
+    using TaskFinished = std::function<void(const QGCMapTask *task, qint64 waitUSecs, qint64 runUSecs)>;
+
+    /// @param memoryCache Shared with the cache worker, may be nullptr
+    /// @param archives Shared with the cache worker, may be nullptr
+    QGCTileCacheReaderPool(const QString &databasePath, int readerCount, QGCTileMemoryCache *memoryCache,
+                           const QGCTileArchiveSet *archives, TaskFinished taskFinished);
+    ~QGCTileCacheReaderPool();
+
+    QGCTileCacheReaderPool(const QGCTileCacheReaderPool&) = delete;
+    QGCTileCacheReaderPool &operator=(const QGCTileCacheReaderPool&) = delete;
+
+    void start();
+    /// Joins the readers, queued fetches fail
+    void stop();
+
+    void enqueue(QGCFetchTileTask *task);
+    qsizetype queueDepth() const;
+    int readerCount() const { return _readerCount; }
+
+    /// Runs the queued fetches, then blocks until every reader has closed its connection.
+    /// Used around writer tasks which replace the database file or drop its tables.
+    void suspend();
+    void resume();
+
+private:
+    void _runReader();
+    bool _serveFromArchives(QGCFetchTileTask *task);
+    bool _serveFromMemory(QGCFetchTileTask *task);
+    void _fetchTile(QGCTileCacheDatabase &database, QGCFetchTileTask *task);
+
+    const QString _databasePath;
+    const int _readerCount;
+    QGCTileMemoryCache *const _memoryCache;
+    const QGCTileArchiveSet *const _archives;
+    const TaskFinished _taskFinished;
+    QList<QThread*> _threads;
+
+    mutable QMutex _mutex;
+    QWaitCondition _wakeReaders;
+    QWaitCondition _readerStateChanged;
+    QQueue<QGCFetchTileTask*> _queue;
+    int _busyReaders = 0;
+    int _closedReaders = 0;
+    bool _suspended = false;
+    bool _stopRequested = false;
+};
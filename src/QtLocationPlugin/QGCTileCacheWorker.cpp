@@ -1,9 +1,12 @@
 #include "QGCTileCacheWorker.h"
+#include "QGCTileArchiveSet.h"
 #include "QGCTileCacheDatabase.h"
+#include "QGCTileCacheReaderPool.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QSettings>
 
+#include "GenericMapProvider.h"
 #include "QGCCachedTileSet.h"
 #include "QGCLoggingCategory.h"
 #include "QGCMapTasks.h"
@@ -13,6 +16,8 @@ QGC_LOGGING_CATEGORY(QGCTileCacheWorkerLog, "QtLocationPlugin.QGCTileCacheWorker
 
 QGCCacheWorker::QGCCacheWorker(QObject *parent)
     : QThread(parent)
+    , _memoryCache(std::make_unique<QGCTileMemoryCache>())
+    , _archives(std::make_unique<QGCTileArchiveSet>(UrlFactory::getQtMapIdFromProviderType(OfflineArchiveMapProvider::kProviderKey)))
 {
     qCDebug(QGCTileCacheWorkerLog) << this;
 }
@@ -33,6 +38,7 @@ void QGCCacheWorker::stop()
     QMutexLocker lock(&_taskQueueMutex);
     qDeleteAll(_taskQueue);
     _taskQueue.clear();
+    _clearPendingTasks();
     lock.unlock();
 
     if (isRunning()) {
@@ -40,6 +46,32 @@ void QGCCacheWorker::stop()
     }
 }
 
+int QGCCacheWorker::loadTileArchives(const QString &directory)
+{
+    return _archives->load(directory);
+}
+
+QStringList QGCCacheWorker::tileArchiveFileNames() const
+{
+    return _archives->fileNames();
+}
+
+QGCCacheWorker::Statistics_t QGCCacheWorker::statistics() const
+{
+    QMutexLocker lock(&_statisticsMutex);
+    Statistics_t stats = _statistics;
+    lock.unlock();
+
+    stats.memoryCache = _memoryCache->statistics();
+
+    QMutexLocker queueLock(&_taskQueueMutex);
+    if (_readers) {
+        stats.readerQueueDepth = _readers->queueDepth();
+    }
+
+    return stats;
+}
+
 bool QGCCacheWorker::enqueueTask(QGCMapTask *task)
 {
     if (!_dbValid && !isRunning() && (task->type() != QGCMapTask::TaskType::taskInit)) {
@@ -48,10 +80,25 @@ bool QGCCacheWorker::enqueueTask(QGCMapTask *task)
         return false;
     }
 
+    task->startQueuedTimer();
+
     QMutexLocker lock(&_taskQueueMutex);
+    if (_routeToReaders(task)) {
+        _readers->enqueue(static_cast<QGCFetchTileTask*>(task));
+        return true;
+    }
+
+    _trackPendingTask(task, 1);
     _taskQueue.enqueue(task);
+    const qsizetype depth = _taskQueue.count();
     lock.unlock();
 
+    {
+        QMutexLocker statisticsLock(&_statisticsMutex);
+        _statistics.writerQueueDepth = depth;
+        _statistics.maxWriterQueueDepth = qMax(_statistics.maxWriterQueueDepth, depth);
+    }
+
     if (isRunning()) {
         _waitc.wakeAll();
     } else {
@@ -87,6 +134,15 @@ void QGCCacheWorker::run()
 
     _dbValid = _database->isValid();
 
+    // Readers open the database once the writer has created it
+    if (_dbValid && (_readerCount > 0)) {
+        auto readers = std::make_unique<QGCTileCacheReaderPool>(_databasePath, _readerCount, _memoryCache.get(), _archives.get(),
+            [this](const QGCMapTask *task, qint64 waitUSecs, qint64 runUSecs) { _recordTask(task, waitUSecs, runUSecs, true); });
+        readers->start();
+        QMutexLocker lock(&_taskQueueMutex);
+        _readers = std::move(readers);
+    }
+
     // M1: Start timer before the loop — hasExpired() on an unstarted timer is UB
     _updateTimer.start();
 
@@ -95,11 +151,20 @@ void QGCCacheWorker::run()
         if (!_taskQueue.isEmpty()) {
             QGCMapTask* const task = _taskQueue.dequeue();
             lock.unlock();
+            const qint64 waitUSecs = task->queuedUSecs();
+            QElapsedTimer runTimer;
+            runTimer.start();
             _runTask(task);
+            _recordTask(task, waitUSecs, runTimer.nsecsElapsed() / 1000, false);
             lock.relock();
+            _trackPendingTask(task, -1);
             task->deleteLater();
 
             const qsizetype count = _taskQueue.count();
+            {
+                QMutexLocker statisticsLock(&_statisticsMutex);
+                _statistics.writerQueueDepth = count;
+            }
             if (count > 100) {
                 _updateTimeout = kLongTimeoutMs;
             } else if (count < 25) {
@@ -125,13 +190,19 @@ void QGCCacheWorker::run()
         orphan->deleteLater();
     }
     _taskQueue.clear();
+    _clearPendingTasks();
+    std::unique_ptr<QGCTileCacheReaderPool> readers = std::move(_readers);
     lock.unlock();
 
+    // Fails the fetches still queued for the readers
+    readers.reset();
+
     _dbValid = false;
     if (_database) {
         _database->disconnectDB();
         _database.reset();
     }
+    _archives->releaseThreadConnections();
 }
 
 void QGCCacheWorker::_runTask(QGCMapTask *task)
@@ -143,6 +214,9 @@ void QGCCacheWorker::_runTask(QGCMapTask *task)
     case QGCMapTask::TaskType::taskCacheTile:
         _saveTile(task);
         break;
+    case QGCMapTask::TaskType::taskCacheTileBatch:
+        _saveTileBatch(task);
+        break;
     case QGCMapTask::TaskType::taskFetchTile:
         _getTile(task);
         break;
@@ -182,6 +256,89 @@ void QGCCacheWorker::_runTask(QGCMapTask *task)
     }
 }
 
+bool QGCCacheWorker::_routeToReaders(const QGCMapTask *task) const
+{
+    if (!_readers || (task->type() != QGCMapTask::TaskType::taskFetchTile)) {
+        return false;
+    }
+
+    // Keep the order against queued tasks which would change the result of this fetch
+    if (_pendingTileRemovals > 0) {
+        return false;
+    }
+
+    return !_pendingSaves.contains(static_cast<const QGCFetchTileTask*>(task)->hash());
+}
+
+void QGCCacheWorker::_trackPendingTask(const QGCMapTask *task, int delta)
+{
+    switch (task->type()) {
+    case QGCMapTask::TaskType::taskCacheTile:
+        _trackPendingSave(static_cast<const QGCSaveTileTask*>(task)->tile()->hash, delta);
+        break;
+    case QGCMapTask::TaskType::taskCacheTileBatch:
+        for (const QGCCacheTile *tile : static_cast<const QGCSaveTileBatchTask*>(task)->tiles()) {
+            _trackPendingSave(tile->hash, delta);
+        }
+        break;
+    case QGCMapTask::TaskType::taskDeleteTileSet:
+    case QGCMapTask::TaskType::taskPruneCache:
+    case QGCMapTask::TaskType::taskReset:
+    case QGCMapTask::TaskType::taskImport:
+        _pendingTileRemovals = qMax(0, _pendingTileRemovals + delta);
+        break;
+    default:
+        break;
+    }
+}
+
+void QGCCacheWorker::_trackPendingSave(const QString &hash, int delta)
+{
+    const int count = _pendingSaves.value(hash) + delta;
+    if (count > 0) {
+        _pendingSaves.insert(hash, count);
+    } else {
+        (void) _pendingSaves.remove(hash);
+    }
+}
+
+void QGCCacheWorker::_clearPendingTasks()
+{
+    _pendingSaves.clear();
+    _pendingTileRemovals = 0;
+}
+
+void QGCCacheWorker::_recordTask(const QGCMapTask *task, qint64 waitUSecs, qint64 runUSecs, bool pooled)
+{
+    QMutexLocker lock(&_statisticsMutex);
+
+    TaskStatistics_t &stats = _statistics.tasks[static_cast<int>(task->type())];
+    stats.count++;
+    stats.totalWaitUSecs += waitUSecs;
+    stats.maxWaitUSecs = qMax(stats.maxWaitUSecs, waitUSecs);
+    stats.totalRunUSecs += runUSecs;
+    stats.maxRunUSecs = qMax(stats.maxRunUSecs, runUSecs);
+
+    if (pooled) {
+        _statistics.pooledFetches++;
+    }
+}
+
+void QGCCacheWorker::_suspendReaders()
+{
+    // Only this thread replaces _readers, no lock needed to read it here
+    if (_readers) {
+        _readers->suspend();
+    }
+}
+
+void QGCCacheWorker::_resumeReaders()
+{
+    if (_readers) {
+        _readers->resume();
+    }
+}
+
 bool QGCCacheWorker::_testTask(QGCMapTask *mtask)
 {
     if (!_database || !_database->isValid()) {
@@ -197,6 +354,22 @@ void QGCCacheWorker::_emitTotals()
     TotalsResult t = _database->computeTotals();
     emit updateTotals(t.totalCount, t.totalSize, t.defaultCount, t.defaultSize);
     _updateTimer.restart();
+
+    if (QGCTileCacheWorkerLog().isDebugEnabled()) {
+        const Statistics_t stats = statistics();
+        const TaskStatistics_t &fetches = stats.task(QGCMapTask::TaskType::taskFetchTile);
+        const TaskStatistics_t &saves = stats.task(QGCMapTask::TaskType::taskCacheTile);
+        const TaskStatistics_t &batches = stats.task(QGCMapTask::TaskType::taskCacheTileBatch);
+        qCDebug(QGCTileCacheWorkerLog) << "queue depth writer" << stats.writerQueueDepth << "max" << stats.maxWriterQueueDepth
+                                       << "readers" << stats.readerQueueDepth
+                                       << "fetches" << fetches.count << "pooled" << stats.pooledFetches
+                                       << "wait avg/max us" << fetches.averageWaitUSecs() << fetches.maxWaitUSecs
+                                       << "saves" << saves.count
+                                       << "wait avg/max us" << saves.averageWaitUSecs() << saves.maxWaitUSecs
+                                       << "save batches" << batches.count << "run avg us" << batches.averageRunUSecs()
+                                       << "memory hits" << stats.memoryCache.hits << "misses" << stats.memoryCache.misses
+                                       << "bytes" << stats.memoryCache.bytes;
+    }
 }
 
 // M2: Check saveTile return value
@@ -213,6 +386,20 @@ void QGCCacheWorker::_saveTile(QGCMapTask *mtask)
     }
 }
 
+void QGCCacheWorker::_saveTileBatch(QGCMapTask *mtask)
+{
+    if (!_testTask(mtask)) {
+        return;
+    }
+
+    QGCSaveTileBatchTask *task = static_cast<QGCSaveTileBatchTask*>(mtask);
+    if (!_database->saveTiles(task->tiles(), task->completeDownloads())) {
+        mtask->setError("Error saving tiles to cache");
+        return;
+    }
+    task->setTilesSaved();
+}
+
 void QGCCacheWorker::_getTile(QGCMapTask *mtask)
 {
     if (!_testTask(mtask)) {
@@ -220,8 +407,27 @@ void QGCCacheWorker::_getTile(QGCMapTask *mtask)
     }
 
     QGCFetchTileTask *task = static_cast<QGCFetchTileTask*>(mtask);
-    auto tile = _database->getTile(task->hash());
+    const quint64 key = QGCTileMemoryCache::keyFromHash(task->hash());
+    if (_archives->isArchiveTile(key)) {
+        auto tile = _archives->getTile(key, task->hash());
+        if (tile) {
+            task->setTileFetched(tile.release());
+        } else {
+            task->setError("Tile not in archives");
+        }
+        return;
+    }
+
+    auto tile = _memoryCache->find(key, task->hash());
+    if (tile) {
+        task->setTileFetched(tile.release());
+        return;
+    }
+
+    const quint64 generation = _memoryCache->generation();
+    tile = _database->getTile(task->hash());
     if (tile) {
+        _memoryCache->insert(key, *tile, generation);
         task->setTileFetched(tile.release());
     } else {
         task->setError("Tile not in cache database");
@@ -348,7 +554,9 @@ void QGCCacheWorker::_pruneCache(QGCMapTask *mtask)
     }
 
     QGCPruneCacheTask *task = static_cast<QGCPruneCacheTask*>(mtask);
-    if (!_database->pruneCache(task->amount())) {
+    const bool pruned = _database->pruneCache(task->amount());
+    _memoryCache->clear();
+    if (!pruned) {
         mtask->setError("Error pruning cache");
         return;
     }
@@ -363,7 +571,9 @@ void QGCCacheWorker::_deleteTileSet(QGCMapTask *mtask)
     }
 
     QGCDeleteTileSetTask *task = static_cast<QGCDeleteTileSetTask*>(mtask);
-    if (!_database->deleteTileSet(task->setID())) {
+    const bool deleted = _database->deleteTileSet(task->setID());
+    _memoryCache->clear();
+    if (!deleted) {
         mtask->setError("Error deleting tile set");
         return;
     }
@@ -391,7 +601,11 @@ void QGCCacheWorker::_resetCacheDatabase(QGCMapTask *mtask)
     }
 
     QGCResetTask *task = static_cast<QGCResetTask*>(mtask);
-    if (!_database->resetDatabase()) {
+    _suspendReaders();
+    const bool reset = _database->resetDatabase();
+    _memoryCache->clear();
+    _resumeReaders();
+    if (!reset) {
         mtask->setError("Error resetting cache database");
         return;
     }
@@ -409,12 +623,16 @@ void QGCCacheWorker::_importSets(QGCMapTask *mtask)
     QGCImportTileTask *task = static_cast<QGCImportTileTask*>(mtask);
     auto progress = [task](int pct) { task->setProgress(pct); };
 
+    // Replacing moves the database file, which is not possible while the readers hold it open
     DatabaseResult result;
+    _suspendReaders();
     if (task->replace()) {
         result = _database->importSetsReplace(task->path(), progress);
     } else {
         result = _database->importSetsMerge(task->path(), progress);
     }
+    _memoryCache->clear();
+    _resumeReaders();
 
     _dbValid = _database->isValid();
 
@@ -444,7 +662,9 @@ void QGCCacheWorker::_exportSets(QGCMapTask *mtask)
     QGCExportTileTask *task = static_cast<QGCExportTileTask*>(mtask);
 
     auto progress = [task](int pct) { task->setProgress(pct); };
-    DatabaseResult result = _database->exportSets(task->sets(), task->path(), progress);
+    const bool mbtiles = task->path().endsWith(QStringLiteral(".mbtiles"), Qt::CaseInsensitive);
+    DatabaseResult result = mbtiles ? _database->exportMBTiles(task->sets(), task->path(), progress)
+                                    : _database->exportSets(task->sets(), task->path(), progress);
 
     if (!result.success) {
         task->setError(result.errorString);
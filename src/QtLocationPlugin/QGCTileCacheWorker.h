@@ -1,20 +1,34 @@
 #pragma once
 
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QMutex>
 #include <QtCore/QQueue>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QThread>
 #include <QtCore/QWaitCondition>
 
+#include <array>
 #include <memory>
 
+#include "QGCMapTasks.h"
+#include "QGCTileMemoryCache.h"
+
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheWorkerLog)
 
-class QGCMapTask;
+class QGCTileArchiveSet;
 class QGCTileCacheDatabase;
+class QGCTileCacheReaderPool;
 
+/// Runs the map cache tasks against the tile cache database.
+/// This thread owns the only writing connection and runs the tasks in order. Tile fetches are passed to a
+/// QGCTileCacheReaderPool of read-only connections instead, so map panning is not stuck behind tile set
+/// downloads, pruning or import/export. A fetch stays on this thread only while it could see a different
+/// result there: a save of the same tile, or a task which removes tiles, is still queued.
+/// Tiles read by either are kept in a QGCTileMemoryCache, which later fetches of the same tile are served from.
+/// Fetches of the "Offline Archive" map type are served read-only from the QGCTileArchiveSet, never the database.
 class QGCCacheWorker : public QThread
 {
     Q_OBJECT
@@ -24,6 +38,41 @@ class QGCCacheWorker : public QThread
     ~QGCCacheWorker();
 
     void setDatabaseFile(const QString &path) { if (isRunning()) { return; } _databasePath = path; }
+    /// Number of read-only connections serving tile fetches, 0 runs every task on this thread
+    void setReaderCount(int count) { if (isRunning()) { return; } _readerCount = qMax(0, count); }
+    /// Memory budget of the tiles kept in front of the database, 0 disables it. Thread safe.
+    void setMemoryCacheSize(qint64 bytes) { _memoryCache->setMaxBytes(bytes); }
+    /// Replaces the tile archives with the MBTiles and PMTiles files in @a directory. Thread safe.
+    ///     @return Number of archives loaded
+    int loadTileArchives(const QString &directory);
+    QStringList tileArchiveFileNames() const;
+
+    static constexpr int kTaskTypeCount = static_cast<int>(QGCMapTask::TaskType::taskCacheTileBatch) + 1;
+
+    struct TaskStatistics_t {
+        quint64 count = 0;
+        qint64 totalWaitUSecs = 0;          ///< Time from enqueueTask() to the task starting
+        qint64 maxWaitUSecs = 0;
+        qint64 totalRunUSecs = 0;
+        qint64 maxRunUSecs = 0;
+
+        qint64 averageWaitUSecs() const { return ((count > 0) ? (totalWaitUSecs / static_cast<qint64>(count)) : 0); }
+        qint64 averageRunUSecs() const { return ((count > 0) ? (totalRunUSecs / static_cast<qint64>(count)) : 0); }
+    };
+
+    struct Statistics_t {
+        qsizetype writerQueueDepth = 0;
+        qsizetype maxWriterQueueDepth = 0;
+        qsizetype readerQueueDepth = 0;
+        quint64 pooledFetches = 0;          ///< Tile fetches served by the reader pool
+        QGCTileMemoryCache::Statistics_t memoryCache;
+        std::array<TaskStatistics_t, kTaskTypeCount> tasks{};   ///< Indexed by QGCMapTask::TaskType
+
+        const TaskStatistics_t &task(QGCMapTask::TaskType type) const { return tasks[static_cast<int>(type)]; }
+    };
+
+    /// Thread safe snapshot of the queue depths, per task type latencies and memory cache hits
+    Statistics_t statistics() const;
 
 public slots:
     bool enqueueTask(QGCMapTask *task);
@@ -37,8 +86,16 @@ public slots:
 
 private:
     void _runTask(QGCMapTask *task);
+    bool _routeToReaders(const QGCMapTask *task) const;
+    void _trackPendingTask(const QGCMapTask *task, int delta);
+    void _trackPendingSave(const QString &hash, int delta);
+    void _clearPendingTasks();
+    void _recordTask(const QGCMapTask *task, qint64 waitUSecs, qint64 runUSecs, bool pooled);
+    void _suspendReaders();
+    void _resumeReaders();
 
     void _saveTile(QGCMapTask *task);
+    void _saveTileBatch(QGCMapTask *task);
     void _getTile(QGCMapTask *task);
     void _getTileSets(QGCMapTask *task);
     void _createTileSet(QGCMapTask *task);
@@ -54,8 +111,16 @@ public slots:
     void _emitTotals();
 
     std::unique_ptr<QGCTileCacheDatabase> _database;
-    QMutex _taskQueueMutex;
+    const std::unique_ptr<QGCTileMemoryCache> _memoryCache;   ///< Shared with _readers, outlives it
+    const std::unique_ptr<QGCTileArchiveSet> _archives;       ///< Shared with _readers, outlives it
+    std::unique_ptr<QGCTileCacheReaderPool> _readers;
+    int _readerCount = kDefaultReaderCount;
+    mutable QMutex _taskQueueMutex;
     QQueue<QGCMapTask*> _taskQueue;
+    QHash<QString, int> _pendingSaves;      ///< Queued or running saves by tile hash
+    int _pendingTileRemovals = 0;           ///< Queued or running tasks which may remove tiles
+    mutable QMutex _statisticsMutex;
+    Statistics_t _statistics;
     QWaitCondition _waitc;
     QString _databasePath;
     QElapsedTimer _updateTimer;
@@ -65,4 +130,5 @@ public slots:
 
     static constexpr int kShortTimeoutMs = 2000;
     static constexpr int kLongTimeoutMs = 5000;
+    static constexpr int kDefaultReaderCount = 2;
 };
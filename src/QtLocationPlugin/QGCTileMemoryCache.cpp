@@ -0,0 +1,180 @@
+#include "QGCTileMemoryCache.h"
+
+#include <QtCore/QLoggingCategory>
+
+#include "QGCCacheTile.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheWorkerLog)
+
+namespace {
+
+/// @return Value of the decimal digits in @a digits, -1 if there is anything else
+qint64 _parseDigits(QStringView digits)
+{
+    qint64 value = 0;
+    for (const QChar c : digits) {
+        const int digit = c.unicode() - u'0';
+        if ((digit < 0) || (digit > 9)) {
+            return -1;
+        }
+        value = (value * 10) + digit;
+    }
+
+    return value;
+}
+
+} // namespace
+
+QGCTileMemoryCache::QGCTileMemoryCache(qint64 maxBytes)
+    : _maxBytes(qMax<qint64>(0, maxBytes))
+{
+}
+
+QGCTileMemoryCache::~QGCTileMemoryCache()
+{
+    const Statistics_t stats = statistics();
+    qCDebug(QGCTileCacheWorkerLog) << "tile memory cache tiles" << stats.count << "bytes" << stats.bytes
+                                   << "hits" << stats.hits << "misses" << stats.misses << "evictions" << stats.evictions;
+}
+
+quint64 QGCTileMemoryCache::keyFromHash(QStringView hash)
+{
+    // Fixed width fields of UrlFactory::getTileHash(): map id, x, y, zoom
+    if (hash.size() != (10 + 8 + 8 + 3)) {
+        return kInvalidKey;
+    }
+
+    const qint64 mapId = _parseDigits(hash.sliced(0, 10));
+    const qint64 x = _parseDigits(hash.sliced(10, 8));
+    const qint64 y = _parseDigits(hash.sliced(18, 8));
+    const qint64 zoom = _parseDigits(hash.sliced(26, 3));
+    if ((mapId < 0) || (mapId > kMaxMapId) || (zoom < 0) || (zoom > kMaxZoom)) {
+        return kInvalidKey;
+    }
+
+    const qint64 tiles = qint64{1} << zoom;
+    if ((x < 0) || (x >= tiles) || (y < 0) || (y >= tiles)) {
+        return kInvalidKey;
+    }
+
+    return key(static_cast<int>(mapId), static_cast<int>(x), static_cast<int>(y), static_cast<int>(zoom));
+}
+
+std::unique_ptr<QGCCacheTile> QGCTileMemoryCache::find(quint64 key, const QString &hash)
+{
+    if ((key == kInvalidKey) || (maxBytes() <= 0)) {
+        return nullptr;
+    }
+
+    Shard_t &shard = _shard(key);
+    QMutexLocker locker(&shard.mutex);
+
+    const auto it = shard.entries.constFind(key);
+    if (it == shard.entries.cend()) {
+        shard.misses++;
+        return nullptr;
+    }
+
+    shard.hits++;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->lruPosition);
+    return std::make_unique<QGCCacheTile>(hash, it->image, it->format, it->type);
+}
+
+void QGCTileMemoryCache::insert(quint64 key, const QGCCacheTile &tile, quint64 generation)
+{
+    if (key == kInvalidKey) {
+        return;
+    }
+
+    const qint64 tileBytes = tile.img.size() + kEntryOverheadBytes;
+    const qint64 shardMaxBytes = _shardMaxBytes();
+    if (tileBytes > shardMaxBytes) {
+        return;
+    }
+
+    Shard_t &shard = _shard(key);
+    QMutexLocker locker(&shard.mutex);
+
+    if (generation != _generation.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->lruPosition);
+        return;
+    }
+
+    shard.lru.push_front(key);
+    (void) shard.entries.insert(key, { tile.img, tile.format, tile.type, tileBytes, shard.lru.begin() });
+    shard.bytes += tileBytes;
+
+    _evict(shard, shardMaxBytes);
+}
+
+void QGCTileMemoryCache::clear()
+{
+    // Bumped first: an insert of a tile read before the clear either lands before its shard is emptied or is refused
+    (void) _generation.fetch_add(1, std::memory_order_acq_rel);
+
+    for (Shard_t &shard : _shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.entries.clear();
+        shard.lru.clear();
+        shard.bytes = 0;
+    }
+}
+
+void QGCTileMemoryCache::setMaxBytes(qint64 maxBytes)
+{
+    _maxBytes.store(qMax<qint64>(0, maxBytes), std::memory_order_relaxed);
+
+    const qint64 shardMaxBytes = _shardMaxBytes();
+    for (Shard_t &shard : _shards) {
+        QMutexLocker locker(&shard.mutex);
+        _evict(shard, shardMaxBytes);
+    }
+}
+
+QGCTileMemoryCache::Statistics_t QGCTileMemoryCache::statistics() const
+{
+    Statistics_t stats;
+    for (const Shard_t &shard : _shards) {
+        QMutexLocker locker(&shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.evictions += shard.evictions;
+        stats.bytes += shard.bytes;
+        stats.count += shard.entries.size();
+    }
+
+    return stats;
+}
+
+void QGCTileMemoryCache::resetStatistics()
+{
+    for (Shard_t &shard : _shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+    }
+}
+
+QGCTileMemoryCache::Shard_t &QGCTileMemoryCache::_shard(quint64 key)
+{
+    // Neighbouring tiles differ in the low bits of x and y, fold both into the shard index
+    const quint64 mixed = key ^ (key >> 23) ^ (key >> 46);
+    return _shards[mixed % kShardCount];
+}
+
+void QGCTileMemoryCache::_evict(Shard_t &shard, qint64 maxBytes)
+{
+    while ((shard.bytes > maxBytes) && !shard.lru.empty()) {
+        const auto it = shard.entries.constFind(shard.lru.back());
+        shard.lru.pop_back();
+        shard.bytes -= it->bytes;
+        shard.entries.erase(it);
+        shard.evictions++;
+    }
+}
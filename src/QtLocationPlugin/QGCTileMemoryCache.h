@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+#include <QtCore/QStringView>
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+
+struct QGCCacheTile;
+
+/// Tiles recently read from the tile cache database, so a map redrawing the same area does not query SQLite
+/// for every tile again. Tiles are keyed by a 64 bit integer packed from the map id and the tile x/y/zoom.
+/// The keys are spread over kShardCount shards, each with its own lock, least recently used list and share
+/// of the memory budget, so the reader threads seldom wait on each other.
+/// Tiles in the database are never overwritten, only removed: the owner calls clear() after removing tiles.
+/// Thread safe.
+class QGCTileMemoryCache
+{
+public:
+    explicit QGCTileMemoryCache(qint64 maxBytes = kDefaultMaxBytes);
+    ~QGCTileMemoryCache();
+
+    QGCTileMemoryCache(const QGCTileMemoryCache&) = delete;
+    QGCTileMemoryCache &operator=(const QGCTileMemoryCache&) = delete;
+
+    /// Key layout: map id 12 bits | zoom 6 bits | y 23 bits | x 23 bits
+    static constexpr quint64 key(int mapId, int x, int y, int zoom)
+    {
+        return ((static_cast<quint64>(mapId) & 0xFFF) << 52) |
+               ((static_cast<quint64>(zoom) & 0x3F) << 46) |
+               ((static_cast<quint64>(y) & 0x7FFFFF) << 23) |
+               (static_cast<quint64>(x) & 0x7FFFFF);
+    }
+
+    static constexpr int keyMapId(quint64 key) { return static_cast<int>(key >> 52); }
+    static constexpr int keyZoom(quint64 key) { return static_cast<int>((key >> 46) & 0x3F); }
+    static constexpr int keyY(quint64 key) { return static_cast<int>((key >> 23) & 0x7FFFFF); }
+    static constexpr int keyX(quint64 key) { return static_cast<int>(key & 0x7FFFFF); }
+
+    /// @return Key of a hash made by UrlFactory::getTileHash(), kInvalidKey if the hash does not fit the key layout
+    static quint64 keyFromHash(QStringView hash);
+
+    /// @return The tile, nullptr if it is not cached. Marks the tile as most recently used.
+    std::unique_ptr<QGCCacheTile> find(quint64 key, const QString &hash);
+
+    /// Changes with every clear(). A tile read from the database before a clear() is not inserted after it.
+    quint64 generation() const { return _generation.load(std::memory_order_acquire); }
+
+    /// Adds a tile read from the database while generation() was @a generation and evicts least recently used
+    /// tiles beyond the shard budget. Tiles larger than a shard budget are not cached.
+    void insert(quint64 key, const QGCCacheTile &tile, quint64 generation);
+    void clear();
+
+    qint64 maxBytes() const { return _maxBytes.load(std::memory_order_relaxed); }
+    /// 0 disables the cache
+    void setMaxBytes(qint64 maxBytes);
+
+    struct Statistics_t {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 bytes = 0;
+        qsizetype count = 0;
+
+        /// Hits as a fraction of lookups, 0 before the first lookup
+        double hitRate() const { return (((hits + misses) > 0) ? (static_cast<double>(hits) / static_cast<double>(hits + misses)) : 0.); }
+    };
+
+    Statistics_t statistics() const;
+    void resetStatistics();
+
+    static constexpr int kShardCount = 8;
+    static constexpr int kMaxZoom = 23;
+    static constexpr int kMaxMapId = 0xFFF;
+    static constexpr quint64 kInvalidKey = UINT64_MAX;
+    static constexpr qint64 kDefaultMaxBytes = 32 * 1024 * 1024;
+
+private:
+    struct Entry_t {
+        QByteArray image;
+        QString format;
+        QString type;
+        qint64 bytes = 0;
+        std::list<quint64>::iterator lruPosition;
+    };
+
+    struct Shard_t {
+        mutable QMutex mutex;
+        QHash<quint64, Entry_t> entries;
+        std::list<quint64> lru;             ///< Keys, most recently used first
+        qint64 bytes = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+    };
+
+    Shard_t &_shard(quint64 key);
+    qint64 _shardMaxBytes() const { return (maxBytes() / kShardCount); }
+    static void _evict(Shard_t &shard, qint64 maxBytes);
+
+    std::array<Shard_t, kShardCount> _shards;
+    std::atomic<qint64> _maxBytes;
+    std::atomic<quint64> _generation = 0;
+
+    static constexpr qint64 kEntryOverheadBytes = 128;  ///< Hash node, list node and string headers
+};
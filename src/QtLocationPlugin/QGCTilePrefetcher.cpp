@@ -0,0 +1,398 @@
+#include "QGCTilePrefetcher.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QtMath>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+
+#include <utility>
+
+#include "MapProvider.h"
+#include "QGCCacheTile.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMapEngine.h"
+#include "QGCMapTasks.h"
+#include "QGCMapUrlEngine.h"
+#include "QGCNetworkHelper.h"
+#include "QGCTileMemoryCache.h"
+#include "QGeoFileTileCacheQGC.h"
+#include "QGeoMapReplyQGC.h"
+#include "QGeoTileFetcherQGC.h"
+
+QGC_LOGGING_CATEGORY(QGCTilePrefetcherLog, "QtLocationPlugin.QGCTilePrefetcher")
+
+namespace {
+
+constexpr double kEarthCircumferenceMeters = 40075016.686;
+constexpr double kMinSampleStepMeters = 1.;
+
+/// @return Width of a tile at @a latitude
+double _tileWidthMeters(double latitude, int zoom)
+{
+    return ((kEarthCircumferenceMeters * qCos(qDegreesToRadians(latitude))) / static_cast<double>(1 << zoom));
+}
+
+} // namespace
+
+QGCTilePrefetcher::QGCTilePrefetcher(QObject *parent)
+    : QObject(parent)
+    , _budgetTimer(new QTimer(this))
+{
+    qCDebug(QGCTilePrefetcherLog) << this;
+
+    _clock.start();
+    _budgetBytes = static_cast<double>(_maxBytesPerSecond);
+
+    _budgetTimer->setSingleShot(true);
+    (void) connect(_budgetTimer, &QTimer::timeout, this, &QGCTilePrefetcher::_dispatch);
+}
+
+QGCTilePrefetcher::~QGCTilePrefetcher()
+{
+    qCDebug(QGCTilePrefetcherLog) << this;
+}
+
+QList<QGCTile> QGCTilePrefetcher::corridorTiles(int mapId, int zoom, const QList<QGeoCoordinate> &path, double lengthMeters,
+                                                int tileRadius, int maxTiles)
+{
+    QList<QGCTile> tiles;
+
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromQtMapId(mapId);
+    if (!provider || path.isEmpty() || (zoom < 0) || (zoom > QGCTileMemoryCache::kMaxZoom) || (maxTiles <= 0)) {
+        return tiles;
+    }
+
+    const int tileCount = 1 << zoom;
+    QSet<quint64> seen;
+
+    // Rings of tiles around the sample, nearest first. False once maxTiles is reached.
+    const auto addAround = [&](const QGeoCoordinate &coordinate) -> bool {
+        const int centerX = provider->long2tileX(coordinate.longitude(), zoom);
+        const int centerY = provider->lat2tileY(coordinate.latitude(), zoom);
+        for (int ring = 0; ring <= tileRadius; ring++) {
+            for (int dy = -ring; dy <= ring; dy++) {
+                for (int dx = -ring; dx <= ring; dx++) {
+                    if (qMax(qAbs(dx), qAbs(dy)) != ring) {
+                        continue;
+                    }
+
+                    const int y = centerY + dy;
+                    if ((y < 0) || (y >= tileCount)) {
+                        continue;
+                    }
+                    // Columns wrap around the antimeridian
+                    const int x = (((centerX + dx) % tileCount) + tileCount) % tileCount;
+
+                    const quint64 key = QGCTileMemoryCache::key(mapId, x, y, zoom);
+                    if (seen.contains(key)) {
+                        continue;
+                    }
+                    (void) seen.insert(key);
+
+                    QGCTile tile;
+                    tile.x = x;
+                    tile.y = y;
+                    tile.z = zoom;
+                    tile.type = mapId;
+                    tile.hash = UrlFactory::getTileHash(provider->getMapName(), x, y, zoom);
+                    tiles.append(tile);
+                    if (tiles.size() >= maxTiles) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+
+    if (!path.first().isValid() || !addAround(path.first())) {
+        return tiles;
+    }
+
+    double travelled = 0.;
+    for (qsizetype i = 1; i < path.size(); i++) {
+        const QGeoCoordinate &from = path.at(i - 1);
+        const QGeoCoordinate &to = path.at(i);
+        if (!from.isValid() || !to.isValid()) {
+            continue;
+        }
+
+        const double distance = from.distanceTo(to);
+        const double azimuth = from.azimuthTo(to);
+        // Half a tile between samples so no tile the path crosses is skipped
+        const double step = qMax(kMinSampleStepMeters, _tileWidthMeters(from.latitude(), zoom) / 2.);
+        for (double along = step; ; along += step) {
+            const double sample = qMin(along, distance);
+            if ((travelled + sample) >= lengthMeters) {
+                (void) addAround(from.atDistanceAndAzimuth(lengthMeters - travelled, azimuth));
+                return tiles;
+            }
+            if (!addAround(from.atDistanceAndAzimuth(sample, azimuth))) {
+                return tiles;
+            }
+            if (sample >= distance) {
+                break;
+            }
+        }
+        travelled += distance;
+    }
+
+    return tiles;
+}
+
+void QGCTilePrefetcher::setCorridor(const QString &mapType, int zoom, const QList<QGeoCoordinate> &path, double lengthMeters)
+{
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(mapType);
+    if (!provider || provider->isElevationProvider()) {
+        clear();
+        return;
+    }
+
+    _expireRecent();
+
+    const int mapId = provider->getMapId();
+    const QList<QGCTile> tiles = corridorTiles(mapId, qBound(0, zoom, QGCTileMemoryCache::kMaxZoom), path, lengthMeters);
+
+    QSet<quint64> corridor;
+    corridor.reserve(tiles.size());
+    for (const QGCTile &tile : tiles) {
+        (void) corridor.insert(QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z));
+    }
+
+    // Tiles already known to be missing from the cache keep their place in the download queue
+    QQueue<QGCTile> downloadQueue;
+    QSet<quint64> awaitingDownload;
+    for (const QGCTile &tile : std::as_const(_downloadQueue)) {
+        const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+        if (corridor.contains(key)) {
+            downloadQueue.enqueue(tile);
+            (void) awaitingDownload.insert(key);
+        } else {
+            (void) _inFlight.remove(key);
+            _statistics.dropped++;
+        }
+    }
+
+    for (const QGCTile &tile : std::as_const(_warmQueue)) {
+        if (!corridor.contains(QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z))) {
+            _statistics.dropped++;
+        }
+    }
+
+    QQueue<QGCTile> warmQueue;
+    for (const QGCTile &tile : tiles) {
+        const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+        if (_isRecent(key) || _inFlight.contains(key) || awaitingDownload.contains(key)) {
+            continue;
+        }
+        warmQueue.enqueue(tile);
+    }
+
+    _statistics.scheduled += static_cast<quint64>(warmQueue.size());
+    _warmQueue = std::move(warmQueue);
+    _downloadQueue = std::move(downloadQueue);
+
+    qCDebug(QGCTilePrefetcherLog) << mapType << "zoom" << zoom << "corridor" << tiles.size() << "tiles, warming" << _warmQueue.size()
+                                  << "downloading" << _downloadQueue.size();
+
+    _dispatch();
+}
+
+void QGCTilePrefetcher::clear()
+{
+    _statistics.dropped += static_cast<quint64>(_warmQueue.size() + _downloadQueue.size());
+    for (const QGCTile &tile : std::as_const(_downloadQueue)) {
+        (void) _inFlight.remove(QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z));
+    }
+    _warmQueue.clear();
+    _downloadQueue.clear();
+    _budgetTimer->stop();
+}
+
+void QGCTilePrefetcher::setMaxBytesPerSecond(qint64 maxBytesPerSecond)
+{
+    _maxBytesPerSecond = qMax<qint64>(0, maxBytesPerSecond);
+    _budgetBytes = qMin(_budgetBytes, static_cast<double>(_maxBytesPerSecond));
+    _dispatch();
+}
+
+void QGCTilePrefetcher::tileRequested(int mapId, int x, int y, int zoom, bool cached)
+{
+    const quint64 key = QGCTileMemoryCache::key(mapId, x, y, zoom);
+    (void) QMetaObject::invokeMethod(this, [this, key, cached]() { _tileRequested(key, cached); }, Qt::AutoConnection);
+}
+
+void QGCTilePrefetcher::_tileRequested(quint64 key, bool cached)
+{
+    _statistics.requests++;
+    if (cached) {
+        _statistics.requestsFromCache++;
+    }
+    if (_prefetched.remove(key) && cached) {
+        _statistics.used++;
+    }
+    (void) _requested.insert(key, _clock.elapsed());
+}
+
+void QGCTilePrefetcher::_expireRecent()
+{
+    const qint64 oldest = _clock.elapsed() - kRecentTileMs;
+    (void) _prefetched.removeIf([oldest](const QHash<quint64, qint64>::iterator it) { return (it.value() < oldest); });
+    (void) _requested.removeIf([oldest](const QHash<quint64, qint64>::iterator it) { return (it.value() < oldest); });
+}
+
+void QGCTilePrefetcher::_dispatch()
+{
+    while ((_pendingWarms < kMaxPendingWarms) && !_warmQueue.isEmpty()) {
+        _warm(_warmQueue.dequeue());
+    }
+
+    if (_downloadQueue.isEmpty() || (_maxBytesPerSecond <= 0)) {
+        return;
+    }
+
+    _refillBudget();
+    while ((_activeDownloads < kMaxConcurrentDownloads) && !_downloadQueue.isEmpty() && (_budgetBytes > 0.)) {
+        _download(_downloadQueue.dequeue());
+    }
+
+    if (!_downloadQueue.isEmpty() && (_budgetBytes <= 0.) && !_budgetTimer->isActive()) {
+        const int waitMs = qCeil((-_budgetBytes * 1000.) / static_cast<double>(_maxBytesPerSecond)) + 1;
+        _budgetTimer->start(waitMs);
+    }
+}
+
+void QGCTilePrefetcher::_refillBudget()
+{
+    const qint64 nowMs = _clock.elapsed();
+    const qint64 elapsedMs = nowMs - _budgetRefilledMs;
+    _budgetRefilledMs = nowMs;
+
+    // At most one second worth of bytes is saved up
+    const double maxBytes = static_cast<double>(_maxBytesPerSecond);
+    _budgetBytes = qMin(maxBytes, _budgetBytes + ((static_cast<double>(elapsedMs) * maxBytes) / 1000.));
+}
+
+void QGCTilePrefetcher::_warm(const QGCTile &tile)
+{
+    const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+
+    _pendingWarms++;
+    (void) _inFlight.insert(key);
+
+    // The cache worker keeps the tile it reads in its memory cache, so the map's request for it is cheap
+    QGCFetchTileTask *task = new QGCFetchTileTask(tile.hash);
+    (void) connect(task, &QGCFetchTileTask::tileFetched, this, [this, key](QGCCacheTile *cacheTile) {
+        _warmFinished(key, cacheTile);
+    });
+    // A rejected task reports its error before addTask() returns, the rejection is handled below instead
+    (void) connect(task, &QGCMapTask::error, this, [this, tile](QGCMapTask::TaskType, const QString &) {
+        if (!_addingTask) {
+            _warmFailed(tile);
+        }
+    });
+
+    _addingTask = true;
+    const bool added = getQGCMapEngine()->addTask(task);
+    _addingTask = false;
+    if (added) {
+        return;
+    }
+
+    // The tile cache is not available, so neither are the other tiles. The engine deleted the task.
+    _pendingWarms--;
+    (void) _inFlight.remove(key);
+    _statistics.dropped += static_cast<quint64>(1 + _warmQueue.size());
+    _warmQueue.clear();
+}
+
+void QGCTilePrefetcher::_warmFinished(quint64 key, QGCCacheTile *cacheTile)
+{
+    delete cacheTile;
+
+    _pendingWarms--;
+    (void) _inFlight.remove(key);
+    (void) _prefetched.insert(key, _clock.elapsed());
+    _statistics.warmed++;
+
+    _dispatch();
+}
+
+void QGCTilePrefetcher::_warmFailed(const QGCTile &tile)
+{
+    _pendingWarms--;
+
+    const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromQtMapId(tile.type);
+    const bool download = provider && !provider->isArchiveProvider() && (_maxBytesPerSecond > 0) &&
+                          QGCNetworkHelper::isInternetAvailable();
+    if (download) {
+        _downloadQueue.enqueue(tile);
+    } else {
+        (void) _inFlight.remove(key);
+    }
+
+    _dispatch();
+}
+
+void QGCTilePrefetcher::_download(const QGCTile &tile)
+{
+    const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+
+    QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(tile.type, tile.x, tile.y, tile.z);
+    if (request.url().isEmpty() || !request.url().isValid()) {
+        (void) _inFlight.remove(key);
+        return;
+    }
+    // Requests of the visible map go first
+    request.setPriority(QNetworkRequest::LowPriority);
+    request.setOriginatingObject(this);
+
+    if (!_networkManager) {
+        _networkManager = new QNetworkAccessManager(this);
+        QGCNetworkHelper::configureProxy(_networkManager);
+    }
+
+    QNetworkReply *const reply = _networkManager->get(request);
+    reply->setParent(this);
+    QGCNetworkHelper::ignoreSslErrorsIfNeeded(reply);
+    (void) connect(reply, &QNetworkReply::finished, this, [this, reply, tile]() {
+        _downloadFinished(reply, tile);
+    });
+
+    _activeDownloads++;
+}
+
+void QGCTilePrefetcher::_downloadFinished(QNetworkReply *reply, const QGCTile &tile)
+{
+    reply->deleteLater();
+    _activeDownloads--;
+
+    const quint64 key = QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z);
+    (void) _inFlight.remove(key);
+
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray image = ((reply->error() == QNetworkReply::NoError) && QGCNetworkHelper::isHttpSuccess(statusCode)) ? reply->readAll() : QByteArray();
+
+    // Charged after the fact, the size of a tile is only known once it arrived
+    _refillBudget();
+    _budgetBytes -= static_cast<double>(image.size());
+
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromQtMapId(tile.type);
+    const QString format = provider ? provider->getImageFormat(image) : QString();
+    if (image.isEmpty() || format.isEmpty() || (provider->isBingProvider() && QGeoTiledMapReplyQGC::isBingNoTileImage(image))) {
+        qCDebug(QGCTilePrefetcherLog) << "Download failed" << tile.hash << reply->errorString();
+        _statistics.failed++;
+        // Left to the map, which reports its own errors
+        (void) _requested.insert(key, _clock.elapsed());
+        _dispatch();
+        return;
+    }
+
+    QGeoFileTileCacheQGC::cacheTile(provider->getMapName(), tile.hash, image, format);
+    (void) _prefetched.insert(key, _clock.elapsed());
+    _statistics.downloaded++;
+    _statistics.downloadedBytes += static_cast<quint64>(image.size());
+
+    _dispatch();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QQueue>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtPositioning/QGeoCoordinate>
+
+#include "QGCTile.h"
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTilePrefetcherLog)
+
+struct QGCCacheTile;
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+/// Loads the map tiles of a corridor ahead of the vehicle before the map asks for them.
+/// Each tile is first fetched from the tile cache, which leaves it in the database tile memory cache. Tiles
+/// the cache does not hold are downloaded at low network priority, a few at a time and within a byte rate
+/// budget, and saved to the cache like tiles the map downloads itself.
+/// The map reports the tiles it requests through tileRequested(), which gives the prefetch hit ratio.
+class QGCTilePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QGCTilePrefetcher(QObject *parent = nullptr);
+    ~QGCTilePrefetcher();
+
+    /// Replaces the tiles waiting to be prefetched with those of a corridor along @a path, nearest first.
+    /// Tiles prefetched or requested by the map recently are not fetched again.
+    ///     @param mapType Map name as used by UrlFactory, e.g. "Bing Satellite"
+    ///     @param lengthMeters Length of @a path the corridor covers
+    void setCorridor(const QString &mapType, int zoom, const QList<QGeoCoordinate> &path, double lengthMeters);
+    /// Drops the tiles waiting to be prefetched, fetches in progress complete
+    void clear();
+
+    /// Download budget in bytes per second, 0 only warms tiles which are already cached
+    void setMaxBytesPerSecond(qint64 maxBytesPerSecond);
+    qint64 maxBytesPerSecond() const { return _maxBytesPerSecond; }
+
+    /// Called for every tile the map loads. Thread safe.
+    ///     @param cached The tile was served from the tile cache
+    void tileRequested(int mapId, int x, int y, int zoom, bool cached);
+
+    struct Statistics_t {
+        quint64 scheduled = 0;          ///< Tiles queued for prefetch
+        quint64 warmed = 0;             ///< Prefetched tiles which were already cached
+        quint64 downloaded = 0;         ///< Prefetched tiles which were downloaded
+        quint64 downloadedBytes = 0;
+        quint64 failed = 0;             ///< Downloads which failed
+        quint64 dropped = 0;            ///< Queued tiles which left the corridor before they were fetched
+        quint64 used = 0;               ///< Prefetched tiles the map then loaded from the cache
+        quint64 requests = 0;           ///< Tiles the map loaded
+        quint64 requestsFromCache = 0;  ///< Tiles the map loaded from the cache
+
+        quint64 prefetched() const { return (warmed + downloaded); }
+        /// Prefetched tiles the map used as a fraction of all prefetched tiles, 0 before the first prefetch
+        double hitRatio() const { return ((prefetched() > 0) ? (static_cast<double>(used) / static_cast<double>(prefetched())) : 0.); }
+        /// Map tile loads served by a prefetched tile as a fraction of all loads, 0 before the first load
+        double coverage() const { return ((requests > 0) ? (static_cast<double>(used) / static_cast<double>(requests)) : 0.); }
+    };
+
+    Statistics_t statistics() const { return _statistics; }
+    void resetStatistics() { _statistics = Statistics_t(); }
+
+    /// @return Tiles within @a tileRadius tiles of @a path up to @a lengthMeters along it, in the order the path
+    ///         reaches them, at most @a maxTiles
+    static QList<QGCTile> corridorTiles(int mapId, int zoom, const QList<QGeoCoordinate> &path, double lengthMeters,
+                                        int tileRadius = kCorridorTileRadius, int maxTiles = kMaxCorridorTiles);
+
+    static constexpr int kCorridorTileRadius = 2;
+    static constexpr int kMaxCorridorTiles = 256;
+    static constexpr int kMaxPendingWarms = 8;
+    static constexpr int kMaxConcurrentDownloads = 2;   ///< Leaves most connections of a host to the map
+    static constexpr qint64 kRecentTileMs = 10 * 60 * 1000;
+    static constexpr qint64 kDefaultMaxBytesPerSecond = 256 * 1024;
+
+private:
+    void _dispatch();
+    void _warm(const QGCTile &tile);
+    void _warmFinished(quint64 key, QGCCacheTile *cacheTile);
+    void _warmFailed(const QGCTile &tile);
+    void _download(const QGCTile &tile);
+    void _downloadFinished(QNetworkReply *reply, const QGCTile &tile);
+    void _refillBudget();
+    void _expireRecent();
+    void _tileRequested(quint64 key, bool cached);
+    bool _isRecent(quint64 key) const { return (_prefetched.contains(key) || _requested.contains(key)); }
+
+    QQueue<QGCTile> _warmQueue;
+    QQueue<QGCTile> _downloadQueue;
+    QSet<quint64> _inFlight;
+    QHash<quint64, qint64> _prefetched;     ///< Key to time prefetched, until the map uses it or it expires
+    QHash<quint64, qint64> _requested;      ///< Key to time the map requested it
+    int _pendingWarms = 0;
+    bool _addingTask = false;               ///< A warm task is being handed to the map engine
+    int _activeDownloads = 0;
+
+    qint64 _maxBytesPerSecond = kDefaultMaxBytesPerSecond;
+    double _budgetBytes = 0.;               ///< Token bucket, below zero after a download overran it
+    qint64 _budgetRefilledMs = 0;
+    QElapsedTimer _clock;
+    QTimer *_budgetTimer = nullptr;
+
+    QNetworkAccessManager *_networkManager = nullptr;
+    Statistics_t _statistics;
+
+    friend class QGCTilePrefetcherTest;
+};
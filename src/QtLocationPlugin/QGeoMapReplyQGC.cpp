@@ -11,6 +11,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCMapEngine.h"
 #include "QGCMapUrlEngine.h"
+#include "QGCTilePrefetcher.h"
 #include "QGeoFileTileCacheQGC.h"
 
 QGC_LOGGING_CATEGORY(QGeoTiledMapReplyQGCLog, "QtLocationPlugin.QGeoTiledMapReplyQGC")
@@ -84,6 +85,12 @@ void QGeoTiledMapReplyQGC::_initDataFromResources()
     }
 }
 
+bool QGeoTiledMapReplyQGC::isBingNoTileImage(const QByteArray &image)
+{
+    _initDataFromResources();
+    return (!_bingNoTileImage.isEmpty() && (image == _bingNoTileImage));
+}
+
 void QGeoTiledMapReplyQGC::_networkReplyFinished()
 {
     QNetworkReply* const reply = qobject_cast<QNetworkReply*>(sender());
@@ -120,7 +127,7 @@ void QGeoTiledMapReplyQGC::_networkReplyFinished()
         return;
     }
 
-    if (mapProvider->isBingProvider() && (image == _bingNoTileImage)) {
+    if (mapProvider->isBingProvider() && isBingNoTileImage(image)) {
         setError(QGeoTiledMapReply::CommunicationError, tr("Bing Tile Above Zoom Level"));
         return;
     }
@@ -178,6 +185,8 @@ void QGeoTiledMapReplyQGC::_networkReplySslErrors(const QList<QSslError> &errors
 
 void QGeoTiledMapReplyQGC::_cacheReply(QGCCacheTile *tile)
 {
+    getQGCMapEngine()->tilePrefetcher()->tileRequested(tileSpec().mapId(), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), (tile != nullptr));
+
     if (tile) {
         setMapImageData(tile->img);
         setMapImageFormat(tile->format);
@@ -195,6 +204,14 @@ void QGeoTiledMapReplyQGC::_cacheError(QGCMapTask::TaskType type, QStringView er
 
     Q_ASSERT(type == QGCMapTask::TaskType::taskFetchTile);
 
+    getQGCMapEngine()->tilePrefetcher()->tileRequested(tileSpec().mapId(), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), false);
+
+    const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromQtMapId(tileSpec().mapId());
+    if (mapProvider && mapProvider->isArchiveProvider()) {
+        setError(QGeoTiledMapReply::UnknownError, tr("Tile Not In Archives"));
+        return;
+    }
+
     if (!QGCNetworkHelper::isInternetAvailable()) {
         setError(QGeoTiledMapReply::CommunicationError, tr("Network Not Available"));
         return;
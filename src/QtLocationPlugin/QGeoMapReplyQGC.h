@@ -23,6 +23,9 @@ class QGeoTiledMapReplyQGC : public QGeoTiledMapReply
     bool init();
     void abort() final;
 
+    /// @return True if @a image is the placeholder Bing serves for tiles it does not have
+    static bool isBingNoTileImage(const QByteArray &image);
+
 private slots:
     void _networkReplyFinished();
     void _networkReplyError(QNetworkReply::NetworkError error);
@@ -42,8 +42,9 @@ QGeoTiledMapReply* QGeoTileFetcherQGC::getTileImage(const QGeoTileSpec &spec)
         return nullptr;
     }*/
 
+    // Archive tiles are only read from the cache worker, there is no URL to fall back to
     const QNetworkRequest request = getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
-    if (request.url().isEmpty()) {
+    if (request.url().isEmpty() && !provider->isArchiveProvider()) {
         return nullptr;
     }
 
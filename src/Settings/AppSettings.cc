@@ -215,6 +215,8 @@ void AppSettings::_checkSavePathDirectories(void)
         QGCFileHelper::ensureDirectoryExists(QGCFileHelper::joinPath(savePath, crashDirectory));
         QGCFileHelper::ensureDirectoryExists(QGCFileHelper::joinPath(savePath, mavlinkActionsDirectory));
         QGCFileHelper::ensureDirectoryExists(QGCFileHelper::joinPath(savePath, settingsDirectory));
+        QGCFileHelper::ensureDirectoryExists(QGCFileHelper::joinPath(savePath, terrainDirectory));
+        QGCFileHelper::ensureDirectoryExists(QGCFileHelper::joinPath(savePath, mapTilesDirectory));
     }
 }
 
@@ -283,6 +285,16 @@ QString AppSettings::settingsSavePath(void)
     return _childSavePath(settingsDirectory);
 }
 
+QString AppSettings::terrainSavePath(void)
+{
+    return _childSavePath(terrainDirectory);
+}
+
+QString AppSettings::mapTilesSavePath(void)
+{
+    return _childSavePath(mapTilesDirectory);
+}
+
 QList<int> AppSettings::firstRunPromptsIdsVariantToList(const QVariant& firstRunPromptIds)
 {
     QList<int> rgIds;
@@ -57,6 +57,8 @@ class AppSettings : public SettingsGroup
     Q_PROPERTY(QString crashSavePath            READ crashSavePath              NOTIFY savePathsChanged)
     Q_PROPERTY(QString mavlinkActionsSavePath   READ mavlinkActionsSavePath     NOTIFY savePathsChanged)
     Q_PROPERTY(QString settingsSavePath         READ settingsSavePath           NOTIFY savePathsChanged)
+    Q_PROPERTY(QString terrainSavePath          READ terrainSavePath            NOTIFY savePathsChanged)
+    Q_PROPERTY(QString mapTilesSavePath         READ mapTilesSavePath           NOTIFY savePathsChanged)
 
     Q_PROPERTY(QString planFileExtension        MEMBER planFileExtension        CONSTANT)
     Q_PROPERTY(QString waypointsFileExtension   MEMBER waypointsFileExtension   CONSTANT)
@@ -78,6 +80,8 @@ class AppSettings : public SettingsGroup
     QString crashSavePath         ();
     QString mavlinkActionsSavePath();
     QString settingsSavePath      ();
+    QString terrainSavePath       ();
+    QString mapTilesSavePath      ();
 
     // Helper methods for working with firstRunPromptIds QVariant settings string list
     static QList<int> firstRunPromptsIdsVariantToList   (const QVariant& firstRunPromptIds);
@@ -105,6 +109,8 @@ class AppSettings : public SettingsGroup
     static constexpr const char* crashDirectory =           QT_TRANSLATE_NOOP("AppSettings", "CrashLogs");
     static constexpr const char* mavlinkActionsDirectory =  QT_TRANSLATE_NOOP("AppSettings", "MavlinkActions");
     static constexpr const char* settingsDirectory =        QT_TRANSLATE_NOOP("AppSettings", "Settings");
+    static constexpr const char* terrainDirectory =         QT_TRANSLATE_NOOP("AppSettings", "Terrain");
+    static constexpr const char* mapTilesDirectory =        QT_TRANSLATE_NOOP("AppSettings", "MapTiles");
 
 signals:
     void savePathsChanged();
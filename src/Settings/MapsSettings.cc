@@ -28,3 +28,8 @@ DECLARE_SETTINGGROUP(Maps, "Maps")
 
 DECLARE_SETTINGSFACT(MapsSettings, maxCacheDiskSize)
 DECLARE_SETTINGSFACT(MapsSettings, maxCacheMemorySize)
+DECLARE_SETTINGSFACT(MapsSettings, maxTileMemoryCacheSize)
+DECLARE_SETTINGSFACT(MapsSettings, maxTerrainCacheMemorySize)
+DECLARE_SETTINGSFACT(MapsSettings, tilePrefetch)
+DECLARE_SETTINGSFACT(MapsSettings, tilePrefetchMaxBandwidth)
+DECLARE_SETTINGSFACT(MapsSettings, tilePrefetchLookahead)
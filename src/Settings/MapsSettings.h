@@ -16,4 +16,9 @@ class MapsSettings : public SettingsGroup
 
     DEFINE_SETTINGFACT(maxCacheDiskSize)
     DEFINE_SETTINGFACT(maxCacheMemorySize)
+    DEFINE_SETTINGFACT(maxTileMemoryCacheSize)
+    DEFINE_SETTINGFACT(maxTerrainCacheMemorySize)
+    DEFINE_SETTINGFACT(tilePrefetch)
+    DEFINE_SETTINGFACT(tilePrefetchMaxBandwidth)
+    DEFINE_SETTINGFACT(tilePrefetchLookahead)
 };
@@ -30,6 +30,7 @@ DECLARE_SETTINGGROUP(Mavlink, "")
 
 DECLARE_SETTINGSFACT(MavlinkSettings, telemetrySave)
 DECLARE_SETTINGSFACT(MavlinkSettings, telemetrySaveNotArmed)
+DECLARE_SETTINGSFACT(MavlinkSettings, telemetryCompression)
 DECLARE_SETTINGSFACT(MavlinkSettings, apmStartMavlinkStreams)
 DECLARE_SETTINGSFACT(MavlinkSettings, saveCsvTelemetry)
 DECLARE_SETTINGSFACT(MavlinkSettings, forwardMavlink)
@@ -37,6 +38,7 @@ DECLARE_SETTINGSFACT(MavlinkSettings, forwardMavlinkHostName)
 DECLARE_SETTINGSFACT(MavlinkSettings, forwardMavlinkAPMSupportHostName)
 DECLARE_SETTINGSFACT(MavlinkSettings, sendGCSHeartbeat)
 DECLARE_SETTINGSFACT(MavlinkSettings, gcsMavlinkSystemID)
+DECLARE_SETTINGSFACT(MavlinkSettings, threadedMavlinkParsing)
 
 DECLARE_SETTINGSFACT_NO_FUNC(MavlinkSettings, mavlink2SigningKey)
 {
@@ -17,6 +17,7 @@ class MavlinkSettings : public SettingsGroup
 
     DEFINE_SETTINGFACT(telemetrySave)
     DEFINE_SETTINGFACT(telemetrySaveNotArmed)
+    DEFINE_SETTINGFACT(telemetryCompression)
     DEFINE_SETTINGFACT(saveCsvTelemetry)
     DEFINE_SETTINGFACT(forwardMavlink)
     DEFINE_SETTINGFACT(forwardMavlinkHostName)
@@ -24,6 +25,7 @@ class MavlinkSettings : public SettingsGroup
     DEFINE_SETTINGFACT(mavlink2SigningKey)
     DEFINE_SETTINGFACT(sendGCSHeartbeat)
     DEFINE_SETTINGFACT(gcsMavlinkSystemID)
+    DEFINE_SETTINGFACT(threadedMavlinkParsing)
 
     // Although this is a global setting it only affects ArduPilot vehicle since PX4 automatically starts the stream from the vehicle side
     DEFINE_SETTINGFACT(apmStartMavlinkStreams)
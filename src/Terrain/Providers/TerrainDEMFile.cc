@@ -0,0 +1,533 @@
+#include "TerrainDEMFile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QtEndian>
+#include <QtCore/QtNumeric>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(TerrainDEMFileLog, "Terrain.TerrainDEMFile")
+
+namespace {
+
+// Baseline TIFF and GeoTIFF tags
+constexpr quint16 kTagImageWidth = 256;
+constexpr quint16 kTagImageLength = 257;
+constexpr quint16 kTagBitsPerSample = 258;
+constexpr quint16 kTagCompression = 259;
+constexpr quint16 kTagStripOffsets = 273;
+constexpr quint16 kTagSamplesPerPixel = 277;
+constexpr quint16 kTagRowsPerStrip = 278;
+constexpr quint16 kTagStripByteCounts = 279;
+constexpr quint16 kTagTileWidth = 322;
+constexpr quint16 kTagTileLength = 323;
+constexpr quint16 kTagTileOffsets = 324;
+constexpr quint16 kTagTileByteCounts = 325;
+constexpr quint16 kTagSampleFormat = 339;
+constexpr quint16 kTagModelPixelScale = 33550;
+constexpr quint16 kTagModelTiepoint = 33922;
+constexpr quint16 kTagGeoKeyDirectory = 34735;
+constexpr quint16 kTagGDALNoData = 42113;
+
+constexpr quint16 kGeoKeyModelType = 1024;
+constexpr quint16 kGeoKeyRasterType = 1025;
+constexpr quint16 kModelTypeGeographic = 2;
+constexpr quint16 kRasterPixelIsPoint = 2;
+
+constexpr quint16 kSampleFormatUInt = 1;
+constexpr quint16 kSampleFormatInt = 2;
+constexpr quint16 kSampleFormatFloat = 3;
+
+/// Converts a tag value to a pixel count, tag values are untrusted and may be any number
+bool toDimension(double value, int &dimension)
+{
+    if (!(value >= 1.0) || (value > std::numeric_limits<int>::max())) {
+        return false;
+    }
+    dimension = static_cast<int>(value);
+    return true;
+}
+
+/// Converts a strip/tile offset or byte count, which must lie within a file of @a fileSize bytes
+bool toFileOffset(double value, qint64 fileSize, qint64 &offset)
+{
+    if (!(value >= 0.0) || (value > static_cast<double>(fileSize))) {
+        return false;
+    }
+    offset = static_cast<qint64>(value);
+    return true;
+}
+
+/// Reads the IFD of a classic TIFF straight from the mapping
+class TiffReader
+{
+public:
+    TiffReader(const uchar *data, qint64 size, bool bigEndian)
+        : _data(data), _size(size), _bigEndian(bigEndian) {}
+
+    bool readU16(qint64 offset, quint16 &value) const
+    {
+        if ((offset < 0) || ((offset + 2) > _size)) {
+            return false;
+        }
+        value = _bigEndian ? qFromBigEndian<quint16>(_data + offset) : qFromLittleEndian<quint16>(_data + offset);
+        return true;
+    }
+
+    bool readU32(qint64 offset, quint32 &value) const
+    {
+        if ((offset < 0) || ((offset + 4) > _size)) {
+            return false;
+        }
+        value = _bigEndian ? qFromBigEndian<quint32>(_data + offset) : qFromLittleEndian<quint32>(_data + offset);
+        return true;
+    }
+
+    bool readIFD(qint64 offset)
+    {
+        quint16 entryCount = 0;
+        if (!readU16(offset, entryCount)) {
+            return false;
+        }
+
+        for (quint16 i = 0; i < entryCount; i++) {
+            const qint64 entryOffset = offset + 2 + (i * 12);
+            quint16 tag = 0;
+            Entry entry;
+            quint32 valueOffset = 0;
+            if (!readU16(entryOffset, tag) || !readU16(entryOffset + 2, entry.type) || !readU32(entryOffset + 4, entry.count)) {
+                return false;
+            }
+
+            const qint64 bytes = static_cast<qint64>(_typeSize(entry.type)) * entry.count;
+            if (bytes <= 4) {
+                entry.offset = entryOffset + 8;
+            } else if (readU32(entryOffset + 8, valueOffset)) {
+                entry.offset = valueOffset;
+            } else {
+                return false;
+            }
+
+            if ((bytes == 0) || ((entry.offset + bytes) > _size)) {
+                // Unknown type or out of the file, the tag is ignored
+                continue;
+            }
+            (void) _entries.insert(tag, entry);
+        }
+
+        return true;
+    }
+
+    bool contains(quint16 tag) const { return _entries.contains(tag); }
+
+    QList<double> values(quint16 tag) const
+    {
+        QList<double> result;
+        const auto it = _entries.constFind(tag);
+        if (it == _entries.cend()) {
+            return result;
+        }
+
+        const Entry &entry = it.value();
+        result.reserve(entry.count);
+        const uchar *const start = _data + entry.offset;
+        for (quint32 i = 0; i < entry.count; i++) {
+            switch (entry.type) {
+            case 1:
+                result.append(start[i]);
+                break;
+            case 3:
+                result.append(_bigEndian ? qFromBigEndian<quint16>(start + (i * 2)) : qFromLittleEndian<quint16>(start + (i * 2)));
+                break;
+            case 4:
+                result.append(_bigEndian ? qFromBigEndian<quint32>(start + (i * 4)) : qFromLittleEndian<quint32>(start + (i * 4)));
+                break;
+            case 11:
+            {
+                const quint32 bits = _bigEndian ? qFromBigEndian<quint32>(start + (i * 4)) : qFromLittleEndian<quint32>(start + (i * 4));
+                float value;
+                (void) memcpy(&value, &bits, sizeof(value));
+                result.append(value);
+                break;
+            }
+            case 12:
+            {
+                const quint64 bits = _bigEndian ? qFromBigEndian<quint64>(start + (i * 8)) : qFromLittleEndian<quint64>(start + (i * 8));
+                double value;
+                (void) memcpy(&value, &bits, sizeof(value));
+                result.append(value);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    double value(quint16 tag, double defaultValue) const
+    {
+        const QList<double> tagValues = values(tag);
+        return tagValues.isEmpty() ? defaultValue : tagValues.first();
+    }
+
+    QString string(quint16 tag) const
+    {
+        const auto it = _entries.constFind(tag);
+        if ((it == _entries.cend()) || (it->type != 2)) {
+            return QString();
+        }
+        return QString::fromLatin1(reinterpret_cast<const char*>(_data + it->offset), it->count).trimmed().remove(QChar('\0'));
+    }
+
+private:
+    struct Entry {
+        quint16 type = 0;
+        quint32 count = 0;
+        qint64 offset = 0;
+    };
+
+    static int _typeSize(quint16 type)
+    {
+        switch (type) {
+        case 1:     // BYTE
+        case 2:     // ASCII
+            return 1;
+        case 3:     // SHORT
+            return 2;
+        case 4:     // LONG
+        case 11:    // FLOAT
+            return 4;
+        case 12:    // DOUBLE
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    const uchar *_data;
+    qint64 _size;
+    bool _bigEndian;
+    QHash<quint16, Entry> _entries;
+};
+
+} // namespace
+
+TerrainDEMFile::~TerrainDEMFile()
+{
+    close();
+}
+
+bool TerrainDEMFile::isSupportedFile(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix().toLower();
+    return ((suffix == QStringLiteral("hgt")) || (suffix == QStringLiteral("tif")) || (suffix == QStringLiteral("tiff")));
+}
+
+bool TerrainDEMFile::open(const QString &fileName)
+{
+    close();
+    _errorString.clear();
+
+    if (!isSupportedFile(fileName)) {
+        return _setError(QStringLiteral("Unsupported file type"));
+    }
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return _setError(_file.errorString());
+    }
+
+    _size = _file.size();
+    _data = (_size > 0) ? _file.map(0, _size) : nullptr;
+    if (!_data) {
+        return _setError((_size > 0) ? _file.errorString() : QStringLiteral("File is empty"));
+    }
+
+    const bool ok = (QFileInfo(fileName).suffix().toLower() == QStringLiteral("hgt")) ? _openHGT() : _openGeoTIFF();
+    if (!ok) {
+        return false;
+    }
+
+    _setExtent();
+
+    qCDebug(TerrainDEMFileLog) << fileName << _width << "x" << _height
+                               << "south" << _south << "west" << _west << "north" << _north << "east" << _east
+                               << "resolution" << resolution();
+
+    return true;
+}
+
+void TerrainDEMFile::close()
+{
+    if (_data) {
+        (void) _file.unmap(_data);
+        _data = nullptr;
+    }
+    if (_file.isOpen()) {
+        _file.close();
+    }
+
+    _size = 0;
+    _format = Format::Invalid;
+    _width = 0;
+    _height = 0;
+    _blockOffsets.clear();
+    _hasNoData = false;
+}
+
+bool TerrainDEMFile::_setError(const QString &errorString)
+{
+    _errorString = errorString;
+    qCWarning(TerrainDEMFileLog) << _file.fileName() << errorString;
+    close();
+    return false;
+}
+
+bool TerrainDEMFile::_openHGT()
+{
+    // SRTM tiles are named after the south west corner of the one degree cell they cover
+    static const QRegularExpression nameRegExp(QStringLiteral("^([NS])(\\d{2})([EW])(\\d{3})$"), QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch match = nameRegExp.match(QFileInfo(_file.fileName()).completeBaseName());
+    if (!match.hasMatch()) {
+        return _setError(QStringLiteral("HGT file name does not give its position"));
+    }
+
+    // Square grid of big endian int16, 1201 samples for 3 arc-second and 3601 for 1 arc-second data
+    const int samples = static_cast<int>(std::lround(std::sqrt(static_cast<double>(_size / 2))));
+    if ((samples < 2) || ((static_cast<qint64>(samples) * samples * 2) != _size)) {
+        return _setError(QStringLiteral("HGT file size is not a square grid"));
+    }
+
+    const int latitude = match.captured(2).toInt() * ((match.captured(1).toUpper() == QStringLiteral("S")) ? -1 : 1);
+    const int longitude = match.captured(4).toInt() * ((match.captured(3).toUpper() == QStringLiteral("W")) ? -1 : 1);
+
+    _width = samples;
+    _height = samples;
+    _latSpacing = 1.0 / (samples - 1);
+    _lonSpacing = _latSpacing;
+    _rowZeroLatitude = latitude + 1.0;
+    _columnZeroLongitude = longitude;
+
+    _sampleType = SampleType::Int16;
+    _bigEndian = true;
+    _blockWidth = samples;
+    _blockHeight = samples;
+    _blocksAcross = 1;
+    _blockOffsets = { 0 };
+
+    _hasNoData = true;
+    _noData = kHGTVoid;
+
+    _format = Format::HGT;
+    return true;
+}
+
+bool TerrainDEMFile::_openGeoTIFF()
+{
+    if (_size < 8) {
+        return _setError(QStringLiteral("Not a TIFF file"));
+    }
+
+    bool bigEndian = false;
+    if ((_data[0] == 'I') && (_data[1] == 'I')) {
+        bigEndian = false;
+    } else if ((_data[0] == 'M') && (_data[1] == 'M')) {
+        bigEndian = true;
+    } else {
+        return _setError(QStringLiteral("Not a TIFF file"));
+    }
+
+    TiffReader reader(_data, _size, bigEndian);
+    quint16 magic = 0;
+    quint32 ifdOffset = 0;
+    (void) reader.readU16(2, magic);
+    if (magic != 42) {
+        return _setError((magic == 43) ? QStringLiteral("BigTIFF is not supported") : QStringLiteral("Not a TIFF file"));
+    }
+    if (!reader.readU32(4, ifdOffset) || !reader.readIFD(ifdOffset)) {
+        return _setError(QStringLiteral("Invalid TIFF directory"));
+    }
+
+    // Samples are read in place, so only uncompressed single band data can be used
+    if (reader.value(kTagCompression, 1) != 1) {
+        return _setError(QStringLiteral("Compressed GeoTIFF is not supported"));
+    }
+    if (reader.value(kTagSamplesPerPixel, 1) != 1) {
+        return _setError(QStringLiteral("GeoTIFF must have a single band"));
+    }
+
+    const double bitsPerSample = reader.value(kTagBitsPerSample, 1);
+    const double sampleFormat = reader.value(kTagSampleFormat, kSampleFormatUInt);
+    if ((bitsPerSample == 16) && (sampleFormat == kSampleFormatInt)) {
+        _sampleType = SampleType::Int16;
+    } else if ((bitsPerSample == 16) && (sampleFormat == kSampleFormatUInt)) {
+        _sampleType = SampleType::UInt16;
+    } else if ((bitsPerSample == 32) && (sampleFormat == kSampleFormatFloat)) {
+        _sampleType = SampleType::Float32;
+    } else {
+        return _setError(QStringLiteral("Unsupported sample type, bits %1 format %2").arg(bitsPerSample).arg(sampleFormat));
+    }
+    _bigEndian = bigEndian;
+
+    // Sizes are checked in qint64 so that neither the int members nor the products below can overflow
+    const qint64 sampleBytes = (_sampleType == SampleType::Float32) ? 4 : 2;
+    if (!toDimension(reader.value(kTagImageWidth, 0), _width) || !toDimension(reader.value(kTagImageLength, 0), _height)) {
+        return _setError(QStringLiteral("Invalid image size"));
+    }
+    const qint64 rowBytes = static_cast<qint64>(_width) * sampleBytes;
+    if ((rowBytes > _size) || (_height > (_size / rowBytes))) {
+        return _setError(QStringLiteral("Image size exceeds the file size"));
+    }
+
+    const bool tiled = reader.contains(kTagTileOffsets);
+    QList<double> offsets;
+    QList<double> byteCounts;
+    bool blockSizeOk = false;
+    if (tiled) {
+        blockSizeOk = toDimension(reader.value(kTagTileWidth, 0), _blockWidth) && toDimension(reader.value(kTagTileLength, 0), _blockHeight);
+        offsets = reader.values(kTagTileOffsets);
+        byteCounts = reader.values(kTagTileByteCounts);
+    } else {
+        _blockWidth = _width;
+        blockSizeOk = toDimension(qMin<double>(_height, reader.value(kTagRowsPerStrip, _height)), _blockHeight);
+        offsets = reader.values(kTagStripOffsets);
+        byteCounts = reader.values(kTagStripByteCounts);
+    }
+    if (!blockSizeOk) {
+        return _setError(QStringLiteral("Invalid strip or tile size"));
+    }
+
+    // A single block may not need more bytes than the file holds
+    const qint64 blockRowBytes = static_cast<qint64>(_blockWidth) * sampleBytes;
+    if ((blockRowBytes > _size) || (_blockHeight > (_size / blockRowBytes))) {
+        return _setError(QStringLiteral("Strip or tile size exceeds the file size"));
+    }
+
+    const qint64 blocksAcross = (static_cast<qint64>(_width) + _blockWidth - 1) / _blockWidth;
+    const qint64 blocksDown = (static_cast<qint64>(_height) + _blockHeight - 1) / _blockHeight;
+    const qint64 blockCount = blocksAcross * blocksDown;
+    if ((offsets.size() != blockCount) || (byteCounts.size() != blockCount)) {
+        return _setError(QStringLiteral("Strip or tile offsets do not match the image size"));
+    }
+    _blocksAcross = static_cast<int>(blocksAcross);
+
+    // Every block must be in the file, the last strip may hold fewer rows
+    _blockOffsets.reserve(blockCount);
+    for (qsizetype i = 0; i < blockCount; i++) {
+        qint64 offset = 0;
+        qint64 byteCount = 0;
+        if (!toFileOffset(offsets.at(i), _size, offset) || !toFileOffset(byteCounts.at(i), _size, byteCount)) {
+            return _setError(QStringLiteral("Strip or tile %1 is outside the file").arg(i));
+        }
+        const qint64 blockRow = i / blocksAcross;
+        const qint64 rows = tiled ? _blockHeight : qMin<qint64>(_blockHeight, _height - (blockRow * _blockHeight));
+        const qint64 requiredBytes = rows * blockRowBytes;
+        if ((byteCount < requiredBytes) || (requiredBytes > (_size - offset))) {
+            return _setError(QStringLiteral("Strip or tile %1 is outside the file").arg(i));
+        }
+        _blockOffsets.append(offset);
+    }
+
+    // Georeferencing: one tie point plus pixel scale in a geographic model
+    const QList<double> tiepoint = reader.values(kTagModelTiepoint);
+    const QList<double> pixelScale = reader.values(kTagModelPixelScale);
+    if ((tiepoint.size() < 6) || (pixelScale.size() < 2) || !(pixelScale.at(0) > 0.0) || !(pixelScale.at(1) > 0.0)
+        || !std::isfinite(pixelScale.at(0)) || !std::isfinite(pixelScale.at(1))
+        || !std::isfinite(tiepoint.at(0)) || !std::isfinite(tiepoint.at(1)) || !std::isfinite(tiepoint.at(3)) || !std::isfinite(tiepoint.at(4))) {
+        return _setError(QStringLiteral("GeoTIFF tie point or pixel scale missing"));
+    }
+
+    bool pixelIsPoint = false;
+    const QList<double> geoKeys = reader.values(kTagGeoKeyDirectory);
+    for (qsizetype i = 4; (i + 3) < geoKeys.size(); i += 4) {
+        const double keyId = geoKeys.at(i);
+        const bool inlineValue = (geoKeys.at(i + 1) == 0);
+        const double value = geoKeys.at(i + 3);
+        if ((keyId == kGeoKeyModelType) && inlineValue && (value != kModelTypeGeographic)) {
+            return _setError(QStringLiteral("Only GeoTIFF in geographic coordinates is supported"));
+        }
+        if ((keyId == kGeoKeyRasterType) && inlineValue) {
+            pixelIsPoint = (value == kRasterPixelIsPoint);
+        }
+    }
+
+    // The tie point gives the model position of a raster position, raster positions are pixel corners unless pixel is point
+    const double pixelCenter = pixelIsPoint ? 0.0 : 0.5;
+    _lonSpacing = pixelScale.at(0);
+    _latSpacing = pixelScale.at(1);
+    _columnZeroLongitude = tiepoint.at(3) + ((pixelCenter - tiepoint.at(0)) * _lonSpacing);
+    _rowZeroLatitude = tiepoint.at(4) - ((pixelCenter - tiepoint.at(1)) * _latSpacing);
+
+    const QString noData = reader.string(kTagGDALNoData);
+    if (!noData.isEmpty()) {
+        _noData = noData.toDouble(&_hasNoData);
+    }
+
+    _format = Format::GeoTIFF;
+    return true;
+}
+
+void TerrainDEMFile::_setExtent()
+{
+    _north = _rowZeroLatitude + (_latSpacing / 2);
+    _south = _rowZeroLatitude - ((_height - 1) * _latSpacing) - (_latSpacing / 2);
+    _west = _columnZeroLongitude - (_lonSpacing / 2);
+    _east = _columnZeroLongitude + ((_width - 1) * _lonSpacing) + (_lonSpacing / 2);
+}
+
+double TerrainDEMFile::elevation(double latitude, double longitude) const
+{
+    if ((_format == Format::Invalid) || (latitude < _south) || (latitude > _north) || (longitude < _west) || (longitude > _east)) {
+        return qQNaN();
+    }
+
+    const int row = qBound(0, static_cast<int>(std::lround((_rowZeroLatitude - latitude) / _latSpacing)), _height - 1);
+    const int column = qBound(0, static_cast<int>(std::lround((longitude - _columnZeroLongitude) / _lonSpacing)), _width - 1);
+
+    return _sample(row, column);
+}
+
+double TerrainDEMFile::_sample(int row, int column) const
+{
+    const qsizetype block = static_cast<qsizetype>(row / _blockHeight) * _blocksAcross + (column / _blockWidth);
+    const qint64 index = (static_cast<qint64>(row % _blockHeight) * _blockWidth) + (column % _blockWidth);
+
+    double value;
+    switch (_sampleType) {
+    case SampleType::Int16:
+    {
+        const uchar *const sample = _data + _blockOffsets.at(block) + (index * 2);
+        value = static_cast<int16_t>(_bigEndian ? qFromBigEndian<quint16>(sample) : qFromLittleEndian<quint16>(sample));
+        break;
+    }
+    case SampleType::UInt16:
+    {
+        const uchar *const sample = _data + _blockOffsets.at(block) + (index * 2);
+        value = _bigEndian ? qFromBigEndian<quint16>(sample) : qFromLittleEndian<quint16>(sample);
+        break;
+    }
+    case SampleType::Float32:
+    default:
+    {
+        const uchar *const sample = _data + _blockOffsets.at(block) + (index * 4);
+        const quint32 bits = _bigEndian ? qFromBigEndian<quint32>(sample) : qFromLittleEndian<quint32>(sample);
+        float floatValue;
+        (void) memcpy(&floatValue, &bits, sizeof(floatValue));
+        value = floatValue;
+        break;
+    }
+    }
+
+    if (_hasNoData && (value == _noData)) {
+        return qQNaN();
+    }
+
+    return value;
+}
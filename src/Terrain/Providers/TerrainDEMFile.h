@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainDEMFileLog)
+
+/// Memory mapped digital elevation model file.
+/// Supported are SRTM .hgt files (1 or 3 arc-second, named after their south west corner such as N37W122.hgt)
+/// and uncompressed, single band GeoTIFF in geographic coordinates with 16 bit integer or 32 bit float samples,
+/// in strips or tiles. Nothing is decoded up front, a lookup reads the nearest sample straight from the mapping.
+class TerrainDEMFile
+{
+public:
+    enum class Format {
+        Invalid,
+        HGT,
+        GeoTIFF
+    };
+
+    TerrainDEMFile() = default;
+    ~TerrainDEMFile();
+
+    TerrainDEMFile(const TerrainDEMFile&) = delete;
+    TerrainDEMFile &operator=(const TerrainDEMFile&) = delete;
+
+    /// Maps the file and reads its layout, the format is taken from the file extension
+    ///     @return false on failure, see errorString()
+    bool open(const QString &fileName);
+    void close();
+
+    bool isValid() const { return (_format != Format::Invalid); }
+    Format format() const { return _format; }
+    QString fileName() const { return _file.fileName(); }
+    QString errorString() const { return _errorString; }
+
+    /// Extent covered by the samples in degrees, half a sample spacing beyond the outer sample centers
+    double south() const { return _south; }
+    double west() const { return _west; }
+    double north() const { return _north; }
+    double east() const { return _east; }
+    /// Larger of the latitude and longitude sample spacing in degrees
+    double resolution() const { return qMax(_latSpacing, _lonSpacing); }
+
+    /// @return Elevation of the sample nearest to the coordinate, NaN outside the file or for a void sample
+    double elevation(double latitude, double longitude) const;
+
+    static bool isSupportedFile(const QString &fileName);
+
+    static constexpr int16_t kHGTVoid = -32768;
+
+private:
+    enum class SampleType {
+        Int16,
+        UInt16,
+        Float32
+    };
+
+    bool _openHGT();
+    bool _openGeoTIFF();
+    void _setExtent();
+    bool _setError(const QString &errorString);
+    double _sample(int row, int column) const;
+
+    QFile _file;
+    uchar *_data = nullptr;
+    qint64 _size = 0;
+    QString _errorString;
+    Format _format = Format::Invalid;
+
+    // Sample grid, row 0 is the northern most row
+    int _width = 0;
+    int _height = 0;
+    double _rowZeroLatitude = 0.0;      ///< Latitude of the centers of row 0
+    double _columnZeroLongitude = 0.0;  ///< Longitude of the centers of column 0
+    double _latSpacing = 0.0;
+    double _lonSpacing = 0.0;
+    double _south = 0.0;
+    double _west = 0.0;
+    double _north = 0.0;
+    double _east = 0.0;
+
+    // Samples are stored in blocks: a strip is a block as wide as the image
+    SampleType _sampleType = SampleType::Int16;
+    bool _bigEndian = false;
+    int _blockWidth = 0;
+    int _blockHeight = 0;
+    int _blocksAcross = 0;
+    QList<qint64> _blockOffsets;
+
+    bool _hasNoData = false;
+    double _noData = 0.0;
+};
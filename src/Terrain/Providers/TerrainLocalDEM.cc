@@ -0,0 +1,133 @@
+#include "TerrainLocalDEM.h"
+#include "TerrainDEMFile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtNumeric>
+#include <QtPositioning/QGeoCoordinate>
+
+#include <algorithm>
+#include <cmath>
+
+QGC_LOGGING_CATEGORY(TerrainLocalDEMLog, "Terrain.TerrainLocalDEM")
+
+namespace {
+
+constexpr double kMinCellLatitude = -90.0;
+constexpr double kMaxCellLatitude = 89.0;
+constexpr double kMinCellLongitude = -180.0;
+constexpr double kMaxCellLongitude = 179.0;
+constexpr int kCellRows = 180;
+constexpr int kCellColumns = 360;
+
+} // namespace
+
+TerrainLocalDEM::TerrainLocalDEM()
+{
+}
+
+TerrainLocalDEM::~TerrainLocalDEM()
+{
+}
+
+int TerrainLocalDEM::cellKey(double latitude, double longitude)
+{
+    // Latitude 90 and longitude 180 are the far edges of the last row and column, not cells of their own
+    const int row = static_cast<int>(std::clamp(std::floor(latitude + 90.0), 0.0, kCellRows - 1.0));
+    const int column = static_cast<int>(std::clamp(std::floor(longitude + 180.0), 0.0, kCellColumns - 1.0));
+    return ((row * kCellColumns) + column);
+}
+
+int TerrainLocalDEM::load(const QString &directory)
+{
+    clear();
+    _directory = directory;
+
+    if (directory.isEmpty()) {
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const QDir dir(directory);
+    const QStringList fileNames = dir.entryList(QDir::Files | QDir::Readable, QDir::Name);
+    for (const QString &fileName : fileNames) {
+        if (!TerrainDEMFile::isSupportedFile(fileName)) {
+            continue;
+        }
+
+        auto file = std::make_unique<TerrainDEMFile>();
+        if (!file->open(dir.filePath(fileName))) {
+            qCWarning(TerrainLocalDEMLog) << "Skipping" << fileName << file->errorString();
+            continue;
+        }
+        if (!(file->south() <= 90.0) || !(file->north() >= -90.0) || !(file->west() <= 180.0) || !(file->east() >= -180.0)) {
+            qCWarning(TerrainLocalDEMLog) << "Skipping" << fileName << "extent is outside of the globe";
+            continue;
+        }
+        _files.push_back(std::move(file));
+    }
+
+    for (int i = 0; i < static_cast<int>(_files.size()); i++) {
+        const TerrainDEMFile *const file = _files[i].get();
+        // Cells are clamped to the globe, which also bounds the loop for files with a bogus extent
+        const int southCell = static_cast<int>(std::clamp(std::floor(file->south()), kMinCellLatitude, kMaxCellLatitude));
+        const int northCell = static_cast<int>(std::clamp(std::floor(file->north()), kMinCellLatitude, kMaxCellLatitude));
+        const int westCell = static_cast<int>(std::clamp(std::floor(file->west()), kMinCellLongitude, kMaxCellLongitude));
+        const int eastCell = static_cast<int>(std::clamp(std::floor(file->east()), kMinCellLongitude, kMaxCellLongitude));
+        for (int lat = southCell; lat <= northCell; lat++) {
+            for (int lon = westCell; lon <= eastCell; lon++) {
+                _cells[cellKey(lat, lon)].append(i);
+            }
+        }
+    }
+
+    for (QList<int> &cellFiles : _cells) {
+        std::stable_sort(cellFiles.begin(), cellFiles.end(), [this](int a, int b) {
+            return (_files[a]->resolution() < _files[b]->resolution());
+        });
+    }
+
+    qCDebug(TerrainLocalDEMLog) << directory << "files" << _files.size() << "cells" << _cells.size() << "loaded in" << timer.elapsed() << "ms";
+
+    return static_cast<int>(_files.size());
+}
+
+void TerrainLocalDEM::clear()
+{
+    _cells.clear();
+    _files.clear();
+    _directory.clear();
+    _lastCellKey = -1;
+    _lastCellFiles = nullptr;
+}
+
+double TerrainLocalDEM::elevation(const QGeoCoordinate &coordinate) const
+{
+    return elevation(coordinate.latitude(), coordinate.longitude());
+}
+
+double TerrainLocalDEM::elevation(double latitude, double longitude) const
+{
+    const int key = cellKey(latitude, longitude);
+    if (key != _lastCellKey) {
+        const auto it = _cells.constFind(key);
+        _lastCellKey = key;
+        _lastCellFiles = (it != _cells.cend()) ? &it.value() : nullptr;
+    }
+
+    if (!_lastCellFiles) {
+        return qQNaN();
+    }
+
+    for (const int fileIndex : *_lastCellFiles) {
+        const double elevation = _files[fileIndex]->elevation(latitude, longitude);
+        if (!qIsNaN(elevation)) {
+            return elevation;
+        }
+    }
+
+    return qQNaN();
+}
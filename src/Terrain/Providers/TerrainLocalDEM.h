@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+#include <memory>
+#include <vector>
+
+class QGeoCoordinate;
+class TerrainDEMFile;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainLocalDEMLog)
+
+/// Elevation from a directory of DEM files (see TerrainDEMFile), for flying without connectivity.
+/// Files are memory mapped when the directory is loaded and indexed by the one degree cells they cover,
+/// so a lookup is a hash of the cell number plus a read from the mapping. Where files overlap the finest
+/// resolution wins, falling back to coarser files for voids. Lookups are synchronous.
+/// Not thread safe, used from the main thread by TerrainTileManager.
+class TerrainLocalDEM
+{
+public:
+    TerrainLocalDEM();
+    ~TerrainLocalDEM();
+
+    /// Replaces the loaded files with the supported files in @a directory, sub directories are not searched
+    ///     @return Number of files loaded
+    int load(const QString &directory);
+    void clear();
+
+    QString directory() const { return _directory; }
+    qsizetype fileCount() const { return static_cast<qsizetype>(_files.size()); }
+
+    /// @return Elevation in meters, NaN where no file has data
+    double elevation(double latitude, double longitude) const;
+    double elevation(const QGeoCoordinate &coordinate) const;
+
+    /// @return Index key of the one degree cell holding the coordinate
+    static int cellKey(double latitude, double longitude);
+
+private:
+    std::vector<std::unique_ptr<TerrainDEMFile>> _files;
+    QHash<int, QList<int>> _cells;                          ///< Cell key to file indices, finest resolution first
+    QString _directory;
+    // Neighbouring lookups mostly fall in the same cell, which then needs no hash lookup
+    mutable int _lastCellKey = -1;
+    mutable const QList<int> *_lastCellFiles = nullptr;
+};
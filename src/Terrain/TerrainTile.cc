@@ -4,6 +4,9 @@
 #include <QtCore/QtNumeric>
 #include <QtPositioning/QGeoCoordinate>
 
+#include <algorithm>
+#include <cstring>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "Terrain.terraintile");
 
 TerrainTile::TerrainTile(const QByteArray &byteArray)
@@ -51,18 +54,9 @@ TerrainTile::TerrainTile(const QByteArray &byteArray)
     qCDebug(TerrainTileLog) << this << "TileInfo: min, max, avg:" << _tileInfo.minElevation << _tileInfo.maxElevation << _tileInfo.avgElevation;
     qCDebug(TerrainTileLog) << this << "TileInfo: cell size:" << _cellSizeLat << _cellSizeLon;
 
-    _elevationData.resize(_tileInfo.gridSizeLat);
-    for (int k = 0; k < _tileInfo.gridSizeLat; k++) {
-        _elevationData[k].resize(_tileInfo.gridSizeLon);
-    }
-
-    int valueIndex = 0;
-    const int16_t* const pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _tileInfo.gridSizeLat; i++) {
-        for (int j = 0; j < _tileInfo.gridSizeLon; j++) {
-            _elevationData[i][j] = pTileData[valueIndex++];
-        }
-    }
+    // Row-major, one allocation for the whole grid. The source may not be aligned for int16_t.
+    _elevationData.resize(static_cast<qsizetype>(_tileInfo.gridSizeLat) * _tileInfo.gridSizeLon);
+    (void) memcpy(_elevationData.data(), byteArray.constData() + cTileHeaderBytes, cTileDataBytes);
 
     _isValid = true;
 }
@@ -93,14 +87,7 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
         return qQNaN();
     }
 
-    if ((latIndex >= _elevationData.size()) || (lonIndex >= _elevationData[latIndex].size())) {
-        qCWarning(TerrainTileLog).noquote() << this << "Internal error: _elevationData size inconsistent _tileInfo << coordinate" << coordinate
-            << "\n\t_tileInfo.gridSizeLat:" << _tileInfo.gridSizeLat << "_tileInfo.gridSizeLon:" << _tileInfo.gridSizeLon
-            << "\n\t_data.size():" << _elevationData.size() << "_elevationData[latIndex].size():" << _elevationData[latIndex].size();
-        return qQNaN();
-    }
-
-    const int16_t elevation = _elevationData[latIndex][lonIndex];
+    const int16_t elevation = _elevationData[(latIndex * _tileInfo.gridSizeLon) + lonIndex];
     if (elevation < _tileInfo.minElevation) {
         qCWarning(TerrainTileLog) << this << "Warning: elevation read is below min elevation in tile:" << elevation << "<" << _tileInfo.minElevation;
     } else if (elevation > _tileInfo.maxElevation) {
@@ -111,3 +98,66 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
 
     return static_cast<double>(elevation);
 }
+
+qsizetype TerrainTile::sampleBilinear(const double *latitudes, const double *longitudes, qsizetype count, double *elevations,
+                                      double &minElevation, double &maxElevation) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << this << "Request for elevation, but tile is invalid.";
+        std::fill(elevations, elevations + count, qQNaN());
+        return count;
+    }
+
+    const int16_t *const data = _elevationData.constData();
+    const int gridSizeLon = _tileInfo.gridSizeLon;
+    const int lastRow = _tileInfo.gridSizeLat - 1;
+    const int lastColumn = gridSizeLon - 1;
+
+    // Sample positions are measured from the center of the south west cell
+    const double latScale = 1.0 / _cellSizeLat;
+    const double lonScale = 1.0 / _cellSizeLon;
+    const double rowOffset = (_tileInfo.swLat * latScale) + 0.5;
+    const double columnOffset = (_tileInfo.swLon * lonScale) + 0.5;
+
+    const double southLimit = _tileInfo.swLat - _cellSizeLat;
+    const double northLimit = _tileInfo.neLat + _cellSizeLat;
+    const double westLimit = _tileInfo.swLon - _cellSizeLon;
+    const double eastLimit = _tileInfo.neLon + _cellSizeLon;
+
+    double minValue = minElevation;
+    double maxValue = maxElevation;
+    qsizetype outside = 0;
+
+    for (qsizetype i = 0; i < count; i++) {
+        const double latitude = latitudes[i];
+        const double longitude = longitudes[i];
+
+        const double row = std::clamp((latitude * latScale) - rowOffset, 0.0, static_cast<double>(lastRow));
+        const double column = std::clamp((longitude * lonScale) - columnOffset, 0.0, static_cast<double>(lastColumn));
+        const int row0 = static_cast<int>(row);
+        const int column0 = static_cast<int>(column);
+        const int row1 = std::min(row0 + 1, lastRow);
+        const int column1 = std::min(column0 + 1, lastColumn);
+        const double rowFraction = row - row0;
+        const double columnFraction = column - column0;
+
+        const double southWest = data[(row0 * gridSizeLon) + column0];
+        const double southEast = data[(row0 * gridSizeLon) + column1];
+        const double northWest = data[(row1 * gridSizeLon) + column0];
+        const double northEast = data[(row1 * gridSizeLon) + column1];
+        const double south = southWest + ((southEast - southWest) * columnFraction);
+        const double north = northWest + ((northEast - northWest) * columnFraction);
+        const double elevation = south + ((north - south) * rowFraction);
+
+        const bool inside = (latitude >= southLimit) & (latitude <= northLimit) & (longitude >= westLimit) & (longitude <= eastLimit);
+        elevations[i] = inside ? elevation : qQNaN();
+        minValue = std::min(minValue, inside ? elevation : minValue);
+        maxValue = std::max(maxValue, inside ? elevation : maxValue);
+        outside += inside ? 0 : 1;
+    }
+
+    minElevation = minValue;
+    maxElevation = maxValue;
+
+    return outside;
+}
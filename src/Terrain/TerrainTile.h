@@ -27,6 +27,16 @@ class TerrainTile
     ///    @return elevation
     double elevation(const QGeoCoordinate &coordinate) const;
 
+    /// Bilinearly interpolates the elevation at a batch of coordinates given as packed latitude and longitude arrays.
+    /// Interpolates between the cell centers and clamps to the edge cells, so coordinates within a cell of the tile
+    /// are still sampled. The loop is branch free and does not log, so the compiler can vectorise it.
+    ///    @param latitudes, longitudes @a count coordinates
+    ///    @param[out] elevations @a count elevations, NaN for coordinates outside the tile
+    ///    @param[in,out] minElevation, maxElevation Widened to include the sampled elevations
+    ///    @return number of coordinates outside the tile
+    qsizetype sampleBilinear(const double *latitudes, const double *longitudes, qsizetype count, double *elevations,
+                             double &minElevation, double &maxElevation) const;
+
     /// Accessor for the minimum elevation of the tile
     ///    @return minimum elevation
     double minElevation() const { return (_isValid ? static_cast<double>(_tileInfo.minElevation) : qQNaN()); }
@@ -39,6 +49,10 @@ class TerrainTile
     ///    @return average elevation
     double avgElevation() const { return (_isValid ? _tileInfo.avgElevation : qQNaN()); }
 
+    /// Approximate heap and object size of the tile, for cache accounting
+    ///    @return size in bytes
+    qint64 memoryUsage() const { return static_cast<qint64>(sizeof(*this)) + (_elevationData.capacity() * static_cast<qint64>(sizeof(int16_t))); }
+
 protected:
     struct TileInfo_t {
         double  swLat, swLon, neLat, neLon;
@@ -49,7 +63,7 @@ class TerrainTile
 
 private:
     TileInfo_t _tileInfo{};
-    QList<QList<int16_t>> _elevationData;   ///< 2D elevation data array
+    QList<int16_t> _elevationData;          ///< Row-major elevation grid, gridSizeLat rows of gridSizeLon values
     double _cellSizeLat = 0.0;              ///< data grid size in latitude direction
     double _cellSizeLon = 0.0;              ///< data grid size in longitude direction
     bool _isValid = false;                  ///< data loaded is valid
@@ -0,0 +1,135 @@
+#include "TerrainTileCache.h"
+#include "TerrainTile.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(TerrainTileCacheLog, "Terrain.TerrainTileCache")
+
+TerrainTileCache::TerrainTileCache(qint64 maxBytes)
+    : _maxBytes(qMax<qint64>(0, maxBytes))
+{
+}
+
+TerrainTileCache::~TerrainTileCache()
+{
+    qCDebug(TerrainTileCacheLog) << "tiles" << _entries.size() << "bytes" << _bytes
+                                 << "hits" << _hits << "misses" << _misses << "evictions" << _evictions;
+}
+
+std::shared_ptr<const TerrainTile> TerrainTileCache::find(quint64 key)
+{
+    QMutexLocker locker(&_mutex);
+
+    const auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        _misses++;
+        return nullptr;
+    }
+
+    _hits++;
+    _lru.splice(_lru.begin(), _lru, it->lruPosition);
+    return it->tile;
+}
+
+bool TerrainTileCache::contains(quint64 key) const
+{
+    QMutexLocker locker(&_mutex);
+    return _entries.contains(key);
+}
+
+void TerrainTileCache::insert(quint64 key, std::shared_ptr<const TerrainTile> tile)
+{
+    if (!tile) {
+        return;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    const qint64 tileBytes = tile->memoryUsage();
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        _bytes -= it->bytes;
+        it->tile = std::move(tile);
+        it->bytes = tileBytes;
+        _lru.splice(_lru.begin(), _lru, it->lruPosition);
+    } else {
+        _lru.push_front(key);
+        (void) _entries.insert(key, { std::move(tile), tileBytes, _lru.begin() });
+    }
+    _bytes += tileBytes;
+
+    _evict(key);
+}
+
+void TerrainTileCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _entries.clear();
+    _lru.clear();
+    _bytes = 0;
+}
+
+qint64 TerrainTileCache::maxBytes() const
+{
+    QMutexLocker locker(&_mutex);
+    return _maxBytes;
+}
+
+void TerrainTileCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&_mutex);
+    _maxBytes = qMax<qint64>(0, maxBytes);
+    _evict(_lru.empty() ? 0 : _lru.front());
+}
+
+qint64 TerrainTileCache::bytes() const
+{
+    QMutexLocker locker(&_mutex);
+    return _bytes;
+}
+
+qsizetype TerrainTileCache::count() const
+{
+    QMutexLocker locker(&_mutex);
+    return _entries.size();
+}
+
+quint64 TerrainTileCache::hits() const
+{
+    QMutexLocker locker(&_mutex);
+    return _hits;
+}
+
+quint64 TerrainTileCache::misses() const
+{
+    QMutexLocker locker(&_mutex);
+    return _misses;
+}
+
+quint64 TerrainTileCache::evictions() const
+{
+    QMutexLocker locker(&_mutex);
+    return _evictions;
+}
+
+void TerrainTileCache::resetStatistics()
+{
+    QMutexLocker locker(&_mutex);
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+}
+
+void TerrainTileCache::_evict(quint64 keepKey)
+{
+    while ((_bytes > _maxBytes) && !_lru.empty() && (_lru.back() != keepKey)) {
+        const quint64 key = _lru.back();
+        _lru.pop_back();
+
+        const auto it = _entries.constFind(key);
+        _bytes -= it->bytes;
+        _entries.erase(it);
+        _evictions++;
+
+        qCDebug(TerrainTileCacheLog) << "evicted" << Qt::hex << key << Qt::dec << "bytes" << _bytes;
+    }
+}
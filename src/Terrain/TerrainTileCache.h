@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+
+#include <list>
+#include <memory>
+
+class TerrainTile;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileCacheLog)
+
+/// In-memory cache of decoded elevation tiles for TerrainTileManager.
+/// Tiles are keyed by a 64 bit integer built from the provider map id and the tile x/y/zoom, so a lookup is a
+/// few shifts and an integer hash. The cache is bounded by the memory the tiles use, when it is over budget the
+/// least recently used tiles are evicted. Tiles are shared, a tile still in use by a lookup outlives its eviction.
+/// Thread safe.
+class TerrainTileCache
+{
+public:
+    explicit TerrainTileCache(qint64 maxBytes = kDefaultMaxBytes);
+    ~TerrainTileCache();
+
+    /// Key layout: map id 16 bits | zoom 8 bits | y 20 bits | x 20 bits
+    static constexpr quint64 key(int mapId, int x, int y, int zoom)
+    {
+        return ((static_cast<quint64>(mapId) & 0xFFFF) << 48) |
+               ((static_cast<quint64>(zoom) & 0xFF) << 40) |
+               ((static_cast<quint64>(y) & 0xFFFFF) << 20) |
+               (static_cast<quint64>(x) & 0xFFFFF);
+    }
+
+    /// @return The tile, nullptr if it is not cached. Marks the tile as most recently used.
+    std::shared_ptr<const TerrainTile> find(quint64 key);
+    /// @return true: the tile is cached. Does not count as a use.
+    bool contains(quint64 key) const;
+
+    /// Adds or replaces a tile and evicts least recently used tiles beyond the budget.
+    /// The tile just inserted is never evicted, even if it is larger than the budget on its own.
+    void insert(quint64 key, std::shared_ptr<const TerrainTile> tile);
+    void clear();
+
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+    qint64 bytes() const;
+    qsizetype count() const;
+
+    quint64 hits() const;
+    quint64 misses() const;
+    quint64 evictions() const;
+    void resetStatistics();
+
+    static constexpr qint64 kDefaultMaxBytes = 32 * 1024 * 1024;
+
+private:
+    struct Entry_t {
+        std::shared_ptr<const TerrainTile> tile;
+        qint64 bytes = 0;
+        std::list<quint64>::iterator lruPosition;
+    };
+
+    void _evict(quint64 keepKey);
+
+    mutable QMutex _mutex;
+    QHash<quint64, Entry_t> _entries;
+    std::list<quint64> _lru;                ///< Keys, most recently used first
+    qint64 _maxBytes = kDefaultMaxBytes;
+    qint64 _bytes = 0;
+
+    quint64 _hits = 0;
+    quint64 _misses = 0;
+    quint64 _evictions = 0;
+};
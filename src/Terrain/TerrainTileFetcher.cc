@@ -0,0 +1,102 @@
+#include "TerrainTileFetcher.h"
+#include "QGeoMapReplyQGC.h"
+#include "QGeoTileFetcherQGC.h"
+#include "QGCLoggingCategory.h"
+#include "QGCNetworkHelper.h"
+
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+
+QGC_LOGGING_CATEGORY(TerrainTileFetcherLog, "Terrain.TerrainTileFetcher")
+
+TerrainTileFetcher::TerrainTileFetcher(QObject *parent)
+    : QObject(parent)
+    , _networkManager(new QNetworkAccessManager(this))
+{
+    qCDebug(TerrainTileFetcherLog) << this;
+
+    QGCNetworkHelper::configureProxy(_networkManager);
+}
+
+TerrainTileFetcher::~TerrainTileFetcher()
+{
+    qCDebug(TerrainTileFetcherLog) << this;
+}
+
+void TerrainTileFetcher::setMaxConcurrentFetches(int maxConcurrentFetches)
+{
+    _maxConcurrentFetches = qMax(1, maxConcurrentFetches);
+    _startQueued();
+}
+
+void TerrainTileFetcher::fetch(const QString &hash, const QGeoTileSpec &spec)
+{
+    if (isPending(hash)) {
+        _duplicateRequests++;
+        return;
+    }
+
+    _queue.enqueue({ hash, spec });
+    (void) _queuedHashes.insert(hash);
+
+    qCDebug(TerrainTileFetcherLog) << "queued" << hash << "active" << _activeFetches.size() << "queued" << _queue.size();
+
+    _startQueued();
+}
+
+void TerrainTileFetcher::_startQueued()
+{
+    while ((_activeFetches.size() < _maxConcurrentFetches) && !_queue.isEmpty()) {
+        const QueuedFetch_t queuedFetch = _queue.dequeue();
+        (void) _queuedHashes.remove(queuedFetch.hash);
+        (void) _activeFetches.insert(queuedFetch.hash, queuedFetch.spec);
+
+        if (!_startFetch(queuedFetch.hash, queuedFetch.spec)) {
+            _fetchFinished(queuedFetch.hash, QByteArray(), tr("Unable to start terrain tile download"));
+        }
+    }
+}
+
+bool TerrainTileFetcher::_startFetch(const QString &hash, const QGeoTileSpec &spec)
+{
+    const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
+    QGeoTiledMapReplyQGC *const reply = new QGeoTiledMapReplyQGC(_networkManager, request, spec, this);
+    (void) connect(reply, &QGeoTiledMapReplyQGC::finished, this, [this, reply, hash]() {
+        reply->deleteLater();
+        if (reply->error() != QGeoTiledMapReplyQGC::NoError) {
+            _fetchFinished(hash, QByteArray(), reply->errorString());
+        } else if (reply->mapImageData().isEmpty()) {
+            _fetchFinished(hash, QByteArray(), tr("Empty response"));
+        } else {
+            _fetchFinished(hash, reply->mapImageData(), QString());
+        }
+    });
+
+    if (!reply->init()) {
+        reply->deleteLater();
+        return false;
+    }
+
+    return true;
+}
+
+void TerrainTileFetcher::_fetchFinished(const QString &hash, const QByteArray &data, const QString &errorString)
+{
+    const auto it = _activeFetches.constFind(hash);
+    if (it == _activeFetches.cend()) {
+        qCWarning(TerrainTileFetcherLog) << "Internal error: finished fetch was not active" << hash;
+        return;
+    }
+    const QGeoTileSpec spec = it.value();
+    _activeFetches.erase(it);
+
+    if (errorString.isEmpty()) {
+        qCDebug(TerrainTileFetcherLog) << "fetched" << hash << "bytes" << data.size();
+        emit tileFetched(hash, spec, data);
+    } else {
+        qCWarning(TerrainTileFetcherLog) << "Elevation tile fetching returned error:" << hash << errorString;
+        emit tileFailed(hash, errorString);
+    }
+
+    _startQueued();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QQueue>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtLocation/private/qgeotilespec_p.h>
+
+class QNetworkAccessManager;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileFetcherLog)
+
+/// Downloads elevation tiles for TerrainTileManager.
+/// Tiles are identified by their hash, a tile which is already queued or downloading is not requested again.
+/// At most maxConcurrentFetches() downloads run at once, further tiles wait in request order.
+class TerrainTileFetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TerrainTileFetcher(QObject *parent = nullptr);
+    ~TerrainTileFetcher();
+
+    /// Queues the download of a tile unless it is already queued or downloading
+    void fetch(const QString &hash, const QGeoTileSpec &spec);
+
+    /// @return true: the tile is queued or downloading
+    bool isPending(const QString &hash) const { return (_queuedHashes.contains(hash) || _activeFetches.contains(hash)); }
+
+    int maxConcurrentFetches() const { return _maxConcurrentFetches; }
+    void setMaxConcurrentFetches(int maxConcurrentFetches);
+
+    qsizetype activeFetches() const { return _activeFetches.size(); }
+    qsizetype queuedFetches() const { return _queue.size(); }
+    /// Requests for a tile which was already queued or downloading
+    quint64 duplicateRequests() const { return _duplicateRequests; }
+
+    static constexpr int kDefaultMaxConcurrentFetches = 4;
+
+signals:
+    void tileFetched(const QString &hash, const QGeoTileSpec &spec, const QByteArray &data);
+    void tileFailed(const QString &hash, const QString &errorString);
+
+protected:
+    /// Starts the download of a tile. The download must be completed by calling _fetchFinished.
+    /// The default implementation goes through the map tile cache and the elevation provider.
+    ///     @return false: the download could not be started
+    virtual bool _startFetch(const QString &hash, const QGeoTileSpec &spec);
+
+    /// Completes a download started by _startFetch
+    ///     @param errorString Empty on success
+    void _fetchFinished(const QString &hash, const QByteArray &data, const QString &errorString);
+
+private:
+    void _startQueued();
+
+    struct QueuedFetch_t {
+        QString hash;
+        QGeoTileSpec spec;
+    };
+
+    QQueue<QueuedFetch_t> _queue;
+    QSet<QString> _queuedHashes;
+    QHash<QString, QGeoTileSpec> _activeFetches;
+    int _maxConcurrentFetches = kDefaultMaxConcurrentFetches;
+    quint64 _duplicateRequests = 0;
+
+    QNetworkAccessManager *_networkManager = nullptr;
+};
@@ -1,22 +1,20 @@
 #include "TerrainTileManager.h"
 #include "TerrainTile.h"
 #include "TerrainTileCopernicus.h"
-#include "QGeoTileFetcherQGC.h"
-#include "QGeoMapReplyQGC.h"
+#include "TerrainTileFetcher.h"
 #include "QGCMapUrlEngine.h"
 #include "ElevationMapProvider.h"
 #include "SettingsManager.h"
 #include "FlightMapSettings.h"
+#include "MapsSettings.h"
+#include "AppSettings.h"
+#include "Fact.h"
 #include "QGCLoggingCategory.h"
 #include "QGCGeo.h"
 
-#include <QtLocation/private/qgeotilespec_p.h>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkRequest>
-
 #include <limits>
-
-#include "QGCNetworkHelper.h"
+#include <memory>
+#include <utility>
 
 QGC_LOGGING_CATEGORY(TerrainTileManagerLog, "Terrain.TerrainTileManager")
 
@@ -33,138 +31,309 @@ TerrainTileManager *TerrainTileManager::instance()
 
 TerrainTileManager::TerrainTileManager(QObject *parent)
     : QObject(parent)
-    , _networkManager(new QNetworkAccessManager(this))
 {
     qCDebug(TerrainTileManagerLog) << this;
 
-    QGCNetworkHelper::configureProxy(_networkManager);
+    setTileFetcher(new TerrainTileFetcher(this));
+
+    Fact *const maxCacheMemorySize = SettingsManager::instance()->mapsSettings()->maxTerrainCacheMemorySize();
+    (void) connect(maxCacheMemorySize, &Fact::rawValueChanged, this, &TerrainTileManager::_maxCacheMemorySizeChanged);
+    _maxCacheMemorySizeChanged();
+
+    (void) connect(SettingsManager::instance()->appSettings(), &AppSettings::savePathsChanged, this, &TerrainTileManager::_terrainSavePathChanged);
 }
 
 TerrainTileManager::~TerrainTileManager()
 {
-    qDeleteAll(_tiles);
-
     qCDebug(TerrainTileManagerLog) << this;
 }
 
+void TerrainTileManager::_maxCacheMemorySizeChanged()
+{
+    const qint64 maxBytes = SettingsManager::instance()->mapsSettings()->maxTerrainCacheMemorySize()->rawValue().toLongLong() * 1024 * 1024;
+    _tileCache.setMaxBytes(maxBytes);
+
+    qCDebug(TerrainTileManagerLog) << "terrain cache budget" << maxBytes << "bytes";
+}
+
+void TerrainTileManager::_terrainSavePathChanged()
+{
+    // Reloaded on the next lookup with the local provider
+    _localDEM.clear();
+    _localDEMLoaded = false;
+}
+
+void TerrainTileManager::setTileFetcher(TerrainTileFetcher *tileFetcher)
+{
+    if (_tileFetcher) {
+        (void) disconnect(_tileFetcher, nullptr, this, nullptr);
+        delete _tileFetcher;
+        _failQueuedRequests();
+    }
+
+    _tileFetcher = tileFetcher;
+    if (_tileFetcher) {
+        _tileFetcher->setParent(this);
+        (void) connect(_tileFetcher, &TerrainTileFetcher::tileFetched, this, &TerrainTileManager::_tileFetched);
+        (void) connect(_tileFetcher, &TerrainTileFetcher::tileFailed, this, &TerrainTileManager::_tileFailed);
+    }
+}
+
 bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error)
+{
+    TileMap_t tiles;
+    QHash<QString, QGeoTileSpec> missingTiles;
+    if (_lookupAltitudes(coordinates, altitudes, error, tiles, missingTiles)) {
+        return true;
+    }
+
+    for (auto it = missingTiles.cbegin(); it != missingTiles.cend(); ++it) {
+        _tileFetcher->fetch(it.key(), it.value());
+    }
+
+    return false;
+}
+
+std::shared_ptr<const TerrainTile> TerrainTileManager::_findTile(quint64 key, TileMap_t &tiles)
+{
+    const auto it = tiles.constFind(key);
+    if (it != tiles.cend()) {
+        return it.value();
+    }
+
+    std::shared_ptr<const TerrainTile> tile = _tileCache.find(key);
+    if (tile) {
+        (void) tiles.insert(key, tile);
+    }
+
+    return tile;
+}
+
+bool TerrainTileManager::_lookupAltitudes(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error, TileMap_t &tiles, QHash<QString, QGeoTileSpec> &missingTiles)
 {
     error = false;
 
     const QString elevationProviderName = SettingsManager::instance()->flightMapSettings()->elevationMapProvider()->rawValue().toString();
+    if (elevationProviderName == QLatin1String(LocalDEMElevationProvider::kProviderKey)) {
+        _lookupLocalAltitudes(coordinates, altitudes, error);
+        return true;
+    }
+
     const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(elevationProviderName);
+
+    altitudes.reserve(altitudes.size() + coordinates.size());
+
+    // Neighbouring coordinates mostly share a tile, the tile is only looked up again when it changes
+    int lastTileX = -1;
+    int lastTileY = -1;
+    std::shared_ptr<const TerrainTile> tile;
     for (const QGeoCoordinate &coordinate: coordinates) {
-        const QString tileHash = UrlFactory::getTileHash(
-            provider->getMapName(),
-            provider->long2tileX(coordinate.longitude(), 1),
-            provider->lat2tileY(coordinate.latitude(), 1),
-            1
-        );
-        qCDebug(TerrainTileManagerLog) << "hash:coordinate" << tileHash << coordinate;
-
-        TerrainTile* const tile = _getCachedTile(tileHash);
-        if (tile) {
-            const double elevation = tile->elevation(coordinate);
-            if (qIsNaN(elevation)) {
-                error = true;
-                qCWarning(TerrainTileManagerLog) << "Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainTileManagerLog) << "returning elevation from tile cache" << elevation;
-            }
-            altitudes.push_back(elevation);
-        } else if (_state != TerrainQuery::State::Downloading) {
-            QGeoTileSpec spec;
-            spec.setX(provider->long2tileX(coordinate.longitude(), 1));
-            spec.setY(provider->lat2tileY(coordinate.latitude(), 1));
-            spec.setZoom(1);
-            spec.setMapId(provider->getMapId());
-            const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
-            QGeoTiledMapReplyQGC *reply = new QGeoTiledMapReplyQGC(_networkManager, request, spec, this);
-            (void) connect(reply, &QGeoTiledMapReplyQGC::finished, this, &TerrainTileManager::_terrainDone);
-            if (reply->init()) {
-                _state = TerrainQuery::State::Downloading;
-            } else {
-                reply->deleteLater();
+        const int tileX = provider->long2tileX(coordinate.longitude(), 1);
+        const int tileY = provider->lat2tileY(coordinate.latitude(), 1);
+        if ((tileX != lastTileX) || (tileY != lastTileY)) {
+            lastTileX = tileX;
+            lastTileY = tileY;
+
+            tile = _findTile(TerrainTileCache::key(provider->getMapId(), tileX, tileY, 1), tiles);
+            if (!tile) {
+                // The hash string is only needed to download the tile
+                const QString tileHash = UrlFactory::getTileHash(provider->getMapName(), tileX, tileY, 1);
+                if (!missingTiles.contains(tileHash)) {
+                    QGeoTileSpec spec;
+                    spec.setX(tileX);
+                    spec.setY(tileY);
+                    spec.setZoom(1);
+                    spec.setMapId(provider->getMapId());
+                    (void) missingTiles.insert(tileHash, spec);
+                }
             }
-            return false;
-        } else {
-            return false;
         }
+
+        if (!tile) {
+            continue;
+        }
+
+        const double elevation = tile->elevation(coordinate);
+        if (qIsNaN(elevation)) {
+            error = true;
+            qCWarning(TerrainTileManagerLog) << "Internal Error: missing elevation in tile cache";
+        }
+        altitudes.push_back(elevation);
+    }
+
+    if (!missingTiles.isEmpty()) {
+        qCDebug(TerrainTileManagerLog) << "missing tiles" << missingTiles.count() << "for coordinates" << coordinates.count();
+        return false;
     }
 
     return true;
 }
 
-void TerrainTileManager::addCoordinateQuery(TerrainQueryInterface *terrainQueryInterface, const QList<QGeoCoordinate> &coordinates)
+bool TerrainTileManager::_sampleAltitudes(const QList<double> &latitudes, const QList<double> &longitudes, QList<double> &altitudes,
+                                          double &minHeight, double &maxHeight, bool &error, TileMap_t &tiles, QHash<QString, QGeoTileSpec> &missingTiles)
 {
-    qCDebug(TerrainTileManagerLog) << "count" << coordinates.count();
+    error = false;
+    minHeight = std::numeric_limits<double>::max();
+    maxHeight = std::numeric_limits<double>::lowest();
 
-    if (coordinates.isEmpty()) {
-        return;
+    const QString elevationProviderName = SettingsManager::instance()->flightMapSettings()->elevationMapProvider()->rawValue().toString();
+    if (elevationProviderName == QLatin1String(LocalDEMElevationProvider::kProviderKey)) {
+        _sampleLocalAltitudes(latitudes, longitudes, altitudes, minHeight, maxHeight, error);
+        return true;
     }
 
-    bool error;
-    QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        qCDebug(TerrainTileManagerLog) << "queue count" << _requestQueue.count();
-        const QueuedRequestInfo_t queuedRequestInfo = {
-            terrainQueryInterface,
-            TerrainQuery::QueryMode::QueryModeCoordinates,
-            0,
-            0,
-            coordinates,
-            false,
-            0,
-            0
-        };
-        _requestQueue.enqueue(queuedRequestInfo);
-        return;
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(elevationProviderName);
+
+    const qsizetype count = latitudes.size();
+    altitudes.resize(count);
+    const double *const lats = latitudes.constData();
+    const double *const lons = longitudes.constData();
+    double *const heights = altitudes.data();
+
+    // Consecutive points mostly share a tile, each run of points within one tile is sampled as a batch
+    qsizetype runStart = 0;
+    while (runStart < count) {
+        const int tileX = provider->long2tileX(lons[runStart], 1);
+        const int tileY = provider->lat2tileY(lats[runStart], 1);
+        qsizetype runEnd = runStart + 1;
+        while ((runEnd < count) && (provider->long2tileX(lons[runEnd], 1) == tileX) && (provider->lat2tileY(lats[runEnd], 1) == tileY)) {
+            runEnd++;
+        }
+
+        const std::shared_ptr<const TerrainTile> tile = _findTile(TerrainTileCache::key(provider->getMapId(), tileX, tileY, 1), tiles);
+        if (!tile) {
+            const QString tileHash = UrlFactory::getTileHash(provider->getMapName(), tileX, tileY, 1);
+            if (!missingTiles.contains(tileHash)) {
+                QGeoTileSpec spec;
+                spec.setX(tileX);
+                spec.setY(tileY);
+                spec.setZoom(1);
+                spec.setMapId(provider->getMapId());
+                (void) missingTiles.insert(tileHash, spec);
+            }
+        } else if (missingTiles.isEmpty()) {
+            // Once a tile is missing the query waits and is sampled again, only the missing tiles matter
+            const qsizetype outside = tile->sampleBilinear(lats + runStart, lons + runStart, runEnd - runStart, heights + runStart, minHeight, maxHeight);
+            if (outside > 0) {
+                error = true;
+                qCWarning(TerrainTileManagerLog) << "Internal Error:" << outside << "sample points outside their tile";
+            }
+        }
+
+        runStart = runEnd;
     }
 
-    if (error) {
-        QList<double> noAltitudes;
-        qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-        terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
+    if (!missingTiles.isEmpty()) {
+        qCDebug(TerrainTileManagerLog) << "missing tiles" << missingTiles.count() << "for sample points" << count;
+        altitudes.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void TerrainTileManager::_loadLocalDEM()
+{
+    if (_localDEMLoaded) {
         return;
     }
 
-    qCDebug(TerrainTileManagerLog) << "all altitudes taken from cached data";
-    terrainQueryInterface->signalCoordinateHeights((coordinates.count() == altitudes.count()), altitudes);
+    _localDEMLoaded = true;
+    const QString directory = SettingsManager::instance()->appSettings()->terrainSavePath();
+    if (_localDEM.load(directory) == 0) {
+        qCWarning(TerrainTileManagerLog) << "No DEM files found in" << directory;
+    }
 }
 
-void TerrainTileManager::addPathQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
+void TerrainTileManager::_lookupLocalAltitudes(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error)
 {
-    double distanceBetween;
-    double finalDistanceBetween;
-    const QList<QGeoCoordinate> coordinates = _pathQueryToCoords(startPoint, endPoint, distanceBetween, finalDistanceBetween);
+    _loadLocalDEM();
 
-    bool error;
-    QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        qCDebug(TerrainTileManagerLog) << "queue count" << _requestQueue.count();
-        const QueuedRequestInfo_t queuedRequestInfo = {
-            terrainQueryInterface,
-            TerrainQuery::QueryMode::QueryModePath,
-            distanceBetween,
-            finalDistanceBetween,
-            coordinates,
-            false,
-            0,
-            0
-        };
-        _requestQueue.enqueue(queuedRequestInfo);
-        return;
+    altitudes.reserve(altitudes.size() + coordinates.size());
+
+    for (const QGeoCoordinate &coordinate: coordinates) {
+        const double elevation = _localDEM.elevation(coordinate);
+        if (qIsNaN(elevation) && !error) {
+            error = true;
+            qCWarning(TerrainTileManagerLog) << "No local elevation data for" << coordinate;
+        }
+        altitudes.push_back(elevation);
     }
+}
 
-    if (error) {
-        QList<double> noAltitudes;
-        qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-        terrainQueryInterface->signalPathHeights(false, distanceBetween, finalDistanceBetween, noAltitudes);
+void TerrainTileManager::_sampleLocalAltitudes(const QList<double> &latitudes, const QList<double> &longitudes, QList<double> &altitudes,
+                                               double &minHeight, double &maxHeight, bool &error)
+{
+    _loadLocalDEM();
+
+    const qsizetype count = latitudes.size();
+    altitudes.resize(count);
+
+    for (qsizetype i = 0; i < count; i++) {
+        const double elevation = _localDEM.elevation(latitudes[i], longitudes[i]);
+        if (qIsNaN(elevation)) {
+            if (!error) {
+                error = true;
+                qCWarning(TerrainTileManagerLog) << "No local elevation data for" << QGeoCoordinate(latitudes[i], longitudes[i]);
+            }
+        } else {
+            minHeight = qMin(minHeight, elevation);
+            maxHeight = qMax(maxHeight, elevation);
+        }
+        altitudes[i] = elevation;
+    }
+}
+
+void TerrainTileManager::addCoordinateQuery(TerrainQueryInterface *terrainQueryInterface, const QList<QGeoCoordinate> &coordinates)
+{
+    qCDebug(TerrainTileManagerLog) << "count" << coordinates.count();
+
+    if (coordinates.isEmpty()) {
         return;
     }
 
-    qCDebug(TerrainTileManagerLog) << "all altitudes taken from cached data";
-    terrainQueryInterface->signalPathHeights((coordinates.count() == altitudes.count()), distanceBetween, finalDistanceBetween, altitudes);
+    QueuedRequestInfo_t requestInfo = {
+        terrainQueryInterface,
+        TerrainQuery::QueryMode::QueryModeCoordinates,
+        0,
+        0,
+        coordinates,
+        {},
+        {},
+        false,
+        0,
+        0,
+        {},
+        {},
+        {}
+    };
+    _addRequest(requestInfo);
+}
+
+void TerrainTileManager::addPathQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
+{
+    double distanceBetween;
+    double finalDistanceBetween;
+    QList<double> latitudes;
+    QList<double> longitudes;
+    _pathQueryToPoints(startPoint, endPoint, latitudes, longitudes, distanceBetween, finalDistanceBetween);
+
+    QueuedRequestInfo_t requestInfo = {
+        terrainQueryInterface,
+        TerrainQuery::QueryMode::QueryModePath,
+        distanceBetween,
+        finalDistanceBetween,
+        {},
+        latitudes,
+        longitudes,
+        false,
+        0,
+        0,
+        {},
+        {},
+        {}
+    };
+    _addRequest(requestInfo);
 }
 
 void TerrainTileManager::addCarpetQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &swCoord, const QGeoCoordinate &neCoord, bool statsOnly)
@@ -193,234 +362,261 @@ void TerrainTileManager::addCarpetQuery(TerrainQueryInterface *terrainQueryInter
         return;
     }
 
-    QList<QGeoCoordinate> coordinates;
+    // Row-major from the south west corner, rows run west to east
+    const qsizetype pointCount = static_cast<qsizetype>(gridSizeLat + 1) * (gridSizeLon + 1);
+    QList<double> latitudes(pointCount);
+    QList<double> longitudes(pointCount);
+    qsizetype idx = 0;
     for (int latIdx = 0; latIdx <= gridSizeLat; latIdx++) {
         const double lat = swCoord.latitude() + (latIdx * TerrainTileCopernicus::kTileValueSpacingDegrees);
         for (int lonIdx = 0; lonIdx <= gridSizeLon; lonIdx++) {
-            const double lon = swCoord.longitude() + (lonIdx * TerrainTileCopernicus::kTileValueSpacingDegrees);
-            (void) coordinates.append(QGeoCoordinate(lat, lon));
+            latitudes[idx] = lat;
+            longitudes[idx] = swCoord.longitude() + (lonIdx * TerrainTileCopernicus::kTileValueSpacingDegrees);
+            idx++;
         }
     }
 
+    QueuedRequestInfo_t requestInfo = {
+        terrainQueryInterface,
+        TerrainQuery::QueryMode::QueryModeCarpet,
+        0,
+        0,
+        {},
+        latitudes,
+        longitudes,
+        statsOnly,
+        gridSizeLat + 1,
+        gridSizeLon + 1,
+        {},
+        {},
+        {}
+    };
+    _addRequest(requestInfo);
+}
+
+void TerrainTileManager::_addRequest(QueuedRequestInfo_t &requestInfo)
+{
     bool error;
     QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        qCDebug(TerrainTileManagerLog) << "carpet query queued, count" << _requestQueue.count();
-        const QueuedRequestInfo_t queuedRequestInfo = {
-            terrainQueryInterface,
-            TerrainQuery::QueryMode::QueryModeCarpet,
-            0,
-            0,
-            coordinates,
-            statsOnly,
-            gridSizeLat + 1,
-            gridSizeLon + 1
-        };
-        _requestQueue.enqueue(queuedRequestInfo);
+    double minHeight = qQNaN();
+    double maxHeight = qQNaN();
+    QHash<QString, QGeoTileSpec> missingTiles;
+    const bool found = (requestInfo.queryMode == TerrainQuery::QueryMode::QueryModeCoordinates)
+        ? _lookupAltitudes(requestInfo.coordinates, altitudes, error, requestInfo.tiles, missingTiles)
+        : _sampleAltitudes(requestInfo.latitudes, requestInfo.longitudes, altitudes, minHeight, maxHeight, error, requestInfo.tiles, missingTiles);
+    if (found) {
+        if (!requestInfo.queuedTimer.isValid()) {
+            qCDebug(TerrainTileManagerLog) << "all altitudes taken from cached data";
+            _statistics.cachedQueries++;
+        } else {
+            _recordWait(requestInfo);
+        }
+        _signalResult(requestInfo, error, altitudes, minHeight, maxHeight);
         return;
     }
 
-    if (error) {
-        qCWarning(TerrainTileManagerLog) << "signalling carpet failure due to internal error";
-        terrainQueryInterface->signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
-        return;
+    if (!requestInfo.queuedTimer.isValid()) {
+        requestInfo.queuedTimer.start();
     }
+    requestInfo.pendingTiles = QSet<QString>(missingTiles.keyBegin(), missingTiles.keyEnd());
+    _requestQueue.append(requestInfo);
+    qCDebug(TerrainTileManagerLog) << "queue count" << _requestQueue.count() << "waiting for tiles" << missingTiles.count();
 
-    double minHeight, maxHeight;
-    QList<QList<double>> carpet;
-    _processCarpetResults(altitudes, gridSizeLat + 1, gridSizeLon + 1, statsOnly, minHeight, maxHeight, carpet);
-
-    qCDebug(TerrainTileManagerLog) << "carpet altitudes from cached data, min:" << minHeight << "max:" << maxHeight;
-    terrainQueryInterface->signalCarpetHeights(true, minHeight, maxHeight, carpet);
+    // Queued first so a fetch which fails right away finds the request
+    for (auto it = missingTiles.cbegin(); it != missingTiles.cend(); ++it) {
+        _tileFetcher->fetch(it.key(), it.value());
+    }
 }
 
-QList<QGeoCoordinate> TerrainTileManager::_pathQueryToCoords(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, double &distanceBetween, double &finalDistanceBetween)
+void TerrainTileManager::_signalResult(const QueuedRequestInfo_t &requestInfo, bool error, const QList<double> &altitudes, double minHeight, double maxHeight)
 {
-    const double totalDistance = QGCGeo::geodesicDistance(fromCoord, toCoord);
-    // TODO: get spacing from terrainQueryInterface
-    const int numPoints = qMax(2, qCeil(totalDistance / TerrainTileCopernicus::kTileValueSpacingMeters) + 1);
-
-    QList<QGeoCoordinate> coordinates = QGCGeo::interpolatePath(fromCoord, toCoord, numPoints);
-
-    if (coordinates.size() >= 2) {
-        distanceBetween = QGCGeo::geodesicDistance(coordinates[0], coordinates[1]);
-        finalDistanceBetween = QGCGeo::geodesicDistance(coordinates[coordinates.size() - 2], coordinates.last());
-    } else {
-        distanceBetween = finalDistanceBetween = totalDistance;
+    if (requestInfo.terrainQueryInterface.isNull()) {
+        return;
     }
 
-    qCDebug(TerrainTileManagerLog) << "fromCoord:toCoord:distanceBetween:finalDistanceBetween:coordCount"
-                                   << fromCoord << toCoord << distanceBetween << finalDistanceBetween << coordinates.count();
-
-    return coordinates;
-}
-
-void TerrainTileManager::_tileFailed()
-{
-    QList<double> noAltitudes;
+    if (error) {
+        qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
+        _signalFailure(requestInfo);
+        return;
+    }
 
-    for (const QueuedRequestInfo_t &requestInfo: _requestQueue) {
-        if (requestInfo.terrainQueryInterface.isNull()) {
-            continue;
+    _statistics.queries++;
+
+    switch (requestInfo.queryMode) {
+    case TerrainQuery::QueryMode::QueryModeCoordinates:
+        requestInfo.terrainQueryInterface->signalCoordinateHeights(requestInfo.coordinates.count() == altitudes.count(), altitudes);
+        break;
+    case TerrainQuery::QueryMode::QueryModePath:
+        requestInfo.terrainQueryInterface->signalPathHeights(requestInfo.latitudes.count() == altitudes.count(), requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
+        break;
+    case TerrainQuery::QueryMode::QueryModeCarpet:
+    {
+        QList<QList<double>> carpet;
+        if (!requestInfo.carpetStatsOnly) {
+            carpet = _carpetRows(altitudes, requestInfo.carpetGridSizeLat, requestInfo.carpetGridSizeLon);
         }
-        switch (requestInfo.queryMode) {
-        case TerrainQuery::QueryMode::QueryModeCoordinates:
-            requestInfo.terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
-            break;
-        case TerrainQuery::QueryMode::QueryModePath:
-            requestInfo.terrainQueryInterface->signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
-            break;
-        case TerrainQuery::QueryMode::QueryModeCarpet:
-            requestInfo.terrainQueryInterface->signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
-            break;
-        default:
-            continue;
-        }
-    }
 
-    _requestQueue.clear();
+        qCDebug(TerrainTileManagerLog) << "carpet altitudes from cached data, min:" << minHeight << "max:" << maxHeight;
+        requestInfo.terrainQueryInterface->signalCarpetHeights(true, minHeight, maxHeight, carpet);
+        break;
+    }
+    default:
+        break;
+    }
 }
 
-void TerrainTileManager::_terrainDone()
+void TerrainTileManager::_signalFailure(const QueuedRequestInfo_t &requestInfo)
 {
-    _state = TerrainQuery::State::Idle;
-
-    QGeoTiledMapReplyQGC* const reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    if (!reply) {
-        qCWarning(TerrainTileManagerLog) << "Elevation tile fetched but invalid reply data type.";
+    if (requestInfo.terrainQueryInterface.isNull()) {
         return;
     }
-    reply->deleteLater();
 
-    const QByteArray responseBytes = reply->mapImageData();
-    const QGeoTileSpec spec = reply->tileSpec();
-
-    if (reply->error() != QGeoTiledMapReplyQGC::NoError) {
-        qCWarning(TerrainTileManagerLog) << "Elevation tile fetching returned error:" << reply->errorString();
-        _tileFailed();
-        return;
+    _statistics.queries++;
+    _statistics.failedQueries++;
+
+    switch (requestInfo.queryMode) {
+    case TerrainQuery::QueryMode::QueryModeCoordinates:
+        requestInfo.terrainQueryInterface->signalCoordinateHeights(false, QList<double>());
+        break;
+    case TerrainQuery::QueryMode::QueryModePath:
+        requestInfo.terrainQueryInterface->signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, QList<double>());
+        break;
+    case TerrainQuery::QueryMode::QueryModeCarpet:
+        requestInfo.terrainQueryInterface->signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
+        break;
+    default:
+        break;
     }
+}
 
-    if (responseBytes.isEmpty()) {
-        qCWarning(TerrainTileManagerLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
-        return;
+void TerrainTileManager::_failQueuedRequests()
+{
+    const QList<QueuedRequestInfo_t> requests = std::exchange(_requestQueue, {});
+    for (const QueuedRequestInfo_t &requestInfo: requests) {
+        _recordWait(requestInfo);
+        _signalFailure(requestInfo);
     }
+}
 
-    qCDebug(TerrainTileManagerLog) << "Received some bytes of terrain data:" << responseBytes.size();
+void TerrainTileManager::_recordWait(const QueuedRequestInfo_t &requestInfo)
+{
+    const qint64 waitMSecs = requestInfo.queuedTimer.elapsed();
+    _statistics.waitedQueries++;
+    _statistics.totalWaitMSecs += waitMSecs;
+    _statistics.maxWaitMSecs = qMax(_statistics.maxWaitMSecs, waitMSecs);
+    _statistics.lastWaitMSecs = waitMSecs;
+
+    qCDebug(TerrainTileManagerLog) << "query answered after" << waitMSecs << "ms"
+                                   << "average" << _statistics.averageWaitMSecs() << "ms"
+                                   << "max" << _statistics.maxWaitMSecs << "ms";
+}
 
-    const QString hash = UrlFactory::getTileHash(UrlFactory::getProviderTypeFromQtMapId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
-    _cacheTile(responseBytes, hash);
+void TerrainTileManager::_pathQueryToPoints(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, QList<double> &latitudes, QList<double> &longitudes,
+                                            double &distanceBetween, double &finalDistanceBetween)
+{
+    const double totalDistance = QGCGeo::geodesicDistance(fromCoord, toCoord);
+    // TODO: get spacing from terrainQueryInterface
+    const int numPoints = qMax(2, qCeil(totalDistance / TerrainTileCopernicus::kTileValueSpacingMeters) + 1);
 
-    for (qsizetype i = _requestQueue.count() - 1; i >= 0; i--) {
-        bool error;
-        QList<double> altitudes;
-        QueuedRequestInfo_t &requestInfo = _requestQueue[i];
+    QGCGeo::interpolatePath(fromCoord, toCoord, numPoints, latitudes, longitudes);
 
-        if (requestInfo.terrainQueryInterface.isNull()) {
-            _requestQueue.removeAt(i);
-            continue;
-        }
+    const qsizetype count = latitudes.size();
+    if (count >= 2) {
+        distanceBetween = QGCGeo::geodesicDistance(QGeoCoordinate(latitudes[0], longitudes[0]), QGeoCoordinate(latitudes[1], longitudes[1]));
+        finalDistanceBetween = QGCGeo::geodesicDistance(QGeoCoordinate(latitudes[count - 2], longitudes[count - 2]), QGeoCoordinate(latitudes[count - 1], longitudes[count - 1]));
+    } else {
+        distanceBetween = finalDistanceBetween = totalDistance;
+    }
 
-        if (!getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
-            continue;
-        }
+    qCDebug(TerrainTileManagerLog) << "fromCoord:toCoord:distanceBetween:finalDistanceBetween:pointCount"
+                                   << fromCoord << toCoord << distanceBetween << finalDistanceBetween << count;
+}
 
-        switch (requestInfo.queryMode) {
-        case TerrainQuery::QueryMode::QueryModeCoordinates:
-            if (error) {
-                qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-                QList<double> noAltitudes;
-                requestInfo.terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
-            } else {
-                qCDebug(TerrainTileManagerLog) << "All altitudes taken from cached data";
-                requestInfo.terrainQueryInterface->signalCoordinateHeights(requestInfo.coordinates.count() == altitudes.count(), altitudes);
-            }
-            break;
-        case TerrainQuery::QueryMode::QueryModePath:
-            if (error) {
-                qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-                QList<double> noAltitudes;
-                requestInfo.terrainQueryInterface->signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
-            } else {
-                qCDebug(TerrainTileManagerLog) << "All altitudes taken from cached data";
-                requestInfo.terrainQueryInterface->signalPathHeights(requestInfo.coordinates.count() == altitudes.count(), requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
-            }
-            break;
-        case TerrainQuery::QueryMode::QueryModeCarpet:
-            if (error) {
-                qCWarning(TerrainTileManagerLog) << "signalling carpet failure due to internal error";
-                requestInfo.terrainQueryInterface->signalCarpetHeights(false, qQNaN(), qQNaN(), QList<QList<double>>());
-            } else {
-                double minHeight, maxHeight;
-                QList<QList<double>> carpet;
-                _processCarpetResults(altitudes, requestInfo.carpetGridSizeLat, requestInfo.carpetGridSizeLon,
-                                      requestInfo.carpetStatsOnly, minHeight, maxHeight, carpet);
+void TerrainTileManager::_tileFetched(const QString &hash, const QGeoTileSpec &spec, const QByteArray &data)
+{
+    qCDebug(TerrainTileManagerLog) << "Received some bytes of terrain data:" << data.size();
 
-                qCDebug(TerrainTileManagerLog) << "carpet altitudes from cached data, min:" << minHeight << "max:" << maxHeight;
-                requestInfo.terrainQueryInterface->signalCarpetHeights(true, minHeight, maxHeight, carpet);
+    const std::shared_ptr<const TerrainTile> tile = _cacheTile(data, spec);
+    if (!tile) {
+        _tileFailed(hash, tr("Invalid terrain tile"));
+        return;
+    }
+    _statistics.tilesFetched++;
+
+    // Every waiting request pins the tile, the cache may evict it before the request's other tiles are in.
+    // Only the requests whose last missing tile this was are answered. They are taken off the queue
+    // first as answering them may queue new requests.
+    const quint64 key = TerrainTileCache::key(spec.mapId(), spec.x(), spec.y(), spec.zoom());
+    QList<QueuedRequestInfo_t> completeRequests;
+    for (auto it = _requestQueue.begin(); it != _requestQueue.end();) {
+        if (it->terrainQueryInterface.isNull()) {
+            it = _requestQueue.erase(it);
+        } else if (it->pendingTiles.remove(hash)) {
+            (void) it->tiles.insert(key, tile);
+            if (it->pendingTiles.isEmpty()) {
+                completeRequests.append(std::move(*it));
+                it = _requestQueue.erase(it);
+            } else {
+                ++it;
             }
-            break;
-        default:
-            break;
+        } else {
+            ++it;
         }
+    }
 
-        _requestQueue.removeAt(i);
+    for (QueuedRequestInfo_t &requestInfo: completeRequests) {
+        // All tiles are pinned in the request now, so this answers it without touching the cache
+        _addRequest(requestInfo);
     }
 }
 
-void TerrainTileManager::_cacheTile(const QByteArray &data, const QString &hash)
+void TerrainTileManager::_tileFailed(const QString &hash, const QString &errorString)
 {
-    TerrainTile* const terrainTile = new TerrainTile(data);
-    if (!terrainTile->isValid()) {
-        delete terrainTile;
-        qCWarning(TerrainTileManagerLog) << "Received invalid tile";
-        return;
+    qCWarning(TerrainTileManagerLog) << "Elevation tile fetching returned error:" << errorString;
+    _statistics.tilesFailed++;
+
+    QList<QueuedRequestInfo_t> failedRequests;
+    for (auto it = _requestQueue.begin(); it != _requestQueue.end();) {
+        if (it->terrainQueryInterface.isNull()) {
+            it = _requestQueue.erase(it);
+        } else if (it->pendingTiles.contains(hash)) {
+            failedRequests.append(std::move(*it));
+            it = _requestQueue.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    QMutexLocker locker(&_tilesMutex);
-    if (!_tiles.contains(hash)) {
-        (void) _tiles.insert(hash, terrainTile);
-    } else {
-        delete terrainTile;
+    for (const QueuedRequestInfo_t &requestInfo: failedRequests) {
+        _recordWait(requestInfo);
+        _signalFailure(requestInfo);
     }
 }
 
-TerrainTile *TerrainTileManager::_getCachedTile(const QString &hash)
+std::shared_ptr<const TerrainTile> TerrainTileManager::_cacheTile(const QByteArray &data, const QGeoTileSpec &spec)
 {
-    QMutexLocker locker(&_tilesMutex);
-
-    if (!_tiles.contains(hash)) {
+    auto terrainTile = std::make_shared<const TerrainTile>(data);
+    if (!terrainTile->isValid()) {
+        qCWarning(TerrainTileManagerLog) << "Received invalid tile";
         return nullptr;
     }
 
-    TerrainTile* const tile = _tiles[hash];
-    if (!tile->isValid()) {
-        return nullptr;
-    }
+    _tileCache.insert(TerrainTileCache::key(spec.mapId(), spec.x(), spec.y(), spec.zoom()), terrainTile);
 
-    return tile;
+    qCDebug(TerrainTileManagerLog) << "terrain cache tiles" << _tileCache.count() << "bytes" << _tileCache.bytes()
+                                   << "hits" << _tileCache.hits() << "misses" << _tileCache.misses()
+                                   << "evictions" << _tileCache.evictions();
+
+    return terrainTile;
 }
 
-void TerrainTileManager::_processCarpetResults(const QList<double> &altitudes, int gridSizeLat, int gridSizeLon,
-                                               bool statsOnly, double &minHeight, double &maxHeight, QList<QList<double>> &carpet)
+QList<QList<double>> TerrainTileManager::_carpetRows(const QList<double> &altitudes, int gridSizeLat, int gridSizeLon)
 {
-    minHeight = std::numeric_limits<double>::max();
-    maxHeight = std::numeric_limits<double>::lowest();
-
-    int idx = 0;
+    QList<QList<double>> carpet;
+    carpet.reserve(gridSizeLat);
     for (int latIdx = 0; latIdx < gridSizeLat; latIdx++) {
-        QList<double> row;
-        for (int lonIdx = 0; lonIdx < gridSizeLon; lonIdx++) {
-            const double height = altitudes[idx++];
-            minHeight = qMin(minHeight, height);
-            maxHeight = qMax(maxHeight, height);
-            if (!statsOnly) {
-                (void) row.append(height);
-            }
-        }
-        if (!statsOnly) {
-            (void) carpet.append(row);
-        }
+        (void) carpet.append(altitudes.mid(static_cast<qsizetype>(latIdx) * gridSizeLon, gridSizeLon));
     }
+
+    return carpet;
 }
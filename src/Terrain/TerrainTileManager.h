@@ -1,67 +1,142 @@
 #pragma once
 
 #include "TerrainQueryInterface.h"
+#include "TerrainTileCache.h"
+#include "TerrainLocalDEM.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
-#include <QtCore/QMutex>
 #include <QtCore/QObject>
-#include <QtCore/QQueue>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+#include <QtLocation/private/qgeotilespec_p.h>
 #include <QtPositioning/QGeoCoordinate>
 
-class TerrainTile;
-class QNetworkAccessManager;
+class TerrainTileFetcher;
 class UnitTestTerrainQuery;
+class TerrainTileFetchTest;
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileManagerLog)
 
+/// Answers terrain queries from elevation tiles, downloading the missing ones.
+/// All tiles missing for a query are requested at once through the TerrainTileFetcher, which downloads
+/// several tiles concurrently and only once each, and a query is answered as soon as its own tiles are in.
+/// Downloaded tiles are kept in a TerrainTileCache bounded by the Maps maxTerrainCacheMemorySize setting.
+/// A query waiting for tiles holds on to every tile it already has, so it is answered even if it needs more
+/// tiles than the cache budget and the cache evicts them in the meantime.
+/// With the Local DEM elevation provider nothing is downloaded, queries are answered right away from the
+/// DEM files in the terrain save directory.
+/// Path and carpet queries keep their sample points in packed latitude/longitude arrays and sample each tile in
+/// one bilinear batch, collecting the carpet min/max in the same pass.
 class TerrainTileManager : public QObject
 {
     Q_OBJECT
 
     friend class UnitTestTerrainQuery;
+    friend class TerrainTileFetchTest;
 public:
     explicit TerrainTileManager(QObject *parent = nullptr);
     ~TerrainTileManager();
 
     static TerrainTileManager *instance();
 
-    /// Either returns altitudes from cache or queues database request
+    /// Either returns altitudes from cache or requests the missing tiles
     ///     @param[out] error true: altitude not returned due to error, false: altitudes returned
-    ///     @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
+    ///     @return true: altitude returned (check error as well), false: tile download requested (altitudes not returned)
     bool getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error);
 
     void addCoordinateQuery(TerrainQueryInterface *terrainQueryInterface, const QList<QGeoCoordinate> &coordinates);
     void addPathQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint);
     void addCarpetQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &swCoord, const QGeoCoordinate &neCoord, bool statsOnly);
 
+    /// Replaces the tile fetcher, takes ownership. Queries waiting for tiles from the previous fetcher fail.
+    void setTileFetcher(TerrainTileFetcher *tileFetcher);
+    TerrainTileFetcher *tileFetcher() const { return _tileFetcher; }
+
+    struct Statistics_t {
+        quint64 queries = 0;                ///< Queries answered, successfully or not
+        quint64 cachedQueries = 0;          ///< Queries answered straight from cached tiles
+        quint64 failedQueries = 0;
+        quint64 tilesFetched = 0;
+        quint64 tilesFailed = 0;
+        quint64 waitedQueries = 0;          ///< Queries which had to wait for tiles
+        qint64 totalWaitMSecs = 0;          ///< Time from queuing to answer, summed over waitedQueries
+        qint64 maxWaitMSecs = 0;
+        qint64 lastWaitMSecs = 0;
+
+        qint64 averageWaitMSecs() const { return ((waitedQueries > 0) ? (totalWaitMSecs / static_cast<qint64>(waitedQueries)) : 0); }
+    };
+    const Statistics_t &statistics() const { return _statistics; }
+
+    TerrainTileCache *tileCache() { return &_tileCache; }
+    const TerrainLocalDEM &localDEM() const { return _localDEM; }
+
 private slots:
-    void _terrainDone();
+    void _tileFetched(const QString &hash, const QGeoTileSpec &spec, const QByteArray &data);
+    void _maxCacheMemorySizeChanged();
+    void _terrainSavePathChanged();
+    void _tileFailed(const QString &hash, const QString &errorString);
 
 private:
-    /// Returns a list of individual coordinates along the requested path spaced according to the terrain tile value spacing
-    static QList<QGeoCoordinate> _pathQueryToCoords(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, double &distanceBetween, double &finalDistanceBetween);
-    void _tileFailed();
-    void _cacheTile(const QByteArray &data, const QString &hash);
-    TerrainTile *_getCachedTile(const QString &hash);
-    static void _processCarpetResults(const QList<double> &altitudes, int gridSizeLat, int gridSizeLon,
-                                      bool statsOnly, double &minHeight, double &maxHeight, QList<QList<double>> &carpet);
+    /// Tiles by TerrainTileCache key
+    using TileMap_t = QHash<quint64, std::shared_ptr<const TerrainTile>>;
 
     struct QueuedRequestInfo_t {
         QPointer<TerrainQueryInterface> terrainQueryInterface;
         TerrainQuery::QueryMode queryMode;
         double distanceBetween;                         ///< Distance between each returned height
         double finalDistanceBetween;                    ///< Distance between for final height
-        QList<QGeoCoordinate> coordinates;
+        QList<QGeoCoordinate> coordinates;             ///< For coordinate queries
+        QList<double> latitudes;                        ///< For path and carpet queries: packed sample points
+        QList<double> longitudes;
         bool carpetStatsOnly;                           ///< For carpet queries: return only stats
         int carpetGridSizeLat;                          ///< For carpet queries: number of rows
         int carpetGridSizeLon;                          ///< For carpet queries: number of columns
+        QSet<QString> pendingTiles;                     ///< Hashes of the tiles still being downloaded
+        TileMap_t tiles;                                ///< Tiles the request already has, pinned independent of the cache
+        QElapsedTimer queuedTimer;                      ///< Started when the request had to wait for tiles
     };
 
-    QQueue<QueuedRequestInfo_t> _requestQueue;
-    TerrainQuery::State _state = TerrainQuery::State::Idle;
+    /// Fills the packed sample points along the requested path spaced according to the terrain tile value spacing
+    static void _pathQueryToPoints(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, QList<double> &latitudes, QList<double> &longitudes,
+                                   double &distanceBetween, double &finalDistanceBetween);
+    /// @return The tile from @a tiles, else from the cache in which case it is added to @a tiles. nullptr if neither has it.
+    std::shared_ptr<const TerrainTile> _findTile(quint64 key, TileMap_t &tiles);
+    /// Looks up the altitudes from @a tiles and cached tiles
+    ///     @param[in,out] tiles Tiles already held, the cached tiles used are added
+    ///     @param[out] missingTiles Tiles which are not cached, by hash
+    ///     @return true: all tiles were cached
+    bool _lookupAltitudes(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error, TileMap_t &tiles, QHash<QString, QGeoTileSpec> &missingTiles);
+    /// Bilinearly samples the altitudes at packed sample points from @a tiles and cached tiles, one batch per tile
+    ///     @param[out] minHeight, maxHeight Range of the sampled altitudes
+    ///     @param[in,out] tiles Tiles already held, the cached tiles used are added
+    ///     @param[out] missingTiles Tiles which are not cached, by hash
+    ///     @return true: all tiles were cached
+    bool _sampleAltitudes(const QList<double> &latitudes, const QList<double> &longitudes, QList<double> &altitudes,
+                          double &minHeight, double &maxHeight, bool &error, TileMap_t &tiles, QHash<QString, QGeoTileSpec> &missingTiles);
+    /// Looks up the altitudes from the local DEM files, never has missing tiles
+    void _lookupLocalAltitudes(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error);
+    void _sampleLocalAltitudes(const QList<double> &latitudes, const QList<double> &longitudes, QList<double> &altitudes,
+                               double &minHeight, double &maxHeight, bool &error);
+    void _loadLocalDEM();
+    /// Answers the request from cached tiles or queues it until its missing tiles are downloaded
+    void _addRequest(QueuedRequestInfo_t &requestInfo);
+    void _signalResult(const QueuedRequestInfo_t &requestInfo, bool error, const QList<double> &altitudes, double minHeight, double maxHeight);
+    void _signalFailure(const QueuedRequestInfo_t &requestInfo);
+    void _failQueuedRequests();
+    void _recordWait(const QueuedRequestInfo_t &requestInfo);
+    /// @return The decoded tile, nullptr if @a data is not a valid tile
+    std::shared_ptr<const TerrainTile> _cacheTile(const QByteArray &data, const QGeoTileSpec &spec);
+    /// Splits the row-major carpet altitudes into rows
+    static QList<QList<double>> _carpetRows(const QList<double> &altitudes, int gridSizeLat, int gridSizeLon);
+
+    QList<QueuedRequestInfo_t> _requestQueue;
 
-    QMutex _tilesMutex;
-    QHash<QString, TerrainTile*> _tiles;
+    TerrainTileCache _tileCache;
+    TerrainLocalDEM _localDEM;
+    bool _localDEMLoaded = false;
 
-    QNetworkAccessManager *_networkManager = nullptr;
+    TerrainTileFetcher *_tileFetcher = nullptr;
+    Statistics_t _statistics;
 };
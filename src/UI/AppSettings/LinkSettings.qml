@@ -12,6 +12,18 @@ SettingsPage {
     property var _linkManager:          QGroundControl.linkManager
     property var _autoConnectSettings:  QGroundControl.settingsManager.autoConnectSettings
 
+    property var _burstLengthLabels: [ "1", "2", "3-4", "5-8", "9-16", "17-32", "33-64" ]
+
+    function _burstHistogramText(histogram) {
+        var parts = []
+        for (var i = 0; i < histogram.length; i++) {
+            if (histogram[i] > 0) {
+                parts.push(_burstLengthLabels[i] + ":" + histogram[i])
+            }
+        }
+        return parts.length ? parts.join(" ") : qsTr("none")
+    }
+
     SettingsGroupLayout {
         heading:        qsTr("AutoConnect")
         visible:        _autoConnectSettings.visible
@@ -106,75 +118,98 @@ SettingsPage {
         Repeater {
             model: _linkManager.linkConfigurations
 
-            RowLayout {
+            ColumnLayout {
                 Layout.fillWidth:   true
                 visible:            !object.dynamic
+                spacing:            0
 
-                QGCLabel {
+                RowLayout {
                     Layout.fillWidth:   true
-                    text:               object.name
-                }
-                QGCColoredImage {
-                    height:                 ScreenTools.minTouchPixels
-                    width:                  height
-                    sourceSize.height:      height
-                    fillMode:               Image.PreserveAspectFit
-                    mipmap:                 true
-                    smooth:                 true
-                    color:                  qgcPalEdit.text
-                    source:                 "/res/pencil.svg"
-                    enabled:                !object.link
-
-                    QGCPalette {
-                        id: qgcPalEdit
-                        colorGroupEnabled: parent.enabled
+
+                    QGCLabel {
+                        Layout.fillWidth:   true
+                        text:               object.name
                     }
+                    QGCColoredImage {
+                        height:                 ScreenTools.minTouchPixels
+                        width:                  height
+                        sourceSize.height:      height
+                        fillMode:               Image.PreserveAspectFit
+                        mipmap:                 true
+                        smooth:                 true
+                        color:                  qgcPalEdit.text
+                        source:                 "/res/pencil.svg"
+                        enabled:                !object.link
+
+                        QGCPalette {
+                            id: qgcPalEdit
+                            colorGroupEnabled: parent.enabled
+                        }
 
-                    QGCMouseArea {
-                        fillItem: parent
-                        onClicked: {
-                            var editingConfig = _linkManager.startConfigurationEditing(object)
-                            linkDialogFactory.open({ editingConfig: editingConfig, originalConfig: object })
+                        QGCMouseArea {
+                            fillItem: parent
+                            onClicked: {
+                                var editingConfig = _linkManager.startConfigurationEditing(object)
+                                linkDialogFactory.open({ editingConfig: editingConfig, originalConfig: object })
+                            }
                         }
                     }
-                }
-                QGCColoredImage {
-                    height:                 ScreenTools.minTouchPixels
-                    width:                  height
-                    sourceSize.height:      height
-                    fillMode:               Image.PreserveAspectFit
-                    mipmap:                 true
-                    smooth:                 true
-                    color:                  qgcPalDelete.text
-                    source:                 "/res/TrashDelete.svg"
-
-                    QGCPalette {
-                        id: qgcPalDelete
-                        colorGroupEnabled: parent.enabled
-                    }
+                    QGCColoredImage {
+                        height:                 ScreenTools.minTouchPixels
+                        width:                  height
+                        sourceSize.height:      height
+                        fillMode:               Image.PreserveAspectFit
+                        mipmap:                 true
+                        smooth:                 true
+                        color:                  qgcPalDelete.text
+                        source:                 "/res/TrashDelete.svg"
+
+                        QGCPalette {
+                            id: qgcPalDelete
+                            colorGroupEnabled: parent.enabled
+                        }
 
-                    QGCMouseArea {
-                        fillItem:   parent
-                        onClicked:  QGroundControl.showMessageDialog(
-                                        _root,
-                                        qsTr("Delete Link"),
-                                        qsTr("Are you sure you want to delete '%1'?").arg(object.name),
-                                        Dialog.Ok | Dialog.Cancel,
-                                        function () {
-                                            _linkManager.removeConfiguration(object)
-                                        })
+                        QGCMouseArea {
+                            fillItem:   parent
+                            onClicked:  QGroundControl.showMessageDialog(
+                                            _root,
+                                            qsTr("Delete Link"),
+                                            qsTr("Are you sure you want to delete '%1'?").arg(object.name),
+                                            Dialog.Ok | Dialog.Cancel,
+                                            function () {
+                                                _linkManager.removeConfiguration(object)
+                                            })
+                        }
                     }
-                }
-                QGCButton {
-                    text:       object.link ? qsTr("Disconnect") : qsTr("Connect")
-                    onClicked: {
-                        if (object.link) {
-                            object.link.disconnect()
-                        } else {
-                            _linkManager.createConnectedLink(object)
+                    QGCButton {
+                        text:       object.link ? qsTr("Disconnect") : qsTr("Connect")
+                        onClicked: {
+                            if (object.link) {
+                                object.link.disconnect()
+                            } else {
+                                _linkManager.createConnectedLink(object)
+                            }
                         }
                     }
                 }
+
+                // Sequence loss per vehicle component on this link
+                Repeater {
+                    model: object.link ? object.link.lossStatistics : []
+
+                    QGCLabel {
+                        Layout.fillWidth:   true
+                        font.pointSize:     ScreenTools.smallFontPointSize
+                        wrapMode:           Text.WordWrap
+                        text:               qsTr("System %1 Component %2: %3% recent loss, %4 lost, %5 reordered, bursts %6")
+                                                .arg(modelData.sysid)
+                                                .arg(modelData.compid)
+                                                .arg(modelData.windowLossPercent.toFixed(1))
+                                                .arg(modelData.lost)
+                                                .arg(modelData.reordered)
+                                                .arg(_burstHistogramText(modelData.burstHistogram))
+                    }
+                }
             }
         }
 
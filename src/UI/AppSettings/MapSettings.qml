@@ -74,6 +74,13 @@ Item {
                 }
             }
 
+            QGCLabel {
+                Layout.fillWidth:   true
+                wrapMode:           Text.WordWrap
+                visible:            _mapProviderFact.rawValue === "Offline"
+                text:               qsTr("Tiles are read from MBTiles and PMTiles files in %1").arg(_appSettings.mapTilesSavePath)
+            }
+
             LabelledComboBox {
                 label: qsTr("Elevation Provider")
                 model: _mapEngineManager.elevationProviderList
@@ -86,6 +93,13 @@ Item {
                     comboBox.currentIndex = index
                 }
             }
+
+            QGCLabel {
+                Layout.fillWidth:   true
+                wrapMode:           Text.WordWrap
+                visible:            _elevationProviderFact.rawValue === "Local DEM"
+                text:               qsTr("Elevation is read from SRTM .hgt and GeoTIFF files in %1").arg(_appSettings.terrainSavePath)
+            }
         }
 
         SettingsGroupLayout {
@@ -223,6 +237,59 @@ Item {
             LabelledFactTextField {
                 fact: _mapsSettings.maxCacheMemorySize
             }
+
+            LabelledFactTextField {
+                fact: _mapsSettings.maxTileMemoryCacheSize
+            }
+
+            LabelledLabel {
+                label:      qsTr("Database tile memory hits")
+                labelText:  _mapEngineManager.memoryCacheStatsStr
+                visible:    _mapsSettings.maxTileMemoryCacheSize.rawValue > 0
+            }
+
+            LabelledFactTextField {
+                fact: _mapsSettings.maxTerrainCacheMemorySize
+            }
+        }
+
+        SettingsGroupLayout {
+            Layout.fillWidth:   true
+            heading:            qsTr("Tile Prefetch")
+            headingDescription: qsTr("Loads map tiles ahead of the active vehicle")
+
+            FactCheckBoxSlider {
+                Layout.fillWidth:   true
+                text:               fact.shortDescription
+                fact:               _mapsSettings.tilePrefetch
+            }
+
+            LabelledFactTextField {
+                fact:       _mapsSettings.tilePrefetchMaxBandwidth
+                enabled:    _mapsSettings.tilePrefetch.rawValue
+            }
+
+            LabelledFactTextField {
+                fact:       _mapsSettings.tilePrefetchLookahead
+                enabled:    _mapsSettings.tilePrefetch.rawValue
+            }
+
+            LabelledLabel {
+                label:      qsTr("Prefetched tiles")
+                labelText:  _mapEngineManager.prefetchStatsStr
+                visible:    _mapsSettings.tilePrefetch.rawValue
+            }
+        }
+
+        Timer {
+            interval:           2000
+            running:            root.visible && (_mapsSettings.maxTileMemoryCacheSize.rawValue > 0 || _mapsSettings.tilePrefetch.rawValue)
+            repeat:             true
+            triggeredOnStart:   true
+            onTriggered: {
+                _mapEngineManager.updateMemoryCacheStats()
+                _mapEngineManager.updatePrefetchStats()
+            }
         }
 
         QGCFileDialog {
@@ -258,6 +325,13 @@ Item {
                 onAccepted: {
                     close()
                     fileDialog.title = qsTr("Export Tiles")
+                    if (mbtilesCheckBox.checked) {
+                        fileDialog.defaultSuffix = "mbtiles"
+                        fileDialog.nameFilters = [ qsTr("MBTiles (*.mbtiles)") ]
+                    } else {
+                        fileDialog.defaultSuffix = _appSettings.tilesetFileExtension
+                        fileDialog.nameFilters = [ qsTr("Tile Sets (*.%1)").arg(_appSettings.tilesetFileExtension) ]
+                    }
                     fileDialog.openForSave()
                 }
 
@@ -273,6 +347,11 @@ Item {
                             onClicked:  object.selected = checked
                         }
                     }
+
+                    QGCCheckBox {
+                        id:     mbtilesCheckBox
+                        text:   qsTr("Export as MBTiles (tile sets of a single map type)")
+                    }
                 }
             }
         }
@@ -293,6 +372,8 @@ Item {
                 onAccepted: {
                     close()
                     fileDialog.title = qsTr("Import Tiles")
+                    fileDialog.defaultSuffix = _appSettings.tilesetFileExtension
+                    fileDialog.nameFilters = [ qsTr("Tile Sets (*.%1)").arg(_appSettings.tilesetFileExtension) ]
                     fileDialog.openForLoad()
                 }
 
@@ -33,6 +33,13 @@ SettingsPage {
             text:               qsTr("Emit heartbeat")
             fact:               _mavlinkSettings.sendGCSHeartbeat
         }
+
+        FactCheckBoxSlider {
+            Layout.fillWidth:   true
+            text:               qsTr("Parse MAVLink on link threads")
+            fact:               _mavlinkSettings.threadedMavlinkParsing
+            visible:            fact.visible
+        }
     }
 
     SettingsGroupLayout {
@@ -121,6 +128,15 @@ SettingsPage {
             property Fact _telemetrySaveNotArmed: _mavlinkSettings.telemetrySaveNotArmed
         }
 
+        LabelledFactComboBox {
+            Layout.fillWidth:   true
+            label:              qsTr("Log compression")
+            fact:               _mavlinkSettings.telemetryCompression
+            indexModel:         false
+            visible:            fact.visible
+            enabled:            _mavlinkSettings.telemetrySave.rawValue
+        }
+
         FactCheckBoxSlider {
             Layout.fillWidth:   true
             text:               qsTr("Save CSV log of telemetry data")
@@ -0,0 +1,266 @@
+#include "QGCCompressDevice.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QFileDevice>
+
+#include <lzma.h>
+#include <zstd.h>
+
+QGC_LOGGING_CATEGORY(QGCCompressDeviceLog, "Utilities.QGCCompressDevice")
+
+namespace {
+
+constexpr qsizetype kOutputBufferSize = 64 * 1024;
+
+QString lzmaErrorString(lzma_ret result)
+{
+    switch (result) {
+    case LZMA_MEM_ERROR:
+        return QStringLiteral("XZ encoder out of memory");
+    case LZMA_OPTIONS_ERROR:
+        return QStringLiteral("XZ encoder options not supported");
+    case LZMA_UNSUPPORTED_CHECK:
+        return QStringLiteral("XZ integrity check not supported");
+    default:
+        return QStringLiteral("XZ encoder error %1").arg(static_cast<int>(result));
+    }
+}
+
+} // namespace
+
+/// Compression state kept for the lifetime of the device
+struct QGCCompressDevice::Encoder
+{
+    ~Encoder()
+    {
+        (void) ZSTD_freeCCtx(zstd);
+        lzma_end(&lzma);
+    }
+
+    ZSTD_CCtx *zstd = nullptr;
+    lzma_stream lzma = LZMA_STREAM_INIT;
+};
+
+// ============================================================================
+// Constructors / Destructor
+// ============================================================================
+
+QGCCompressDevice::QGCCompressDevice(QIODevice *sink, QGCCompression::Format format, QObject *parent)
+    : QIODevice(parent)
+    , _sink(sink)
+    , _format(format)
+{
+}
+
+QGCCompressDevice::~QGCCompressDevice()
+{
+    close();
+}
+
+bool QGCCompressDevice::isSupportedFormat(QGCCompression::Format format)
+{
+    return ((format == QGCCompression::Format::ZSTD) || (format == QGCCompression::Format::XZ));
+}
+
+// ============================================================================
+// QIODevice Interface
+// ============================================================================
+
+bool QGCCompressDevice::open(OpenMode mode)
+{
+    if (mode != WriteOnly) {
+        _setError(QStringLiteral("QGCCompressDevice only supports WriteOnly mode"));
+        return false;
+    }
+
+    if (!isSupportedFormat(_format)) {
+        _setError(QStringLiteral("Unsupported compression format: %1").arg(QGCCompression::formatName(_format)));
+        return false;
+    }
+
+    if (!_sink || !_sink->isWritable()) {
+        _setError(QStringLiteral("Sink device is not writable"));
+        return false;
+    }
+
+    if (!_encoder) {
+        _encoder = std::make_unique<Encoder>();
+        if (_format == QGCCompression::Format::ZSTD) {
+            // Default level as before, each frame carries a checksum of its content
+            _encoder->zstd = ZSTD_createCCtx();
+            if (!_encoder->zstd ||
+                ZSTD_isError(ZSTD_CCtx_setParameter(_encoder->zstd, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT)) ||
+                ZSTD_isError(ZSTD_CCtx_setParameter(_encoder->zstd, ZSTD_c_checksumFlag, 1))) {
+                _encoder.reset();
+                _setError(QStringLiteral("Failed to create zstd encoder"));
+                return false;
+            }
+        }
+        _outputBuffer.resize(kOutputBufferSize);
+    }
+
+    _errorString.clear();
+    return QIODevice::open(mode);
+}
+
+void QGCCompressDevice::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    (void) _endFrame();
+    QIODevice::close();
+}
+
+bool QGCCompressDevice::flushFrame()
+{
+    if (!_frameOpen) {
+        return true;
+    }
+
+    if (!_endFrame()) {
+        return false;
+    }
+
+    if (auto *const fileDevice = qobject_cast<QFileDevice*>(_sink)) {
+        (void) fileDevice->flush();
+    }
+
+    return true;
+}
+
+QString QGCCompressDevice::errorString() const
+{
+    if (!_errorString.isEmpty()) {
+        return _errorString;
+    }
+    return QIODevice::errorString();
+}
+
+qint64 QGCCompressDevice::readData(char *, qint64)
+{
+    return -1;  // Write-only device
+}
+
+qint64 QGCCompressDevice::writeData(const char *data, qint64 maxSize)
+{
+    if (maxSize <= 0) {
+        return 0;
+    }
+
+    if (!_frameOpen && !_beginFrame()) {
+        return -1;
+    }
+
+    if (!_encode(data, maxSize, false)) {
+        qCWarning(QGCCompressDeviceLog) << "Write failed:" << _errorString;
+        return -1;
+    }
+
+    return maxSize;
+}
+
+// ============================================================================
+// Private Implementation
+// ============================================================================
+
+void QGCCompressDevice::_setError(const QString &errorString)
+{
+    // Also set the QIODevice error so callers holding a plain QIODevice pointer see it
+    _errorString = errorString;
+    setErrorString(errorString);
+}
+
+bool QGCCompressDevice::_beginFrame()
+{
+    if (_format == QGCCompression::Format::XZ) {
+        // Each frame is a complete .xz stream. Initialising the same lzma_stream again reuses its encoder memory.
+        const lzma_ret result = lzma_easy_encoder(&_encoder->lzma, LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64);
+        if (result != LZMA_OK) {
+            _setError(lzmaErrorString(result));
+            qCWarning(QGCCompressDeviceLog) << "Failed to start frame:" << _errorString;
+            return false;
+        }
+    }
+    // The zstd context starts a new frame by itself once the previous one was ended
+
+    _frameOpen = true;
+    return true;
+}
+
+bool QGCCompressDevice::_endFrame()
+{
+    if (!_frameOpen) {
+        return true;
+    }
+
+    // Ending the frame makes it complete on its own
+    _frameOpen = false;
+    if (!_encode(nullptr, 0, true)) {
+        qCWarning(QGCCompressDeviceLog) << "Failed to finish frame:" << _errorString;
+        if (_format == QGCCompression::Format::ZSTD) {
+            // Drop what is left of the broken frame so the next one starts clean
+            (void) ZSTD_CCtx_reset(_encoder->zstd, ZSTD_reset_session_only);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool QGCCompressDevice::_encode(const char *data, qint64 size, bool endFrame)
+{
+    char *const output = _outputBuffer.data();
+    const size_t outputSize = static_cast<size_t>(_outputBuffer.size());
+
+    if (_format == QGCCompression::Format::ZSTD) {
+        ZSTD_inBuffer input{ data, static_cast<size_t>(size), 0 };
+        const ZSTD_EndDirective directive = endFrame ? ZSTD_e_end : ZSTD_e_continue;
+        while (true) {
+            ZSTD_outBuffer out{ output, outputSize, 0 };
+            const size_t remaining = ZSTD_compressStream2(_encoder->zstd, &out, &input, directive);
+            if (ZSTD_isError(remaining)) {
+                _setError(QString::fromUtf8(ZSTD_getErrorName(remaining)));
+                return false;
+            }
+            if (!_writeSink(output, static_cast<qint64>(out.pos))) {
+                return false;
+            }
+            // Continuing only needs the input consumed, ending needs the frame flushed completely
+            if (endFrame ? (remaining == 0) : (input.pos == input.size)) {
+                return true;
+            }
+        }
+    }
+
+    lzma_stream &stream = _encoder->lzma;
+    stream.next_in = reinterpret_cast<const uint8_t*>(data);
+    stream.avail_in = static_cast<size_t>(size);
+    const lzma_action action = endFrame ? LZMA_FINISH : LZMA_RUN;
+    while (true) {
+        stream.next_out = reinterpret_cast<uint8_t*>(output);
+        stream.avail_out = outputSize;
+        const lzma_ret result = lzma_code(&stream, action);
+        if ((result != LZMA_OK) && (result != LZMA_STREAM_END)) {
+            _setError(lzmaErrorString(result));
+            return false;
+        }
+        if (!_writeSink(output, static_cast<qint64>(outputSize - stream.avail_out))) {
+            return false;
+        }
+        if (endFrame ? (result == LZMA_STREAM_END) : (stream.avail_in == 0)) {
+            return true;
+        }
+    }
+}
+
+bool QGCCompressDevice::_writeSink(const char *data, qint64 size)
+{
+    if ((size > 0) && (_sink->write(data, size) != size)) {
+        _setError(QStringLiteral("Failed to write to sink: %1").arg(_sink->errorString()));
+        return false;
+    }
+
+    return true;
+}
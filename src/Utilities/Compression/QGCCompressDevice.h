@@ -0,0 +1,87 @@
+#pragma once
+
+/// @file QGCCompressDevice.h
+/// @brief QIODevice wrapper for streaming compression
+
+#include "QGCCompression.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+#include <QtCore/QLoggingCategory>
+
+#include <memory>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCCompressDeviceLog)
+
+/// QIODevice wrapper for streaming compression into a single-file format
+/// Supports .zst and .xz output
+/// Write-only, sequential access only
+///
+/// The output is a series of independent compressed frames. flushFrame() ends the current frame so
+/// everything written up to that point can be decompressed even if the writer never gets to close().
+/// Concatenated frames decompress as a single stream, for example with QGCDecompressDevice.
+/// The encoder is created once per device and reset at each frame boundary, its buffers are not reallocated.
+///
+/// Example usage:
+/// @code
+/// QFile file("data.bin.zst");
+/// file.open(QIODevice::WriteOnly);
+/// QGCCompressDevice device(&file, QGCCompression::Format::ZSTD);
+/// device.open(QIODevice::WriteOnly);
+/// device.write(data);
+/// device.close();
+/// @endcode
+class QGCCompressDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /// @param sink Destination for the compressed data (must be open and writable)
+    /// @param format Compression format, see isSupportedFormat()
+    /// @param parent QObject parent
+    /// @note The sink device must remain valid until this device is closed
+    QGCCompressDevice(QIODevice *sink, QGCCompression::Format format, QObject *parent = nullptr);
+    ~QGCCompressDevice() override;
+
+    /// Check if a format can be written
+    /// @return true for ZSTD and XZ
+    static bool isSupportedFormat(QGCCompression::Format format);
+
+    // QIODevice interface
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+
+    /// End the current compressed frame and push it to the sink
+    /// The next write starts a new frame
+    /// @return true on success, sets errorString() on failure
+    bool flushFrame();
+
+    /// Get error description
+    /// @return Error string if error occurred, empty otherwise
+    QString errorString() const;
+
+    QGCCompression::Format format() const { return _format; }
+
+protected:
+    // QIODevice interface
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    struct Encoder;
+
+    void _setError(const QString &errorString);
+    bool _beginFrame();
+    bool _endFrame();
+    /// Compresses @a size bytes into the sink, @a endFrame also finishes the frame
+    bool _encode(const char *data, qint64 size, bool endFrame);
+    bool _writeSink(const char *data, qint64 size);
+
+    QIODevice *_sink = nullptr;
+    const QGCCompression::Format _format;
+    std::unique_ptr<Encoder> _encoder;
+    bool _frameOpen = false;
+    QByteArray _outputBuffer;           ///< Encoder output on its way to the sink
+    QString _errorString;
+};
@@ -9,7 +9,7 @@
 
 /// Unified decompression interface for archives and single-file compression
 /// Uses libarchive for all operations (ZIP, GZIP, XZ, ZSTD, TAR, etc.)
-/// NOTE: This module is decompression-only; QGC does not create compressed files
+/// NOTE: Compressed output is limited to streaming single-file XZ/ZSTD through QGCCompressDevice
 namespace QGCCompression {
 
 // ============================================================================
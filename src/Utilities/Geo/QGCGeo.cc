@@ -305,19 +305,26 @@ double polygonPerimeter(const QList<QGeoCoordinate> &polygon)
     return perimeter;
 }
 
-QList<QGeoCoordinate> interpolatePath(const QGeoCoordinate &from, const QGeoCoordinate &to, int numPoints)
+static int _clampPathPoints(int numPoints)
 {
-    QList<QGeoCoordinate> result;
-
     // Clamp to reasonable bounds to prevent excessive memory allocation
     constexpr int kMaxPoints = 10000;
     if (numPoints < 2) {
-        numPoints = 2;
+        return 2;
     } else if (numPoints > kMaxPoints) {
         qCWarning(QGCGeoLog) << "interpolatePath: numPoints" << numPoints << "exceeds maximum, clamping to" << kMaxPoints;
-        numPoints = kMaxPoints;
+        return kMaxPoints;
     }
 
+    return numPoints;
+}
+
+QList<QGeoCoordinate> interpolatePath(const QGeoCoordinate &from, const QGeoCoordinate &to, int numPoints)
+{
+    QList<QGeoCoordinate> result;
+
+    numPoints = _clampPathPoints(numPoints);
+
     if (from == to) {
         for (int i = 0; i < numPoints; ++i) {
             result.append(from);
@@ -346,6 +353,30 @@ QList<QGeoCoordinate> interpolatePath(const QGeoCoordinate &from, const QGeoCoor
     return result;
 }
 
+void interpolatePath(const QGeoCoordinate &from, const QGeoCoordinate &to, int numPoints, QList<double> &latitudes, QList<double> &longitudes)
+{
+    numPoints = _clampPathPoints(numPoints);
+
+    latitudes.resize(numPoints);
+    longitudes.resize(numPoints);
+
+    if (from == to) {
+        latitudes.fill(from.latitude());
+        longitudes.fill(from.longitude());
+        return;
+    }
+
+    const GeographicLib::GeodesicLine line = GeographicLib::Geodesic::WGS84().InverseLine(
+        from.latitude(), from.longitude(), to.latitude(), to.longitude());
+
+    const double totalDistance = line.Distance();
+
+    for (int i = 0; i < numPoints; ++i) {
+        const double fraction = static_cast<double>(i) / (numPoints - 1);
+        line.Position(totalDistance * fraction, latitudes[i], longitudes[i]);
+    }
+}
+
 QGeoCoordinate interpolateAtDistance(const QGeoCoordinate &from, const QGeoCoordinate &to, double distance)
 {
     if (from == to || distance <= 0.0) {
@@ -184,6 +184,15 @@ double polygonPerimeter(const QList<QGeoCoordinate> &polygon);
 /// @note Uses GeodesicLine internally for efficiency. Altitude is linearly interpolated.
 QList<QGeoCoordinate> interpolatePath(const QGeoCoordinate &from, const QGeoCoordinate &to, int numPoints);
 
+/// Interpolate evenly-spaced points along a geodesic path into packed latitude and longitude arrays.
+/// Same points as interpolatePath() without building a QGeoCoordinate for each, for bulk terrain sampling.
+/// @param from Starting coordinate.
+/// @param to Ending coordinate.
+/// @param numPoints Number of points to generate (must be >= 2).
+/// @param latitudes Receives the latitudes, replacing any previous content.
+/// @param longitudes Receives the longitudes, replacing any previous content.
+void interpolatePath(const QGeoCoordinate &from, const QGeoCoordinate &to, int numPoints, QList<double> &latitudes, QList<double> &longitudes);
+
 /// Get the coordinate at a specific distance along a geodesic path using WGS84 ellipsoid.
 /// @param from Starting coordinate.
 /// @param to Ending coordinate.
@@ -143,7 +143,7 @@ std::optional<int> Platform::initialize(int argc, char* argv[],
 #endif
 
 #if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
-    const bool allowMultiple = args.allowMultiple || args.runningUnitTests || args.listTests;
+    const bool allowMultiple = args.allowMultiple || args.runningUnitTests || args.listTests || args.replayLogFile.has_value();
     if (!checkSingleInstance(allowMultiple)) {
         return showMultipleInstanceError(argc, argv);
     }
@@ -182,6 +182,11 @@ std::optional<int> Platform::initialize(int argc, char* argv[],
     }
 #endif
 
+    // --- Headless log replay: no windows are created ---
+    if (args.replayLogFile && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        (void) qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     // --- Qt attributes ---
     if (args.useDesktopGL) {
         QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
@@ -23,6 +23,7 @@ constexpr QLatin1StringView kOptClearCache    = QLatin1StringView("clear-cache")
 constexpr QLatin1StringView kOptLogging       = QLatin1StringView("logging");
 constexpr QLatin1StringView kOptLogOutput     = QLatin1StringView("log-output");
 constexpr QLatin1StringView kOptSimpleBoot    = QLatin1StringView("simple-boot-test");
+constexpr QLatin1StringView kOptReplayLog     = QLatin1StringView("replay-log");
 
 #if !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
 // --- Desktop-only options ---
@@ -151,6 +152,12 @@ CommandLineParseResult parseCommandLine()
         QCoreApplication::translate("main", "Initialize subsystems and exit."));
     (void) parser.addOption(simpleBootOpt);
 
+    const QCommandLineOption replayLogOpt(
+        QString(kOptReplayLog),
+        QCoreApplication::translate("main", "Replay a telemetry log as fast as possible without UI, report throughput and exit."),
+        QCoreApplication::translate("main", "file"));
+    (void) parser.addOption(replayLogOpt);
+
 #ifdef QGC_UNITTEST_BUILD
     // --- Test options (only in test builds) ---
     const QCommandLineOption unittestOpt(
@@ -330,6 +337,10 @@ CommandLineParseResult parseCommandLine()
     }
     out.logOutput = parser.isSet(logOutputOpt);
     out.simpleBootTest = parser.isSet(simpleBootOpt);
+    if (parser.isSet(replayLogOpt)) {
+        out.replayLogFile = parser.value(replayLogOpt);
+        qCDebug(QGCCommandLineParserLog) << "Replay log:" << out.replayLogFile.value();
+    }
 
 #ifdef QGC_UNITTEST_BUILD
     // --- Parse test options ---
@@ -451,6 +462,9 @@ AppMode determineAppMode(const CommandLineParseResult& args)
     if (args.simpleBootTest) {
         return AppMode::BootTest;
     }
+    if (args.replayLogFile) {
+        return AppMode::LogReplay;
+    }
     return AppMode::Gui;
 }
 
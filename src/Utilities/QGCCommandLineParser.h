@@ -40,6 +40,7 @@ struct CommandLineParseResult
     std::optional<QString> loggingOptions;
     bool logOutput = false;
     bool simpleBootTest = false;
+    std::optional<QString> replayLogFile;   ///< Telemetry log to replay as fast as possible without UI, then exit
 
     // --- Test options (command-line parsing only in QGC_UNITTEST_BUILD) ---
     bool runningUnitTests = false;
@@ -81,6 +82,7 @@ std::optional<int> handleParseResult(const CommandLineParseResult& result);
 enum class AppMode {
     Gui,        ///< Normal GUI application
     BootTest,   ///< Initialize and exit (for CI validation)
+    LogReplay,  ///< Replay a telemetry log without UI and exit
 #ifdef QGC_UNITTEST_BUILD
     Test,       ///< Run unit tests
     ListTests   ///< List available tests and exit
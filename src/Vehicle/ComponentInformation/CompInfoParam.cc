@@ -4,6 +4,7 @@
 #include "FactMetaData.h"
 #include "FirmwarePlugin.h"
 #include "FirmwarePluginManager.h"
+#include "ParameterMetaDataStore.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
 #include "Vehicle.h"
@@ -32,43 +33,57 @@ void CompInfoParam::setJson(const QString& metadataJsonFileName)
         return;
     }
 
-    QString         errorString;
-    QJsonDocument   jsonDoc;
-
     _noJsonMetadata = false;
 
-    if (!JsonParsing::isJsonFile(metadataJsonFileName, jsonDoc, errorString)) {
-        qCWarning(CompInfoParamLog) << "Metadata json file open failed: compid:" << compId << errorString;
-        return;
-    }
-    QJsonObject jsonObj = jsonDoc.object();
-
-    QList<JsonHelper::KeyValidateInfo> keyInfoList = {
-        { JsonHelper::jsonVersionKey,   QJsonValue::Double, true },
-        { _jsonParametersKey,           QJsonValue::Array,  true },
-    };
-    if (!JsonHelper::validateKeys(jsonObj, keyInfoList, errorString)) {
-        qCWarning(CompInfoParamLog) << "Metadata json validation failed: compid:" << compId << errorString;
-        return;
-    }
+    // Vehicles with the same metadata json share the FactMetaData parsed from it, which are the children of the set
+    const uint8_t compId = this->compId;
+    QObject* metaDataSet = ParameterMetaDataStore::instance()->metaDataSet(QStringLiteral("CompInfoParam"), metadataJsonFileName, [metadataJsonFileName, compId](QObject* parent, const QString& /*compiledFile*/) -> QObject* {
+        QString         errorString;
+        QJsonDocument   jsonDoc;
 
-    int version = jsonObj[JsonHelper::jsonVersionKey].toInt();
-    if (version != 1) {
-        qCWarning(CompInfoParamLog) << "Metadata json unsupported version" << version;
-        return;
-    }
+        if (!JsonParsing::isJsonFile(metadataJsonFileName, jsonDoc, errorString)) {
+            qCWarning(CompInfoParamLog) << "Metadata json file open failed: compid:" << compId << errorString;
+            return nullptr;
+        }
+        QJsonObject jsonObj = jsonDoc.object();
+
+        QList<JsonHelper::KeyValidateInfo> keyInfoList = {
+            { JsonHelper::jsonVersionKey,   QJsonValue::Double, true },
+            { _jsonParametersKey,           QJsonValue::Array,  true },
+        };
+        if (!JsonHelper::validateKeys(jsonObj, keyInfoList, errorString)) {
+            qCWarning(CompInfoParamLog) << "Metadata json validation failed: compid:" << compId << errorString;
+            return nullptr;
+        }
+
+        int version = jsonObj[JsonHelper::jsonVersionKey].toInt();
+        if (version != 1) {
+            qCWarning(CompInfoParamLog) << "Metadata json unsupported version" << version;
+            return nullptr;
+        }
 
-    QJsonArray rgParameters = jsonObj[_jsonParametersKey].toArray();
-    for (QJsonValue parameterValue: rgParameters) {
-        QMap<QString, QString> emptyDefineMap;
+        QObject* set = new QObject(parent);
+        QJsonArray rgParameters = jsonObj[_jsonParametersKey].toArray();
+        for (QJsonValue parameterValue: rgParameters) {
+            QMap<QString, QString> emptyDefineMap;
 
-        if (!parameterValue.isObject()) {
-            qCWarning(CompInfoParamLog) << "Metadata json read failed: compid:" << compId << "parameters array contains non-object";
-            return;
+            if (!parameterValue.isObject()) {
+                // Only the malformed entry is lost, the rest of the metadata is still used
+                qCWarning(CompInfoParamLog) << "Metadata json read failed: compid:" << compId << "parameters array contains non-object, skipping entry";
+                continue;
+            }
+
+            (void) FactMetaData::createFromJsonObject(parameterValue.toObject(), emptyDefineMap, set);
         }
 
-        FactMetaData* newMetaData = FactMetaData::createFromJsonObject(parameterValue.toObject(), emptyDefineMap, this);
+        return set;
+    });
+    if (!metaDataSet) {
+        return;
+    }
 
+    const QList<FactMetaData*> rgMetaData = metaDataSet->findChildren<FactMetaData*>(Qt::FindDirectChildrenOnly);
+    for (FactMetaData* newMetaData: rgMetaData) {
         if (newMetaData->name().contains(_indexedNameTag)) {
             _indexedNameMetaDataList.append(RegexFactMetaDataPair_t(newMetaData->name(), newMetaData));
         } else {
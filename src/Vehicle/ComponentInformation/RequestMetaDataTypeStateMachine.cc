@@ -500,6 +500,7 @@ void RequestMetaDataTypeStateMachine::_requestFile(const QString& cacheFileTag,
             _metadataSource = MetadataSource::FTP;
             _metadataUri = uri;
         }
+        _ftpCompId = FTPManager::componentIdForURI(MAV_COMP_ID_AUTOPILOT1, uri);
         connect(ftpManager, &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
         if (ftpManager->download(MAV_COMP_ID_AUTOPILOT1, uri, QStandardPaths::writableLocation(QStandardPaths::TempLocation))) {
             _downloadStartTime.start();
@@ -542,8 +543,12 @@ QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QStri
     return outputFileName;
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg)
+void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileName, const QString& errorMsg, uint8_t compId)
 {
+    if (compId != _ftpCompId) {
+        return;
+    }
+
     qCDebug(RequestMetaDataTypeStateMachineLog) << "_ftpDownloadComplete fileName:errorMsg" << fileName << errorMsg;
 
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadComplete);
@@ -564,8 +569,12 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadComplete(const QString& fileNa
     }
 }
 
-void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress)
+void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress, uint8_t compId)
 {
+    if (compId != _ftpCompId) {
+        return;
+    }
+
     int elapsedSec = _downloadStartTime.elapsed() / 1000;
     float totalDownloadTime = elapsedSec / progress;
 
@@ -573,7 +582,7 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadProgress(float progress)
     const int maxDownloadTimeSec = 40;
     if (elapsedSec > 10 && progress < 0.5 && totalDownloadTime > maxDownloadTimeSec) {
         qCDebug(RequestMetaDataTypeStateMachineLog) << "Slow download, aborting. Total time (s):" << totalDownloadTime;
-        _compInfo->vehicle->ftpManager()->cancelDownload();
+        _compInfo->vehicle->ftpManager()->cancelDownload(_ftpCompId);
     }
 }
 
@@ -70,8 +70,8 @@ class RequestMetaDataTypeStateMachine : public QGCStateMachine
     void _handleCompInfoResult(MAV_RESULT result, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& message);
 
 private slots:
-    void _ftpDownloadComplete(const QString& file, const QString& errorMsg);
-    void _ftpDownloadProgress(float progress);
+    void _ftpDownloadComplete(const QString& file, const QString& errorMsg, uint8_t compId);
+    void _ftpDownloadProgress(float progress, uint8_t compId);
     void _httpDownloadComplete(bool success, const QString& localFile, const QString& errorMsg, bool fromCache);
     void _downloadAndTranslationComplete(QString translatedJsonTempFile, QString errorMsg);
 
@@ -90,6 +90,7 @@ private slots:
     bool _currentFileValidCrc = false;
 
     QElapsedTimer _downloadStartTime;
+    uint8_t _ftpCompId = MAV_COMP_ID_AUTOPILOT1;    ///< Component the current FTP download runs on
     MetadataSource _metadataSource = MetadataSource::None;
     QString _metadataUri;
     bool _metadataIsFallback = false;
@@ -22,14 +22,27 @@ FTPController::FTPController(QObject *parent)
     , _ftpManager(_vehicle->ftpManager())
     , _archiveModel(new QGCArchiveModel(this))
 {
+    // The FTPManager is shared by everything talking to the vehicle, only pass on what belongs to our component
     connect(_ftpManager, &FTPManager::downloadComplete, this, &FTPController::_handleDownloadComplete);
-    connect(_ftpManager, &FTPManager::downloadComplete, this, &FTPController::downloadComplete);
+    connect(_ftpManager, &FTPManager::downloadComplete, this, [this](const QString &filePath, const QString &error, uint8_t compId) {
+        if (compId == _operationCompId) {
+            emit downloadComplete(filePath, error);
+        }
+    });
     connect(_ftpManager, &FTPManager::uploadComplete, this, &FTPController::_handleUploadComplete);
-    connect(_ftpManager, &FTPManager::uploadComplete, this, &FTPController::uploadComplete);
+    connect(_ftpManager, &FTPManager::uploadComplete, this, [this](const QString &remotePath, const QString &error, uint8_t compId) {
+        if (compId == _operationCompId) {
+            emit uploadComplete(remotePath, error);
+        }
+    });
     connect(_ftpManager, &FTPManager::listDirectoryComplete, this, &FTPController::_handleDirectoryComplete);
     connect(_ftpManager, &FTPManager::commandProgress, this, &FTPController::_handleCommandProgress);
     connect(_ftpManager, &FTPManager::deleteComplete, this, &FTPController::_handleDeleteComplete);
-    connect(_ftpManager, &FTPManager::deleteComplete, this, &FTPController::deleteComplete);
+    connect(_ftpManager, &FTPManager::deleteComplete, this, [this](const QString &remotePath, const QString &error, uint8_t compId) {
+        if (compId == _operationCompId) {
+            emit deleteComplete(remotePath, error);
+        }
+    });
 }
 
 bool FTPController::listDirectory(const QString &uri, int componentId)
@@ -52,6 +65,7 @@ bool FTPController::listDirectory(const QString &uri, int componentId)
     emit progressChanged();
 
     const uint8_t compId = _componentIdForRequest(componentId);
+    _operationCompId = FTPManager::componentIdForURI(compId, uri);
     if (!_ftpManager->listDirectory(compId, uri)) {
         qCWarning(FTPControllerLog) << "Failed to start list operation for" << uri;
         _setErrorString(tr("Failed to list %1").arg(uri));
@@ -91,8 +105,10 @@ bool FTPController::downloadFile(const QString &uri, const QString &localDir, co
     _setOperation(Operation::Download);
     _progress = 0.0F;
     emit progressChanged();
+    _setThroughput(0.0);
 
     const uint8_t compId = _componentIdForRequest(componentId);
+    _operationCompId = FTPManager::componentIdForURI(compId, uri);
     if (!_ftpManager->download(compId, uri, absoluteLocalDir, fileName)) {
         qCWarning(FTPControllerLog) << "Failed to start download" << uri << absoluteLocalDir;
         const QString error = tr("Failed to download %1").arg(uri);
@@ -131,8 +147,10 @@ bool FTPController::uploadFile(const QString &localFile, const QString &uri, int
     _setOperation(Operation::Upload);
     _progress = 0.0F;
     emit progressChanged();
+    _setThroughput(0.0);
 
     const uint8_t compId = _componentIdForRequest(componentId);
+    _operationCompId = FTPManager::componentIdForURI(compId, uri);
     if (!_ftpManager->upload(compId, uri, sourceInfo.absoluteFilePath())) {
         qCWarning(FTPControllerLog) << "Failed to start upload" << sourceInfo.absoluteFilePath() << uri;
         const QString error = tr("Failed to upload %1").arg(sourceInfo.fileName());
@@ -160,6 +178,7 @@ bool FTPController::deleteFile(const QString &uri, int componentId)
     _setOperation(Operation::Delete);
 
     const uint8_t compId = _componentIdForRequest(componentId);
+    _operationCompId = FTPManager::componentIdForURI(compId, uri);
     if (!_ftpManager->deleteFile(compId, uri)) {
         qCWarning(FTPControllerLog) << "Failed to start delete" << uri;
         const QString error = tr("Failed to delete %1").arg(uri);
@@ -177,29 +196,30 @@ void FTPController::cancelActiveOperation()
 {
     switch (_operation) {
     case Operation::Download:
-        _ftpManager->cancelDownload();
+        _ftpManager->cancelDownload(_operationCompId);
         break;
     case Operation::Upload:
-        _ftpManager->cancelUpload();
+        _ftpManager->cancelUpload(_operationCompId);
         break;
     case Operation::List:
-        _ftpManager->cancelListDirectory();
+        _ftpManager->cancelListDirectory(_operationCompId);
         break;
     case Operation::Delete:
-        _ftpManager->cancelDelete();
+        _ftpManager->cancelDelete(_operationCompId);
         break;
     case Operation::None:
         break;
     }
 }
 
-void FTPController::_handleDownloadComplete(const QString &filePath, const QString &error)
+void FTPController::_handleDownloadComplete(const QString &filePath, const QString &error, uint8_t compId)
 {
-    if (_operation != Operation::Download) {
+    if ((_operation != Operation::Download) || (compId != _operationCompId)) {
         return;
     }
 
     _setBusy(false);
+    _setThroughput(_ftpManager->statistics(compId).bytesPerSecond);
 
     if (error.isEmpty()) {
         if (!filePath.isEmpty()) {
@@ -218,13 +238,14 @@ void FTPController::_handleDownloadComplete(const QString &filePath, const QStri
     _clearOperation();
 }
 
-void FTPController::_handleUploadComplete(const QString &remotePath, const QString &error)
+void FTPController::_handleUploadComplete(const QString &remotePath, const QString &error, uint8_t compId)
 {
-    if (_operation != Operation::Upload) {
+    if ((_operation != Operation::Upload) || (compId != _operationCompId)) {
         return;
     }
 
     _setBusy(false);
+    _setThroughput(_ftpManager->statistics(compId).bytesPerSecond);
 
     if (error.isEmpty()) {
         _lastUploadTarget = remotePath;
@@ -239,9 +260,9 @@ void FTPController::_handleUploadComplete(const QString &remotePath, const QStri
     _clearOperation();
 }
 
-void FTPController::_handleDirectoryComplete(const QStringList &entries, const QString &error)
+void FTPController::_handleDirectoryComplete(const QStringList &entries, const QString &error, uint8_t compId)
 {
-    if (_operation != Operation::List) {
+    if ((_operation != Operation::List) || (compId != _operationCompId)) {
         return;
     }
 
@@ -261,11 +282,11 @@ void FTPController::_handleDirectoryComplete(const QStringList &entries, const Q
     _clearOperation();
 }
 
-void FTPController::_handleDeleteComplete(const QString &remotePath, const QString &error)
+void FTPController::_handleDeleteComplete(const QString &remotePath, const QString &error, uint8_t compId)
 {
     Q_UNUSED(remotePath)
 
-    if (_operation != Operation::Delete) {
+    if ((_operation != Operation::Delete) || (compId != _operationCompId)) {
         return;
     }
 
@@ -280,13 +301,18 @@ void FTPController::_handleDeleteComplete(const QString &remotePath, const QStri
     _clearOperation();
 }
 
-void FTPController::_handleCommandProgress(float value)
+void FTPController::_handleCommandProgress(float value, uint8_t compId)
 {
+    if (compId != _operationCompId) {
+        return;
+    }
+
     if (_operation == Operation::Download || _operation == Operation::Upload) {
         if (std::fabs(_progress - value) > std::numeric_limits<float>::epsilon()) {
             _progress = value;
             emit progressChanged();
         }
+        _setThroughput(_ftpManager->statistics(compId).bytesPerSecond);
     }
 }
 
@@ -329,6 +355,16 @@ void FTPController::_setErrorString(const QString &error)
     emit errorStringChanged();
 }
 
+void FTPController::_setThroughput(double throughput)
+{
+    if (qFuzzyCompare(_throughput, throughput)) {
+        return;
+    }
+
+    _throughput = throughput;
+    emit throughputChanged();
+}
+
 void FTPController::_resetDirectoryState()
 {
     if (!_directoryEntries.isEmpty()) {
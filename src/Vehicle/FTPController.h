@@ -29,6 +29,7 @@ class FTPController : public QObject
     Q_PROPERTY(bool uploadInProgress READ uploadInProgress NOTIFY activeOperationChanged)
     Q_PROPERTY(bool deleteInProgress READ deleteInProgress NOTIFY activeOperationChanged)
     Q_PROPERTY(float progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(double throughput READ throughput NOTIFY throughputChanged)   ///< Bytes per second of the current or last transfer
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
     Q_PROPERTY(QString currentPath READ currentPath NOTIFY currentPathChanged)
     Q_PROPERTY(QStringList directoryEntries READ directoryEntries NOTIFY directoryEntriesChanged)
@@ -48,6 +49,7 @@ class FTPController : public QObject
     bool uploadInProgress() const { return _operation == Operation::Upload; }
     bool deleteInProgress() const { return _operation == Operation::Delete; }
     float progress() const { return _progress; }
+    double throughput() const { return _throughput; }
     QString errorString() const { return _errorString; }
     QString currentPath() const { return _currentPath; }
     QStringList directoryEntries() const { return _directoryEntries; }
@@ -82,6 +84,7 @@ class FTPController : public QObject
     void busyChanged();
     void activeOperationChanged();
     void progressChanged();
+    void throughputChanged();
     void errorStringChanged();
     void currentPathChanged();
     void directoryEntriesChanged();
@@ -95,11 +98,11 @@ class FTPController : public QObject
     void extractionComplete(const QString &outputDir, const QString &error);
 
 private slots:
-    void _handleDownloadComplete(const QString &filePath, const QString &error);
-    void _handleUploadComplete(const QString &remotePath, const QString &error);
-    void _handleDirectoryComplete(const QStringList &entries, const QString &error);
-    void _handleDeleteComplete(const QString &remotePath, const QString &error);
-    void _handleCommandProgress(float value);
+    void _handleDownloadComplete(const QString &filePath, const QString &error, uint8_t compId);
+    void _handleUploadComplete(const QString &remotePath, const QString &error, uint8_t compId);
+    void _handleDirectoryComplete(const QStringList &entries, const QString &error, uint8_t compId);
+    void _handleDeleteComplete(const QString &remotePath, const QString &error, uint8_t compId);
+    void _handleCommandProgress(float value, uint8_t compId);
     void _handleExtractionProgress(qreal progress);
     void _handleExtractionFinished(bool success);
 
@@ -116,14 +119,17 @@ private slots:
     void _setOperation(Operation operation);
     void _clearOperation();
     void _setErrorString(const QString &error);
+    void _setThroughput(double throughput);
     void _resetDirectoryState();
     uint8_t _componentIdForRequest(int componentId) const;
 
     Vehicle *_vehicle = nullptr;
     FTPManager *_ftpManager = nullptr;
     Operation _operation = Operation::None;
+    uint8_t _operationCompId = MAV_COMP_ID_AUTOPILOT1;     ///< Component the FTPManager runs the operation on
     bool _busy = false;
     float _progress = 0.0F;
+    double _throughput = 0.0;
     QString _errorString;
     QString _currentPath;
     QStringList _directoryEntries;
@@ -0,0 +1,121 @@
+#include "FTPIntervalSet.h"
+
+#include <iterator>
+
+void FTPIntervalSet::add(quint32 start, quint32 end)
+{
+    if (start >= end) {
+        return;
+    }
+
+    // Merge with a preceding interval which overlaps or touches the new one
+    auto it = _intervals.upperBound(start);
+    if (it != _intervals.begin()) {
+        auto previous = std::prev(it);
+        if (previous.value() >= start) {
+            start = previous.key();
+            end = qMax(end, previous.value());
+            (void) _intervals.erase(previous);
+        }
+    }
+
+    // Swallow following intervals which start within the new one
+    it = _intervals.lowerBound(start);
+    while ((it != _intervals.end()) && (it.key() <= end)) {
+        end = qMax(end, it.value());
+        it = _intervals.erase(it);
+    }
+
+    (void) _intervals.insert(start, end);
+}
+
+quint32 FTPIntervalSet::remove(quint32 start, quint32 end)
+{
+    if (start >= end) {
+        return 0;
+    }
+
+    quint32 removed = 0;
+
+    // A preceding interval may reach into the removed range
+    auto it = _intervals.upperBound(start);
+    if (it != _intervals.begin()) {
+        auto previous = std::prev(it);
+        if (previous.value() > start) {
+            const quint32 previousEnd = previous.value();
+            removed += qMin(previousEnd, end) - start;
+            previous.value() = start;
+            if (previous.key() == start) {
+                (void) _intervals.erase(previous);
+            }
+            if (previousEnd > end) {
+                // Range was in the middle of the interval, keep the tail
+                (void) _intervals.insert(end, previousEnd);
+                return removed;
+            }
+        }
+    }
+
+    it = _intervals.lowerBound(start);
+    while ((it != _intervals.end()) && (it.key() < end)) {
+        const quint32 intervalEnd = it.value();
+        removed += qMin(intervalEnd, end) - it.key();
+        it = _intervals.erase(it);
+        if (intervalEnd > end) {
+            (void) _intervals.insert(end, intervalEnd);
+            break;
+        }
+    }
+
+    return removed;
+}
+
+bool FTPIntervalSet::contains(quint32 start, quint32 end) const
+{
+    if (start >= end) {
+        return true;
+    }
+
+    auto it = _intervals.upperBound(start);
+    if (it == _intervals.begin()) {
+        return false;
+    }
+    --it;
+
+    return (it.value() >= end);
+}
+
+bool FTPIntervalSet::intersects(quint32 start, quint32 end) const
+{
+    if (start >= end) {
+        return false;
+    }
+
+    auto it = _intervals.upperBound(start);
+    if ((it != _intervals.begin()) && (std::prev(it).value() > start)) {
+        return true;
+    }
+
+    return ((it != _intervals.end()) && (it.key() < end));
+}
+
+quint64 FTPIntervalSet::size() const
+{
+    quint64 total = 0;
+    for (auto it = _intervals.cbegin(); it != _intervals.cend(); ++it) {
+        total += it.value() - it.key();
+    }
+
+    return total;
+}
+
+QList<FTPIntervalSet::Interval_t> FTPIntervalSet::intervals() const
+{
+    QList<Interval_t> result;
+    result.reserve(_intervals.count());
+    for (auto it = _intervals.cbegin(); it != _intervals.cend(); ++it) {
+        result.append(Interval_t(it.key(), it.value()));
+    }
+
+    return result;
+}
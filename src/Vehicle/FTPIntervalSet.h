@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+
+/// Set of disjoint half open byte ranges [start, end) of a file transfer, such as the ranges which are still
+/// missing from a download. Adjacent and overlapping ranges are merged on insert, removing a range from the
+/// middle of another one splits it.
+class FTPIntervalSet
+{
+public:
+    typedef QPair<quint32, quint32> Interval_t;     ///< start, end (exclusive)
+
+    /// Adds [start, end)
+    void add(quint32 start, quint32 end);
+
+    /// Removes [start, end)
+    ///     @return Number of bytes which were in the set
+    quint32 remove(quint32 start, quint32 end);
+
+    /// @return true if all of [start, end) is in the set
+    bool contains(quint32 start, quint32 end) const;
+
+    /// @return true if any of [start, end) is in the set
+    bool intersects(quint32 start, quint32 end) const;
+
+    bool isEmpty() const { return _intervals.isEmpty(); }
+    int count() const { return _intervals.count(); }
+    void clear() { _intervals.clear(); }
+
+    /// @return Total number of bytes in the set
+    quint64 size() const;
+
+    /// @return Intervals ordered by start
+    QList<Interval_t> intervals() const;
+
+private:
+    QMap<quint32, quint32> _intervals;  ///< Key: start, Value: end
+};
@@ -7,6 +7,7 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <iterator>
 #include <limits>
 
 QGC_LOGGING_CATEGORY(FTPManagerLog, "Vehicle.FTPManager")
@@ -15,15 +16,99 @@ FTPManager::FTPManager(Vehicle* vehicle)
     : QObject   (vehicle)
     , _vehicle  (vehicle)
 {
-    _ackOrNakTimeoutTimer.setSingleShot(true);
-    // Mock link responds immediately if at all, speed up unit tests with faster timeout
-    _ackOrNakTimeoutTimer.setInterval(qgcApp()->runningUnitTests() ? kTestAckTimeoutMs : _ackOrNakTimeoutMsecs);
-    connect(&_ackOrNakTimeoutTimer, &QTimer::timeout, this, &FTPManager::_ackOrNakTimeout);
-
     // Make sure we don't have bad structure packing
     Q_ASSERT(sizeof(MavlinkFTP::RequestHeader) == 12);
+}
+
+FTPManager::~FTPManager()
+{
+    qDeleteAll(_sessions);
+}
+
+FTPManager::Session_t* FTPManager::_sessionFor(uint8_t compId)
+{
+    Session_t* session = _sessions.value(compId);
+    if (session) {
+        return session;
+    }
+
+    session = new Session_t;
+    session->compId = compId;
+    session->downloadState.reset();
+    session->listDirectoryState.reset();
+    session->deleteState.reset();
+    session->uploadState.reset();
+
+    session->ackOrNakTimeoutTimer.setSingleShot(true);
+    // Mock link responds immediately if at all, speed up unit tests with faster timeout
+    session->ackOrNakTimeoutTimer.setInterval(qgcApp()->runningUnitTests() ? kTestAckTimeoutMs : _ackOrNakTimeoutMsecs);
+    (void) connect(&session->ackOrNakTimeoutTimer, &QTimer::timeout, this, [this, session]() {
+        SessionScope scope(this, session);
+        _ackOrNakTimeout();
+    });
+
+    _sessions.insert(compId, session);
 
-    _uploadState.reset();
+    return session;
+}
+
+QList<FTPManager::Session_t*> FTPManager::_sessionsFor(uint8_t compId) const
+{
+    if (compId == MAV_COMP_ID_ALL) {
+        return _sessions.values();
+    }
+
+    Session_t* const session = _sessions.value(compId);
+    return session ? QList<Session_t*>({ session }) : QList<Session_t*>();
+}
+
+uint8_t FTPManager::componentIdForURI(uint8_t fromCompId, const QString& uri)
+{
+    QString parsedURI;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, uri, parsedURI, compId)) {
+        return (fromCompId == MAV_COMP_ID_ALL) ? static_cast<uint8_t>(MAV_COMP_ID_AUTOPILOT1) : fromCompId;
+    }
+
+    return compId;
+}
+
+bool FTPManager::busy(uint8_t compId) const
+{
+    const Session_t* const session = _sessions.value(compId);
+    return (session && !session->rgStateMachine.isEmpty());
+}
+
+FTPManager::Statistics_t FTPManager::statistics(uint8_t compId) const
+{
+    Statistics_t statistics;
+
+    const Session_t* const session = _sessions.value(compId);
+    if (!session) {
+        return statistics;
+    }
+
+    statistics.bytesTransferred = session->transferBytes;
+    statistics.elapsedMs        = session->transferElapsedMs;
+    statistics.bytesPerSecond   = (statistics.elapsedMs > 0) ? (statistics.bytesTransferred * 1000.0 / statistics.elapsedMs) : 0;
+    statistics.readWindow       = session->downloadState.readWindow;
+    statistics.readRequests     = session->downloadState.readRequests;
+    statistics.readRequestsLost = session->downloadState.readRequestsLost;
+
+    return statistics;
+}
+
+void FTPManager::_transferStarted(void)
+{
+    _session->transferTimer.start();
+    _session->transferBytes     = 0;
+    _session->transferElapsedMs = 0;
+}
+
+void FTPManager::_transferProgress(qint64 bytes)
+{
+    _session->transferBytes     += bytes;
+    _session->transferElapsedMs = _session->transferTimer.elapsed();
 }
 
 bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName, bool checksize)
@@ -33,11 +118,20 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
         << "to:" << toDir
         << "fileName:" << fileName;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot download. Already in another operation";
+    QString fullPathOnVehicle;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, fullPathOnVehicle, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    if (busy(compId)) {
+        qCDebug(FTPManagerLog) << "Cannot download. Already in another operation on component" << compId;
         return false;
     }
 
+    SessionScope scope(this, _sessionFor(compId));
+
     static const StateFunctions_t rgDownloadStateMachine[] = {
         { &FTPManager::_openFileROBegin,            &FTPManager::_openFileROAckOrNak,           &FTPManager::_openFileROTimeout },
         { &FTPManager::_burstReadFileBegin,         &FTPManager::_burstReadFileAckOrNak,        &FTPManager::_burstReadFileTimeout },
@@ -46,36 +140,33 @@ bool FTPManager::download(uint8_t fromCompId, const QString& fromURI, const QStr
         { &FTPManager::_downloadCompleteNoError,    nullptr,                                    nullptr },
     };
     for (size_t i=0; i<sizeof(rgDownloadStateMachine)/sizeof(rgDownloadStateMachine[0]); i++) {
-        _rgStateMachine.append(rgDownloadStateMachine[i]);
+        _session->rgStateMachine.append(rgDownloadStateMachine[i]);
     }
 
-    _downloadState.reset();
-    _downloadState.toDir.setPath(toDir);
-    _downloadState.checksize = checksize;
-
-    if (!_parseURI(fromCompId, fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
-        qCWarning(FTPManagerLog) << "_parseURI failed";
-        return false;
-    }
+    _session->downloadState.reset();
+    _session->downloadState.toDir.setPath(toDir);
+    _session->downloadState.checksize = checksize;
+    _session->downloadState.fullPathOnVehicle = fullPathOnVehicle;
 
     // We need to strip off the file name from the fully qualified path. We can't use the usual QDir
     // routines because this path does not exist locally.
     int lastDirSlashIndex;
-    for (lastDirSlashIndex=_downloadState.fullPathOnVehicle.size()-1; lastDirSlashIndex>=0; lastDirSlashIndex--) {
-        if (_downloadState.fullPathOnVehicle[lastDirSlashIndex] == '/') {
+    for (lastDirSlashIndex=_session->downloadState.fullPathOnVehicle.size()-1; lastDirSlashIndex>=0; lastDirSlashIndex--) {
+        if (_session->downloadState.fullPathOnVehicle[lastDirSlashIndex] == '/') {
             break;
         }
     }
     lastDirSlashIndex++; // move past slash
 
     if (fileName.isEmpty()) {
-        _downloadState.fileName = _downloadState.fullPathOnVehicle.right(_downloadState.fullPathOnVehicle.size() - lastDirSlashIndex);
+        _session->downloadState.fileName = _session->downloadState.fullPathOnVehicle.right(_session->downloadState.fullPathOnVehicle.size() - lastDirSlashIndex);
     } else {
-        _downloadState.fileName = fileName;
+        _session->downloadState.fileName = fileName;
     }
 
-    qCDebug(FTPManagerLog) << "_downloadState.fullPathOnVehicle:_downloadState.fileName" << _downloadState.fullPathOnVehicle << _downloadState.fileName;
+    qCDebug(FTPManagerLog) << "fullPathOnVehicle:fileName" << _session->downloadState.fullPathOnVehicle << _session->downloadState.fileName;
 
+    _transferStarted();
     _startStateMachine();
 
     return true;
@@ -85,8 +176,15 @@ bool FTPManager::upload(uint8_t toCompId, const QString& toURI, const QString& f
 {
     qCDebug(FTPManagerLog) << "upload fromFile:" << fromFile << "toURI:" << toURI << "toCompId:" << toCompId;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot upload. Already in another operation";
+    QString fullPathOnVehicle;
+    uint8_t compId;
+    if (!_parseURI(toCompId, toURI, fullPathOnVehicle, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    if (busy(compId)) {
+        qCDebug(FTPManagerLog) << "Cannot upload. Already in another operation on component" << compId;
         return false;
     }
 
@@ -101,28 +199,25 @@ bool FTPManager::upload(uint8_t toCompId, const QString& toURI, const QString& f
         return false;
     }
 
-    _uploadState.reset();
-    _uploadState.localFilePath = fromFile;
-    _uploadState.file.setFileName(fromFile);
-    if (!_uploadState.file.open(QFile::ReadOnly)) {
-        qCWarning(FTPManagerLog) << "Cannot upload. Failed to open file" << fromFile << _uploadState.file.errorString();
-        _uploadState.reset();
-        return false;
-    }
-
-    _uploadState.fileSize         = static_cast<uint32_t>(sourceInfo.size());
-    _uploadState.totalBytesSent = 0;
-    _uploadState.lastChunkSize  = 0;
-    _uploadState.retryCount       = 0;
-    _uploadState.sessionId        = 0;
-    _uploadState.cancelled        = false;
+    SessionScope scope(this, _sessionFor(compId));
 
-    if (!_parseURI(toCompId, toURI, _uploadState.fullPathOnVehicle, _ftpCompId)) {
-        qCWarning(FTPManagerLog) << "_parseURI failed";
-        _uploadState.reset();
+    _session->uploadState.reset();
+    _session->uploadState.localFilePath = fromFile;
+    _session->uploadState.file.setFileName(fromFile);
+    if (!_session->uploadState.file.open(QFile::ReadOnly)) {
+        qCWarning(FTPManagerLog) << "Cannot upload. Failed to open file" << fromFile << _session->uploadState.file.errorString();
+        _session->uploadState.reset();
         return false;
     }
 
+    _session->uploadState.fileSize          = static_cast<uint32_t>(sourceInfo.size());
+    _session->uploadState.totalBytesSent    = 0;
+    _session->uploadState.lastChunkSize     = 0;
+    _session->uploadState.retryCount        = 0;
+    _session->uploadState.sessionId         = 0;
+    _session->uploadState.cancelled         = false;
+    _session->uploadState.fullPathOnVehicle = fullPathOnVehicle;
+
     static const StateFunctions_t rgUploadStateMachine[] = {
         { &FTPManager::_createFileBegin,    &FTPManager::_createFileAckOrNak,       &FTPManager::_createFileTimeout },
         { &FTPManager::_writeFileBegin,     &FTPManager::_writeFileAckOrNak,        &FTPManager::_writeFileTimeout },
@@ -130,9 +225,10 @@ bool FTPManager::upload(uint8_t toCompId, const QString& toURI, const QString& f
         { &FTPManager::_uploadFinalize,     nullptr,                                nullptr },
     };
     for (size_t i=0; i<sizeof(rgUploadStateMachine)/sizeof(rgUploadStateMachine[0]); i++) {
-        _rgStateMachine.append(rgUploadStateMachine[i]);
+        _session->rgStateMachine.append(rgUploadStateMachine[i]);
     }
 
+    _transferStarted();
     _startStateMachine();
 
     return true;
@@ -142,27 +238,32 @@ bool FTPManager::listDirectory(uint8_t fromCompId, const QString& fromURI)
 {
     qCDebug(FTPManagerLog) << "list directory fromURI:" << fromURI << "fromCompId:" << fromCompId;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot list directory. Already in another operation";
+    QString fullPathOnVehicle;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, fullPathOnVehicle, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
         return false;
     }
 
+    if (busy(compId)) {
+        qCDebug(FTPManagerLog) << "Cannot list directory. Already in another operation on component" << compId;
+        return false;
+    }
+
+    SessionScope scope(this, _sessionFor(compId));
+
     static const StateFunctions_t rgStateMachine[] = {
         { &FTPManager::_listDirectoryBegin,             &FTPManager::_listDirectoryAckOrNak,        &FTPManager::_listDirectoryTimeout },
         { &FTPManager::_listDirectoryCompleteNoError,   nullptr,                                    nullptr },
     };
     for (size_t i=0; i<sizeof(rgStateMachine)/sizeof(rgStateMachine[0]); i++) {
-        _rgStateMachine.append(rgStateMachine[i]);
+        _session->rgStateMachine.append(rgStateMachine[i]);
     }
 
-    _listDirectoryState.reset();
+    _session->listDirectoryState.reset();
+    _session->listDirectoryState.fullPathOnVehicle = fullPathOnVehicle;
 
-    if (!_parseURI(fromCompId, fromURI, _listDirectoryState.fullPathOnVehicle, _ftpCompId)) {
-        qCWarning(FTPManagerLog) << "_parseURI failed";
-        return false;
-    }
-
-    qCDebug(FTPManagerLog) << "_listDirectoryState.fullPathOnVehicle" << _listDirectoryState.fullPathOnVehicle;
+    qCDebug(FTPManagerLog) << "fullPathOnVehicle" << _session->listDirectoryState.fullPathOnVehicle;
 
     _startStateMachine();
 
@@ -173,104 +274,121 @@ bool FTPManager::deleteFile(uint8_t fromCompId, const QString& fromURI)
 {
     qCDebug(FTPManagerLog) << "delete file fromURI:" << fromURI << "fromCompId:" << fromCompId;
 
-    if (!_rgStateMachine.isEmpty()) {
-        qCDebug(FTPManagerLog) << "Cannot delete file. Already in another operation";
+    QString fullPathOnVehicle;
+    uint8_t compId;
+    if (!_parseURI(fromCompId, fromURI, fullPathOnVehicle, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    if (busy(compId)) {
+        qCDebug(FTPManagerLog) << "Cannot delete file. Already in another operation on component" << compId;
         return false;
     }
 
+    SessionScope scope(this, _sessionFor(compId));
+
     static const StateFunctions_t rgStateMachine[] = {
         { &FTPManager::_deleteFileBegin,            &FTPManager::_deleteFileAckOrNak,        &FTPManager::_deleteFileTimeout },
         { &FTPManager::_deleteCompleteNoError,      nullptr,                                 nullptr },
     };
     for (size_t i=0; i<sizeof(rgStateMachine)/sizeof(rgStateMachine[0]); i++) {
-        _rgStateMachine.append(rgStateMachine[i]);
+        _session->rgStateMachine.append(rgStateMachine[i]);
     }
 
-    _deleteState.reset();
+    _session->deleteState.reset();
+    _session->deleteState.fullPathOnVehicle = fullPathOnVehicle;
 
-    if (!_parseURI(fromCompId, fromURI, _deleteState.fullPathOnVehicle, _ftpCompId)) {
-        qCWarning(FTPManagerLog) << "_parseURI failed";
-        _rgStateMachine.clear();
-        return false;
-    }
-
-    qCDebug(FTPManagerLog) << "_deleteState.fullPathOnVehicle" << _deleteState.fullPathOnVehicle;
+    qCDebug(FTPManagerLog) << "fullPathOnVehicle" << _session->deleteState.fullPathOnVehicle;
 
     _startStateMachine();
 
     return true;
 }
 
-void FTPManager::cancelDownload()
+void FTPManager::cancelDownload(uint8_t compId)
 {
-    if (!_downloadState.inProgress()) {
-        return;
-    }
+    for (Session_t* const session : _sessionsFor(compId)) {
+        SessionScope scope(this, session);
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    static const StateFunctions_t rgTerminateStateMachine[] = {
-        { &FTPManager::_terminateSessionBegin,  &FTPManager::_terminateSessionAckOrNak,     &FTPManager::_terminateSessionTimeout },
-        { &FTPManager::_terminateComplete,      nullptr,                                    nullptr },
-    };
-    for (size_t i=0; i<sizeof(rgTerminateStateMachine)/sizeof(rgTerminateStateMachine[0]); i++) {
-        _rgStateMachine.append(rgTerminateStateMachine[i]);
+        if (!_session->downloadState.inProgress()) {
+            continue;
+        }
+
+        _session->ackOrNakTimeoutTimer.stop();
+        _session->rgStateMachine.clear();
+        _session->pipelined = false;
+        static const StateFunctions_t rgTerminateStateMachine[] = {
+            { &FTPManager::_terminateSessionBegin,  &FTPManager::_terminateSessionAckOrNak,     &FTPManager::_terminateSessionTimeout },
+            { &FTPManager::_terminateComplete,      nullptr,                                    nullptr },
+        };
+        for (size_t i=0; i<sizeof(rgTerminateStateMachine)/sizeof(rgTerminateStateMachine[0]); i++) {
+            _session->rgStateMachine.append(rgTerminateStateMachine[i]);
+        }
+        _session->downloadState.retryCount = 0;
+        _startStateMachine();
     }
-    _downloadState.retryCount = 0;
-    _startStateMachine();
 }
 
-void FTPManager::cancelListDirectory()
+void FTPManager::cancelListDirectory(uint8_t compId)
 {
-    if (!_listDirectoryState.inProgress()) {
-        return;
-    }
+    for (Session_t* const session : _sessionsFor(compId)) {
+        SessionScope scope(this, session);
 
-    if (_rgStateMachine.isEmpty()) {
-        return;
-    }
+        if (!_session->listDirectoryState.inProgress() || _session->rgStateMachine.isEmpty()) {
+            continue;
+        }
 
-    _listDirectoryComplete(tr("Aborted"));
+        _listDirectoryComplete(tr("Aborted"));
+    }
 }
 
-void FTPManager::cancelUpload()
+void FTPManager::cancelUpload(uint8_t compId)
 {
-    if (!_uploadState.inProgress()) {
-        return;
-    }
+    for (Session_t* const session : _sessionsFor(compId)) {
+        SessionScope scope(this, session);
 
-    _uploadState.cancelled = true;
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
+        if (!_session->uploadState.inProgress()) {
+            continue;
+        }
 
-    if (_uploadState.sessionId != 0) {
-        static const StateFunctions_t rgTerminateStateMachine[] = {
-            { &FTPManager::_terminateUploadSessionBegin, &FTPManager::_terminateUploadSessionAckOrNak, &FTPManager::_terminateUploadSessionTimeout },
-            { &FTPManager::_uploadFinalize,              nullptr,                                      nullptr },
-        };
-        for (size_t i=0; i<sizeof(rgTerminateStateMachine)/sizeof(rgTerminateStateMachine[0]); i++) {
-            _rgStateMachine.append(rgTerminateStateMachine[i]);
+        _session->uploadState.cancelled = true;
+        _session->ackOrNakTimeoutTimer.stop();
+        _session->rgStateMachine.clear();
+
+        if (_session->uploadState.sessionId != 0) {
+            static const StateFunctions_t rgTerminateStateMachine[] = {
+                { &FTPManager::_terminateUploadSessionBegin, &FTPManager::_terminateUploadSessionAckOrNak, &FTPManager::_terminateUploadSessionTimeout },
+                { &FTPManager::_uploadFinalize,              nullptr,                                      nullptr },
+            };
+            for (size_t i=0; i<sizeof(rgTerminateStateMachine)/sizeof(rgTerminateStateMachine[0]); i++) {
+                _session->rgStateMachine.append(rgTerminateStateMachine[i]);
+            }
+            _session->uploadState.retryCount = 0;
+            _startStateMachine();
+        } else {
+            _uploadComplete(tr("Aborted"));
         }
-        _uploadState.retryCount = 0;
-        _startStateMachine();
-    } else {
-        _uploadComplete(tr("Aborted"));
     }
 }
 
-void FTPManager::cancelDelete()
+void FTPManager::cancelDelete(uint8_t compId)
 {
-    if (!_deleteState.inProgress()) {
-        return;
-    }
+    for (Session_t* const session : _sessionsFor(compId)) {
+        SessionScope scope(this, session);
+
+        if (!_session->deleteState.inProgress()) {
+            continue;
+        }
 
-    _deleteComplete(tr("Aborted"));
+        _deleteComplete(tr("Aborted"));
+    }
 }
 
 void FTPManager::_terminateSessionBegin(void)
 {
     MavlinkFTP::Request request{};
-    request.hdr.session = _downloadState.sessionId;
+    request.hdr.session = _session->downloadState.sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdTerminateSession;
     _sendRequestExpectAck(&request);
 }
@@ -282,23 +400,23 @@ void FTPManager::_terminateSessionAckOrNak(const MavlinkFTP::Request *ackOrNak)
         qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
     _advanceStateMachine();
 }
 
 void FTPManager::_terminateSessionTimeout(void)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
+    if (++_session->downloadState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_terminateSessionTimeout retries exceeded");
         _downloadComplete(tr("Download failed"));
     } else {
         // Try again
-        qCDebug(FTPManagerLog) << QString("_terminateSessionTimeout: retrying - retryCount(%1)").arg(_downloadState.retryCount);
+        qCDebug(FTPManagerLog) << QString("_terminateSessionTimeout: retrying - retryCount(%1)").arg(_session->downloadState.retryCount);
         _terminateSessionBegin();
     }
 
@@ -315,20 +433,22 @@ void FTPManager::_downloadComplete(const QString& errorMsg)
 {
     qCDebug(FTPManagerLog) << QString("_downloadComplete: errorMsg(%1)").arg(errorMsg);
 
-    QString downloadFilePath    = _downloadState.toDir.absoluteFilePath(_downloadState.fileName);
+    QString downloadFilePath    = _session->downloadState.toDir.absoluteFilePath(_session->downloadState.fileName);
     QString error               = errorMsg;
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    _currentStateMachineIndex = -1;
-    if (_downloadState.file.isOpen()) {
-        _downloadState.file.close();
+    _session->ackOrNakTimeoutTimer.stop();
+    _session->rgStateMachine.clear();
+    _session->currentStateMachineIndex = -1;
+    _session->pipelined = false;
+    _transferProgress(0);
+    if (_session->downloadState.file.isOpen()) {
+        _session->downloadState.file.close();
         if (!errorMsg.isEmpty()) {
-            _downloadState.file.remove();
+            _session->downloadState.file.remove();
         }
     }
 
-    emit downloadComplete(downloadFilePath, errorMsg);
+    emit downloadComplete(downloadFilePath, errorMsg, _session->compId);
 }
 
 /// Closes out a list directory sequence
@@ -337,30 +457,30 @@ void FTPManager::_listDirectoryComplete(const QString& errorMsg)
 {
     qCDebug(FTPManagerLog) << QString("_listDirectoryComplete: errorMsg(%1)").arg(errorMsg);
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    _currentStateMachineIndex = -1;
+    _session->ackOrNakTimeoutTimer.stop();
+    _session->rgStateMachine.clear();
+    _session->currentStateMachineIndex = -1;
 
-    QStringList rgDirectoryList = _listDirectoryState.rgDirectoryList;
+    QStringList rgDirectoryList = _session->listDirectoryState.rgDirectoryList;
     if (!errorMsg.isEmpty()) {
         rgDirectoryList.clear();
     }
 
-    _listDirectoryState.reset();
+    _session->listDirectoryState.reset();
 
-    emit listDirectoryComplete(errorMsg.isEmpty() ? rgDirectoryList : QStringList(), errorMsg);
+    emit listDirectoryComplete(errorMsg.isEmpty() ? rgDirectoryList : QStringList(), errorMsg, _session->compId);
 }
 
 void FTPManager::_deleteFileBegin(void)
 {
-    qCDebug(FTPManagerLog) << "file" << _deleteState.fullPathOnVehicle;
+    qCDebug(FTPManagerLog) << "file" << _session->deleteState.fullPathOnVehicle;
 
     MavlinkFTP::Request request{};
     request.hdr.session = 0;
     request.hdr.opcode  = MavlinkFTP::kCmdRemoveFile;
     request.hdr.offset  = 0;
     request.hdr.size    = 0;
-    _fillRequestDataWithString(&request, _deleteState.fullPathOnVehicle);
+    _fillRequestDataWithString(&request, _session->deleteState.fullPathOnVehicle);
     _sendRequestExpectAck(&request);
 }
 
@@ -371,12 +491,12 @@ void FTPManager::_deleteFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_deleteFileAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_deleteFileAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_deleteFileAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
         _advanceStateMachine();
@@ -388,11 +508,11 @@ void FTPManager::_deleteFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
 
 void FTPManager::_deleteFileTimeout(void)
 {
-    if (++_deleteState.retryCount > _maxRetry) {
+    if (++_session->deleteState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_deleteFileTimeout retries exceeded");
         _deleteComplete(tr("Delete failed"));
     } else {
-        qCDebug(FTPManagerLog) << QString("_deleteFileTimeout: retrying - retryCount(%1)").arg(_deleteState.retryCount);
+        qCDebug(FTPManagerLog) << QString("_deleteFileTimeout: retrying - retryCount(%1)").arg(_session->deleteState.retryCount);
         _deleteFileBegin();
     }
 }
@@ -401,27 +521,27 @@ void FTPManager::_deleteComplete(const QString& errorMsg)
 {
     qCDebug(FTPManagerLog) << QString("_deleteComplete: errorMsg(%1)").arg(errorMsg);
 
-    const QString deletedPath = _deleteState.fullPathOnVehicle;
+    const QString deletedPath = _session->deleteState.fullPathOnVehicle;
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    _currentStateMachineIndex = -1;
+    _session->ackOrNakTimeoutTimer.stop();
+    _session->rgStateMachine.clear();
+    _session->currentStateMachineIndex = -1;
 
-    _deleteState.reset();
+    _session->deleteState.reset();
 
-    emit deleteComplete(deletedPath, errorMsg);
+    emit deleteComplete(deletedPath, errorMsg, _session->compId);
 }
 
 void FTPManager::_createFileBegin(void)
 {
-    qCDebug(FTPManagerLog) << "file" << _uploadState.fullPathOnVehicle;
+    qCDebug(FTPManagerLog) << "file" << _session->uploadState.fullPathOnVehicle;
 
     MavlinkFTP::Request request{};
     request.hdr.session = 0;
     request.hdr.opcode  = MavlinkFTP::kCmdCreateFile;
     request.hdr.offset  = 0;
     request.hdr.size    = 0;
-    _fillRequestDataWithString(&request, _uploadState.fullPathOnVehicle);
+    _fillRequestDataWithString(&request, _session->uploadState.fullPathOnVehicle);
     _sendRequestExpectAck(&request);
 }
 
@@ -432,28 +552,28 @@ void FTPManager::_createFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
         qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack - sessionId" << ackOrNak->hdr.session;
 
-        _uploadState.sessionId = ackOrNak->hdr.session;
+        _session->uploadState.sessionId = ackOrNak->hdr.session;
         _advanceStateMachine();
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         qCDebug(FTPManagerLog) << "_createFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
+        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_session->uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
     }
 }
 
 void FTPManager::_createFileTimeout(void)
 {
     qCDebug(FTPManagerLog) << "_createFileTimeout";
-    _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_uploadState.fullPathOnVehicle));
+    _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_session->uploadState.fullPathOnVehicle));
 }
 
 void FTPManager::_writeFileBegin(void)
@@ -463,50 +583,50 @@ void FTPManager::_writeFileBegin(void)
 
 void FTPManager::_writeFileWorker(bool firstRequest)
 {
-    if (!_uploadState.file.isOpen()) {
-        _uploadComplete(tr("Upload failed for: %1 - file not open").arg(_uploadState.fullPathOnVehicle));
+    if (!_session->uploadState.file.isOpen()) {
+        _uploadComplete(tr("Upload failed for: %1 - file not open").arg(_session->uploadState.fullPathOnVehicle));
         return;
     }
 
-    if (_uploadState.totalBytesSent >= _uploadState.fileSize) {
+    if (_session->uploadState.totalBytesSent >= _session->uploadState.fileSize) {
         _advanceStateMachine();
         return;
     }
 
-    qCDebug(FTPManagerLog) << "_writeFileWorker: offset:firstRequest:retryCount" << _uploadState.totalBytesSent << firstRequest << _uploadState.retryCount;
+    qCDebug(FTPManagerLog) << "_writeFileWorker: offset:firstRequest:retryCount" << _session->uploadState.totalBytesSent << firstRequest << _session->uploadState.retryCount;
 
     MavlinkFTP::Request request{};
-    request.hdr.session = _uploadState.sessionId;
+    request.hdr.session = _session->uploadState.sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdWriteFile;
-    request.hdr.offset  = _uploadState.totalBytesSent;
+    request.hdr.offset  = _session->uploadState.totalBytesSent;
 
     if (firstRequest) {
-        _uploadState.retryCount = 0;
+        _session->uploadState.retryCount = 0;
     } else {
-        _expectedIncomingSeqNumber -= 2;
+        _session->expectedIncomingSeqNumber -= 2;
     }
 
-    qint64 bytesRemaining = static_cast<qint64>(_uploadState.fileSize) - static_cast<qint64>(_uploadState.totalBytesSent);
+    qint64 bytesRemaining = static_cast<qint64>(_session->uploadState.fileSize) - static_cast<qint64>(_session->uploadState.totalBytesSent);
     qint64 bytesToSend = bytesRemaining;
     if (bytesToSend > static_cast<qint64>(sizeof(request.data))) {
         bytesToSend = sizeof(request.data);
     }
 
-    if (!_uploadState.file.seek(_uploadState.totalBytesSent)) {
-        qCDebug(FTPManagerLog) << "_writeFileWorker: seek failed" << _uploadState.file.errorString();
-        _uploadComplete(tr("Upload failed for: %1 - error reading file").arg(_uploadState.fullPathOnVehicle));
+    if (!_session->uploadState.file.seek(_session->uploadState.totalBytesSent)) {
+        qCDebug(FTPManagerLog) << "_writeFileWorker: seek failed" << _session->uploadState.file.errorString();
+        _uploadComplete(tr("Upload failed for: %1 - error reading file").arg(_session->uploadState.fullPathOnVehicle));
         return;
     }
 
-    qint64 bytesRead = _uploadState.file.read(reinterpret_cast<char*>(request.data), bytesToSend);
+    qint64 bytesRead = _session->uploadState.file.read(reinterpret_cast<char*>(request.data), bytesToSend);
     if (bytesRead != bytesToSend) {
-        qCDebug(FTPManagerLog) << "_writeFileWorker: read failed" << _uploadState.file.errorString();
-        _uploadComplete(tr("Upload failed for: %1 - error reading file").arg(_uploadState.fullPathOnVehicle));
+        qCDebug(FTPManagerLog) << "_writeFileWorker: read failed" << _session->uploadState.file.errorString();
+        _uploadComplete(tr("Upload failed for: %1 - error reading file").arg(_session->uploadState.fullPathOnVehicle));
         return;
     }
 
     request.hdr.size           = static_cast<uint8_t>(bytesRead);
-    _uploadState.lastChunkSize = static_cast<uint32_t>(bytesRead);
+    _session->uploadState.lastChunkSize = static_cast<uint32_t>(bytesRead);
 
     _sendRequestExpectAck(&request);
 }
@@ -519,16 +639,16 @@ void FTPManager::_writeFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.session != _uploadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _uploadState.sessionId;
+    if (ackOrNak->hdr.session != _session->uploadState.sessionId) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _session->uploadState.sessionId;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        if (ackOrNak->hdr.seqNumber < _expectedIncomingSeqNumber) {
-            qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        if (ackOrNak->hdr.seqNumber < _session->expectedIncomingSeqNumber) {
+            qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
             return;
         }
 
@@ -536,46 +656,47 @@ void FTPManager::_writeFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
             qCDebug(FTPManagerLog) << "_writeFileAckOrNak: unexpected ack size expected:actual 0" << ackOrNak->hdr.size;
         }
 
-        _uploadState.totalBytesSent += _uploadState.lastChunkSize;
-        _uploadState.lastChunkSize = 0;
-        _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
+        _session->uploadState.totalBytesSent += _session->uploadState.lastChunkSize;
+        _transferProgress(_session->uploadState.lastChunkSize);
+        _session->uploadState.lastChunkSize = 0;
+        _session->expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
 
-        if (_uploadState.fileSize != 0) {
-            emit commandProgress(static_cast<float>(_uploadState.totalBytesSent) / static_cast<float>(_uploadState.fileSize));
+        if (_session->uploadState.fileSize != 0) {
+            emit commandProgress(static_cast<float>(_session->uploadState.totalBytesSent) / static_cast<float>(_session->uploadState.fileSize), _session->compId);
         }
 
-        if (_uploadState.totalBytesSent >= _uploadState.fileSize) {
+        if (_session->uploadState.totalBytesSent >= _session->uploadState.fileSize) {
             _advanceStateMachine();
         } else {
             _writeFileWorker(true /* firstRequest */);
         }
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
+        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_session->uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
     }
 }
 
 void FTPManager::_writeFileTimeout(void)
 {
-    if (++_uploadState.retryCount > _maxRetry) {
+    if (++_session->uploadState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_writeFileTimeout retries exceeded");
-        _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_uploadState.fullPathOnVehicle));
+        _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_session->uploadState.fullPathOnVehicle));
     } else {
-        qCDebug(FTPManagerLog) << QString("_writeFileTimeout: retrying - retryCount(%1) offset(%2)").arg(_uploadState.retryCount).arg(_uploadState.totalBytesSent);
+        qCDebug(FTPManagerLog) << QString("_writeFileTimeout: retrying - retryCount(%1) offset(%2)").arg(_session->uploadState.retryCount).arg(_session->uploadState.totalBytesSent);
         _writeFileWorker(false /* firstRequest */);
     }
 }
 
 void FTPManager::_terminateUploadSessionBegin(void)
 {
-    if (_uploadState.sessionId == 0) {
+    if (_session->uploadState.sessionId == 0) {
         qCWarning(FTPManagerLog) << "_terminateUploadSessionBegin: No session to terminate";
         _advanceStateMachine();
         return;
     }
 
     MavlinkFTP::Request request{};
-    request.hdr.session = _uploadState.sessionId;
+    request.hdr.session = _session->uploadState.sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdTerminateSession;
     _sendRequestExpectAck(&request);
 }
@@ -587,68 +708,74 @@ void FTPManager::_terminateUploadSessionAckOrNak(const MavlinkFTP::Request* ackO
         qCDebug(FTPManagerLog) << "_terminateUploadSessionAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_terminateUploadSessionAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_terminateUploadSessionAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
         qCDebug(FTPManagerLog) << "_terminateUploadSessionAckOrNak: Ack";
         _advanceStateMachine();
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         qCDebug(FTPManagerLog) << "_terminateUploadSessionAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
-        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
+        _uploadComplete(tr("Upload failed for: %1 - error: %2").arg(_session->uploadState.fullPathOnVehicle).arg(_errorMsgFromNak(ackOrNak)));
     }
 }
 
 void FTPManager::_terminateUploadSessionTimeout(void)
 {
-    if (++_uploadState.retryCount > _maxRetry) {
+    if (++_session->uploadState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_terminateUploadSessionTimeout retries exceeded");
-        _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_uploadState.fullPathOnVehicle));
+        _uploadComplete(tr("Upload failed for: %1 - no response from vehicle").arg(_session->uploadState.fullPathOnVehicle));
     } else {
-        qCDebug(FTPManagerLog) << QString("_terminateUploadSessionTimeout: retrying - retryCount(%1)").arg(_uploadState.retryCount);
+        qCDebug(FTPManagerLog) << QString("_terminateUploadSessionTimeout: retrying - retryCount(%1)").arg(_session->uploadState.retryCount);
         _terminateUploadSessionBegin();
     }
 }
 
 void FTPManager::_uploadFinalize(void)
 {
-    QString error = _uploadState.cancelled ? tr("Aborted for: %1").arg(_uploadState.fullPathOnVehicle) : QString();
+    QString error = _session->uploadState.cancelled ? tr("Aborted for: %1").arg(_session->uploadState.fullPathOnVehicle) : QString();
     _uploadComplete(error);
 }
 
 void FTPManager::_uploadComplete(const QString& errorMsg)
 {
     qCDebug(FTPManagerLog) << QString("_uploadComplete: errorMsg(%1)").arg(errorMsg)
-                           << "local" << _uploadState.localFilePath
-                           << "remote" << _uploadState.fullPathOnVehicle;
+                           << "local" << _session->uploadState.localFilePath
+                           << "remote" << _session->uploadState.fullPathOnVehicle;
 
-    QString remotePath = _uploadState.fullPathOnVehicle;
+    QString remotePath = _session->uploadState.fullPathOnVehicle;
 
-    _ackOrNakTimeoutTimer.stop();
-    _rgStateMachine.clear();
-    _currentStateMachineIndex = -1;
+    _session->ackOrNakTimeoutTimer.stop();
+    _session->rgStateMachine.clear();
+    _session->currentStateMachineIndex = -1;
 
-    if (_uploadState.file.isOpen()) {
-        _uploadState.file.close();
+    if (_session->uploadState.file.isOpen()) {
+        _session->uploadState.file.close();
     }
 
-    _uploadState.reset();
+    _transferProgress(0);
+    _session->uploadState.reset();
 
-    emit uploadComplete(remotePath, errorMsg);
+    emit uploadComplete(remotePath, errorMsg, _session->compId);
 }
 
 void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
 {
-    if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL ||
-            message.sysid != _vehicle->id() || message.compid != _ftpCompId) {
+    if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL || message.sysid != _vehicle->id()) {
         return;
     }
 
-    if (_currentStateMachineIndex == -1) {
+    Session_t* const session = _sessions.value(message.compid);
+    if (!session) {
+        return;
+    }
+    SessionScope scope(this, session);
+
+    if (_session->currentStateMachineIndex == -1) {
         return;
     }
 
@@ -669,10 +796,17 @@ void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
         return;
     }
 
-    // Ignore old/reordered packets (handle wrap-around properly)
+    // Ignore old/reordered packets (handle wrap-around properly). Pipelined requests are answered out of
+    // sequence, anything since the pipeline started is good.
     uint16_t actualIncomingSeqNumber = request->hdr.seqNumber;
-    if ((uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
-        qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _expectedIncomingSeqNumber << actualIncomingSeqNumber
+    bool oldPacket;
+    if (_session->pipelined) {
+        oldPacket = (uint16_t)(actualIncomingSeqNumber - _session->pipelineFirstSeqNumber) > (uint16_t)(_session->expectedIncomingSeqNumber - _session->pipelineFirstSeqNumber);
+    } else {
+        oldPacket = (uint16_t)((_session->expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2);
+    }
+    if (oldPacket) {
+        qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _session->expectedIncomingSeqNumber << actualIncomingSeqNumber
                                << "hdr.opcode:hdr.req_opcode" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
 
         return;
@@ -682,24 +816,24 @@ void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
                            << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode))
                            << request->hdr.seqNumber;
 
-    (this->*_rgStateMachine[_currentStateMachineIndex].ackNakFn)(request);
+    (this->*_session->rgStateMachine[_session->currentStateMachineIndex].ackNakFn)(request);
 }
 
 void FTPManager::_startStateMachine(void)
 {
-    _currentStateMachineIndex = -1;
+    _session->currentStateMachineIndex = -1;
     _advanceStateMachine();
 }
 
 void FTPManager::_advanceStateMachine(void)
 {
-    _currentStateMachineIndex++;
-    (this->*_rgStateMachine[_currentStateMachineIndex].beginFn)();
+    _session->currentStateMachineIndex++;
+    (this->*_session->rgStateMachine[_session->currentStateMachineIndex].beginFn)();
 }
 
 void FTPManager::_ackOrNakTimeout(void)
 {
-    (this->*_rgStateMachine[_currentStateMachineIndex].timeoutFn)();
+    (this->*_session->rgStateMachine[_session->currentStateMachineIndex].timeoutFn)();
 }
 
 void FTPManager::_fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str)
@@ -732,7 +866,7 @@ void FTPManager::_openFileROBegin(void)
     request.hdr.opcode  = MavlinkFTP::kCmdOpenFileRO;
     request.hdr.offset  = 0;
     request.hdr.size    = 0;
-    _fillRequestDataWithString(&request, _downloadState.fullPathOnVehicle);
+    _fillRequestDataWithString(&request, _session->downloadState.fullPathOnVehicle);
     _sendRequestExpectAck(&request);
 }
 
@@ -749,12 +883,12 @@ void FTPManager::_openFileROAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
         qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack  - sessionId:openFileLength" << ackOrNak->hdr.session << ackOrNak->openFileLength;
@@ -765,15 +899,15 @@ void FTPManager::_openFileROAckOrNak(const MavlinkFTP::Request* ackOrNak)
             return;
         }
 
-        _downloadState.sessionId        = ackOrNak->hdr.session;
-        _downloadState.fileSize         = ackOrNak->openFileLength;
-        _downloadState.expectedOffset   = 0;
+        _session->downloadState.sessionId        = ackOrNak->hdr.session;
+        _session->downloadState.fileSize         = ackOrNak->openFileLength;
+        _session->downloadState.expectedOffset   = 0;
 
-        _downloadState.file.setFileName(_downloadState.toDir.filePath(_downloadState.fileName));
-        if (_downloadState.file.open(QFile::WriteOnly | QFile::Truncate)) {
+        _session->downloadState.file.setFileName(_session->downloadState.toDir.filePath(_session->downloadState.fileName));
+        if (_session->downloadState.file.open(QFile::WriteOnly | QFile::Truncate)) {
             _advanceStateMachine();
         } else {
-            qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack _downloadState.file open failed" << _downloadState.file.errorString();
+            qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack file open failed" << _session->downloadState.file.errorString();
             _downloadComplete(tr("Download failed"));
         }
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
@@ -784,19 +918,19 @@ void FTPManager::_openFileROAckOrNak(const MavlinkFTP::Request* ackOrNak)
 
 void FTPManager::_burstReadFileWorker(bool firstRequest)
 {
-    qCDebug(FTPManagerLog) << "_burstReadFileWorker: starting burst at offset:firstRequest:retryCount" << _downloadState.expectedOffset << firstRequest << _downloadState.retryCount;
+    qCDebug(FTPManagerLog) << "_burstReadFileWorker: starting burst at offset:firstRequest:retryCount" << _session->downloadState.expectedOffset << firstRequest << _session->downloadState.retryCount;
 
     MavlinkFTP::Request request{};
-    request.hdr.session = _downloadState.sessionId;
+    request.hdr.session = _session->downloadState.sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdBurstReadFile;
-    request.hdr.offset  = _downloadState.expectedOffset;
+    request.hdr.offset  = _session->downloadState.expectedOffset;
     request.hdr.size    = sizeof(request.data);
 
     if (firstRequest) {
-        _downloadState.retryCount = 0;
+        _session->downloadState.retryCount = 0;
     } else {
         // Must used same sequence number as previous request
-        _expectedIncomingSeqNumber -= 2;
+        _session->expectedIncomingSeqNumber -= 2;
     }
 
     _sendRequestExpectAck(&request);
@@ -815,71 +949,78 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.session != _downloadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
+    if (ackOrNak->hdr.session != _session->downloadState.sessionId) {
+        qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _session->downloadState.sessionId;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        if (ackOrNak->hdr.seqNumber < _expectedIncomingSeqNumber) {
-            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        if (ackOrNak->hdr.seqNumber < _session->expectedIncomingSeqNumber) {
+            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
             return;
         }
 
         qCDebug(FTPManagerLog) << QString("_burstReadFileAckOrNak: Ack offset(%1) size(%2) burstComplete(%3)").arg(ackOrNak->hdr.offset).arg(ackOrNak->hdr.size).arg(ackOrNak->hdr.burstComplete);
 
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
-            if (ackOrNak->hdr.offset > _downloadState.expectedOffset) {
-                // There is a hole in our data, record it as missing and continue on
-                MissingData_t missingData;
-                missingData.offset          = _downloadState.expectedOffset;
-                missingData.cBytesMissing   = ackOrNak->hdr.offset - _downloadState.expectedOffset;
-                _downloadState.rgMissingData.append(missingData);
-                qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: adding missing data offset:cBytesMissing" << missingData.offset << missingData.cBytesMissing;
+        const uint32_t offset   = ackOrNak->hdr.offset;
+        const uint32_t endOffset = offset + ackOrNak->hdr.size;
+
+        if (offset < _session->downloadState.expectedOffset) {
+            // Data we have seen already, or data which fills a hole recorded earlier in the burst
+            if (_session->downloadState.missingData.intersects(offset, endOffset)) {
+                if (!_writeDownloadData(ackOrNak)) {
+                    return;
+                }
             } else {
-                // Offset is past what we have already seen, disregard and wait for something usefule
-                _ackOrNakTimeoutTimer.start();
-                qCDebug(FTPManagerLog) << "_handleBurstReadFileAck: received offset less than expected offset received:expected" << ackOrNak->hdr.offset << _downloadState.expectedOffset;
-                return;
+                qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: received offset less than expected offset received:expected" << offset << _session->downloadState.expectedOffset;
             }
+            _session->ackOrNakTimeoutTimer.start();
+            return;
+        }
+
+        if (offset > _session->downloadState.expectedOffset) {
+            // There is a hole in our data, record it as missing and continue on
+            qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: adding missing data offset:cBytesMissing" << _session->downloadState.expectedOffset << offset - _session->downloadState.expectedOffset;
+            _session->downloadState.missingData.add(_session->downloadState.expectedOffset, offset);
         }
 
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
+        _session->downloadState.file.seek(offset);
+        int bytesWritten = _session->downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
         if (bytesWritten != ackOrNak->hdr.size) {
             _downloadComplete(tr("Download failed: Error saving file"));
             return;
         }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
-        _downloadState.expectedOffset = ackOrNak->hdr.offset + ackOrNak->hdr.size;
+        _session->downloadState.bytesWritten += ackOrNak->hdr.size;
+        _session->downloadState.expectedOffset = endOffset;
+        _transferProgress(ackOrNak->hdr.size);
 
         if (ackOrNak->hdr.burstComplete) {
             // The current burst is done, request next one in offset sequence
-            _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
+            _session->expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
             _burstReadFileWorker(true /* firstRequest */);
         } else {
             // Still within a burst, next ack should come automatically
-            _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber + 1;
-            _ackOrNakTimeoutTimer.start();
+            _session->expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber + 1;
+            _session->ackOrNakTimeoutTimer.start();
         }
 
         // Emit progress last, as cancel could be called in there
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
+        if (_session->downloadState.fileSize != 0) {
+            emit commandProgress((float)(_session->downloadState.bytesWritten) / (float)_session->downloadState.fileSize, _session->compId);
         }
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
         if (errorCode == MavlinkFTP::kErrEOF) {
             // Burst sequence has gone through the whole file
-            if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+            if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
                 qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak: EOF Nak"
                     "with incorrect sequence nr actual:expected"
-                    << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+                    << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
                 /* We have received the EOF Nak but out of sequence, i.e. data is missing */
-                _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
+                _session->expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
                 _burstReadFileWorker(true); /* Retry from last expected offset */
             } else {
                 qCDebug(FTPManagerLog) << "_burstReadFileAckOrNak EOF";
@@ -894,32 +1035,32 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
 
 void FTPManager::_burstReadFileTimeout(void)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
+    if (++_session->downloadState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_burstReadFileTimeout retries exceeded");
         _downloadComplete(tr("Download failed"));
     } else {
         // Try again
-        qCDebug(FTPManagerLog) << QString("_burstReadFileTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
+        qCDebug(FTPManagerLog) << QString("_burstReadFileTimeout: retrying - retryCount(%1) offset(%2)").arg(_session->downloadState.retryCount).arg(_session->downloadState.expectedOffset);
         _burstReadFileWorker(false /* firstReqeust */);
     }
 }
 
 void FTPManager::_listDirectoryWorker(bool firstRequest)
 {
-    qCDebug(FTPManagerLog) << "_listDirectoryWorker: offset:firstRequest:retryCount" << _listDirectoryState.expectedOffset << firstRequest << _listDirectoryState.retryCount;
+    qCDebug(FTPManagerLog) << "_listDirectoryWorker: offset:firstRequest:retryCount" << _session->listDirectoryState.expectedOffset << firstRequest << _session->listDirectoryState.retryCount;
 
     MavlinkFTP::Request request{};
-    request.hdr.session = _downloadState.sessionId;
+    request.hdr.session = _session->downloadState.sessionId;
     request.hdr.opcode  = MavlinkFTP::kCmdListDirectory;
-    request.hdr.offset  = _listDirectoryState.expectedOffset;
+    request.hdr.offset  = _session->listDirectoryState.expectedOffset;
     request.hdr.size    = sizeof(request.data);
-    _fillRequestDataWithString(&request, _listDirectoryState.fullPathOnVehicle);
+    _fillRequestDataWithString(&request, _session->listDirectoryState.fullPathOnVehicle);
 
     if (firstRequest) {
-        _listDirectoryState.retryCount = 0;
+        _session->listDirectoryState.retryCount = 0;
     } else {
         // Must used same sequence number as previous request
-        _expectedIncomingSeqNumber -= 2;
+        _session->expectedIncomingSeqNumber -= 2;
     }
 
     _sendRequestExpectAck(&request);
@@ -939,36 +1080,36 @@ void FTPManager::_listDirectoryAckOrNak(const MavlinkFTP::Request* ackOrNak)
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        if (ackOrNak->hdr.seqNumber < _expectedIncomingSeqNumber) {
-            qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        if (ackOrNak->hdr.seqNumber < _session->expectedIncomingSeqNumber) {
+            qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding Ack due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
             return;
         }
 
         qCDebug(FTPManagerLog) << QString("_listDirectoryAckOrNak: Ack size(%1)").arg(ackOrNak->hdr.size);
 
-        // Parse entries in ackOrNak->data into _listDirectoryState.rgDirectoryList
+        // Parse entries in ackOrNak->data into listDirectoryState.rgDirectoryList
         const char* curDataPtr = (const char*)ackOrNak->data;
         while (curDataPtr < (const char*)ackOrNak->data + ackOrNak->hdr.size) {
             QString dirEntry = curDataPtr;
             curDataPtr += dirEntry.size() + 1;
-            _listDirectoryState.rgDirectoryList.append(dirEntry);
-            _listDirectoryState.expectedOffset++;
+            _session->listDirectoryState.rgDirectoryList.append(dirEntry);
+            _session->listDirectoryState.expectedOffset++;
         }
 
         // Request next set of directory entries
-        _expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
+        _session->expectedIncomingSeqNumber = ackOrNak->hdr.seqNumber;
         _listDirectoryWorker(true /* firstRequest */);
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
         if (errorCode == MavlinkFTP::kErrEOF) {
             // All entries returned
-            if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-                qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding Nak due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-                _ackOrNakTimeoutTimer.start();
+            if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+                qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding Nak due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
+                _session->ackOrNakTimeoutTimer.start();
                 return;
             } else {
                 qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak EOF";
@@ -983,124 +1124,217 @@ void FTPManager::_listDirectoryAckOrNak(const MavlinkFTP::Request* ackOrNak)
 
 void FTPManager::_listDirectoryTimeout(void)
 {
-    if (++_listDirectoryState.retryCount > _maxRetry) {
+    if (++_session->listDirectoryState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_listDirectoryTimeout retries exceeded");
         _listDirectoryComplete(tr("List directory failed"));
     } else {
         // Try again
-        qCDebug(FTPManagerLog) << QString("_listDirectoryTimeout: retrying - retryCount(%1) offset(%2)").arg(_listDirectoryState.retryCount).arg(_listDirectoryState.expectedOffset);
+        qCDebug(FTPManagerLog) << QString("_listDirectoryTimeout: retrying - retryCount(%1) offset(%2)").arg(_session->listDirectoryState.retryCount).arg(_session->listDirectoryState.expectedOffset);
         _listDirectoryWorker(false /* firstReqeust */);
     }
 }
 
-void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
+bool FTPManager::_writeDownloadData(const MavlinkFTP::Request* ackOrNak)
 {
-    if (_downloadState.rgMissingData.count()) {
-        MavlinkFTP::Request request{};
-        MissingData_t&      missingData = _downloadState.rgMissingData.first();
+    const uint32_t offset = ackOrNak->hdr.offset;
 
-        uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytesMissing);
+    _session->downloadState.file.seek(offset);
+    int bytesWritten = _session->downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
+    if (bytesWritten != ackOrNak->hdr.size) {
+        _downloadComplete(tr("Download failed: Error saving file"));
+        return false;
+    }
 
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksBegin: offset:cBytesToRead" << missingData.offset << cBytesToRead;
+    // Only bytes which were still missing count, the rest is a duplicate of what we have
+    const uint32_t cBytesNew = _session->downloadState.missingData.remove(offset, offset + ackOrNak->hdr.size);
+    _session->downloadState.bytesWritten += cBytesNew;
+    _transferProgress(cBytesNew);
 
-        request.hdr.session                 = _downloadState.sessionId;
-        request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
-        request.hdr.offset                  = missingData.offset;
-        request.hdr.size                    = cBytesToRead;
+    return true;
+}
 
-        if (firstRequest) {
-            _downloadState.retryCount = 0;
-        } else {
-            // Must used same sequence number as previous request
-            _expectedIncomingSeqNumber -= 2;
+/// Finds the next missing range which is not already requested
+///     @return false: all missing data is requested
+bool FTPManager::_nextMissingBlock(uint32_t& offset, uint32_t& cBytes) const
+{
+    const QMap<uint32_t, ReadRequest_t>& readsInFlight = _session->downloadState.readsInFlight;
+    const uint32_t maxBytes = sizeof(MavlinkFTP::Request::data);
+
+    for (const FTPIntervalSet::Interval_t& interval : _session->downloadState.missingData.intervals()) {
+        uint32_t start = interval.first;
+        while (start < interval.second) {
+            // Skip over a request in flight which covers start
+            auto next = readsInFlight.upperBound(start);
+            if (next != readsInFlight.cbegin()) {
+                auto previous = std::prev(next);
+                if ((previous.key() + previous.value().cBytes) > start) {
+                    start = previous.key() + previous.value().cBytes;
+                    continue;
+                }
+            }
+
+            uint32_t end = qMin(interval.second, start + maxBytes);
+            if (next != readsInFlight.cend()) {
+                end = qMin(end, next.key());
+            }
+
+            offset = start;
+            cBytes = end - start;
+            return true;
         }
-        _downloadState.expectedOffset = request.hdr.offset;
+    }
+
+    return false;
+}
+
+/// Keeps the read window full of ReadFile requests for missing data, completes once nothing is missing
+void FTPManager::_fillMissingBlocksWorker(void)
+{
+    DownloadState_t& downloadState = _session->downloadState;
+
+    if (downloadState.missingData.isEmpty() && downloadState.readsInFlight.isEmpty()) {
+        _session->pipelined = false;
+        _session->ackOrNakTimeoutTimer.stop();
+
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: complete - readRequests:readRequestsLost" << downloadState.readRequests << downloadState.readRequestsLost;
 
-        _sendRequestExpectAck(&request);
-    } else {
         // We should have the full file now
-        if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
+        if (downloadState.checksize == false || downloadState.bytesWritten == downloadState.fileSize) {
             _advanceStateMachine();
         } else {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: no missing blocks but file still incomplete - bytesWritten:fileSize" << _downloadState.bytesWritten << _downloadState.fileSize;
+            qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: no missing blocks but file still incomplete - bytesWritten:fileSize" << downloadState.bytesWritten << downloadState.fileSize;
             _downloadComplete(tr("Download failed"));
         }
+        return;
     }
+
+    uint32_t offset;
+    uint32_t cBytes;
+    while ((downloadState.readsInFlight.count() < downloadState.readWindow) && _nextMissingBlock(offset, cBytes)) {
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: offset:cBytesToRead:window" << offset << cBytes << downloadState.readWindow;
+
+        MavlinkFTP::Request request{};
+        request.hdr.session = downloadState.sessionId;
+        request.hdr.opcode  = MavlinkFTP::kCmdReadFile;
+        request.hdr.offset  = offset;
+        request.hdr.size    = static_cast<uint8_t>(cBytes);
+
+        downloadState.readsInFlight.insert(offset, { cBytes, downloadState.nextReadSendIndex++ });
+        downloadState.readRequests++;
+
+        _sendRequestExpectAck(&request);
+    }
+
+    // The timeout covers the time since the last response
+    _session->ackOrNakTimeoutTimer.start();
+}
+
+/// Requests which were in flight got no response, shrink the window
+void FTPManager::_readRequestsLost(int count)
+{
+    DownloadState_t& downloadState = _session->downloadState;
+
+    downloadState.readRequestsLost += count;
+    downloadState.readWindow        = qMax(1, downloadState.readWindow / 2);
+    downloadState.readWindowAcks    = 0;
+
+    qCDebug(FTPManagerLog) << "_readRequestsLost: count:window" << count << downloadState.readWindow;
 }
 
 void FTPManager::_fillMissingBlocksBegin(void)
 {
-    _fillMissingBlocksWorker(true /* firstRequest */);
+    _session->downloadState.retryCount = 0;
+    _session->downloadState.readsInFlight.clear();
+    _session->pipelined = true;
+    _session->pipelineFirstSeqNumber = _session->expectedIncomingSeqNumber + 2;    // Response to the next request
+    _fillMissingBlocksWorker();
 }
 
 void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
 {
+    DownloadState_t& downloadState = _session->downloadState;
     MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
 
     if (requestOpCode != MavlinkFTP::kCmdReadFile) {
         qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
-        return;
-    }
-    if (ackOrNak->hdr.session != _downloadState.sessionId) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _downloadState.sessionId;
+    if (ackOrNak->hdr.session != downloadState.sessionId) {
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << downloadState.sessionId;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
-    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
+    const uint32_t offset = ackOrNak->hdr.offset;
 
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
-            if (++_downloadState.retryCount > _maxRetry) {
-                qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: offset mismatch, retries exceeded");
-                _downloadComplete(tr("Download failed"));
-                return;
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack offset:size" << offset << ackOrNak->hdr.size;
+
+        auto readRequest = downloadState.readsInFlight.find(offset);
+        if (readRequest != downloadState.readsInFlight.end()) {
+            const quint64 sendIndex = readRequest.value().sendIndex;
+            const uint32_t cBytesRequested = readRequest.value().cBytes;
+            (void) downloadState.readsInFlight.erase(readRequest);
+
+            // Responses come back in the order the requests went out, requests sent before this one
+            // which are still unanswered were lost
+            int lost = 0;
+            for (auto it = downloadState.readsInFlight.begin(); it != downloadState.readsInFlight.end();) {
+                if (it.value().sendIndex < sendIndex) {
+                    it = downloadState.readsInFlight.erase(it);
+                    lost++;
+                } else {
+                    ++it;
+                }
+            }
+            if (lost > 0) {
+                _readRequestsLost(lost);
+            } else if (++downloadState.readWindowAcks >= downloadState.readWindow) {
+                downloadState.readWindow = qMin(downloadState.readWindow + 1, kMaxReadWindow);
+                downloadState.readWindowAcks = 0;
             }
 
-            // Ask for current offset again
-            qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: Ack offset mismatch retry, retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-            _fillMissingBlocksWorker(false /* firstReqeust */);
-            return;
+            if (ackOrNak->hdr.size == 0) {
+                // Nothing past offset, the file is shorter than the open response said
+                if (downloadState.checksize) {
+                    qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: empty read before end of file offset" << offset;
+                    _downloadComplete(tr("Download failed"));
+                    return;
+                }
+                (void) downloadState.missingData.remove(offset, offset + cBytesRequested);
+            }
+        } else {
+            // Late response to a request we considered lost, or a duplicate. Its data is still good.
+            qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack for request not in flight offset" << offset;
         }
 
-        _downloadState.file.seek(ackOrNak->hdr.offset);
-        int bytesWritten = _downloadState.file.write((const char*)ackOrNak->data, ackOrNak->hdr.size);
-        if (bytesWritten != ackOrNak->hdr.size) {
-            _downloadComplete(tr("Download failed: Error saving file"));
-            return;
-        }
-        _downloadState.bytesWritten += ackOrNak->hdr.size;
-
-        MissingData_t& missingData = _downloadState.rgMissingData.first();
-        missingData.offset += ackOrNak->hdr.size;
-        missingData.cBytesMissing -= ackOrNak->hdr.size;
-        if (missingData.cBytesMissing == 0) {
-            // This block is finished, remove it
-            _downloadState.rgMissingData.takeFirst();
+        if ((ackOrNak->hdr.size != 0) && downloadState.missingData.intersects(offset, offset + ackOrNak->hdr.size)) {
+            if (!_writeDownloadData(ackOrNak)) {
+                return;
+            }
         }
+        downloadState.retryCount = 0;
 
-        // Move on to fill in possible next hole
-        _fillMissingBlocksWorker(true /* firstReqeust */);
+        // Move on to fill in remaining holes
+        _fillMissingBlocksWorker();
 
         // Emit progress last, as cancel could be called in there
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize);
+        if (downloadState.fileSize != 0) {
+            emit commandProgress((float)(downloadState.bytesWritten) / (float)downloadState.fileSize, _session->compId);
         }
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
-        if (errorCode == MavlinkFTP::kErrEOF) {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak EOF";
-            if (_downloadState.checksize == false || _downloadState.bytesWritten == _downloadState.fileSize) {
-                // We've successfully complete filling in all missing blocks
-                _advanceStateMachine();
-                return;
+        if ((errorCode == MavlinkFTP::kErrEOF) && !downloadState.checksize) {
+            // The file ends before the data we are missing, nothing left to read past offset
+            qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak EOF offset" << offset;
+            (void) downloadState.missingData.remove(offset, std::numeric_limits<uint32_t>::max());
+            for (auto it = downloadState.readsInFlight.begin(); it != downloadState.readsInFlight.end();) {
+                it = (it.key() >= offset) ? downloadState.readsInFlight.erase(it) : std::next(it);
             }
+            _fillMissingBlocksWorker();
+            return;
         }
 
         qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
@@ -1110,13 +1344,18 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
 
 void FTPManager::_fillMissingBlocksTimeout(void)
 {
-    if (++_downloadState.retryCount > _maxRetry) {
+    DownloadState_t& downloadState = _session->downloadState;
+
+    if (++downloadState.retryCount > _maxRetry) {
         qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout retries exceeded");
         _downloadComplete(tr("Download failed"));
     } else {
-        // Ask for current offset again
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-        _fillMissingBlocksWorker(false /* firstReqeust */);
+        // Nothing came back for the whole window, ask again for everything that is missing
+        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) inFlight(%2)").arg(downloadState.retryCount).arg(downloadState.readsInFlight.count());
+        const int lost = downloadState.readsInFlight.count();
+        downloadState.readsInFlight.clear();
+        _readRequestsLost(lost);
+        _fillMissingBlocksWorker();
     }
 }
 
@@ -1136,12 +1375,12 @@ void FTPManager::_resetSessionsAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (ackOrNak->hdr.seqNumber != _session->expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _session->expectedIncomingSeqNumber;
         return;
     }
 
-    _ackOrNakTimeoutTimer.stop();
+    _session->ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
         qCDebug(FTPManagerLog) << "_resetSessionsAckOrNak: Ack";
@@ -1160,12 +1399,12 @@ void FTPManager::_resetSessionsTimeout(void)
 
 void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
 {
-    _ackOrNakTimeoutTimer.start();
+    _session->ackOrNakTimeoutTimer.start();
 
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (sharedLink) {
-        request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
-        _expectedIncomingSeqNumber += 2;
+        request->hdr.seqNumber = _session->expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
+        _session->expectedIncomingSeqNumber += 2;
 
         qCDebug(FTPManagerLog) << "_sendRequestExpectAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
 
@@ -1176,7 +1415,7 @@ void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
                                                      &message,
                                                      0,                                                     // Target network, 0=broadcast?
                                                      _vehicle->id(),
-                                                     _ftpCompId,
+                                                     _session->compId,
                                                      (uint8_t*)request);                                    // Payload
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     } else {
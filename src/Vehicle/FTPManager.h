@@ -1,17 +1,27 @@
 #pragma once
 
 #include "MAVLinkFTP.h"
+#include "FTPIntervalSet.h"
 
 #include <QtCore/QObject>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
 #include <QtCore/QTimer>
 #include <QtCore/QLoggingCategory>
 
+#include <utility>
+
 Q_DECLARE_LOGGING_CATEGORY(FTPManagerLog)
 
 class Vehicle;
 
+/// MAVLink FTP client of a vehicle.
+/// Each component of the vehicle has its own session: operations on different components run concurrently,
+/// a component runs one operation at a time. Completion and progress signals carry the component id the
+/// operation runs on, see componentIdForURI.
 class FTPManager : public QObject
 {
     Q_OBJECT
@@ -20,6 +30,7 @@ class FTPManager : public QObject
 
 public:
     FTPManager(Vehicle* vehicle);
+    ~FTPManager();
 
 	/// Downloads the specified file.
     ///     @param fromCompId Component id of the component to download from. If fromCompId is MAV_COMP_ID_ALL, then MAV_COMP_ID_AUTOPILOT1 is used.
@@ -32,7 +43,7 @@ class FTPManager : public QObject
     ///                       and the indicated filesize from MAVFTP fileopen response is ignored.
     ///                       This is used for the APM parameter download where the filesize is wrong due to
     ///                       a dynamic file creation on the vehicle.
-    /// @return true: download has started, false: error, no download
+    /// @return true: download has started, false: error or the component is busy, no download
     /// Signals downloadComplete, commandProgress
     bool download(uint8_t fromCompId, const QString& fromURI, const QString& toDir, const QString& fileName="", bool checksize = true);
 
@@ -61,34 +72,51 @@ class FTPManager : public QObject
 
     /// Cancel the download operation
     /// This will emit downloadComplete() when done, and if there's currently a download in progress
-    void cancelDownload();
+    ///     @param compId Component to cancel the download of, MAV_COMP_ID_ALL cancels the downloads of all components
+    void cancelDownload(uint8_t compId = MAV_COMP_ID_ALL);
 
     /// Cancel the list directory operation if running.
     /// This will emit listDirectoryComplete() with an error string when finished.
-    void cancelListDirectory();
+    void cancelListDirectory(uint8_t compId = MAV_COMP_ID_ALL);
 
     /// Cancel the delete operation if running.
     /// This will emit deleteComplete() with an error string when finished.
-    void cancelDelete();
+    void cancelDelete(uint8_t compId = MAV_COMP_ID_ALL);
 
     /// Cancel the upload operation
     /// This will emit uploadComplete() when done, and if there's currently an upload in progress
-    void cancelUpload();
+    void cancelUpload(uint8_t compId = MAV_COMP_ID_ALL);
+
+    /// @return Component id an operation on @a uri requested from @a fromCompId runs on, which is the one the
+    ///         completion and progress signals of the operation carry
+    static uint8_t componentIdForURI(uint8_t fromCompId, const QString& uri);
+
+    /// @return true if an operation is running on @a compId
+    bool busy(uint8_t compId) const;
+
+    struct Statistics_t {
+        qint64  bytesTransferred    = 0;    ///< Bytes transferred by the current or last transfer
+        qint64  elapsedMs           = 0;    ///< Duration of the current or last transfer
+        double  bytesPerSecond      = 0;
+        int     readWindow          = 0;    ///< ReadFile requests kept in flight while filling gaps
+        int     readRequests        = 0;    ///< ReadFile requests sent while filling gaps
+        int     readRequestsLost    = 0;    ///< ReadFile requests which were not answered
+    };
+
+    /// @return Statistics of the current or last transfer on @a compId
+    Statistics_t statistics(uint8_t compId) const;
 
     static constexpr const char* mavlinkFTPScheme = "mftp";
 
 signals:
-    void downloadComplete       (const QString& file, const QString& errorMsg);
-    void uploadComplete         (const QString& file, const QString& errorMsg);
-    void listDirectoryComplete  (const QStringList& dirList, const QString& errorMsg);
-    void deleteComplete         (const QString& file, const QString& errorMsg);
+    void downloadComplete       (const QString& file, const QString& errorMsg, uint8_t compId);
+    void uploadComplete         (const QString& file, const QString& errorMsg, uint8_t compId);
+    void listDirectoryComplete  (const QStringList& dirList, const QString& errorMsg, uint8_t compId);
+    void deleteComplete         (const QString& file, const QString& errorMsg, uint8_t compId);
 
     /// Signalled during a lengthy command to show progress
     ///     @param value Amount of progress: 0.0 = none, 1.0 = complete
-    void commandProgress(float value);
-
-private slots:
-    void _ackOrNakTimeout(void);
+    void commandProgress(float value, uint8_t compId);
 
 private:
     typedef void (FTPManager::*StateBeginFn)    (void);
@@ -101,16 +129,22 @@ private slots:
         StateTimeoutFn  timeoutFn;
     };
 
-    struct MissingData_t {
-        uint32_t offset;
-        uint32_t cBytesMissing;
+    struct ReadRequest_t {
+        uint32_t    cBytes;                             ///< Bytes requested
+        quint64     sendIndex;                          ///< Order the request was sent in
     };
 
     struct DownloadState_t {
         uint8_t                 sessionId;
         uint32_t                expectedOffset;         ///< offset which should be coming next
         uint32_t                bytesWritten;
-        QList<MissingData_t>    rgMissingData;
+        FTPIntervalSet          missingData;            ///< Ranges which were skipped by the burst
+        QMap<uint32_t, ReadRequest_t> readsInFlight;    ///< Pipelined ReadFile requests filling missingData, by offset
+        quint64                 nextReadSendIndex;
+        int                     readWindow;             ///< Number of ReadFile requests kept in flight
+        int                     readWindowAcks;         ///< Acks received since the window last grew
+        int                     readRequests;
+        int                     readRequestsLost;
         QString                 fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
         QDir                    toDir;                  ///< Directory to download file to
         QString                 fileName;               ///< Filename (no path) for download file
@@ -122,14 +156,20 @@ private slots:
         bool inProgress() const { return fileSize > 0; }
 
         void reset() {
-            sessionId       = 0;
-            expectedOffset  = 0;
-            bytesWritten    = 0;
-            retryCount      = 0;
-            fileSize        = 0;
+            sessionId           = 0;
+            expectedOffset      = 0;
+            bytesWritten        = 0;
+            retryCount          = 0;
+            fileSize            = 0;
+            nextReadSendIndex   = 0;
+            readWindow          = kInitialReadWindow;
+            readWindowAcks      = 0;
+            readRequests        = 0;
+            readRequestsLost    = 0;
             fullPathOnVehicle.clear();
             fileName.clear();
-            rgMissingData.clear();
+            missingData.clear();
+            readsInFlight.clear();
             file.close();
         }
     };
@@ -190,6 +230,39 @@ private slots:
         }
     };
 
+    /// Operation state of one component
+    struct Session_t {
+        uint8_t                 compId;
+        QList<StateFunctions_t> rgStateMachine;
+        DownloadState_t         downloadState;
+        ListDirectoryState_t    listDirectoryState;
+        DeleteFileState_t       deleteState;
+        UploadState_t           uploadState;
+        QTimer                  ackOrNakTimeoutTimer;
+        int                     currentStateMachineIndex    = -1;
+        uint16_t                expectedIncomingSeqNumber   = 0;
+        bool                    pipelined                   = false;    ///< Responses are matched by offset, not by sequence number
+        uint16_t                pipelineFirstSeqNumber      = 0;        ///< Sequence number of the first pipelined response
+        QElapsedTimer           transferTimer;
+        qint64                  transferBytes               = 0;
+        qint64                  transferElapsedMs           = 0;
+    };
+
+    /// Makes a session the one the state machine functions operate on until the scope ends
+    class SessionScope {
+    public:
+        SessionScope(FTPManager* manager, Session_t* session) : _manager(manager), _previousSession(std::exchange(manager->_session, session)) {}
+        ~SessionScope() { _manager->_session = _previousSession; }
+    private:
+        FTPManager* _manager;
+        Session_t*  _previousSession;
+    };
+
+    Session_t*          _sessionFor     (uint8_t compId);
+    QList<Session_t*>   _sessionsFor    (uint8_t compId) const;
+    void    _ackOrNakTimeout            (void);
+    void    _transferStarted            (void);
+    void    _transferProgress           (qint64 bytes);
     void    _mavlinkMessageReceived     (const mavlink_message_t& message);
     void    _startStateMachine          (void);
     void    _advanceStateMachine        (void);
@@ -213,10 +286,13 @@ private slots:
     void    _downloadCompleteNoError    (void) { _downloadComplete(QString()); }
     void    _downloadComplete           (const QString& errorMsg);
     void    _fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str);
-    void    _fillMissingBlocksWorker    (bool firstRequest);
+    void    _fillMissingBlocksWorker    (void);
+    bool    _nextMissingBlock           (uint32_t& offset, uint32_t& cBytes) const;
+    void    _readRequestsLost           (int count);
+    bool    _writeDownloadData          (const MavlinkFTP::Request* ackOrNak);
     void    _burstReadFileWorker        (bool firstRequest);
     void    _listDirectoryWorker        (bool firstRequest);
-    bool    _parseURI                   (uint8_t fromCompId, const QString& uri, QString& parsedURI, uint8_t& compId);
+    static bool _parseURI               (uint8_t fromCompId, const QString& uri, QString& parsedURI, uint8_t& compId);
     void    _listDirectoryCompleteNoError(void) { _listDirectoryComplete(QString()); }
     void    _listDirectoryComplete      (const QString& errorMsg);
     void    _deleteFileBegin            (void);
@@ -243,20 +319,16 @@ private slots:
     void    _terminateSessionTimeout    (void);
     void    _terminateComplete          (void);
 
-    Vehicle*                _vehicle;
-    uint8_t                 _ftpCompId = MAV_COMP_ID_AUTOPILOT1;
-    QList<StateFunctions_t> _rgStateMachine;
-    DownloadState_t         _downloadState;
-    ListDirectoryState_t    _listDirectoryState;
-    DeleteFileState_t       _deleteState;
-    UploadState_t           _uploadState;
-    QTimer                  _ackOrNakTimeoutTimer;
-    int                     _currentStateMachineIndex   = -1;
-    uint16_t                _expectedIncomingSeqNumber  = 0;
+    Vehicle*                    _vehicle;
+    QHash<uint8_t, Session_t*>  _sessions;              ///< Sessions by component id
+    Session_t*                  _session = nullptr;     ///< Session the state machine functions operate on
 
     static const int _ackOrNakTimeoutMsecs  = 1000;
     static const int _maxRetry              = 3;
 
+    static constexpr int kInitialReadWindow = 4;
+    static constexpr int kMaxReadWindow     = 16;
+
 public:
     /// Ack timeout used in unit tests (much shorter for faster tests)
     static constexpr int kTestAckTimeoutMs = 10;
@@ -1,7 +1,7 @@
 #include "BatteryFactGroupListModel.h"
 
 BatteryFactGroupListModel::BatteryFactGroupListModel(QObject* parent)
-    : FactGroupListModel("battery", parent)
+    : FactGroupListModel("battery", { MAVLINK_MSG_ID_HIGH_LATENCY, MAVLINK_MSG_ID_HIGH_LATENCY2, MAVLINK_MSG_ID_BATTERY_STATUS }, parent)
 {
 
 }
@@ -33,8 +33,10 @@ FactGroupWithId *BatteryFactGroupListModel::_createFactGroupWithId(uint32_t id)
 }
 
 BatteryFactGroup::BatteryFactGroup(uint32_t batteryId, QObject *parent)
-    : FactGroupWithId(1000, QStringLiteral(":/json/Vehicle/BatteryFact.json"), parent)
+    : FactGroupWithId(1000, QStringLiteral(":/json/Vehicle/BatteryFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_HIGH_LATENCY, MAVLINK_MSG_ID_HIGH_LATENCY2, MAVLINK_MSG_ID_BATTERY_STATUS });
+
     _addFact(&_batteryFunctionFact);
     _addFact(&_batteryTypeFact);
     _addFact(&_voltageFact);
@@ -2,7 +2,7 @@
 #include "QGCMAVLink.h"
 
 EscStatusFactGroupListModel::EscStatusFactGroupListModel(QObject* parent)
-    : FactGroupListModel("escStatus", parent)
+    : FactGroupListModel("escStatus", { MAVLINK_MSG_ID_ESC_INFO, MAVLINK_MSG_ID_ESC_STATUS }, parent)
 {
 
 }
@@ -51,8 +51,10 @@ FactGroupWithId *EscStatusFactGroupListModel::_createFactGroupWithId(uint32_t id
 }
 
 EscStatusFactGroup::EscStatusFactGroup(uint32_t escIndex, QObject *parent)
-    : FactGroupWithId(1000, QStringLiteral(":/json/Vehicle/EscStatusFactGroup.json"), parent)
+    : FactGroupWithId(1000, QStringLiteral(":/json/Vehicle/EscStatusFactGroup.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ESC_INFO, MAVLINK_MSG_ID_ESC_STATUS });
+
     _addFact(&_rpmFact);
     _addFact(&_currentFact);
     _addFact(&_voltageFact);
@@ -1,8 +1,10 @@
 #include "TerrainFactGroup.h"
 
 TerrainFactGroup::TerrainFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/TerrainFactGroup.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/TerrainFactGroup.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({}); // Values are not updated from incoming messages
+
     _addFact(&_blocksPendingFact);
     _addFact(&_blocksLoadedFact);
 }
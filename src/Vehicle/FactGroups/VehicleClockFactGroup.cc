@@ -2,8 +2,10 @@
 #include "QGCApplication.h"
 
 VehicleClockFactGroup::VehicleClockFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/ClockFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/ClockFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({}); // Values are not updated from incoming messages
+
     _addFact(&_currentTimeFact);
     _addFact(&_currentUTCTimeFact);
     _addFact(&_currentDateFact);
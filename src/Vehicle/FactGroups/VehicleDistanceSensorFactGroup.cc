@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleDistanceSensorFactGroup::VehicleDistanceSensorFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/DistanceSensorFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/DistanceSensorFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_DISTANCE_SENSOR });
+
     _addFact(&_rotationNoneFact);
     _addFact(&_rotationYaw45Fact);
     _addFact(&_rotationYaw90Fact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleEFIFactGroup::VehicleEFIFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/EFIFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/EFIFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_EFI_STATUS });
+
     _addFact(&_healthFact);
     _addFact(&_ecuIndexFact);
     _addFact(&_rpmFact);
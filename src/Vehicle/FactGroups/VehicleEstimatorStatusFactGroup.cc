@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleEstimatorStatusFactGroup::VehicleEstimatorStatusFactGroup(QObject *parent)
-    : FactGroup(500, QStringLiteral(":/json/Vehicle/EstimatorStatusFactGroup.json"), parent)
+    : FactGroup(500, QStringLiteral(":/json/Vehicle/EstimatorStatusFactGroup.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ESTIMATOR_STATUS });
+
     _addFact(&_goodAttitudeEstimateFact);
     _addFact(&_goodHorizVelEstimateFact);
     _addFact(&_goodVertVelEstimateFact);
@@ -5,6 +5,14 @@
 
 #include <QtPositioning/QGeoCoordinate>
 
+VehicleGPS2FactGroup::VehicleGPS2FactGroup(QObject *parent)
+    : VehicleGPSFactGroup(parent)
+{
+    _setHandledMessageIds({ MAVLINK_MSG_ID_GPS2_RAW, MAVLINK_MSG_ID_GNSS_INTEGRITY });
+
+    _gnssIntegrityId = 1;
+}
+
 void VehicleGPS2FactGroup::handleMessage(Vehicle *vehicle, const mavlink_message_t &message)
 {
     Q_UNUSED(vehicle);
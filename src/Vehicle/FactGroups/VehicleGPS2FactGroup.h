@@ -7,11 +7,7 @@ class VehicleGPS2FactGroup : public VehicleGPSFactGroup
     Q_OBJECT
 
 public:
-    explicit VehicleGPS2FactGroup(QObject *parent = nullptr)
-        : VehicleGPSFactGroup(parent)
-    {
-        _gnssIntegrityId = 1;
-    }
+    explicit VehicleGPS2FactGroup(QObject *parent = nullptr);
 
     // Overrides from VehicleGPSFactGroup
     void handleMessage(Vehicle *vehicle, const mavlink_message_t &message) final;
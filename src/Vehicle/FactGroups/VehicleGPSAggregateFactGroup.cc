@@ -13,8 +13,10 @@
 #include <QtMath>
 
 VehicleGPSAggregateFactGroup::VehicleGPSAggregateFactGroup(QObject *parent)
-    : FactGroup(1000, ":/json/Vehicle/GPSFact.json", parent)
+    : FactGroup(1000, ":/json/Vehicle/GPSFact.json", parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({}); // Values are not updated from incoming messages
+
     _addFact(&_spoofingStateFact);
     _addFact(&_jammingStateFact);
     _addFact(&_authenticationStateFact);
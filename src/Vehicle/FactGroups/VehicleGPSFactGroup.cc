@@ -7,8 +7,10 @@
 #include <QtPositioning/QGeoCoordinate>
 
 VehicleGPSFactGroup::VehicleGPSFactGroup(QObject *parent)
-    : FactGroup(1000, ":/json/Vehicle/GPSFact.json", parent)
+    : FactGroup(1000, ":/json/Vehicle/GPSFact.json", parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_GPS_RAW_INT, MAVLINK_MSG_ID_HIGH_LATENCY, MAVLINK_MSG_ID_HIGH_LATENCY2, MAVLINK_MSG_ID_GNSS_INTEGRITY });
+
     _addFact(&_latFact);
     _addFact(&_lonFact);
     _addFact(&_mgrsFact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleGeneratorFactGroup::VehicleGeneratorFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/GeneratorFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/GeneratorFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_GENERATOR_STATUS });
+
     _addFact(&_statusFact);
     _addFact(&_genSpeedFact);
     _addFact(&_batteryCurrentFact);
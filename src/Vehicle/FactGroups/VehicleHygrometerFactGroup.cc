@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleHygrometerFactGroup::VehicleHygrometerFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/HygrometerFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/HygrometerFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_HYGROMETER_SENSOR });
+
     _addFact(&_hygroTempFact);
     _addFact(&_hygroHumiFact);
     _addFact(&_hygroIDFact);
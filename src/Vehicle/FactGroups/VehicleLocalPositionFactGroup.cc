@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleLocalPositionFactGroup::VehicleLocalPositionFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/LocalPositionFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/LocalPositionFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_LOCAL_POSITION_NED });
+
     _addFact(&_xFact);
     _addFact(&_yFact);
     _addFact(&_zFact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleLocalPositionSetpointFactGroup::VehicleLocalPositionSetpointFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/LocalPositionSetpointFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/LocalPositionSetpointFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED });
+
     _addFact(&_xFact);
     _addFact(&_yFact);
     _addFact(&_zFact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleRPMFactGroup::VehicleRPMFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/RPMFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/RPMFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_RAW_RPM, MAVLINK_MSG_ID_RPM });
+
     _addFact(&_rpm1Fact);
     _addFact(&_rpm2Fact);
     _addFact(&_rpm3Fact);
@@ -4,8 +4,10 @@
 #include <QtMath>
 
 VehicleSetpointFactGroup::VehicleSetpointFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/SetpointFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/SetpointFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_ATTITUDE_TARGET });
+
     _addFact(&_rollFact);
     _addFact(&_pitchFact);
     _addFact(&_yawFact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleTemperatureFactGroup::VehicleTemperatureFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/TemperatureFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/TemperatureFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_SCALED_PRESSURE, MAVLINK_MSG_ID_SCALED_PRESSURE2, MAVLINK_MSG_ID_SCALED_PRESSURE3, MAVLINK_MSG_ID_HIGH_LATENCY, MAVLINK_MSG_ID_HIGH_LATENCY2 });
+
     _addFact(&_temperature1Fact);
     _addFact(&_temperature2Fact);
     _addFact(&_temperature3Fact);
@@ -2,8 +2,10 @@
 #include "Vehicle.h"
 
 VehicleVibrationFactGroup::VehicleVibrationFactGroup(QObject *parent)
-    : FactGroup(1000, QStringLiteral(":/json/Vehicle/VibrationFact.json"), parent)
+    : FactGroup(1000, QStringLiteral(":/json/Vehicle/VibrationFact.json"), parent, false /* ignoreCamelCase */, true /* frameSynchronised */)
 {
+    _setHandledMessageIds({ MAVLINK_MSG_ID_VIBRATION });
+
     _addFact(&_xAxisFact);
     _addFact(&_yAxisFact);
     _addFact(&_zAxisFact);
@@ -321,6 +321,12 @@ void Vehicle::_commonInit(LinkInterface* link)
     _createStatusTextHandler();
     _createMAVLinkLogManager();
 
+    _subscribeMessageHandlers();
+
+    // Keep the FactGroup dispatch table in sync as FactGroups are added, this includes the dynamic battery/esc/gimbal groups
+    connect(this, &FactGroup::factGroupNamesChanged, this, &Vehicle::_rebuildFactGroupMessageHandlers);
+    _rebuildFactGroupMessageHandlers();
+
     // _addFactGroup(_vehicleFactGroup,            _vehicleFactGroupName);
     _addFactGroup(_gpsFactGroup,               _gpsFactGroupName);
     _addFactGroup(_gps2FactGroup,              _gps2FactGroupName);
@@ -499,17 +505,21 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
-void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+void Vehicle::_mavlinkMessageReceived(LinkInterface* link, const MAVLinkMessageRef& sharedMessage)
 {
-    if (message.sysid != _systemID && message.sysid != 0) {
+    if (sharedMessage->sysid != _systemID && sharedMessage->sysid != 0) {
         // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
-        if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
+        if (!(sharedMessage->msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
             return;
         }
     }
 
     // We give the link manager first whack since it it reponsible for adding new links
-    _vehicleLinkManager->mavlinkMessageReceived(link, message);
+    _vehicleLinkManager->mavlinkMessageReceived(link, *sharedMessage);
+
+    // The received message is shared read-only with every other receiver. Only a vehicle which accepts the
+    // message takes the private copy the firmware plugin is allowed to adjust below.
+    mavlink_message_t message = *sharedMessage;
 
     //-- Check link status
     _messagesReceived++;
@@ -550,23 +560,19 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     if (!_terrainProtocolHandler->mavlinkMessageReceived(message)) {
         return;
     }
-    _ftpManager->_mavlinkMessageReceived(message);
-    _parameterManager->mavlinkMessageReceived(message);
-    (void) QMetaObject::invokeMethod(_imageProtocolManager, "mavlinkMessageReceived", Qt::AutoConnection, message);
-    _remoteIDManager->mavlinkMessageReceived(message);
 
-    _waitForMavlinkMessageMessageReceivedHandler(message);
+    // Managers and dynamic fact group list creation. Creating a fact group rebuilds _factGroupMessageHandlers
+    // so a newly created group still sees the message which caused its creation.
+    _messageHandlers.dispatch(message.msgid, [&message](const MessageHandler& handler) {
+        handler(message);
+    });
 
-    // Handle creation of dynamic fact group lists
-    _batteryFactGroupListModel->handleMessageForFactGroupCreation(this, message);
-    _escStatusFactGroupListModel->handleMessageForFactGroupCreation(this, message);
+    _waitForMavlinkMessageMessageReceivedHandler(message);
 
-    // Let the fact groups take a whack at the mavlink traffic
-    for (FactGroup* factGroup : factGroups()) {
+    // Let the fact groups take a whack at the mavlink traffic they subscribed to
+    _factGroupMessageHandlers.dispatch(message.msgid, [this, &message](FactGroup* factGroup) {
         factGroup->handleMessage(this, message);
-    }
-
-    this->handleMessage(this, message);
+    });
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
@@ -707,6 +713,54 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     emit mavlinkMessageReceived(message);
 }
 
+void Vehicle::_subscribeMessageHandlers()
+{
+    _messageHandlers.subscribe(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, [this](const mavlink_message_t& message) {
+        _ftpManager->_mavlinkMessageReceived(message);
+    });
+    _messageHandlers.subscribe(MAVLINK_MSG_ID_PARAM_VALUE, [this](const mavlink_message_t& message) {
+        _parameterManager->mavlinkMessageReceived(message);
+    });
+    for (const uint32_t msgId : { MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE, MAVLINK_MSG_ID_ENCAPSULATED_DATA }) {
+        _messageHandlers.subscribe(msgId, [this](const mavlink_message_t& message) {
+            _imageProtocolManager->mavlinkMessageReceived(message);
+        });
+    }
+    _messageHandlers.subscribe(MAVLINK_MSG_ID_OPEN_DRONE_ID_ARM_STATUS, [this](const mavlink_message_t& message) {
+        _remoteIDManager->mavlinkMessageReceived(message);
+    });
+
+    const auto subscribeFactGroupCreation = [this](FactGroupListModel* listModel) {
+        for (const uint32_t msgId : listModel->handledMessageIds()) {
+            _messageHandlers.subscribe(msgId, [this, listModel](const mavlink_message_t& message) {
+                listModel->handleMessageForFactGroupCreation(this, message);
+            });
+        }
+    };
+    subscribeFactGroupCreation(_batteryFactGroupListModel);
+    subscribeFactGroupCreation(_escStatusFactGroupListModel);
+}
+
+void Vehicle::_rebuildFactGroupMessageHandlers()
+{
+    _factGroupMessageHandlers.clear();
+
+    const auto subscribe = [this](FactGroup* factGroup) {
+        if (factGroup->handlesAllMessages()) {
+            _factGroupMessageHandlers.subscribeAll(factGroup);
+        } else {
+            for (const uint32_t msgId : factGroup->handledMessageIds()) {
+                _factGroupMessageHandlers.subscribe(msgId, factGroup);
+            }
+        }
+    };
+
+    for (FactGroup* factGroup : factGroups()) {
+        subscribe(factGroup);
+    }
+    subscribe(this);
+}
+
 #if !defined(QGC_NO_ARDUPILOT_DIALECT)
 void Vehicle::_handleCameraFeedback(const mavlink_message_t& message)
 {
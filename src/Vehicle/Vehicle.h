@@ -11,7 +11,11 @@
 #include <QtPositioning/QGeoCoordinate>
 #include <QtQmlIntegration/QtQmlIntegration>
 
+#include <functional>
+
 #include "HealthAndArmingCheckReport.h"
+#include "MAVLinkMessageDispatchTable.h"
+#include "MAVLinkMessagePool.h"
 #include "MAVLinkStreamConfig.h"
 #include "QGCMapCircle.h"
 #include "QGCMAVLink.h"
@@ -870,7 +874,7 @@ public slots:
     void logData                        (uint32_t ofs, uint16_t id, uint8_t count, const uint8_t* data);
 
 private slots:
-    void _mavlinkMessageReceived            (LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived            (LinkInterface* link, const MAVLinkMessageRef& sharedMessage);
     void _sendMessageMultipleNext           ();
     void _parametersReady                   (bool parametersReady);
     void _remoteControlRSSIChanged          (uint8_t rssi);
@@ -939,6 +943,8 @@ void _activeVehicleChanged          (Vehicle* newActiveVehicle);
     void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
     void _ackMavlinkLogData             (uint16_t sequence);
     void _commonInit                    (LinkInterface* link);
+    void _subscribeMessageHandlers      ();
+    void _rebuildFactGroupMessageHandlers();
     void _setupAutoDisarmSignalling     ();
     void _setCapabilities               (uint64_t capabilityBits);
     void _updateArmed                   (bool armed);
@@ -1242,6 +1248,11 @@ void _activeVehicleChanged          (Vehicle* newActiveVehicle);
 
     TerrainProtocolHandler* _terrainProtocolHandler = nullptr;
 
+    // Incoming message dispatch. Handlers are only called for the message ids they subscribed to.
+    using MessageHandler = std::function<void(const mavlink_message_t& message)>;
+    MAVLinkMessageDispatchTable<MessageHandler> _messageHandlers;           ///< Managers and dynamic FactGroup creation
+    MAVLinkMessageDispatchTable<FactGroup*>     _factGroupMessageHandlers;  ///< Rebuilt whenever a FactGroup is added
+
     MissionManager*                 _missionManager             = nullptr;
     GeoFenceManager*                _geoFenceManager            = nullptr;
     RallyPointManager*              _rallyPointManager          = nullptr;
@@ -156,6 +156,8 @@ View3D {
                 geometry: Viewer3DTerrainGeometry {
                     id: terrainGeometryManager
 
+                    // The model is scaled by 10
+                    cameraPosition: standAloneScene.cameraOne.scenePosition.times(0.1)
                     refCoordinate: _gpsRef
                 }
                 materials: CustomMaterial {
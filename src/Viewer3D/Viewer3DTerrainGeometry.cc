@@ -1,107 +1,310 @@
 #include "Viewer3DTerrainGeometry.h"
 
-#include "QGCGeo.h"
 #include "QGCLoggingCategory.h"
 #include "SettingsManager.h"
+#include "TerrainQuery.h"
 #include "Viewer3DSettings.h"
+#include "Viewer3DTerrainQuadtree.h"
 
-#include <cmath>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 
-QGC_LOGGING_CATEGORY(Viewer3DTerrainGeometryLog, "Viewer3d.Viewer3DTerrainGeometry")
+#include <utility>
 
-static constexpr double kMaxLatitude = 85.05112878;
+QGC_LOGGING_CATEGORY(Viewer3DTerrainGeometryLog, "Viewer3d.Viewer3DTerrainGeometry")
 
 Viewer3DTerrainGeometry::Viewer3DTerrainGeometry()
+    : _meshThread(new QThread(this))
+    , _meshBuilder(new Viewer3DTerrainMeshBuilder())
+    , _selectionTimer(new QTimer(this))
 {
+    (void) qRegisterMetaType<Viewer3DTerrainMeshBuilder::ChunkRequest_t>("Viewer3DTerrainMeshBuilder::ChunkRequest_t");
+    (void) qRegisterMetaType<Viewer3DTerrainMeshBuilder::ChunkMesh_t>("Viewer3DTerrainMeshBuilder::ChunkMesh_t");
+
+    _meshThread->setObjectName(QStringLiteral("Viewer3DTerrainMesh"));
+    _meshBuilder->moveToThread(_meshThread);
+    connect(_meshThread, &QThread::finished, _meshBuilder, &QObject::deleteLater);
+    connect(this, &Viewer3DTerrainGeometry::buildChunk, _meshBuilder, &Viewer3DTerrainMeshBuilder::build);
+    connect(_meshBuilder, &Viewer3DTerrainMeshBuilder::chunkBuilt, this, &Viewer3DTerrainGeometry::_chunkBuilt);
+    _meshThread->start(QThread::LowPriority);
+
+    // Camera moves come in every frame, the chunks are selected again once it settles
+    _selectionTimer->setSingleShot(true);
+    _selectionTimer->setInterval(kSelectionDelayMs);
+    connect(_selectionTimer, &QTimer::timeout, this, &Viewer3DTerrainGeometry::_selectChunks);
+
     auto *viewer3DSettings = SettingsManager::instance()->viewer3DSettings();
     connect(viewer3DSettings->osmFilePath(), &Fact::rawValueChanged, this, &Viewer3DTerrainGeometry::_clearScene);
     connect(this, &Viewer3DTerrainGeometry::refCoordinateChanged, this, &Viewer3DTerrainGeometry::updateEarthData);
 }
 
+Viewer3DTerrainGeometry::~Viewer3DTerrainGeometry()
+{
+    _cancelQueries();
+
+    _meshThread->quit();
+    _meshThread->wait();
+}
+
+bool Viewer3DTerrainGeometry::_isReady() const
+{
+    return ((_sectorCount > 0) && (_stackCount > 0) && _roiMin.isValid() && _roiMax.isValid() && _refCoordinate.isValid());
+}
+
 void Viewer3DTerrainGeometry::updateEarthData()
 {
-    clear();
-    const int stride = 3 * sizeof(float)
-                     + 3 * sizeof(float)   // normals
-                     + 2 * sizeof(float);  // UV
+    _resetChunks();
+    if (!_isReady()) {
+        qCDebug(Viewer3DTerrainGeometryLog) << "Terrain not built, sector/stack count likely 0";
+        return;
+    }
 
-    if (!_buildTerrain(roiMin(), roiMax(), refCoordinate(), true)) {
-        qCDebug(Viewer3DTerrainGeometryLog) << "buildTerrain returned false (sector/stack count likely 0)";
+    _queryRefElevation();
+}
+
+void Viewer3DTerrainGeometry::_queryRefElevation()
+{
+    // Chunk heights are placed relative to the reference, so it is queried first
+    _refElevationQuery = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    const quint64 generation = _generation;
+    connect(_refElevationQuery, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, generation](bool success, const QList<double> &heights) {
+        if (generation != _generation) {
+            return;
+        }
+        _refElevationQuery = nullptr;
+        _refElevation = (success && !heights.isEmpty() && !qIsNaN(heights.first())) ? heights.first() : 0.;
+        _refElevationKnown = true;
+        _selectChunks();
+    });
+    _refElevationQuery->requestData({ _refCoordinate });
+}
+
+void Viewer3DTerrainGeometry::_selectChunks()
+{
+    if (!_isReady() || !_refElevationKnown) {
         return;
     }
 
-    QByteArray vertexData;
-    vertexData.resize(_vertices.size() * stride);
-    float *p = reinterpret_cast<float *>(vertexData.data());
+    const QList<quint64> keys = Viewer3DTerrainQuadtree::selectChunks(_roiMin, _roiMax, _refCoordinate, _cameraPosition);
+    _selectedChunks = QSet<quint64>(keys.cbegin(), keys.cend());
+
+    // Chunks which are no longer wanted are not worth waiting for
+    for (auto it = _heightQueries.begin(); it != _heightQueries.end();) {
+        if (!_selectedChunks.contains(it.key())) {
+            (void) disconnect(it.value(), nullptr, this, nullptr);
+            it = _heightQueries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    int requested = 0;
+    for (const quint64 key : keys) {
+        if (_chunkSlots.contains(key) || _heightQueries.contains(key) || _buildingChunks.contains(key)) {
+            continue;
+        }
+        _queryHeights(key);
+        requested++;
+    }
+
+    qCDebug(Viewer3DTerrainGeometryLog) << "Selected" << keys.size() << "chunks," << requested << "new";
+
+    _retireChunks();
+}
 
-    for (size_t i = 0; i < _vertices.size(); ++i) {
-        *p++ = _vertices[i].x();
-        *p++ = _vertices[i].y();
-        *p++ = _vertices[i].z();
+void Viewer3DTerrainGeometry::_queryHeights(quint64 key)
+{
+    QGeoCoordinate chunkMin;
+    QGeoCoordinate chunkMax;
+    Viewer3DTerrainQuadtree::chunkBounds(_roiMin, _roiMax, key, chunkMin, chunkMax);
+
+    TerrainAtCoordinateQuery *const query = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    _heightQueries.insert(key, query);
+    connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, key](bool success, const QList<double> &heights) {
+        _heightsReceived(key, success, heights);
+    });
+    query->requestData(Viewer3DTerrainMeshBuilder::gridCoordinates(chunkMin, chunkMax));
+}
 
-        *p++ = _normals[i].x();
-        *p++ = _normals[i].y();
-        *p++ = _normals[i].z();
+void Viewer3DTerrainGeometry::_heightsReceived(quint64 key, bool success, const QList<double> &heights)
+{
+    (void) _heightQueries.remove(key);
+    if (!_selectedChunks.contains(key)) {
+        _retireChunks();
+        return;
+    }
 
-        *p++ = _texCoords[i].x();
-        *p++ = _texCoords[i].y();
+    Viewer3DTerrainMeshBuilder::ChunkRequest_t request;
+    request.key = key;
+    request.generation = _generation;
+    Viewer3DTerrainQuadtree::chunkBounds(_roiMin, _roiMax, key, request.chunkMin, request.chunkMax);
+    request.ref = _refCoordinate;
+    request.refElevation = _refElevation;
+    if (success) {
+        request.heights = heights;
+    } else {
+        qCDebug(Viewer3DTerrainGeometryLog) << "Terrain query failed for chunk" << key << ", built flat";
     }
 
-    qCDebug(Viewer3DTerrainGeometryLog) << "Terrain built:" << _vertices.size() << "vertices," << _sectorCount << "sectors," << _stackCount << "stacks";
+    // The texture spans the region of interest
+    request.minS = Viewer3DTerrainMeshBuilder::texCoordS(_roiMin.longitude());
+    request.scaleS = Viewer3DTerrainMeshBuilder::texCoordS(_roiMax.longitude()) - request.minS;
+    request.minT = Viewer3DTerrainMeshBuilder::texCoordT(_roiMax.latitude());
+    request.scaleT = Viewer3DTerrainMeshBuilder::texCoordT(_roiMin.latitude()) - request.minT;
 
-    setVertexData(vertexData);
-    setStride(stride);
+    (void) _buildingChunks.insert(key);
+    emit buildChunk(request);
+}
 
-    setPrimitiveType(QQuick3DGeometry::PrimitiveType::Triangles);
-    addAttribute(QQuick3DGeometry::Attribute::PositionSemantic,
-                 0,
-                 QQuick3DGeometry::Attribute::F32Type);
-    addAttribute(QQuick3DGeometry::Attribute::NormalSemantic,
-                 3 * sizeof(float),
-                 QQuick3DGeometry::Attribute::F32Type);
-    addAttribute(QQuick3DGeometry::Attribute::TexCoordSemantic,
-                 6 * sizeof(float),
-                 QQuick3DGeometry::Attribute::F32Type);
+void Viewer3DTerrainGeometry::_chunkBuilt(const Viewer3DTerrainMeshBuilder::ChunkMesh_t &mesh)
+{
+    if (mesh.generation != _generation) {
+        return;
+    }
+
+    (void) _buildingChunks.remove(mesh.key);
+    if (!_selectedChunks.contains(mesh.key)) {
+        _retireChunks();
+        return;
+    }
 
+    int slot = _chunkSlots.value(mesh.key, -1);
+    if (slot < 0) {
+        slot = _allocateSlot();
+        _chunkSlots.insert(mesh.key, slot);
+    }
+    _writeSlot(slot, mesh.vertexData);
+
+    if (_chunkSlots.size() == 1) {
+        _boundsMin = mesh.boundsMin;
+        _boundsMax = mesh.boundsMax;
+    } else {
+        _boundsMin = QVector3D(qMin(_boundsMin.x(), mesh.boundsMin.x()), qMin(_boundsMin.y(), mesh.boundsMin.y()), qMin(_boundsMin.z(), mesh.boundsMin.z()));
+        _boundsMax = QVector3D(qMax(_boundsMax.x(), mesh.boundsMax.x()), qMax(_boundsMax.y(), mesh.boundsMax.y()), qMax(_boundsMax.z(), mesh.boundsMax.z()));
+    }
+    setBounds(_boundsMin, _boundsMax);
+
+    _retireChunks();
     update();
 }
 
-QVector3D Viewer3DTerrainGeometry::_computeFaceNormal(const QVector3D &x1, const QVector3D &x2, const QVector3D &x3)
+void Viewer3DTerrainGeometry::_retireChunks()
 {
-    constexpr float EPSILON = 0.000001f;
-
-    QVector3D normal(0, 0, 0);
-
-    const float ex1 = x2.x() - x1.x();
-    const float ey1 = x2.y() - x1.y();
-    const float ez1 = x2.z() - x1.z();
-    const float ex2 = x3.x() - x1.x();
-    const float ey2 = x3.y() - x1.y();
-    const float ez2 = x3.z() - x1.z();
-
-    const float nx = ey1 * ez2 - ez1 * ey2;
-    const float ny = ez1 * ex2 - ex1 * ez2;
-    const float nz = ex1 * ey2 - ey1 * ex2;
-
-    const float length = std::sqrt(nx * nx + ny * ny + nz * nz);
-    if (length > EPSILON) {
-        const float lengthInv = 1.0f / length;
-        normal.setX(nx * lengthInv);
-        normal.setY(ny * lengthInv);
-        normal.setZ(nz * lengthInv);
+    QByteArray emptySlot;
+    bool changed = false;
+    for (auto it = _chunkSlots.begin(); it != _chunkSlots.end();) {
+        if (_selectedChunks.contains(it.key()) || !_isReplaced(it.key())) {
+            ++it;
+            continue;
+        }
+        if (emptySlot.isEmpty()) {
+            emptySlot = QByteArray(static_cast<qsizetype>(Viewer3DTerrainMeshBuilder::kVerticesPerChunk) * Viewer3DTerrainMeshBuilder::kStride, '\0');
+        }
+        // A slot of coincident vertices draws nothing
+        _writeSlot(it.value(), emptySlot);
+        _freeSlots.append(it.value());
+        it = _chunkSlots.erase(it);
+        changed = true;
     }
 
-    return normal;
+    if (changed) {
+        qCDebug(Viewer3DTerrainGeometryLog) << "Terrain chunks:" << _chunkSlots.size() << "in" << _slotCount << "slots";
+        update();
+    }
+}
+
+bool Viewer3DTerrainGeometry::_isReplaced(quint64 key) const
+{
+    // A chunk stays until the selected chunks covering its area are in, finer ones when refining or the
+    // coarser one when coarsening, so the terrain has no holes while the rest of the selection is built
+    for (const quint64 selectedKey : _selectedChunks) {
+        if (!_chunkSlots.contains(selectedKey) && Viewer3DTerrainQuadtree::overlaps(key, selectedKey)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Viewer3DTerrainGeometry::_allocateSlot()
+{
+    if (!_freeSlots.isEmpty()) {
+        return _freeSlots.takeLast();
+    }
+
+    // Out of slots: the buffers double, which is the only time all chunks are uploaded again
+    const int oldSlotCount = _slotCount;
+    _slotCount = qMax(16, _slotCount * 2);
+
+    QByteArray vertices = vertexData();
+    vertices.resize(static_cast<qsizetype>(_slotCount) * Viewer3DTerrainMeshBuilder::kVerticesPerChunk * Viewer3DTerrainMeshBuilder::kStride, '\0');
+    setVertexData(vertices);
+    setIndexData(Viewer3DTerrainMeshBuilder::indexData(_slotCount));
+
+    for (int slot = _slotCount - 1; slot > oldSlotCount; --slot) {
+        _freeSlots.append(slot);
+    }
+
+    return oldSlotCount;
+}
+
+void Viewer3DTerrainGeometry::_writeSlot(int slot, const QByteArray &vertexData)
+{
+    const int slotBytes = Viewer3DTerrainMeshBuilder::kVerticesPerChunk * Viewer3DTerrainMeshBuilder::kStride;
+    Q_ASSERT(vertexData.size() == slotBytes);
+    setVertexData(slot * slotBytes, vertexData);
+}
+
+void Viewer3DTerrainGeometry::_cancelQueries()
+{
+    // Pending queries delete themselves once answered, their answers are no longer wanted
+    if (_refElevationQuery) {
+        (void) disconnect(_refElevationQuery, nullptr, this, nullptr);
+        _refElevationQuery = nullptr;
+    }
+    for (TerrainAtCoordinateQuery *query : std::as_const(_heightQueries)) {
+        (void) disconnect(query, nullptr, this, nullptr);
+    }
+    _heightQueries.clear();
 }
 
 void Viewer3DTerrainGeometry::_clearScene()
 {
-    clear();
     setSectorCount(0);
     setStackCount(0);
-    _vertices.clear();
-    _normals.clear();
-    _texCoords.clear();
+    _resetChunks();
+}
+
+void Viewer3DTerrainGeometry::_resetChunks()
+{
+    _cancelQueries();
+    _selectionTimer->stop();
+
+    // Meshes still being built for the previous generation are dropped when they arrive
+    _generation++;
+    _buildingChunks.clear();
+    _selectedChunks.clear();
+    _chunkSlots.clear();
+    _freeSlots.clear();
+    _slotCount = 0;
+    _refElevationKnown = false;
+    _refElevation = 0.;
+
+    clear();
+    setStride(Viewer3DTerrainMeshBuilder::kStride);
+    setPrimitiveType(QQuick3DGeometry::PrimitiveType::Triangles);
+    addAttribute(QQuick3DGeometry::Attribute::PositionSemantic,
+                 0,
+                 QQuick3DGeometry::Attribute::F32Type);
+    addAttribute(QQuick3DGeometry::Attribute::NormalSemantic,
+                 3 * sizeof(float),
+                 QQuick3DGeometry::Attribute::F32Type);
+    addAttribute(QQuick3DGeometry::Attribute::TexCoordSemantic,
+                 6 * sizeof(float),
+                 QQuick3DGeometry::Attribute::F32Type);
+    addAttribute(QQuick3DGeometry::Attribute::IndexSemantic,
+                 0,
+                 QQuick3DGeometry::Attribute::U32Type);
     update();
 }
 
@@ -123,134 +326,6 @@ void Viewer3DTerrainGeometry::setStackCount(int newStackCount)
     emit stackCountChanged();
 }
 
-bool Viewer3DTerrainGeometry::_buildTerrain(const QGeoCoordinate &roiMinCoordinate, const QGeoCoordinate &roiMaxCoordinate, const QGeoCoordinate &refCoordinate, bool scale)
-{
-    if (_sectorCount == 0 || _stackCount == 0) {
-        return false;
-    }
-
-    const float sectorLength = std::abs(roiMaxCoordinate.longitude() - roiMinCoordinate.longitude());
-    const float stackLength = std::abs(roiMaxCoordinate.latitude() - roiMinCoordinate.latitude());
-    const float stackRef = roiMaxCoordinate.latitude();
-    const float sectorRef = roiMinCoordinate.longitude();
-
-    struct Vertex {
-        float x, y, z, s, t;
-    };
-    std::vector<Vertex> tmpVertices;
-
-    float minT = 10;
-    float maxT = -10;
-    float minS = 10;
-    float maxS = -10;
-
-    // Resolution of each polygon changes by the portion
-    const float sectorStep = sectorLength / _sectorCount;
-    const float stackStep = stackLength / _stackCount;
-    float sectorAngle, stackAngle;
-
-    for (int i = 0; i <= _stackCount; ++i) {
-        stackAngle = stackRef - i * stackStep;
-
-        for (int j = 0; j <= _sectorCount; ++j) {
-            sectorAngle = sectorRef + j * sectorStep;
-
-            Vertex vertex;
-            const QVector3D localPoint = QGCGeo::convertGpsToEnu(QGeoCoordinate(stackAngle, sectorAngle, 0), refCoordinate);
-            vertex.x = localPoint.x();
-            vertex.y = localPoint.y();
-            vertex.z = 0;
-
-            vertex.s = (sectorAngle + 180.0f) / 360.0f;
-            minS = std::fmin(minS, vertex.s);
-            maxS = std::fmax(maxS, vertex.s);
-
-            if (std::abs(stackAngle) < kMaxLatitude) {
-                const double sinLatitude = std::sin(qDegreesToRadians(stackAngle));
-                vertex.t = 0.5 - std::log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI);
-            } else {
-                vertex.t = (stackRef - stackAngle) / 180;
-            }
-            minT = std::fmin(minT, vertex.t);
-            maxT = std::fmax(maxT, vertex.t);
-
-            tmpVertices.push_back(vertex);
-        }
-    }
-
-    const float scaleT = maxT - minT;
-    const float scaleS = maxS - minS;
-    _vertices.clear();
-    _texCoords.clear();
-    _normals.clear();
-
-    Vertex v1, v2, v3, v4;
-    int vi1, vi2;
-    QVector3D n;
-
-    for (int i = 0; i < _stackCount; ++i) {
-        vi1 = i * (_sectorCount + 1);
-        vi2 = (i + 1) * (_sectorCount + 1);
-        stackAngle = stackRef - i * stackStep;
-
-        for (int j = 0; j < _sectorCount; ++j, ++vi1, ++vi2) {
-            v1 = tmpVertices[vi1];
-            v2 = tmpVertices[vi2];
-            v3 = tmpVertices[vi1 + 1];
-            v4 = tmpVertices[vi2 + 1];
-
-            if (scale) {
-                v1.s = (v1.s - minS) / scaleS;
-                v1.t = (v1.t - minT) / scaleT;
-                v2.s = (v2.s - minS) / scaleS;
-                v2.t = (v2.t - minT) / scaleT;
-                v3.s = (v3.s - minS) / scaleS;
-                v3.t = (v3.t - minT) / scaleT;
-                v4.s = (v4.s - minS) / scaleS;
-                v4.t = (v4.t - minT) / scaleT;
-            }
-
-            if (stackAngle < 90) {
-                _vertices.push_back(QVector3D(v1.x, v1.y, v1.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-
-                _texCoords.push_back(QVector2D(v1.s, v1.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-
-                n = _computeFaceNormal(QVector3D(v1.x, v1.y, v1.z),
-                                      QVector3D(v2.x, v2.y, v2.z),
-                                      QVector3D(v3.x, v3.y, v3.z));
-
-                for (int k = 0; k < 3; ++k) {
-                    _normals.push_back(n);
-                }
-            }
-
-            if (stackAngle > -90) {
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v4.x, v4.y, v4.z));
-
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v4.s, v4.t));
-
-                n = _computeFaceNormal(QVector3D(v3.x, v3.y, v3.z),
-                                      QVector3D(v2.x, v2.y, v2.z),
-                                      QVector3D(v4.x, v4.y, v4.z));
-
-                for (int k = 0; k < 3; ++k) {
-                    _normals.push_back(n);
-                }
-            }
-        }
-    }
-
-    return true;
-}
-
 void Viewer3DTerrainGeometry::setRoiMin(const QGeoCoordinate &newRoiMin)
 {
     if (_roiMin == newRoiMin) {
@@ -277,3 +352,16 @@ void Viewer3DTerrainGeometry::setRefCoordinate(const QGeoCoordinate &newRefCoord
     _refCoordinate = newRefCoordinate;
     emit refCoordinateChanged();
 }
+
+void Viewer3DTerrainGeometry::setCameraPosition(const QVector3D &newCameraPosition)
+{
+    if (_cameraPosition == newCameraPosition) {
+        return;
+    }
+    _cameraPosition = newCameraPosition;
+    emit cameraPositionChanged();
+
+    if (_refElevationKnown && !_selectionTimer->isActive()) {
+        _selectionTimer->start();
+    }
+}
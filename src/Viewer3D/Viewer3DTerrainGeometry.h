@@ -1,30 +1,45 @@
 #pragma once
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
-#include <QtGui/QVector2D>
+#include <QtCore/QSet>
 #include <QtGui/QVector3D>
 #include <QtPositioning/QGeoCoordinate>
 #include <QtQmlIntegration/QtQmlIntegration>
 #include <QtQuick3D/QQuick3DGeometry>
 
+#include "Viewer3DTerrainMeshBuilder.h"
+
 Q_DECLARE_LOGGING_CATEGORY(Viewer3DTerrainGeometryLog)
 
+class QThread;
+class QTimer;
+class TerrainAtCoordinateQuery;
+
+/// Terrain of the region of interest, displaced by the elevation data of TerrainTileManager.
+/// The region is split into quadtree chunks, finer near the camera (see Viewer3DTerrainQuadtree). The heights
+/// of each chunk are queried separately and its mesh is built on a worker thread (see Viewer3DTerrainMeshBuilder).
+/// Each chunk owns a fixed slot of the vertex buffer, only the slots of chunks which changed are rewritten.
 class Viewer3DTerrainGeometry : public QQuick3DGeometry
 {
     Q_OBJECT
     QML_ELEMENT
 
-    Q_PROPERTY(int            sectorCount   READ sectorCount   WRITE setSectorCount   NOTIFY sectorCountChanged)
-    Q_PROPERTY(int            stackCount    READ stackCount    WRITE setStackCount    NOTIFY stackCountChanged)
-    Q_PROPERTY(QGeoCoordinate roiMin        READ roiMin        WRITE setRoiMin        NOTIFY roiMinChanged)
-    Q_PROPERTY(QGeoCoordinate roiMax        READ roiMax        WRITE setRoiMax        NOTIFY roiMaxChanged)
-    Q_PROPERTY(QGeoCoordinate refCoordinate READ refCoordinate WRITE setRefCoordinate NOTIFY refCoordinateChanged)
+    Q_PROPERTY(int            sectorCount    READ sectorCount    WRITE setSectorCount    NOTIFY sectorCountChanged)
+    Q_PROPERTY(int            stackCount     READ stackCount     WRITE setStackCount     NOTIFY stackCountChanged)
+    Q_PROPERTY(QGeoCoordinate roiMin         READ roiMin         WRITE setRoiMin         NOTIFY roiMinChanged)
+    Q_PROPERTY(QGeoCoordinate roiMax         READ roiMax         WRITE setRoiMax         NOTIFY roiMaxChanged)
+    Q_PROPERTY(QGeoCoordinate refCoordinate  READ refCoordinate  WRITE setRefCoordinate  NOTIFY refCoordinateChanged)
+    Q_PROPERTY(QVector3D      cameraPosition READ cameraPosition WRITE setCameraPosition NOTIFY cameraPositionChanged)
 
     friend class Viewer3DTerrainGeometryTest;
 
 public:
     explicit Viewer3DTerrainGeometry();
+    ~Viewer3DTerrainGeometry();
 
+    /// Starts over for a new region of interest or reference
     Q_INVOKABLE void updateEarthData();
 
     int sectorCount() const { return _sectorCount; }
@@ -42,26 +57,63 @@ class Viewer3DTerrainGeometry : public QQuick3DGeometry
     QGeoCoordinate refCoordinate() const { return _refCoordinate; }
     void setRefCoordinate(const QGeoCoordinate &newRefCoordinate);
 
+    /// Camera position in the geometry's local frame, drives the level of detail
+    QVector3D cameraPosition() const { return _cameraPosition; }
+    void setCameraPosition(const QVector3D &newCameraPosition);
+
 signals:
     void sectorCountChanged();
     void stackCountChanged();
     void roiMinChanged();
     void roiMaxChanged();
     void refCoordinateChanged();
+    void cameraPositionChanged();
+    void buildChunk(const Viewer3DTerrainMeshBuilder::ChunkRequest_t &request);
+
+private slots:
+    void _selectChunks();
+    void _chunkBuilt(const Viewer3DTerrainMeshBuilder::ChunkMesh_t &mesh);
 
 private:
-    bool _buildTerrain(const QGeoCoordinate &roiMinCoordinate, const QGeoCoordinate &roiMaxCoordinate, const QGeoCoordinate &refCoordinate, bool scale);
-    static QVector3D _computeFaceNormal(const QVector3D &x1, const QVector3D &x2, const QVector3D &x3);
+    bool _isReady() const;
+    void _queryRefElevation();
+    void _queryHeights(quint64 key);
+    void _heightsReceived(quint64 key, bool success, const QList<double> &heights);
+    void _cancelQueries();
+    /// Frees the slots of chunks which left the selection and whose area the selection has built
+    void _retireChunks();
+    /// @return true if all selected chunks overlapping the chunk @a key are in the vertex buffer
+    bool _isReplaced(quint64 key) const;
+    int _allocateSlot();
+    void _writeSlot(int slot, const QByteArray &vertexData);
+    /// Drops all chunks and queries, the next generation starts from an empty buffer
+    void _resetChunks();
     void _clearScene();
 
-    std::vector<QVector3D> _vertices;
-    std::vector<QVector2D> _texCoords;
-    std::vector<QVector3D> _normals;
+    QThread *_meshThread = nullptr;
+    Viewer3DTerrainMeshBuilder *_meshBuilder = nullptr;
+    QTimer *_selectionTimer = nullptr;
+
+    quint64 _generation = 0;
+    bool _refElevationKnown = false;
+    double _refElevation = 0.;
+    TerrainAtCoordinateQuery *_refElevationQuery = nullptr;
+    QHash<quint64, TerrainAtCoordinateQuery*> _heightQueries;
+    QSet<quint64> _buildingChunks;
+    QSet<quint64> _selectedChunks;
+    QHash<quint64, int> _chunkSlots;            ///< Chunks in the vertex buffer and their slot
+    QList<int> _freeSlots;
+    int _slotCount = 0;
+    QVector3D _boundsMin;
+    QVector3D _boundsMax;
 
     QGeoCoordinate _roiMin;
     QGeoCoordinate _roiMax;
     QGeoCoordinate _refCoordinate;
+    QVector3D _cameraPosition;
 
     int _sectorCount = 0;
     int _stackCount = 0;
+
+    static constexpr int kSelectionDelayMs = 250;
 };
@@ -0,0 +1,209 @@
+#include "Viewer3DTerrainMeshBuilder.h"
+
+#include <QtCore/QtMath>
+#include <QtGui/QVector2D>
+
+#include <cmath>
+
+#include "QGCGeo.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(Viewer3DTerrainMeshBuilderLog, "Viewer3d.Viewer3DTerrainMeshBuilder")
+
+static constexpr double kMaxLatitude = 85.05112878;
+
+Viewer3DTerrainMeshBuilder::Viewer3DTerrainMeshBuilder(QObject *parent)
+    : QObject(parent)
+{
+    qCDebug(Viewer3DTerrainMeshBuilderLog) << this;
+}
+
+Viewer3DTerrainMeshBuilder::~Viewer3DTerrainMeshBuilder()
+{
+    qCDebug(Viewer3DTerrainMeshBuilderLog) << this;
+}
+
+double Viewer3DTerrainMeshBuilder::texCoordT(double latitude)
+{
+    const double sinLatitude = std::sin(qDegreesToRadians(qBound(-kMaxLatitude, latitude, kMaxLatitude)));
+    return (0.5 - (std::log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * M_PI)));
+}
+
+QVector3D Viewer3DTerrainMeshBuilder::computeFaceNormal(const QVector3D &x1, const QVector3D &x2, const QVector3D &x3)
+{
+    constexpr float EPSILON = 0.000001f;
+
+    QVector3D normal(0, 0, 0);
+
+    const float ex1 = x2.x() - x1.x();
+    const float ey1 = x2.y() - x1.y();
+    const float ez1 = x2.z() - x1.z();
+    const float ex2 = x3.x() - x1.x();
+    const float ey2 = x3.y() - x1.y();
+    const float ez2 = x3.z() - x1.z();
+
+    const float nx = ey1 * ez2 - ez1 * ey2;
+    const float ny = ez1 * ex2 - ex1 * ez2;
+    const float nz = ex1 * ey2 - ey1 * ex2;
+
+    const float length = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (length > EPSILON) {
+        const float lengthInv = 1.0f / length;
+        normal.setX(nx * lengthInv);
+        normal.setY(ny * lengthInv);
+        normal.setZ(nz * lengthInv);
+    }
+
+    return normal;
+}
+
+QList<QGeoCoordinate> Viewer3DTerrainMeshBuilder::gridCoordinates(const QGeoCoordinate &chunkMin, const QGeoCoordinate &chunkMax)
+{
+    const double latStep = (chunkMax.latitude() - chunkMin.latitude()) / kGridSize;
+    const double lonStep = (chunkMax.longitude() - chunkMin.longitude()) / kGridSize;
+
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve(kSurfaceVertices);
+    for (int row = 0; row <= kGridSize; ++row) {
+        for (int column = 0; column <= kGridSize; ++column) {
+            coordinates.append(QGeoCoordinate(chunkMax.latitude() - (row * latStep), chunkMin.longitude() + (column * lonStep), 0));
+        }
+    }
+
+    return coordinates;
+}
+
+Viewer3DTerrainMeshBuilder::ChunkMesh_t Viewer3DTerrainMeshBuilder::buildChunk(const ChunkRequest_t &request)
+{
+    ChunkMesh_t mesh;
+    mesh.key = request.key;
+    mesh.generation = request.generation;
+
+    const QList<QGeoCoordinate> coordinates = gridCoordinates(request.chunkMin, request.chunkMax);
+    const bool hasHeights = (request.heights.size() == coordinates.size());
+
+    // Horizontal position in the ENU frame of the reference like the vehicle items, height relative to the reference
+    QList<QVector3D> positions(kSurfaceVertices);
+    QList<QVector2D> texCoords(kSurfaceVertices);
+    for (int i = 0; i < kSurfaceVertices; ++i) {
+        const QGeoCoordinate &coordinate = coordinates.at(i);
+        const QVector3D enu = QGCGeo::convertGpsToEnu(coordinate, request.ref);
+        const double height = hasHeights ? request.heights.at(i) : qQNaN();
+        const float z = qIsNaN(height) ? 0.f : static_cast<float>(height - request.refElevation);
+        positions[i] = QVector3D(enu.x(), enu.y(), z);
+
+        texCoords[i] = QVector2D(static_cast<float>((texCoordS(coordinate.longitude()) - request.minS) / request.scaleS),
+                                 static_cast<float>((texCoordT(coordinate.latitude()) - request.minT) / request.scaleT));
+    }
+
+    const auto index = [](int row, int column) { return (row * (kGridSize + 1)) + column; };
+
+    // Smooth normals from the neighbouring grid points, one sided at the chunk edges
+    QList<QVector3D> normals(kSurfaceVertices);
+    for (int row = 0; row <= kGridSize; ++row) {
+        for (int column = 0; column <= kGridSize; ++column) {
+            const QVector3D east = positions.at(index(row, qMin(column + 1, kGridSize))) - positions.at(index(row, qMax(column - 1, 0)));
+            const QVector3D north = positions.at(index(qMax(row - 1, 0), column)) - positions.at(index(qMin(row + 1, kGridSize), column));
+            normals[index(row, column)] = computeFaceNormal(QVector3D(), east, north);
+        }
+    }
+
+    const QVector3D &northWest = positions.at(index(0, 0));
+    const QVector3D &southEast = positions.at(index(kGridSize, kGridSize));
+    const float skirtDepth = qMax(1.f, qAbs(southEast.x() - northWest.x()) / kGridSize);
+
+    mesh.vertexData.resize(static_cast<qsizetype>(kVerticesPerChunk) * kStride);
+    float *p = reinterpret_cast<float *>(mesh.vertexData.data());
+    mesh.boundsMin = positions.first();
+    mesh.boundsMax = positions.first();
+
+    const auto writeVertex = [&](int i, float zOffset) {
+        const QVector3D position(positions.at(i).x(), positions.at(i).y(), positions.at(i).z() - zOffset);
+        *p++ = position.x();
+        *p++ = position.y();
+        *p++ = position.z();
+
+        *p++ = normals.at(i).x();
+        *p++ = normals.at(i).y();
+        *p++ = normals.at(i).z();
+
+        *p++ = texCoords.at(i).x();
+        *p++ = texCoords.at(i).y();
+
+        mesh.boundsMin = QVector3D(qMin(mesh.boundsMin.x(), position.x()), qMin(mesh.boundsMin.y(), position.y()), qMin(mesh.boundsMin.z(), position.z()));
+        mesh.boundsMax = QVector3D(qMax(mesh.boundsMax.x(), position.x()), qMax(mesh.boundsMax.y(), position.y()), qMax(mesh.boundsMax.z(), position.z()));
+    };
+
+    for (int i = 0; i < kSurfaceVertices; ++i) {
+        writeVertex(i, 0.f);
+    }
+    // Skirts: north, south, west and east edges
+    for (int k = 0; k <= kGridSize; ++k) {
+        writeVertex(index(0, k), skirtDepth);
+    }
+    for (int k = 0; k <= kGridSize; ++k) {
+        writeVertex(index(kGridSize, k), skirtDepth);
+    }
+    for (int k = 0; k <= kGridSize; ++k) {
+        writeVertex(index(k, 0), skirtDepth);
+    }
+    for (int k = 0; k <= kGridSize; ++k) {
+        writeVertex(index(k, kGridSize), skirtDepth);
+    }
+
+    return mesh;
+}
+
+QByteArray Viewer3DTerrainMeshBuilder::indexData(int chunkCount)
+{
+    QByteArray data;
+    data.resize(static_cast<qsizetype>(qMax(0, chunkCount)) * kIndicesPerChunk * sizeof(quint32));
+    quint32 *p = reinterpret_cast<quint32 *>(data.data());
+
+    const auto index = [](int row, int column) { return static_cast<quint32>((row * (kGridSize + 1)) + column); };
+
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        const quint32 base = static_cast<quint32>(chunk) * kVerticesPerChunk;
+
+        for (int row = 0; row < kGridSize; ++row) {
+            for (int column = 0; column < kGridSize; ++column) {
+                const quint32 v1 = base + index(row, column);
+                const quint32 v2 = base + index(row + 1, column);
+                const quint32 v3 = base + index(row, column + 1);
+                const quint32 v4 = base + index(row + 1, column + 1);
+
+                *p++ = v1; *p++ = v2; *p++ = v3;
+                *p++ = v3; *p++ = v2; *p++ = v4;
+            }
+        }
+
+        // Each skirt quad joins two edge vertices to the two below them, both faces as skirts are seen from either side
+        const quint32 edges[4][2] = {
+            { index(0, 0), 1 },
+            { index(kGridSize, 0), 1 },
+            { index(0, 0), kGridSize + 1 },
+            { index(0, kGridSize), kGridSize + 1 },
+        };
+        for (int edge = 0; edge < 4; ++edge) {
+            const quint32 skirtBase = base + kSurfaceVertices + (edge * (kGridSize + 1));
+            for (int k = 0; k < kGridSize; ++k) {
+                const quint32 a = base + edges[edge][0] + (k * edges[edge][1]);
+                const quint32 b = a + edges[edge][1];
+                const quint32 sa = skirtBase + k;
+                const quint32 sb = sa + 1;
+
+                *p++ = a; *p++ = sa; *p++ = b;
+                *p++ = b; *p++ = sa; *p++ = sb;
+                *p++ = a; *p++ = b; *p++ = sa;
+                *p++ = b; *p++ = sb; *p++ = sa;
+            }
+        }
+    }
+
+    return data;
+}
+
+void Viewer3DTerrainMeshBuilder::build(const ChunkRequest_t &request)
+{
+    emit chunkBuilt(buildChunk(request));
+}
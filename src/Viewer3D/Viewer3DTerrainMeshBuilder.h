@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMetaType>
+#include <QtCore/QObject>
+#include <QtGui/QVector3D>
+#include <QtPositioning/QGeoCoordinate>
+
+Q_DECLARE_LOGGING_CATEGORY(Viewer3DTerrainMeshBuilderLog)
+
+/// Builds the heightmapped meshes of terrain chunks. Lives on the worker thread of Viewer3DTerrainGeometry,
+/// which queues one build() per chunk and receives each mesh through chunkBuilt() as soon as it is done.
+/// Every chunk mesh has the same vertex count and layout, position, normal and texture coordinate, so it
+/// fills a fixed slot of the geometry vertex buffer. The chunk edges carry skirts hanging below the surface
+/// which hide the cracks between neighbouring chunks of different levels.
+class Viewer3DTerrainMeshBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct ChunkRequest_t {
+        quint64 key = 0;
+        quint64 generation = 0;
+        QGeoCoordinate chunkMin;
+        QGeoCoordinate chunkMax;
+        QGeoCoordinate ref;
+        double refElevation = 0.;       ///< Terrain height at ref, the mesh is placed relative to it
+        QList<double> heights;          ///< Terrain heights at gridCoordinates(), flat if empty
+        double minS = 0.;               ///< Texture coordinates of the region of interest, see texCoordS() and texCoordT()
+        double scaleS = 1.;
+        double minT = 0.;
+        double scaleT = 1.;
+    };
+
+    struct ChunkMesh_t {
+        quint64 key = 0;
+        quint64 generation = 0;
+        QByteArray vertexData;          ///< kVerticesPerChunk vertices of kStride bytes
+        QVector3D boundsMin;
+        QVector3D boundsMax;
+    };
+
+    explicit Viewer3DTerrainMeshBuilder(QObject *parent = nullptr);
+    ~Viewer3DTerrainMeshBuilder();
+
+    /// Coordinates of the chunk height grid, row major from the north west corner
+    static QList<QGeoCoordinate> gridCoordinates(const QGeoCoordinate &chunkMin, const QGeoCoordinate &chunkMax);
+    static ChunkMesh_t buildChunk(const ChunkRequest_t &request);
+    /// Triangle indices of @a chunkCount chunk slots
+    static QByteArray indexData(int chunkCount);
+
+    static QVector3D computeFaceNormal(const QVector3D &x1, const QVector3D &x2, const QVector3D &x3);
+    /// Web Mercator texture coordinates, before scaling to the region of interest
+    static double texCoordS(double longitude) { return ((longitude + 180.) / 360.); }
+    static double texCoordT(double latitude);
+
+    static constexpr int kGridSize = 16;    ///< Cells along each chunk edge
+    static constexpr int kSurfaceVertices = (kGridSize + 1) * (kGridSize + 1);
+    static constexpr int kVerticesPerChunk = kSurfaceVertices + (4 * (kGridSize + 1));
+    static constexpr int kIndicesPerChunk = (kGridSize * kGridSize * 6) + (4 * kGridSize * 12);
+    static constexpr int kStride = (3 + 3 + 2) * sizeof(float);
+
+public slots:
+    void build(const Viewer3DTerrainMeshBuilder::ChunkRequest_t &request);
+
+signals:
+    void chunkBuilt(const Viewer3DTerrainMeshBuilder::ChunkMesh_t &mesh);
+};
+
+Q_DECLARE_METATYPE(Viewer3DTerrainMeshBuilder::ChunkRequest_t)
+Q_DECLARE_METATYPE(Viewer3DTerrainMeshBuilder::ChunkMesh_t)
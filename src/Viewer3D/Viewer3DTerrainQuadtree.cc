@@ -0,0 +1,90 @@
+#include "Viewer3DTerrainQuadtree.h"
+
+#include <QtCore/QQueue>
+#include <QtGui/QVector2D>
+
+#include <algorithm>
+#include <utility>
+
+#include "QGCGeo.h"
+
+void Viewer3DTerrainQuadtree::chunkBounds(const QGeoCoordinate &roiMin, const QGeoCoordinate &roiMax, quint64 key,
+                                          QGeoCoordinate &chunkMin, QGeoCoordinate &chunkMax)
+{
+    const int divisions = 1 << keyLevel(key);
+    const double latStep = (roiMax.latitude() - roiMin.latitude()) / divisions;
+    const double lonStep = (roiMax.longitude() - roiMin.longitude()) / divisions;
+    const int x = keyX(key);
+    const int y = keyY(key);
+
+    chunkMin = QGeoCoordinate(roiMax.latitude() - ((y + 1) * latStep), roiMin.longitude() + (x * lonStep), 0);
+    chunkMax = QGeoCoordinate(roiMax.latitude() - (y * latStep), roiMin.longitude() + ((x + 1) * lonStep), 0);
+}
+
+bool Viewer3DTerrainQuadtree::overlaps(quint64 a, quint64 b)
+{
+    // The coarser chunk contains the finer one if the finer one's ancestor at its level is the coarser chunk
+    if (keyLevel(a) > keyLevel(b)) {
+        std::swap(a, b);
+    }
+    const int levels = keyLevel(b) - keyLevel(a);
+
+    return (((keyX(b) >> levels) == keyX(a)) && ((keyY(b) >> levels) == keyY(a)));
+}
+
+QList<quint64> Viewer3DTerrainQuadtree::selectChunks(const QGeoCoordinate &roiMin, const QGeoCoordinate &roiMax, const QGeoCoordinate &ref,
+                                                     const QVector3D &camera, int maxLevel, int maxChunks)
+{
+    if (!roiMin.isValid() || !roiMax.isValid() || !ref.isValid() || (maxChunks < 1)) {
+        return {};
+    }
+
+    struct Chunk_t {
+        quint64 key;
+        double distance;
+    };
+
+    const auto chunkOf = [&](quint64 chunkKey, double &size) -> Chunk_t {
+        QGeoCoordinate chunkMin;
+        QGeoCoordinate chunkMax;
+        chunkBounds(roiMin, roiMax, chunkKey, chunkMin, chunkMax);
+        const QVector3D min = QGCGeo::convertGpsToEnu(chunkMin, ref);
+        const QVector3D max = QGCGeo::convertGpsToEnu(chunkMax, ref);
+        const QVector3D center((min.x() + max.x()) / 2.f, (min.y() + max.y()) / 2.f, 0.f);
+        size = QVector2D(max.x() - min.x(), max.y() - min.y()).length();
+        return { chunkKey, static_cast<double>((camera - center).length()) };
+    };
+
+    QList<Chunk_t> leaves;
+
+    // Breadth first, so coarse chunks near the camera split before fine ones once the budget runs short
+    QQueue<quint64> queue;
+    queue.enqueue(key(0, 0, 0));
+    qsizetype chunkCount = 1;
+    while (!queue.isEmpty()) {
+        const quint64 chunkKey = queue.dequeue();
+        double size = 0.;
+        const Chunk_t chunk = chunkOf(chunkKey, size);
+        const int level = keyLevel(chunkKey);
+        if ((level < maxLevel) && (chunk.distance < (kSplitFactor * size)) && ((chunkCount + 3) <= maxChunks)) {
+            const int x = keyX(chunkKey) * 2;
+            const int y = keyY(chunkKey) * 2;
+            queue.enqueue(key(level + 1, x, y));
+            queue.enqueue(key(level + 1, x + 1, y));
+            queue.enqueue(key(level + 1, x, y + 1));
+            queue.enqueue(key(level + 1, x + 1, y + 1));
+            chunkCount += 3;
+        } else {
+            leaves.append(chunk);
+        }
+    }
+
+    std::sort(leaves.begin(), leaves.end(), [](const Chunk_t &a, const Chunk_t &b) { return (a.distance < b.distance); });
+
+    QList<quint64> keys;
+    keys.reserve(leaves.size());
+    for (const Chunk_t &leaf : leaves) {
+        keys.append(leaf.key);
+    }
+    return keys;
+}
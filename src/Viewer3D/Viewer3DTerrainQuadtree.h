@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QtCore/QList>
+#include <QtGui/QVector3D>
+#include <QtPositioning/QGeoCoordinate>
+
+/// Splits the terrain region of interest into a quadtree of chunks, finer near the camera.
+/// A chunk is split into its four children while the camera is closer to its center than
+/// kSplitFactor times its size. Chunks are identified by a key packing their level and their
+/// column and row within that level, row 0 being the northern most.
+class Viewer3DTerrainQuadtree
+{
+public:
+    static quint64 key(int level, int x, int y) { return ((static_cast<quint64>(level) << 56) | (static_cast<quint64>(x) << 28) | static_cast<quint64>(y)); }
+    static int keyLevel(quint64 key) { return static_cast<int>(key >> 56); }
+    static int keyX(quint64 key) { return static_cast<int>((key >> 28) & kKeyMask); }
+    static int keyY(quint64 key) { return static_cast<int>(key & kKeyMask); }
+
+    /// Latitude and longitude range of the chunk @a key within the region @a roiMin to @a roiMax
+    static void chunkBounds(const QGeoCoordinate &roiMin, const QGeoCoordinate &roiMax, quint64 key,
+                            QGeoCoordinate &chunkMin, QGeoCoordinate &chunkMax);
+
+    /// @return true if chunks @a a and @a b overlap, that is one of them contains the other
+    static bool overlaps(quint64 a, quint64 b);
+
+    /// @param camera Camera position in the local ENU frame of @a ref, meters
+    /// @return Leaf chunks covering the region without overlap, nearest to the camera first
+    static QList<quint64> selectChunks(const QGeoCoordinate &roiMin, const QGeoCoordinate &roiMax, const QGeoCoordinate &ref,
+                                       const QVector3D &camera, int maxLevel = kMaxLevel, int maxChunks = kMaxChunks);
+
+    static constexpr int kMaxLevel = 6;
+    static constexpr int kMaxChunks = 256;
+    static constexpr double kSplitFactor = 2.;
+
+private:
+    static constexpr quint64 kKeyMask = (1ULL << 28) - 1;
+};
@@ -1,3 +1,4 @@
+#include "LogReplayRunner.h"
 #include "QGCApplication.h"
 #include "QGCCommandLineParser.h"
 #include "QGCLogging.h"
@@ -47,6 +48,8 @@ int main(int argc, char *argv[])
             }
             qCInfo(MainLog) << "Simple boot test completed";
             return 0;
+        case AppMode::LogReplay:
+            return LogReplayRunner(args.replayLogFile.value()).exec();
         case AppMode::Gui:
             qCInfo(MainLog) << "Starting application event loop";
             return app.exec();
@@ -3,6 +3,7 @@
 #include <QtNetwork/QTcpServer>
 #include <QtTest/QSignalSpy>
 
+#include "ADSBSBSParser.h"
 #include "ADSBTCPLink.h"
 #include "ADSBVehicle.h"
 #include "ADSBVehicleManager.h"
@@ -106,6 +107,14 @@ void ADSBTest::_adsbTcpLinkIgnoresInvalidMessagesTest()
     clientSocket->flush();
     clientSocket->waitForBytesWritten(TestTimeout::shortMs());
 
+    // The end of an overlong line is dropped up to its line end, even if it looks like a message
+    clientSocket->write(QByteArray(8192, 'X'));
+    clientSocket->flush();
+    clientSocket->waitForBytesWritten(TestTimeout::shortMs());
+    clientSocket->write("MSG,1,1,1,ABCDEF,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,CALL123,,,,,,,,,,\n");
+    clientSocket->flush();
+    clientSocket->waitForBytesWritten(TestTimeout::shortMs());
+
     QVERIFY_NO_SIGNAL_WAIT(spy, TestTimeout::shortMs());
     QCOMPARE(spy.count(), 0);
 
@@ -147,6 +156,100 @@ void ADSBTest::_adsbTcpLinkCallsignMessageTest()
     server->close();
 }
 
+void ADSBTest::_adsbTcpLinkMergesUpdatesTest()
+{
+    QTcpServer* const server = new QTcpServer(this);
+    QVERIFY(server);
+    QVERIFY(server->listen(QHostAddress::LocalHost, 0));
+    const quint16 serverPort = server->serverPort();
+    QVERIFY(serverPort > 0);
+
+    ADSBTCPLink* const adsbLink = new ADSBTCPLink(QHostAddress::LocalHost, serverPort, this);
+    QVERIFY(adsbLink);
+    QVERIFY(adsbLink->init());
+
+    QSignalSpy spy(adsbLink, &ADSBTCPLink::adsbVehicleUpdate);
+    bool timeout = false;
+    QVERIFY(server->waitForNewConnection(TestTimeout::mediumMs(), &timeout));
+    QVERIFY(!timeout);
+    QTcpSocket* const clientSocket = server->nextPendingConnection();
+    QVERIFY(clientSocket != nullptr);
+
+    // Identification, position and velocity of one aircraft are sent as a single update
+    const QByteArray messages(
+        "MSG,1,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,KLM1023 ,,,,,,,,,,,0\r\n"
+        "MSG,3,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35000,,,47.0,-122.0,,,,0,,0\r\n"
+        "MSG,3,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35100H,,,47.1,-122.1,,,,1,,0\r\n"
+        "MSG,4,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,,450.0,90.0,,,-640,,,,,0\r\n");
+    clientSocket->write(messages);
+    clientSocket->flush();
+    clientSocket->waitForBytesWritten(TestTimeout::shortMs());
+
+    QVERIFY_SIGNAL_WAIT(spy, TestTimeout::mediumMs());
+    QCOMPARE(spy.count(), 1);
+    const ADSB::VehicleInfo_t vehicleInfo = spy.takeFirst().at(0).value<ADSB::VehicleInfo_t>();
+    QCOMPARE(vehicleInfo.icaoAddress, static_cast<uint32_t>(0x4840D6));
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("KLM1023"));
+    QVERIFY(vehicleInfo.availableFlags.testFlags(ADSB::CallsignAvailable | ADSB::LocationAvailable | ADSB::AltitudeAvailable |
+                                                 ADSB::AlertAvailable | ADSB::HeadingAvailable | ADSB::VelocityAvailable |
+                                                 ADSB::VerticalVelAvailable));
+    QCOMPARE(vehicleInfo.location.latitude(), 47.1);
+    QCOMPARE(vehicleInfo.location.longitude(), -122.1);
+    QCOMPARE(vehicleInfo.location.altitude(), 35100 * 0.3048);
+    QVERIFY(vehicleInfo.alert);
+    QCOMPARE(vehicleInfo.heading, 90.0);
+    QCOMPARE(vehicleInfo.velocity, 450.0 * 0.514444);
+    QCOMPARE(vehicleInfo.verticalVel, -640 * 0.00508);
+
+    server->close();
+}
+
+void ADSBTest::_sbsParserTest()
+{
+    ADSBSBSParser::Message_t message;
+
+    QVERIFY(ADSBSBSParser::parseLine("MSG,3,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35000,,,47.0,-122.0,,,,0,,0\r\n", message));
+    QCOMPARE(message.icaoAddress, static_cast<uint32_t>(0x4840D6));
+    QCOMPARE(message.availableFlags, ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable);
+    QCOMPARE(message.latitude, 47.0);
+    QCOMPARE(message.longitude, -122.0);
+    QCOMPARE(message.altitude, 35000 * 0.3048);
+    QVERIFY(!message.alert);
+
+    // Velocity without vertical rate
+    QVERIFY(ADSBSBSParser::parseLine("MSG,4,1,1,ABCDEF,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,,100,180.5,,,,,,,,0", message));
+    QCOMPARE(message.icaoAddress, static_cast<uint32_t>(0xABCDEF));
+    QCOMPARE(message.availableFlags, ADSB::HeadingAvailable | ADSB::VelocityAvailable);
+    QCOMPARE(message.heading, 180.5);
+
+    // Callsign is trimmed and limited to its SBS-1 length
+    QVERIFY(ADSBSBSParser::parseLine("MSG,6,1,1,ABCDEF,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000, CALL123456,,,,,,,7000,0,0,0,0\n", message));
+    QCOMPARE(message.availableFlags, ADSB::AvailableInfoTypes(ADSB::CallsignAvailable));
+    QCOMPARE(QByteArray(message.callsign, message.callsignLength), QByteArray("CALL1234"));
+
+    ADSBSBSParser::Message_t merged;
+    QVERIFY(ADSBSBSParser::parseLine("MSG,3,1,1,ABCDEF,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,1000,,,1.5,2.5,,,,1,,0", merged));
+    ADSBSBSParser::merge(merged, message);
+    const ADSB::VehicleInfo_t vehicleInfo = ADSBSBSParser::toVehicleInfo(merged);
+    QCOMPARE(vehicleInfo.icaoAddress, static_cast<uint32_t>(0xABCDEF));
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("CALL1234"));
+    QCOMPARE(vehicleInfo.location, QGeoCoordinate(1.5, 2.5, 1000 * 0.3048));
+    QVERIFY(vehicleInfo.alert);
+    QVERIFY(vehicleInfo.availableFlags.testFlags(ADSB::CallsignAvailable | ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable));
+
+    // Rejected lines
+    QVERIFY(!ADSBSBSParser::parseLine("", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,", message));
+    QVERIFY(!ADSBSBSParser::parseLine("NOT,3,1,1,4840D6,1,2024/01/01,12:00:00.000", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,X,1,1,4840D6,1,2024/01/01,12:00:00.000", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,2,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,0,10,90,47.0,-122.0,,,0,0,0,0", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,8,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,,,,,,,,,,,0", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,3,1,1,ZZZZZZ,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35000,,,47.0,-122.0,,,,0,,0", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,3,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35000,,,0,0,,,,0,,0", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,3,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,,35000,,,47.0", message));
+    QVERIFY(!ADSBSBSParser::parseLine("MSG,1,1,1,4840D6,1,2024/01/01,12:00:00.000,2024/01/01,12:00:00.000,   ,,,,,,,,,,,0", message));
+}
+
 void ADSBTest::_adsbVehicleManagerTest()
 {
     ADSBVehicleManager* const manager = ADSBVehicleManager::instance();
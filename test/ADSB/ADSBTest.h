@@ -12,5 +12,7 @@ private slots:
     void _adsbTcpLinkRejectsNullHostTest();
     void _adsbTcpLinkIgnoresInvalidMessagesTest();
     void _adsbTcpLinkCallsignMessageTest();
+    void _adsbTcpLinkMergesUpdatesTest();
+    void _sbsParserTest();
     void _adsbVehicleManagerTest();
 };
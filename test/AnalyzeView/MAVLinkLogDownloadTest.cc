@@ -1,5 +1,6 @@
 #include "MAVLinkLogDownloadTest.h"
 
+#include <QtCore/QBitArray>
 #include <QtCore/QDir>
 
 #include "MAVLinkLogController.h"
@@ -40,4 +41,128 @@ void MAVLinkLogDownloadTest::_downloadTest()
     (void)QFile::remove(downloadFile);
 }
 
+void MAVLinkLogDownloadTest::_downloadStateTest()
+{
+    // 40 bins, the last one short
+    constexpr uint logSize = (39 * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN) + 10;
+    const QDateTime logTime = QDateTime::fromSecsSinceEpoch(1700000000);
+    QGCMAVLinkLogEntry entry(3, logTime, logSize, true);
+
+    MAVLinkLogDownloadData data(&entry);
+    QCOMPARE(data.numBins(), 40u);
+    data.bin_table = QBitArray(data.numBins(), false);
+
+    for (uint32_t bin = 0; bin < 20; bin++) {
+        QVERIFY(data.setReceived(bin));
+    }
+    QVERIFY(!data.setReceived(5));
+    QVERIFY(data.setReceived(22));
+    QVERIFY(data.setReceived(39));
+    QCOMPARE(data.received_bins, 22u);
+    QVERIFY(!data.complete());
+
+    uint32_t start = 0;
+    uint32_t end = 0;
+    QVERIFY(data.nextMissingBins(0, start, end));
+    QCOMPARE(start, 20u);
+    QCOMPARE(end, 22u);
+    QVERIFY(data.nextMissingBins(end, start, end));
+    QCOMPARE(start, 23u);
+    QCOMPARE(end, 39u);
+    QVERIFY(!data.nextMissingBins(39, start, end));
+
+    const QByteArray state = data.saveState();
+
+    MAVLinkLogDownloadData restored(&entry);
+    QVERIFY(restored.restoreState(state));
+    QCOMPARE(restored.bin_table, data.bin_table);
+    QCOMPARE(restored.received_bins, data.received_bins);
+
+    // State of a different log is rejected
+    QGCMAVLinkLogEntry otherSize(3, logTime, logSize + 1, true);
+    MAVLinkLogDownloadData otherSizeData(&otherSize);
+    QVERIFY(!otherSizeData.restoreState(state));
+    QGCMAVLinkLogEntry otherId(4, logTime, logSize, true);
+    MAVLinkLogDownloadData otherIdData(&otherId);
+    QVERIFY(!otherIdData.restoreState(state));
+    QVERIFY(!restored.restoreState(QByteArray("not a download state")));
+
+    for (uint32_t bin = 0; bin < data.numBins(); bin++) {
+        (void) data.setReceived(bin);
+    }
+    QVERIFY(data.complete());
+    QVERIFY(!data.nextMissingBins(0, start, end));
+}
+
+void MAVLinkLogDownloadTest::_resumeTest()
+{
+    MAVLinkLogController* const controller = new MAVLinkLogController(this);
+    MultiSignalSpy* multiSpyLogDownloadController = new MultiSignalSpy(this);
+    QVERIFY(multiSpyLogDownloadController->init(controller));
+    controller->refresh();
+    QVERIFY(multiSpyLogDownloadController->waitForSignal("requestingListChanged", TestTimeout::longMs()));
+    multiSpyLogDownloadController->clearAllSignals();
+    if (controller->_getRequestingList()) {
+        QVERIFY(multiSpyLogDownloadController->waitForSignal("requestingListChanged", TestTimeout::longMs()));
+    }
+    multiSpyLogDownloadController->clearAllSignals();
+
+    QGCMAVLinkLogEntry* const entry = controller->_getModel()->value<QGCMAVLinkLogEntry*>(0);
+    QVERIFY(entry);
+
+    const auto downloadLog = [&]() -> bool {
+        entry->setSelected(true);
+        controller->download(QDir::currentPath());
+        if (!multiSpyLogDownloadController->waitForSignal("downloadingLogsChanged", TestTimeout::longMs())) {
+            return false;
+        }
+        multiSpyLogDownloadController->clearAllSignals();
+        if (controller->_getDownloadingLogs() && !multiSpyLogDownloadController->waitForSignal("downloadingLogsChanged", TestTimeout::longMs())) {
+            return false;
+        }
+        multiSpyLogDownloadController->clearAllSignals();
+        return !controller->_getDownloadingLogs();
+    };
+
+    QVERIFY(downloadLog());
+    const QString downloadFile = QDir::current().filePath("log_0_UnknownDate.ulg");
+    const QString stateFile = downloadFile + MAVLinkLogDownloadData::kStateFileSuffix;
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(stateFile));
+
+    // Pretend the download was interrupted after the first bins
+    constexpr uint32_t receivedBins = 6;
+    constexpr qint64 receivedBytes = receivedBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN;
+    {
+        MAVLinkLogDownloadData data(entry);
+        data.bin_table = QBitArray(data.numBins(), false);
+        for (uint32_t bin = 0; bin < receivedBins; bin++) {
+            (void) data.setReceived(bin);
+        }
+
+        QFile file(stateFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(data.saveState()), data.saveState().size());
+    }
+    {
+        QFile file(downloadFile);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.seek(receivedBytes));
+        QCOMPARE(file.write(QByteArray(entry->size() - receivedBytes, 0)), entry->size() - receivedBytes);
+    }
+
+    QVERIFY(downloadLog());
+    QVERIFY(UnitTest::fileCompare(downloadFile, _mockLink->logDownloadFile()));
+    QVERIFY(!QFile::exists(stateFile));
+    QVERIFY(!QFile::exists(QDir::current().filePath("log_0_UnknownDate_1.ulg")));
+
+    // Only the missing bins were downloaded
+    const MAVLinkLogController::Statistics_t statistics = controller->statistics();
+    QCOMPARE(statistics.bytesResumed, receivedBytes);
+    QCOMPARE(statistics.bytesReceived, entry->size() - receivedBytes);
+    QVERIFY(statistics.requests >= 1);
+
+    (void) QFile::remove(downloadFile);
+}
+
 UT_REGISTER_TEST(MAVLinkLogDownloadTest, TestLabel::Integration, TestLabel::AnalyzeView, TestLabel::Vehicle)
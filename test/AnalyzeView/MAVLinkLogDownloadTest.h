@@ -8,4 +8,6 @@ class MAVLinkLogDownloadTest : public VehicleTest
 
 private slots:
     void _downloadTest();
+    void _downloadStateTest();
+    void _resumeTest();
 };
@@ -0,0 +1,189 @@
+#include "LogReplayIndexTest.h"
+
+#include "LogReplayIndex.h"
+#include "MAVLinkLib.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+
+namespace {
+
+constexpr quint64 kStartTimeUSecs = 1700000000000000ULL;
+constexpr quint64 kIntervalUSecs = 10000;
+
+QByteArray heartbeatRecord(quint64 timestampUSecs, uint32_t customMode)
+{
+    mavlink_message_t message{};
+    (void) mavlink_msg_heartbeat_pack_chan(1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, customMode, MAV_STATE_ACTIVE);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN + LogReplayIndex::kTimestampSize]{};
+    qToBigEndian(timestampUSecs, buffer);
+    const uint16_t length = mavlink_msg_to_send_buffer(buffer + LogReplayIndex::kTimestampSize, &message);
+
+    return QByteArray(reinterpret_cast<const char*>(buffer), LogReplayIndex::kTimestampSize + length);
+}
+
+bool writeLog(const QString &fileName, int recordCount, const QByteArray &garbageAfterFirst = QByteArray())
+{
+    QByteArray contents;
+    for (int i = 0; i < recordCount; i++) {
+        contents += heartbeatRecord(kStartTimeUSecs + (static_cast<quint64>(i) * kIntervalUSecs), static_cast<uint32_t>(i));
+        if (i == 0) {
+            contents += garbageAfterFirst;
+        }
+    }
+
+    QFile file(fileName);
+    return (file.open(QIODevice::WriteOnly) && (file.write(contents) == contents.size()));
+}
+
+} // namespace
+
+void LogReplayIndexTest::_testIndexRange()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("range.tlog"));
+    QVERIFY(writeLog(fileName, 10));
+
+    LogReplayIndex log;
+    QVERIFY(log.open(fileName));
+    QVERIFY(log.isOpen());
+    QCOMPARE(log.recordCount(), static_cast<qint64>(10));
+    QCOMPARE(log.startTimeUSecs(), kStartTimeUSecs);
+    QCOMPARE(log.endTimeUSecs(), kStartTimeUSecs + (9 * kIntervalUSecs));
+
+    // Records come back in order, with the frame sliced straight out of the log
+    qint64 offset = 0;
+    LogReplayIndex::Record record;
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(log.readRecord(offset, record));
+        QCOMPARE(record.timestampUSecs, kStartTimeUSecs + (static_cast<quint64>(i) * kIntervalUSecs));
+        QCOMPARE(static_cast<uint8_t>(record.frame.at(0)), static_cast<uint8_t>(MAVLINK_STX));
+        QCOMPARE(static_cast<uint8_t>(record.frame.at(MAVLINK_CORE_HEADER_LEN + 1)), static_cast<uint8_t>(i));  // custom_mode low byte
+    }
+    QVERIFY(!log.readRecord(offset, record));
+    QCOMPARE(offset, log.size());
+
+    log.close();
+    QVERIFY(!log.isOpen());
+    QCOMPARE(log.recordCount(), static_cast<qint64>(0));
+}
+
+void LogReplayIndexTest::_testExactSeek()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("seek.tlog"));
+    constexpr int kRecordCount = (LogReplayIndex::kIndexStride * 4) + 17;
+    QVERIFY(writeLog(fileName, kRecordCount));
+
+    LogReplayIndex log;
+    QVERIFY(log.open(fileName));
+    QCOMPARE(log.recordCount(), static_cast<qint64>(kRecordCount));
+
+    const int targets[] = { 0, 1, LogReplayIndex::kIndexStride - 1, LogReplayIndex::kIndexStride, (LogReplayIndex::kIndexStride * 3) + 5, kRecordCount - 1 };
+    for (const int target : targets) {
+        const quint64 targetTimeUSecs = kStartTimeUSecs + (static_cast<quint64>(target) * kIntervalUSecs);
+
+        // On a record and just before it both land on that record
+        for (const quint64 seekTimeUSecs : { targetTimeUSecs, targetTimeUSecs - 1 }) {
+            qint64 offset = log.seek(seekTimeUSecs);
+            LogReplayIndex::Record record;
+            QVERIFY(log.readRecord(offset, record));
+            QCOMPARE(record.timestampUSecs, targetTimeUSecs);
+        }
+    }
+
+    QCOMPARE(log.seek(log.endTimeUSecs() + 1), log.size());
+}
+
+void LogReplayIndexTest::_testResyncOverGarbage()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("garbage.tlog"));
+
+    // Includes start bytes, which must fail the length or CRC check rather than derail the walk
+    const QByteArray garbage = QByteArrayLiteral("\x00\xfd\x05\x11\xfe\x22\x33\xfd");
+    QVERIFY(writeLog(fileName, 5, garbage));
+
+    LogReplayIndex log;
+    QVERIFY(log.open(fileName));
+    QCOMPARE(log.recordCount(), static_cast<qint64>(5));
+    QCOMPARE(log.endTimeUSecs(), kStartTimeUSecs + (4 * kIntervalUSecs));
+}
+
+void LogReplayIndexTest::_testUnknownMessage()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    // Record with an empty frame of a message id no dialect uses, its CRC can not be checked
+    QByteArray unknownRecord(LogReplayIndex::kTimestampSize, Qt::Uninitialized);
+    qToBigEndian(kStartTimeUSecs + (kIntervalUSecs / 2), unknownRecord.data());
+    unknownRecord += QByteArrayLiteral("\xfd\x00\x00\x00\x01\x01\xff\xff\xff\x12\x34");
+
+    // Followed directly by the next record it is taken as a record of its own
+    const QString alignedFileName = tempDir->filePath(QStringLiteral("aligned.tlog"));
+    QVERIFY(writeLog(alignedFileName, 5, unknownRecord));
+
+    LogReplayIndex alignedLog;
+    QVERIFY(alignedLog.open(alignedFileName));
+    QCOMPARE(alignedLog.recordCount(), static_cast<qint64>(6));
+
+    // Otherwise it is garbage
+    const QString misalignedFileName = tempDir->filePath(QStringLiteral("misaligned.tlog"));
+    QVERIFY(writeLog(misalignedFileName, 5, unknownRecord + QByteArrayLiteral("\x00")));
+
+    LogReplayIndex misalignedLog;
+    QVERIFY(misalignedLog.open(misalignedFileName));
+    QCOMPARE(misalignedLog.recordCount(), static_cast<qint64>(5));
+    QCOMPARE(misalignedLog.endTimeUSecs(), kStartTimeUSecs + (4 * kIntervalUSecs));
+}
+
+void LogReplayIndexTest::_testSidecarCache()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("cache.tlog"));
+    QVERIFY(writeLog(fileName, 300));
+
+    LogReplayIndex log;
+    QVERIFY(log.open(fileName));
+    QVERIFY(!log.loadedFromCache());
+    QVERIFY(QFile::exists(LogReplayIndex::cacheFileName(fileName)));
+    const qint64 builtSeek = log.seek(kStartTimeUSecs + (200 * kIntervalUSecs));
+
+    QVERIFY(log.open(fileName));
+    QVERIFY(log.loadedFromCache());
+    QCOMPARE(log.recordCount(), static_cast<qint64>(300));
+    QCOMPARE(log.endTimeUSecs(), kStartTimeUSecs + (299 * kIntervalUSecs));
+    QCOMPARE(log.seek(kStartTimeUSecs + (200 * kIntervalUSecs)), builtSeek);
+    log.close();
+
+    // A log which changed since the index was written is indexed again
+    QVERIFY(writeLog(fileName, 50));
+    QVERIFY(log.open(fileName));
+    QVERIFY(!log.loadedFromCache());
+    QCOMPARE(log.recordCount(), static_cast<qint64>(50));
+}
+
+void LogReplayIndexTest::_testNoCache()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("nocache.tlog"));
+    QVERIFY(writeLog(fileName, 20));
+
+    LogReplayIndex log;
+    QVERIFY(log.open(fileName, false));
+    QCOMPARE(log.recordCount(), static_cast<qint64>(20));
+    QVERIFY(!QFile::exists(LogReplayIndex::cacheFileName(fileName)));
+
+    QVERIFY(!log.open(tempDir->filePath(QStringLiteral("missing.tlog"))));
+    QVERIFY(!log.errorString().isEmpty());
+    QVERIFY(!log.isOpen());
+}
+
+UT_REGISTER_TEST(LogReplayIndexTest, TestLabel::Unit, TestLabel::Comms)
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class LogReplayIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testIndexRange();
+    void _testExactSeek();
+    void _testResyncOverGarbage();
+    void _testUnknownMessage();
+    void _testSidecarCache();
+    void _testNoCache();
+};
@@ -0,0 +1,81 @@
+#include "LogReplayWorkerTest.h"
+
+#include "LogReplayLink.h"
+#include "MAVLinkLib.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+#include <QtTest/QSignalSpy>
+
+void LogReplayWorkerTest::_testAsFastAsPossible()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("fast.tlog"));
+
+    // Enough data that the worker has to stop and wait for the receiver several times
+    constexpr int kRecordCount = 20000;
+    constexpr quint64 kStartTimeUSecs = 1700000000000000ULL;
+    QByteArray log;
+    QByteArray expected;
+    for (int i = 0; i < kRecordCount; i++) {
+        mavlink_message_t message{};
+        (void) mavlink_msg_heartbeat_pack_chan(1, 1, MAVLINK_COMM_0, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, static_cast<uint32_t>(i), MAV_STATE_ACTIVE);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN]{};
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+
+        uint8_t timestamp[LogReplayIndex::kTimestampSize]{};
+        // Hours of log time, which would take hours to replay in real time
+        qToBigEndian(kStartTimeUSecs + (static_cast<quint64>(i) * 1000000ULL), timestamp);
+        (void) log.append(reinterpret_cast<const char*>(timestamp), LogReplayIndex::kTimestampSize);
+        (void) log.append(reinterpret_cast<const char*>(buffer), length);
+        (void) expected.append(reinterpret_cast<const char*>(buffer), length);
+    }
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(log), static_cast<qint64>(log.size()));
+    file.close();
+
+    LogReplayConfiguration config(QStringLiteral("FastReplay"));
+    config.setLogFilename(fileName);
+    LogReplayWorker worker(&config);
+    worker.setup();
+    worker.setAsFastAsPossible(true);
+
+    // Acknowledge from the event loop, the way LogReplayLink does once the protocol has handled the bytes
+    QByteArray received;
+    qint64 bytesInFlight = 0;
+    qint64 peakBytesInFlight = 0;
+    (void) connect(&worker, &LogReplayWorker::dataReceived, this, [&](const QByteArray &data) {
+        (void) received.append(data);
+        bytesInFlight += data.size();
+        peakBytesInFlight = qMax(peakBytesInFlight, bytesInFlight);
+        const qint64 size = data.size();
+        (void) QMetaObject::invokeMethod(&worker, [&worker, &bytesInFlight, size]() {
+            bytesInFlight -= size;
+            worker.dataConsumed(size);
+        }, Qt::QueuedConnection);
+    });
+
+    QSignalSpy throughputSpy(&worker, &LogReplayWorker::replayThroughput);
+    QSignalSpy atEndSpy(&worker, &LogReplayWorker::playbackAtEnd);
+
+    worker.connectToLog();
+    QVERIFY(worker.isConnected());
+    QTRY_COMPARE_WITH_TIMEOUT(atEndSpy.count(), 1, TestTimeout::longMs());
+
+    QCOMPARE(received, expected);
+    QVERIFY(!worker.isPlaying());
+    QCOMPARE(bytesInFlight, static_cast<qint64>(0));
+    QVERIFY(peakBytesInFlight < (LogReplayWorker::kMaxBytesInFlight + LogReplayWorker::kFastBatchBytes + MAVLINK_MAX_PACKET_LEN));
+
+    // Reported once the receiver has consumed everything
+    QCOMPARE(throughputSpy.count(), 1);
+    QCOMPARE(throughputSpy.first().at(0).toULongLong(), static_cast<quint64>(kRecordCount));
+    QCOMPARE(throughputSpy.first().at(1).toULongLong(), static_cast<quint64>(expected.size()));
+
+    worker.disconnectFromLog();
+    QVERIFY(!worker.isConnected());
+}
+
+UT_REGISTER_TEST(LogReplayWorkerTest, TestLabel::Unit, TestLabel::Comms)
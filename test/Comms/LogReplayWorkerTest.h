@@ -0,0 +1,11 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class LogReplayWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testAsFastAsPossible();
+};
@@ -0,0 +1,323 @@
+#include "MAVLinkIngestTest.h"
+
+#include "Benchmarking.h"
+#include "MAVLinkIngest.h"
+#include "MAVLinkSigning.h"
+
+#include <QtCore/QThread>
+
+namespace {
+
+constexpr mavlink_channel_t kPackChannel = MAVLINK_COMM_1;
+
+QByteArray packHeartbeat(uint8_t sysid)
+{
+    mavlink_message_t message{};
+    (void) mavlink_msg_heartbeat_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, kPackChannel, &message,
+                                           MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN]{};
+    const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+    return QByteArray(reinterpret_cast<const char*>(buf), len);
+}
+
+QByteArray packSystemTime(uint8_t sysid)
+{
+    mavlink_message_t message{};
+    (void) mavlink_msg_system_time_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, kPackChannel, &message, 1000, 10);
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN]{};
+    const uint16_t len = mavlink_msg_to_send_buffer(buf, &message);
+    return QByteArray(reinterpret_cast<const char*>(buf), len);
+}
+
+} // namespace
+
+void MAVLinkIngestTest::init()
+{
+    UnitTest::init();
+
+    (void) MAVLinkSigning::initSigning(kPackChannel, QByteArrayView(), nullptr);
+    mavlink_set_proto_version(kPackChannel, 2);
+}
+
+void MAVLinkIngestTest::_testFrameSplitChunks()
+{
+    QByteArray stream;
+    for (uint8_t sysid = 1; sysid <= 5; sysid++) {
+        stream.append(packHeartbeat(sysid));
+        stream.append(packSystemTime(sysid));
+    }
+
+    // Feed the stream in odd sized chunks so frames straddle chunk boundaries
+    MAVLinkFramer framer;
+    MAVLinkMessageBatch batch;
+    qsizetype framed = 0;
+    for (qsizetype offset = 0; offset < stream.size(); offset += 7) {
+        framed += framer.frame(QByteArrayView(stream).sliced(offset, qMin<qsizetype>(7, stream.size() - offset)), batch);
+    }
+
+    QCOMPARE(framed, 10);
+    QCOMPARE(batch.messages.size(), 10);
+    QVERIFY(!batch.mavlinkV1Traffic);
+    for (qsizetype i = 0; i < batch.messages.size(); i++) {
+        const mavlink_message_t &message = *batch.messages[i];
+        QCOMPARE(message.sysid, static_cast<uint8_t>((i / 2) + 1));
+        QCOMPARE(message.msgid, (i % 2) ? static_cast<uint32_t>(MAVLINK_MSG_ID_SYSTEM_TIME) : static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    }
+}
+
+void MAVLinkIngestTest::_testFrameDropsV1Traffic()
+{
+    mavlink_set_proto_version(kPackChannel, 1);
+    const QByteArray stream = packHeartbeat(1) + packSystemTime(1);
+
+    MAVLinkFramer framer;
+    MAVLinkMessageBatch batch;
+    QCOMPARE(framer.frame(stream, batch), 1);
+    QCOMPARE(batch.messages.constFirst()->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QVERIFY(batch.mavlinkV1Traffic);
+}
+
+void MAVLinkIngestTest::_testFrameLossAccounting()
+{
+    QByteArray stream;
+    for (int i = 0; i < 40; i++) {
+        stream.append(packHeartbeat(1));
+        if (i == 10) {
+            // Drop two messages from the sequence
+            mavlink_get_channel_status(kPackChannel)->current_tx_seq += 2;
+        }
+    }
+
+    MAVLinkFramer framer;
+    MAVLinkMessageBatch batch;
+    QCOMPARE(framer.frame(stream, batch), 40);
+    QCOMPARE(framer.totalReceived(), 40ULL);
+    QCOMPARE(framer.totalLoss(), 2ULL);
+
+    QCOMPARE(batch.statusUpdates.size(), 1);
+    const MAVLinkStatusUpdate &update = batch.statusUpdates.constFirst();
+    QCOMPARE(update.sysid, 1);
+    QCOMPARE(update.messageIndex, static_cast<qsizetype>(MAVLinkFramer::kStatusInterval - 1));
+    QCOMPARE(update.totalReceived, MAVLinkFramer::kStatusInterval);
+    QCOMPARE(update.totalLoss, 2ULL);
+    QCOMPARE(update.totalSent, MAVLinkFramer::kStatusInterval + 2);
+
+    framer.requestReset();
+    MAVLinkMessageBatch nextBatch;
+    QCOMPARE(framer.frame(packHeartbeat(1), nextBatch), 1);
+    QCOMPARE(framer.totalReceived(), 1ULL);
+    QCOMPARE(framer.totalLoss(), 0ULL);
+}
+
+void MAVLinkIngestTest::_testFrameSigning()
+{
+    QVERIFY(MAVLinkSigning::initSigning(kPackChannel, "key", MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    const QByteArray signedStream = packHeartbeat(1) + packSystemTime(1);
+    const mavlink_signing_t packSigning = *mavlink_get_channel_status(kPackChannel)->signing;
+
+    // Signing off: signed frames are accepted without checking the signature
+    MAVLinkFramer framer;
+    MAVLinkMessageBatch batch;
+    QCOMPARE(framer.frame(signedStream, batch), 2);
+    QCOMPARE(batch.signingTimestamp, 0ULL);
+
+    // Same key: accepted, the timestamp follows the accepted frames
+    framer.setSigning(&packSigning);
+    batch = MAVLinkMessageBatch();
+    QCOMPARE(framer.frame(packHeartbeat(1) + packSystemTime(1), batch), 2);
+    QVERIFY(batch.signingTimestamp > packSigning.timestamp);
+
+    // Other key: dropped, parsing resumes with the next frame
+    mavlink_signing_t otherSigning = packSigning;
+    otherSigning.secret_key[0] ^= 0xFF;
+    framer.setSigning(&otherSigning);
+    batch = MAVLinkMessageBatch();
+    QCOMPARE(framer.frame(packHeartbeat(1) + packSystemTime(1), batch), 0);
+
+    // Resetting the channel status does not disturb the framer, it only owns its own parse state
+    framer.setSigning(nullptr);
+    (void) MAVLinkSigning::initSigning(kPackChannel, QByteArrayView(), nullptr);
+    const QByteArray stream = packHeartbeat(1) + packSystemTime(1);
+    batch = MAVLinkMessageBatch();
+    QCOMPARE(framer.frame(QByteArrayView(stream).first(5), batch), 0);
+    mavlink_reset_channel_status(MAVLINK_COMM_0);
+    QCOMPARE(framer.frame(QByteArrayView(stream).sliced(5), batch), 2);
+}
+
+void MAVLinkIngestTest::_testQueueFifoOrder()
+{
+    MAVLinkIngestQueue queue;
+    QVERIFY(queue.isEmpty());
+
+    for (uint32_t i = 0; i < 3; i++) {
+        auto *const batch = new MAVLinkMessageBatch;
+        mavlink_message_t message{};
+        message.msgid = i;
+        batch->messages.append(MAVLinkMessageRef::fromMessage(message));
+        QCOMPARE(queue.push(batch), (i == 0));
+    }
+    QVERIFY(!queue.isEmpty());
+
+    QList<uint32_t> order;
+    const int count = queue.drain([&order](MAVLinkMessageBatch &batch) {
+        order.append(batch.messages.constFirst()->msgid);
+    });
+    QCOMPARE(count, 3);
+    QCOMPARE(order, QList<uint32_t>({0, 1, 2}));
+    QVERIFY(queue.isEmpty());
+
+    // Queue is empty again, so the next push must request a new drain
+    QVERIFY(queue.push(new MAVLinkMessageBatch));
+}
+
+void MAVLinkIngestTest::_testQueueConcurrentProducers()
+{
+    constexpr int kProducers = 4;
+    constexpr uint32_t kBatchesPerProducer = 5000;
+
+    MAVLinkIngestQueue queue;
+    QList<QThread*> producers;
+    for (int producer = 0; producer < kProducers; producer++) {
+        producers.append(QThread::create([&queue, producer]() {
+            for (uint32_t i = 0; i < kBatchesPerProducer; i++) {
+                auto *const batch = new MAVLinkMessageBatch;
+                mavlink_message_t message{};
+                message.sysid = static_cast<uint8_t>(producer);
+                message.msgid = i;
+                batch->messages.append(MAVLinkMessageRef::fromMessage(message));
+                (void) queue.push(batch);
+            }
+        }));
+    }
+
+    for (QThread *thread : producers) {
+        thread->start();
+    }
+
+    QList<uint32_t> nextExpected(kProducers, 0);
+    bool ordered = true;
+    const auto consumer = [&nextExpected, &ordered](MAVLinkMessageBatch &batch) {
+        const mavlink_message_t &message = *batch.messages.constFirst();
+        if (message.msgid != nextExpected[message.sysid]) {
+            ordered = false;
+        }
+        nextExpected[message.sysid] = message.msgid + 1;
+    };
+
+    bool running = true;
+    while (running) {
+        running = false;
+        for (const QThread *thread : std::as_const(producers)) {
+            running |= !thread->isFinished();
+        }
+        (void) queue.drain(consumer);
+    }
+    (void) queue.drain(consumer);
+
+    for (QThread *thread : std::as_const(producers)) {
+        QVERIFY(thread->wait(TestTimeout::mediumMs()));
+        delete thread;
+    }
+
+    QVERIFY(ordered);
+    for (int producer = 0; producer < kProducers; producer++) {
+        QCOMPARE(nextExpected[producer], kBatchesPerProducer);
+    }
+}
+
+void MAVLinkIngestTest::_testPoolRecyclesBuffers()
+{
+    QByteArray stream;
+    for (int i = 0; i < 10; i++) {
+        stream.append(packHeartbeat(1));
+    }
+
+    MAVLinkFramer framer;
+    {
+        MAVLinkMessageBatch batch;
+        QCOMPARE(framer.frame(stream, batch), 10);
+        QCOMPARE(batch.messages.constFirst().useCount(), 1);
+        QCOMPARE(framer.allocationsAvoided(), 0ULL);
+    }
+
+    // The first batch returned its buffers to the pool, so framing again reuses them
+    MAVLinkMessageBatch batch;
+    QCOMPARE(framer.frame(stream, batch), 10);
+    QCOMPARE(framer.allocationsAvoided(), 10ULL);
+    for (const MAVLinkMessageRef &message : std::as_const(batch.messages)) {
+        QCOMPARE(message->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    }
+}
+
+void MAVLinkIngestTest::_testPoolSharedRefs()
+{
+    MAVLinkMessagePool *const pool = MAVLinkMessagePool::create();
+
+    MAVLinkMessageRef ref = pool->acquire();
+    ref.data()->msgid = MAVLINK_MSG_ID_SYSTEM_TIME;
+
+    MAVLinkMessageRef copy = ref;
+    QCOMPARE(ref.useCount(), 2);
+    QCOMPARE(copy.get(), ref.get());
+
+    // Closing the pool while buffers are still referenced must keep them valid
+    pool->close();
+    ref = MAVLinkMessageRef();
+    QCOMPARE(copy.useCount(), 1);
+    QCOMPARE(copy->msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_SYSTEM_TIME));
+
+    // The last reference is released on another thread, which also deletes the pool
+    QThread *const thread = QThread::create([released = std::move(copy)]() mutable {
+        released = MAVLinkMessageRef();
+    });
+    thread->start();
+    QVERIFY(thread->wait(TestTimeout::mediumMs()));
+    delete thread;
+
+    QVERIFY(copy.isNull());
+}
+
+void MAVLinkIngestTest::_benchmarkMainThreadCost()
+{
+    constexpr int kMessages = 1000;
+
+    QByteArray stream;
+    for (int i = 0; i < (kMessages / 2); i++) {
+        stream.append(packHeartbeat(1));
+        stream.append(packSystemTime(1));
+    }
+
+    MAVLinkFramer framer;
+    MAVLinkMessageBatch framed;
+    QCOMPARE(framer.frame(stream, framed), kMessages);
+
+    MAVLinkIngestQueue queue;
+    qsizetype consumed = 0;
+
+    auto bench = qgc::bench::ciConfig();
+    bench.relative(true).batch(kMessages).unit("msg");
+
+    // Threaded parsing off: framing, CRC, signing and loss accounting all run on the main thread
+    bench.run("main thread parses bytes", [&] {
+        MAVLinkMessageBatch batch;
+        (void) framer.frame(stream, batch);
+        ankerl::nanobench::doNotOptimizeAway(batch.messages.size());
+    });
+
+    // Threaded parsing on: the worker already framed the batch, the main thread only drains and walks it
+    bench.run("main thread drains framed batch", [&] {
+        auto *const batch = new MAVLinkMessageBatch;
+        batch->messages = framed.messages;
+        (void) queue.push(batch);
+        (void) queue.drain([&consumed](MAVLinkMessageBatch &drained) {
+            for (const MAVLinkMessageRef &message : std::as_const(drained.messages)) {
+                consumed += message->len;
+            }
+        });
+        ankerl::nanobench::doNotOptimizeAway(consumed);
+    });
+
+    QVERIFY(consumed > 0);
+}
+
+UT_REGISTER_TEST(MAVLinkIngestTest, TestLabel::Unit, TestLabel::Comms)
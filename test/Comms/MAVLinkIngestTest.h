@@ -0,0 +1,23 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkIngestTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init() override;
+
+    void _testFrameSplitChunks();
+    void _testFrameDropsV1Traffic();
+    void _testFrameLossAccounting();
+    void _testFrameSigning();
+    void _testQueueFifoOrder();
+    void _testQueueConcurrentProducers();
+    void _testPoolRecyclesBuffers();
+    void _testPoolSharedRefs();
+
+    // Benchmarks (nanobench)
+    void _benchmarkMainThreadCost();
+};
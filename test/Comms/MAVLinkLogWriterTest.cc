@@ -0,0 +1,182 @@
+#include "MAVLinkLogWriterTest.h"
+
+#include "MAVLinkLogWriter.h"
+#include "QGCDecompressDevice.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QThread>
+#include <QtCore/QtEndian>
+
+#include <atomic>
+
+namespace {
+
+QByteArray readAll(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+} // namespace
+
+void MAVLinkLogWriterTest::_testRecordFormat()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("format.mavlink"));
+
+    const QList<QByteArray> frames = {
+        QByteArrayLiteral("\xfd\x09\x00\x00\x01\x01\x01\x00\x00\x00"),
+        QByteArrayLiteral("\xfd\x01\x02\x03"),
+        QByteArray(280, '\x55'),
+    };
+
+    MAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.isOpen());
+    for (qsizetype i = 0; i < frames.size(); i++) {
+        QVERIFY(writer.append(1000000ULL + static_cast<quint64>(i), frames.at(i)));
+    }
+    writer.close();
+    QVERIFY(!writer.isOpen());
+
+    // Same layout LogReplayLink reads: big endian microsecond timestamp followed by the frame
+    const QByteArray contents = readAll(fileName);
+    QCOMPARE(static_cast<quint64>(contents.size()), writer.bytesWritten());
+
+    qsizetype offset = 0;
+    for (qsizetype i = 0; i < frames.size(); i++) {
+        const quint64 timestamp = qFromBigEndian<quint64>(contents.constData() + offset);
+        QCOMPARE(timestamp, 1000000ULL + static_cast<quint64>(i));
+        offset += MAVLinkLogWriter::kTimestampSize;
+        QCOMPARE(contents.mid(offset, frames.at(i).size()), frames.at(i));
+        offset += frames.at(i).size();
+    }
+    QCOMPARE(offset, contents.size());
+    QCOMPARE(writer.droppedRecords(), 0ULL);
+    QCOMPARE(writer.bytesQueued(), 0);
+}
+
+void MAVLinkLogWriterTest::_testCompressedLog()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("compressed.mavlink") + MAVLinkLogWriter::fileExtension(MAVLinkLogWriter::Compression::Zstd));
+    QVERIFY(fileName.endsWith(QStringLiteral(".mavlink.zst")));
+
+    QByteArray expected;
+    MAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName, MAVLinkLogWriter::Compression::Zstd));
+    QCOMPARE(writer.compression(), MAVLinkLogWriter::Compression::Zstd);
+    for (int i = 0; i < 2000; i++) {
+        const QByteArray frame = QByteArrayLiteral("\xfd\x09\x00\x00") + QByteArray::number(i % 50);
+        QVERIFY(writer.append(static_cast<quint64>(i), frame));
+
+        uint8_t timestamp[MAVLinkLogWriter::kTimestampSize]{};
+        qToBigEndian(static_cast<quint64>(i), timestamp);
+        expected.append(reinterpret_cast<const char*>(timestamp), MAVLinkLogWriter::kTimestampSize);
+        expected.append(frame);
+    }
+    writer.close();
+
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(expected.size()));
+    QVERIFY(QFileInfo(fileName).size() < expected.size());
+
+    // Replay reads compressed logs through QGCDecompressDevice
+    QGCDecompressDevice device(fileName);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QCOMPARE(device.readAll(), expected);
+}
+
+void MAVLinkLogWriterTest::_testRingWrapConcurrentProducers()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("wrap.mavlink"));
+
+    // A ring much smaller than the total forces many wraps, with records straddling the end of the ring
+    constexpr qsizetype kCapacity = 1000;
+    constexpr int kProducers = 4;
+    constexpr int kRecordsPerProducer = 500;
+    constexpr qsizetype kFrameSize = 17;
+
+    MAVLinkLogWriter writer(kCapacity);
+    QCOMPARE(writer.writeChunkSize(), kCapacity / 2);
+    QVERIFY(writer.open(fileName));
+
+    std::atomic<int> accepted{0};
+    QList<QThread*> producers;
+    for (int producer = 0; producer < kProducers; producer++) {
+        producers.append(QThread::create([&writer, &accepted, producer] {
+            for (int i = 0; i < kRecordsPerProducer; i++) {
+                const QByteArray frame(kFrameSize, static_cast<char>('A' + producer));
+                // The writer may fall behind the producers, retry until the record fits
+                while (!writer.append(static_cast<quint64>((producer << 16) | i), frame)) {
+                    QThread::yieldCurrentThread();
+                }
+                accepted++;
+            }
+        }));
+        producers.last()->start();
+    }
+    for (QThread *const producer : std::as_const(producers)) {
+        QVERIFY(producer->wait(TestTimeout::longMs()));
+        delete producer;
+    }
+
+    writer.close();
+    QCOMPARE(accepted.load(), kProducers * kRecordsPerProducer);
+    QVERIFY(writer.peakBytesQueued() <= kCapacity);
+
+    // Every record must be intact and each producer's records must be in order
+    const QByteArray contents = readAll(fileName);
+    constexpr qsizetype kRecordSize = MAVLinkLogWriter::kTimestampSize + kFrameSize;
+    QCOMPARE(contents.size(), kRecordSize * kProducers * kRecordsPerProducer);
+
+    QList<int> nextIndex(kProducers, 0);
+    for (qsizetype offset = 0; offset < contents.size(); offset += kRecordSize) {
+        const quint64 timestamp = qFromBigEndian<quint64>(contents.constData() + offset);
+        const int producer = static_cast<int>(timestamp >> 16);
+        QVERIFY(producer < kProducers);
+        QCOMPARE(static_cast<int>(timestamp & 0xffff), nextIndex[producer]++);
+        QCOMPARE(contents.mid(offset + MAVLinkLogWriter::kTimestampSize, kFrameSize), QByteArray(kFrameSize, static_cast<char>('A' + producer)));
+    }
+}
+
+void MAVLinkLogWriterTest::_testDropsOversizedRecord()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    constexpr qsizetype kCapacity = 256;
+    MAVLinkLogWriter writer(kCapacity);
+    QVERIFY(writer.open(tempDir->filePath(QStringLiteral("drop.mavlink"))));
+
+    QVERIFY(!writer.append(QByteArray(kCapacity, 'x')));
+    QVERIFY(writer.append(QByteArray(16, 'y')));
+    writer.close();
+
+    QCOMPARE(writer.droppedRecords(), 1ULL);
+    QCOMPARE(writer.droppedBytes(), static_cast<quint64>(kCapacity + MAVLinkLogWriter::kTimestampSize));
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(16 + MAVLinkLogWriter::kTimestampSize));
+}
+
+void MAVLinkLogWriterTest::_testAppendWhenClosed()
+{
+    MAVLinkLogWriter writer;
+    QVERIFY(!writer.isOpen());
+    QVERIFY(!writer.append(QByteArray(16, 'z')));
+    QCOMPARE(writer.droppedRecords(), 0ULL);
+
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    QVERIFY(!writer.open(tempDir->filePath(QStringLiteral("missing/dir/log.mavlink"))));
+    QVERIFY(!writer.errorString().isEmpty());
+    QVERIFY(!writer.isOpen());
+}
+
+UT_REGISTER_TEST(MAVLinkLogWriterTest, TestLabel::Unit, TestLabel::Comms)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testRecordFormat();
+    void _testCompressedLog();
+    void _testRingWrapConcurrentProducers();
+    void _testDropsOversizedRecord();
+    void _testAppendWhenClosed();
+};
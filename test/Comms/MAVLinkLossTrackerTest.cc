@@ -0,0 +1,205 @@
+#include "MAVLinkLossTrackerTest.h"
+#include "MAVLinkLossTracker.h"
+
+#include <memory>
+
+namespace {
+
+constexpr uint8_t kSysId = 1;
+constexpr uint8_t kCompId = 1;
+
+} // namespace
+
+void MAVLinkLossTrackerTest::_testInOrder()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    // Wraps the sequence number twice
+    for (int i = 0; i < 600; i++) {
+        QCOMPARE(tracker->update(kSysId, kCompId, static_cast<uint8_t>(i)), 0U);
+    }
+
+    QCOMPARE(tracker->totalReceived(), 600ULL);
+    QCOMPARE(tracker->totalLost(), 0ULL);
+    QCOMPARE(tracker->totalReordered(), 0ULL);
+    QCOMPARE(tracker->windowLossPercent(), 0.f);
+    QCOMPARE(static_cast<int>(tracker->sourceCount()), 1);
+}
+
+void MAVLinkLossTrackerTest::_testGapAndBurstHistogram()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    (void) tracker->update(kSysId, kCompId, 250);
+    QCOMPARE(tracker->update(kSysId, kCompId, 252), 1U);     // 251 lost
+    QCOMPARE(tracker->update(kSysId, kCompId, 3), 6U);       // 253-255, 0-2 lost across the wrap
+    QCOMPARE(tracker->update(kSysId, kCompId, 4), 0U);
+
+    QCOMPARE(tracker->totalLost(), 7ULL);
+
+    const QList<MAVLinkLossStats> stats = tracker->statistics();
+    QCOMPARE(static_cast<int>(stats.size()), 1);
+    QCOMPARE(stats[0].received, 4ULL);
+    QCOMPARE(stats[0].lost, 7ULL);
+    QCOMPARE(stats[0].burstHistogram[0], 1U);
+    QCOMPARE(stats[0].burstHistogram[3], 1U);
+    QVERIFY(stats[0].windowLossPercent > 0.f);
+}
+
+void MAVLinkLossTrackerTest::_testLateArrival()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    (void) tracker->update(kSysId, kCompId, 10);
+    QCOMPARE(tracker->update(kSysId, kCompId, 13), 2U);
+    QCOMPARE(tracker->update(kSysId, kCompId, 11), 0U);
+    QCOMPARE(tracker->update(kSysId, kCompId, 14), 0U);
+
+    QCOMPARE(tracker->totalLost(), 1ULL);
+    QCOMPARE(tracker->totalReordered(), 1ULL);
+    QCOMPARE(tracker->statistics()[0].reordered, 1ULL);
+}
+
+void MAVLinkLossTrackerTest::_testDuplicate()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    (void) tracker->update(kSysId, kCompId, 10);
+    QCOMPARE(tracker->update(kSysId, kCompId, 10), 0U);
+    QCOMPARE(tracker->update(kSysId, kCompId, 11), 0U);
+
+    QCOMPARE(tracker->totalLost(), 0ULL);
+    QCOMPARE(tracker->totalReordered(), 0ULL);
+    QCOMPARE(tracker->totalDuplicates(), 1ULL);
+    QCOMPARE(tracker->statistics()[0].duplicates, 1ULL);
+}
+
+void MAVLinkLossTrackerTest::_testSequenceRestart()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    (void) tracker->update(kSysId, kCompId, 200);
+    QCOMPARE(tracker->update(kSysId, kCompId, 100), 0U);
+    QCOMPARE(tracker->update(kSysId, kCompId, 101), 0U);
+
+    QCOMPARE(tracker->totalLost(), 0ULL);
+    QCOMPARE(tracker->totalReordered(), 0ULL);
+    QCOMPARE(tracker->totalRestarts(), 1ULL);
+}
+
+void MAVLinkLossTrackerTest::_testSequenceReset()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    // Each case uses its own component so the jumps between them do not count
+
+    // The sender restarts from zero, further back than a late message can be
+    (void) tracker->update(kSysId, 1, 150);
+    QCOMPARE(tracker->update(kSysId, 1, 0), 0U);
+    QCOMPARE(tracker->update(kSysId, 1, 1), 0U);
+
+    // Exactly the reorder distance back is no longer a late message
+    (void) tracker->update(kSysId, 2, 40);
+    QCOMPARE(tracker->update(kSysId, 2, 40 - MAVLinkLossTracker::kMaxReorderDistance), 0U);
+
+    // Neither is a jump further ahead than the largest loss burst
+    (void) tracker->update(kSysId, 3, 10);
+    QCOMPARE(tracker->update(kSysId, 3, 11 + MAVLinkLossTracker::kMaxLossBurst + 1), 0U);
+
+    QCOMPARE(tracker->totalLost(), 0ULL);
+    QCOMPARE(tracker->totalReordered(), 0ULL);
+    QCOMPARE(tracker->totalRestarts(), 3ULL);
+    QCOMPARE(tracker->statistics()[0].restarts, 1ULL);
+    QCOMPARE(tracker->windowLossPercent(), 0.f);
+
+    // The largest loss burst is still loss
+    (void) tracker->update(kSysId, 4, 100);
+    QCOMPARE(tracker->update(kSysId, 4, 101 + MAVLinkLossTracker::kMaxLossBurst), uint32_t{MAVLinkLossTracker::kMaxLossBurst});
+    QCOMPARE(tracker->totalLost(), quint64{MAVLinkLossTracker::kMaxLossBurst});
+    QCOMPARE(tracker->totalRestarts(), 3ULL);
+}
+
+void MAVLinkLossTrackerTest::_testWindowRecovers()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    // Lose every other message for a while
+    uint8_t seq = 0;
+    (void) tracker->update(kSysId, kCompId, seq);
+    for (int i = 0; i < 99; i++) {
+        seq += 2;
+        (void) tracker->update(kSysId, kCompId, seq);
+    }
+    QVERIFY(tracker->windowLossPercent() > 40.f);
+
+    // Two full windows of clean traffic push the loss out of the window, the totals keep it
+    for (uint32_t i = 0; i < (MAVLinkLossTracker::kWindowSize * 2); i++) {
+        (void) tracker->update(kSysId, kCompId, ++seq);
+    }
+    QCOMPARE(tracker->windowLossPercent(), 0.f);
+    QCOMPARE(tracker->totalLost(), 99ULL);
+}
+
+void MAVLinkLossTrackerTest::_testPerSource()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    // Interleaved sources each have their own sequence
+    for (uint8_t seq = 0; seq < 10; seq++) {
+        QCOMPARE(tracker->update(1, 1, seq), 0U);
+        QCOMPARE(tracker->update(1, 100, static_cast<uint8_t>(seq + 50)), 0U);
+        QCOMPARE(tracker->update(2, 1, static_cast<uint8_t>(seq * 2)), (seq > 0) ? 1U : 0U);
+    }
+
+    const QList<MAVLinkLossStats> stats = tracker->statistics();
+    QCOMPARE(static_cast<int>(stats.size()), 3);
+    QCOMPARE(stats[0].sysid, uint8_t{1});
+    QCOMPARE(stats[0].lost, 0ULL);
+    QCOMPARE(stats[1].compid, uint8_t{100});
+    QCOMPARE(stats[1].lost, 0ULL);
+    QCOMPARE(stats[2].sysid, uint8_t{2});
+    QCOMPARE(stats[2].lost, 9ULL);
+    QCOMPARE(tracker->totalLost(), 9ULL);
+}
+
+void MAVLinkLossTrackerTest::_testSourceLimitAndReset()
+{
+    auto tracker = std::make_unique<MAVLinkLossTracker>();
+
+    for (int sysid = 1; sysid <= 255; sysid++) {
+        (void) tracker->update(static_cast<uint8_t>(sysid), 1, 0);
+    }
+    QCOMPARE(static_cast<int>(tracker->sourceCount()), MAVLinkLossTracker::kMaxSources);
+
+    // An untracked source is still counted as received
+    (void) tracker->update(1, 2, 0);
+    QCOMPARE(tracker->update(1, 2, 50), 0U);
+    QCOMPARE(static_cast<int>(tracker->sourceCount()), MAVLinkLossTracker::kMaxSources);
+    QCOMPARE(tracker->totalReceived(), 257ULL);
+
+    tracker->reset();
+    QCOMPARE(static_cast<int>(tracker->sourceCount()), 0);
+    QCOMPARE(tracker->totalReceived(), 0ULL);
+    QVERIFY(tracker->statistics().isEmpty());
+
+    // Sources seen before the reset start afresh
+    (void) tracker->update(5, 1, 100);
+    QCOMPARE(tracker->update(5, 1, 101), 0U);
+    QCOMPARE(static_cast<int>(tracker->sourceCount()), 1);
+    QCOMPARE(tracker->totalLost(), 0ULL);
+}
+
+void MAVLinkLossTrackerTest::_testBurstBucket()
+{
+    QCOMPARE(MAVLinkLossStats::burstBucket(1), 0);
+    QCOMPARE(MAVLinkLossStats::burstBucket(2), 1);
+    QCOMPARE(MAVLinkLossStats::burstBucket(3), 2);
+    QCOMPARE(MAVLinkLossStats::burstBucket(4), 2);
+    QCOMPARE(MAVLinkLossStats::burstBucket(5), 3);
+    QCOMPARE(MAVLinkLossStats::burstBucket(8), 3);
+    QCOMPARE(MAVLinkLossStats::burstBucket(9), 4);
+    QCOMPARE(MAVLinkLossStats::burstBucket(33), 6);
+    QCOMPARE(MAVLinkLossStats::burstBucket(MAVLinkLossTracker::kMaxLossBurst), MAVLinkLossStats::kBurstBuckets - 1);
+}
+
+UT_REGISTER_TEST(MAVLinkLossTrackerTest, TestLabel::Unit, TestLabel::Comms)
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkLossTrackerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testInOrder();
+    void _testGapAndBurstHistogram();
+    void _testLateArrival();
+    void _testDuplicate();
+    void _testSequenceRestart();
+    void _testSequenceReset();
+    void _testWindowRecovers();
+    void _testPerSource();
+    void _testSourceLimitAndReset();
+    void _testBurstBucket();
+};
@@ -10,14 +10,15 @@ class TestableFactGroup : public FactGroup
 {
     Q_OBJECT
 public:
-    explicit TestableFactGroup(QObject *parent = nullptr, bool ignoreCamelCase = false)
-        : FactGroup(0 /* immediate updates */, parent, ignoreCamelCase)
+    explicit TestableFactGroup(QObject *parent = nullptr, bool ignoreCamelCase = false, bool frameSynchronised = false)
+        : FactGroup(0 /* immediate updates */, parent, ignoreCamelCase, frameSynchronised)
     {
     }
 
     using FactGroup::_addFact;
     using FactGroup::_addFactGroup;
     using FactGroup::_setTelemetryAvailable;
+    using FactGroup::_setHandledMessageIds;
 };
 
 void FactGroupTest::_addFactAndLookup_test()
@@ -220,6 +221,37 @@ void FactGroupTest::_factGroupNames_test()
     QVERIFY(names.contains(QStringLiteral("sub2")));
 }
 
+void FactGroupTest::_handledMessageIds_test()
+{
+    TestableFactGroup group;
+
+    // FactGroups which do not declare their ids are offered every message
+    QVERIFY(group.handlesAllMessages());
+    QVERIFY(group.handledMessageIds().isEmpty());
+
+    group._setHandledMessageIds({ MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_VFR_HUD });
+    QVERIFY(!group.handlesAllMessages());
+    QCOMPARE(group.handledMessageIds(), QList<uint32_t>({ MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_VFR_HUD }));
+
+    group._setHandledMessageIds({});
+    QVERIFY(!group.handlesAllMessages());
+    QVERIFY(group.handledMessageIds().isEmpty());
+}
+
+void FactGroupTest::_frameSynchronised_test()
+{
+    // Only groups which opt in get frame synchronised Facts, others keep synchronous notifications
+    TestableFactGroup group;
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble, &group);
+    group._addFact(&fact, QStringLiteral("fact"));
+    QVERIFY(!fact.frameSynchronised());
+
+    TestableFactGroup telemetryGroup(nullptr, false /* ignoreCamelCase */, true /* frameSynchronised */);
+    Fact telemetryFact(0, "telemetryFact", FactMetaData::valueTypeDouble, &telemetryGroup);
+    telemetryGroup._addFact(&telemetryFact, QStringLiteral("telemetryFact"));
+    QVERIFY(telemetryFact.frameSynchronised());
+}
+
 #include "FactGroupTest.moc"
 
 UT_REGISTER_TEST(FactGroupTest, TestLabel::Unit)
@@ -0,0 +1,165 @@
+#include "FactNotificationCoalescerTest.h"
+
+#include <QtTest/QSignalSpy>
+
+#include "Fact.h"
+#include "FactNotificationCoalescer.h"
+
+void FactNotificationCoalescerTest::init()
+{
+    UnitTest::init();
+
+    FactNotificationCoalescer::instance()->resetStatistics();
+}
+
+void FactNotificationCoalescerTest::cleanup()
+{
+    FactNotificationCoalescer::instance()->setEnabled(false);
+
+    UnitTest::cleanup();
+}
+
+void FactNotificationCoalescerTest::_disabledNotifiesImmediately_test()
+{
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact.setFrameSynchronised(true);
+
+    QSignalSpy valueSpy(&fact, &Fact::valueChanged);
+    QSignalSpy rawValueSpy(&fact, &Fact::rawValueChanged);
+
+    fact.setRawValue(1.0);
+    fact.setRawValue(2.0);
+
+    QCOMPARE(valueSpy.count(), 2);
+    QCOMPARE(rawValueSpy.count(), 2);
+}
+
+void FactNotificationCoalescerTest::_coalescesToLatestValue_test()
+{
+    FactNotificationCoalescer *const coalescer = FactNotificationCoalescer::instance();
+    coalescer->setEnabled(true);
+
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact.setFrameSynchronised(true);
+
+    QSignalSpy valueSpy(&fact, &Fact::valueChanged);
+    QSignalSpy rawValueSpy(&fact, &Fact::rawValueChanged);
+    QSignalSpy containerSpy(&fact, &Fact::containerRawValueChanged);
+
+    for (int i = 1; i <= 10; i++) {
+        fact.setRawValue(static_cast<double>(i));
+    }
+
+    // The value is stored right away, only the UI notification waits for the frame
+    QCOMPARE(fact.rawValue().toDouble(), 10.0);
+    QCOMPARE(valueSpy.count(), 0);
+    QCOMPARE(rawValueSpy.count(), 0);
+    QCOMPARE(containerSpy.count(), 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(rawValueSpy.count(), 1, TestTimeout::shortMs());
+    QCOMPARE(valueSpy.count(), 1);
+    QCOMPARE(containerSpy.count(), 1);
+    QCOMPARE(valueSpy.first().first().toDouble(), 10.0);
+    QCOMPARE(rawValueSpy.first().first().toDouble(), 10.0);
+
+    QCOMPARE(coalescer->suppressedSignals(), 9ULL * FactNotificationCoalescer::kSignalsPerNotification);
+    QCOMPARE(coalescer->emittedSignals(), 1ULL * FactNotificationCoalescer::kSignalsPerNotification);
+    QCOMPARE(coalescer->frames(), 1ULL);
+}
+
+void FactNotificationCoalescerTest::_containerSetRawValue_test()
+{
+    FactNotificationCoalescer::instance()->setEnabled(true);
+
+    Fact fact(0, "fact", FactMetaData::valueTypeInt32);
+    fact.setFrameSynchronised(true);
+
+    QSignalSpy rawValueSpy(&fact, &Fact::rawValueChanged);
+    QSignalSpy vehicleUpdatedSpy(&fact, &Fact::vehicleUpdated);
+
+    fact.containerSetRawValue(1);
+    fact.containerSetRawValue(2);
+
+    QCOMPARE(vehicleUpdatedSpy.count(), 2);
+    QCOMPARE(rawValueSpy.count(), 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(rawValueSpy.count(), 1, TestTimeout::shortMs());
+    QCOMPARE(rawValueSpy.first().first().toInt(), 2);
+}
+
+void FactNotificationCoalescerTest::_notificationOrder_test()
+{
+    FactNotificationCoalescer::instance()->setEnabled(true);
+
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact.setFrameSynchronised(true);
+
+    // valueChanged must precede containerRawValueChanged, as without frame synchronisation
+    QStringList order;
+    (void) connect(&fact, &Fact::valueChanged, this, [&order]() { order.append(QStringLiteral("value")); });
+    (void) connect(&fact, &Fact::containerRawValueChanged, this, [&order]() { order.append(QStringLiteral("container")); });
+    (void) connect(&fact, &Fact::rawValueChanged, this, [&order]() { order.append(QStringLiteral("raw")); });
+
+    fact.setRawValue(1.0);
+    QVERIFY(order.isEmpty());
+
+    FactNotificationCoalescer::instance()->flush();
+    QCOMPARE(order, QStringList({ QStringLiteral("value"), QStringLiteral("container"), QStringLiteral("raw") }));
+
+    // Updates from the vehicle do not notify the container
+    order.clear();
+    fact.containerSetRawValue(2.0);
+    FactNotificationCoalescer::instance()->flush();
+    QCOMPARE(order, QStringList({ QStringLiteral("value"), QStringLiteral("raw") }));
+}
+
+void FactNotificationCoalescerTest::_notFrameSynchronised_test()
+{
+    FactNotificationCoalescer::instance()->setEnabled(true);
+
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    QVERIFY(!fact.frameSynchronised());
+
+    QSignalSpy valueSpy(&fact, &Fact::valueChanged);
+
+    fact.setRawValue(1.0);
+    fact.setRawValue(2.0);
+
+    QCOMPARE(valueSpy.count(), 2);
+}
+
+void FactNotificationCoalescerTest::_destroyedWhileQueued_test()
+{
+    FactNotificationCoalescer *const coalescer = FactNotificationCoalescer::instance();
+    coalescer->setEnabled(true);
+
+    Fact *const fact = new Fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact->setFrameSynchronised(true);
+    fact->setRawValue(1.0);
+    delete fact;
+
+    coalescer->flush();
+    QCOMPARE(coalescer->emittedSignals(), 0ULL);
+}
+
+void FactNotificationCoalescerTest::_disableFlushes_test()
+{
+    FactNotificationCoalescer *const coalescer = FactNotificationCoalescer::instance();
+    coalescer->setEnabled(true);
+
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact.setFrameSynchronised(true);
+
+    QSignalSpy valueSpy(&fact, &Fact::valueChanged);
+
+    fact.setRawValue(1.0);
+    QCOMPARE(valueSpy.count(), 0);
+
+    coalescer->setEnabled(false);
+    QCOMPARE(valueSpy.count(), 1);
+
+    fact.setRawValue(2.0);
+    QCOMPARE(valueSpy.count(), 2);
+}
+
+UT_REGISTER_TEST(FactNotificationCoalescerTest, TestLabel::Unit)
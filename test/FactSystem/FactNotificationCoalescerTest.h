@@ -0,0 +1,20 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class FactNotificationCoalescerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init() override;
+    void cleanup() override;
+
+    void _disabledNotifiesImmediately_test();
+    void _coalescesToLatestValue_test();
+    void _containerSetRawValue_test();
+    void _notificationOrder_test();
+    void _notFrameSynchronised_test();
+    void _destroyedWhileQueued_test();
+    void _disableFlushes_test();
+};
@@ -27,7 +27,7 @@ void HashCheckTest::_deleteCacheFiles()
 {
     const QDir cacheDir = ParameterManager::parameterCacheDir();
     if (cacheDir.exists()) {
-        const QStringList cacheFiles = cacheDir.entryList(QStringList() << QStringLiteral("*.v2"), QDir::Files);
+        const QStringList cacheFiles = cacheDir.entryList(QStringList() << QStringLiteral("*.v*"), QDir::Files);
         for (const QString &file : cacheFiles) {
             QFile::remove(cacheDir.filePath(file));
         }
@@ -0,0 +1,208 @@
+#include "ParameterCacheTest.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+
+#include "ParameterCache.h"
+#include "QGC.h"
+
+namespace {
+
+QList<ParameterCache::Param_t> testParams()
+{
+    return {
+        { QStringLiteral("SYS_AUTOSTART"), FactMetaData::valueTypeInt32, QVariant(4001) },
+        { QStringLiteral("BAT1_V_CHARGED"), FactMetaData::valueTypeFloat, QVariant(4.05f) },
+        { QStringLiteral("MAV_SYS_ID"), FactMetaData::valueTypeUint8, QVariant(1) },
+        { QStringLiteral("COM_ARM_WO_GPS"), FactMetaData::valueTypeInt8, QVariant(-1) },
+        { QStringLiteral("CAL_ACC0_ID"), FactMetaData::valueTypeUint32, QVariant(4294967295u) },
+        { QStringLiteral("SENS_BOARD_ROT"), FactMetaData::valueTypeInt16, QVariant(-300) },
+        { QStringLiteral("RC_MAP_THROTTLE"), FactMetaData::valueTypeUint16, QVariant(65000) },
+        { QStringLiteral("LND_FLIGHT_T_HI"), FactMetaData::valueTypeInt64, QVariant(qint64(-5000000000)) },
+        { QStringLiteral("LND_FLIGHT_T_LO"), FactMetaData::valueTypeUint64, QVariant(quint64(5000000000)) },
+        { QStringLiteral("MIS_TAKEOFF_ALT"), FactMetaData::valueTypeDouble, QVariant(2.5) },
+    };
+}
+
+} // namespace
+
+void ParameterCacheTest::_roundTrip_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("1_1.v3"));
+
+    const QList<ParameterCache::Param_t> params = testParams();
+    QVERIFY(ParameterCache::save(fileName, params));
+
+    ParameterCache cache;
+    QVERIFY2(cache.open(fileName), qPrintable(cache.errorString()));
+    QCOMPARE(cache.count(), params.count());
+    qint64 expectedSize = ParameterCache::kHeaderSize + (params.count() * (ParameterCache::kNameEntrySize + ParameterCache::kValueSize));
+    for (const ParameterCache::Param_t &param : params) {
+        expectedSize += param.name.size();
+    }
+    QCOMPARE(QFileInfo(fileName).size(), expectedSize);
+
+    for (const ParameterCache::Param_t &param : params) {
+        const int index = cache.indexOf(param.name.toUtf8());
+        QVERIFY2(index >= 0, qPrintable(param.name));
+        QCOMPARE(cache.name(index), param.name);
+        QCOMPARE(cache.type(index), param.type);
+        QCOMPARE(cache.value(index), param.rawValue);
+    }
+
+    cache.close();
+    QVERIFY(!cache.isOpen());
+    QCOMPARE(cache.count(), 0);
+}
+
+void ParameterCacheTest::_sortedLookup_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("sorted.v3"));
+
+    QList<ParameterCache::Param_t> params = testParams();
+    params.append({ QStringLiteral("SYS_AUTOSTART"), FactMetaData::valueTypeInt32, QVariant(1) });
+    QVERIFY(ParameterCache::save(fileName, params));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(fileName));
+
+    // Duplicates are dropped and the table is in name order
+    QCOMPARE(cache.count(), testParams().count());
+    for (int index = 1; index < cache.count(); index++) {
+        QVERIFY(cache.nameView(index - 1) < cache.nameView(index));
+    }
+
+    QCOMPARE(cache.indexOf("BAT1_V_CHARGED"), 0);
+    QCOMPARE(cache.indexOf("SYS_AUTOSTART"), cache.count() - 1);
+    QCOMPARE(cache.indexOf("NOT_A_PARAM"), -1);
+    QCOMPARE(cache.indexOf("BAT1_V_CHARGE"), -1);
+    QCOMPARE(cache.indexOf(""), -1);
+}
+
+void ParameterCacheTest::_hashMatchesValueBytes_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("hash.v3"));
+
+    const QList<ParameterCache::Param_t> params = {
+        { QStringLiteral("B_PARAM"), FactMetaData::valueTypeFloat, QVariant(1.5f) },
+        { QStringLiteral("A_PARAM"), FactMetaData::valueTypeInt32, QVariant(42) },
+    };
+    QVERIFY(ParameterCache::save(fileName, params));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(fileName));
+
+    // The vehicle hashes name bytes then little endian value bytes, in name order
+    quint32 expected = 0;
+    uchar value[4];
+    qToLittleEndian<qint32>(42, value);
+    expected = QGC::crc32(reinterpret_cast<const quint8*>("A_PARAM"), 7, expected);
+    expected = QGC::crc32(value, sizeof(value), expected);
+    qToLittleEndian<float>(1.5f, value);
+    expected = QGC::crc32(reinterpret_cast<const quint8*>("B_PARAM"), 7, expected);
+    expected = QGC::crc32(value, sizeof(value), expected);
+
+    QCOMPARE(cache.hash(), expected);
+}
+
+void ParameterCacheTest::_hashExcludesParams_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString allFileName = tempDir->filePath(QStringLiteral("all.v3"));
+    const QString stableFileName = tempDir->filePath(QStringLiteral("stable.v3"));
+
+    QList<ParameterCache::Param_t> params = testParams();
+    QVERIFY(ParameterCache::save(allFileName, params));
+    params.removeIf([](const ParameterCache::Param_t &param) {
+        return (param.name == QStringLiteral("LND_FLIGHT_T_HI"));
+    });
+    QVERIFY(ParameterCache::save(stableFileName, params));
+
+    ParameterCache all;
+    ParameterCache stable;
+    QVERIFY(all.open(allFileName));
+    QVERIFY(stable.open(stableFileName));
+
+    QVERIFY(all.hash() != stable.hash());
+    QCOMPARE(all.hash([&all](int index) { return (all.nameView(index) == "LND_FLIGHT_T_HI"); }), stable.hash());
+}
+
+void ParameterCacheTest::_unsupportedTypeSkipped_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("unsupported.v3"));
+
+    QList<ParameterCache::Param_t> params = testParams();
+    params.append({ QStringLiteral("SOME_STRING"), FactMetaData::valueTypeString, QVariant(QStringLiteral("value")) });
+    QVERIFY(ParameterCache::save(fileName, params));
+
+    ParameterCache cache;
+    QVERIFY(cache.open(fileName));
+    QCOMPARE(cache.count(), testParams().count());
+    QCOMPARE(cache.indexOf("SOME_STRING"), -1);
+}
+
+void ParameterCacheTest::_rejectsCorruptFile_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("corrupt.v3"));
+    QVERIFY(ParameterCache::save(fileName, testParams()));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+
+    // Flipped value byte fails the checksum
+    data[ParameterCache::kHeaderSize + (testParams().count() * ParameterCache::kNameEntrySize)] ^= 0x01;
+    QVERIFY(file.seek(0));
+    QVERIFY(file.write(data) == data.size());
+    file.close();
+
+    ParameterCache cache;
+    QVERIFY(!cache.open(fileName));
+    QVERIFY(!cache.isOpen());
+    QVERIFY(!cache.errorString().isEmpty());
+    QCOMPARE(cache.hash(), 0u);
+
+    // Truncated
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QVERIFY(file.write(data.left(ParameterCache::kHeaderSize + 4)) == (ParameterCache::kHeaderSize + 4));
+    file.close();
+    QVERIFY(!cache.open(fileName));
+
+    // Missing
+    QVERIFY(!cache.open(tempDir->filePath(QStringLiteral("missing.v3"))));
+}
+
+void ParameterCacheTest::_rejectsOtherVersion_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+    const QString fileName = tempDir->filePath(QStringLiteral("version.v3"));
+    QVERIFY(ParameterCache::save(fileName, testParams()));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    uchar version[4];
+    qToLittleEndian<quint32>(ParameterCache::kVersion + 1, version);
+    QVERIFY(file.seek(4));
+    QVERIFY(file.write(reinterpret_cast<const char*>(version), sizeof(version)) == sizeof(version));
+    file.close();
+
+    ParameterCache cache;
+    QVERIFY(!cache.open(fileName));
+    QVERIFY(cache.errorString().contains(QStringLiteral("version")));
+}
+
+UT_REGISTER_TEST(ParameterCacheTest, TestLabel::Unit)
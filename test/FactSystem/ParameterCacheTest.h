@@ -0,0 +1,17 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class ParameterCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _roundTrip_test();
+    void _sortedLookup_test();
+    void _hashMatchesValueBytes_test();
+    void _hashExcludesParams_test();
+    void _unsupportedTypeSkipped_test();
+    void _rejectsCorruptFile_test();
+    void _rejectsOtherVersion_test();
+};
@@ -0,0 +1,280 @@
+#include "ParameterMetaDataStoreTest.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+
+#include "APMParameterMetaData.h"
+#include "CompInfoParam.h"
+#include "ParameterMetaDataStore.h"
+#include "PX4ParameterMetaData.h"
+
+namespace {
+
+bool writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return (file.open(QIODevice::WriteOnly) && (file.write(contents) == contents.size()));
+}
+
+constexpr const char *apmMetaDataXml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<paramfile>\n"
+    "<vehicles>\n"
+    "<parameters name=\"ArduCopter\">\n"
+    "<param humanName=\"Pilot maximum vertical speed\" name=\"ArduCopter:PILOT_SPEED_UP\" documentation=\"Climb rate\" user=\"Standard\">\n"
+    "<field name=\"Range\">50 500</field>\n"
+    "<field name=\"Increment\">10</field>\n"
+    "<field name=\"Units\">cm/s</field>\n"
+    "</param>\n"
+    "<param humanName=\"Pilot maximum descent speed\" name=\"ArduCopter:PILOT_SPEED_DN\" documentation=\"Descent rate\" user=\"Standard\">\n"
+    "<field name=\"Range\">0 500</field>\n"
+    "<field name=\"Units\">cm/s</field>\n"
+    "<field name=\"RebootRequired\">True</field>\n"
+    "</param>\n"
+    "<param humanName=\"Frame class\" name=\"ArduCopter:FRAME_CLASS\" documentation=\"Frame\" user=\"Standard\">\n"
+    "<values>\n"
+    "<value code=\"0\">Undefined</value>\n"
+    "<value code=\"1\">Quad</value>\n"
+    "</values>\n"
+    "</param>\n"
+    "</parameters>\n"
+    "</vehicles>\n"
+    "<libraries>\n"
+    "<parameters name=\"SERIAL\">\n"
+    "<param humanName=\"Serial options\" name=\"SERIAL1_OPTIONS\" documentation=\"Options\" user=\"Advanced\">\n"
+    "<field name=\"Bitmask\">0:InvertRX, 1:InvertTX</field>\n"
+    "<field name=\"ReadOnly\">True</field>\n"
+    "</param>\n"
+    "</parameters>\n"
+    "</libraries>\n"
+    "</paramfile>\n";
+
+void compareMetaData(const FactMetaData *actual, const FactMetaData *expected)
+{
+    QCOMPARE(actual->name(), expected->name());
+    QCOMPARE(actual->category(), expected->category());
+    QCOMPARE(actual->group(), expected->group());
+    QCOMPARE(actual->shortDescription(), expected->shortDescription());
+    QCOMPARE(actual->longDescription(), expected->longDescription());
+    QCOMPARE(actual->rawUnits(), expected->rawUnits());
+    QCOMPARE(actual->rawMin(), expected->rawMin());
+    QCOMPARE(actual->rawMax(), expected->rawMax());
+    QCOMPARE(actual->rawIncrement(), expected->rawIncrement());
+    QCOMPARE(actual->vehicleRebootRequired(), expected->vehicleRebootRequired());
+    QCOMPARE(actual->readOnly(), expected->readOnly());
+    QCOMPARE(actual->enumStrings(), expected->enumStrings());
+    QCOMPARE(actual->enumValues(), expected->enumValues());
+    QCOMPARE(actual->bitmaskStrings(), expected->bitmaskStrings());
+    QCOMPARE(actual->bitmaskValues(), expected->bitmaskValues());
+}
+
+} // namespace
+
+void ParameterMetaDataStoreTest::_contentKey_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString first = tempDir->filePath(QStringLiteral("first.xml"));
+    const QString second = tempDir->filePath(QStringLiteral("second.xml"));
+    const QString other = tempDir->filePath(QStringLiteral("other.xml"));
+    QVERIFY(writeFile(first, "<parameters/>"));
+    QVERIFY(writeFile(second, "<parameters/>"));
+    QVERIFY(writeFile(other, "<parameters />"));
+
+    QVERIFY(!ParameterMetaDataStore::contentKey(first).isEmpty());
+    QCOMPARE(ParameterMetaDataStore::contentKey(first), ParameterMetaDataStore::contentKey(second));
+    QVERIFY(ParameterMetaDataStore::contentKey(first) != ParameterMetaDataStore::contentKey(other));
+    QVERIFY(ParameterMetaDataStore::contentKey(tempDir->filePath(QStringLiteral("missing.xml"))).isEmpty());
+}
+
+void ParameterMetaDataStoreTest::_sharedSet_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString first = tempDir->filePath(QStringLiteral("first.xml"));
+    const QString second = tempDir->filePath(QStringLiteral("second.xml"));
+    QVERIFY(writeFile(first, "<parameters/>"));
+    QVERIFY(writeFile(second, "<parameters/>"));
+
+    ParameterMetaDataStore store;
+    int loads = 0;
+    QString compiledFile;
+    const ParameterMetaDataStore::Loader_t loader = [&loads, &compiledFile](QObject *parent, const QString &file) {
+        loads++;
+        compiledFile = file;
+        return new QObject(parent);
+    };
+
+    QObject *const set = store.metaDataSet(QStringLiteral("Test"), first, loader);
+    QVERIFY(set);
+    QCOMPARE(set->parent(), &store);
+    QCOMPARE(loads, 1);
+    QVERIFY(compiledFile.startsWith(ParameterMetaDataStore::compiledDir().absolutePath()));
+
+    // Identical content in another file is served by the same set
+    QCOMPARE(store.metaDataSet(QStringLiteral("Test"), first, loader), set);
+    QCOMPARE(store.metaDataSet(QStringLiteral("Test"), second, loader), set);
+    QCOMPARE(loads, 1);
+
+    const ParameterMetaDataStore::Statistics_t statistics = store.statistics();
+    QCOMPARE(statistics.setsLoaded, 1);
+    QCOMPARE(statistics.setsShared, 2);
+    QVERIFY(statistics.savedMs >= 0);
+    QVERIFY(statistics.savedResidentBytes >= 0);
+}
+
+void ParameterMetaDataStoreTest::_separateSets_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString first = tempDir->filePath(QStringLiteral("first.xml"));
+    const QString other = tempDir->filePath(QStringLiteral("other.xml"));
+    QVERIFY(writeFile(first, "<parameters/>"));
+    QVERIFY(writeFile(other, "<parameters name=\"other\"/>"));
+
+    ParameterMetaDataStore store;
+    int loads = 0;
+    const ParameterMetaDataStore::Loader_t loader = [&loads](QObject *parent, const QString &) {
+        loads++;
+        return new QObject(parent);
+    };
+
+    QObject *const set = store.metaDataSet(QStringLiteral("Test"), first, loader);
+    QObject *const otherContentSet = store.metaDataSet(QStringLiteral("Test"), other, loader);
+    QObject *const otherKindSet = store.metaDataSet(QStringLiteral("Other"), first, loader);
+    QVERIFY(set && otherContentSet && otherKindSet);
+    QVERIFY(set != otherContentSet);
+    QVERIFY(set != otherKindSet);
+    QCOMPARE(loads, 3);
+    QCOMPARE(store.statistics().setsLoaded, 3);
+    QCOMPARE(store.statistics().setsShared, 0);
+}
+
+void ParameterMetaDataStoreTest::_failedLoadNotShared_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString fileName = tempDir->filePath(QStringLiteral("first.xml"));
+    QVERIFY(writeFile(fileName, "<parameters/>"));
+
+    ParameterMetaDataStore store;
+    int loads = 0;
+    const ParameterMetaDataStore::Loader_t failingLoader = [&loads](QObject *, const QString &) -> QObject* {
+        loads++;
+        return nullptr;
+    };
+
+    QVERIFY(!store.metaDataSet(QStringLiteral("Test"), fileName, failingLoader));
+    QVERIFY(!store.metaDataSet(QStringLiteral("Test"), fileName, failingLoader));
+    QCOMPARE(loads, 2);
+
+    // Unreadable files never reach the loader
+    QVERIFY(!store.metaDataSet(QStringLiteral("Test"), tempDir->filePath(QStringLiteral("missing.xml")), failingLoader));
+    QCOMPARE(loads, 2);
+    QCOMPARE(store.statistics().setsLoaded, 0);
+}
+
+void ParameterMetaDataStoreTest::_intern_test()
+{
+    ParameterMetaDataStore store;
+
+    const QString first = QStringLiteral("Standard").toLower();
+    const QString second = QStringLiteral("STANDARD").toLower();
+    QVERIFY(!first.isSharedWith(second));
+
+    const QString internedFirst = store.intern(first);
+    const QString internedSecond = store.intern(second);
+    QCOMPARE(internedSecond, second);
+    QVERIFY(internedFirst.isSharedWith(internedSecond));
+
+    // Interning an already shared copy is not counted as a saving
+    (void) store.intern(internedFirst);
+    QVERIFY(store.intern(QString()).isEmpty());
+
+    const ParameterMetaDataStore::Statistics_t statistics = store.statistics();
+    QCOMPARE(statistics.internedStrings, 1);
+    QCOMPARE(statistics.internHits, 1);
+    QVERIFY(statistics.internSavedBytes == (second.size() * static_cast<qint64>(sizeof(QChar))));
+
+    store.resetStatistics();
+    QCOMPARE(store.statistics().internHits, 0);
+}
+
+void ParameterMetaDataStoreTest::_apmCompiledRoundTrip_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString xmlFile = tempDir->filePath(QStringLiteral("APMParameterFactMetaData.Copter.4.5.xml"));
+    const QString compiledFile = tempDir->filePath(QStringLiteral("APM.compiled.bin"));
+    QVERIFY(writeFile(xmlFile, apmMetaDataXml));
+
+    APMParameterMetaData parsed;
+    parsed.loadParameterFactMetaDataFile(xmlFile, compiledFile);
+    QVERIFY(QFile::exists(compiledFile));
+
+    // The compiled form must be used even once the xml is gone
+    QVERIFY(QFile::remove(xmlFile));
+    APMParameterMetaData compiled;
+    compiled.loadParameterFactMetaDataFile(xmlFile, compiledFile);
+
+    const QList<QPair<QString, FactMetaData::ValueType_t>> params = {
+        { QStringLiteral("PILOT_SPEED_UP"), FactMetaData::valueTypeInt16 },
+        { QStringLiteral("PILOT_SPEED_DN"), FactMetaData::valueTypeInt16 },
+        { QStringLiteral("FRAME_CLASS"), FactMetaData::valueTypeInt8 },
+        { QStringLiteral("SERIAL1_OPTIONS"), FactMetaData::valueTypeInt32 },
+        { QStringLiteral("UNKNOWN_PARAM"), FactMetaData::valueTypeFloat },
+    };
+    for (const auto &param : params) {
+        const FactMetaData *const expected = parsed.getMetaDataForFact(param.first, MAV_TYPE_QUADROTOR, param.second);
+        const FactMetaData *const actual = compiled.getMetaDataForFact(param.first, MAV_TYPE_QUADROTOR, param.second);
+        QVERIFY(expected && actual);
+        compareMetaData(actual, expected);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+
+        // Vehicles of the same type share the FactMetaData
+        QCOMPARE(compiled.getMetaDataForFact(param.first, MAV_TYPE_QUADROTOR, param.second), actual);
+    }
+}
+
+void ParameterMetaDataStoreTest::_px4GenericMetaDataPerType_test()
+{
+    PX4ParameterMetaData metaData;
+
+    // Vehicles sharing the meta data may report a parameter it does not know with different types
+    FactMetaData *const int32MetaData = metaData.getMetaDataForFact(QStringLiteral("UNKNOWN_PARAM"), MAV_TYPE_QUADROTOR, FactMetaData::valueTypeInt32);
+    FactMetaData *const floatMetaData = metaData.getMetaDataForFact(QStringLiteral("UNKNOWN_PARAM"), MAV_TYPE_FIXED_WING, FactMetaData::valueTypeFloat);
+    QVERIFY(int32MetaData && floatMetaData);
+    QCOMPARE(int32MetaData->type(), FactMetaData::valueTypeInt32);
+    QCOMPARE(floatMetaData->type(), FactMetaData::valueTypeFloat);
+
+    QCOMPARE(metaData.getMetaDataForFact(QStringLiteral("UNKNOWN_PARAM"), MAV_TYPE_HEXAROTOR, FactMetaData::valueTypeInt32), int32MetaData);
+}
+
+void ParameterMetaDataStoreTest::_compInfoParamSkipsMalformed_test()
+{
+    QTemporaryDir *const tempDir = createTempDir();
+    QVERIFY(tempDir && tempDir->isValid());
+
+    const QString fileName = tempDir->filePath(QStringLiteral("parameters.json"));
+    QVERIFY(writeFile(fileName,
+        "{ \"version\": 1, \"parameters\": ["
+        "{ \"name\": \"SKIP_TEST_FIRST\", \"type\": \"Int32\", \"shortDesc\": \"First\" },"
+        "42,"
+        "{ \"name\": \"SKIP_TEST_LAST\", \"type\": \"Float\", \"shortDesc\": \"Last\" }"
+        "] }"));
+
+    // The malformed entry is skipped, the entries before and after it are kept
+    CompInfoParam compInfoParam(MAV_COMP_ID_AUTOPILOT1, nullptr);
+    compInfoParam.setJson(fileName);
+    QCOMPARE(compInfoParam.factMetaDataForName(QStringLiteral("SKIP_TEST_FIRST"), FactMetaData::valueTypeInt32)->shortDescription(), QStringLiteral("First"));
+    QCOMPARE(compInfoParam.factMetaDataForName(QStringLiteral("SKIP_TEST_LAST"), FactMetaData::valueTypeFloat)->shortDescription(), QStringLiteral("Last"));
+}
+
+UT_REGISTER_TEST(ParameterMetaDataStoreTest, TestLabel::Unit)
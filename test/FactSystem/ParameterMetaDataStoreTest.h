@@ -0,0 +1,18 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class ParameterMetaDataStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _contentKey_test();
+    void _sharedSet_test();
+    void _separateSets_test();
+    void _failedLoadNotShared_test();
+    void _intern_test();
+    void _apmCompiledRoundTrip_test();
+    void _px4GenericMetaDataPerType_test();
+    void _compInfoParamSkipsMalformed_test();
+};
@@ -0,0 +1,75 @@
+#include "MAVLinkMessageDispatchTableTest.h"
+
+#include "MAVLinkLib.h"
+#include "MAVLinkMessageDispatchTable.h"
+
+using DispatchTable = MAVLinkMessageDispatchTable<int>;
+
+static QList<int> _dispatched(const DispatchTable &table, uint32_t msgId)
+{
+    QList<int> handlers;
+    table.dispatch(msgId, [&handlers](int handler) {
+        handlers.append(handler);
+    });
+    return handlers;
+}
+
+void MAVLinkMessageDispatchTableTest::_directIdDispatch_test()
+{
+    DispatchTable table;
+    table.subscribe(MAVLINK_MSG_ID_ATTITUDE, 1);
+    table.subscribe(MAVLINK_MSG_ID_ATTITUDE, 2);
+    table.subscribe(MAVLINK_MSG_ID_VFR_HUD, 3);
+
+    QVERIFY(MAVLINK_MSG_ID_ATTITUDE < DispatchTable::kDirectMsgIdCount);
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_ATTITUDE), QList<int>({ 1, 2 }));
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_VFR_HUD), QList<int>({ 3 }));
+}
+
+void MAVLinkMessageDispatchTableTest::_sparseIdDispatch_test()
+{
+    DispatchTable table;
+    table.subscribe(MAVLINK_MSG_ID_HYGROMETER_SENSOR, 1);
+    table.subscribe(MAVLINK_MSG_ID_OPEN_DRONE_ID_ARM_STATUS, 2);
+
+    QVERIFY(MAVLINK_MSG_ID_HYGROMETER_SENSOR >= DispatchTable::kDirectMsgIdCount);
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_HYGROMETER_SENSOR), QList<int>({ 1 }));
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_OPEN_DRONE_ID_ARM_STATUS), QList<int>({ 2 }));
+}
+
+void MAVLinkMessageDispatchTableTest::_subscribeAllDispatch_test()
+{
+    DispatchTable table;
+    table.subscribeAll(9);
+    table.subscribe(MAVLINK_MSG_ID_ATTITUDE, 1);
+
+    // Id specific handlers come first
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_ATTITUDE), QList<int>({ 1, 9 }));
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_HEARTBEAT), QList<int>({ 9 }));
+    QCOMPARE(_dispatched(table, MAVLINK_MSG_ID_HYGROMETER_SENSOR), QList<int>({ 9 }));
+    QVERIFY(table.handlers(MAVLINK_MSG_ID_HEARTBEAT).isEmpty());
+}
+
+void MAVLinkMessageDispatchTableTest::_unsubscribedId_test()
+{
+    DispatchTable table;
+    table.subscribe(MAVLINK_MSG_ID_ATTITUDE, 1);
+
+    QVERIFY(_dispatched(table, MAVLINK_MSG_ID_HEARTBEAT).isEmpty());
+    QVERIFY(_dispatched(table, MAVLINK_MSG_ID_HYGROMETER_SENSOR).isEmpty());
+}
+
+void MAVLinkMessageDispatchTableTest::_clear_test()
+{
+    DispatchTable table;
+    table.subscribe(MAVLINK_MSG_ID_ATTITUDE, 1);
+    table.subscribe(MAVLINK_MSG_ID_HYGROMETER_SENSOR, 2);
+    table.subscribeAll(3);
+
+    table.clear();
+
+    QVERIFY(_dispatched(table, MAVLINK_MSG_ID_ATTITUDE).isEmpty());
+    QVERIFY(_dispatched(table, MAVLINK_MSG_ID_HYGROMETER_SENSOR).isEmpty());
+}
+
+UT_REGISTER_TEST(MAVLinkMessageDispatchTableTest, TestLabel::Unit)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkMessageDispatchTableTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _directIdDispatch_test();
+    void _sparseIdDispatch_test();
+    void _subscribeAllDispatch_test();
+    void _unsubscribedId_test();
+    void _clear_test();
+};
@@ -25,6 +25,30 @@ bool QGCCacheWorkerTest::_startWorker(QGCCacheWorker& worker, int timeoutMs)
     return ok;
 }
 
+bool QGCCacheWorkerTest::_fetchTile(QGCCacheWorker& worker, const QString& hash)
+{
+    auto* fetchTask = new QGCFetchTileTask(hash);
+    QGCCacheTile* fetched = nullptr;
+    bool fetchError = false;
+    connect(
+        fetchTask, &QGCFetchTileTask::tileFetched, this, [&](QGCCacheTile* t) { fetched = t; }, Qt::QueuedConnection);
+    connect(
+        fetchTask, &QGCMapTask::error, this, [&](QGCMapTask::TaskType, const QString&) { fetchError = true; },
+        Qt::QueuedConnection);
+
+    if (!worker.enqueueTask(fetchTask)) {
+        return false;
+    }
+    if (!UnitTest::waitForCondition([&]() { return fetched || fetchError; }, TestTimeout::mediumMs(),
+                                    QStringLiteral("QGCFetchTileTask"))) {
+        return false;
+    }
+
+    const bool found = (fetched != nullptr) && (fetched->hash == hash);
+    delete fetched;
+    return found;
+}
+
 void QGCCacheWorkerTest::_testStartAndStop()
 {
     QGCCacheWorker worker;
@@ -298,4 +322,124 @@ void QGCCacheWorkerTest::_testStopWhileProcessing()
     QVERIFY(!worker.isRunning());
 }
 
+void QGCCacheWorkerTest::_testFetchFromReaderPool()
+{
+    QGCCacheWorker worker;
+    worker.setDatabaseFile(tempPath("reader_pool.db"));
+    QVERIFY(_startWorker(worker));
+
+    auto* tile = new QGCCacheTile(QStringLiteral("rp1"), QByteArray("tile_data"), QStringLiteral("png"), QStringLiteral("T"));
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(tile)));
+
+    // The save is still queued, so this fetch stays behind it on the writer
+    QVERIFY(_fetchTile(worker, QStringLiteral("rp1")));
+
+    // Nothing pending for the tile any more, a reader serves it from its own connection
+    QVERIFY(_fetchTile(worker, QStringLiteral("rp1")));
+    QVERIFY(!_fetchTile(worker, QStringLiteral("missing")));
+    // Statistics are recorded just after the result is sent
+    QTRY_COMPARE_WITH_TIMEOUT(worker.statistics().pooledFetches, 2ULL, TestTimeout::mediumMs());
+    QTRY_COMPARE_WITH_TIMEOUT(worker.statistics().task(QGCMapTask::TaskType::taskFetchTile).count, 3ULL, TestTimeout::mediumMs());
+    QTRY_COMPARE_WITH_TIMEOUT(static_cast<int>(worker.statistics().writerQueueDepth), 0, TestTimeout::mediumMs());
+
+    const QGCCacheWorker::Statistics_t stats = worker.statistics();
+    QCOMPARE(stats.task(QGCMapTask::TaskType::taskCacheTile).count, 1ULL);
+    QVERIFY(stats.maxWriterQueueDepth >= 1);
+    QCOMPARE(static_cast<int>(stats.readerQueueDepth), 0);
+
+    // Readers close their connections for the reset and see the empty database afterwards
+    auto* resetTask = new QGCResetTask();
+    bool resetDone = false;
+    connect(resetTask, &QGCResetTask::resetCompleted, this, [&]() { resetDone = true; }, Qt::QueuedConnection);
+    QVERIFY(worker.enqueueTask(resetTask));
+    QTRY_VERIFY_WITH_TIMEOUT(resetDone, TestTimeout::mediumMs());
+    QVERIFY(!_fetchTile(worker, QStringLiteral("rp1")));
+
+    worker.stop();
+    QVERIFY(worker.wait(TestTimeout::mediumMs()));
+}
+
+void QGCCacheWorkerTest::_testReaderPoolDisabled()
+{
+    QGCCacheWorker worker;
+    worker.setDatabaseFile(tempPath("no_readers.db"));
+    worker.setReaderCount(0);
+    QVERIFY(_startWorker(worker));
+
+    auto* tile = new QGCCacheTile(QStringLiteral("nr1"), QByteArray("tile_data"), QStringLiteral("png"), QStringLiteral("T"));
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(tile)));
+    QVERIFY(_fetchTile(worker, QStringLiteral("nr1")));
+    QVERIFY(_fetchTile(worker, QStringLiteral("nr1")));
+
+    QTRY_COMPARE_WITH_TIMEOUT(worker.statistics().task(QGCMapTask::TaskType::taskFetchTile).count, 2ULL, TestTimeout::mediumMs());
+    QCOMPARE(worker.statistics().pooledFetches, 0ULL);
+
+    worker.stop();
+    QVERIFY(worker.wait(TestTimeout::mediumMs()));
+}
+
+void QGCCacheWorkerTest::_testFetchFromMemoryCache()
+{
+    QGCCacheWorker worker;
+    worker.setDatabaseFile(tempPath("memory_cache.db"));
+    QVERIFY(_startWorker(worker));
+
+    // Hash layout of UrlFactory::getTileHash(): map id, x, y, zoom
+    const QString hash = QString::asprintf("%010d%08d%08d%03d", 1, 5, 3, 4);
+    auto* tile = new QGCCacheTile(hash, QByteArray("tile_data"), QStringLiteral("png"), QStringLiteral("T"));
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(tile)));
+
+    // Read from the database once, then served from memory
+    QVERIFY(_fetchTile(worker, hash));
+    QVERIFY(_fetchTile(worker, hash));
+    QVERIFY(_fetchTile(worker, hash));
+
+    QGCTileMemoryCache::Statistics_t stats = worker.statistics().memoryCache;
+    QCOMPARE(stats.misses, 1ULL);
+    QCOMPARE(stats.hits, 2ULL);
+    QCOMPARE(static_cast<int>(stats.count), 1);
+
+    // Removing tiles drops them from memory too
+    auto* resetTask = new QGCResetTask();
+    bool resetDone = false;
+    connect(resetTask, &QGCResetTask::resetCompleted, this, [&]() { resetDone = true; }, Qt::QueuedConnection);
+    QVERIFY(worker.enqueueTask(resetTask));
+    QTRY_VERIFY_WITH_TIMEOUT(resetDone, TestTimeout::mediumMs());
+    QVERIFY(!_fetchTile(worker, hash));
+
+    stats = worker.statistics().memoryCache;
+    QCOMPARE(stats.hits, 2ULL);
+    QCOMPARE(static_cast<int>(stats.count), 0);
+
+    worker.stop();
+    QVERIFY(worker.wait(TestTimeout::mediumMs()));
+}
+
+void QGCCacheWorkerTest::_testSaveTileBatch()
+{
+    QGCCacheWorker worker;
+    worker.setDatabaseFile(tempPath("save_batch.db"));
+    QVERIFY(_startWorker(worker));
+
+    QList<QGCCacheTile*> tiles;
+    tiles.append(new QGCCacheTile(QStringLiteral("sb1"), QByteArray("tile_data"), QStringLiteral("png"), QStringLiteral("T")));
+    tiles.append(new QGCCacheTile(QStringLiteral("sb2"), QByteArray("tile_data"), QStringLiteral("png"), QStringLiteral("T")));
+    auto* batchTask = new QGCSaveTileBatchTask(tiles, false);
+    int savedCount = 0;
+    qint64 savedBytes = 0;
+    connect(batchTask, &QGCSaveTileBatchTask::tilesSaved, this, [&](int count, qint64 bytes) { savedCount = count; savedBytes = bytes; }, Qt::QueuedConnection);
+    QVERIFY(worker.enqueueTask(batchTask));
+
+    // Queued behind the batch on the writer
+    QVERIFY(_fetchTile(worker, QStringLiteral("sb2")));
+    QTRY_COMPARE_WITH_TIMEOUT(savedCount, 2, TestTimeout::mediumMs());
+    QCOMPARE(savedBytes, qint64(2 * 9));
+    QVERIFY(_fetchTile(worker, QStringLiteral("sb1")));
+
+    QTRY_COMPARE_WITH_TIMEOUT(worker.statistics().task(QGCMapTask::TaskType::taskCacheTileBatch).count, 1ULL, TestTimeout::mediumMs());
+
+    worker.stop();
+    QVERIFY(worker.wait(TestTimeout::mediumMs()));
+}
+
 UT_REGISTER_TEST(QGCCacheWorkerTest, TestLabel::Unit)
@@ -19,7 +19,12 @@ private slots:
     void _testPruneCache();
     void _testResetDatabase();
     void _testStopWhileProcessing();
+    void _testFetchFromReaderPool();
+    void _testReaderPoolDisabled();
+    void _testFetchFromMemoryCache();
+    void _testSaveTileBatch();
 
 private:
     bool _startWorker(QGCCacheWorker& worker, int timeoutMs = TestTimeout::mediumMs());
+    bool _fetchTile(QGCCacheWorker& worker, const QString& hash);
 };
@@ -248,6 +248,55 @@ void QGCCachedTileSetTest::_testCompleteWhenAllSaved()
     QVERIFY(ts.complete());
 }
 
+void QGCCachedTileSetTest::_testSavedCountFollowsCommits()
+{
+    QGCCachedTileSet ts(QStringLiteral("test"));
+    ts.setTotalTileCount(10);
+
+    // The download finishes while a batch is still being written
+    ts._saveBatchesInFlight = 2;
+    ts._doneWithDownload();
+    QVERIFY(ts._donePending);
+    QCOMPARE(ts.totalTileCount(), 10u);
+
+    ts._tilesSaved(4, 400);
+    QCOMPARE(ts.savedTileCount(), 4u);
+    QCOMPARE(ts.savedTileSize(), quint64(400));
+    QVERIFY(ts._donePending);
+
+    // The totals are only taken once the last batch committed
+    ts._tilesSaved(2, 200);
+    QVERIFY(!ts._donePending);
+    QCOMPARE(ts._saveBatchesInFlight, 0);
+    QCOMPARE(ts.savedTileCount(), 6u);
+    QCOMPARE(ts.totalTileCount(), 6u);
+    QCOMPARE(ts.totalTilesSize(), quint64(600));
+}
+
+void QGCCachedTileSetTest::_testSaveBatchNotSaved()
+{
+    QGCCachedTileSet ts(QStringLiteral("test"));
+    ts.setTotalTileCount(10);
+
+    // The map engine has no tile cache database in this test, so it rejects the batch
+    ts._queueTileSave(QStringLiteral("Bing Road"), QStringLiteral("hash1"), QByteArray("image1"), QStringLiteral("png"));
+    ts._queueTileSave(QStringLiteral("Bing Road"), QStringLiteral("hash2"), QByteArray("image2"), QStringLiteral("png"));
+    ts._flushTileSaves();
+    QCOMPARE(ts._saveBatchesInFlight, 0);
+    QCOMPARE(ts.errorCount(), 2u);
+    QCOMPARE(ts.savedTileCount(), 0u);
+
+    // A batch rolled back while the download finishes still completes it
+    ts._saveBatchesInFlight = 1;
+    ts._doneWithDownload();
+    QVERIFY(ts._donePending);
+    ts._tilesNotSaved({ QStringLiteral("hash3") });
+    QVERIFY(!ts._donePending);
+    QCOMPARE(ts._saveBatchesInFlight, 0);
+    QCOMPARE(ts.errorCount(), 3u);
+    QCOMPARE(ts.totalTileCount(), 10u);
+}
+
 void QGCCachedTileSetTest::_testSetSelectedEmitsSignal()
 {
     QGCCachedTileSet ts(QStringLiteral("test"));
@@ -21,5 +21,7 @@ private slots:
     void _testSetterNoSignalOnSameValue();
     void _testCompleteWhenDefaultSet();
     void _testCompleteWhenAllSaved();
+    void _testSavedCountFollowsCommits();
+    void _testSaveBatchNotSaved();
     void _testSetSelectedEmitsSignal();
 };
@@ -0,0 +1,319 @@
+#include "QGCTileArchiveTest.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+#include <QtCore/QtEndian>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtTest/QTest>
+
+#include <tuple>
+
+#include "GenericMapProvider.h"
+#include "QGCCacheTile.h"
+#include "QGCMapUrlEngine.h"
+#include "QGCTileArchive.h"
+#include "QGCTileArchiveSet.h"
+#include "QGCTileMemoryCache.h"
+
+namespace {
+
+struct Entry_t {
+    quint64 tileId;
+    quint64 offset;
+    quint32 length;
+    quint32 runLength;
+};
+
+void appendVarint(QByteArray &bytes, quint64 value)
+{
+    while (value >= 0x80) {
+        bytes.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    bytes.append(static_cast<char>(value));
+}
+
+/// Uncompressed PMTiles directory, entries sorted by tile id
+QByteArray encodeDirectory(const QList<Entry_t> &entries)
+{
+    QByteArray bytes;
+    appendVarint(bytes, entries.size());
+    quint64 lastId = 0;
+    for (const Entry_t &entry : entries) {
+        appendVarint(bytes, entry.tileId - lastId);
+        lastId = entry.tileId;
+    }
+    for (const Entry_t &entry : entries) {
+        appendVarint(bytes, entry.runLength);
+    }
+    for (const Entry_t &entry : entries) {
+        appendVarint(bytes, entry.length);
+    }
+    for (qsizetype i = 0; i < entries.size(); i++) {
+        const Entry_t &entry = entries.at(i);
+        const bool contiguous = (i > 0) && (entry.offset == (entries.at(i - 1).offset + entries.at(i - 1).length));
+        appendVarint(bytes, contiguous ? 0 : (entry.offset + 1));
+    }
+    return bytes;
+}
+
+/// Uncompressed PMTiles version 3 file: header, root directory, leaf directories, tile data
+bool writePMTiles(const QString &path, quint8 tileType, quint8 minZoom, quint8 maxZoom,
+                  const QByteArray &rootDirectory, const QByteArray &leafDirectories, const QByteArray &tileData)
+{
+    QByteArray header(127, '\0');
+    (void) header.replace(0, 7, "PMTiles");
+    header[7] = 3;
+
+    const quint64 rootOffset = header.size();
+    const quint64 leafOffset = rootOffset + rootDirectory.size();
+    const quint64 tileDataOffset = leafOffset + leafDirectories.size();
+    const auto put = [&header](qsizetype position, quint64 value) {
+        qToLittleEndian<quint64>(value, header.data() + position);
+    };
+    put(8, rootOffset);
+    put(16, rootDirectory.size());
+    put(40, leafOffset);
+    put(48, leafDirectories.size());
+    put(56, tileDataOffset);
+    put(64, tileData.size());
+    header[97] = 1;
+    header[98] = 1;
+    header[99] = static_cast<char>(tileType);
+    header[100] = static_cast<char>(minZoom);
+    header[101] = static_cast<char>(maxZoom);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return (file.write(header + rootDirectory + leafDirectories + tileData) == (header.size() + rootDirectory.size() + leafDirectories.size() + tileData.size()));
+}
+
+/// MBTiles file with the tiles given in XYZ numbering
+bool writeMBTiles(const QString &path, const QString &format, const QList<std::tuple<int, int, int, QByteArray>> &tiles)
+{
+    bool success = false;
+    const QString connection = QStringLiteral("QGCTileArchiveTest_mbtiles");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection);
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            success = query.exec("CREATE TABLE metadata (name TEXT, value TEXT)") &&
+                      query.exec("CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)") &&
+                      query.prepare("INSERT INTO metadata (name, value) VALUES ('format', ?)");
+            if (success) {
+                query.addBindValue(format);
+                success = query.exec();
+            }
+            for (const auto &[x, y, zoom, image] : tiles) {
+                success = success && query.prepare("INSERT INTO tiles VALUES (?, ?, ?, ?)");
+                if (success) {
+                    query.addBindValue(zoom);
+                    query.addBindValue(x);
+                    query.addBindValue(((1 << zoom) - 1) - y);
+                    query.addBindValue(image);
+                    success = query.exec();
+                }
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return success;
+}
+
+constexpr quint8 kTileTypeMvt = 1;
+constexpr quint8 kTileTypePng = 2;
+
+} // namespace
+
+void QGCTileArchiveTest::_testPMTilesTileId()
+{
+    QCOMPARE(QGCTileArchive::pmtilesTileId(0, 0, 0), 0ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(0, 0, 1), 1ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(0, 1, 1), 2ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(1, 1, 1), 3ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(1, 0, 1), 4ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(0, 0, 2), 5ULL);
+    QCOMPARE(QGCTileArchive::pmtilesTileId(0, 0, 3), 21ULL);
+}
+
+void QGCTileArchiveTest::_testPMTilesRootDirectory()
+{
+    // Zoom 0 "A", all of zoom 1 shares "B" through a run, zoom 2 only has (0,0) "CC"
+    const QByteArray tileData("ABCC");
+    const QByteArray root = encodeDirectory({ {0, 0, 1, 1}, {1, 1, 1, 4}, {5, 2, 2, 1} });
+    const QString path = tempPath("root.pmtiles");
+    QVERIFY(writePMTiles(path, kTileTypePng, 0, 2, root, QByteArray(), tileData));
+
+    QGCTileArchive archive;
+    QVERIFY2(archive.open(path), qPrintable(archive.errorString()));
+    QCOMPARE(archive.format(), QGCTileArchive::Format::PMTiles);
+    QCOMPARE(archive.tileFormat(), QStringLiteral("png"));
+    QCOMPARE(archive.minZoom(), 0);
+    QCOMPARE(archive.maxZoom(), 2);
+
+    QCOMPARE(archive.tile(0, 0, 0), QByteArray("A"));
+    QCOMPARE(archive.tile(0, 0, 1), QByteArray("B"));
+    QCOMPARE(archive.tile(1, 0, 1), QByteArray("B"));
+    QCOMPARE(archive.tile(0, 0, 2), QByteArray("CC"));
+    QVERIFY(archive.tile(1, 1, 2).isEmpty());
+    QVERIFY(archive.tile(0, 0, 3).isEmpty());
+    QVERIFY(archive.tile(2, 0, 1).isEmpty());
+}
+
+void QGCTileArchiveTest::_testPMTilesLeafDirectory()
+{
+    const QByteArray tileData("LEAF");
+    const QByteArray leaf = encodeDirectory({ {QGCTileArchive::pmtilesTileId(1, 1, 1), 0, 4, 1} });
+    const QByteArray root = encodeDirectory({ {0, 0, static_cast<quint32>(leaf.size()), 0} });
+    const QString path = tempPath("leaf.pmtiles");
+    QVERIFY(writePMTiles(path, kTileTypePng, 0, 1, root, leaf, tileData));
+
+    QGCTileArchive archive;
+    QVERIFY2(archive.open(path), qPrintable(archive.errorString()));
+    QCOMPARE(archive.tile(1, 1, 1), QByteArray("LEAF"));
+    QVERIFY(archive.tile(0, 0, 1).isEmpty());
+    // From the cached leaf directory
+    QCOMPARE(archive.tile(1, 1, 1), QByteArray("LEAF"));
+}
+
+void QGCTileArchiveTest::_testPMTilesRejectsVectorTiles()
+{
+    const QString path = tempPath("vector.pmtiles");
+    QVERIFY(writePMTiles(path, kTileTypeMvt, 0, 0, encodeDirectory({ {0, 0, 1, 1} }), QByteArray(), QByteArray("V")));
+
+    QGCTileArchive archive;
+    QVERIFY(!archive.open(path));
+    QVERIFY(!archive.isValid());
+    QVERIFY(!archive.errorString().isEmpty());
+    QVERIFY(archive.tile(0, 0, 0).isEmpty());
+
+    const QString garbage = tempPath("garbage.pmtiles");
+    QFile file(garbage);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(QByteArray(200, 'x')) == 200);
+    file.close();
+    QVERIFY(!archive.open(garbage));
+}
+
+void QGCTileArchiveTest::_testMBTiles()
+{
+    const QString path = tempPath("tiles.mbtiles");
+    QVERIFY(writeMBTiles(path, QStringLiteral("jpg"), { {0, 0, 0, QByteArray("root")}, {1, 0, 1, QByteArray("north-east")} }));
+
+    QGCTileArchive archive;
+    QVERIFY2(archive.open(path), qPrintable(archive.errorString()));
+    QCOMPARE(archive.format(), QGCTileArchive::Format::MBTiles);
+    QCOMPARE(archive.tileFormat(), QStringLiteral("jpg"));
+    QCOMPARE(archive.minZoom(), 0);
+    QCOMPARE(archive.maxZoom(), 1);
+
+    QCOMPARE(archive.tile(0, 0, 0), QByteArray("root"));
+    QCOMPARE(archive.tile(1, 0, 1), QByteArray("north-east"));
+    QVERIFY(archive.tile(1, 1, 1).isEmpty());
+
+    archive.releaseThreadConnection();
+    // A new connection is opened on the next read
+    QCOMPARE(archive.tile(0, 0, 0), QByteArray("root"));
+}
+
+void QGCTileArchiveTest::_testMBTilesRejectsVectorTiles()
+{
+    const QString path = tempPath("vector.mbtiles");
+    QVERIFY(writeMBTiles(path, QStringLiteral("pbf"), { {0, 0, 0, QByteArray("V")} }));
+
+    QGCTileArchive archive;
+    QVERIFY(!archive.open(path));
+    QVERIFY(!archive.isValid());
+}
+
+void QGCTileArchiveTest::_testArchiveSet()
+{
+    QVERIFY(writePMTiles(tempPath("a.pmtiles"), kTileTypePng, 0, 0, encodeDirectory({ {0, 0, 1, 1} }), QByteArray(), QByteArray("P")));
+    QVERIFY(writeMBTiles(tempPath("b.mbtiles"), QStringLiteral("png"), { {0, 0, 0, QByteArray("M")}, {0, 1, 1, QByteArray("M1")} }));
+    QVERIFY(writeMBTiles(tempPath("c.mbtiles"), QStringLiteral("pbf"), { {0, 0, 0, QByteArray("V")} }));
+
+    const QString type = QString::fromLatin1(OfflineArchiveMapProvider::kProviderKey);
+    const int mapId = UrlFactory::getQtMapIdFromProviderType(type);
+    QVERIFY(mapId > 0);
+
+    QGCTileArchiveSet archives(mapId);
+    QCOMPARE(archives.load(tempDirPath()), 2);
+    QCOMPARE(archives.count(), 2);
+
+    const auto fetch = [&](int x, int y, int zoom) {
+        return archives.getTile(QGCTileMemoryCache::key(mapId, x, y, zoom), UrlFactory::getTileHash(type, x, y, zoom));
+    };
+
+    // The first archive in name order wins
+    std::unique_ptr<QGCCacheTile> tile = fetch(0, 0, 0);
+    QVERIFY(tile);
+    QCOMPARE(tile->img, QByteArray("P"));
+    QCOMPARE(tile->format, QStringLiteral("png"));
+    QCOMPARE(tile->type, type);
+
+    tile = fetch(0, 1, 1);
+    QVERIFY(tile);
+    QCOMPARE(tile->img, QByteArray("M1"));
+    QVERIFY(!fetch(1, 1, 1));
+
+    const int otherMapId = UrlFactory::getQtMapIdFromProviderType(QStringLiteral("Bing Road"));
+    QVERIFY(!archives.isArchiveTile(QGCTileMemoryCache::key(otherMapId, 0, 0, 0)));
+    QVERIFY(!archives.isArchiveTile(QGCTileMemoryCache::kInvalidKey));
+    QVERIFY(!archives.getTile(QGCTileMemoryCache::key(otherMapId, 0, 0, 0), QString()));
+
+    archives.releaseThreadConnections();
+    archives.clear();
+    QCOMPARE(archives.count(), 0);
+    QVERIFY(!fetch(0, 0, 0));
+}
+
+void QGCTileArchiveTest::_testArchiveSetRetiresThroughReaders()
+{
+    QVERIFY(writePMTiles(tempPath("a.pmtiles"), kTileTypePng, 0, 0, encodeDirectory({ {0, 0, 1, 1} }), QByteArray(), QByteArray("P")));
+    QVERIFY(writeMBTiles(tempPath("b.mbtiles"), QStringLiteral("png"), { {0, 1, 1, QByteArray("M1")} }));
+
+    const QString type = QString::fromLatin1(OfflineArchiveMapProvider::kProviderKey);
+    const int mapId = UrlFactory::getQtMapIdFromProviderType(type);
+
+    QGCTileArchiveSet archives(mapId);
+    QCOMPARE(archives.load(tempDirPath()), 2);
+
+    // A reading thread with an event loop, so it can keep its connection between fetches
+    QThread reader;
+    QObject readerContext;
+    readerContext.moveToThread(&reader);
+    reader.start();
+    const auto fetchOnReader = [&]() {
+        QByteArray image;
+        (void) QMetaObject::invokeMethod(&readerContext, [&]() {
+            const std::unique_ptr<QGCCacheTile> tile = archives.getTile(QGCTileMemoryCache::key(mapId, 0, 1, 1), UrlFactory::getTileHash(type, 0, 1, 1));
+            image = tile ? tile->img : QByteArray();
+        }, Qt::BlockingQueuedConnection);
+        return image;
+    };
+
+    QCOMPARE(fetchOnReader(), QByteArray("M1"));
+    const qsizetype connectionCount = QSqlDatabase::connectionNames().size();
+
+    // Reloading retires the archives instead of removing the reader's connection under it
+    QCOMPARE(archives.load(tempDirPath()), 2);
+    QCOMPARE(archives.retiredCount(), 2);
+    QCOMPARE(QSqlDatabase::connectionNames().size(), connectionCount);
+
+    // The reader removes its own connection to the retired archive on its next fetch, then both are destroyed
+    QCOMPARE(fetchOnReader(), QByteArray("M1"));
+    QCOMPARE(archives.retiredCount(), 0);
+    QCOMPARE(QSqlDatabase::connectionNames().size(), connectionCount);
+
+    (void) QMetaObject::invokeMethod(&readerContext, [&]() { archives.releaseThreadConnections(); }, Qt::BlockingQueuedConnection);
+    QCOMPARE(QSqlDatabase::connectionNames().size(), connectionCount - 1);
+    reader.quit();
+    QVERIFY(reader.wait());
+}
+
+UT_REGISTER_TEST(QGCTileArchiveTest, TestLabel::Unit)
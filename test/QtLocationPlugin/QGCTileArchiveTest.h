@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BaseClasses/TempDirectoryTest.h"
+
+class QGCTileArchiveTest : public TempDirectoryTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testPMTilesTileId();
+    void _testPMTilesRootDirectory();
+    void _testPMTilesLeafDirectory();
+    void _testPMTilesRejectsVectorTiles();
+    void _testMBTiles();
+    void _testMBTilesRejectsVectorTiles();
+    void _testArchiveSet();
+    void _testArchiveSetRetiresThroughReaders();
+};
@@ -1,7 +1,10 @@
 #include "QGCTileCacheDatabaseTest.h"
 
+#include "Benchmarking.h"
+
 #include <QtCore/QDateTime>
 #include <QtCore/QFile>
+#include <QtCore/QHash>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QSettings>
 #include <QtSql/QSqlDatabase>
@@ -357,6 +360,87 @@ void QGCTileCacheDatabaseTest::_testExportImportReplace()
     QVERIFY(db2->findTile(QStringLiteral("exp2")).has_value());
 }
 
+void QGCTileCacheDatabaseTest::_testExportMBTiles()
+{
+    auto db = _createInitializedDB();
+
+    const QString type = QStringLiteral("Bing Road");
+    const int mapId = UrlFactory::getQtMapIdFromProviderType(type);
+    quint64 setID = 0;
+    _insertTileSet(db.get(), QStringLiteral("Field"), setID);
+
+    QVERIFY(db->saveTile(UrlFactory::getTileHash(type, 1, 0, 2), QStringLiteral("png"), QByteArray("z2"), type, setID));
+    QVERIFY(db->saveTile(UrlFactory::getTileHash(type, 5, 2, 3), QStringLiteral("png"), QByteArray("z3"), type, setID));
+
+    TileSetRecord set;
+    set.setID = setID;
+    set.name = QStringLiteral("Field");
+    set.topleftLat = 47.5;
+    set.topleftLon = 8.5;
+    set.bottomRightLat = 47.4;
+    set.bottomRightLon = 8.6;
+    set.type = mapId;
+
+    const QString exportPath = tempPath("export.mbtiles");
+    int lastProgress = 0;
+    const DatabaseResult result = db->exportMBTiles({set}, exportPath, [&lastProgress](int p) { lastProgress = p; });
+    QVERIFY2(result.success, qPrintable(result.errorString));
+    QCOMPARE(lastProgress, 100);
+
+    // The active database is usable again once the MBTiles file is detached
+    QVERIFY(db->saveTile(QStringLiteral("after_export"), QStringLiteral("png"), QByteArray("a"), type, QGCTileCacheDatabase::kInvalidTileSet));
+
+    {
+        QSqlDatabase mbtiles = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("mbtiles_export_test"));
+        mbtiles.setDatabaseName(exportPath);
+        QVERIFY(mbtiles.open());
+
+        QSqlQuery query(mbtiles);
+        // TMS rows count from the south: row = 2^zoom - 1 - y
+        QVERIFY(query.exec("SELECT tile_data FROM tiles WHERE zoom_level = 2 AND tile_column = 1 AND tile_row = 3"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toByteArray(), QByteArray("z2"));
+        QVERIFY(query.exec("SELECT tile_data FROM tiles WHERE zoom_level = 3 AND tile_column = 5 AND tile_row = 5"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toByteArray(), QByteArray("z3"));
+        QVERIFY(query.exec("SELECT COUNT(*) FROM tiles"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 2);
+
+        QHash<QString, QString> metadata;
+        QVERIFY(query.exec("SELECT name, value FROM metadata"));
+        while (query.next()) {
+            metadata.insert(query.value(0).toString(), query.value(1).toString());
+        }
+        QCOMPARE(metadata.value(QStringLiteral("format")), QStringLiteral("png"));
+        QCOMPARE(metadata.value(QStringLiteral("minzoom")), QStringLiteral("2"));
+        QCOMPARE(metadata.value(QStringLiteral("maxzoom")), QStringLiteral("3"));
+        QCOMPARE(metadata.value(QStringLiteral("name")), QStringLiteral("Field"));
+        QVERIFY(metadata.value(QStringLiteral("bounds")).startsWith(QStringLiteral("8.5")));
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("mbtiles_export_test"));
+}
+
+void QGCTileCacheDatabaseTest::_testExportMBTilesRejectsMixedTypes()
+{
+    auto db = _createInitializedDB();
+
+    TileSetRecord road;
+    road.setID = 2;
+    road.type = UrlFactory::getQtMapIdFromProviderType(QStringLiteral("Bing Road"));
+    TileSetRecord satellite = road;
+    satellite.setID = 3;
+    satellite.type = UrlFactory::getQtMapIdFromProviderType(QStringLiteral("Bing Satellite"));
+    QVERIFY(road.type != satellite.type);
+
+    QVERIFY(!db->exportMBTiles({road, satellite}, tempPath("mixed.mbtiles"), nullptr).success);
+
+    TileSetRecord defaultSet;
+    defaultSet.defaultSet = true;
+    QVERIFY(!db->exportMBTiles({defaultSet}, tempPath("default.mbtiles"), nullptr).success);
+    QVERIFY(!db->exportMBTiles({}, tempPath("empty.mbtiles"), nullptr).success);
+}
+
 void QGCTileCacheDatabaseTest::_linkTileToSet(QGCTileCacheDatabase* db, quint64 tileID, quint64 setID)
 {
     QSqlQuery query(db->database());
@@ -1292,4 +1376,106 @@ void QGCTileCacheDatabaseTest::_testForeignKeyCascadeDelete()
     }
 }
 
+void QGCTileCacheDatabaseTest::_testSaveTilesBatch()
+{
+    auto db = _createInitializedDB();
+
+    quint64 setID = 0;
+    _insertTileSet(db.get(), QStringLiteral("BatchSet"), setID);
+    QVERIFY(db->saveTile(QStringLiteral("batch_0"), QStringLiteral("png"), QByteArray(10, 'A'), QStringLiteral("T"), QGCTileCacheDatabase::kInvalidTileSet));
+
+    QList<QGCCacheTile*> tiles;
+    for (int i = 0; i < 3; i++) {
+        const QString hash = QStringLiteral("batch_%1").arg(i);
+        _insertDownloadRecord(db.get(), setID, hash, QGCTile::StateDownloading);
+        tiles.append(new QGCCacheTile(hash, QByteArray(10 + i, 'B'), QStringLiteral("png"), QStringLiteral("T"), setID));
+    }
+    _insertDownloadRecord(db.get(), setID, QStringLiteral("batch_other"), QGCTile::StatePending);
+
+    QVERIFY(db->saveTiles(tiles, true));
+    qDeleteAll(tiles);
+
+    // Existing tiles are kept as they are and linked to the set as well
+    auto tile = db->getTile(QStringLiteral("batch_0"));
+    QVERIFY(tile != nullptr);
+    QCOMPARE(tile->img, QByteArray(10, 'A'));
+    tile = db->getTile(QStringLiteral("batch_2"));
+    QVERIFY(tile != nullptr);
+    QCOMPARE(tile->img, QByteArray(12, 'B'));
+
+    {
+        QSqlQuery query(db->database());
+        QVERIFY(query.prepare(QStringLiteral("SELECT COUNT(*) FROM SetTiles WHERE setID = ?")));
+        query.addBindValue(setID);
+        QVERIFY(query.exec());
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 3);
+    }
+
+    {
+        QSqlQuery query(db->database());
+        QVERIFY(query.prepare(QStringLiteral("SELECT hash FROM TilesDownload WHERE setID = ?")));
+        query.addBindValue(setID);
+        QVERIFY(query.exec());
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toString(), QStringLiteral("batch_other"));
+        QVERIFY(!query.next());
+    }
+
+    QVERIFY(db->saveTiles({}, true));
+}
+
+void QGCTileCacheDatabaseTest::_testSaveTilesBatchRollsBack()
+{
+    auto db = _createInitializedDB();
+
+    // The second tile refers to a tile set which does not exist
+    QList<QGCCacheTile*> tiles;
+    tiles.append(new QGCCacheTile(QStringLiteral("rollback_0"), QByteArray(10, 'A'), QStringLiteral("png"), QStringLiteral("T")));
+    tiles.append(new QGCCacheTile(QStringLiteral("rollback_1"), QByteArray(10, 'A'), QStringLiteral("png"), QStringLiteral("T"), 999999));
+
+    QVERIFY(!db->saveTiles(tiles, false));
+    qDeleteAll(tiles);
+
+    QVERIFY(!db->findTile(QStringLiteral("rollback_0")).has_value());
+    QVERIFY(!db->findTile(QStringLiteral("rollback_1")).has_value());
+}
+
+void QGCTileCacheDatabaseTest::_benchmarkSaveTilesBatch()
+{
+    auto db = _createInitializedDB();
+    QVERIFY(db);
+
+    constexpr int kTileCount = 64;
+    const QByteArray image(4096, 'A');
+    int run = 0;
+
+    auto makeTiles = [&]() {
+        QList<QGCCacheTile*> tiles;
+        for (int i = 0; i < kTileCount; i++) {
+            tiles.append(new QGCCacheTile(QStringLiteral("bench_%1_%2").arg(run).arg(i), image, QStringLiteral("png"), QStringLiteral("T")));
+        }
+        run++;
+        return tiles;
+    };
+
+    auto bench = qgc::bench::ciConfig();
+    bench.relative(true).batch(kTileCount).unit("tile");
+
+    // Previous path: a transaction per tile
+    bench.run("saveTile() per tile", [&] {
+        const QList<QGCCacheTile*> tiles = makeTiles();
+        for (const QGCCacheTile *tile : tiles) {
+            (void) db->saveTile(tile->hash, tile->format, tile->img, tile->type, tile->tileSet);
+        }
+        qDeleteAll(tiles);
+    });
+
+    bench.run("saveTiles() batch", [&] {
+        const QList<QGCCacheTile*> tiles = makeTiles();
+        (void) db->saveTiles(tiles, false);
+        qDeleteAll(tiles);
+    });
+}
+
 UT_REGISTER_TEST(QGCTileCacheDatabaseTest, TestLabel::Unit)
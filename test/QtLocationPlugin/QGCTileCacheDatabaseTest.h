@@ -28,6 +28,8 @@ private slots:
     void _testPruneCache();
     void _testUpdateTileDownloadState();
     void _testExportImportReplace();
+    void _testExportMBTiles();
+    void _testExportMBTilesRejectsMixedTypes();
     void _testGetTileDownloadList();
     void _testImportSetsMerge();
     void _testComputeSetTotalsNonDefault();
@@ -54,6 +56,9 @@ private slots:
     void _testTilesDownloadTableColumns();
     void _testIndexesExist();
     void _testForeignKeyCascadeDelete();
+    void _testSaveTilesBatch();
+    void _testSaveTilesBatchRollsBack();
+    void _benchmarkSaveTilesBatch();
 
 private:
     std::unique_ptr<QGCTileCacheDatabase> _createInitializedDB();
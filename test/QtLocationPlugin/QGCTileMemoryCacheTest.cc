@@ -0,0 +1,175 @@
+#include "QGCTileMemoryCacheTest.h"
+
+#include <QtTest/QTest>
+
+#include "QGCCacheTile.h"
+#include "QGCMapUrlEngine.h"
+#include "QGCTileMemoryCache.h"
+
+namespace {
+
+constexpr qsizetype kImageBytes = 872;      ///< 1000 bytes with the entry overhead
+
+QGCCacheTile makeTile(const QString &hash, char fill)
+{
+    return QGCCacheTile(hash, QByteArray(kImageBytes, fill), QStringLiteral("png"), QStringLiteral("Bing Road"));
+}
+
+/// Keys whose x is a multiple of the shard count and y, zoom and map id are equal share a shard
+quint64 sameShardKey(int index)
+{
+    return QGCTileMemoryCache::key(1, index * QGCTileMemoryCache::kShardCount, 0, 20);
+}
+
+} // namespace
+
+void QGCTileMemoryCacheTest::_testKey()
+{
+    const quint64 key = QGCTileMemoryCache::key(3, 8388607, 8388607, 23);
+    QCOMPARE(key, QGCTileMemoryCache::key(3, 8388607, 8388607, 23));
+    QVERIFY(key != QGCTileMemoryCache::kInvalidKey);
+    QVERIFY(key != QGCTileMemoryCache::key(4, 8388607, 8388607, 23));
+    QVERIFY(key != QGCTileMemoryCache::key(3, 8388606, 8388607, 23));
+    QVERIFY(key != QGCTileMemoryCache::key(3, 8388607, 8388606, 23));
+    QVERIFY(key != QGCTileMemoryCache::key(3, 8388607, 8388607, 22));
+    QVERIFY(QGCTileMemoryCache::key(0, 1, 0, 1) != QGCTileMemoryCache::key(0, 0, 1, 1));
+}
+
+void QGCTileMemoryCacheTest::_testKeyFromHash()
+{
+    const QString type = QStringLiteral("Bing Road");
+    const int mapId = UrlFactory::hashFromProviderType(type);
+    QVERIFY(mapId > 0);
+
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(UrlFactory::getTileHash(type, 100, 200, 10)),
+             QGCTileMemoryCache::key(mapId, 100, 200, 10));
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(UrlFactory::getTileHash(type, 0, 0, 0)),
+             QGCTileMemoryCache::key(mapId, 0, 0, 0));
+
+    // Tile outside the zoom level, zoom beyond the key layout, not a tile hash
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(UrlFactory::getTileHash(type, 16, 0, 4)), QGCTileMemoryCache::kInvalidKey);
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(UrlFactory::getTileHash(type, 0, 0, 24)), QGCTileMemoryCache::kInvalidKey);
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(QStringLiteral("hash")), QGCTileMemoryCache::kInvalidKey);
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(QStringLiteral("000000000a0000000100000001002")), QGCTileMemoryCache::kInvalidKey);
+    QCOMPARE(QGCTileMemoryCache::keyFromHash(QString::asprintf("%010d%08d%08d%03d", -1, 0, 0, 1)), QGCTileMemoryCache::kInvalidKey);
+}
+
+void QGCTileMemoryCacheTest::_testFindCountsHitsAndMisses()
+{
+    QGCTileMemoryCache cache;
+    const quint64 key = QGCTileMemoryCache::key(1, 10, 20, 5);
+    const QString hash = QStringLiteral("hash");
+
+    QVERIFY(!cache.find(key, hash));
+    cache.insert(key, makeTile(hash, 'a'), cache.generation());
+
+    const std::unique_ptr<QGCCacheTile> tile = cache.find(key, hash);
+    QVERIFY(tile);
+    QCOMPARE(tile->hash, hash);
+    QCOMPARE(tile->img, QByteArray(kImageBytes, 'a'));
+    QCOMPARE(tile->format, QStringLiteral("png"));
+    QCOMPARE(tile->type, QStringLiteral("Bing Road"));
+
+    QGCTileMemoryCache::Statistics_t stats = cache.statistics();
+    QCOMPARE(stats.hits, 1ULL);
+    QCOMPARE(stats.misses, 1ULL);
+    QCOMPARE(stats.evictions, 0ULL);
+    QCOMPARE(static_cast<int>(stats.count), 1);
+    QCOMPARE(stats.bytes, qint64{1000});
+    QCOMPARE(stats.hitRate(), 0.5);
+
+    cache.resetStatistics();
+    stats = cache.statistics();
+    QCOMPARE(stats.hits, 0ULL);
+    QCOMPARE(stats.misses, 0ULL);
+    QCOMPARE(stats.hitRate(), 0.);
+    QCOMPARE(static_cast<int>(stats.count), 1);
+}
+
+void QGCTileMemoryCacheTest::_testEvictsLeastRecentlyUsed()
+{
+    // Three tiles per shard
+    QGCTileMemoryCache cache(QGCTileMemoryCache::kShardCount * 3000);
+    const QString hash = QStringLiteral("hash");
+
+    for (int i = 0; i < 3; i++) {
+        cache.insert(sameShardKey(i), makeTile(hash, 'a'), cache.generation());
+    }
+
+    // Using the first tile makes the second the least recently used
+    QVERIFY(cache.find(sameShardKey(0), hash));
+    cache.insert(sameShardKey(3), makeTile(hash, 'b'), cache.generation());
+
+    QVERIFY(cache.find(sameShardKey(0), hash));
+    QVERIFY(!cache.find(sameShardKey(1), hash));
+    QVERIFY(cache.find(sameShardKey(2), hash));
+    QVERIFY(cache.find(sameShardKey(3), hash));
+    QCOMPARE(cache.statistics().evictions, 1ULL);
+
+    // Shrinking the budget evicts down to it
+    cache.setMaxBytes(QGCTileMemoryCache::kShardCount * 1000);
+    QCOMPARE(static_cast<int>(cache.statistics().count), 1);
+    QVERIFY(cache.find(sameShardKey(3), hash));
+}
+
+void QGCTileMemoryCacheTest::_testStaysWithinBudget()
+{
+    constexpr qint64 kMaxBytes = 64 * 1000;
+    QGCTileMemoryCache cache(kMaxBytes);
+    const QString hash = QStringLiteral("hash");
+
+    for (int x = 0; x < 32; x++) {
+        for (int y = 0; y < 32; y++) {
+            cache.insert(QGCTileMemoryCache::key(1, x, y, 10), makeTile(hash, 'a'), cache.generation());
+        }
+    }
+
+    const QGCTileMemoryCache::Statistics_t stats = cache.statistics();
+    QVERIFY(stats.bytes <= kMaxBytes);
+    QVERIFY(stats.count > 0);
+    QCOMPARE(stats.evictions + static_cast<quint64>(stats.count), 1024ULL);
+    QVERIFY(cache.find(QGCTileMemoryCache::key(1, 31, 31, 10), hash));
+
+    // Larger than a shard
+    cache.insert(QGCTileMemoryCache::key(1, 0, 0, 11),
+                 QGCCacheTile(hash, QByteArray(kMaxBytes, 'a'), QStringLiteral("png"), QStringLiteral("Bing Road")), cache.generation());
+    QVERIFY(!cache.find(QGCTileMemoryCache::key(1, 0, 0, 11), hash));
+}
+
+void QGCTileMemoryCacheTest::_testClearRefusesStaleInsert()
+{
+    QGCTileMemoryCache cache;
+    const quint64 key = QGCTileMemoryCache::key(1, 1, 1, 1);
+    const QString hash = QStringLiteral("hash");
+
+    cache.insert(key, makeTile(hash, 'a'), cache.generation());
+    QVERIFY(cache.find(key, hash));
+
+    // Read from the database before tiles were removed, inserted after
+    const quint64 generation = cache.generation();
+    cache.clear();
+    QVERIFY(!cache.find(key, hash));
+    QCOMPARE(cache.statistics().bytes, qint64{0});
+
+    cache.insert(key, makeTile(hash, 'a'), generation);
+    QVERIFY(!cache.find(key, hash));
+
+    cache.insert(key, makeTile(hash, 'a'), cache.generation());
+    QVERIFY(cache.find(key, hash));
+}
+
+void QGCTileMemoryCacheTest::_testDisabled()
+{
+    QGCTileMemoryCache cache(0);
+    const quint64 key = QGCTileMemoryCache::key(1, 1, 1, 1);
+    const QString hash = QStringLiteral("hash");
+
+    cache.insert(key, makeTile(hash, 'a'), cache.generation());
+    QVERIFY(!cache.find(key, hash));
+
+    const QGCTileMemoryCache::Statistics_t stats = cache.statistics();
+    QCOMPARE(static_cast<int>(stats.count), 0);
+    QCOMPARE(stats.misses, 0ULL);
+}
+
+UT_REGISTER_TEST(QGCTileMemoryCacheTest, TestLabel::Unit)
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCTileMemoryCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testKey();
+    void _testKeyFromHash();
+    void _testFindCountsHitsAndMisses();
+    void _testEvictsLeastRecentlyUsed();
+    void _testStaysWithinBudget();
+    void _testClearRefusesStaleInsert();
+    void _testDisabled();
+};
@@ -0,0 +1,167 @@
+#include "QGCTilePrefetcherTest.h"
+
+#include <QtTest/QTest>
+
+#include "QGCMapUrlEngine.h"
+#include "QGCTileMemoryCache.h"
+#include "QGCTilePrefetcher.h"
+
+namespace {
+
+const QString kMapType = QStringLiteral("Bing Road");
+
+int mapId()
+{
+    return UrlFactory::getQtMapIdFromProviderType(kMapType);
+}
+
+} // namespace
+
+void QGCTilePrefetcherTest::_testCorridorSinglePoint()
+{
+    const QGeoCoordinate point(47.3977, 8.5456);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 15, { point }, 1000., 0);
+    QCOMPARE(tiles.size(), 1);
+    QCOMPARE(tiles.first().x, UrlFactory::long2tileX(kMapType, point.longitude(), 15));
+    QCOMPARE(tiles.first().y, UrlFactory::lat2tileY(kMapType, point.latitude(), 15));
+    QCOMPARE(tiles.first().z, 15);
+    QCOMPARE(tiles.first().type, mapId());
+    QCOMPARE(tiles.first().hash, UrlFactory::getTileHash(kMapType, tiles.first().x, tiles.first().y, 15));
+}
+
+void QGCTilePrefetcherTest::_testCorridorRadius()
+{
+    const QGeoCoordinate point(47.3977, 8.5456);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 15, { point }, 1000., 1);
+    QCOMPARE(tiles.size(), 9);
+
+    // The tile under the point comes first, the ring around it after
+    const int x = UrlFactory::long2tileX(kMapType, point.longitude(), 15);
+    const int y = UrlFactory::lat2tileY(kMapType, point.latitude(), 15);
+    QCOMPARE(tiles.first().x, x);
+    QCOMPARE(tiles.first().y, y);
+    for (const QGCTile &tile : tiles) {
+        QVERIFY(qAbs(tile.x - x) <= 1);
+        QVERIFY(qAbs(tile.y - y) <= 1);
+    }
+}
+
+void QGCTilePrefetcherTest::_testCorridorFollowsPath()
+{
+    // Due east along the equator, a tile is about 1.2 km wide at zoom 15
+    const QGeoCoordinate start(0.001, 10.);
+    const QGeoCoordinate end = start.atDistanceAndAzimuth(10000., 90.);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 15, { start, end }, 20000., 0);
+
+    const int startX = UrlFactory::long2tileX(kMapType, start.longitude(), 15);
+    const int endX = UrlFactory::long2tileX(kMapType, end.longitude(), 15);
+    QCOMPARE(tiles.size(), endX - startX + 1);
+    for (qsizetype i = 0; i < tiles.size(); i++) {
+        QCOMPARE(tiles.at(i).x, startX + static_cast<int>(i));
+        QCOMPARE(tiles.at(i).y, tiles.first().y);
+    }
+}
+
+void QGCTilePrefetcherTest::_testCorridorLength()
+{
+    const QGeoCoordinate start(0.001, 10.);
+    const QGeoCoordinate end = start.atDistanceAndAzimuth(10000., 90.);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 15, { start, end }, 5000., 0);
+
+    const QGeoCoordinate stop = start.atDistanceAndAzimuth(5000., 90.);
+    QCOMPARE(tiles.last().x, UrlFactory::long2tileX(kMapType, stop.longitude(), 15));
+    QVERIFY(tiles.last().x < UrlFactory::long2tileX(kMapType, end.longitude(), 15));
+}
+
+void QGCTilePrefetcherTest::_testCorridorMaxTiles()
+{
+    const QGeoCoordinate start(47.3977, 8.5456);
+    const QGeoCoordinate end = start.atDistanceAndAzimuth(50000., 45.);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 17, { start, end }, 50000., 2, 40);
+    QCOMPARE(tiles.size(), 40);
+
+    QSet<quint64> keys;
+    for (const QGCTile &tile : tiles) {
+        (void) keys.insert(QGCTileMemoryCache::key(tile.type, tile.x, tile.y, tile.z));
+    }
+    QCOMPARE(keys.size(), tiles.size());
+}
+
+void QGCTilePrefetcherTest::_testCorridorWrapsAntimeridian()
+{
+    const QGeoCoordinate point(0.5, 179.9);
+    const QList<QGCTile> tiles = QGCTilePrefetcher::corridorTiles(mapId(), 3, { point }, 1000., 1);
+    QCOMPARE(tiles.first().x, 7);
+
+    bool wrapped = false;
+    for (const QGCTile &tile : tiles) {
+        QVERIFY((tile.x >= 0) && (tile.x < 8));
+        wrapped |= (tile.x == 0);
+    }
+    QVERIFY(wrapped);
+}
+
+void QGCTilePrefetcherTest::_testCorridorInvalid()
+{
+    const QGeoCoordinate point(47.3977, 8.5456);
+    QVERIFY(QGCTilePrefetcher::corridorTiles(mapId(), 15, {}, 1000.).isEmpty());
+    QVERIFY(QGCTilePrefetcher::corridorTiles(mapId(), QGCTileMemoryCache::kMaxZoom + 1, { point }, 1000.).isEmpty());
+    QVERIFY(QGCTilePrefetcher::corridorTiles(mapId(), 15, { QGeoCoordinate() }, 1000.).isEmpty());
+    QVERIFY(QGCTilePrefetcher::corridorTiles(-1, 15, { point }, 1000.).isEmpty());
+}
+
+void QGCTilePrefetcherTest::_testStatistics()
+{
+    QGCTilePrefetcher::Statistics_t statistics;
+    QCOMPARE(statistics.hitRatio(), 0.);
+    QCOMPARE(statistics.coverage(), 0.);
+
+    statistics.warmed = 6;
+    statistics.downloaded = 2;
+    statistics.used = 4;
+    statistics.requests = 16;
+    QCOMPARE(statistics.prefetched(), 8ULL);
+    QCOMPARE(statistics.hitRatio(), 0.5);
+    QCOMPARE(statistics.coverage(), 0.25);
+}
+
+void QGCTilePrefetcherTest::_testTileRequestedCounts()
+{
+    QGCTilePrefetcher prefetcher;
+    prefetcher.tileRequested(mapId(), 1, 2, 3, true);
+    prefetcher.tileRequested(mapId(), 1, 3, 3, false);
+
+    const QGCTilePrefetcher::Statistics_t statistics = prefetcher.statistics();
+    QCOMPARE(statistics.requests, 2ULL);
+    QCOMPARE(statistics.requestsFromCache, 1ULL);
+    // Neither tile was prefetched
+    QCOMPARE(statistics.used, 0ULL);
+
+    prefetcher.resetStatistics();
+    QCOMPARE(prefetcher.statistics().requests, 0ULL);
+}
+
+void QGCTilePrefetcherTest::_testCacheNotReady()
+{
+    // The map engine has no tile cache database in this test, so it rejects every task
+    QGCTilePrefetcher prefetcher;
+    const QGeoCoordinate point(47.3977, 8.5456);
+    prefetcher.setCorridor(kMapType, 15, { point }, 1000.);
+
+    const quint64 scheduled = prefetcher.statistics().scheduled;
+    QVERIFY(scheduled > 0);
+    QCOMPARE(prefetcher.statistics().dropped, scheduled);
+    QCOMPARE(prefetcher.statistics().warmed, 0ULL);
+    QCOMPARE(prefetcher._pendingWarms, 0);
+    QVERIFY(prefetcher._inFlight.isEmpty());
+    QVERIFY(prefetcher._warmQueue.isEmpty());
+    QVERIFY(prefetcher._downloadQueue.isEmpty());
+    QCOMPARE(prefetcher._activeDownloads, 0);
+
+    // Nothing was left in flight, so the same corridor is scheduled again
+    prefetcher.setCorridor(kMapType, 15, { point }, 1000.);
+    QCOMPARE(prefetcher.statistics().scheduled, 2 * scheduled);
+    QCOMPARE(prefetcher._pendingWarms, 0);
+}
+
+UT_REGISTER_TEST(QGCTilePrefetcherTest, TestLabel::Unit)
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCTilePrefetcherTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testCorridorSinglePoint();
+    void _testCorridorRadius();
+    void _testCorridorFollowsPath();
+    void _testCorridorLength();
+    void _testCorridorMaxTiles();
+    void _testCorridorWrapsAntimeridian();
+    void _testCorridorInvalid();
+    void _testStatistics();
+    void _testTileRequestedCounts();
+    void _testCacheNotReady();
+};
@@ -0,0 +1,476 @@
+#include "TerrainLocalDEMTest.h"
+#include "AppSettings.h"
+#include "ElevationMapProvider.h"
+#include "Fact.h"
+#include "FlightMapSettings.h"
+#include "SettingsManager.h"
+#include "TerrainDEMFile.h"
+#include "TerrainLocalDEM.h"
+#include "TerrainQueryInterface.h"
+#include "TerrainTileManager.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QtEndian>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QSignalSpy>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int kHGTSamples = 1201;
+
+/// 3 arc-second SRTM tile, sample (row, column) holds (row % 100) * 100 + (column % 100)
+QByteArray hgtData(int16_t voidValue = TerrainDEMFile::kHGTVoid)
+{
+    QByteArray data(kHGTSamples * kHGTSamples * 2, Qt::Uninitialized);
+    uchar *const samples = reinterpret_cast<uchar*>(data.data());
+    for (int row = 0; row < kHGTSamples; row++) {
+        for (int column = 0; column < kHGTSamples; column++) {
+            const int16_t value = static_cast<int16_t>(((row % 100) * 100) + (column % 100));
+            qToBigEndian<qint16>(value, samples + (((row * kHGTSamples) + column) * 2));
+        }
+    }
+    // North west corner is a void
+    qToBigEndian<qint16>(voidValue, samples);
+
+    return data;
+}
+
+/// Minimal classic TIFF writer: blocks follow the header, then out of line tag values, then the directory
+class TiffWriter
+{
+public:
+    explicit TiffWriter(bool bigEndian) : _bigEndian(bigEndian) {}
+
+    void addTag(quint16 tag, quint16 type, const QList<double> &values) { _tags.append({ tag, type, values, QByteArray() }); }
+    void addAscii(quint16 tag, const QByteArray &text) { _tags.append({ tag, 2, {}, text + '\0' }); }
+
+    QByteArray build(const QList<QByteArray> &blocks, quint16 offsetsTag, quint16 byteCountsTag)
+    {
+        QByteArray data(_bigEndian ? "MM" : "II");
+        _appendU16(data, 42);
+        _appendU32(data, 0);        // Directory offset, patched below
+
+        QList<double> offsets;
+        QList<double> byteCounts;
+        for (const QByteArray &block : blocks) {
+            offsets.append(data.size());
+            byteCounts.append(block.size());
+            data.append(block);
+        }
+        addTag(offsetsTag, 4, offsets);
+        addTag(byteCountsTag, 4, byteCounts);
+        std::sort(_tags.begin(), _tags.end(), [](const Tag &a, const Tag &b) { return (a.tag < b.tag); });
+
+        // Out of line values
+        QList<QByteArray> encoded;
+        QList<quint32> valueOffsets;
+        for (const Tag &tag : std::as_const(_tags)) {
+            const QByteArray value = _encode(tag);
+            encoded.append(value);
+            if (value.size() > 4) {
+                if (data.size() % 2) {
+                    data.append('\0');
+                }
+                valueOffsets.append(static_cast<quint32>(data.size()));
+                data.append(value);
+            } else {
+                valueOffsets.append(0);
+            }
+        }
+
+        if (data.size() % 2) {
+            data.append('\0');
+        }
+        const quint32 directoryOffset = static_cast<quint32>(data.size());
+        _appendU16(data, static_cast<quint16>(_tags.size()));
+        for (qsizetype i = 0; i < _tags.size(); i++) {
+            const Tag &tag = _tags.at(i);
+            _appendU16(data, tag.tag);
+            _appendU16(data, tag.type);
+            _appendU32(data, static_cast<quint32>(tag.ascii.isEmpty() ? tag.values.size() : tag.ascii.size()));
+            if (encoded.at(i).size() > 4) {
+                _appendU32(data, valueOffsets.at(i));
+            } else {
+                data.append(encoded.at(i).leftJustified(4, '\0'));
+            }
+        }
+        _appendU32(data, 0);
+
+        uchar *const header = reinterpret_cast<uchar*>(data.data());
+        if (_bigEndian) {
+            qToBigEndian<quint32>(directoryOffset, header + 4);
+        } else {
+            qToLittleEndian<quint32>(directoryOffset, header + 4);
+        }
+
+        return data;
+    }
+
+    QByteArray int16Samples(const QList<int16_t> &values) const
+    {
+        QByteArray data;
+        for (const int16_t value : values) {
+            _appendU16(data, static_cast<quint16>(value));
+        }
+        return data;
+    }
+
+    QByteArray floatSamples(const QList<float> &values) const
+    {
+        QByteArray data;
+        for (const float value : values) {
+            quint32 bits;
+            (void) memcpy(&bits, &value, sizeof(bits));
+            _appendU32(data, bits);
+        }
+        return data;
+    }
+
+private:
+    struct Tag {
+        quint16 tag;
+        quint16 type;
+        QList<double> values;
+        QByteArray ascii;
+    };
+
+    QByteArray _encode(const Tag &tag) const
+    {
+        if (tag.type == 2) {
+            return tag.ascii;
+        }
+
+        QByteArray value;
+        for (const double v : tag.values) {
+            switch (tag.type) {
+            case 3:
+                _appendU16(value, static_cast<quint16>(v));
+                break;
+            case 4:
+                _appendU32(value, static_cast<quint32>(v));
+                break;
+            case 12:
+            {
+                quint64 bits;
+                (void) memcpy(&bits, &v, sizeof(bits));
+                uchar bytes[8];
+                if (_bigEndian) {
+                    qToBigEndian<quint64>(bits, bytes);
+                } else {
+                    qToLittleEndian<quint64>(bits, bytes);
+                }
+                value.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        return value;
+    }
+
+    void _appendU16(QByteArray &data, quint16 value) const
+    {
+        uchar bytes[2];
+        if (_bigEndian) {
+            qToBigEndian<quint16>(value, bytes);
+        } else {
+            qToLittleEndian<quint16>(value, bytes);
+        }
+        data.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    void _appendU32(QByteArray &data, quint32 value) const
+    {
+        uchar bytes[4];
+        if (_bigEndian) {
+            qToBigEndian<quint32>(value, bytes);
+        } else {
+            qToLittleEndian<quint32>(value, bytes);
+        }
+        data.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    const bool _bigEndian;
+    QList<Tag> _tags;
+};
+
+/// Geographic, pixel is area GeoTIFF tags with the north west corner at @a north / @a west
+void addGeoTags(TiffWriter &writer, int width, int height, double north, double west, double spacing)
+{
+    writer.addTag(256, 3, { static_cast<double>(width) });
+    writer.addTag(257, 3, { static_cast<double>(height) });
+    writer.addTag(259, 3, { 1 });
+    writer.addTag(277, 3, { 1 });
+    writer.addTag(33550, 12, { spacing, spacing, 0.0 });
+    writer.addTag(33922, 12, { 0.0, 0.0, 0.0, west, north, 0.0 });
+    // Version 1.1.0, 2 keys: geographic model, pixel is area
+    writer.addTag(34735, 3, { 1, 1, 0, 2, 1024, 0, 1, 2, 1025, 0, 1, 1 });
+}
+
+/// 4 x 3 little endian int16 GeoTIFF in strips of 2 rows, sample (row, column) holds row * 100 + column.
+/// Sample (1, 1) is no data.
+QByteArray stripGeoTIFF(double north, double west, double spacing)
+{
+    constexpr int kWidth = 4;
+    constexpr int kHeight = 3;
+
+    TiffWriter writer(false);
+    addGeoTags(writer, kWidth, kHeight, north, west, spacing);
+    writer.addTag(258, 3, { 16 });
+    writer.addTag(278, 3, { 2 });
+    writer.addTag(339, 3, { 2 });
+    writer.addAscii(42113, "-9999");
+
+    QList<QByteArray> strips;
+    for (int firstRow = 0; firstRow < kHeight; firstRow += 2) {
+        QList<int16_t> values;
+        for (int row = firstRow; row < qMin(firstRow + 2, kHeight); row++) {
+            for (int column = 0; column < kWidth; column++) {
+                values.append(((row == 1) && (column == 1)) ? -9999 : static_cast<int16_t>((row * 100) + column));
+            }
+        }
+        strips.append(writer.int16Samples(values));
+    }
+
+    return writer.build(strips, 273, 279);
+}
+
+/// 5 x 5 big endian float32 GeoTIFF in 4 x 4 tiles, sample (row, column) holds row * 10 + column + 0.5
+QByteArray tiledGeoTIFF(double north, double west, double spacing)
+{
+    constexpr int kSize = 5;
+    constexpr int kTileSize = 4;
+
+    TiffWriter writer(true);
+    addGeoTags(writer, kSize, kSize, north, west, spacing);
+    writer.addTag(258, 3, { 32 });
+    writer.addTag(322, 3, { kTileSize });
+    writer.addTag(323, 3, { kTileSize });
+    writer.addTag(339, 3, { 3 });
+
+    QList<QByteArray> tiles;
+    for (int tileRow = 0; tileRow < kSize; tileRow += kTileSize) {
+        for (int tileColumn = 0; tileColumn < kSize; tileColumn += kTileSize) {
+            QList<float> values;
+            for (int row = tileRow; row < (tileRow + kTileSize); row++) {
+                for (int column = tileColumn; column < (tileColumn + kTileSize); column++) {
+                    values.append(((row < kSize) && (column < kSize)) ? static_cast<float>((row * 10) + column) + 0.5f : 0.0f);
+                }
+            }
+            tiles.append(writer.floatSamples(values));
+        }
+    }
+
+    return writer.build(tiles, 324, 325);
+}
+
+} // namespace
+
+void TerrainLocalDEMTest::_testHGT()
+{
+    QVERIFY(createFile(QStringLiteral("N10E020.hgt"), hgtData()));
+
+    TerrainDEMFile file;
+    QVERIFY2(file.open(tempPath(QStringLiteral("N10E020.hgt"))), qPrintable(file.errorString()));
+    QVERIFY(file.format() == TerrainDEMFile::Format::HGT);
+    QCOMPARE(file.resolution(), 1.0 / 1200);
+
+    // Row 0 is the north edge, samples are on the cell edges
+    const double spacing = 1.0 / 1200;
+    QCOMPARE(file.elevation(11.0 - (345 * spacing), 20.0 + (678 * spacing)), 4578.0);
+    QCOMPARE(file.elevation(10.0, 21.0), 0.0);
+    QCOMPARE(file.elevation(10.0 + (0.4 * spacing), 21.0 - (0.4 * spacing)), 0.0);
+    QVERIFY(qIsNaN(file.elevation(11.0, 20.0)));
+    QVERIFY(qIsNaN(file.elevation(9.5, 20.5)));
+
+    QVERIFY(createFile(QStringLiteral("S01W001.hgt"), hgtData()));
+    QVERIFY(file.open(tempPath(QStringLiteral("S01W001.hgt"))));
+    QCOMPARE(file.elevation(-1.0 + (1200 * spacing) - (345 * spacing), -1.0 + (678 * spacing)), 4578.0);
+}
+
+void TerrainLocalDEMTest::_testGeoTIFFStrips()
+{
+    QVERIFY(createFile(QStringLiteral("strips.tif"), stripGeoTIFF(41.0, 30.0, 0.25)));
+
+    TerrainDEMFile file;
+    QVERIFY2(file.open(tempPath(QStringLiteral("strips.tif"))), qPrintable(file.errorString()));
+    QVERIFY(file.format() == TerrainDEMFile::Format::GeoTIFF);
+    QCOMPARE(file.north(), 41.0);
+    QCOMPARE(file.west(), 30.0);
+    QCOMPARE(file.south(), 40.25);
+    QCOMPARE(file.east(), 31.0);
+
+    // Pixel centers are half a pixel in from the corner
+    QCOMPARE(file.elevation(40.875, 30.125), 0.0);
+    QCOMPARE(file.elevation(40.375, 30.875), 203.0);
+    QCOMPARE(file.elevation(40.3, 30.9), 203.0);
+    QCOMPARE(file.elevation(40.625, 30.375 + 0.25), 102.0);
+    QVERIFY(qIsNaN(file.elevation(40.625, 30.375)));
+    QVERIFY(qIsNaN(file.elevation(41.1, 30.5)));
+}
+
+void TerrainLocalDEMTest::_testGeoTIFFTiles()
+{
+    QVERIFY(createFile(QStringLiteral("tiles.tiff"), tiledGeoTIFF(-20.0, -50.0, 0.1)));
+
+    TerrainDEMFile file;
+    QVERIFY2(file.open(tempPath(QStringLiteral("tiles.tiff"))), qPrintable(file.errorString()));
+    QCOMPARE(file.elevation(-20.05, -49.95), 0.5);
+    QCOMPARE(file.elevation(-20.35, -49.65), 33.5);
+    QCOMPARE(file.elevation(-20.45, -49.95), 40.5);
+    QCOMPARE(file.elevation(-20.45, -49.55), 44.5);
+    QVERIFY(qIsNaN(file.elevation(-20.55, -49.55)));
+}
+
+void TerrainLocalDEMTest::_testRejectsUnsupportedFiles()
+{
+    TerrainDEMFile file;
+
+    QVERIFY(createFile(QStringLiteral("tile.hgt"), hgtData()));
+    QVERIFY(!file.open(tempPath(QStringLiteral("tile.hgt"))));
+    QVERIFY(!file.isValid());
+
+    QVERIFY(createFile(QStringLiteral("N10E020.hgt"), QByteArray(1000, '\0')));
+    QVERIFY(!file.open(tempPath(QStringLiteral("N10E020.hgt"))));
+
+    TiffWriter writer(false);
+    addGeoTags(writer, 2, 2, 41.0, 30.0, 0.25);
+    writer.addTag(258, 3, { 16 });
+    writer.addTag(339, 3, { 2 });
+    QByteArray compressed = writer.build({ writer.int16Samples({ 1, 2, 3, 4 }) }, 273, 279);
+    // The inline Compression value follows its 8 byte tag header
+    const qsizetype compressionTag = compressed.indexOf(QByteArray::fromHex("0301030001000000"));
+    QVERIFY(compressionTag > 0);
+    compressed[compressionTag + 8] = 5;
+    QVERIFY(createFile(QStringLiteral("compressed.tif"), compressed));
+    QVERIFY(!file.open(tempPath(QStringLiteral("compressed.tif"))));
+
+    // Sizes beyond int or the file size are rejected instead of overflowing
+    const auto oversized = [](double width, double height, double tileSize) {
+        TiffWriter tiffWriter(false);
+        tiffWriter.addTag(256, 4, { width });
+        tiffWriter.addTag(257, 4, { height });
+        tiffWriter.addTag(258, 3, { 16 });
+        tiffWriter.addTag(259, 3, { 1 });
+        tiffWriter.addTag(277, 3, { 1 });
+        tiffWriter.addTag(322, 4, { tileSize });
+        tiffWriter.addTag(323, 4, { tileSize });
+        tiffWriter.addTag(339, 3, { 2 });
+        tiffWriter.addTag(33550, 12, { 0.25, 0.25, 0.0 });
+        tiffWriter.addTag(33922, 12, { 0.0, 0.0, 0.0, 30.0, 41.0, 0.0 });
+        return tiffWriter.build({ tiffWriter.int16Samples({ 1, 2, 3, 4 }) }, 324, 325);
+    };
+    QVERIFY(createFile(QStringLiteral("wide.tif"), oversized(4294967295.0, 1, 2)));
+    QVERIFY(!file.open(tempPath(QStringLiteral("wide.tif"))));
+    QVERIFY(createFile(QStringLiteral("large.tif"), oversized(65536, 65536, 2)));
+    QVERIFY(!file.open(tempPath(QStringLiteral("large.tif"))));
+    QVERIFY(createFile(QStringLiteral("bigtile.tif"), oversized(2, 2, 2147483647.0)));
+    QVERIFY(!file.open(tempPath(QStringLiteral("bigtile.tif"))));
+    QVERIFY(createFile(QStringLiteral("tile.tif"), oversized(2, 2, 2)));
+    QVERIFY(file.open(tempPath(QStringLiteral("tile.tif"))));
+
+    QVERIFY(createFile(QStringLiteral("notes.txt"), QByteArrayLiteral("N10E020")));
+    QVERIFY(!file.open(tempPath(QStringLiteral("notes.txt"))));
+}
+
+void TerrainLocalDEMTest::_testDirectoryIndex()
+{
+    const QString directory = createSubDir(QStringLiteral("dem"));
+    QVERIFY(createFile(QStringLiteral("dem/N10E020.hgt"), hgtData()));
+    // Finer data over the middle of the same cell
+    QVERIFY(createFile(QStringLiteral("dem/fine.tif"), stripGeoTIFF(10.5, 20.5, 0.0001)));
+    QVERIFY(createFile(QStringLiteral("dem/readme.txt"), QByteArrayLiteral("not a DEM")));
+
+    TerrainLocalDEM dem;
+    QCOMPARE(dem.load(directory), 2);
+    QCOMPARE(dem.directory(), directory);
+
+    // Inside the GeoTIFF
+    QCOMPARE(dem.elevation(10.49995, 20.50015), 1.0);
+    QCOMPARE(dem.elevation(QGeoCoordinate(10.49975, 20.50035)), 203.0);
+    // GeoTIFF no data falls back to the HGT
+    QCOMPARE(dem.elevation(10.49985, 20.50015), 0.0);
+    // Outside the GeoTIFF
+    const double spacing = 1.0 / 1200;
+    QCOMPARE(dem.elevation(11.0 - (345 * spacing), 20.0 + (678 * spacing)), 4578.0);
+    // No file at all
+    QVERIFY(qIsNaN(dem.elevation(12.5, 20.5)));
+    QVERIFY(qIsNaN(dem.elevation(10.5, 22.5)));
+
+    dem.clear();
+    QCOMPARE(static_cast<int>(dem.fileCount()), 0);
+    QVERIFY(qIsNaN(dem.elevation(10.5, 20.5)));
+}
+
+void TerrainLocalDEMTest::_testGlobeEdges()
+{
+    // The poles and the antimeridian fall in the outermost cells, never one past them
+    QCOMPARE(TerrainLocalDEM::cellKey(90.0, 0.5), TerrainLocalDEM::cellKey(89.5, 0.5));
+    QCOMPARE(TerrainLocalDEM::cellKey(-90.0, 0.5), TerrainLocalDEM::cellKey(-89.5, 0.5));
+    QCOMPARE(TerrainLocalDEM::cellKey(0.5, 180.0), TerrainLocalDEM::cellKey(0.5, 179.5));
+    QCOMPARE(TerrainLocalDEM::cellKey(0.5, -180.0), TerrainLocalDEM::cellKey(0.5, -179.5));
+    QVERIFY(TerrainLocalDEM::cellKey(0.5, 180.0) != TerrainLocalDEM::cellKey(1.5, -180.0));
+    QCOMPARE(TerrainLocalDEM::cellKey(-90.0, -180.0), 0);
+    QCOMPARE(TerrainLocalDEM::cellKey(90.0, 180.0), (180 * 360) - 1);
+
+    const QString directory = createSubDir(QStringLiteral("edges"));
+    QVERIFY(createFile(QStringLiteral("edges/N89E179.hgt"), hgtData()));
+    QVERIFY(createFile(QStringLiteral("edges/S90W180.hgt"), hgtData()));
+
+    TerrainLocalDEM dem;
+    QCOMPARE(dem.load(directory), 2);
+
+    const double spacing = 1.0 / 1200;
+    QCOMPARE(dem.elevation(90.0, 180.0 - (345 * spacing)), 55.0);
+    QCOMPARE(dem.elevation(89.0 + (345 * spacing), 180.0), 5500.0);
+    QCOMPARE(dem.elevation(-90.0, -180.0 + (678 * spacing)), 78.0);
+    QCOMPARE(dem.elevation(-89.0 - (345 * spacing), -180.0), 4500.0);
+}
+
+void TerrainLocalDEMTest::_testTerrainTileManager()
+{
+    AppSettings *const appSettings = SettingsManager::instance()->appSettings();
+    Fact *const providerFact = SettingsManager::instance()->flightMapSettings()->elevationMapProvider();
+    const QVariant savedSavePath = appSettings->savePath()->rawValue();
+    const QVariant savedProvider = providerFact->rawValue();
+
+    appSettings->savePath()->setRawValue(tempDirPath());
+    providerFact->setRawValue(QString(LocalDEMElevationProvider::kProviderKey));
+    const QString terrainDirectory = appSettings->terrainSavePath();
+    QVERIFY(QDir().mkpath(terrainDirectory));
+    QVERIFY(createFile(QString(AppSettings::terrainDirectory) + QStringLiteral("/N10E020.hgt"), hgtData()));
+
+    {
+        TerrainTileManager manager;
+        const double spacing = 1.0 / 1200;
+        const QList<QGeoCoordinate> coordinates = { QGeoCoordinate(11.0 - (345 * spacing), 20.0 + (678 * spacing)), QGeoCoordinate(10.0, 21.0) };
+
+        QList<double> altitudes;
+        bool error = true;
+        QVERIFY(manager.getAltitudesForCoordinates(coordinates, altitudes, error));
+        QVERIFY(!error);
+        QCOMPARE(altitudes, QList<double>({ 4578.0, 0.0 }));
+        QCOMPARE(static_cast<int>(manager.localDEM().fileCount()), 1);
+
+        // Answered without waiting for any download
+        TerrainQueryInterface query;
+        QSignalSpy spy(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+        manager.addCoordinateQuery(&query, coordinates);
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(spy.first().at(0).toBool());
+
+        // Outside the local data the query fails
+        manager.addCoordinateQuery(&query, { QGeoCoordinate(45.5, 7.5) });
+        QCOMPARE(spy.count(), 2);
+        QVERIFY(!spy.at(1).at(0).toBool());
+    }
+
+    providerFact->setRawValue(savedProvider);
+    appSettings->savePath()->setRawValue(savedSavePath);
+}
+
+UT_REGISTER_TEST(TerrainLocalDEMTest, TestLabel::Unit, TestLabel::Terrain)
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "TempDirectoryTest.h"
+
+class TerrainLocalDEMTest : public TempDirectoryTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testHGT();
+    void _testGeoTIFFStrips();
+    void _testGeoTIFFTiles();
+    void _testRejectsUnsupportedFiles();
+    void _testDirectoryIndex();
+    void _testGlobeEdges();
+    void _testTerrainTileManager();
+};
@@ -0,0 +1,146 @@
+#include "TerrainTileCacheTest.h"
+#include "TerrainTile.h"
+#include "TerrainTileCache.h"
+
+#include <QtPositioning/QGeoCoordinate>
+
+namespace {
+
+/// Flat 10 x 10 tile of @a elevation
+std::shared_ptr<const TerrainTile> makeTile(int16_t elevation)
+{
+    struct Header_t {
+        double  swLat, swLon, neLat, neLon;
+        int16_t minElevation, maxElevation;
+        double  avgElevation;
+        int16_t gridSizeLat, gridSizeLon;
+    } Q_PACKED;
+
+    constexpr int16_t kGridSize = 10;
+    const Header_t header = { 0.0, 0.0, 0.01, 0.01, elevation, elevation, static_cast<double>(elevation), kGridSize, kGridSize };
+    QByteArray data(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int i = 0; i < (kGridSize * kGridSize); i++) {
+        (void) data.append(reinterpret_cast<const char*>(&elevation), sizeof(elevation));
+    }
+
+    return std::make_shared<const TerrainTile>(data);
+}
+
+} // namespace
+
+void TerrainTileCacheTest::_testKey()
+{
+    const quint64 key = TerrainTileCache::key(3, 35999, 17999, 1);
+    QCOMPARE(key, TerrainTileCache::key(3, 35999, 17999, 1));
+    QVERIFY(key != TerrainTileCache::key(4, 35999, 17999, 1));
+    QVERIFY(key != TerrainTileCache::key(3, 17999, 35999, 1));
+    QVERIFY(key != TerrainTileCache::key(3, 35999, 17999, 2));
+    QVERIFY(TerrainTileCache::key(0, 1, 0, 0) != TerrainTileCache::key(0, 0, 1, 0));
+}
+
+void TerrainTileCacheTest::_testFindCountsHitsAndMisses()
+{
+    TerrainTileCache cache;
+    const quint64 key = TerrainTileCache::key(0, 10, 20, 1);
+
+    QVERIFY(!cache.find(key));
+    cache.insert(key, makeTile(42));
+    QVERIFY(cache.contains(key));
+
+    const std::shared_ptr<const TerrainTile> tile = cache.find(key);
+    QVERIFY(tile);
+    QCOMPARE(tile->elevation(QGeoCoordinate(0.005, 0.005)), 42.0);
+
+    QCOMPARE(cache.hits(), 1ULL);
+    QCOMPARE(cache.misses(), 1ULL);
+    QCOMPARE(cache.evictions(), 0ULL);
+    QCOMPARE(static_cast<int>(cache.count()), 1);
+    QCOMPARE(cache.bytes(), tile->memoryUsage());
+
+    cache.resetStatistics();
+    QCOMPARE(cache.hits(), 0ULL);
+    QCOMPARE(cache.misses(), 0ULL);
+}
+
+void TerrainTileCacheTest::_testEvictsLeastRecentlyUsed()
+{
+    const qint64 tileBytes = makeTile(0)->memoryUsage();
+    TerrainTileCache cache(3 * tileBytes);
+
+    const quint64 key0 = TerrainTileCache::key(0, 0, 0, 1);
+    const quint64 key1 = TerrainTileCache::key(0, 1, 0, 1);
+    const quint64 key2 = TerrainTileCache::key(0, 2, 0, 1);
+    const quint64 key3 = TerrainTileCache::key(0, 3, 0, 1);
+    cache.insert(key0, makeTile(0));
+    cache.insert(key1, makeTile(1));
+    cache.insert(key2, makeTile(2));
+
+    // Using key0 makes key1 the least recently used
+    QVERIFY(cache.find(key0));
+    cache.insert(key3, makeTile(3));
+
+    QCOMPARE(static_cast<int>(cache.count()), 3);
+    QVERIFY(cache.contains(key0));
+    QVERIFY(!cache.contains(key1));
+    QVERIFY(cache.contains(key2));
+    QVERIFY(cache.contains(key3));
+    QCOMPARE(cache.evictions(), 1ULL);
+    QVERIFY(cache.bytes() <= cache.maxBytes());
+
+    // Replacing a tile does not change the count
+    cache.insert(key2, makeTile(20));
+    QCOMPARE(static_cast<int>(cache.count()), 3);
+    QCOMPARE(cache.bytes(), 3 * tileBytes);
+}
+
+void TerrainTileCacheTest::_testOversizedTileIsKept()
+{
+    TerrainTileCache cache(1);
+    const quint64 key0 = TerrainTileCache::key(0, 0, 0, 1);
+    const quint64 key1 = TerrainTileCache::key(0, 1, 0, 1);
+
+    cache.insert(key0, makeTile(0));
+    QVERIFY(cache.contains(key0));
+
+    cache.insert(key1, makeTile(1));
+    QVERIFY(!cache.contains(key0));
+    QVERIFY(cache.contains(key1));
+    QCOMPARE(static_cast<int>(cache.count()), 1);
+}
+
+void TerrainTileCacheTest::_testShrinkingBudgetEvicts()
+{
+    const qint64 tileBytes = makeTile(0)->memoryUsage();
+    TerrainTileCache cache(10 * tileBytes);
+    for (int x = 0; x < 10; x++) {
+        cache.insert(TerrainTileCache::key(0, x, 0, 1), makeTile(static_cast<int16_t>(x)));
+    }
+    QCOMPARE(static_cast<int>(cache.count()), 10);
+
+    cache.setMaxBytes(4 * tileBytes);
+    QCOMPARE(static_cast<int>(cache.count()), 4);
+    QCOMPARE(cache.evictions(), 6ULL);
+    for (int x = 6; x < 10; x++) {
+        QVERIFY(cache.contains(TerrainTileCache::key(0, x, 0, 1)));
+    }
+
+    cache.clear();
+    QCOMPARE(static_cast<int>(cache.count()), 0);
+    QCOMPARE(cache.bytes(), qint64{0});
+}
+
+void TerrainTileCacheTest::_testEvictedTileStaysValidWhileInUse()
+{
+    TerrainTileCache cache(1);
+    const quint64 key0 = TerrainTileCache::key(0, 0, 0, 1);
+    cache.insert(key0, makeTile(7));
+
+    const std::shared_ptr<const TerrainTile> tile = cache.find(key0);
+    cache.insert(TerrainTileCache::key(0, 1, 0, 1), makeTile(8));
+    QVERIFY(!cache.contains(key0));
+
+    QVERIFY(tile->isValid());
+    QCOMPARE(tile->elevation(QGeoCoordinate(0.005, 0.005)), 7.0);
+}
+
+UT_REGISTER_TEST(TerrainTileCacheTest, TestLabel::Unit, TestLabel::Terrain)
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "BaseClasses/TerrainTest.h"
+
+class TerrainTileCacheTest : public TerrainTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testKey();
+    void _testFindCountsHitsAndMisses();
+    void _testEvictsLeastRecentlyUsed();
+    void _testOversizedTileIsKept();
+    void _testShrinkingBudgetEvicts();
+    void _testEvictedTileStaysValidWhileInUse();
+};
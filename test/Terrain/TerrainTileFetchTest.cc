@@ -0,0 +1,348 @@
+#include "TerrainTileFetchTest.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QTimer>
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QSignalSpy>
+
+#include <cmath>
+#include <utility>
+
+#include "TerrainQueryInterface.h"
+#include "TerrainTileCopernicus.h"
+#include "TerrainTileFetcher.h"
+#include "TerrainTileManager.h"
+
+namespace {
+
+constexpr int16_t kGridSize = 10;
+
+/// Tile x/y of the Copernicus provider, zoom is always 1
+int tileX(double longitude) { return static_cast<int>(floor((longitude + 180.0) / TerrainTileCopernicus::kTileSizeDegrees)); }
+int tileY(double latitude) { return static_cast<int>(floor((latitude + 90.0) / TerrainTileCopernicus::kTileSizeDegrees)); }
+
+/// Elevation the stand-in server reports for every point of a tile
+int16_t tileElevation(int x, int y) { return static_cast<int16_t>(((x * 7) + y) % 1000); }
+
+/// Center of the tile at @a column/@a row tiles away from a fixed origin
+QGeoCoordinate tileCenter(int column, int row)
+{
+    return QGeoCoordinate(10.005 + (row * TerrainTileCopernicus::kTileSizeDegrees), 20.005 + (column * TerrainTileCopernicus::kTileSizeDegrees));
+}
+
+/// Serialized TerrainTile of constant elevation covering Copernicus tile x/y
+QByteArray tileData(int x, int y)
+{
+    const double swLat = (y * TerrainTileCopernicus::kTileSizeDegrees) - 90.0;
+    const double swLon = (x * TerrainTileCopernicus::kTileSizeDegrees) - 180.0;
+    const double neLat = swLat + TerrainTileCopernicus::kTileSizeDegrees;
+    const double neLon = swLon + TerrainTileCopernicus::kTileSizeDegrees;
+    const int16_t elevation = tileElevation(x, y);
+    const double avgElevation = elevation;
+
+    QByteArray data;
+    const auto append = [&data](const auto &value) {
+        (void) data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    append(swLat);
+    append(swLon);
+    append(neLat);
+    append(neLon);
+    append(elevation);
+    append(elevation);
+    append(avgElevation);
+    append(kGridSize);
+    append(kGridSize);
+    for (int i = 0; i < (kGridSize * kGridSize); i++) {
+        append(elevation);
+    }
+
+    return data;
+}
+
+/// Local HTTP stand-in for the terrain server: GET /<x>/<y> returns the tile after a delay
+class TerrainTileServer
+{
+public:
+    TerrainTileServer()
+    {
+        (void) QObject::connect(&_server, &QTcpServer::newConnection, &_server, [this]() {
+            while (_server.hasPendingConnections()) {
+                QTcpSocket *const socket = _server.nextPendingConnection();
+                (void) QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() { _request(socket); });
+                (void) QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            }
+        });
+    }
+
+    bool listen() { return _server.listen(QHostAddress::LocalHost, 0); }
+    QString errorString() const { return _server.errorString(); }
+    QString baseUrl() const { return QStringLiteral("http://127.0.0.1:%1").arg(_server.serverPort()); }
+
+    int defaultDelayMs = 50;
+    QHash<QString, int> delayMs;        ///< Per path delay, overrides defaultDelayMs
+    QSet<QString> failPaths;            ///< Paths answered with 404
+    QHash<QString, int> requestCounts;
+    int activeRequests = 0;
+    int maxActiveRequests = 0;
+
+private:
+    void _request(QTcpSocket *socket)
+    {
+        const QByteArray request = socket->readAll();
+        const QString path = QString::fromLatin1(request.split(' ').value(1));
+        requestCounts[path]++;
+        activeRequests++;
+        maxActiveRequests = qMax(maxActiveRequests, activeRequests);
+
+        QTimer::singleShot(delayMs.value(path, defaultDelayMs), socket, [this, socket, path]() {
+            activeRequests--;
+
+            QByteArray response;
+            if (failPaths.contains(path)) {
+                response = QByteArrayLiteral("HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+            } else {
+                const QStringList parts = path.split('/', Qt::SkipEmptyParts);
+                const QByteArray payload = tileData(parts.value(0).toInt(), parts.value(1).toInt());
+                response = QByteArrayLiteral("HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nConnection: close\r\nContent-Length: ") +
+                           QByteArray::number(payload.size()) + QByteArrayLiteral("\r\n\r\n") + payload;
+            }
+            (void) socket->write(response);
+            (void) socket->flush();
+            socket->disconnectFromHost();
+        });
+    }
+
+    QTcpServer _server;
+};
+
+/// Fetches tiles straight from the stand-in server instead of the map cache and elevation provider
+class HttpTerrainTileFetcher : public TerrainTileFetcher
+{
+public:
+    explicit HttpTerrainTileFetcher(const QString &baseUrl)
+        : _baseUrl(baseUrl)
+        , _networkManager(new QNetworkAccessManager(this))
+    {
+    }
+
+protected:
+    bool _startFetch(const QString &hash, const QGeoTileSpec &spec) final
+    {
+        QNetworkReply *const reply = _networkManager->get(QNetworkRequest(QUrl(QStringLiteral("%1/%2/%3").arg(_baseUrl).arg(spec.x()).arg(spec.y()))));
+        (void) connect(reply, &QNetworkReply::finished, this, [this, reply, hash]() {
+            reply->deleteLater();
+            if (reply->error() != QNetworkReply::NoError) {
+                _fetchFinished(hash, QByteArray(), reply->errorString());
+            } else {
+                _fetchFinished(hash, reply->readAll(), QString());
+            }
+        });
+        return true;
+    }
+
+private:
+    const QString _baseUrl;
+    QNetworkAccessManager *const _networkManager;
+};
+
+QString tilePath(const QGeoCoordinate &coordinate)
+{
+    return QStringLiteral("/%1/%2").arg(tileX(coordinate.longitude())).arg(tileY(coordinate.latitude()));
+}
+
+double expectedElevation(const QGeoCoordinate &coordinate)
+{
+    return tileElevation(tileX(coordinate.longitude()), tileY(coordinate.latitude()));
+}
+
+} // namespace
+
+void TerrainTileFetchTest::_testDeduplicatesAndBoundsConcurrency()
+{
+    TerrainTileServer server;
+    if (!server.listen()) {
+        QSKIP(qPrintable(QStringLiteral("Could not start local test HTTP server: %1").arg(server.errorString())));
+    }
+
+    TerrainTileManager manager;
+    HttpTerrainTileFetcher *const fetcher = new HttpTerrainTileFetcher(server.baseUrl());
+    fetcher->setMaxConcurrentFetches(2);
+    manager.setTileFetcher(fetcher);
+
+    // Two queries over six distinct tiles, two of them shared
+    const QList<QGeoCoordinate> first = { tileCenter(0, 0), tileCenter(1, 0), tileCenter(2, 0), tileCenter(3, 0) };
+    const QList<QGeoCoordinate> second = { tileCenter(2, 0), tileCenter(3, 0), tileCenter(0, 1), tileCenter(1, 1) };
+
+    TerrainQueryInterface firstQuery;
+    TerrainQueryInterface secondQuery;
+    QSignalSpy firstSpy(&firstQuery, &TerrainQueryInterface::coordinateHeightsReceived);
+    QSignalSpy secondSpy(&secondQuery, &TerrainQueryInterface::coordinateHeightsReceived);
+
+    manager.addCoordinateQuery(&firstQuery, first);
+    manager.addCoordinateQuery(&secondQuery, second);
+    QCOMPARE(fetcher->activeFetches(), 2);
+    QCOMPARE(fetcher->queuedFetches(), 4);
+    QCOMPARE(fetcher->duplicateRequests(), 2ULL);
+
+    QTRY_COMPARE_WITH_TIMEOUT(firstSpy.count(), 1, TestTimeout::mediumMs());
+    QTRY_COMPARE_WITH_TIMEOUT(secondSpy.count(), 1, TestTimeout::mediumMs());
+
+    QVERIFY(firstSpy.first().at(0).toBool());
+    const QVariantList firstHeights = firstSpy.first().at(1).toList();
+    QCOMPARE(firstHeights.size(), first.size());
+    for (qsizetype i = 0; i < first.size(); i++) {
+        QCOMPARE(firstHeights.at(i).toDouble(), expectedElevation(first.at(i)));
+    }
+    QVERIFY(secondSpy.first().at(0).toBool());
+    QCOMPARE(secondSpy.first().at(1).toList().size(), second.size());
+
+    // Every tile was downloaded exactly once, never more than two at a time
+    QCOMPARE(server.requestCounts.size(), 6);
+    for (const int count : std::as_const(server.requestCounts)) {
+        QCOMPARE(count, 1);
+    }
+    QCOMPARE(server.maxActiveRequests, 2);
+
+    const TerrainTileManager::Statistics_t &statistics = manager.statistics();
+    QCOMPARE(statistics.tilesFetched, 6ULL);
+    QCOMPARE(statistics.queries, 2ULL);
+    QCOMPARE(statistics.waitedQueries, 2ULL);
+    QVERIFY(statistics.maxWaitMSecs >= statistics.averageWaitMSecs());
+}
+
+void TerrainTileFetchTest::_testQueryAnsweredWhenOwnTilesArrive()
+{
+    TerrainTileServer server;
+    if (!server.listen()) {
+        QSKIP(qPrintable(QStringLiteral("Could not start local test HTTP server: %1").arg(server.errorString())));
+    }
+
+    const QGeoCoordinate fastCoordinate = tileCenter(0, 0);
+    const QGeoCoordinate slowCoordinate = tileCenter(5, 5);
+    server.delayMs[tilePath(slowCoordinate)] = TestTimeout::shortMs();
+
+    TerrainTileManager manager;
+    manager.setTileFetcher(new HttpTerrainTileFetcher(server.baseUrl()));
+
+    // The slow query is queued first, the fast one must not wait behind it
+    TerrainQueryInterface slowQuery;
+    TerrainQueryInterface fastQuery;
+    QSignalSpy slowSpy(&slowQuery, &TerrainQueryInterface::pathHeightsReceived);
+    QSignalSpy fastSpy(&fastQuery, &TerrainQueryInterface::coordinateHeightsReceived);
+
+    manager.addPathQuery(&slowQuery, slowCoordinate, QGeoCoordinate(slowCoordinate.latitude(), slowCoordinate.longitude() + 0.001));
+    manager.addCoordinateQuery(&fastQuery, { fastCoordinate });
+
+    QTRY_COMPARE_WITH_TIMEOUT(fastSpy.count(), 1, TestTimeout::mediumMs());
+    QCOMPARE(slowSpy.count(), 0);
+    QCOMPARE(fastSpy.first().at(1).toList().value(0).toDouble(), expectedElevation(fastCoordinate));
+
+    QTRY_COMPARE_WITH_TIMEOUT(slowSpy.count(), 1, TestTimeout::mediumMs());
+    QVERIFY(slowSpy.first().at(0).toBool());
+    QCOMPARE(slowSpy.first().at(3).toList().value(0).toDouble(), expectedElevation(slowCoordinate));
+}
+
+void TerrainTileFetchTest::_testFailedTileFailsWaitingQueriesOnly()
+{
+    TerrainTileServer server;
+    if (!server.listen()) {
+        QSKIP(qPrintable(QStringLiteral("Could not start local test HTTP server: %1").arg(server.errorString())));
+    }
+
+    const QGeoCoordinate goodCoordinate = tileCenter(0, 0);
+    const QGeoCoordinate badCoordinate = tileCenter(1, 0);
+    (void) server.failPaths.insert(tilePath(badCoordinate));
+
+    TerrainTileManager manager;
+    manager.setTileFetcher(new HttpTerrainTileFetcher(server.baseUrl()));
+
+    TerrainQueryInterface badQuery;
+    TerrainQueryInterface goodQuery;
+    QSignalSpy badSpy(&badQuery, &TerrainQueryInterface::carpetHeightsReceived);
+    QSignalSpy goodSpy(&goodQuery, &TerrainQueryInterface::coordinateHeightsReceived);
+
+    manager.addCarpetQuery(&badQuery, goodCoordinate, QGeoCoordinate(badCoordinate.latitude() + 0.001, badCoordinate.longitude()), true);
+    manager.addCoordinateQuery(&goodQuery, { goodCoordinate });
+
+    QTRY_COMPARE_WITH_TIMEOUT(badSpy.count(), 1, TestTimeout::mediumMs());
+    QTRY_COMPARE_WITH_TIMEOUT(goodSpy.count(), 1, TestTimeout::mediumMs());
+    QVERIFY(!badSpy.first().at(0).toBool());
+    QVERIFY(goodSpy.first().at(0).toBool());
+
+    QCOMPARE(manager.statistics().tilesFailed, 1ULL);
+    QCOMPARE(manager.statistics().failedQueries, 1ULL);
+}
+
+void TerrainTileFetchTest::_testCachedQueryAnsweredImmediately()
+{
+    TerrainTileServer server;
+    if (!server.listen()) {
+        QSKIP(qPrintable(QStringLiteral("Could not start local test HTTP server: %1").arg(server.errorString())));
+    }
+
+    TerrainTileManager manager;
+    manager.setTileFetcher(new HttpTerrainTileFetcher(server.baseUrl()));
+
+    const QList<QGeoCoordinate> coordinates = { tileCenter(0, 0), tileCenter(1, 0) };
+
+    TerrainQueryInterface query;
+    QSignalSpy spy(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+    manager.addCoordinateQuery(&query, coordinates);
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, TestTimeout::mediumMs());
+
+    manager.addCoordinateQuery(&query, coordinates);
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(spy.at(1).at(0).toBool());
+    QCOMPARE(manager.statistics().cachedQueries, 1ULL);
+    QCOMPARE(server.requestCounts.size(), 2);
+
+    bool error = true;
+    QList<double> altitudes;
+    QVERIFY(manager.getAltitudesForCoordinates(coordinates, altitudes, error));
+    QVERIFY(!error);
+    QCOMPARE(altitudes.value(1), expectedElevation(coordinates.at(1)));
+}
+
+void TerrainTileFetchTest::_testQueryLargerThanCacheAnswered()
+{
+    TerrainTileServer server;
+    if (!server.listen()) {
+        QSKIP(qPrintable(QStringLiteral("Could not start local test HTTP server: %1").arg(server.errorString())));
+    }
+
+    TerrainTileManager manager;
+    manager.setTileFetcher(new HttpTerrainTileFetcher(server.baseUrl()));
+    // Each tile evicts the previous one, the waiting query must keep the tiles it already has
+    manager.tileCache()->setMaxBytes(1);
+
+    const QList<QGeoCoordinate> coordinates = { tileCenter(0, 0), tileCenter(1, 0), tileCenter(2, 0) };
+    server.delayMs[tilePath(coordinates.at(1))] = 2 * server.defaultDelayMs;
+    server.delayMs[tilePath(coordinates.at(2))] = 3 * server.defaultDelayMs;
+
+    TerrainQueryInterface query;
+    QSignalSpy spy(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+    manager.addCoordinateQuery(&query, coordinates);
+
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, TestTimeout::mediumMs());
+    QVERIFY(spy.first().at(0).toBool());
+    const QVariantList heights = spy.first().at(1).toList();
+    QCOMPARE(heights.size(), coordinates.size());
+    for (qsizetype i = 0; i < coordinates.size(); i++) {
+        QCOMPARE(heights.at(i).toDouble(), expectedElevation(coordinates.at(i)));
+    }
+
+    // Answered from the pinned tiles, nothing was downloaded twice
+    QCOMPARE(server.requestCounts.size(), 3);
+    for (const int count : std::as_const(server.requestCounts)) {
+        QCOMPARE(count, 1);
+    }
+    QCOMPARE(manager.tileCache()->count(), 1);
+}
+
+UT_REGISTER_TEST(TerrainTileFetchTest, TestLabel::Unit)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileFetchTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testDeduplicatesAndBoundsConcurrency();
+    void _testQueryAnsweredWhenOwnTilesArrive();
+    void _testFailedTileFailsWaitingQueriesOnly();
+    void _testCachedQueryAnsweredImmediately();
+    void _testQueryLargerThanCacheAnswered();
+};
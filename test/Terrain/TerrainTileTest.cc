@@ -1,5 +1,9 @@
 #include "TerrainTileTest.h"
 
+#include "Benchmarking.h"
+
+#include <limits>
+
 QByteArray TerrainTileTest::_createValidTileData(double swLat, double swLon, double neLat, double neLon,
                                                  int16_t minElev, int16_t maxElev, double avgElev, int16_t gridSizeLat,
                                                  int16_t gridSizeLon, int16_t fillElevation)
@@ -166,4 +170,133 @@ void TerrainTileTest::_testInvalidTileElevation()
     QVERIFY(qIsNaN(tile.avgElevation()));
 }
 
+void TerrainTileTest::_testRowMajorGrid()
+{
+    // 2 rows of 3 columns, each cell holds (row * 10) + column
+    constexpr int16_t gridSizeLat = 2;
+    constexpr int16_t gridSizeLon = 3;
+    QByteArray tileData = _createValidTileData(0.0, 0.0, 0.02, 0.03, 0, 12, 6.0, gridSizeLat, gridSizeLon, 0);
+    int16_t *const elevData = reinterpret_cast<int16_t*>(tileData.data() + sizeof(TerrainTile::TileInfo_t));
+    for (int row = 0; row < gridSizeLat; ++row) {
+        for (int column = 0; column < gridSizeLon; ++column) {
+            elevData[(row * gridSizeLon) + column] = static_cast<int16_t>((row * 10) + column);
+        }
+    }
+
+    const TerrainTile tile(tileData);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.elevation(QGeoCoordinate(0.005, 0.005)), 0.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(0.005, 0.025)), 2.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(0.015, 0.005)), 10.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(0.015, 0.015)), 11.0);
+    QVERIFY(tile.memoryUsage() >= static_cast<qint64>(gridSizeLat * gridSizeLon * sizeof(int16_t)));
+}
+
+void TerrainTileTest::_testBilinearSampling()
+{
+    // Same 2 by 3 grid as _testRowMajorGrid, cell centers at 0.005 and 0.015 latitude, 0.005 to 0.025 longitude
+    constexpr int16_t gridSizeLat = 2;
+    constexpr int16_t gridSizeLon = 3;
+    QByteArray tileData = _createValidTileData(0.0, 0.0, 0.02, 0.03, 0, 12, 6.0, gridSizeLat, gridSizeLon, 0);
+    int16_t *const elevData = reinterpret_cast<int16_t*>(tileData.data() + sizeof(TerrainTile::TileInfo_t));
+    for (int row = 0; row < gridSizeLat; ++row) {
+        for (int column = 0; column < gridSizeLon; ++column) {
+            elevData[(row * gridSizeLon) + column] = static_cast<int16_t>((row * 10) + column);
+        }
+    }
+
+    const TerrainTile tile(tileData);
+    QVERIFY(tile.isValid());
+
+    // Cell centers, between centers, clamped at the edges and one point well outside the tile
+    const QList<double> latitudes = { 0.005, 0.015, 0.01, 0.005, 0.0, 0.02, 0.05 };
+    const QList<double> longitudes = { 0.005, 0.025, 0.01, 0.02, 0.0, 0.03, 0.01 };
+    QList<double> elevations(latitudes.size());
+    double minElevation = std::numeric_limits<double>::max();
+    double maxElevation = std::numeric_limits<double>::lowest();
+
+    const qsizetype outside = tile.sampleBilinear(latitudes.constData(), longitudes.constData(), latitudes.size(),
+                                                  elevations.data(), minElevation, maxElevation);
+    QCOMPARE(static_cast<int>(outside), 1);
+    QCOMPARE(elevations[0], 0.0);
+    QCOMPARE(elevations[1], 12.0);
+    QCOMPARE(elevations[2], 5.5);
+    QCOMPARE(elevations[3], 1.5);
+    QCOMPARE(elevations[4], 0.0);
+    QCOMPARE(elevations[5], 12.0);
+    QVERIFY(qIsNaN(elevations[6]));
+    QCOMPARE(minElevation, 0.0);
+    QCOMPARE(maxElevation, 12.0);
+
+    // Agrees with the nearest cell lookup at the cell centers
+    QCOMPARE(elevations[0], tile.elevation(QGeoCoordinate(latitudes[0], longitudes[0])));
+    QCOMPARE(elevations[1], tile.elevation(QGeoCoordinate(latitudes[1], longitudes[1])));
+
+    // An invalid tile samples nothing
+    const TerrainTile invalidTile{QByteArray()};
+    QCOMPARE(invalidTile.sampleBilinear(latitudes.constData(), longitudes.constData(), latitudes.size(),
+                                        elevations.data(), minElevation, maxElevation), latitudes.size());
+    QVERIFY(qIsNaN(elevations[0]));
+}
+
+void TerrainTileTest::_benchmarkBatchSampling()
+{
+    // One Copernicus sized tile of 1 arc-second cells sampled by a 100 by 100 carpet
+    constexpr int16_t gridSizeLat = 36;
+    constexpr int16_t gridSizeLon = 36;
+    constexpr int kCarpetSize = 100;
+    QByteArray tileData = _createValidTileData(47.0, 8.0, 47.01, 8.01, 0, 1000, 500.0, gridSizeLat, gridSizeLon, 0);
+    int16_t *const elevData = reinterpret_cast<int16_t*>(tileData.data() + sizeof(TerrainTile::TileInfo_t));
+    for (int i = 0; i < (gridSizeLat * gridSizeLon); ++i) {
+        elevData[i] = static_cast<int16_t>((i * 37) % 1000);
+    }
+    const TerrainTile tile(tileData);
+    QVERIFY(tile.isValid());
+
+    QList<double> latitudes;
+    QList<double> longitudes;
+    for (int row = 0; row < kCarpetSize; ++row) {
+        for (int column = 0; column < kCarpetSize; ++column) {
+            (void) latitudes.append(47.0 + ((row + 0.5) * (0.01 / kCarpetSize)));
+            (void) longitudes.append(8.0 + ((column + 0.5) * (0.01 / kCarpetSize)));
+        }
+    }
+    QList<double> elevations(latitudes.size());
+
+    auto bench = qgc::bench::ciConfig();
+    bench.relative(true).batch(latitudes.size()).unit("point");
+
+    // Previous path: a QGeoCoordinate per point, nearest cell lookup each, min/max in a second pass
+    bench.run("per coordinate elevation()", [&] {
+        QList<QGeoCoordinate> coordinates;
+        coordinates.reserve(latitudes.size());
+        for (qsizetype i = 0; i < latitudes.size(); ++i) {
+            (void) coordinates.append(QGeoCoordinate(latitudes[i], longitudes[i]));
+        }
+        QList<double> altitudes;
+        altitudes.reserve(coordinates.size());
+        for (const QGeoCoordinate &coordinate : coordinates) {
+            altitudes.push_back(tile.elevation(coordinate));
+        }
+        double minElevation = std::numeric_limits<double>::max();
+        double maxElevation = std::numeric_limits<double>::lowest();
+        for (const double altitude : altitudes) {
+            minElevation = qMin(minElevation, altitude);
+            maxElevation = qMax(maxElevation, altitude);
+        }
+        ankerl::nanobench::doNotOptimizeAway(minElevation);
+        ankerl::nanobench::doNotOptimizeAway(maxElevation);
+    });
+
+    bench.run("batched sampleBilinear()", [&] {
+        double minElevation = std::numeric_limits<double>::max();
+        double maxElevation = std::numeric_limits<double>::lowest();
+        const qsizetype outside = tile.sampleBilinear(latitudes.constData(), longitudes.constData(), latitudes.size(),
+                                                      elevations.data(), minElevation, maxElevation);
+        ankerl::nanobench::doNotOptimizeAway(outside);
+        ankerl::nanobench::doNotOptimizeAway(minElevation);
+        ankerl::nanobench::doNotOptimizeAway(maxElevation);
+    });
+}
+
 UT_REGISTER_TEST(TerrainTileTest, TestLabel::Unit, TestLabel::Terrain)
@@ -20,6 +20,11 @@ private slots:
     void _testDataTooSmallForElevation();
     void _testElevationOutsideBounds();
     void _testInvalidTileElevation();
+    void _testRowMajorGrid();
+    void _testBilinearSampling();
+
+    // Benchmarks (nanobench)
+    void _benchmarkBatchSampling();
 
 private:
     static QByteArray _createValidTileData(double swLat, double swLon, double neLat, double neLon, int16_t minElev,
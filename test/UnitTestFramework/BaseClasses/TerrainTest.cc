@@ -73,8 +73,14 @@ UnitTestTerrainQuery::PathHeightInfo_t UnitTestTerrainQuery::_requestPathHeights
                                                                                  const QGeoCoordinate& toCoord)
 {
     PathHeightInfo_t pathHeights;
-    pathHeights.rgCoords = TerrainTileManager::_pathQueryToCoords(fromCoord, toCoord, pathHeights.distanceBetween,
-                                                                  pathHeights.finalDistanceBetween);
+    QList<double> latitudes;
+    QList<double> longitudes;
+    TerrainTileManager::_pathQueryToPoints(fromCoord, toCoord, latitudes, longitudes, pathHeights.distanceBetween,
+                                           pathHeights.finalDistanceBetween);
+    pathHeights.rgCoords.reserve(latitudes.size());
+    for (qsizetype i = 0; i < latitudes.size(); ++i) {
+        (void)pathHeights.rgCoords.append(QGeoCoordinate(latitudes[i], longitudes[i]));
+    }
     pathHeights.rgHeights = _requestCoordinateHeights(pathHeights.rgCoords);
     return pathHeights;
 }
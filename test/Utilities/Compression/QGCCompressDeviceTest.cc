@@ -0,0 +1,164 @@
+#include "QGCCompressDeviceTest.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+
+#include "QGCCompressDevice.h"
+#include "QGCDecompressDevice.h"
+
+namespace {
+
+/// Compressible but not trivially repetitive test data
+QByteArray makeTestData(int size)
+{
+    QByteArray data;
+    data.reserve(size);
+    quint32 state = 12345;
+    while (data.size() < size) {
+        state = (state * 1103515245u) + 12345u;
+        data.append(QByteArrayLiteral("HEARTBEAT seq="));
+        data.append(QByteArray::number((state >> 16) & 0xff));
+        data.append('\n');
+    }
+    data.truncate(size);
+    return data;
+}
+
+QByteArray decompress(const QByteArray &compressed)
+{
+    QBuffer buffer;
+    buffer.setData(compressed);
+    if (!buffer.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QGCDecompressDevice device(&buffer);
+    if (!device.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    return device.readAll();
+}
+
+} // namespace
+
+void QGCCompressDeviceTest::_testRoundTrip_data()
+{
+    QTest::addColumn<int>("formatValue");
+    QTest::addColumn<QString>("filterName");
+
+    QTest::newRow("zstd") << static_cast<int>(QGCCompression::Format::ZSTD) << QStringLiteral("zstd");
+    QTest::newRow("xz") << static_cast<int>(QGCCompression::Format::XZ) << QStringLiteral("xz");
+}
+
+void QGCCompressDeviceTest::_testRoundTrip()
+{
+    QFETCH(int, formatValue);
+    QFETCH(QString, filterName);
+    const auto format = static_cast<QGCCompression::Format>(formatValue);
+
+    const QByteArray data = makeTestData(256 * 1024);
+    const QString filePath = tempPath(QStringLiteral("roundtrip.bin") + QGCCompression::formatExtension(format));
+
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QGCCompressDevice device(&file, format);
+    QVERIFY(device.open(QIODevice::WriteOnly));
+    QVERIFY(device.isSequential());
+    for (qsizetype offset = 0; offset < data.size(); offset += 1000) {
+        const QByteArray chunk = data.mid(offset, 1000);
+        QCOMPARE(device.write(chunk), chunk.size());
+    }
+    device.close();
+    file.close();
+
+    QVERIFY(file.size() > 0);
+    QVERIFY(file.size() < (data.size() / 2));
+
+    QGCDecompressDevice reader(filePath);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), data);
+    QCOMPARE(reader.filterName(), filterName);
+}
+
+void QGCCompressDeviceTest::_testFramesConcatenate_data()
+{
+    QTest::addColumn<int>("formatValue");
+
+    QTest::newRow("zstd") << static_cast<int>(QGCCompression::Format::ZSTD);
+    QTest::newRow("xz") << static_cast<int>(QGCCompression::Format::XZ);
+}
+
+void QGCCompressDeviceTest::_testFramesConcatenate()
+{
+    QFETCH(int, formatValue);
+    const auto format = static_cast<QGCCompression::Format>(formatValue);
+
+    const QByteArray data = makeTestData(64 * 1024);
+
+    // The same encoder is reset for each frame
+    QBuffer sink;
+    QVERIFY(sink.open(QIODevice::WriteOnly));
+    QGCCompressDevice device(&sink, format);
+    QVERIFY(device.open(QIODevice::WriteOnly));
+
+    qsizetype sizeAfterPreviousFrame = 0;
+    for (qsizetype offset = 0; offset < data.size(); offset += 8192) {
+        QCOMPARE(device.write(data.mid(offset, 8192)), qMin<qsizetype>(8192, data.size() - offset));
+        QVERIFY(device.flushFrame());
+        // Every frame is pushed to the sink as soon as it is flushed
+        QVERIFY(sink.data().size() > sizeAfterPreviousFrame);
+        sizeAfterPreviousFrame = sink.data().size();
+    }
+
+    // Flushing without new data does not add an empty frame
+    QVERIFY(device.flushFrame());
+    QCOMPARE(sink.data().size(), sizeAfterPreviousFrame);
+
+    device.close();
+    QCOMPARE(decompress(sink.data()), data);
+}
+
+void QGCCompressDeviceTest::_testUnfinishedFrameRecoverable()
+{
+    const QByteArray flushed = makeTestData(32 * 1024);
+
+    QBuffer sink;
+    QVERIFY(sink.open(QIODevice::WriteOnly));
+    QGCCompressDevice device(&sink, QGCCompression::Format::ZSTD);
+    QVERIFY(device.open(QIODevice::WriteOnly));
+    QCOMPARE(device.write(flushed), flushed.size());
+    QVERIFY(device.flushFrame());
+
+    // Simulate a writer which dies in the middle of the next frame
+    const QByteArray finishedFrames = sink.data();
+    QCOMPARE(device.write(makeTestData(32 * 1024)), 32 * 1024);
+    device.close();
+    const QByteArray truncated = sink.data().left(finishedFrames.size() + ((sink.data().size() - finishedFrames.size()) / 2));
+
+    const QByteArray recovered = decompress(truncated);
+    QVERIFY(recovered.size() >= flushed.size());
+    QCOMPARE(recovered.left(flushed.size()), flushed);
+}
+
+void QGCCompressDeviceTest::_testErrors()
+{
+    QBuffer sink;
+    QVERIFY(sink.open(QIODevice::WriteOnly));
+
+    QGCCompressDevice unsupported(&sink, QGCCompression::Format::GZIP);
+    QVERIFY(!QGCCompressDevice::isSupportedFormat(QGCCompression::Format::GZIP));
+    QVERIFY(!unsupported.open(QIODevice::WriteOnly));
+    QVERIFY(!unsupported.errorString().isEmpty());
+
+    QGCCompressDevice readMode(&sink, QGCCompression::Format::ZSTD);
+    QVERIFY(!readMode.open(QIODevice::ReadOnly));
+
+    QBuffer closedSink;
+    QGCCompressDevice notWritable(&closedSink, QGCCompression::Format::ZSTD);
+    QVERIFY(!notWritable.open(QIODevice::WriteOnly));
+}
+
+#include "UnitTest.h"
+
+UT_REGISTER_TEST(QGCCompressDeviceTest, TestLabel::Unit, TestLabel::Utilities)
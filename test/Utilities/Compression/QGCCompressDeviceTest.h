@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BaseClasses/TempDirectoryTest.h"
+
+/// Tests for QGCCompressDevice
+/// Streaming compression via QIODevice interface, read back with QGCDecompressDevice
+class QGCCompressDeviceTest : public TempDirectoryTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testRoundTrip_data();
+    void _testRoundTrip();
+    void _testFramesConcatenate_data();
+    void _testFramesConcatenate();
+    void _testUnfinishedFrameRecoverable();
+    void _testErrors();
+};
@@ -325,6 +325,19 @@ void GeoTest::_interpolatePath_test()
     QVERIFY(compareDoubles(altPoints[0].altitude(), 100.0, 0.01));
     QVERIFY(compareDoubles(altPoints[5].altitude(), 150.0, 0.01));
     QVERIFY(compareDoubles(altPoints[10].altitude(), 200.0, 0.01));
+    // Packed arrays hold the same points
+    QList<double> latitudes;
+    QList<double> longitudes;
+    QGCGeo::interpolatePath(m_origin, end, 11, latitudes, longitudes);
+    QCOMPARE(latitudes.size(), 11);
+    QCOMPARE(longitudes.size(), 11);
+    for (int i = 0; i < elevenPoints.size(); ++i) {
+        QCOMPARE(latitudes[i], elevenPoints[i].latitude());
+        QCOMPARE(longitudes[i], elevenPoints[i].longitude());
+    }
+    QGCGeo::interpolatePath(m_origin, m_origin, 3, latitudes, longitudes);
+    QCOMPARE(latitudes, QList<double>(3, m_origin.latitude()));
+    QCOMPARE(longitudes, QList<double>(3, m_origin.longitude()));
 }
 
 void GeoTest::_interpolateAtDistance_test()
@@ -0,0 +1,83 @@
+#include "FTPIntervalSetTest.h"
+
+#include "FTPIntervalSet.h"
+
+void FTPIntervalSetTest::_addMerge_test()
+{
+    FTPIntervalSet set;
+    QVERIFY(set.isEmpty());
+
+    set.add(10, 20);
+    set.add(30, 40);
+    QCOMPARE(set.count(), 2);
+    QCOMPARE(set.size(), 20ULL);
+
+    // Empty ranges are ignored
+    set.add(50, 50);
+    QCOMPARE(set.count(), 2);
+
+    // Touching ranges merge
+    set.add(20, 25);
+    QCOMPARE(set.count(), 2);
+    QVERIFY(set.intervals().first() == FTPIntervalSet::Interval_t(10, 25));
+
+    // A range spanning both merges them into one
+    set.add(5, 35);
+    QCOMPARE(set.count(), 1);
+    QVERIFY(set.intervals().first() == FTPIntervalSet::Interval_t(5, 40));
+    QCOMPARE(set.size(), 35ULL);
+
+    set.clear();
+    QVERIFY(set.isEmpty());
+    QCOMPARE(set.size(), 0ULL);
+}
+
+void FTPIntervalSetTest::_removeSplit_test()
+{
+    FTPIntervalSet set;
+    set.add(0, 100);
+
+    // Removing from the middle splits the interval
+    QCOMPARE(set.remove(40, 60), 20U);
+    QCOMPARE(set.count(), 2);
+    QVERIFY(set.intervals().at(0) == FTPIntervalSet::Interval_t(0, 40));
+    QVERIFY(set.intervals().at(1) == FTPIntervalSet::Interval_t(60, 100));
+
+    // Removing what is not in the set removes nothing
+    QCOMPARE(set.remove(40, 60), 0U);
+
+    // Removing across the gap trims both sides and only counts bytes which were in the set
+    QCOMPARE(set.remove(30, 70), 20U);
+    QVERIFY(set.intervals().at(0) == FTPIntervalSet::Interval_t(0, 30));
+    QVERIFY(set.intervals().at(1) == FTPIntervalSet::Interval_t(70, 100));
+
+    // Removing from the start of an interval
+    QCOMPARE(set.remove(0, 10), 10U);
+    QVERIFY(set.intervals().at(0) == FTPIntervalSet::Interval_t(10, 30));
+
+    // Removing everything
+    QCOMPARE(set.remove(0, 0xFFFFFFFF), 50U);
+    QVERIFY(set.isEmpty());
+}
+
+void FTPIntervalSetTest::_containsIntersects_test()
+{
+    FTPIntervalSet set;
+    set.add(10, 20);
+    set.add(30, 40);
+
+    QVERIFY(set.contains(10, 20));
+    QVERIFY(set.contains(12, 18));
+    QVERIFY(!set.contains(15, 35));
+    QVERIFY(!set.contains(0, 5));
+
+    QVERIFY(set.intersects(15, 35));
+    QVERIFY(set.intersects(0, 11));
+    QVERIFY(set.intersects(39, 50));
+    QVERIFY(!set.intersects(20, 30));
+    QVERIFY(!set.intersects(0, 10));
+    QVERIFY(!set.intersects(40, 50));
+    QVERIFY(!set.intersects(15, 15));
+}
+
+UT_REGISTER_TEST(FTPIntervalSetTest, TestLabel::Unit, TestLabel::Vehicle)
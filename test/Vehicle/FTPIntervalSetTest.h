@@ -0,0 +1,13 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class FTPIntervalSetTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _addMerge_test();
+    void _removeSplit_test();
+    void _containsIntersects_test();
+};
@@ -111,6 +111,40 @@ void FTPManagerTest::_testLostPackets()
     _disconnectMockLink();
 }
 
+void FTPManagerTest::_testBusyAndStatistics()
+{
+    _connectMockLinkNoInitialConnectSequence();
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    const int fileSize = 3 * 1024;
+    QString filename = QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(fileSize);
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+    QVERIFY(ftpManager->download(MAV_COMP_ID_AUTOPILOT1, filename,
+                                 QStandardPaths::writableLocation(QStandardPaths::TempLocation)));
+
+    // A component runs one operation at a time, other components are not affected
+    QVERIFY(ftpManager->busy(MAV_COMP_ID_AUTOPILOT1));
+    QVERIFY(!ftpManager->busy(MAV_COMP_ID_CAMERA));
+    QVERIFY(!ftpManager->download(MAV_COMP_ID_AUTOPILOT1, filename,
+                                  QStandardPaths::writableLocation(QStandardPaths::TempLocation)));
+    QCOMPARE(FTPManager::componentIdForURI(MAV_COMP_ID_AUTOPILOT1, QStringLiteral("mftp://[;comp=100]/file")), static_cast<uint8_t>(MAV_COMP_ID_CAMERA));
+
+    QVERIFY_SIGNAL_WAIT(spyDownloadComplete, TestTimeout::longMs());
+    QCOMPARE(spyDownloadComplete.count(), 1);
+    // void downloadComplete   (const QString& file, const QString& errorMsg, uint8_t compId);
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+    QCOMPARE(arguments[2].value<uint8_t>(), static_cast<uint8_t>(MAV_COMP_ID_AUTOPILOT1));
+    QVERIFY(!ftpManager->busy(MAV_COMP_ID_AUTOPILOT1));
+
+    // Every byte of the file is counted once
+    const FTPManager::Statistics_t statistics = ftpManager->statistics(MAV_COMP_ID_AUTOPILOT1);
+    QCOMPARE(statistics.bytesTransferred, static_cast<qint64>(fileSize));
+    QVERIFY(statistics.readRequestsLost <= statistics.readRequests);
+
+    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+    _disconnectMockLink();
+}
+
 void FTPManagerTest::_verifyFileSizeAndDelete(const QString& filename, int expectedSize)
 {
     QFileInfo fileInfo(filename);
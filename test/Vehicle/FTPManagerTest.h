@@ -12,6 +12,7 @@ private slots:
     void _performSizeBasedTestCases_data();
     void _performSizeBasedTestCases();
     void _testLostPackets();
+    void _testBusyAndStatistics();
     void _testListDirectory();
     void _testListDirectoryNoResponse();
     void _testListDirectoryNakResponse();
@@ -1,74 +1,95 @@
 #include "Viewer3DTerrainGeometryTest.h"
 
+#include <QtCore/QTimer>
 #include <QtTest/QSignalSpy>
 
 #include "Viewer3DTerrainGeometry.h"
+#include "Viewer3DTerrainMeshBuilder.h"
+#include "Viewer3DTerrainQuadtree.h"
 
-void Viewer3DTerrainGeometryTest::_testComputeFaceNormal()
+void Viewer3DTerrainGeometryTest::_testUpdateEarthDataZeroCounts()
 {
     Viewer3DTerrainGeometry geo;
 
-    QVector3D x1(0, 0, 0);
-    QVector3D x2(1, 0, 0);
-    QVector3D x3(0, 1, 0);
-
-    QVector3D normal = geo._computeFaceNormal(x1, x2, x3);
-
-    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.z(), 1.0f, 0.0001f);
-}
-
-void Viewer3DTerrainGeometryTest::_testComputeFaceNormalDegenerate()
-{
-    Viewer3DTerrainGeometry geo;
-
-    // Collinear points — degenerate triangle
-    QVector3D x1(0, 0, 0);
-    QVector3D x2(1, 0, 0);
-    QVector3D x3(2, 0, 0);
-
-    QVector3D normal = geo._computeFaceNormal(x1, x2, x3);
-
-    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.z(), 0.0f, 0.0001f);
+    geo.setSectorCount(0);
+    geo.setStackCount(0);
+    geo.setRoiMin(QGeoCoordinate(47.0, 8.0, 0));
+    geo.setRoiMax(QGeoCoordinate(47.1, 8.1, 0));
+    geo.setRefCoordinate(QGeoCoordinate(47.05, 8.05, 0));
+
+    // No texture yet, nothing is queried
+    geo.updateEarthData();
+    QVERIFY(geo._refElevationQuery == nullptr);
+    QVERIFY(geo._heightQueries.isEmpty());
+    QVERIFY(geo._chunkSlots.isEmpty());
+    QVERIFY(geo.vertexData().isEmpty());
 }
 
-void Viewer3DTerrainGeometryTest::_testBuildTerrainZeroCounts()
+void Viewer3DTerrainGeometryTest::_testAllocateSlot()
 {
     Viewer3DTerrainGeometry geo;
+    const qsizetype slotBytes = static_cast<qsizetype>(Viewer3DTerrainMeshBuilder::kVerticesPerChunk) * Viewer3DTerrainMeshBuilder::kStride;
 
-    geo.setSectorCount(0);
-    geo.setStackCount(0);
-
-    QGeoCoordinate roiMin(47.0, 8.0, 0);
-    QGeoCoordinate roiMax(47.1, 8.1, 0);
-    QGeoCoordinate ref(47.05, 8.05, 0);
+    QCOMPARE(geo._allocateSlot(), 0);
+    const int slotCount = geo._slotCount;
+    QVERIFY(slotCount > 1);
+    QCOMPARE(geo.vertexData().size(), slotCount * slotBytes);
+    QCOMPARE(geo.indexData().size(), static_cast<qsizetype>(slotCount) * Viewer3DTerrainMeshBuilder::kIndicesPerChunk * static_cast<qsizetype>(sizeof(quint32)));
 
-    bool result = geo._buildTerrain(roiMin, roiMax, ref, true);
-    QVERIFY(!result);
+    // Lowest free slots first, the buffers only grow once all are taken
+    for (int slot = 1; slot < slotCount; ++slot) {
+        QCOMPARE(geo._allocateSlot(), slot);
+    }
+    QCOMPARE(geo._slotCount, slotCount);
+    QCOMPARE(geo._allocateSlot(), slotCount);
+    QCOMPARE(geo._slotCount, slotCount * 2);
+    QCOMPARE(geo.vertexData().size(), geo._slotCount * slotBytes);
+
+    // Only the written slot changes
+    const QByteArray mesh(slotBytes, '\x01');
+    geo._writeSlot(1, mesh);
+    QCOMPARE(geo.vertexData().mid(slotBytes, slotBytes), mesh);
+    QCOMPARE(geo.vertexData().mid(0, slotBytes), QByteArray(slotBytes, '\0'));
 }
 
-void Viewer3DTerrainGeometryTest::_testBuildTerrainValidRegion()
+void Viewer3DTerrainGeometryTest::_testRetireChunks()
 {
     Viewer3DTerrainGeometry geo;
 
-    geo.setSectorCount(2);
-    geo.setStackCount(2);
-
-    QGeoCoordinate roiMin(47.0, 8.0, 0);
-    QGeoCoordinate roiMax(47.01, 8.01, 0);
-    QGeoCoordinate ref(47.005, 8.005, 0);
-
-    bool result = geo._buildTerrain(roiMin, roiMax, ref, true);
-    QVERIFY(result);
-
-    QVERIFY(!geo._vertices.empty());
-    QVERIFY(!geo._normals.empty());
-    QVERIFY(!geo._texCoords.empty());
-    QCOMPARE(geo._vertices.size(), geo._normals.size());
-    QCOMPARE(geo._vertices.size(), geo._texCoords.size());
+    // Two coarse chunks in the buffer, the selection refines both
+    const quint64 refining = Viewer3DTerrainQuadtree::key(1, 0, 0);
+    const quint64 refined = Viewer3DTerrainQuadtree::key(1, 1, 1);
+    geo._chunkSlots.insert(refining, geo._allocateSlot());
+    geo._chunkSlots.insert(refined, geo._allocateSlot());
+    for (const quint64 parent : { refining, refined }) {
+        for (int child = 0; child < 4; ++child) {
+            const int x = (Viewer3DTerrainQuadtree::keyX(parent) * 2) + (child % 2);
+            const int y = (Viewer3DTerrainQuadtree::keyY(parent) * 2) + (child / 2);
+            (void) geo._selectedChunks.insert(Viewer3DTerrainQuadtree::key(2, x, y));
+        }
+    }
+    (void) geo._selectedChunks.insert(Viewer3DTerrainQuadtree::key(1, 1, 0));
+    (void) geo._selectedChunks.insert(Viewer3DTerrainQuadtree::key(1, 0, 1));
+
+    // Nothing of the finer chunks is in yet
+    geo._retireChunks();
+    QCOMPARE(geo._chunkSlots.size(), 2);
+
+    // Once all children of one chunk are built it goes, while the other one waits for its last child
+    for (const quint64 key : std::as_const(geo._selectedChunks)) {
+        if (Viewer3DTerrainQuadtree::overlaps(key, refined) || ((Viewer3DTerrainQuadtree::keyLevel(key) == 2) && (key != Viewer3DTerrainQuadtree::key(2, 1, 1)))) {
+            geo._chunkSlots.insert(key, geo._allocateSlot());
+        }
+    }
+    const int refinedSlot = geo._chunkSlots.value(refined);
+    geo._retireChunks();
+    QVERIFY(!geo._chunkSlots.contains(refined));
+    QVERIFY(geo._chunkSlots.contains(refining));
+    QVERIFY(geo._freeSlots.contains(refinedSlot));
+
+    geo._chunkSlots.insert(Viewer3DTerrainQuadtree::key(2, 1, 1), geo._allocateSlot());
+    geo._retireChunks();
+    QVERIFY(!geo._chunkSlots.contains(refining));
 }
 
 void Viewer3DTerrainGeometryTest::_testClearScene()
@@ -77,63 +98,36 @@ void Viewer3DTerrainGeometryTest::_testClearScene()
 
     geo.setSectorCount(2);
     geo.setStackCount(2);
-
-    QGeoCoordinate roiMin(47.0, 8.0, 0);
-    QGeoCoordinate roiMax(47.01, 8.01, 0);
-    QGeoCoordinate ref(47.005, 8.005, 0);
-
-    geo._buildTerrain(roiMin, roiMax, ref, true);
-    QVERIFY(!geo._vertices.empty());
+    (void) geo._allocateSlot();
+    geo._chunkSlots.insert(1, 0);
+    const quint64 generation = geo._generation;
 
     geo._clearScene();
 
-    QVERIFY(geo._vertices.empty());
-    QVERIFY(geo._normals.empty());
-    QVERIFY(geo._texCoords.empty());
+    QVERIFY(geo._chunkSlots.isEmpty());
+    QVERIFY(geo._freeSlots.isEmpty());
+    QCOMPARE(geo._slotCount, 0);
+    QVERIFY(geo.vertexData().isEmpty());
+    QVERIFY(geo._generation != generation);
     QCOMPARE(geo.sectorCount(), 0);
     QCOMPARE(geo.stackCount(), 0);
 }
 
-void Viewer3DTerrainGeometryTest::_testComputeFaceNormalNegativeZ()
+void Viewer3DTerrainGeometryTest::_testCameraPositionSetter()
 {
     Viewer3DTerrainGeometry geo;
 
-    // Reversed winding: normal should point in -Z
-    QVector3D x1(0, 0, 0);
-    QVector3D x2(0, 1, 0);
-    QVector3D x3(1, 0, 0);
+    QSignalSpy spy(&geo, &Viewer3DTerrainGeometry::cameraPositionChanged);
+    const QVector3D position(10, 20, 300);
+    geo.setCameraPosition(position);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(geo.cameraPosition(), position);
 
-    QVector3D normal = geo._computeFaceNormal(x1, x2, x3);
+    geo.setCameraPosition(position);
+    QCOMPARE(spy.count(), 1);
 
-    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
-    QCOMPARE_FUZZY(normal.z(), -1.0f, 0.0001f);
-}
-
-void Viewer3DTerrainGeometryTest::_testBuildTerrainVertexCountScaling()
-{
-    Viewer3DTerrainGeometry geo;
-
-    QGeoCoordinate roiMin(47.0, 8.0, 0);
-    QGeoCoordinate roiMax(47.01, 8.01, 0);
-    QGeoCoordinate ref(47.005, 8.005, 0);
-
-    // 2x2 grid
-    geo.setSectorCount(2);
-    geo.setStackCount(2);
-    geo._buildTerrain(roiMin, roiMax, ref, true);
-    const size_t count2x2 = geo._vertices.size();
-
-    // 4x4 grid should produce more vertices
-    geo._vertices.clear();
-    geo._normals.clear();
-    geo._texCoords.clear();
-    geo.setSectorCount(4);
-    geo.setStackCount(4);
-    geo._buildTerrain(roiMin, roiMax, ref, true);
-    const size_t count4x4 = geo._vertices.size();
-
-    QVERIFY(count4x4 > count2x2);
+    // Nothing to refine before the terrain is set up
+    QVERIFY(!geo._selectionTimer->isActive());
 }
 
 void Viewer3DTerrainGeometryTest::_testRoiSetters()
@@ -9,13 +9,11 @@ class Viewer3DTerrainGeometryTest : public UnitTest
     Q_OBJECT
 
 private slots:
-    void _testComputeFaceNormal();
-    void _testComputeFaceNormalDegenerate();
-    void _testComputeFaceNormalNegativeZ();
-    void _testBuildTerrainZeroCounts();
-    void _testBuildTerrainValidRegion();
-    void _testBuildTerrainVertexCountScaling();
+    void _testUpdateEarthDataZeroCounts();
+    void _testAllocateSlot();
+    void _testRetireChunks();
     void _testClearScene();
     void _testPropertySetters();
     void _testRoiSetters();
+    void _testCameraPositionSetter();
 };
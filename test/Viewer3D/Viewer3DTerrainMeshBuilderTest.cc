@@ -0,0 +1,191 @@
+#include "Viewer3DTerrainMeshBuilderTest.h"
+
+#include <QtTest/QSignalSpy>
+
+#include "Viewer3DTerrainMeshBuilder.h"
+
+namespace {
+
+using Builder = Viewer3DTerrainMeshBuilder;
+
+Builder::ChunkRequest_t makeRequest()
+{
+    Builder::ChunkRequest_t request;
+    request.key = 42;
+    request.generation = 3;
+    request.chunkMin = QGeoCoordinate(47.0, 8.0, 0);
+    request.chunkMax = QGeoCoordinate(47.01, 8.01, 0);
+    request.ref = QGeoCoordinate(47.005, 8.005, 0);
+    request.minS = Builder::texCoordS(8.0);
+    request.scaleS = Builder::texCoordS(8.01) - request.minS;
+    request.minT = Builder::texCoordT(47.01);
+    request.scaleT = Builder::texCoordT(47.0) - request.minT;
+    return request;
+}
+
+const float *vertexAt(const QByteArray &vertexData, int index)
+{
+    return reinterpret_cast<const float *>(vertexData.constData() + (static_cast<qsizetype>(index) * Builder::kStride));
+}
+
+} // namespace
+
+void Viewer3DTerrainMeshBuilderTest::_testComputeFaceNormal()
+{
+    QVector3D x1(0, 0, 0);
+    QVector3D x2(1, 0, 0);
+    QVector3D x3(0, 1, 0);
+
+    QVector3D normal = Builder::computeFaceNormal(x1, x2, x3);
+
+    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.z(), 1.0f, 0.0001f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testComputeFaceNormalDegenerate()
+{
+    // Collinear points — degenerate triangle
+    QVector3D x1(0, 0, 0);
+    QVector3D x2(1, 0, 0);
+    QVector3D x3(2, 0, 0);
+
+    QVector3D normal = Builder::computeFaceNormal(x1, x2, x3);
+
+    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.z(), 0.0f, 0.0001f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testComputeFaceNormalNegativeZ()
+{
+    // Reversed winding: normal should point in -Z
+    QVector3D x1(0, 0, 0);
+    QVector3D x2(0, 1, 0);
+    QVector3D x3(1, 0, 0);
+
+    QVector3D normal = Builder::computeFaceNormal(x1, x2, x3);
+
+    QCOMPARE_FUZZY(normal.x(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.y(), 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(normal.z(), -1.0f, 0.0001f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testGridCoordinates()
+{
+    const QGeoCoordinate chunkMin(47.0, 8.0, 0);
+    const QGeoCoordinate chunkMax(47.01, 8.01, 0);
+    const QList<QGeoCoordinate> coordinates = Builder::gridCoordinates(chunkMin, chunkMax);
+
+    QCOMPARE(coordinates.size(), Builder::kSurfaceVertices);
+    // Row major from the north west corner
+    QCOMPARE_FUZZY(coordinates.first().latitude(), 47.01, 1e-9);
+    QCOMPARE_FUZZY(coordinates.first().longitude(), 8.0, 1e-9);
+    QCOMPARE_FUZZY(coordinates.at(Builder::kGridSize).longitude(), 8.01, 1e-9);
+    QCOMPARE_FUZZY(coordinates.at(Builder::kGridSize + 1).latitude(), 47.01 - (0.01 / Builder::kGridSize), 1e-9);
+    QCOMPARE_FUZZY(coordinates.last().latitude(), 47.0, 1e-9);
+    QCOMPARE_FUZZY(coordinates.last().longitude(), 8.01, 1e-9);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testBuildChunkFlat()
+{
+    const Builder::ChunkMesh_t mesh = Builder::buildChunk(makeRequest());
+
+    QCOMPARE(mesh.key, 42ULL);
+    QCOMPARE(mesh.generation, 3ULL);
+    QCOMPARE(mesh.vertexData.size(), static_cast<qsizetype>(Builder::kVerticesPerChunk) * Builder::kStride);
+
+    // Without heights the surface is flat at the reference and faces up
+    for (int i = 0; i < Builder::kSurfaceVertices; ++i) {
+        const float *vertex = vertexAt(mesh.vertexData, i);
+        QCOMPARE_FUZZY(vertex[2], 0.0f, 0.0001f);
+        QCOMPARE_FUZZY(vertex[5], 1.0f, 0.0001f);
+    }
+    // Skirts hang below the surface
+    for (int i = Builder::kSurfaceVertices; i < Builder::kVerticesPerChunk; ++i) {
+        QVERIFY(vertexAt(mesh.vertexData, i)[2] < 0.f);
+    }
+
+    // About 760 m east and 1110 m north, centered on the reference
+    QVERIFY(mesh.boundsMin.x() < -300.f);
+    QVERIFY(mesh.boundsMax.x() > 300.f);
+    QVERIFY(mesh.boundsMin.y() < -500.f);
+    QVERIFY(mesh.boundsMax.y() > 500.f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testBuildChunkHeights()
+{
+    Builder::ChunkRequest_t request = makeRequest();
+    request.refElevation = 400.;
+    for (int i = 0; i < Builder::kSurfaceVertices; ++i) {
+        request.heights.append(500.);
+    }
+    request.heights[0] = qQNaN();
+
+    const Builder::ChunkMesh_t mesh = Builder::buildChunk(request);
+
+    // Placed relative to the reference, unknown heights at the reference
+    QCOMPARE_FUZZY(vertexAt(mesh.vertexData, 0)[2], 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(vertexAt(mesh.vertexData, Builder::kSurfaceVertices - 1)[2], 100.0f, 0.0001f);
+    QCOMPARE_FUZZY(mesh.boundsMax.z(), 100.0f, 0.0001f);
+
+    // Heights of the wrong size are ignored
+    request.heights.removeLast();
+    const Builder::ChunkMesh_t flat = Builder::buildChunk(request);
+    QCOMPARE_FUZZY(vertexAt(flat.vertexData, Builder::kSurfaceVertices - 1)[2], 0.0f, 0.0001f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testBuildChunkTexCoords()
+{
+    const Builder::ChunkMesh_t mesh = Builder::buildChunk(makeRequest());
+
+    // The chunk spans the whole region of interest here
+    const float *northWest = vertexAt(mesh.vertexData, 0);
+    const float *southEast = vertexAt(mesh.vertexData, Builder::kSurfaceVertices - 1);
+    QCOMPARE_FUZZY(northWest[6], 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(northWest[7], 0.0f, 0.0001f);
+    QCOMPARE_FUZZY(southEast[6], 1.0f, 0.0001f);
+    QCOMPARE_FUZZY(southEast[7], 1.0f, 0.0001f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testIndexData()
+{
+    QVERIFY(Builder::indexData(0).isEmpty());
+
+    const QByteArray data = Builder::indexData(3);
+    QCOMPARE(data.size(), static_cast<qsizetype>(3) * Builder::kIndicesPerChunk * static_cast<qsizetype>(sizeof(quint32)));
+
+    // Each chunk only references the vertices of its own slot
+    const quint32 *indices = reinterpret_cast<const quint32 *>(data.constData());
+    for (int chunk = 0; chunk < 3; ++chunk) {
+        for (int i = 0; i < Builder::kIndicesPerChunk; ++i) {
+            const quint32 index = indices[(chunk * Builder::kIndicesPerChunk) + i];
+            QVERIFY(index >= static_cast<quint32>(chunk * Builder::kVerticesPerChunk));
+            QVERIFY(index < static_cast<quint32>((chunk + 1) * Builder::kVerticesPerChunk));
+        }
+    }
+
+    // The first surface triangle faces up
+    const QByteArray vertexData = Builder::buildChunk(makeRequest()).vertexData;
+    const auto position = [&vertexData](quint32 index) {
+        const float *vertex = vertexAt(vertexData, static_cast<int>(index));
+        return QVector3D(vertex[0], vertex[1], vertex[2]);
+    };
+    const QVector3D normal = Builder::computeFaceNormal(position(indices[0]), position(indices[1]), position(indices[2]));
+    QVERIFY(normal.z() > 0.99f);
+}
+
+void Viewer3DTerrainMeshBuilderTest::_testBuildSignalsMesh()
+{
+    Builder builder;
+    QSignalSpy spy(&builder, &Builder::chunkBuilt);
+
+    builder.build(makeRequest());
+
+    QCOMPARE(spy.count(), 1);
+    const Builder::ChunkMesh_t mesh = spy.first().first().value<Builder::ChunkMesh_t>();
+    QCOMPARE(mesh.key, 42ULL);
+    QCOMPARE(mesh.vertexData.size(), static_cast<qsizetype>(Builder::kVerticesPerChunk) * Builder::kStride);
+}
+
+UT_REGISTER_TEST(Viewer3DTerrainMeshBuilderTest, TestLabel::Unit)
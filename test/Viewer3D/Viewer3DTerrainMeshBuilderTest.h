@@ -0,0 +1,19 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class Viewer3DTerrainMeshBuilderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testComputeFaceNormal();
+    void _testComputeFaceNormalDegenerate();
+    void _testComputeFaceNormalNegativeZ();
+    void _testGridCoordinates();
+    void _testBuildChunkFlat();
+    void _testBuildChunkHeights();
+    void _testBuildChunkTexCoords();
+    void _testIndexData();
+    void _testBuildSignalsMesh();
+};
@@ -0,0 +1,117 @@
+#include "Viewer3DTerrainQuadtreeTest.h"
+
+#include <QtTest/QTest>
+
+#include "QGCGeo.h"
+#include "Viewer3DTerrainQuadtree.h"
+
+namespace {
+
+using Quadtree = Viewer3DTerrainQuadtree;
+
+const QGeoCoordinate kRoiMin(47.0, 8.0, 0);
+const QGeoCoordinate kRoiMax(47.1, 8.1, 0);
+const QGeoCoordinate kRef(47.05, 8.05, 0);
+
+/// Fraction of the region of interest a chunk covers
+double coverage(quint64 key)
+{
+    return (1. / static_cast<double>(1ULL << (2 * Quadtree::keyLevel(key))));
+}
+
+} // namespace
+
+void Viewer3DTerrainQuadtreeTest::_testKey()
+{
+    const quint64 key = Quadtree::key(6, 63, 17);
+    QCOMPARE(Quadtree::keyLevel(key), 6);
+    QCOMPARE(Quadtree::keyX(key), 63);
+    QCOMPARE(Quadtree::keyY(key), 17);
+    QVERIFY(key != Quadtree::key(6, 17, 63));
+    QVERIFY(key != Quadtree::key(5, 63, 17));
+}
+
+void Viewer3DTerrainQuadtreeTest::_testOverlaps()
+{
+    const quint64 parent = Quadtree::key(1, 1, 0);
+
+    QVERIFY(Quadtree::overlaps(parent, parent));
+    QVERIFY(Quadtree::overlaps(Quadtree::key(0, 0, 0), parent));
+    QVERIFY(Quadtree::overlaps(parent, Quadtree::key(2, 3, 1)));
+    QVERIFY(Quadtree::overlaps(Quadtree::key(3, 7, 3), parent));
+    QVERIFY(!Quadtree::overlaps(parent, Quadtree::key(1, 0, 0)));
+    QVERIFY(!Quadtree::overlaps(parent, Quadtree::key(2, 1, 1)));
+    QVERIFY(!Quadtree::overlaps(Quadtree::key(3, 7, 4), parent));
+}
+
+void Viewer3DTerrainQuadtreeTest::_testChunkBounds()
+{
+    QGeoCoordinate chunkMin;
+    QGeoCoordinate chunkMax;
+
+    Quadtree::chunkBounds(kRoiMin, kRoiMax, Quadtree::key(0, 0, 0), chunkMin, chunkMax);
+    QCOMPARE_FUZZY(chunkMin.latitude(), 47.0, 1e-9);
+    QCOMPARE_FUZZY(chunkMin.longitude(), 8.0, 1e-9);
+    QCOMPARE_FUZZY(chunkMax.latitude(), 47.1, 1e-9);
+    QCOMPARE_FUZZY(chunkMax.longitude(), 8.1, 1e-9);
+
+    // Row 0 is the northern most
+    Quadtree::chunkBounds(kRoiMin, kRoiMax, Quadtree::key(1, 1, 0), chunkMin, chunkMax);
+    QCOMPARE_FUZZY(chunkMin.latitude(), 47.05, 1e-9);
+    QCOMPARE_FUZZY(chunkMin.longitude(), 8.05, 1e-9);
+    QCOMPARE_FUZZY(chunkMax.latitude(), 47.1, 1e-9);
+    QCOMPARE_FUZZY(chunkMax.longitude(), 8.1, 1e-9);
+}
+
+void Viewer3DTerrainQuadtreeTest::_testSelectFarCamera()
+{
+    const QList<quint64> keys = Quadtree::selectChunks(kRoiMin, kRoiMax, kRef, QVector3D(0, 0, 1000000));
+    QCOMPARE(keys.size(), 1);
+    QCOMPARE(keys.first(), Quadtree::key(0, 0, 0));
+}
+
+void Viewer3DTerrainQuadtreeTest::_testSelectNearCamera()
+{
+    // Close above the north west corner of the region
+    const QVector3D camera = QGCGeo::convertGpsToEnu(QGeoCoordinate(47.099, 8.001, 0), kRef) + QVector3D(0, 0, 50);
+    const QList<quint64> keys = Quadtree::selectChunks(kRoiMin, kRoiMax, kRef, camera);
+
+    QVERIFY(keys.size() > 4);
+    QVERIFY(keys.size() <= Quadtree::kMaxChunks);
+
+    // Finest next to the camera, coarser away from it
+    const quint64 nearest = keys.first();
+    QCOMPARE(Quadtree::keyLevel(nearest), Quadtree::kMaxLevel);
+    QCOMPARE(Quadtree::keyX(nearest), 0);
+    QCOMPARE(Quadtree::keyY(nearest), 0);
+    QVERIFY(Quadtree::keyLevel(keys.last()) < Quadtree::kMaxLevel);
+
+    // The leaves cover the region exactly once
+    double covered = 0.;
+    for (const quint64 key : keys) {
+        covered += coverage(key);
+    }
+    QCOMPARE_FUZZY(covered, 1.0, 1e-9);
+    QCOMPARE(QSet<quint64>(keys.cbegin(), keys.cend()).size(), keys.size());
+}
+
+void Viewer3DTerrainQuadtreeTest::_testSelectMaxChunks()
+{
+    const QList<quint64> keys = Quadtree::selectChunks(kRoiMin, kRoiMax, kRef, QVector3D(0, 0, 10), Quadtree::kMaxLevel, 10);
+    QVERIFY(keys.size() <= 10);
+
+    double covered = 0.;
+    for (const quint64 key : keys) {
+        covered += coverage(key);
+    }
+    QCOMPARE_FUZZY(covered, 1.0, 1e-9);
+}
+
+void Viewer3DTerrainQuadtreeTest::_testSelectInvalid()
+{
+    QVERIFY(Quadtree::selectChunks(QGeoCoordinate(), kRoiMax, kRef, QVector3D()).isEmpty());
+    QVERIFY(Quadtree::selectChunks(kRoiMin, kRoiMax, QGeoCoordinate(), QVector3D()).isEmpty());
+    QVERIFY(Quadtree::selectChunks(kRoiMin, kRoiMax, kRef, QVector3D(), Quadtree::kMaxLevel, 0).isEmpty());
+}
+
+UT_REGISTER_TEST(Viewer3DTerrainQuadtreeTest, TestLabel::Unit)
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "UnitTest.h"
+
+class Viewer3DTerrainQuadtreeTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _testKey();
+    void _testOverlaps();
+    void _testChunkBounds();
+    void _testSelectFarCamera();
+    void _testSelectNearCamera();
+    void _testSelectMaxChunks();
+    void _testSelectInvalid();
+};